@@ -25,6 +25,75 @@ async function fetchConfig() {
     }
 }
 
+// Binary density map from /api/v1/lightning/density (layout in strike_density.h)
+function decodeDensity(buffer) {
+    const view = new DataView(buffer);
+    if (buffer.byteLength < 26 || view.getUint8(0) !== 0x53 || view.getUint8(1) !== 0x44 || view.getUint8(2) !== 1) {
+        throw new Error('Unknown density format');
+    }
+    const map = {
+        grid: view.getUint8(3),
+        cellKm: view.getUint16(4, true) / 1000,
+        max: view.getFloat32(6, true),
+        lat: view.getInt32(10, true) / 1e7,
+        lon: view.getInt32(14, true) / 1e7,
+        strikes: view.getUint32(18, true),
+        halfLifeMin: view.getUint16(22, true),
+    };
+    const pairs = view.getUint16(24, true);
+    map.levels = new Uint8Array(map.grid * map.grid);
+    let cell = 0;
+    for (let i = 0; i < pairs; i++) {
+        const run = view.getUint8(26 + 2 * i);
+        map.levels.fill(view.getUint8(27 + 2 * i), cell, cell + run);
+        cell += run;
+    }
+    return map;
+}
+
+function drawDensity(map) {
+    const canvas = document.getElementById('density-canvas');
+    const ctx = canvas.getContext('2d');
+    const size = canvas.width / map.grid;
+    ctx.fillStyle = '#10152a';
+    ctx.fillRect(0, 0, canvas.width, canvas.height);
+    for (let row = 0; row < map.grid; row++) {
+        for (let col = 0; col < map.grid; col++) {
+            const level = map.levels[row * map.grid + col];
+            if (level === 0) continue;
+            // Levels are sqrt-scaled already: map straight onto a blue-yellow-red ramp
+            const hue = 240 - 240 * level / 255;
+            ctx.fillStyle = `hsla(${hue}, 100%, 50%, ${0.35 + 0.65 * level / 255})`;
+            ctx.fillRect(col * size, row * size, size, size);
+        }
+    }
+    // Receiver at the centre, rings every 40 km
+    const centre = canvas.width / 2;
+    ctx.strokeStyle = 'rgba(255, 255, 255, 0.4)';
+    for (let km = 40; km * size / map.cellKm <= centre; km += 40) {
+        ctx.beginPath();
+        ctx.arc(centre, centre, km * size / map.cellKm, 0, 2 * Math.PI);
+        ctx.stroke();
+    }
+    ctx.fillStyle = 'white';
+    ctx.fillRect(centre - 2, centre - 2, 4, 4);
+}
+
+async function fetchDensity() {
+    const info = document.getElementById('density-info');
+    try {
+        const res = await fetch('/api/v1/lightning/density');
+        const map = decodeDensity(await res.arrayBuffer());
+        drawDensity(map);
+        const span = (map.grid * map.cellKm).toFixed(0);
+        info.textContent = `${map.strikes} strikes binned, densest cell ${map.max.toFixed(1)} ` +
+            `(${map.halfLifeMin} min half-life), ${span} x ${span} km around ` +
+            `${map.lat.toFixed(3)}, ${map.lon.toFixed(3)}`;
+    } catch (err) {
+        info.textContent = 'Error fetching strike density';
+    }
+}
+
 function updatePresetInfo(presetIndex) {
     const presets = [
         { name: "Long Range - Fast", bw: "125kHz", sf: "SF10" },
@@ -164,7 +233,9 @@ async function saveMode() {
 window.addEventListener('load', () => {
     fetchStatus();
     fetchConfig();
+    fetchDensity();
     setInterval(fetchStatus, 5000);
+    setInterval(fetchDensity, 30000);
     setInterval(fetchConfig, 3000); // Poll for config changes every 3 seconds
     document.getElementById('loraPresetSelect').addEventListener('change', saveConfig);
     document.getElementById('saveModeBtn').addEventListener('click', saveMode);
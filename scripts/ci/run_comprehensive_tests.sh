@@ -71,7 +71,7 @@ echo "=========================================="
 
 # Hardware Abstraction comprehensive test
 total_tests=$((total_tests + 1))
-if run_comprehensive_test "Hardware Abstraction" "test/test_hardware_abstraction.cpp" "src/hardware/hardware_abstraction.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+if run_comprehensive_test "Hardware Abstraction" "test/test_hardware_abstraction.cpp" "src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
     passed_tests=$((passed_tests + 1))
 else
     failed_tests=$((failed_tests + 1))
@@ -103,7 +103,7 @@ fi
 
 # Sensor Framework test
 total_tests=$((total_tests + 1))
-if run_comprehensive_test "Sensor Framework" "test/test_sensor_framework.cpp" "$COMMON_DEPS" "$COMMON_INCLUDES"; then
+if run_comprehensive_test "Sensor Framework" "test/test_sensor_framework.cpp" "src/sensors/sensor_interface.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
     passed_tests=$((passed_tests + 1))
 else
     failed_tests=$((failed_tests + 1))
@@ -135,7 +135,199 @@ fi
 
 # Integration test
 total_tests=$((total_tests + 1))
-if run_comprehensive_test "Integration" "test/test_integration.cpp" "src/app_logic.cpp src/hardware/hardware_abstraction.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+if run_comprehensive_test "Integration" "test/test_integration.cpp" "src/app_logic.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# GPS Sensor test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "GPS Sensor" "test/test_gps_sensor.cpp" "src/sensors/gps_sensor.cpp src/sensors/geodesy.cpp src/sensors/position_filter.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# GPS Duty Cycle test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "GPS Duty Cycle" "test/test_gps_duty_cycle.cpp" "src/sensors/gps_duty_cycle.cpp src/sensors/gps_sensor.cpp src/sensors/geodesy.cpp src/sensors/position_filter.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Position Filter test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Position Filter" "test/test_position_filter.cpp" "src/sensors/position_filter.cpp src/sensors/gps_sensor.cpp src/sensors/geodesy.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Geodesy test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Geodesy" "test/test_geodesy.cpp" "src/sensors/geodesy.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Lightning sensor test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Lightning Sensor" "test/test_lightning_sensor.cpp" "src/sensors/lightning_sensor.cpp src/sensors/lightning_autotune.cpp src/sensors/storm_tracker.cpp src/system/event_log.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp src/hardware/flash_partition.cpp test/mocks/as3935_mock.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Lightning auto-tune test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Lightning Auto-Tune" "test/test_lightning_autotune.cpp" "src/sensors/lightning_autotune.cpp src/sensors/lightning_sensor.cpp src/sensors/storm_tracker.cpp src/system/event_log.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp src/hardware/flash_partition.cpp test/mocks/as3935_mock.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Storm tracker test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Storm Tracker" "test/test_storm_tracker.cpp" "src/sensors/storm_tracker.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Strike locator test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Strike Locator" "test/test_strike_locator.cpp" "src/sensors/strike_locator.cpp src/sensors/strike_density.cpp src/sensors/geodesy.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# TDOA locator test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "TDOA Locator" "test/test_tdoa_locator.cpp" "src/sensors/tdoa_locator.cpp src/sensors/geodesy.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Strike density test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Strike Density" "test/test_strike_density.cpp" "src/sensors/strike_density.cpp src/sensors/geodesy.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Time-series store test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Time Series Store" "test/test_time_series_store.cpp" "src/sensors/time_series_store.cpp src/sensors/sensor_interface.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Event log test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Event Log" "test/test_event_log.cpp" "src/system/event_log.cpp src/hardware/flash_partition.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Event export test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Event Export" "test/test_event_export.cpp" "src/system/event_export.cpp src/system/event_log.cpp src/hardware/flash_partition.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Dirty-tile OLED renderer test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Dirty Tile Renderer" "test/test_dirty_tile_renderer.cpp" "src/display/dirty_tile_renderer.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Display task mailbox and frame pacing test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Display Task" "test/test_display_task.cpp" "src/display/display_task.cpp src/display/dirty_tile_renderer.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS -pthread" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Retained screen model and message queue test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Screen Model" "test/test_screen_model.cpp" "src/display/screen_model.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Screen renderer on the headless U8g2: golden PBM snapshots and render cost
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Screen Renderer" "test/test_screen_renderer.cpp" "src/display/screen_renderer.cpp src/display/screen_model.cpp src/display/dirty_tile_renderer.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp test/mocks/u8g2_mock.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Deferred UI action timeline test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "UI Timeline" "test/test_ui_timeline.cpp" "src/display/ui_timeline.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Loop blocking budget with the UI flows on the simulated clock
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Loop Budget" "test/test_loop_budget.cpp" "src/system/loop_budget.cpp src/display/ui_timeline.cpp src/display/screen_model.cpp src/display/ui_controller.cpp src/communication/control_burst.cpp src/sensors/button_input.cpp src/app_logic.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Background battery sampling against a simulated divider
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Battery Monitor" "test/test_battery_monitor.cpp" "src/sensors/battery_monitor.cpp src/sensors/battery_soc.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# State of charge against a full discharge log
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Battery SoC" "test/test_battery_soc.cpp" "src/sensors/battery_soc.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Power calibration store against an in-memory NVS
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Power Calibration" "test/test_power_calibration.cpp" "src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Continuous ADC test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Continuous ADC" "test/test_adc_continuous.cpp" "src/sensors/battery_monitor.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
+    passed_tests=$((passed_tests + 1))
+else
+    failed_tests=$((failed_tests + 1))
+fi
+
+# Button Input test
+total_tests=$((total_tests + 1))
+if run_comprehensive_test "Button Input" "test/test_button_input.cpp" "src/sensors/button_input.cpp src/app_logic.cpp src/hardware/hardware_abstraction.cpp src/hardware/power_calibration.cpp src/hardware/adc_continuous.cpp $COMMON_DEPS" "$COMMON_INCLUDES"; then
     passed_tests=$((passed_tests + 1))
 else
     failed_tests=$((failed_tests + 1))
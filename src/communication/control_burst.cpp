@@ -0,0 +1,89 @@
+#include "control_burst.h"
+#include "../hardware/hardware_abstraction.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+namespace CommunicationSystem {
+
+    namespace Timer = HardwareAbstraction::Timer;
+
+    ControlBurst::ControlBurst(Display::UiTimeline& timeline)
+        : m_timeline(timeline), m_hooks(), m_stepId(0), m_onControl(false), m_remaining(0), m_intervalMs(0),
+          m_sent(0) {}
+
+    bool ControlBurst::start(uint32_t nowMs, uint8_t times, uint32_t intervalMs) {
+        if (times == 0) {
+            return false;
+        }
+        // A preset change mid-burst has retuned the radio already; start
+        // over from the retune
+        cancel();
+        m_remaining = times;
+        m_intervalMs = intervalMs;
+        m_stepId = m_timeline.schedule(nowMs, 0, stepNow, this, "control burst");
+        return isActive();
+    }
+
+    void ControlBurst::cancel() {
+        if (isActive()) {
+            m_timeline.cancel(m_stepId);
+        }
+        m_stepId = 0;
+        m_onControl = false;
+        m_remaining = 0;
+    }
+
+    void ControlBurst::runStep(uint32_t nowMs) {
+        m_stepId = 0;
+
+        // One radio operation per step, so no loop iteration carries more
+        // than a single retune or packet
+        if (!m_onControl && m_remaining > 0) {
+            if (m_hooks.enterControl && !m_hooks.enterControl()) {
+#ifdef ARDUINO
+                Serial.println("[CTRL] Burst abandoned, control channel unavailable");
+#endif
+                m_remaining = 0;
+                return;
+            }
+            m_onControl = true;
+            scheduleStep(nowMs, 0);
+            return;
+        }
+
+        if (m_remaining > 0) {
+            if (m_hooks.transmit) {
+                m_hooks.transmit();
+            }
+            m_sent++;
+            m_remaining--;
+            // The gap runs from the end of the packet, as the airtime varies
+            scheduleStep(Timer::millis(), m_intervalMs);
+            return;
+        }
+
+        finish();
+    }
+
+    void ControlBurst::scheduleStep(uint32_t nowMs, uint32_t delayMs) {
+        m_stepId = m_timeline.schedule(nowMs, delayMs, stepNow, this, "control burst");
+        if (!isActive()) {
+            // Timeline full: never leave the radio parked on the control channel
+            m_remaining = 0;
+            finish();
+        }
+    }
+
+    void ControlBurst::finish() {
+        if (m_onControl && m_hooks.restore) {
+            m_hooks.restore();
+        }
+        m_onControl = false;
+    }
+
+    void ControlBurst::stepNow(void* context) {
+        static_cast<ControlBurst*>(context)->runStep(Timer::millis());
+    }
+}
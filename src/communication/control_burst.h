@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../display/ui_timeline.h"
+
+namespace CommunicationSystem {
+
+    // Radio steps of a control-channel burst; any may be nullptr
+    struct ControlBurstHooks {
+        bool (*enterControl)();             // Retune to the control channel; false abandons the burst
+        bool (*transmit)();                 // Send one CFG packet with the current settings
+        void (*restore)();                  // Back to the operational channel
+    };
+
+    // Announces the settings on the control channel a few times without
+    // holding up loop(): retune, one packet per step intervalMs apart, then
+    // retune back, each step a UiTimeline action. While active the radio is
+    // off the operational channel, so the caller should not poll it for RX.
+    class ControlBurst {
+    public:
+        explicit ControlBurst(Display::UiTimeline& timeline);
+
+        void setHooks(const ControlBurstHooks& hooks) { m_hooks = hooks; }
+
+        // Starts a burst of times packets. A burst already under way starts
+        // over, retune included, as the caller has usually just retuned the
+        // radio. False if the timeline is full.
+        bool start(uint32_t nowMs, uint8_t times, uint32_t intervalMs);
+
+        // Drops the remaining steps without touching the radio; for callers
+        // that are about to retune it themselves
+        void cancel();
+
+        bool isActive() const { return m_stepId != 0; }
+        uint8_t getRemaining() const { return m_remaining; }
+        uint32_t getSent() const { return m_sent; }
+
+    private:
+        Display::UiTimeline& m_timeline;
+        ControlBurstHooks m_hooks;
+
+        uint16_t m_stepId;                  // Pending timeline step, 0 when idle
+        bool m_onControl;
+        uint8_t m_remaining;
+        uint32_t m_intervalMs;
+        uint32_t m_sent;
+
+        void runStep(uint32_t nowMs);
+        void scheduleStep(uint32_t nowMs, uint32_t delayMs);
+        void finish();
+        static void stepNow(void* context);
+    };
+}
@@ -0,0 +1,96 @@
+#include "dirty_tile_renderer.h"
+
+#include <cstring>
+
+#include "../hardware/hardware_abstraction.h"
+
+namespace Timer = HardwareAbstraction::Timer;
+
+namespace Display {
+
+    DirtyTileRenderer::DirtyTileRenderer()
+        : m_frame(nullptr), m_sink(nullptr), m_shown(), m_valid(false), m_stats() {}
+
+    void DirtyTileRenderer::attach(const uint8_t* frame, TileSink* sink) {
+        m_frame = frame;
+        m_sink = sink;
+        m_valid = false;
+    }
+
+    void DirtyTileRenderer::resetStats() {
+        m_stats = FlushStats();
+    }
+
+    void DirtyTileRenderer::sendRun(uint8_t tx, uint8_t ty, uint8_t tw) {
+        const size_t offset = (static_cast<size_t>(ty) * TILE_COLUMNS + tx) * TILE_BYTES;
+        const size_t length = static_cast<size_t>(tw) * TILE_BYTES;
+
+        m_sink->sendTiles(tx, ty, tw, m_frame + offset);
+        memcpy(m_shown + offset, m_frame + offset, length);
+
+        m_stats.tiles_sent += tw;
+        m_stats.runs_sent++;
+        m_stats.last_bytes += length + RUN_OVERHEAD_BYTES;
+    }
+
+    uint32_t DirtyTileRenderer::flush() {
+        if (!m_frame || !m_sink) {
+            return 0;
+        }
+
+        const uint32_t start = Timer::micros();
+        const uint32_t tilesBefore = m_stats.tiles_sent;
+        m_stats.frames++;
+        m_stats.last_bytes = 0;
+
+        for (uint8_t ty = 0; ty < TILE_ROWS; ty++) {
+            int runStart = -1;
+            int lastDirty = -1;
+
+            for (uint8_t tx = 0; tx < TILE_COLUMNS; tx++) {
+                const size_t offset = (static_cast<size_t>(ty) * TILE_COLUMNS + tx) * TILE_BYTES;
+                uint64_t now;
+                uint64_t shown;
+                memcpy(&now, m_frame + offset, TILE_BYTES);
+                memcpy(&shown, m_shown + offset, TILE_BYTES);
+                if (m_valid && now == shown) {
+                    continue;
+                }
+
+                if (runStart >= 0 && tx - lastDirty - 1 > MERGE_GAP_TILES) {
+                    sendRun(runStart, ty, lastDirty - runStart + 1);
+                    runStart = -1;
+                }
+                if (runStart < 0) {
+                    runStart = tx;
+                }
+                lastDirty = tx;
+            }
+
+            if (runStart >= 0) {
+                sendRun(runStart, ty, lastDirty - runStart + 1);
+            }
+        }
+
+        m_valid = true;
+
+        const uint32_t sent = m_stats.tiles_sent - tilesBefore;
+        if (sent == 0) {
+            m_stats.unchanged_frames++;
+        }
+        m_stats.bytes_sent += m_stats.last_bytes;
+
+        const uint32_t elapsed = Timer::micros() - start;
+        m_stats.last_flush_us = elapsed;
+        m_stats.total_flush_us += elapsed;
+        if (elapsed > m_stats.max_flush_us) {
+            m_stats.max_flush_us = elapsed;
+        }
+
+        return sent;
+    }
+
+    uint32_t estimateI2CMicros(uint32_t bytes, uint32_t clockHz) {
+        return clockHz ? static_cast<uint32_t>(static_cast<uint64_t>(bytes) * 9 * 1000000 / clockHz) : 0;
+    }
+}
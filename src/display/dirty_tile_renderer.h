@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Display {
+
+    // SSD1306 128x64 in U8g2 full-buffer layout: 8 pages of 128 column
+    // bytes, bit n of a byte is row 8 * page + n. A tile is 8x8 pixels,
+    // i.e. 8 consecutive bytes of one page.
+    static constexpr uint8_t TILE_COLUMNS = 16;
+    static constexpr uint8_t TILE_ROWS = 8;
+    static constexpr size_t TILE_BYTES = 8;
+    static constexpr size_t FRAME_BYTES = TILE_COLUMNS * TILE_ROWS * TILE_BYTES;
+
+    // Per-transfer cost on SSD1306 I2C besides the pixel data: address and
+    // control bytes for the command and data transactions plus the three
+    // page/column positioning commands
+    static constexpr size_t RUN_OVERHEAD_BYTES = 7;
+
+    // Destination for a horizontal run of tiles, e.g. U8g2::updateDisplayArea()
+    class TileSink {
+    public:
+        virtual ~TileSink() = default;
+
+        // Tiles [tx, tx + tw) of tile row ty; data points at their
+        // tw * TILE_BYTES bytes in the frame
+        virtual void sendTiles(uint8_t tx, uint8_t ty, uint8_t tw, const uint8_t* data) = 0;
+    };
+
+    struct FlushStats {
+        uint32_t frames;                    // flush() calls
+        uint32_t unchanged_frames;          // Nothing sent
+        uint32_t tiles_sent;
+        uint32_t runs_sent;
+        uint32_t bytes_sent;                // Pixel data plus RUN_OVERHEAD_BYTES per run
+        uint32_t last_bytes;
+        uint32_t last_flush_us;             // Diff plus sink time
+        uint32_t max_flush_us;
+        uint64_t total_flush_us;
+    };
+
+    // Double-buffered partial updates: keeps a copy of what the panel
+    // shows, diffs each new frame against it tile by tile and sends only
+    // the tiles that changed, merged into one transfer per run of nearby
+    // dirty tiles. A status-bar or ping-dot change costs a few tiles
+    // instead of the full 1 KiB frame.
+    class DirtyTileRenderer {
+    public:
+        // Dirty runs closer than this are sent as one, since a gap this small
+        // costs less to resend than a new transfer's overhead
+        static constexpr uint8_t MERGE_GAP_TILES = 1;
+
+        DirtyTileRenderer();
+
+        // frame stays owned by the caller (U8g2::getBufferPtr()); the next
+        // flush sends everything
+        void attach(const uint8_t* frame, TileSink* sink);
+
+        // Panel contents unknown (reset, re-init): resend the full frame next
+        void invalidate() { m_valid = false; }
+
+        // Sends the tiles that differ from the last flush; returns tiles sent
+        uint32_t flush();
+
+        const FlushStats& getStats() const { return m_stats; }
+        void resetStats();
+
+    private:
+        const uint8_t* m_frame;
+        TileSink* m_sink;
+        uint8_t m_shown[FRAME_BYTES];
+        bool m_valid;
+        FlushStats m_stats;
+
+        void sendRun(uint8_t tx, uint8_t ty, uint8_t tw);
+    };
+
+    // Bus time for a transfer at the given I2C clock, 9 bit times per byte
+    uint32_t estimateI2CMicros(uint32_t bytes, uint32_t clockHz);
+}
@@ -0,0 +1,236 @@
+#include "display_task.h"
+
+#include <cstring>
+
+#include "../hardware/hardware_abstraction.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#endif
+
+namespace Timer = HardwareAbstraction::Timer;
+
+namespace Display {
+
+    DisplayMailbox::DisplayMailbox()
+        : m_slots(), m_write(0), m_read(1), m_middle(2), m_posted(0), m_dropped(0) {}
+
+    bool DisplayMailbox::post(const ScreenModel& model) {
+        ScreenModel& slot = m_slots[m_write];
+        memcpy(&slot, &model, sizeof(slot));
+        slot.sequence = ++m_posted;
+
+        const uint8_t previous = m_middle.exchange(static_cast<uint8_t>(m_write | FRESH), std::memory_order_acq_rel);
+        m_write = previous & 0x3;
+        if (previous & FRESH) {
+            m_dropped++;
+            return false;
+        }
+        return true;
+    }
+
+    const ScreenModel* DisplayMailbox::take() {
+        if (!hasPending()) {
+            return nullptr;
+        }
+        const uint8_t previous = m_middle.exchange(m_read, std::memory_order_acq_rel);
+        m_read = previous & 0x3;
+        return &m_slots[m_read];
+    }
+
+    DisplayTaskConfig getDefaultDisplayTaskConfig() {
+        DisplayTaskConfig config;
+        config.i2c_clock_hz = 400000;
+        config.max_fps = 20;
+        config.priority = 1;
+        config.stack_size = 4096;
+        config.core = 0;                    // Arduino loop() runs on core 1
+        config.stats_interval_ms = 30000;
+        return config;
+    }
+
+    DisplayTask::DisplayTask(const DisplayTaskConfig& config)
+        : m_config(config),
+          m_intervalMs(config.max_fps ? 1000u / config.max_fps : 0),
+          m_mailbox(),
+          m_draw(nullptr),
+          m_context(nullptr),
+          m_renderer(nullptr),
+          m_task(nullptr),
+          m_busMutex(nullptr),
+          m_hasRendered(false),
+          m_lastRenderMs(0),
+          m_stats(),
+          m_postedBase(0),
+          m_droppedBase(0) {}
+
+    void DisplayTask::begin(ScreenDrawFn draw, void* context, DirtyTileRenderer* renderer) {
+        m_draw = draw;
+        m_context = context;
+        m_renderer = renderer;
+#ifdef ARDUINO
+        if (!m_busMutex) {
+            m_busMutex = xSemaphoreCreateMutex();
+        }
+#endif
+    }
+
+    bool DisplayTask::start() {
+#ifdef ARDUINO
+        if (m_task || !m_draw) {
+            return m_task != nullptr;
+        }
+        TaskHandle_t handle = nullptr;
+        const BaseType_t core = m_config.core < 0 ? tskNO_AFFINITY : m_config.core;
+        if (xTaskCreatePinnedToCore(taskEntry, "display", m_config.stack_size, this, m_config.priority, &handle,
+                                    core) != pdPASS) {
+            return false;
+        }
+        m_task = handle;
+        if (m_mailbox.hasPending()) {
+            xTaskNotifyGive(handle);
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void DisplayTask::post(const ScreenModel& model) {
+        m_mailbox.post(model);
+#ifdef ARDUINO
+        if (m_task) {
+            xTaskNotifyGive(static_cast<TaskHandle_t>(m_task));
+        }
+#endif
+    }
+
+    uint32_t DisplayTask::msUntilNextFrame(uint32_t nowMs) const {
+        if (!m_hasRendered) {
+            return 0;
+        }
+        const uint32_t elapsed = nowMs - m_lastRenderMs;
+        return elapsed >= m_intervalMs ? 0 : m_intervalMs - elapsed;
+    }
+
+    bool DisplayTask::poll(uint32_t nowMs) {
+        if (!m_draw || !m_renderer || msUntilNextFrame(nowMs) > 0) {
+            return false;
+        }
+        if (!acquireBus(0xFFFFFFFFu)) {
+            return false;
+        }
+        const ScreenModel* model = m_mailbox.take();
+        if (!model) {
+            releaseBus();
+            return false;
+        }
+
+        const uint32_t start = Timer::micros();
+        m_draw(*model, m_context);
+        const uint32_t drawn = Timer::micros();
+        m_renderer->flush();
+        const uint32_t flushed = Timer::micros();
+        releaseBus();
+
+        m_hasRendered = true;
+        m_lastRenderMs = nowMs;
+
+        m_stats.rendered++;
+        m_stats.last_render_us = drawn - start;
+        if (m_stats.last_render_us > m_stats.max_render_us) {
+            m_stats.max_render_us = m_stats.last_render_us;
+        }
+        m_stats.last_flush_us = flushed - drawn;
+        m_stats.total_flush_us += m_stats.last_flush_us;
+        if (m_stats.last_flush_us > m_stats.max_flush_us) {
+            m_stats.max_flush_us = m_stats.last_flush_us;
+        }
+        return true;
+    }
+
+    bool DisplayTask::acquireBus(uint32_t timeoutMs) {
+#ifdef ARDUINO
+        if (!m_busMutex) {
+            return true;
+        }
+        const TickType_t ticks = timeoutMs == 0xFFFFFFFFu ? portMAX_DELAY : pdMS_TO_TICKS(timeoutMs);
+        return xSemaphoreTake(static_cast<SemaphoreHandle_t>(m_busMutex), ticks) == pdTRUE;
+#else
+        (void)timeoutMs;
+        return true;
+#endif
+    }
+
+    void DisplayTask::releaseBus() {
+#ifdef ARDUINO
+        if (m_busMutex) {
+            xSemaphoreGive(static_cast<SemaphoreHandle_t>(m_busMutex));
+        }
+#endif
+    }
+
+    DisplayTaskStats DisplayTask::getStats() const {
+        DisplayTaskStats stats = m_stats;
+        stats.posted = m_mailbox.getPosted() - m_postedBase;
+        stats.dropped = m_mailbox.getDropped() - m_droppedBase;
+        return stats;
+    }
+
+    void DisplayTask::resetStats() {
+        m_stats = DisplayTaskStats();
+        m_postedBase = m_mailbox.getPosted();
+        m_droppedBase = m_mailbox.getDropped();
+    }
+
+    void DisplayTask::logStats() {
+#ifdef ARDUINO
+        const DisplayTaskStats stats = getStats();
+        if (stats.rendered > 0) {
+            Serial.printf("[OLED] %lu posted, %lu rendered, %lu dropped; render max %lu us, flush avg %lu us max %lu us\n",
+                          (unsigned long)stats.posted, (unsigned long)stats.rendered, (unsigned long)stats.dropped,
+                          (unsigned long)stats.max_render_us,
+                          (unsigned long)(stats.total_flush_us / stats.rendered), (unsigned long)stats.max_flush_us);
+        }
+#endif
+        resetStats();
+    }
+
+    void DisplayTask::taskEntry(void* param) {
+#ifdef ARDUINO
+        DisplayTask* self = static_cast<DisplayTask*>(param);
+        uint32_t lastStatsMs = Timer::millis();
+
+        for (;;) {
+            TickType_t wait = portMAX_DELAY;
+            if (self->m_config.stats_interval_ms) {
+                const uint32_t sinceStats = Timer::millis() - lastStatsMs;
+                wait = sinceStats >= self->m_config.stats_interval_ms
+                           ? 0
+                           : pdMS_TO_TICKS(self->m_config.stats_interval_ms - sinceStats);
+            }
+            ulTaskNotifyTake(pdTRUE, wait);
+
+            // Hold back until the frame interval has passed; posts arriving
+            // meanwhile just replace the pending model
+            uint32_t holdMs;
+            while ((holdMs = self->msUntilNextFrame(Timer::millis())) > 0 && self->m_mailbox.hasPending()) {
+                const TickType_t ticks = pdMS_TO_TICKS(holdMs);
+                vTaskDelay(ticks > 0 ? ticks : 1);
+            }
+            self->poll(Timer::millis());
+
+            if (self->m_config.stats_interval_ms &&
+                Timer::millis() - lastStatsMs >= self->m_config.stats_interval_ms) {
+                lastStatsMs = Timer::millis();
+                self->logStats();
+            }
+        }
+#else
+        (void)param;
+#endif
+    }
+}
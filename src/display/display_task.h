@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+#include "dirty_tile_renderer.h"
+#include "screen_model.h"
+
+namespace Display {
+
+    // Single-slot, latest-wins mailbox between one producer and the display
+    // task: a triple buffer, so neither side ever waits on the other. A post
+    // that lands before the previous frame was taken replaces it and counts
+    // as dropped.
+    class DisplayMailbox {
+    public:
+        DisplayMailbox();
+
+        // Producer side; false if an unrendered frame was overwritten
+        bool post(const ScreenModel& model);
+
+        // Consumer side: newest frame not yet taken, or nullptr. Stays valid
+        // until the next take().
+        const ScreenModel* take();
+
+        bool hasPending() const { return (m_middle.load(std::memory_order_acquire) & FRESH) != 0; }
+
+        uint32_t getPosted() const { return m_posted; }
+        uint32_t getDropped() const { return m_dropped; }
+
+    private:
+        static constexpr uint8_t FRESH = 0x4;
+
+        ScreenModel m_slots[3];
+        uint8_t m_write;                    // Producer-owned slot
+        uint8_t m_read;                     // Consumer-owned slot
+        std::atomic<uint8_t> m_middle;      // Slot index | FRESH
+        uint32_t m_posted;
+        uint32_t m_dropped;
+    };
+
+    struct DisplayTaskConfig {
+        uint32_t i2c_clock_hz;              // SSD1306 is specified for 400 kHz fast mode
+        uint8_t max_fps;                    // Renders closer together than 1/max_fps wait
+        uint8_t priority;                   // FreeRTOS priority, below the loop task's
+        uint16_t stack_size;
+        int8_t core;                        // -1 = no affinity
+        uint32_t stats_interval_ms;         // Serial stats period, 0 = off
+    };
+
+    DisplayTaskConfig getDefaultDisplayTaskConfig();
+
+    struct DisplayTaskStats {
+        uint32_t posted;
+        uint32_t dropped;                   // Overwritten before the task got to them
+        uint32_t rendered;
+        uint32_t last_render_us;            // Drawing into the frame buffer
+        uint32_t max_render_us;
+        uint32_t last_flush_us;             // Dirty-tile transfer to the panel
+        uint32_t max_flush_us;
+        uint64_t total_flush_us;
+    };
+
+    // Brings the U8g2 frame buffer up to date with a model
+    typedef void (*ScreenDrawFn)(const ScreenModel& model, void* context);
+
+    // Decouples display updates from their callers: post() copies the model
+    // into the mailbox and wakes a low-priority task that draws and flushes
+    // the newest model at most max_fps times per second. The I2C transfer
+    // never runs on the caller's stack, so radio handlers and OTA callbacks
+    // only pay for the copy.
+    class DisplayTask {
+    public:
+        explicit DisplayTask(const DisplayTaskConfig& config = getDefaultDisplayTaskConfig());
+
+        void begin(ScreenDrawFn draw, void* context, DirtyTileRenderer* renderer);
+
+        // Creates the FreeRTOS task; until then frames wait in the mailbox
+        bool start();
+
+        void post(const ScreenModel& model);
+
+        // One render step: draws and flushes the pending model if the frame
+        // interval allows; returns true if it did. Called by the task, and
+        // directly by tests.
+        bool poll(uint32_t nowMs);
+
+        // Milliseconds until a pending model may be rendered
+        uint32_t msUntilNextFrame(uint32_t nowMs) const;
+
+        // Exclusive use of the display bus outside the task (power save,
+        // re-init); blocks while a frame is being flushed
+        bool acquireBus(uint32_t timeoutMs);
+        void releaseBus();
+
+        DisplayTaskStats getStats() const;
+        void resetStats();
+        const DisplayTaskConfig& getConfig() const { return m_config; }
+
+    private:
+        DisplayTaskConfig m_config;
+        uint32_t m_intervalMs;
+        DisplayMailbox m_mailbox;
+        ScreenDrawFn m_draw;
+        void* m_context;
+        DirtyTileRenderer* m_renderer;
+        void* m_task;                       // TaskHandle_t
+        void* m_busMutex;                   // SemaphoreHandle_t
+        bool m_hasRendered;
+        uint32_t m_lastRenderMs;
+        DisplayTaskStats m_stats;
+        uint32_t m_postedBase;
+        uint32_t m_droppedBase;
+
+        static void taskEntry(void* param);
+        void logStats();
+    };
+}
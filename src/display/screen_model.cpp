@@ -0,0 +1,456 @@
+#include "screen_model.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "../sensors/storm_tracker.h"
+
+namespace Display {
+
+    namespace {
+        void copyLine(char* dst, const char* src, size_t size) {
+            if (src) {
+                strncpy(dst, src, size - 1);
+                dst[size - 1] = '\0';
+            } else {
+                dst[0] = '\0';
+            }
+        }
+
+        int16_t roundTo16(float value) {
+            const float r = roundf(value);
+            return static_cast<int16_t>(r > 32767.0f ? 32767.0f : (r < -32768.0f ? -32768.0f : r));
+        }
+
+        size_t ipLength(const uint8_t ip[4]) {
+            char text[16];
+            const int n = snprintf(text, sizeof(text), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+            return n > 0 ? static_cast<size_t>(n) : 0;
+        }
+    }
+
+    ScreenConfig getDefaultScreenConfig() {
+        ScreenConfig config;
+        config.hold_ms[static_cast<size_t>(MessagePriority::INFO)] = 1500;
+        config.hold_ms[static_cast<size_t>(MessagePriority::STATUS)] = 2000;
+        config.hold_ms[static_cast<size_t>(MessagePriority::WARNING)] = 3000;
+        config.hold_ms[static_cast<size_t>(MessagePriority::ERROR)] = 5000;
+        config.rotate_interval_ms = 0;
+        config.node_timeout_ms = 10 * 60 * 1000;
+        config.scroll_interval_ms = 300;
+        config.scroll_width = 12;           // 5x7 font on the 64 px portrait width
+        return config;
+    }
+
+    const char* screenToString(Screen screen) {
+        switch (screen) {
+            case Screen::SIGNAL: return "Signal";
+            case Screen::NETWORK: return "Network";
+            case Screen::NODES: return "Nodes";
+            case Screen::STORM: return "Storm";
+            default: return "unknown";
+        }
+    }
+
+    // MessageQueue
+
+    MessageQueue::MessageQueue() : m_heap(), m_count(0), m_order(0), m_stats() {}
+
+    bool MessageQueue::before(const TransientMessage& a, const TransientMessage& b) {
+        if (a.priority != b.priority) {
+            return a.priority > b.priority;
+        }
+        return static_cast<int32_t>(a.order - b.order) < 0;
+    }
+
+    void MessageQueue::siftUp(size_t index) {
+        while (index > 0) {
+            const size_t parent = (index - 1) / 2;
+            if (!before(m_heap[index], m_heap[parent])) {
+                break;
+            }
+            const TransientMessage tmp = m_heap[index];
+            m_heap[index] = m_heap[parent];
+            m_heap[parent] = tmp;
+            index = parent;
+        }
+    }
+
+    void MessageQueue::siftDown(size_t index) {
+        for (;;) {
+            const size_t left = 2 * index + 1;
+            const size_t right = left + 1;
+            size_t best = index;
+            if (left < m_count && before(m_heap[left], m_heap[best])) {
+                best = left;
+            }
+            if (right < m_count && before(m_heap[right], m_heap[best])) {
+                best = right;
+            }
+            if (best == index) {
+                break;
+            }
+            const TransientMessage tmp = m_heap[index];
+            m_heap[index] = m_heap[best];
+            m_heap[best] = tmp;
+            index = best;
+        }
+    }
+
+    void MessageQueue::removeAt(size_t index) {
+        m_count--;
+        if (index == m_count) {
+            return;
+        }
+        m_heap[index] = m_heap[m_count];
+        siftDown(index);
+        siftUp(index);
+    }
+
+    bool MessageQueue::push(const char* line1, const char* line2, MessagePriority priority, uint32_t holdMs) {
+        TransientMessage message;
+        copyLine(message.line1, line1, sizeof(message.line1));
+        copyLine(message.line2, line2, sizeof(message.line2));
+        message.priority = priority;
+        message.hold_ms = holdMs;
+        message.order = m_order++;
+
+        if (m_count == CAPACITY) {
+            // The least important message is one of the leaves
+            size_t worst = CAPACITY / 2;
+            for (size_t i = worst + 1; i < m_count; i++) {
+                if (before(m_heap[worst], m_heap[i])) {
+                    worst = i;
+                }
+            }
+            if (!before(message, m_heap[worst])) {
+                m_stats.dropped++;
+                return false;
+            }
+            removeAt(worst);
+            m_stats.dropped++;
+        }
+
+        m_heap[m_count] = message;
+        siftUp(m_count);
+        m_count++;
+        m_stats.queued++;
+        return true;
+    }
+
+    bool MessageQueue::replace(const char* line1, const char* line2, MessagePriority priority) {
+        for (size_t i = 0; i < m_count; i++) {
+            TransientMessage& message = m_heap[i];
+            if (message.priority == priority && strncmp(message.line1, line1 ? line1 : "", sizeof(message.line1) - 1) == 0) {
+                copyLine(message.line2, line2, sizeof(message.line2));
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool MessageQueue::pop(TransientMessage& out) {
+        if (m_count == 0) {
+            return false;
+        }
+        out = m_heap[0];
+        removeAt(0);
+        m_stats.shown++;
+        return true;
+    }
+
+    // ScreenState
+
+    ScreenState::ScreenState(const ScreenConfig& config)
+        : m_config(config),
+          m_model(),
+          m_messages(),
+          m_enabledScreens((1u << static_cast<uint8_t>(Screen::COUNT)) - 1),
+          m_changed(true),
+          m_messageSinceMs(0),
+          m_messageHoldMs(0),
+          m_lastScrollMs(0),
+          m_lastRotateMs(0),
+          m_started(false) {
+        m_model.screen = Screen::SIGNAL;
+        m_model.signal.rssi_dbm = -999;
+        m_model.storm.eta_min = -1;
+        restHeader();
+    }
+
+    void ScreenState::restHeader() {
+        char line1[MESSAGE_LINE_LEN];
+        char line2[MESSAGE_LINE_LEN];
+        copyLine(line1, m_model.radio.sender ? "Sender" : "Receiver", sizeof(line1));
+        copyLine(line2, screenToString(m_model.screen), sizeof(line2));
+
+        if (m_model.header.message || strcmp(line1, m_model.header.line1) != 0 ||
+            strcmp(line2, m_model.header.line2) != 0) {
+            m_model.header.message = false;
+            m_model.header.priority = MessagePriority::INFO;
+            memcpy(m_model.header.line1, line1, sizeof(line1));
+            memcpy(m_model.header.line2, line2, sizeof(line2));
+            touch(Section::HEADER);
+        }
+    }
+
+    void ScreenState::touch(Section section) {
+        m_model.revision[static_cast<size_t>(section)]++;
+        m_changed = true;
+    }
+
+    void ScreenState::setScreen(Screen screen) {
+        if (screen >= Screen::COUNT || screen == m_model.screen) {
+            return;
+        }
+        m_model.screen = screen;
+        m_changed = true;
+        if (!m_model.header.message) {
+            restHeader();
+        }
+    }
+
+    void ScreenState::setEnabledScreens(uint8_t mask) {
+        m_enabledScreens = mask & ((1u << static_cast<uint8_t>(Screen::COUNT)) - 1);
+        if (m_enabledScreens && !(m_enabledScreens & (1u << static_cast<uint8_t>(m_model.screen)))) {
+            nextScreen();
+        }
+    }
+
+    void ScreenState::nextScreen() {
+        const uint8_t count = static_cast<uint8_t>(Screen::COUNT);
+        uint8_t screen = static_cast<uint8_t>(m_model.screen);
+        for (uint8_t i = 0; i < count; i++) {
+            screen = (screen + 1) % count;
+            if (m_enabledScreens & (1u << screen)) {
+                setScreen(static_cast<Screen>(screen));
+                return;
+            }
+        }
+    }
+
+    bool ScreenState::showMessage(const char* line1, const char* line2, MessagePriority priority, uint32_t holdMs) {
+        if (holdMs == 0) {
+            holdMs = m_config.hold_ms[static_cast<size_t>(priority)];
+        }
+
+        if (m_model.header.message && m_model.header.priority == priority &&
+            strncmp(m_model.header.line1, line1 ? line1 : "", sizeof(m_model.header.line1) - 1) == 0) {
+            char text[MESSAGE_LINE_LEN];
+            copyLine(text, line2, sizeof(text));
+            if (strcmp(text, m_model.header.line2) != 0) {
+                memcpy(m_model.header.line2, text, sizeof(text));
+                touch(Section::HEADER);
+            }
+            return true;
+        }
+        if (m_messages.replace(line1, line2, priority)) {
+            return true;
+        }
+        return m_messages.push(line1, line2, priority, holdMs);
+    }
+
+    void ScreenState::setPing(bool dot, bool fullScreen) {
+        fullScreen = dot && fullScreen;
+        if (dot != m_model.ping.dot || fullScreen != m_model.ping.full_screen) {
+            m_model.ping.dot = dot;
+            m_model.ping.full_screen = fullScreen;
+            touch(Section::PING);
+        }
+    }
+
+    void ScreenState::setSignal(float rssiDbm, float snrDb) {
+        const int16_t rssi = roundTo16(rssiDbm);
+        const int16_t snr = roundTo16(snrDb * 10.0f);
+        if (!m_model.signal.valid || rssi != m_model.signal.rssi_dbm || snr != m_model.signal.snr_x10) {
+            m_model.signal.valid = true;
+            m_model.signal.rssi_dbm = rssi;
+            m_model.signal.snr_x10 = snr;
+            touch(Section::SIGNAL);
+        }
+    }
+
+    void ScreenState::setRadio(bool sender, int spreadingFactor, float bandwidthKhz, float frequencyMhz) {
+        const int8_t sf = static_cast<int8_t>(spreadingFactor);
+        const uint16_t bw = static_cast<uint16_t>(roundTo16(bandwidthKhz));
+        const uint16_t freq = static_cast<uint16_t>(lroundf(frequencyMhz * 10.0f));
+        if (sender != m_model.radio.sender || sf != m_model.radio.spreading_factor ||
+            bw != m_model.radio.bandwidth_khz || freq != m_model.radio.frequency_x10) {
+            m_model.radio.sender = sender;
+            m_model.radio.spreading_factor = sf;
+            m_model.radio.bandwidth_khz = bw;
+            m_model.radio.frequency_x10 = freq;
+            touch(Section::RADIO);
+            if (!m_model.header.message) {
+                restHeader();
+            }
+        }
+    }
+
+    void ScreenState::setNetwork(bool connected, const uint8_t ip[4], const char* location, bool otaActive,
+                                 bool loraOtaActive) {
+        char loc[LOCATION_LEN];
+        copyLine(loc, connected ? location : nullptr, sizeof(loc));
+        uint8_t addr[4] = {0, 0, 0, 0};
+        if (connected && ip) {
+            memcpy(addr, ip, sizeof(addr));
+        }
+
+        const bool ipChanged = memcmp(addr, m_model.network.ip, sizeof(addr)) != 0;
+        if (connected != m_model.network.connected || ipChanged || strcmp(loc, m_model.network.location) != 0 ||
+            otaActive != m_model.network.ota_active || loraOtaActive != m_model.network.lora_ota_active) {
+            m_model.network.connected = connected;
+            memcpy(m_model.network.ip, addr, sizeof(addr));
+            memcpy(m_model.network.location, loc, sizeof(loc));
+            m_model.network.ota_active = otaActive;
+            m_model.network.lora_ota_active = loraOtaActive;
+            if (ipChanged) {
+                m_model.network.scroll = 0;
+            }
+            touch(Section::NETWORK);
+        }
+    }
+
+    void ScreenState::setBattery(uint8_t percent) {
+        if (percent != m_model.battery_percent) {
+            m_model.battery_percent = percent;
+            touch(Section::BATTERY);
+        }
+    }
+
+    void ScreenState::setStorm(const Sensors::StormSummary& summary) {
+        const float distance = summary.distance_km < 0.0f ? 0.0f : summary.distance_km;
+        const uint8_t km = static_cast<uint8_t>(distance > Sensors::STORM_OUT_OF_RANGE_KM
+                                                    ? Sensors::STORM_OUT_OF_RANGE_KM
+                                                    : lroundf(distance));
+        const uint16_t rate = static_cast<uint16_t>(lroundf(summary.rate_1min * 10.0f));
+        const int16_t eta = summary.eta_min < 0.0f ? -1 : roundTo16(summary.eta_min);
+        const uint8_t motion = static_cast<uint8_t>(summary.motion);
+
+        if (summary.active != m_model.storm.active || summary.strikes != m_model.storm.strikes ||
+            km != m_model.storm.distance_km || rate != m_model.storm.rate_x10 || motion != m_model.storm.motion ||
+            eta != m_model.storm.eta_min) {
+            m_model.storm.active = summary.active;
+            m_model.storm.strikes = summary.strikes;
+            m_model.storm.distance_km = km;
+            m_model.storm.rate_x10 = rate;
+            m_model.storm.motion = motion;
+            m_model.storm.eta_min = eta;
+            touch(Section::STORM);
+        }
+    }
+
+    void ScreenState::updateNode(uint16_t id, float rssiDbm, float snrDb, uint32_t nowMs) {
+        size_t index = 0;
+        while (index < m_model.nodes.count && m_model.nodes.entries[index].id != id) {
+            index++;
+        }
+
+        NodeEntry entry;
+        if (index < m_model.nodes.count) {
+            entry = m_model.nodes.entries[index];
+        } else {
+            memset(&entry, 0, sizeof(entry));
+            entry.id = id;
+            if (m_model.nodes.count < MAX_NODES) {
+                m_model.nodes.count++;
+            }
+            index = m_model.nodes.count - 1;            // Full: the least recently heard goes
+        }
+
+        entry.rssi_dbm = roundTo16(rssiDbm);
+        entry.snr_x10 = roundTo16(snrDb * 10.0f);
+        entry.age_s = 0;
+        entry.last_seen_ms = nowMs;
+        if (entry.packets < 0xFFFF) {
+            entry.packets++;
+        }
+
+        // Most recently heard first
+        memmove(&m_model.nodes.entries[1], &m_model.nodes.entries[0], index * sizeof(NodeEntry));
+        m_model.nodes.entries[0] = entry;
+        touch(Section::NODES);
+    }
+
+    void ScreenState::updateNodeAges(uint32_t nowMs) {
+        bool changed = false;
+        size_t kept = 0;
+        for (size_t i = 0; i < m_model.nodes.count; i++) {
+            NodeEntry entry = m_model.nodes.entries[i];
+            const uint32_t elapsed = nowMs - entry.last_seen_ms;
+            if (m_config.node_timeout_ms && elapsed > m_config.node_timeout_ms) {
+                changed = true;
+                continue;
+            }
+            const uint32_t age = elapsed / 1000;
+            const uint16_t ageS = static_cast<uint16_t>(age > 0xFFFF ? 0xFFFF : age);
+            if (ageS != entry.age_s) {
+                entry.age_s = ageS;
+                changed = true;
+            }
+            m_model.nodes.entries[kept++] = entry;
+        }
+        m_model.nodes.count = static_cast<uint8_t>(kept);
+        if (changed) {
+            touch(Section::NODES);
+        }
+    }
+
+    void ScreenState::updateScroll(uint32_t nowMs) {
+        if (!m_model.network.connected || nowMs - m_lastScrollMs < m_config.scroll_interval_ms) {
+            return;
+        }
+        const size_t length = ipLength(m_model.network.ip);
+        if (length <= m_config.scroll_width) {
+            return;
+        }
+        m_lastScrollMs = nowMs;
+        m_model.network.scroll = m_model.network.scroll + m_config.scroll_width >= length
+                                     ? 0
+                                     : m_model.network.scroll + 1;
+        touch(Section::NETWORK);
+    }
+
+    bool ScreenState::messagesPending(uint32_t nowMs) const {
+        return m_messages.size() > 0 || (m_model.header.message && nowMs - m_messageSinceMs < m_messageHoldMs);
+    }
+
+    bool ScreenState::update(uint32_t nowMs) {
+        if (!m_started) {
+            m_started = true;
+            m_lastRotateMs = nowMs;
+            m_lastScrollMs = nowMs;
+        }
+
+        // A message stays up for its hold time; then the most important
+        // queued one follows, or the resting header returns
+        const bool held = m_model.header.message && nowMs - m_messageSinceMs < m_messageHoldMs;
+        if (!held) {
+            TransientMessage next;
+            if (m_messages.pop(next)) {
+                m_model.header.message = true;
+                m_model.header.priority = next.priority;
+                memcpy(m_model.header.line1, next.line1, sizeof(next.line1));
+                memcpy(m_model.header.line2, next.line2, sizeof(next.line2));
+                m_messageSinceMs = nowMs;
+                m_messageHoldMs = next.hold_ms;
+                touch(Section::HEADER);
+            } else if (m_model.header.message) {
+                restHeader();
+            }
+        }
+
+        updateNodeAges(nowMs);
+        updateScroll(nowMs);
+
+        if (m_config.rotate_interval_ms && nowMs - m_lastRotateMs >= m_config.rotate_interval_ms) {
+            m_lastRotateMs = nowMs;
+            nextScreen();
+        }
+
+        const bool changed = m_changed;
+        m_changed = false;
+        return changed;
+    }
+}
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Sensors {
+    struct StormSummary;
+}
+
+namespace Display {
+
+    enum class Screen : uint8_t {
+        SIGNAL,
+        NETWORK,
+        NODES,
+        STORM,
+        COUNT
+    };
+
+    // Independently redrawn parts of a screen; each has a revision counter in
+    // the model, bumped only when what it shows changes
+    enum class Section : uint8_t {
+        HEADER,                             // Transient message or role + screen name
+        PING,
+        SIGNAL,
+        RADIO,
+        NETWORK,
+        BATTERY,
+        NODES,
+        STORM,
+        COUNT
+    };
+
+    static constexpr size_t SECTION_COUNT = static_cast<size_t>(Section::COUNT);
+
+    enum class MessagePriority : uint8_t {
+        INFO,
+        STATUS,
+        WARNING,
+        ERROR
+    };
+
+    static constexpr size_t MESSAGE_LINE_LEN = 20;
+    static constexpr size_t LOCATION_LEN = 12;
+    static constexpr size_t MAX_NODES = 6;              // Rows that fit the node table
+
+    struct NodeEntry {
+        uint16_t id;
+        int16_t rssi_dbm;
+        int16_t snr_x10;
+        uint16_t age_s;                     // Seconds since last heard, saturating
+        uint16_t packets;
+        uint32_t last_seen_ms;
+    };
+
+    // Display state as values at display resolution (whole dBm, tenths of a
+    // dB, ...), so that setting a value that would render identically is not
+    // a change. Fixed size and trivially copyable: this is what the display
+    // task receives.
+    struct ScreenModel {
+        uint32_t sequence;                  // Set by DisplayMailbox::post()
+        Screen screen;
+        uint16_t revision[SECTION_COUNT];
+
+        struct {
+            bool message;                   // false: resting header
+            MessagePriority priority;
+            char line1[MESSAGE_LINE_LEN];
+            char line2[MESSAGE_LINE_LEN];
+        } header;
+
+        struct {
+            bool dot;
+            bool full_screen;               // Idle mode: the flash takes the whole panel
+        } ping;
+
+        struct {
+            bool valid;                     // Something received yet
+            int16_t rssi_dbm;
+            int16_t snr_x10;
+        } signal;
+
+        struct {
+            bool sender;
+            int8_t spreading_factor;
+            uint16_t bandwidth_khz;
+            uint16_t frequency_x10;         // MHz * 10
+        } radio;
+
+        struct {
+            bool connected;
+            uint8_t ip[4];
+            char location[LOCATION_LEN];
+            bool ota_active;
+            bool lora_ota_active;
+            uint8_t scroll;                 // Status-bar IP scroll offset
+        } network;
+
+        uint8_t battery_percent;
+
+        struct {
+            uint8_t count;
+            NodeEntry entries[MAX_NODES];   // Most recently heard first
+        } nodes;
+
+        struct {
+            bool active;
+            uint32_t strikes;
+            uint8_t distance_km;
+            uint16_t rate_x10;              // Strikes per minute * 10
+            uint8_t motion;                 // Sensors::StormMotion
+            int16_t eta_min;                // < 0: not approaching
+        } storm;
+
+        uint16_t getRevision(Section section) const { return revision[static_cast<size_t>(section)]; }
+    };
+
+    struct TransientMessage {
+        char line1[MESSAGE_LINE_LEN];
+        char line2[MESSAGE_LINE_LEN];
+        MessagePriority priority;
+        uint32_t hold_ms;                   // Minimum time on screen
+        uint32_t order;                     // FIFO among equal priorities
+    };
+
+    struct MessageQueueStats {
+        uint32_t queued;
+        uint32_t shown;
+        uint32_t dropped;                   // Queue full of higher-priority messages
+    };
+
+    // Fixed-capacity binary max-heap on (priority, arrival). When full, a new
+    // message evicts the least important queued one if it outranks it.
+    class MessageQueue {
+    public:
+        static constexpr size_t CAPACITY = 8;
+
+        MessageQueue();
+
+        bool push(const char* line1, const char* line2, MessagePriority priority, uint32_t holdMs);
+
+        // Updates line2 of a queued message with this line1 and priority, so
+        // progress reports replace each other instead of queueing up
+        bool replace(const char* line1, const char* line2, MessagePriority priority);
+        bool pop(TransientMessage& out);
+        const TransientMessage* peek() const { return m_count ? &m_heap[0] : nullptr; }
+
+        size_t size() const { return m_count; }
+        void clear() { m_count = 0; }
+        const MessageQueueStats& getStats() const { return m_stats; }
+
+    private:
+        TransientMessage m_heap[CAPACITY];
+        size_t m_count;
+        uint32_t m_order;
+        MessageQueueStats m_stats;
+
+        static bool before(const TransientMessage& a, const TransientMessage& b);
+        void siftUp(size_t index);
+        void siftDown(size_t index);
+        void removeAt(size_t index);
+    };
+
+    struct ScreenConfig {
+        uint32_t hold_ms[4];                // Default minimum display time per MessagePriority
+        uint32_t rotate_interval_ms;        // Cycle enabled screens, 0 = stay
+        uint32_t node_timeout_ms;           // Forget nodes not heard for this long
+        uint32_t scroll_interval_ms;        // Status-bar IP scroll step
+        uint8_t scroll_width;               // Characters visible in the status bar
+    };
+
+    ScreenConfig getDefaultScreenConfig();
+
+    const char* screenToString(Screen screen);
+
+    // Retained display state on the producer side. Typed setters quantize
+    // their input and bump the section revision only on a visible change;
+    // update() advances time-driven state (message holds, node ages, IP
+    // scroll, screen rotation) and says whether there is anything new to
+    // post.
+    class ScreenState {
+    public:
+        explicit ScreenState(const ScreenConfig& config = getDefaultScreenConfig());
+
+        void setScreen(Screen screen);
+        void setEnabledScreens(uint8_t mask);           // Bit per Screen
+        void nextScreen();
+
+        // holdMs 0 = the priority's default from ScreenConfig. A message with
+        // the same line1 and priority as the one showing or queued updates it
+        // in place.
+        bool showMessage(const char* line1, const char* line2, MessagePriority priority, uint32_t holdMs = 0);
+
+        void setPing(bool dot, bool fullScreen);
+        void setSignal(float rssiDbm, float snrDb);
+        void setRadio(bool sender, int spreadingFactor, float bandwidthKhz, float frequencyMhz);
+        void setNetwork(bool connected, const uint8_t ip[4], const char* location, bool otaActive,
+                        bool loraOtaActive);
+        void setBattery(uint8_t percent);
+        void setStorm(const Sensors::StormSummary& summary);
+        void updateNode(uint16_t id, float rssiDbm, float snrDb, uint32_t nowMs);
+
+        // True if any section changed since the last call
+        bool update(uint32_t nowMs);
+
+        // A message is still within its hold time or waiting in the queue
+        bool messagesPending(uint32_t nowMs) const;
+
+        const ScreenModel& getModel() const { return m_model; }
+        const MessageQueue& getMessages() const { return m_messages; }
+        const ScreenConfig& getConfig() const { return m_config; }
+
+    private:
+        ScreenConfig m_config;
+        ScreenModel m_model;
+        MessageQueue m_messages;
+        uint8_t m_enabledScreens;
+        bool m_changed;
+        uint32_t m_messageSinceMs;
+        uint32_t m_messageHoldMs;
+        uint32_t m_lastScrollMs;
+        uint32_t m_lastRotateMs;
+        bool m_started;
+
+        void touch(Section section);
+        void restHeader();                  // Role + screen name when no message is up
+        void updateNodeAges(uint32_t nowMs);
+        void updateScroll(uint32_t nowMs);
+    };
+}
@@ -0,0 +1,283 @@
+#include "screen_renderer.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include <U8g2lib.h>
+
+#include "../sensors/storm_tracker.h"
+
+namespace Display {
+
+    namespace {
+        // Portrait 64x128 regions; a region is cleared and repainted as a whole
+        constexpr int WIDTH = 64;
+        constexpr int HEADER_Y = 0, HEADER_H = 38;
+        constexpr int UPPER_Y = 38, UPPER_H = 30;          // SIGNAL: RSSI/SNR
+        constexpr int LOWER_Y = 68, LOWER_H = 32;          // SIGNAL: SF/BW, frequency
+        constexpr int BODY_Y = 38, BODY_H = 62;            // Other screens
+        constexpr int STATUS_Y = 100, STATUS_H = 28;
+
+        void formatAge(char* out, size_t size, uint16_t ageS) {
+            if (ageS < 60) {
+                snprintf(out, size, "%us", (unsigned)ageS);
+            } else if (ageS < 3600) {
+                snprintf(out, size, "%um", (unsigned)(ageS / 60));
+            } else {
+                snprintf(out, size, "%uh", (unsigned)(ageS / 3600));
+            }
+        }
+
+        const char* motionToString(uint8_t motion) {
+            switch (static_cast<Sensors::StormMotion>(motion)) {
+                case Sensors::StormMotion::APPROACHING: return "Closing";
+                case Sensors::StormMotion::STATIONARY: return "Steady";
+                case Sensors::StormMotion::RECEDING: return "Leaving";
+                default: return "--";
+            }
+        }
+    }
+
+    ScreenRenderer::ScreenRenderer(U8G2& u8g2) : m_u8g2(u8g2), m_drawn(), m_valid(false), m_stats() {}
+
+    void ScreenRenderer::drawCallback(const ScreenModel& model, void* context) {
+        static_cast<ScreenRenderer*>(context)->draw(model);
+    }
+
+    void ScreenRenderer::clearBox(int x, int y, int w, int h) {
+        m_u8g2.setDrawColor(0);
+        m_u8g2.drawBox(x, y, w, h);
+        m_u8g2.setDrawColor(1);
+    }
+
+    void ScreenRenderer::draw(const ScreenModel& model) {
+        m_stats.frames++;
+
+        const bool full = !m_valid || model.screen != m_drawn.screen || model.ping.full_screen ||
+                          m_drawn.ping.full_screen;
+        auto changed = [&](Section section) {
+            return full || model.getRevision(section) != m_drawn.getRevision(section);
+        };
+        auto region = [&](bool dirty) {
+            if (dirty) {
+                m_stats.regions_drawn++;
+            } else {
+                m_stats.regions_skipped++;
+            }
+            return dirty;
+        };
+
+        if (full) {
+            m_stats.full_redraws++;
+            m_u8g2.clearBuffer();
+        }
+
+        if (model.ping.full_screen) {
+            drawFullScreenPing();
+        } else {
+            if (region(changed(Section::HEADER) || changed(Section::PING))) {
+                drawHeader(model);
+            }
+
+            switch (model.screen) {
+                case Screen::SIGNAL:
+                    if (region(changed(Section::SIGNAL) || changed(Section::RADIO))) {
+                        drawSignal(model);
+                    }
+                    if (region(changed(Section::RADIO))) {
+                        drawRadio(model);
+                    }
+                    break;
+                case Screen::NETWORK:
+                    if (region(changed(Section::NETWORK))) {
+                        drawNetwork(model);
+                    }
+                    break;
+                case Screen::NODES:
+                    if (region(changed(Section::NODES))) {
+                        drawNodes(model);
+                    }
+                    break;
+                case Screen::STORM:
+                    if (region(changed(Section::STORM))) {
+                        drawStorm(model);
+                    }
+                    break;
+                default:
+                    break;
+            }
+
+            if (region(changed(Section::NETWORK) || changed(Section::BATTERY))) {
+                drawStatusBar(model);
+            }
+        }
+
+        memcpy(&m_drawn, &model, sizeof(m_drawn));
+        m_valid = true;
+    }
+
+    void ScreenRenderer::drawHeader(const ScreenModel& model) {
+        clearBox(0, HEADER_Y, WIDTH, HEADER_H);
+        m_u8g2.setFont(u8g2_font_6x10_tr);
+
+        // Warnings and errors stand out in inverse video
+        const bool urgent = model.header.message && model.header.priority >= MessagePriority::WARNING;
+        if (urgent) {
+            m_u8g2.drawBox(0, 2, WIDTH, 13);
+            m_u8g2.setDrawColor(0);
+        }
+        if (model.header.line1[0]) m_u8g2.drawStr(2, 12, model.header.line1);
+        m_u8g2.setDrawColor(1);
+
+        if (model.header.line2[0]) m_u8g2.drawStr(2, 32, model.header.line2);
+
+        if (model.ping.dot) {
+            m_u8g2.setDrawColor(urgent ? 0 : 1);
+            m_u8g2.drawDisc(55, 12, 4);
+            m_u8g2.setDrawColor(1);
+        }
+    }
+
+    void ScreenRenderer::drawSignal(const ScreenModel& model) {
+        clearBox(0, UPPER_Y, WIDTH, UPPER_H);
+        if (model.radio.sender || !model.signal.valid) {
+            return;
+        }
+        m_u8g2.setFont(u8g2_font_6x10_tr);
+        char text[16];
+        snprintf(text, sizeof(text), "RSSI: %d", model.signal.rssi_dbm);
+        m_u8g2.drawStr(2, 51, text);
+        const int snr = model.signal.snr_x10;
+        snprintf(text, sizeof(text), "SNR: %s%d.%d", snr < 0 ? "-" : "", (snr < 0 ? -snr : snr) / 10,
+                 (snr < 0 ? -snr : snr) % 10);
+        m_u8g2.drawStr(2, 65, text);
+    }
+
+    void ScreenRenderer::drawRadio(const ScreenModel& model) {
+        clearBox(0, LOWER_Y, WIDTH, LOWER_H);
+        m_u8g2.setFont(u8g2_font_6x10_tr);
+        char text[16];
+        snprintf(text, sizeof(text), "SF%d BW%u", model.radio.spreading_factor, (unsigned)model.radio.bandwidth_khz);
+        m_u8g2.drawStr(2, 81, text);
+        snprintf(text, sizeof(text), "%s %u.%uMHz", model.radio.sender ? "TX" : "RX",
+                 (unsigned)(model.radio.frequency_x10 / 10), (unsigned)(model.radio.frequency_x10 % 10));
+        m_u8g2.drawStr(2, 95, text);
+    }
+
+    void ScreenRenderer::drawNetwork(const ScreenModel& model) {
+        clearBox(0, BODY_Y, WIDTH, BODY_H);
+        m_u8g2.setFont(u8g2_font_6x10_tr);
+        if (!model.network.connected) {
+            m_u8g2.drawStr(2, 51, "No WiFi");
+        } else {
+            m_u8g2.drawStr(2, 51, model.network.location);
+            char ip[16];
+            snprintf(ip, sizeof(ip), "%u.%u.%u.%u", model.network.ip[0], model.network.ip[1], model.network.ip[2],
+                     model.network.ip[3]);
+            m_u8g2.setFont(u8g2_font_4x6_tr);          // A full dotted quad fits at 4 px
+            m_u8g2.drawStr(2, 62, ip);
+            m_u8g2.setFont(u8g2_font_6x10_tr);
+        }
+        m_u8g2.drawStr(2, 81, model.network.ota_active ? "OTA busy" : "OTA idle");
+        if (model.network.lora_ota_active) {
+            m_u8g2.drawStr(2, 95, "LoRa OTA");
+        }
+    }
+
+    void ScreenRenderer::drawNodes(const ScreenModel& model) {
+        clearBox(0, BODY_Y, WIDTH, BODY_H);
+        m_u8g2.setFont(u8g2_font_5x7_tr);
+        if (model.nodes.count == 0) {
+            m_u8g2.drawStr(2, 51, "No nodes");
+            return;
+        }
+        for (uint8_t i = 0; i < model.nodes.count && i < MAX_NODES; i++) {
+            const NodeEntry& node = model.nodes.entries[i];
+            char age[6];
+            formatAge(age, sizeof(age), node.age_s);
+            char row[24];
+            snprintf(row, sizeof(row), "%04X%4d %s", (unsigned)node.id, node.rssi_dbm, age);
+            m_u8g2.drawStr(2, 47 + i * 10, row);
+        }
+    }
+
+    void ScreenRenderer::drawStorm(const ScreenModel& model) {
+        clearBox(0, BODY_Y, WIDTH, BODY_H);
+        m_u8g2.setFont(u8g2_font_6x10_tr);
+        if (!model.storm.active) {
+            m_u8g2.drawStr(2, 51, "No storm");
+            return;
+        }
+        char text[16];
+        if (model.storm.distance_km >= Sensors::STORM_OUT_OF_RANGE_KM) {
+            snprintf(text, sizeof(text), ">40 km");
+        } else {
+            snprintf(text, sizeof(text), "%u km", (unsigned)model.storm.distance_km);
+        }
+        m_u8g2.drawStr(2, 51, text);
+        snprintf(text, sizeof(text), "%u.%u/min", (unsigned)(model.storm.rate_x10 / 10),
+                 (unsigned)(model.storm.rate_x10 % 10));
+        m_u8g2.drawStr(2, 65, text);
+        m_u8g2.drawStr(2, 81, motionToString(model.storm.motion));
+        if (model.storm.eta_min >= 0) {
+            snprintf(text, sizeof(text), "ETA %dm", model.storm.eta_min);
+            m_u8g2.drawStr(2, 95, text);
+        } else {
+            snprintf(text, sizeof(text), "N %lu", (unsigned long)model.storm.strikes);
+            m_u8g2.drawStr(2, 95, text);
+        }
+    }
+
+    void ScreenRenderer::drawStatusBar(const ScreenModel& model) {
+        clearBox(0, STATUS_Y, WIDTH, STATUS_H);
+        m_u8g2.setFont(u8g2_font_5x7_tr);
+
+        const int yPos = 120;
+        int xPos = 2;
+
+        if (model.network.connected) {
+            char ip[16];
+            snprintf(ip, sizeof(ip), "%u.%u.%u.%u", model.network.ip[0], model.network.ip[1], model.network.ip[2],
+                     model.network.ip[3]);
+            const size_t length = strlen(ip);
+            const size_t offset = model.network.scroll < length ? model.network.scroll : 0;
+            char visible[13];
+            strncpy(visible, ip + offset, sizeof(visible) - 1);
+            visible[sizeof(visible) - 1] = '\0';
+            m_u8g2.drawStr(xPos, yPos - 10, visible);
+
+            m_u8g2.drawStr(xPos, yPos, model.network.location);
+            xPos += strlen(model.network.location) * 6;
+        } else {
+            m_u8g2.drawStr(xPos, yPos, "NoWiFi");
+            xPos += 20;
+        }
+        if (model.network.ota_active) {
+            m_u8g2.drawStr(xPos, yPos, "OTA");
+            xPos += 20;
+        }
+        if (model.network.lora_ota_active) {
+            m_u8g2.drawStr(xPos, yPos, "LoRaOTA");
+        }
+
+        // Battery right-aligned, 6 px per character
+        char battery[8];
+        snprintf(battery, sizeof(battery), "%u%%", (unsigned)model.battery_percent);
+        int drawX = 62 - static_cast<int>(strlen(battery)) * 6;
+        if (drawX < xPos) {
+            drawX = xPos;
+        }
+        m_u8g2.drawStr(drawX, yPos, battery);
+    }
+
+    void ScreenRenderer::drawFullScreenPing() {
+        m_u8g2.setFont(u8g2_font_ncenB14_tr);
+        m_u8g2.setDrawColor(1);
+
+        const int textWidth = m_u8g2.getStrWidth("PING");
+        const int x = (m_u8g2.getDisplayWidth() - textWidth) / 2;
+        const int y = (m_u8g2.getDisplayHeight() + 14) / 2;
+        m_u8g2.drawStr(x, y, "PING");
+        m_u8g2.drawCircle(m_u8g2.getDisplayWidth() / 2, m_u8g2.getDisplayHeight() / 2, 25);
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "screen_model.h"
+
+class U8G2;
+
+namespace Display {
+
+    struct ScreenRenderStats {
+        uint32_t frames;
+        uint32_t full_redraws;              // Screen switch, first frame, full-screen ping
+        uint32_t regions_drawn;
+        uint32_t regions_skipped;           // Revisions unchanged since the last frame
+    };
+
+    // Draws a ScreenModel into a U8g2 full frame buffer in portrait (U8G2_R1)
+    // layout. Keeps the last model it drew and repaints only the regions
+    // whose section revisions moved: a new RSSI reformats two lines instead
+    // of the whole screen, and the dirty-tile flush then sends just those
+    // tiles.
+    class ScreenRenderer {
+    public:
+        explicit ScreenRenderer(U8G2& u8g2);
+
+        // Frame buffer contents unknown: the next draw repaints everything
+        void invalidate() { m_valid = false; }
+
+        void draw(const ScreenModel& model);
+
+        // ScreenDrawFn adapter; context is the ScreenRenderer
+        static void drawCallback(const ScreenModel& model, void* context);
+
+        const ScreenRenderStats& getStats() const { return m_stats; }
+        void resetStats() { m_stats = ScreenRenderStats(); }
+
+    private:
+        U8G2& m_u8g2;
+        ScreenModel m_drawn;
+        bool m_valid;
+        ScreenRenderStats m_stats;
+
+        void clearBox(int x, int y, int w, int h);
+        void drawHeader(const ScreenModel& model);
+        void drawSignal(const ScreenModel& model);
+        void drawRadio(const ScreenModel& model);
+        void drawNetwork(const ScreenModel& model);
+        void drawNodes(const ScreenModel& model);
+        void drawStorm(const ScreenModel& model);
+        void drawStatusBar(const ScreenModel& model);
+        void drawFullScreenPing();
+    };
+}
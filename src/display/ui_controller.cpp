@@ -0,0 +1,140 @@
+#include "ui_controller.h"
+#include "../sensors/button_input.h"
+#include "../hardware/hardware_abstraction.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+namespace Display {
+
+    namespace Timer = HardwareAbstraction::Timer;
+
+    UiControllerConfig getDefaultUiControllerConfig() {
+        UiControllerConfig config;
+        config.idle_timeout_ms = 10000;
+        config.interactive_timeout_ms = 30000;
+        config.sleep_message_ms = 1000;
+        config.sleep_max_wait_ms = 5000;
+        config.sleep_retry_ms = 100;
+        return config;
+    }
+
+    UiController::UiController(ScreenState& screen, UiTimeline& timeline, const UiControllerConfig& config)
+        : m_screen(screen), m_timeline(timeline), m_config(config), m_hooks(), m_lastPressMs(0), m_idle(false),
+          m_idleStartMs(0), m_sleepRequested(false), m_sleepRequestedMs(0) {}
+
+    void UiController::begin(uint32_t nowMs) {
+        m_lastPressMs = nowMs;
+        m_idle = false;
+        m_idleStartMs = 0;
+    }
+
+    void UiController::serviceButton(Sensors::ButtonInput& button, bool sender, uint32_t nowMs) {
+        // Edges were stamped in the ISR; durations do not depend on loop latency
+        button.update(Timer::micros());
+
+        Sensors::ButtonEvent event;
+        while (button.poll(event)) {
+#ifdef ARDUINO
+            Serial.printf("[BTN] Press %lu ms, action %d (role: %s)\n", (unsigned long)event.duration_ms,
+                          (int)event.action, sender ? "Sender" : "Receiver");
+#endif
+            if (event.action == ButtonAction::Ignore) {
+                continue;
+            }
+            handleAction(event.action, sender, nowMs);
+        }
+    }
+
+    void UiController::handleAction(ButtonAction action, bool sender, uint32_t nowMs) {
+        // Any press is activity and leaves idle mode
+        m_lastPressMs = nowMs;
+        if (m_idle) {
+            m_idle = false;
+#ifdef ARDUINO
+            Serial.println("[IDLE] Exiting idle mode due to button press");
+#endif
+            showMessage("Interactive", "Mode");
+        }
+
+        switch (action) {
+            case ButtonAction::CyclePreset: {
+                const char* name = m_hooks.cyclePreset ? m_hooks.cyclePreset(sender) : nullptr;
+                if (name) {
+                    showMessage("Preset", name);
+                }
+                break;
+            }
+            case ButtonAction::SleepMode:
+#ifdef ARDUINO
+                Serial.println("Sleep mode requested");
+#endif
+                requestSleep(nowMs);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void UiController::checkIdle(uint32_t nowMs) {
+        if (!m_idle && nowMs - m_lastPressMs > m_config.idle_timeout_ms) {
+            m_idle = true;
+            m_idleStartMs = nowMs;
+#ifdef ARDUINO
+            Serial.println("[IDLE] Entering full-screen ping flash mode");
+#endif
+            showMessage("Idle Mode", "Full Screen");
+        }
+
+        if (m_idle && nowMs - m_idleStartMs > m_config.interactive_timeout_ms) {
+            m_idle = false;
+#ifdef ARDUINO
+            Serial.println("[IDLE] Returning to full-screen ping flash mode");
+#endif
+            showMessage("Idle Mode", "Full Screen");
+        }
+    }
+
+    void UiController::requestSleep(uint32_t nowMs) {
+        if (m_sleepRequested) {
+            return;
+        }
+        m_sleepRequested = true;
+        m_sleepRequestedMs = nowMs;
+#ifdef ARDUINO
+        Serial.println("[SLEEP] Entering deep sleep mode...");
+#endif
+        if (m_hooks.prepareSleep) {
+            m_hooks.prepareSleep();
+        }
+
+        // The panel goes dark once the message has had its hold time on
+        // screen; the loop keeps serving until then
+        showMessage("Sleep Mode", "Entering...", m_config.sleep_message_ms);
+        m_timeline.schedule(nowMs, m_config.sleep_message_ms, sleepNow, this, "deep sleep");
+    }
+
+    void UiController::commitSleep(uint32_t nowMs) {
+        // The sleep message may have queued behind another one; give it up
+        // to sleep_max_wait_ms to be seen
+        if (m_screen.messagesPending(nowMs) && nowMs - m_sleepRequestedMs < m_config.sleep_max_wait_ms) {
+            m_timeline.schedule(nowMs, m_config.sleep_retry_ms, sleepNow, this, "deep sleep");
+            return;
+        }
+        if (m_hooks.powerDown) {
+            m_hooks.powerDown();
+        }
+    }
+
+    void UiController::sleepNow(void* context) {
+        static_cast<UiController*>(context)->commitSleep(Timer::millis());
+    }
+
+    void UiController::showMessage(const char* line1, const char* line2, uint32_t holdMs) {
+        m_screen.showMessage(line1, line2, MessagePriority::STATUS, holdMs);
+        if (m_hooks.messageShown) {
+            m_hooks.messageShown();
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../app_logic.h"
+#include "screen_model.h"
+#include "ui_timeline.h"
+
+namespace Sensors {
+    class ButtonInput;
+}
+
+namespace Display {
+
+    struct UiControllerConfig {
+        uint32_t idle_timeout_ms;           // No press for this long: full-screen ping mode
+        uint32_t interactive_timeout_ms;    // Idle mode hands back to the normal screens after this
+        uint32_t sleep_message_ms;          // "Sleep Mode" hold before the panel goes dark
+        uint32_t sleep_max_wait_ms;         // Longest wait for a sleep message queued behind others
+        uint32_t sleep_retry_ms;
+    };
+
+    UiControllerConfig getDefaultUiControllerConfig();
+
+    // What the controller asks of the firmware; any may be nullptr
+    struct UiControllerHooks {
+        // Applies and persists the next LoRa preset and returns its short
+        // name; broadcast = announce it to the receivers (sender role)
+        const char* (*cyclePreset)(bool broadcast);
+        void (*prepareSleep)();             // Save state while the sleep message shows
+        void (*powerDown)();                // Panel off, wake-up sources, deep sleep
+        void (*messageShown)();             // Push the screen model to the display
+    };
+
+    // Button actions, idle mode and the two-step sleep (request, then power
+    // down once the message has been seen). Nothing here waits: messages
+    // hold on the ScreenState and deferred steps go on the UiTimeline, so
+    // loop() keeps serving the radio and web server throughout.
+    class UiController {
+    public:
+        UiController(ScreenState& screen, UiTimeline& timeline,
+                     const UiControllerConfig& config = getDefaultUiControllerConfig());
+
+        void setHooks(const UiControllerHooks& hooks) { m_hooks = hooks; }
+
+        // Interactive, with the idle timeout running from nowMs
+        void begin(uint32_t nowMs);
+
+        // Settles the button and acts on every completed press
+        void serviceButton(Sensors::ButtonInput& button, bool sender, uint32_t nowMs);
+        void handleAction(ButtonAction action, bool sender, uint32_t nowMs);
+
+        void checkIdle(uint32_t nowMs);
+
+        // Shows the sleep message and schedules the power-down; repeats are
+        // ignored while on the way down
+        void requestSleep(uint32_t nowMs);
+
+        bool isIdle() const { return m_idle; }
+        bool isSleepRequested() const { return m_sleepRequested; }
+        uint32_t getSleepRequestedMs() const { return m_sleepRequestedMs; }
+
+    private:
+        ScreenState& m_screen;
+        UiTimeline& m_timeline;
+        UiControllerConfig m_config;
+        UiControllerHooks m_hooks;
+
+        uint32_t m_lastPressMs;
+        bool m_idle;
+        uint32_t m_idleStartMs;
+        bool m_sleepRequested;
+        uint32_t m_sleepRequestedMs;
+
+        void showMessage(const char* line1, const char* line2, uint32_t holdMs = 0);
+        void commitSleep(uint32_t nowMs);
+        static void sleepNow(void* context);
+    };
+}
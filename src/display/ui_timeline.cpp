@@ -0,0 +1,119 @@
+#include "ui_timeline.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+namespace Display {
+
+    namespace {
+        // Wrap-safe: true once now has reached due
+        bool reached(uint32_t nowMs, uint32_t dueMs) {
+            return static_cast<int32_t>(nowMs - dueMs) >= 0;
+        }
+    }
+
+    UiTimeline::UiTimeline() : m_entries(), m_count(0), m_nextId(1), m_stats() {}
+
+    uint16_t UiTimeline::schedule(uint32_t nowMs, uint32_t delayMs, UiAction action, void* context,
+                                  const char* label) {
+        if (action == nullptr || m_count >= CAPACITY) {
+            m_stats.rejected++;
+            return 0;
+        }
+
+        Entry& entry = m_entries[m_count++];
+        entry.due_ms = nowMs + delayMs;
+        entry.action = action;
+        entry.context = context;
+        entry.label = label ? label : "";
+        entry.id = m_nextId;
+        entry.armed = false;
+        m_nextId = static_cast<uint16_t>(m_nextId + 1);
+        if (m_nextId == 0) {
+            m_nextId = 1;                   // 0 means "not scheduled"
+        }
+        m_stats.scheduled++;
+        return entry.id;
+    }
+
+    bool UiTimeline::cancel(uint16_t id) {
+        for (size_t i = 0; i < m_count; i++) {
+            if (m_entries[i].id == id) {
+                removeAt(i);
+                m_stats.cancelled++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool UiTimeline::isPending(uint16_t id) const {
+        for (size_t i = 0; i < m_count; i++) {
+            if (m_entries[i].id == id) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t UiTimeline::poll(uint32_t nowMs) {
+        // Only entries present on entry may fire, not ones an action adds
+        for (size_t i = 0; i < m_count; i++) {
+            m_entries[i].armed = true;
+        }
+
+        size_t fired = 0;
+        while (true) {
+            size_t earliest = m_count;
+            for (size_t i = 0; i < m_count; i++) {
+                const Entry& entry = m_entries[i];
+                if (!entry.armed || !reached(nowMs, entry.due_ms)) {
+                    continue;
+                }
+                if (earliest == m_count) {
+                    earliest = i;
+                    continue;
+                }
+                // Earlier due time first, scheduling order among equals
+                const int32_t diff = static_cast<int32_t>(entry.due_ms - m_entries[earliest].due_ms);
+                if (diff < 0 || (diff == 0 && entry.id < m_entries[earliest].id)) {
+                    earliest = i;
+                }
+            }
+            if (earliest == m_count) {
+                break;
+            }
+
+            const Entry entry = m_entries[earliest];
+            removeAt(earliest);
+            const uint32_t lateMs = nowMs - entry.due_ms;
+            if (lateMs > m_stats.max_late_ms) {
+                m_stats.max_late_ms = lateMs;
+            }
+            m_stats.fired++;
+            fired++;
+#ifdef ARDUINO
+            Serial.printf("[UI] %s (%lu ms late)\n", entry.label, (unsigned long)lateMs);
+#endif
+            entry.action(entry.context);
+        }
+        return fired;
+    }
+
+    uint32_t UiTimeline::msUntilNext(uint32_t nowMs) const {
+        uint32_t best = UINT32_MAX;
+        for (size_t i = 0; i < m_count; i++) {
+            const uint32_t wait = reached(nowMs, m_entries[i].due_ms) ? 0 : m_entries[i].due_ms - nowMs;
+            if (wait < best) {
+                best = wait;
+            }
+        }
+        return best;
+    }
+
+    void UiTimeline::removeAt(size_t index) {
+        m_entries[index] = m_entries[m_count - 1];
+        m_count--;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Display {
+
+    typedef void (*UiAction)(void* context);
+
+    struct UiTimelineStats {
+        uint32_t scheduled;
+        uint32_t fired;
+        uint32_t cancelled;
+        uint32_t rejected;                  // Timeline full
+        uint32_t max_late_ms;               // Worst delay between due time and firing
+    };
+
+    // One-shot actions that must wait for something the user should see
+    // first (a "Sleep Mode" message before the panel goes dark, "Rebooting"
+    // before a restart). The loop polls the timeline instead of sleeping
+    // through the wait, so radio, web server and button keep running while
+    // the display task holds the message on screen.
+    class UiTimeline {
+    public:
+        static constexpr size_t CAPACITY = 8;
+
+        UiTimeline();
+
+        // Runs action once delayMs has passed since nowMs. Returns an id for
+        // cancel(), 0 if the timeline is full. label names the action in logs.
+        uint16_t schedule(uint32_t nowMs, uint32_t delayMs, UiAction action, void* context, const char* label);
+        bool cancel(uint16_t id);
+        bool isPending(uint16_t id) const;
+
+        // Fires due actions, earliest first; returns how many ran. An action
+        // may schedule further ones, which wait for the next poll.
+        size_t poll(uint32_t nowMs);
+
+        // Milliseconds until the next action is due, UINT32_MAX if none
+        uint32_t msUntilNext(uint32_t nowMs) const;
+
+        size_t size() const { return m_count; }
+        const UiTimelineStats& getStats() const { return m_stats; }
+
+    private:
+        struct Entry {
+            uint32_t due_ms;
+            UiAction action;
+            void* context;
+            const char* label;
+            uint16_t id;
+            bool armed;                     // Present when the current poll started
+        };
+
+        Entry m_entries[CAPACITY];          // Unordered; CAPACITY is tiny
+        size_t m_count;
+        uint16_t m_nextId;
+        UiTimelineStats m_stats;
+
+        void removeAt(size_t index);
+    };
+}
@@ -0,0 +1,456 @@
+#include "adc_continuous.h"
+
+#include <cmath>
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <driver/adc.h>
+#include <esp_adc_cal.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#endif
+
+namespace HardwareAbstraction {
+
+    // Continuous sampler shared by the HAL one-shot reads and the sensors
+    ContinuousAdc g_continuousAdc;
+
+#ifdef ARDUINO
+    static portMUX_TYPE s_ringLock = portMUX_INITIALIZER_UNLOCKED;
+    static esp_adc_cal_characteristics_t s_chars;
+    static constexpr size_t MAX_FRAME_BYTES = 512;
+
+    static void lockRings() { portENTER_CRITICAL(&s_ringLock); }
+    static void unlockRings() { portEXIT_CRITICAL(&s_ringLock); }
+#else
+    static void lockRings() {}
+    static void unlockRings() {}
+#endif
+
+    ContinuousAdcConfig getDefaultContinuousAdcConfig() {
+        ContinuousAdcConfig config;
+        config.priority = 2;                // Above the display task, below loop()
+        config.stack_size = 3072;
+        config.core = 0;                    // Arduino loop() runs on core 1
+        config.frame_bytes = 256;           // 64 conversions per interrupt
+        config.dma_buffer_bytes = 1024;
+        return config;
+    }
+
+    ContinuousAdc::ContinuousAdc()
+        : m_channels(), m_channelCount(0), m_running(false), m_generation(0), m_controllerHz(0),
+          m_config(getDefaultContinuousAdcConfig()), m_stats(), m_task(nullptr), m_nextConversionUs(0), m_phase(0),
+          m_nextSlot(0), m_stopRequested(false) {}
+
+    int ContinuousAdc::indexOf(uint8_t pin) const {
+        for (size_t i = 0; i < m_channelCount; i++) {
+            if (m_channels[i].pin == pin) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    Result ContinuousAdc::addChannel(uint8_t pin, uint32_t rateHz) {
+        if (m_running) {
+            return Result::ERROR_INVALID_PARAMETER;
+        }
+        // ESP32-S3 ADC1 is GPIO1-10
+        if (pin < 1 || pin > 10 || rateHz == 0) {
+            return Result::ERROR_INVALID_PARAMETER;
+        }
+        const int existing = indexOf(pin);
+        if (existing >= 0) {
+            m_channels[existing].rate_hz = rateHz;
+            return Result::SUCCESS;
+        }
+        if (m_channelCount >= MAX_CHANNELS) {
+            return Result::ERROR_INVALID_PARAMETER;
+        }
+        Channel& channel = m_channels[m_channelCount++];
+        memset(&channel, 0, sizeof(channel));
+        channel.pin = pin;
+        channel.rate_hz = rateHz;
+        return Result::SUCCESS;
+    }
+
+    void ContinuousAdc::clearChannels() {
+        if (!m_running) {
+            m_channelCount = 0;
+        }
+    }
+
+    // One controller rate for the whole pattern, fast enough for the most
+    // demanding channel; slower channels average several conversions per
+    // output instead
+    void ContinuousAdc::planRates() {
+        uint32_t maxRate = 0;
+        for (size_t i = 0; i < m_channelCount; i++) {
+            if (m_channels[i].rate_hz > maxRate) {
+                maxRate = m_channels[i].rate_hz;
+            }
+        }
+        uint64_t controller = static_cast<uint64_t>(maxRate) * m_channelCount;
+        if (controller < MIN_CONTROLLER_HZ) controller = MIN_CONTROLLER_HZ;
+        if (controller > MAX_CONTROLLER_HZ) controller = MAX_CONTROLLER_HZ;
+        m_controllerHz = static_cast<uint32_t>(controller);
+
+        const float perChannel = static_cast<float>(m_controllerHz) / static_cast<float>(m_channelCount);
+        for (size_t i = 0; i < m_channelCount; i++) {
+            Channel& channel = m_channels[i];
+            const long decimation = std::lround(perChannel / static_cast<float>(channel.rate_hz));
+            channel.decimation = decimation < 1 ? 1 : static_cast<uint32_t>(decimation);
+            channel.pending = 0;
+            channel.sum = 0;
+            channel.written = 0;
+        }
+    }
+
+    float ContinuousAdc::getEffectiveRate(uint8_t pin) const {
+        const int index = indexOf(pin);
+        if (index < 0 || m_controllerHz == 0) {
+            return 0.0f;
+        }
+        return static_cast<float>(m_controllerHz) / static_cast<float>(m_channelCount) /
+               static_cast<float>(m_channels[index].decimation);
+    }
+
+    Result ContinuousAdc::start(const ContinuousAdcConfig& config) {
+        if (m_running) {
+            return Result::SUCCESS;
+        }
+        if (m_channelCount == 0) {
+            return Result::ERROR_INVALID_PARAMETER;
+        }
+        m_config = config;
+        m_stats = ContinuousAdcStats();
+        planRates();
+
+#ifdef ARDUINO
+        if (m_config.frame_bytes > MAX_FRAME_BYTES) {
+            m_config.frame_bytes = MAX_FRAME_BYTES;
+        }
+
+        adc_digi_init_config_t init = {};
+        init.max_store_buf_size = m_config.dma_buffer_bytes;
+        init.conv_num_each_intr = m_config.frame_bytes;
+        adc_digi_pattern_config_t pattern[MAX_CHANNELS] = {};
+        for (size_t i = 0; i < m_channelCount; i++) {
+            const uint8_t channel = m_channels[i].pin - 1;   // GPIOn -> ADC1_CHANNEL_(n-1)
+            init.adc1_chan_mask |= 1u << channel;
+            pattern[i].atten = ADC_ATTEN_DB_12;
+            pattern[i].channel = channel;
+            pattern[i].unit = 0;                               // ADC1
+            pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+        }
+        if (adc_digi_initialize(&init) != ESP_OK) {
+            return Result::ERROR_INIT_FAILED;
+        }
+
+        adc_digi_configuration_t digi = {};
+        digi.conv_limit_en = false;
+        digi.conv_limit_num = 250;
+        digi.pattern_num = m_channelCount;
+        digi.adc_pattern = pattern;
+        digi.sample_freq_hz = m_controllerHz;
+        digi.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+        digi.format = ADC_DIGI_OUTPUT_FORMAT_TYPE2;
+        if (adc_digi_controller_configure(&digi) != ESP_OK || adc_digi_start() != ESP_OK) {
+            adc_digi_deinitialize();
+            return Result::ERROR_INIT_FAILED;
+        }
+        esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_12, ADC_WIDTH_BIT_12, 1100, &s_chars);
+
+        m_stopRequested = false;
+        m_running = true;
+        m_generation++;
+        TaskHandle_t handle = nullptr;
+        const BaseType_t core = m_config.core < 0 ? tskNO_AFFINITY : m_config.core;
+        if (xTaskCreatePinnedToCore(taskEntry, "adc_dma", m_config.stack_size, this, m_config.priority, &handle,
+                                    core) != pdPASS) {
+            stop();
+            return Result::ERROR_INIT_FAILED;
+        }
+        m_task = handle;
+        Serial.printf("[ADC] Continuous: %u channel(s) at %lu Hz\n", (unsigned)m_channelCount,
+                      (unsigned long)m_controllerHz);
+#else
+        m_nextConversionUs = Timer::micros();
+        m_phase = 0;
+        m_nextSlot = 0;
+        m_running = true;
+        m_generation++;
+#endif
+        return Result::SUCCESS;
+    }
+
+    void ContinuousAdc::stop() {
+        if (!m_running) {
+            return;
+        }
+#ifdef ARDUINO
+        if (m_task) {
+            // The task leaves its read loop within one timeout and clears m_task
+            m_stopRequested = true;
+            for (int i = 0; i < 50 && m_task; i++) {
+                vTaskDelay(pdMS_TO_TICKS(10));
+            }
+        }
+        adc_digi_stop();
+        adc_digi_deinitialize();
+#endif
+        m_running = false;
+        m_generation++;
+    }
+
+#ifdef ARDUINO
+    void ContinuousAdc::taskEntry(void* self) {
+        ContinuousAdc* adc = static_cast<ContinuousAdc*>(self);
+        while (!adc->m_stopRequested) {
+            adc->drain(20);
+        }
+        adc->m_task = nullptr;
+        vTaskDelete(nullptr);
+    }
+
+    void ContinuousAdc::drain(uint32_t timeoutMs) {
+        uint8_t frame[MAX_FRAME_BYTES];
+        uint32_t length = 0;
+        const esp_err_t ret = adc_digi_read_bytes(frame, m_config.frame_bytes, &length, timeoutMs);
+        if (ret == ESP_ERR_INVALID_STATE) {
+            m_stats.dma_overflows++;        // Data is still returned
+        } else if (ret != ESP_OK) {
+            return;
+        }
+
+        // The frame ends at about now; earlier entries are one period apart
+        const uint32_t nowUs = micros();
+        const uint32_t periodUs = 1000000UL / m_controllerHz;
+        const uint32_t entries = length / SOC_ADC_DIGI_RESULT_BYTES;
+        for (uint32_t i = 0; i < entries; i++) {
+            const adc_digi_output_data_t* entry =
+                reinterpret_cast<const adc_digi_output_data_t*>(&frame[i * SOC_ADC_DIGI_RESULT_BYTES]);
+            const int slot = entry->type2.unit == 0 ? indexOf(entry->type2.channel + 1) : -1;
+            if (slot < 0) {
+                m_stats.bad_entries++;
+                continue;
+            }
+            pushConversion(static_cast<size_t>(slot), entry->type2.data, nowUs - (entries - 1 - i) * periodUs);
+        }
+    }
+#endif
+
+    void ContinuousAdc::advanceConversion() {
+        m_nextConversionUs += 1000000UL / m_controllerHz;
+        m_phase += 1000000UL % m_controllerHz;
+        if (m_phase >= m_controllerHz) {
+            m_phase -= m_controllerHz;
+            m_nextConversionUs++;
+        }
+        m_nextSlot = (m_nextSlot + 1) % m_channelCount;
+    }
+
+    void ContinuousAdc::service() {
+#ifndef ARDUINO
+        if (!m_running) {
+            return;
+        }
+        const uint32_t now = Timer::micros();
+        if (static_cast<int32_t>(now - m_nextConversionUs) < 0) {
+            return;
+        }
+
+        // Only the conversions that can still reach a ring matter; after a
+        // long gap, jump ahead in whole pattern cycles and start fresh windows
+        uint32_t maxDecimation = 1;
+        for (size_t i = 0; i < m_channelCount; i++) {
+            if (m_channels[i].decimation > maxDecimation) {
+                maxDecimation = m_channels[i].decimation;
+            }
+        }
+        const uint64_t backlog = static_cast<uint64_t>(now - m_nextConversionUs) * m_controllerHz / 1000000ULL + 1;
+        const uint64_t needed = static_cast<uint64_t>(RING_SIZE + 1) * maxDecimation * m_channelCount;
+        if (backlog > needed) {
+            uint64_t skip = backlog - needed;
+            skip -= skip % m_channelCount;
+            const uint64_t skipUs = skip * 1000000ULL / m_controllerHz;
+            m_nextConversionUs += static_cast<uint32_t>(skipUs);
+            m_stats.skipped += static_cast<uint32_t>(skip);
+            for (size_t i = 0; i < m_channelCount; i++) {
+                m_channels[i].pending = 0;
+                m_channels[i].sum = 0;
+            }
+        }
+
+        while (static_cast<int32_t>(now - m_nextConversionUs) >= 0) {
+            const size_t slot = m_nextSlot;
+            const uint32_t at = m_nextConversionUs;
+            pushConversion(slot, Simulation::sampleAnalog(m_channels[slot].pin, at), at);
+            advanceConversion();
+        }
+#endif
+    }
+
+    void ContinuousAdc::pushConversion(size_t slot, uint16_t raw, uint32_t timestampUs) {
+        if (slot >= m_channelCount) {
+            m_stats.bad_entries++;
+            return;
+        }
+        Channel& channel = m_channels[slot];
+        m_stats.conversions++;
+        channel.sum += raw;
+        if (++channel.pending < channel.decimation) {
+            return;
+        }
+
+        ContinuousSample sample;
+        sample.raw = static_cast<uint16_t>((channel.sum + channel.pending / 2) / channel.pending);
+        sample.timestamp_us = timestampUs;
+        channel.pending = 0;
+        channel.sum = 0;
+
+        lockRings();
+        channel.ring[channel.written % RING_SIZE] = sample;
+        channel.written++;
+        unlockRings();
+        m_stats.outputs++;
+    }
+
+    bool ContinuousAdc::latest(uint8_t pin, uint16_t& raw) {
+        const int index = indexOf(pin);
+        if (index < 0) {
+            return false;
+        }
+        service();
+        const Channel& channel = m_channels[index];
+        bool found = false;
+        lockRings();
+        if (channel.written > 0) {
+            raw = channel.ring[(channel.written - 1) % RING_SIZE].raw;
+            found = true;
+        }
+        unlockRings();
+        return found;
+    }
+
+    float ContinuousAdc::toVolts(uint16_t raw) const {
+#ifdef ARDUINO
+        return esp_adc_cal_raw_to_voltage(raw, &s_chars) / 1000.0f;
+#else
+        return (raw / 4095.0f) * 3.3f;      // Same mapping as the native one-shot read
+#endif
+    }
+
+    bool ContinuousAdc::latestVoltage(uint8_t pin, float& volts) {
+        uint16_t raw = 0;
+        if (!latest(pin, raw)) {
+            return false;
+        }
+        volts = toVolts(raw);
+        return true;
+    }
+
+    size_t ContinuousAdc::average(uint8_t pin, size_t count, float& raw) {
+        const int index = indexOf(pin);
+        if (index < 0 || count == 0) {
+            return 0;
+        }
+        service();
+        const Channel& channel = m_channels[index];
+        uint32_t sum = 0;
+        size_t used = 0;
+        lockRings();
+        const uint32_t available = channel.written < RING_SIZE ? channel.written : RING_SIZE;
+        used = count < available ? count : available;
+        for (size_t i = 0; i < used; i++) {
+            sum += channel.ring[(channel.written - 1 - i) % RING_SIZE].raw;
+        }
+        unlockRings();
+        if (used > 0) {
+            raw = static_cast<float>(sum) / static_cast<float>(used);
+        }
+        return used;
+    }
+
+    size_t ContinuousAdc::readSince(uint8_t pin, uint32_t sinceUs, ContinuousSample* out, size_t maxCount) {
+        const int index = indexOf(pin);
+        if (index < 0 || maxCount == 0) {
+            return 0;
+        }
+        service();
+        const Channel& channel = m_channels[index];
+        size_t count = 0;
+        lockRings();
+        const uint32_t available = channel.written < RING_SIZE ? channel.written : RING_SIZE;
+
+        // Newest first until an old one, then hand them out oldest first
+        size_t newer = 0;
+        while (newer < available && newer < maxCount) {
+            const ContinuousSample& sample = channel.ring[(channel.written - 1 - newer) % RING_SIZE];
+            if (static_cast<int32_t>(sample.timestamp_us - sinceUs) <= 0) {
+                break;
+            }
+            newer++;
+        }
+        for (size_t i = 0; i < newer; i++) {
+            out[count++] = channel.ring[(channel.written - newer + i) % RING_SIZE];
+        }
+        unlockRings();
+        return count;
+    }
+
+#ifndef ARDUINO
+    namespace Simulation {
+
+        SignalGenerator::SignalGenerator()
+            : samples(0), m_dc(0.0f), m_wave(Wave::DC), m_amplitude(0.0f), m_frequency(0.0f), m_noise(0.0f),
+              m_rng(1) {}
+
+        SignalGenerator& SignalGenerator::dc(float volts) {
+            m_dc = volts;
+            return *this;
+        }
+
+        SignalGenerator& SignalGenerator::wave(Wave shape, float amplitudeVolts, float frequencyHz) {
+            m_wave = shape;
+            m_amplitude = amplitudeVolts;
+            m_frequency = frequencyHz;
+            return *this;
+        }
+
+        SignalGenerator& SignalGenerator::noise(float peakVolts, uint32_t seed) {
+            m_noise = peakVolts;
+            m_rng = seed ? seed : 1;
+            return *this;
+        }
+
+        float SignalGenerator::voltsAt(uint32_t nowUs) const {
+            const double phase = std::fmod(static_cast<double>(nowUs) * 1e-6 * m_frequency, 1.0);
+            switch (m_wave) {
+                case Wave::SINE:
+                    return m_dc + m_amplitude * static_cast<float>(std::sin(2.0 * M_PI * phase));
+                case Wave::SQUARE:
+                    return m_dc + (phase < 0.5 ? m_amplitude : -m_amplitude);
+                case Wave::DC:
+                default:
+                    return m_dc;
+            }
+        }
+
+        uint16_t SignalGenerator::sample(uint8_t, uint32_t nowUs) {
+            samples++;
+            float volts = voltsAt(nowUs);
+            if (m_noise > 0.0f) {
+                // xorshift32, uniform in [-noise, +noise]
+                m_rng ^= m_rng << 13;
+                m_rng ^= m_rng >> 17;
+                m_rng ^= m_rng << 5;
+                volts += m_noise * (static_cast<float>(m_rng) / 2147483648.0f - 1.0f);
+            }
+            const long code = std::lround(volts / 3.3f * 4095.0f);
+            return static_cast<uint16_t>(code < 0 ? 0 : (code > 4095 ? 4095 : code));
+        }
+    }
+#endif
+}
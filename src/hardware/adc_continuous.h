@@ -0,0 +1,160 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "hardware_abstraction.h"
+
+namespace HardwareAbstraction {
+
+    struct ContinuousAdcConfig {
+        uint8_t priority;                   // FreeRTOS priority of the DMA drain task
+        uint16_t stack_size;
+        int8_t core;                        // -1 = no affinity
+        uint16_t frame_bytes;               // DMA bytes per interrupt (4 per conversion)
+        uint16_t dma_buffer_bytes;          // Driver ring between interrupts and the task
+    };
+
+    ContinuousAdcConfig getDefaultContinuousAdcConfig();
+
+    // One decimated output: mean of `decimation` conversions, stamped with
+    // the time of the last of them
+    struct ContinuousSample {
+        uint16_t raw;
+        uint32_t timestamp_us;
+    };
+
+    struct ContinuousAdcStats {
+        uint32_t conversions;               // Raw conversions consumed
+        uint32_t outputs;                   // Decimated samples produced
+        uint32_t skipped;                   // Native: conversions skipped when catching up a long gap
+        uint32_t dma_overflows;             // Driver ring overran before the task drained it
+        uint32_t bad_entries;               // Conversions for channels not in the pattern
+    };
+
+    // ADC1 digital controller in continuous mode. The controller converts the
+    // registered channels round-robin at one rate into DMA; a task drains it
+    // and decimates each channel down to its own rate into a small ring. Reads
+    // only copy from the ring: no conversion, no attenuation setup, no wait.
+    //
+    // Natively the conversions are generated at their exact times on the
+    // simulated clock from Simulation analog sources, whenever a read or
+    // service() catches up.
+    class ContinuousAdc {
+    public:
+        static constexpr size_t MAX_CHANNELS = 6;
+        static constexpr size_t RING_SIZE = 32;             // Outputs kept per channel
+        static constexpr uint32_t MIN_CONTROLLER_HZ = 611;  // ESP32-S3 digital controller limits
+        static constexpr uint32_t MAX_CONTROLLER_HZ = 83333;
+
+        ContinuousAdc();
+
+        // Channels are fixed while running; ADC1 pins (GPIO1-10) only, since
+        // ADC2 is shared with WiFi
+        Result addChannel(uint8_t pin, uint32_t rateHz);
+        void clearChannels();
+
+        Result start(const ContinuousAdcConfig& config);
+        Result start() { return start(getDefaultContinuousAdcConfig()); }
+        void stop();
+        bool isRunning() const { return m_running; }
+
+        // Bumped on every start/stop; one-shot reads re-arm their channel
+        // setup when it changes
+        uint32_t getGeneration() const { return m_generation; }
+
+        bool hasChannel(uint8_t pin) const { return indexOf(pin) >= 0; }
+        uint32_t getControllerHz() const { return m_controllerHz; }
+        float getEffectiveRate(uint8_t pin) const;
+
+        // Newest output; false if the pin is not registered or has none yet
+        bool latest(uint8_t pin, uint16_t& raw);
+        bool latestVoltage(uint8_t pin, float& volts);
+        float toVolts(uint16_t raw) const;
+
+        // Mean of up to `count` newest outputs; returns how many were used
+        size_t average(uint8_t pin, size_t count, float& raw);
+
+        // Outputs stamped after sinceUs, oldest first
+        size_t readSince(uint8_t pin, uint32_t sinceUs, ContinuousSample* out, size_t maxCount);
+
+        // Moves converted data into the rings. The DMA task calls it on the
+        // device; natively reads call it, and tests may too.
+        void service();
+
+        const ContinuousAdcStats& getStats() const { return m_stats; }
+
+        // Conversion result for pattern slot `slot`, as parsed from DMA
+        void pushConversion(size_t slot, uint16_t raw, uint32_t timestampUs);
+
+    private:
+        struct Channel {
+            uint8_t pin;
+            uint32_t rate_hz;
+            uint32_t decimation;
+            uint32_t pending;
+            uint32_t sum;
+            uint32_t written;               // Outputs ever written; ring index = written % RING_SIZE
+            ContinuousSample ring[RING_SIZE];
+        };
+
+        Channel m_channels[MAX_CHANNELS];
+        size_t m_channelCount;
+        bool m_running;
+        uint32_t m_generation;
+        uint32_t m_controllerHz;
+        ContinuousAdcConfig m_config;
+        ContinuousAdcStats m_stats;
+        void* m_task;
+        uint32_t m_nextConversionUs;        // Native: time of the next simulated conversion
+        uint32_t m_phase;                   // Native: sub-microsecond remainder of the period
+        size_t m_nextSlot;
+        volatile bool m_stopRequested;
+
+        int indexOf(uint8_t pin) const;
+        void planRates();
+        void advanceConversion();
+
+#ifdef ARDUINO
+        static void taskEntry(void* self);
+        void drain(uint32_t timeoutMs);
+#endif
+    };
+
+    extern ContinuousAdc g_continuousAdc;
+
+#ifndef ARDUINO
+    namespace Simulation {
+
+        // Analog test signal: DC level plus optional sine or square wave and
+        // deterministic noise, clipped to the 12-bit range
+        class SignalGenerator : public AnalogSource {
+        public:
+            enum class Wave : uint8_t {
+                DC,
+                SINE,
+                SQUARE
+            };
+
+            SignalGenerator();
+
+            SignalGenerator& dc(float volts);
+            SignalGenerator& wave(Wave shape, float amplitudeVolts, float frequencyHz);
+            SignalGenerator& noise(float peakVolts, uint32_t seed = 1);
+
+            float voltsAt(uint32_t nowUs) const;
+            uint16_t sample(uint8_t pin, uint32_t nowUs) override;
+
+            uint32_t samples;
+
+        private:
+            float m_dc;
+            Wave m_wave;
+            float m_amplitude;
+            float m_frequency;
+            float m_noise;
+            uint32_t m_rng;
+        };
+    }
+#endif
+}
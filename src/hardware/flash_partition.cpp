@@ -0,0 +1,238 @@
+#include "flash_partition.h"
+
+#include <cstring>
+
+#ifdef ARDUINO
+#include <new>
+#include <esp_partition.h>
+#include <esp_spi_flash.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace HardwareAbstraction {
+
+#ifdef ARDUINO
+    namespace {
+        class EspFlashPartition : public FlashPartition {
+        public:
+            EspFlashPartition(const esp_partition_t* partition, const uint8_t* map)
+                : m_partition(partition), m_map(map) {}
+
+            size_t size() const override { return m_partition->size; }
+
+            Result read(size_t offset, void* data, size_t length) const override {
+                return esp_partition_read(m_partition, offset, data, length) == ESP_OK
+                    ? Result::SUCCESS : Result::ERROR_HARDWARE_FAULT;
+            }
+
+            Result write(size_t offset, const void* data, size_t length) override {
+                // Flash writes invalidate the cache lines of any mapping over
+                // the range, so the mapped view stays coherent
+                return esp_partition_write(m_partition, offset, data, length) == ESP_OK
+                    ? Result::SUCCESS : Result::ERROR_HARDWARE_FAULT;
+            }
+
+            Result eraseSector(size_t sector) override {
+                if (sector >= sectorCount()) {
+                    return Result::ERROR_INVALID_PARAMETER;
+                }
+                return esp_partition_erase_range(m_partition, sector * SECTOR_SIZE, SECTOR_SIZE) == ESP_OK
+                    ? Result::SUCCESS : Result::ERROR_HARDWARE_FAULT;
+            }
+
+            const uint8_t* data() const override { return m_map; }
+
+        private:
+            const esp_partition_t* m_partition;
+            const uint8_t* m_map;
+        };
+    }
+
+    FlashPartition* openFlashPartition(const char* label) {
+        const esp_partition_t* partition =
+            esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+        if (!partition) {
+            return nullptr;
+        }
+
+        // Uses MMU pages from the data window; the handle is never released
+        const void* map = nullptr;
+        spi_flash_mmap_handle_t handle;
+        if (esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA, &map, &handle) != ESP_OK) {
+            return nullptr;
+        }
+
+        return new (std::nothrow) EspFlashPartition(partition, static_cast<const uint8_t*>(map));
+    }
+#endif
+
+#ifndef ARDUINO
+    namespace Simulation {
+
+        FileFlashPartition::FileFlashPartition()
+            : m_fd(-1), m_map(nullptr), m_size(0), m_erase_counts(nullptr), m_bytes_written(0),
+              m_fail_armed(false), m_fail_budget(0), m_failed(false) {}
+
+        FileFlashPartition::~FileFlashPartition() {
+            close();
+        }
+
+        bool FileFlashPartition::open(const char* path, size_t size) {
+            close();
+
+            if (size == 0 || size % SECTOR_SIZE != 0) {
+                return false;
+            }
+
+            const int fd = ::open(path, O_RDWR | O_CREAT, 0644);
+            if (fd < 0) {
+                return false;
+            }
+
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                ::close(fd);
+                return false;
+            }
+
+            // Anything past the current end of file is fresh, erased flash
+            if (static_cast<size_t>(st.st_size) < size) {
+                uint8_t erased[SECTOR_SIZE];
+                memset(erased, 0xFF, sizeof(erased));
+                for (size_t offset = st.st_size; offset < size; ) {
+                    const size_t chunk = (size - offset) < sizeof(erased) ? (size - offset) : sizeof(erased);
+                    if (pwrite(fd, erased, chunk, offset) != static_cast<ssize_t>(chunk)) {
+                        ::close(fd);
+                        return false;
+                    }
+                    offset += chunk;
+                }
+            }
+
+            void* map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (map == MAP_FAILED) {
+                ::close(fd);
+                return false;
+            }
+
+            m_fd = fd;
+            m_map = static_cast<uint8_t*>(map);
+            m_size = size;
+            m_erase_counts = new uint32_t[sectorCount()]();
+            m_bytes_written = 0;
+            clearPowerFail();
+            return true;
+        }
+
+        void FileFlashPartition::close() {
+            if (m_map) {
+                munmap(m_map, m_size);
+                m_map = nullptr;
+            }
+            if (m_fd >= 0) {
+                ::close(m_fd);
+                m_fd = -1;
+            }
+            delete[] m_erase_counts;
+            m_erase_counts = nullptr;
+            m_size = 0;
+        }
+
+        bool FileFlashPartition::inRange(size_t offset, size_t length) const {
+            return m_map && offset <= m_size && length <= m_size - offset;
+        }
+
+        Result FileFlashPartition::read(size_t offset, void* data, size_t length) const {
+            if (!inRange(offset, length)) {
+                return Result::ERROR_INVALID_PARAMETER;
+            }
+            memcpy(data, m_map + offset, length);
+            return Result::SUCCESS;
+        }
+
+        Result FileFlashPartition::write(size_t offset, const void* data, size_t length) {
+            if (!inRange(offset, length)) {
+                return Result::ERROR_INVALID_PARAMETER;
+            }
+            if (m_failed) {
+                return Result::ERROR_HARDWARE_FAULT;
+            }
+
+            size_t programmed = length;
+            if (m_fail_armed && length > m_fail_budget) {
+                programmed = m_fail_budget;
+                m_failed = true;
+            }
+
+            // Programming can only clear bits
+            const uint8_t* src = static_cast<const uint8_t*>(data);
+            for (size_t i = 0; i < programmed; i++) {
+                m_map[offset + i] &= src[i];
+            }
+
+            m_bytes_written += programmed;
+            if (m_fail_armed && !m_failed) {
+                m_fail_budget -= programmed;
+            }
+
+            return m_failed ? Result::ERROR_HARDWARE_FAULT : Result::SUCCESS;
+        }
+
+        Result FileFlashPartition::eraseSector(size_t sector) {
+            if (!m_map || sector >= sectorCount()) {
+                return Result::ERROR_INVALID_PARAMETER;
+            }
+            if (m_failed) {
+                return Result::ERROR_HARDWARE_FAULT;
+            }
+
+            uint8_t* base = m_map + sector * SECTOR_SIZE;
+            m_erase_counts[sector]++;
+
+            if (m_fail_armed && m_fail_budget == 0) {
+                // Interrupted erase: part of the sector is cleared and the
+                // rest holds its old data with some bits already set
+                for (size_t i = 0; i < SECTOR_SIZE / 2; i++) {
+                    base[i] |= 0xF0;
+                }
+                memset(base + SECTOR_SIZE / 2, 0xFF, SECTOR_SIZE / 2);
+                m_failed = true;
+                return Result::ERROR_HARDWARE_FAULT;
+            }
+
+            memset(base, 0xFF, SECTOR_SIZE);
+            return Result::SUCCESS;
+        }
+
+        uint32_t FileFlashPartition::getEraseCount(size_t sector) const {
+            return (m_erase_counts && sector < sectorCount()) ? m_erase_counts[sector] : 0;
+        }
+
+        uint32_t FileFlashPartition::getMaxEraseCount() const {
+            uint32_t max = 0;
+            for (size_t i = 0; m_erase_counts && i < sectorCount(); i++) {
+                if (m_erase_counts[i] > max) {
+                    max = m_erase_counts[i];
+                }
+            }
+            return max;
+        }
+
+        void FileFlashPartition::failAfterBytes(uint32_t bytes) {
+            m_fail_armed = true;
+            m_fail_budget = bytes;
+            m_failed = false;
+        }
+
+        void FileFlashPartition::clearPowerFail() {
+            m_fail_armed = false;
+            m_fail_budget = 0;
+            m_failed = false;
+        }
+    }
+#endif
+}
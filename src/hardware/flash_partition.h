@@ -0,0 +1,90 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "hardware_abstraction.h"
+
+namespace HardwareAbstraction {
+
+    // Raw access to a data partition with NOR flash semantics: erasing a
+    // sector sets it to 0xFF and writes can only clear bits, so a region
+    // must be erased before it is rewritten.
+    class FlashPartition {
+    public:
+        static constexpr size_t SECTOR_SIZE = 4096;
+
+        virtual ~FlashPartition() = default;
+
+        virtual size_t size() const = 0;
+        size_t sectorCount() const { return size() / SECTOR_SIZE; }
+
+        virtual Result read(size_t offset, void* data, size_t length) const = 0;
+        virtual Result write(size_t offset, const void* data, size_t length) = 0;
+        virtual Result eraseSector(size_t sector) = 0;
+
+        // Read-only view of the whole partition that tracks later writes and
+        // erases, or nullptr if the partition could not be mapped
+        virtual const uint8_t* data() const = 0;
+    };
+
+#ifdef ARDUINO
+    // Data partition by label from the partition table, memory-mapped through
+    // the flash cache. Returns nullptr if the partition is missing or the
+    // mapping fails; the object lives for the rest of the program.
+    FlashPartition* openFlashPartition(const char* label);
+#endif
+
+#ifndef ARDUINO
+    namespace Simulation {
+
+        // File-backed partition for native builds. The file is created erased
+        // (0xFF) if missing and mapped with mmap, so readers see the same
+        // zero-copy view as on the device. Counts erases per sector and can
+        // cut power part-way through a write to exercise recovery.
+        class FileFlashPartition : public FlashPartition {
+        public:
+            FileFlashPartition();
+            ~FileFlashPartition() override;
+
+            FileFlashPartition(const FileFlashPartition&) = delete;
+            FileFlashPartition& operator=(const FileFlashPartition&) = delete;
+
+            bool open(const char* path, size_t size);
+            void close();
+            bool isOpen() const { return m_map != nullptr; }
+
+            size_t size() const override { return m_size; }
+            Result read(size_t offset, void* data, size_t length) const override;
+            Result write(size_t offset, const void* data, size_t length) override;
+            Result eraseSector(size_t sector) override;
+            const uint8_t* data() const override { return m_map; }
+
+            // Counters cover this open() only
+            uint32_t getEraseCount(size_t sector) const;
+            uint32_t getMaxEraseCount() const;
+            uint64_t getBytesWritten() const { return m_bytes_written; }
+
+            // Power loss after this many more programmed bytes: the write that
+            // crosses the budget keeps only its leading bytes, an erase hit by
+            // it leaves the sector partly erased, and everything after fails
+            // until clearPowerFail()
+            void failAfterBytes(uint32_t bytes);
+            bool hasPowerFailed() const { return m_failed; }
+            void clearPowerFail();
+
+        private:
+            int m_fd;
+            uint8_t* m_map;
+            size_t m_size;
+            uint32_t* m_erase_counts;
+            uint64_t m_bytes_written;
+            bool m_fail_armed;
+            uint32_t m_fail_budget;
+            bool m_failed;
+
+            bool inRange(size_t offset, size_t length) const;
+        };
+    }
+#endif
+}
@@ -1,11 +1,9 @@
 #include "hardware_abstraction.h"
+#include "power_calibration.h"
+#include "adc_continuous.h"
 #include <Arduino.h>
-#ifdef ARDUINO_MOCK
-#include "../test/mocks/preferences_mocks.h"
-#else
-#include <Preferences.h>
-#endif
 #include <cstddef>
+#include <cstring>
 #include <cstdlib>
 
 #ifdef ARDUINO
@@ -22,6 +20,11 @@
 #include <driver/adc.h>
 #include <esp_adc_cal.h>
 #include <soc/soc_caps.h>
+#include <driver/pcnt.h>
+#else
+#include <map>
+#include <string>
+#include <vector>
 #endif
 
 namespace HardwareAbstraction {
@@ -37,6 +40,51 @@ namespace HardwareAbstraction {
     static uint32_t g_nvs_handle = 0; // Mock handle for testing
     #endif
 
+    #ifndef ARDUINO
+    // Simulation state for native builds
+    namespace {
+        constexpr size_t SIM_MAX_I2C_DEVICES = 4;
+        constexpr size_t SIM_I2C_BUFFER = 32;
+        constexpr uint8_t SIM_MAX_PINS = 49;
+
+        struct SimI2CDevice {
+            uint8_t address;
+            Simulation::BusDevice* device;
+        };
+
+        SimI2CDevice s_sim_i2c[SIM_MAX_I2C_DEVICES] = {};
+        Simulation::BusDevice* s_sim_spi = nullptr;
+        void (*s_sim_isr[SIM_MAX_PINS])() = {};
+        Simulation::AnalogSource* s_sim_analog[SIM_MAX_PINS] = {};
+        uint8_t s_sim_levels[SIM_MAX_PINS] = {};            // Last GPIO::digitalWrite() or pull per pin
+        Simulation::PulseSource* s_sim_pulse_source = nullptr;
+        uint8_t s_sim_pulse_pin = 0;
+
+        // In-memory NVS, keyed by "namespace/key"
+        std::map<std::string, std::vector<uint8_t>> s_sim_nvs;
+        std::string s_sim_nvs_namespace;
+
+        uint8_t s_sim_tx_address = 0;
+        uint8_t s_sim_tx[SIM_I2C_BUFFER];
+        size_t s_sim_tx_len = 0;
+        uint8_t s_sim_rx[SIM_I2C_BUFFER];
+        size_t s_sim_rx_len = 0;
+        size_t s_sim_rx_pos = 0;
+
+        bool s_sim_manual_clock = false;
+        uint32_t s_sim_micros = 0;
+
+        Simulation::BusDevice* findI2CDevice(uint8_t address) {
+            for (size_t i = 0; i < SIM_MAX_I2C_DEVICES; i++) {
+                if (s_sim_i2c[i].device && s_sim_i2c[i].address == address) {
+                    return s_sim_i2c[i].device;
+                }
+            }
+            return nullptr;
+        }
+    }
+    #endif
+
     // Convert result to string
     const char* resultToString(Result result) {
         switch (result) {
@@ -68,17 +116,24 @@ namespace HardwareAbstraction {
             return Result::ERROR_INIT_FAILED;
         }
 
+        // All power calibration is read here once; later reads come from RAM
+        g_powerCalibration.begin(openPreferencesCalibration("LtngDet"));
+
+        // Subsystem initializers refuse to run before the HAL is marked up
+        g_initialized = true;
+
         // Initialize timers
         if (Timer::initialize() != Result::SUCCESS) {
+            g_initialized = false;
             return Result::ERROR_INIT_FAILED;
         }
 
         // Initialize ADC (for battery monitoring and analog sensors)
         if (ADC::initialize() != Result::SUCCESS) {
+            g_initialized = false;
             return Result::ERROR_INIT_FAILED;
         }
 
-        g_initialized = true;
         return Result::SUCCESS;
         #else
         // Mock implementation for testing
@@ -143,6 +198,13 @@ namespace HardwareAbstraction {
                 default:
                     return Result::ERROR_INVALID_PARAMETER;
             }
+            #else
+            // An undriven input rests at its pull
+            if (mode == Mode::MODE_INPUT_PULLUP) {
+                s_sim_levels[pin] = 1;
+            } else if (mode == Mode::MODE_INPUT_PULLDOWN) {
+                s_sim_levels[pin] = 0;
+            }
             #endif
 
             return Result::SUCCESS;
@@ -159,6 +221,8 @@ namespace HardwareAbstraction {
 
             #ifdef ARDUINO
             ::digitalWrite(pin, static_cast<int>(level));
+            #else
+            s_sim_levels[pin] = static_cast<uint8_t>(level);
             #endif
 
             return Result::SUCCESS;
@@ -172,7 +236,7 @@ namespace HardwareAbstraction {
             #ifdef ARDUINO
             return static_cast<Level>(::digitalRead(pin));
             #else
-            return Level::LEVEL_LOW; // Mock
+            return static_cast<Level>(s_sim_levels[pin]);
             #endif
         }
 
@@ -187,6 +251,8 @@ namespace HardwareAbstraction {
 
             #ifdef ARDUINO
             ::attachInterrupt(digitalPinToInterrupt(pin), callback, mode);
+            #else
+            s_sim_isr[pin] = callback;
             #endif
 
             return Result::SUCCESS;
@@ -203,6 +269,8 @@ namespace HardwareAbstraction {
 
             #ifdef ARDUINO
             ::detachInterrupt(digitalPinToInterrupt(pin));
+            #else
+            s_sim_isr[pin] = nullptr;
             #endif
 
             return Result::SUCCESS;
@@ -246,6 +314,9 @@ namespace HardwareAbstraction {
 
             #ifdef ARDUINO
             Wire.beginTransmission(address);
+            #else
+            s_sim_tx_address = address;
+            s_sim_tx_len = 0;
             #endif
 
             return Result::SUCCESS;
@@ -260,6 +331,10 @@ namespace HardwareAbstraction {
             size_t written = Wire.write(data);
             return (written == 1) ? Result::SUCCESS : Result::ERROR_COMMUNICATION_FAILED;
             #else
+            if (s_sim_tx_len >= SIM_I2C_BUFFER) {
+                return Result::ERROR_COMMUNICATION_FAILED;
+            }
+            s_sim_tx[s_sim_tx_len++] = data;
             return Result::SUCCESS;
             #endif
         }
@@ -277,6 +352,11 @@ namespace HardwareAbstraction {
             size_t written = Wire.write(data, length);
             return (written == length) ? Result::SUCCESS : Result::ERROR_COMMUNICATION_FAILED;
             #else
+            if (s_sim_tx_len + length > SIM_I2C_BUFFER) {
+                return Result::ERROR_COMMUNICATION_FAILED;
+            }
+            memcpy(&s_sim_tx[s_sim_tx_len], data, length);
+            s_sim_tx_len += length;
             return Result::SUCCESS;
             #endif
         }
@@ -298,6 +378,10 @@ namespace HardwareAbstraction {
                 default: return Result::ERROR_HARDWARE_FAULT;
             }
             #else
+            Simulation::BusDevice* device = findI2CDevice(s_sim_tx_address);
+            if (device && !device->i2cWrite(s_sim_tx, s_sim_tx_len)) {
+                return Result::ERROR_COMMUNICATION_FAILED;
+            }
             return Result::SUCCESS;
             #endif
         }
@@ -315,7 +399,17 @@ namespace HardwareAbstraction {
             size_t received = Wire.requestFrom(address, length);
             return (received == length) ? Result::SUCCESS : Result::ERROR_COMMUNICATION_FAILED;
             #else
-            return Result::SUCCESS;
+            s_sim_rx_len = 0;
+            s_sim_rx_pos = 0;
+            Simulation::BusDevice* device = findI2CDevice(address);
+            if (!device) {
+                return Result::SUCCESS;
+            }
+            if (length > SIM_I2C_BUFFER) {
+                return Result::ERROR_INVALID_PARAMETER;
+            }
+            s_sim_rx_len = device->i2cRead(s_sim_rx, length);
+            return (s_sim_rx_len == length) ? Result::SUCCESS : Result::ERROR_COMMUNICATION_FAILED;
             #endif
         }
 
@@ -327,7 +421,7 @@ namespace HardwareAbstraction {
             #ifdef ARDUINO
             return Wire.available();
             #else
-            return 0;
+            return static_cast<int>(s_sim_rx_len - s_sim_rx_pos);
             #endif
         }
 
@@ -339,7 +433,7 @@ namespace HardwareAbstraction {
             #ifdef ARDUINO
             return Wire.read();
             #else
-            return -1;
+            return (s_sim_rx_pos < s_sim_rx_len) ? s_sim_rx[s_sim_rx_pos++] : -1;
             #endif
         }
 
@@ -380,6 +474,10 @@ namespace HardwareAbstraction {
             #ifdef ARDUINO
             SPISettings spiSettings(settings.frequency, settings.bitOrder, settings.dataMode);
             ::SPI.beginTransaction(spiSettings);
+            #else
+            if (s_sim_spi) {
+                s_sim_spi->spiSelect();
+            }
             #endif
 
             return Result::SUCCESS;
@@ -393,7 +491,7 @@ namespace HardwareAbstraction {
             #ifdef ARDUINO
             return ::SPI.transfer(data);
             #else
-            return data; // Mock echo
+            return s_sim_spi ? s_sim_spi->spiTransfer(data) : data; // Mock echo without a device
             #endif
         }
 
@@ -404,6 +502,12 @@ namespace HardwareAbstraction {
 
             #ifdef ARDUINO
             ::SPI.transfer(data, length);
+            #else
+            if (s_sim_spi) {
+                for (size_t i = 0; i < length; i++) {
+                    data[i] = s_sim_spi->spiTransfer(data[i]);
+                }
+            }
             #endif
         }
 
@@ -414,6 +518,10 @@ namespace HardwareAbstraction {
 
             #ifdef ARDUINO
             ::SPI.endTransaction();
+            #else
+            if (s_sim_spi) {
+                s_sim_spi->spiDeselect();
+            }
             #endif
 
             return Result::SUCCESS;
@@ -519,6 +627,15 @@ namespace HardwareAbstraction {
         static const int ADC_UNIT = 1;      // Mock value
         #endif
 
+        // Channels whose attenuation is already set, per unit. Starting or
+        // stopping the continuous controller reprograms ADC1, so the cache
+        // follows its generation.
+        static uint16_t s_adc1_configured = 0;
+        #ifdef ARDUINO
+        static uint16_t s_adc2_configured = 0;
+        #endif
+        static uint32_t s_adc_generation = 0;
+
         Result initialize() {
             if (!g_initialized) {
                 return Result::ERROR_NOT_INITIALIZED;
@@ -556,6 +673,18 @@ namespace HardwareAbstraction {
                 return Result::ERROR_NOT_INITIALIZED;
             }
 
+            // Pins the continuous controller samples are served from its ring
+            if (g_continuousAdc.isRunning() && g_continuousAdc.hasChannel(pin)) {
+                return g_continuousAdc.latest(pin, value) ? Result::SUCCESS : Result::ERROR_TIMEOUT;
+            }
+            if (s_adc_generation != g_continuousAdc.getGeneration()) {
+                s_adc_generation = g_continuousAdc.getGeneration();
+                s_adc1_configured = 0;
+                #ifdef ARDUINO
+                adc1_config_width(ADC_WIDTH_BIT_12);
+                #endif
+            }
+
             #ifdef ARDUINO
             // Convert GPIO to ADC channel for ESP32-S3
             adc1_channel_t channel;
@@ -591,27 +720,38 @@ namespace HardwareAbstraction {
             // Configure and read from appropriate ADC
             int raw_value = -1;
             if (useAdc2) {
-                // Configure ADC2 channel
-                esp_err_t ret = adc2_config_channel_atten(channel2, ADC_ATTEN);
-                if (ret != ESP_OK) {
-                    Serial.printf("[ADC] Failed to configure ADC2 channel %d: %d\n", channel2, ret);
-                    return Result::ERROR_HARDWARE_FAULT;
+                // Configure ADC2 channel once
+                if (!(s_adc2_configured & (1u << channel2))) {
+                    esp_err_t ret = adc2_config_channel_atten(channel2, ADC_ATTEN);
+                    if (ret != ESP_OK) {
+                        Serial.printf("[ADC] Failed to configure ADC2 channel %d: %d\n", channel2, ret);
+                        return Result::ERROR_HARDWARE_FAULT;
+                    }
+                    s_adc2_configured |= 1u << channel2;
                 }
 
                 // Read raw value from ADC2
-                ret = adc2_get_raw(channel2, ADC_WIDTH_BIT_12, &raw_value);
+                esp_err_t ret = adc2_get_raw(channel2, ADC_WIDTH_BIT_12, &raw_value);
                 if (ret != ESP_OK) {
                     Serial.printf("[ADC] Failed to read raw value from ADC2 channel %d: %d\n", channel2, ret);
                     return Result::ERROR_HARDWARE_FAULT;
                 }
             } else {
-                // Configure ADC1 channel
-                esp_err_t ret = adc1_config_channel_atten(channel, ADC_ATTEN);
-                if (ret != ESP_OK) {
-                    Serial.printf("[ADC] Failed to configure ADC1 channel %d: %d\n", channel, ret);
+                // ADC1 belongs to the digital controller while it runs
+                if (g_continuousAdc.isRunning()) {
                     return Result::ERROR_HARDWARE_FAULT;
                 }
 
+                // Configure ADC1 channel once
+                if (!(s_adc1_configured & (1u << channel))) {
+                    esp_err_t ret = adc1_config_channel_atten(channel, ADC_ATTEN);
+                    if (ret != ESP_OK) {
+                        Serial.printf("[ADC] Failed to configure ADC1 channel %d: %d\n", channel, ret);
+                        return Result::ERROR_HARDWARE_FAULT;
+                    }
+                    s_adc1_configured |= 1u << channel;
+                }
+
                 // Read raw value from ADC1
                 raw_value = adc1_get_raw(channel);
                 if (raw_value < 0) {
@@ -621,21 +761,12 @@ namespace HardwareAbstraction {
             }
 
             value = static_cast<uint16_t>(raw_value);
-
-            // Debug output for battery pins
-            if (pin == 1 || pin == 35 || pin == 37) {
-                const char* adcUnit = useAdc2 ? "ADC2" : "ADC1";
-                int channelNum = useAdc2 ? channel2 : channel;
-                Serial.printf("[ADC] GPIO%d -> %s Channel %d, Raw: %d (0x%04X), Atten: %d\n",
-                            pin, adcUnit, channelNum, raw_value, raw_value, ADC_ATTEN);
-            }
             #else
             // Mock channel for testing - validate pin range
             if (pin > 20) {
                 return Result::ERROR_INVALID_PARAMETER;
             }
-            int channel = pin % 10;
-            value = 2048; // Mock middle value
+            value = Simulation::sampleAnalog(pin, Timer::micros());
             #endif
 
             return Result::SUCCESS;
@@ -656,16 +787,8 @@ namespace HardwareAbstraction {
             if (s_adc_chars != nullptr) {
                 uint32_t voltage_mv = esp_adc_cal_raw_to_voltage(raw_value, s_adc_chars);
                 voltage = voltage_mv / 1000.0f;
-                if (pin == 1) {
-                    Serial.printf("[ADC_VOLT] Pin %d: Raw=%d, Calibrated=%dmV, Voltage=%.3fV\n",
-                                pin, raw_value, voltage_mv, voltage);
-                }
             } else {
                 voltage = (raw_value / 4095.0f) * 3.3f; // Fallback calculation
-                if (pin == 1) {
-                    Serial.printf("[ADC_VOLT] Pin %d: Raw=%d, Fallback=%.3fV (no calibration)\n",
-                                pin, raw_value, voltage);
-                }
             }
             #else
             voltage = (raw_value / 4095.0f) * 3.3f; // Mock calculation
@@ -697,6 +820,60 @@ namespace HardwareAbstraction {
         }
     }
 
+    // Pulse Counter Implementation
+    namespace PulseCounter {
+        Result countEdges(uint8_t pin, uint32_t gateMs, uint32_t& edges, uint32_t& gateUs) {
+            if (!g_initialized) {
+                return Result::ERROR_NOT_INITIALIZED;
+            }
+
+            if (pin > 48 || gateMs == 0) {
+                return Result::ERROR_INVALID_PARAMETER;
+            }
+
+            #ifdef ARDUINO
+            pcnt_config_t config = {};
+            config.pulse_gpio_num = pin;
+            config.ctrl_gpio_num = PCNT_PIN_NOT_USED;
+            config.channel = PCNT_CHANNEL_0;
+            config.unit = PCNT_UNIT_0;
+            config.pos_mode = PCNT_COUNT_INC;
+            config.neg_mode = PCNT_COUNT_DIS;
+            config.lctrl_mode = PCNT_MODE_KEEP;
+            config.hctrl_mode = PCNT_MODE_KEEP;
+            config.counter_h_lim = INT16_MAX;
+            config.counter_l_lim = 0;
+
+            if (pcnt_unit_config(&config) != ESP_OK) {
+                return Result::ERROR_INIT_FAILED;
+            }
+
+            // Reject glitches shorter than ~1 us (APB clock cycles)
+            pcnt_set_filter_value(PCNT_UNIT_0, 80);
+            pcnt_filter_enable(PCNT_UNIT_0);
+
+            pcnt_counter_pause(PCNT_UNIT_0);
+            pcnt_counter_clear(PCNT_UNIT_0);
+
+            const uint32_t start = ::micros();
+            pcnt_counter_resume(PCNT_UNIT_0);
+            ::delay(gateMs);
+            pcnt_counter_pause(PCNT_UNIT_0);
+            gateUs = ::micros() - start;
+
+            int16_t count = 0;
+            esp_err_t ret = pcnt_get_counter_value(PCNT_UNIT_0, &count);
+            edges = static_cast<uint32_t>(count);
+            return (ret == ESP_OK) ? Result::SUCCESS : Result::ERROR_HARDWARE_FAULT;
+            #else
+            gateUs = gateMs * 1000;
+            edges = (s_sim_pulse_source && s_sim_pulse_pin == pin) ? s_sim_pulse_source->countEdges(pin, gateUs) : 0;
+            Timer::delay(gateMs);
+            return Result::SUCCESS;
+            #endif
+        }
+    }
+
     // Timer Implementation
     namespace Timer {
         struct Handle {
@@ -732,6 +909,9 @@ namespace HardwareAbstraction {
             #ifdef ARDUINO
             return ::millis();
             #else
+            if (s_sim_manual_clock) {
+                return s_sim_micros / 1000;
+            }
             // Mock implementation - return incrementing value
             static uint32_t mock_time = 0;
             return ++mock_time;
@@ -742,6 +922,9 @@ namespace HardwareAbstraction {
             #ifdef ARDUINO
             return ::micros();
             #else
+            if (s_sim_manual_clock) {
+                return s_sim_micros;
+            }
             // Mock implementation
             static uint32_t mock_time = 0;
             return ++mock_time;
@@ -751,12 +934,20 @@ namespace HardwareAbstraction {
         void delay(uint32_t ms) {
             #ifdef ARDUINO
             ::delay(ms);
+            #else
+            if (s_sim_manual_clock) {
+                s_sim_micros += ms * 1000;
+            }
             #endif
         }
 
         void delayMicroseconds(uint32_t us) {
             #ifdef ARDUINO
             ::delayMicroseconds(us);
+            #else
+            if (s_sim_manual_clock) {
+                s_sim_micros += us;
+            }
             #endif
         }
 
@@ -855,9 +1046,6 @@ namespace HardwareAbstraction {
 
     // Power Management Implementation
     namespace Power {
-        // Global mutable multiplier for battery voltage scaling (default 4.9 for Heltec V3)
-        static float s_adcMultiplier = 4.9f;
-
         static const uint8_t VEXT_PIN = 36; // Heltec V3 Vext control pin
 
         Result enableVext() {
@@ -930,7 +1118,6 @@ namespace HardwareAbstraction {
             // Common pins: GPIO1, GPIO35, GPIO37
             constexpr uint8_t kBatteryAdcPin = 1;          // GPIO1 -> ADC1_CH0
             constexpr uint8_t kBatteryCtrlPin = 37;        // GPIO37 gate low = enable divider
-            // use global s_adcMultiplier declared in namespace scope
 
             // Configure control pin once
             static bool s_ctrlConfigured = false;
@@ -942,45 +1129,38 @@ namespace HardwareAbstraction {
 
             // Enable divider momentarily
             ::digitalWrite(kBatteryCtrlPin, LOW);
+            const uint32_t settledUs = ::micros() + 3000;
             delay(3); // allow settling
 
             float voltageOnPin = 0.0f;
+            if (g_continuousAdc.isRunning() && g_continuousAdc.hasChannel(kBatteryAdcPin)) {
+                // Older ring entries were converted with the divider off
+                ContinuousSample sample;
+                for (int i = 0; i < 20 && g_continuousAdc.readSince(kBatteryAdcPin, settledUs, &sample, 1) == 0; i++) {
+                    delay(1);
+                }
+                ::digitalWrite(kBatteryCtrlPin, HIGH);
+                if (g_continuousAdc.readSince(kBatteryAdcPin, settledUs, &sample, 1) == 0) {
+                    return 0.0f;
+                }
+                return g_powerCalibration.batteryVoltage(g_continuousAdc.toVolts(sample.raw));
+            }
             if (ADC::readVoltage(kBatteryAdcPin, voltageOnPin) == Result::SUCCESS) {
                 // Disable divider immediately after reading
                 ::digitalWrite(kBatteryCtrlPin, HIGH);
-                return voltageOnPin * s_adcMultiplier;      // Scale to actual VBAT
+                return g_powerCalibration.batteryVoltage(voltageOnPin);
             }
 
             // Ensure divider disabled if read failed
             ::digitalWrite(kBatteryCtrlPin, HIGH);
 
-
-            // Try to load calibrated multiplier from preferences
-            static bool multiplierLoaded = false;
-            if (!multiplierLoaded) {
-                Preferences prefs;
-                if (prefs.begin("LtngDet", true)) {
-                    if (prefs.isKey("adc_multiplier")) {
-                        s_adcMultiplier = prefs.getFloat("adc_multiplier", 4.9f);
-                        Serial.printf("[BATTERY] Loaded calibrated ADC multiplier: %.2f\n", s_adcMultiplier);
-                    } else {
-                        Serial.printf("[BATTERY] Using default ADC multiplier: %.2f\n", s_adcMultiplier);
-                    }
-                    prefs.end();
-                }
-                multiplierLoaded = true;
-            }
-
             // Fallback to Arduino analogRead if ADC abstraction fails
             Serial.printf("[BATTERY] ADC abstraction failed for GPIO%d, trying analogRead fallback...\n", kBatteryAdcPin);
             int analogValue = analogRead(kBatteryAdcPin);
             voltageOnPin = (analogValue / 4095.0f) * 3.3f;
 
             if (voltageOnPin > 0.1f) {
-                float batteryVoltage = voltageOnPin * s_adcMultiplier;
-                Serial.printf("[BATTERY] analogRead fallback: GPIO%d, Raw: %d, Voltage: %.3fV, Multiplier: %.2f, Battery: %.3fV\n",
-                            kBatteryAdcPin, analogValue, voltageOnPin, s_adcMultiplier, batteryVoltage);
-                return batteryVoltage;
+                return g_powerCalibration.batteryVoltage(voltageOnPin);
             } else {
                 Serial.printf("[BATTERY] Both ADC methods failed for GPIO%d\n", kBatteryAdcPin);
             }
@@ -989,31 +1169,14 @@ namespace HardwareAbstraction {
         }
 
         void setAdcMultiplier(float multiplier) {
-            if (multiplier < 2.0f || multiplier > 6.0f) {
+            // Written through to NVS only if it actually changed
+            if (!g_powerCalibration.setAdcMultiplier(multiplier)) {
                 Serial.printf("[BATTERY] Invalid ADC multiplier: %.2f (must be 2.0-6.0)\n", multiplier);
-                return;
             }
-
-            // Save to preferences
-            Preferences prefs;
-            if (prefs.begin("LtngDet", false)) {
-                prefs.putFloat("adc_multiplier", multiplier);
-                prefs.end();
-                Serial.printf("[BATTERY] ADC multiplier saved: %.2f\n", multiplier);
-            }
-
-            // Update the static multiplier (will take effect on next battery read)
-            s_adcMultiplier = multiplier;
         }
 
         float getAdcMultiplier() {
-            Preferences prefs;
-            if (prefs.begin("LtngDet", true)) {
-                float multiplier = prefs.getFloat("adc_multiplier", 4.9f);
-                prefs.end();
-                return multiplier;
-            }
-            return 4.9f; // Default fallback
+            return g_powerCalibration.getAdcMultiplier();
         }
 
         uint8_t getBatteryPercent() {
@@ -1081,6 +1244,7 @@ namespace HardwareAbstraction {
             return (ret == ESP_OK) ? Result::SUCCESS : Result::ERROR_INIT_FAILED;
             #else
             g_nvs_handle = 1; // Mock handle
+            s_sim_nvs_namespace = namespace_name;
             return Result::SUCCESS;
             #endif
         }
@@ -1099,6 +1263,15 @@ namespace HardwareAbstraction {
                 default: return Result::ERROR_HARDWARE_FAULT;
             }
             #else
+            auto it = s_sim_nvs.find(s_sim_nvs_namespace + "/" + key);
+            if (it == s_sim_nvs.end()) {
+                return Result::ERROR_COMMUNICATION_FAILED;
+            }
+            if (it->second.size() > length) {
+                return Result::ERROR_INVALID_PARAMETER;
+            }
+            length = it->second.size();
+            memcpy(value, it->second.data(), length);
             return Result::SUCCESS;
             #endif
         }
@@ -1112,6 +1285,8 @@ namespace HardwareAbstraction {
             esp_err_t ret = ::nvs_set_blob(g_nvs_handle, key, value, length);
             return (ret == ESP_OK) ? Result::SUCCESS : Result::ERROR_HARDWARE_FAULT;
             #else
+            const uint8_t* bytes = static_cast<const uint8_t*>(value);
+            s_sim_nvs[s_sim_nvs_namespace + "/" + key].assign(bytes, bytes + length);
             return Result::SUCCESS;
             #endif
         }
@@ -1194,4 +1369,81 @@ namespace HardwareAbstraction {
             #endif
         }
     }
+
+    #ifndef ARDUINO
+    namespace Simulation {
+        void attachI2CDevice(uint8_t address, BusDevice* device) {
+            for (size_t i = 0; i < SIM_MAX_I2C_DEVICES; i++) {
+                if (s_sim_i2c[i].device && s_sim_i2c[i].address == address) {
+                    s_sim_i2c[i].device = device;
+                    return;
+                }
+            }
+            if (!device) {
+                return;
+            }
+            for (size_t i = 0; i < SIM_MAX_I2C_DEVICES; i++) {
+                if (!s_sim_i2c[i].device) {
+                    s_sim_i2c[i] = {address, device};
+                    return;
+                }
+            }
+        }
+
+        void attachSPIDevice(BusDevice* device) {
+            s_sim_spi = device;
+        }
+
+        void attachPulseSource(uint8_t pin, PulseSource* source) {
+            s_sim_pulse_pin = pin;
+            s_sim_pulse_source = source;
+        }
+
+        bool triggerInterrupt(uint8_t pin) {
+            if (pin >= SIM_MAX_PINS || !s_sim_isr[pin]) {
+                return false;
+            }
+            s_sim_isr[pin]();
+            return true;
+        }
+
+        void attachAnalogSource(uint8_t pin, AnalogSource* source) {
+            if (pin < SIM_MAX_PINS) {
+                s_sim_analog[pin] = source;
+            }
+        }
+
+        uint16_t sampleAnalog(uint8_t pin, uint32_t nowUs) {
+            if (pin < SIM_MAX_PINS && s_sim_analog[pin]) {
+                return s_sim_analog[pin]->sample(pin, nowUs);
+            }
+            return 2048; // Mock middle value
+        }
+
+        void setMicros(uint32_t us) {
+            s_sim_manual_clock = true;
+            s_sim_micros = us;
+        }
+
+        void advanceMicros(uint32_t us) {
+            s_sim_manual_clock = true;
+            s_sim_micros += us;
+        }
+
+        void reset() {
+            memset(s_sim_i2c, 0, sizeof(s_sim_i2c));
+            memset(s_sim_isr, 0, sizeof(s_sim_isr));
+            memset(s_sim_analog, 0, sizeof(s_sim_analog));
+            memset(s_sim_levels, 0, sizeof(s_sim_levels));
+            s_sim_spi = nullptr;
+            s_sim_pulse_source = nullptr;
+            s_sim_nvs.clear();
+            s_sim_tx_len = 0;
+            s_sim_rx_len = 0;
+            s_sim_rx_pos = 0;
+            s_sim_manual_clock = false;
+            s_sim_micros = 0;
+        }
+    }
+    #endif
 }
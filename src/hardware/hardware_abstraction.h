@@ -77,11 +77,21 @@ namespace HardwareAbstraction {
     // ADC abstraction
     namespace ADC {
         Result initialize();
+        // Pins the running continuous sampler converts return its newest
+        // output as is, whatever the state of any divider gate in front of
+        // the pin. On the device other ADC1 pins are refused while it runs.
         Result read(uint8_t pin, uint16_t& value);
         Result readVoltage(uint8_t pin, float& voltage);
         Result setResolution(uint8_t bits);
     }
 
+    // Pulse counter abstraction (PCNT unit 0)
+    namespace PulseCounter {
+        // Count rising edges on pin for gateMs; gateUs returns the measured gate length.
+        // The hardware counter is 16-bit: keep edges per gate below 32767.
+        Result countEdges(uint8_t pin, uint32_t gateMs, uint32_t& edges, uint32_t& gateUs);
+    }
+
     // Timer abstraction
     namespace Timer {
         typedef void (*TimerCallback)();
@@ -163,4 +173,54 @@ namespace HardwareAbstraction {
 
     // Convert result to string
     const char* resultToString(Result result);
+
+#ifndef ARDUINO
+    // Native builds only: bus device models, interrupt injection and a
+    // manual clock so drivers can be exercised at register level in tests
+    namespace Simulation {
+        class BusDevice {
+        public:
+            virtual ~BusDevice() = default;
+
+            // One I2C write transaction (address already matched); false = NACK
+            virtual bool i2cWrite(const uint8_t*, size_t) { return false; }
+            // One I2C read transaction; returns bytes supplied
+            virtual size_t i2cRead(uint8_t*, size_t) { return 0; }
+
+            // SPI: select at beginTransaction, one call per byte, deselect at endTransaction
+            virtual void spiSelect() {}
+            virtual uint8_t spiTransfer(uint8_t) { return 0xFF; }
+            virtual void spiDeselect() {}
+        };
+
+        class PulseSource {
+        public:
+            virtual ~PulseSource() = default;
+
+            // Rising edges seen on the pin during a gate of gateUs
+            virtual uint32_t countEdges(uint8_t pin, uint32_t gateUs) = 0;
+        };
+
+        class AnalogSource {
+        public:
+            virtual ~AnalogSource() = default;
+
+            // 12-bit ADC code on the pin at simulated time nowUs
+            virtual uint16_t sample(uint8_t pin, uint32_t nowUs) = 0;
+        };
+
+        void attachI2CDevice(uint8_t address, BusDevice* device);  // nullptr detaches
+        void attachSPIDevice(BusDevice* device);                   // nullptr detaches
+        bool triggerInterrupt(uint8_t pin);                        // Run the ISR attached to pin
+        void attachPulseSource(uint8_t pin, PulseSource* source);  // nullptr detaches
+        void attachAnalogSource(uint8_t pin, AnalogSource* source); // nullptr detaches; unattached pins read 2048
+        uint16_t sampleAnalog(uint8_t pin, uint32_t nowUs);        // The code the pin converts to at nowUs
+
+        // Manual clock: Timer::millis()/micros() return this, Timer::delay() advances it
+        void setMicros(uint32_t us);
+        void advanceMicros(uint32_t us);
+
+        void reset();                                              // Detach all, erase NVS, free-running clock
+    }
+#endif
 }
@@ -0,0 +1,284 @@
+#include "power_calibration.h"
+
+#include <cmath>
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#include <Preferences.h>
+#endif
+
+namespace HardwareAbstraction {
+
+    // Calibration for this board, loaded by HardwareAbstraction::initialize()
+    PowerCalibration g_powerCalibration;
+
+    // "adc_multiplier" predates this store; Preferences::putFloat() wrote it
+    // as a 4-byte blob, so it loads unchanged
+    static const char* const KEY_MULTIPLIER = "adc_multiplier";
+    static const char* const KEY_POINTS = "adc_cal_pts";
+
+    static constexpr uint8_t POINTS_VERSION = 1;
+    static constexpr uint16_t POINT_MERGE_MV = 20;
+
+    struct StoredPoints {
+        uint8_t version;
+        uint8_t count;
+        uint16_t reserved;
+        AdcCalibrationPoint points[PowerCalibration::MAX_POINTS];
+    };
+
+    static bool validMultiplier(float multiplier) {
+        return multiplier >= PowerCalibration::MIN_MULTIPLIER && multiplier <= PowerCalibration::MAX_MULTIPLIER;
+    }
+
+    static bool validPoint(const AdcCalibrationPoint& point) {
+        return point.pin_mv > 0 &&
+               validMultiplier(static_cast<float>(point.battery_mv) / static_cast<float>(point.pin_mv));
+    }
+
+    static float ratioOf(const AdcCalibrationPoint& point) {
+        return static_cast<float>(point.battery_mv) / static_cast<float>(point.pin_mv);
+    }
+
+    PowerCalibration::PowerCalibration()
+        : m_backend(nullptr), m_loaded(false), m_multiplier(DEFAULT_MULTIPLIER), m_points(), m_pointCount(0),
+          m_stats() {}
+
+    void PowerCalibration::begin(CalibrationBackend* backend) {
+        m_backend = backend;
+        m_multiplier = DEFAULT_MULTIPLIER;
+        m_pointCount = 0;
+        m_stats = PowerCalibrationStats();
+        m_loaded = true;
+        if (m_backend == nullptr) {
+            return;
+        }
+
+        float multiplier = 0.0f;
+        m_stats.loads++;
+        if (m_backend->load(KEY_MULTIPLIER, &multiplier, sizeof(multiplier))) {
+            if (validMultiplier(multiplier)) {
+                m_multiplier = multiplier;
+            } else {
+                m_stats.rejected++;
+            }
+        }
+
+        StoredPoints stored;
+        m_stats.loads++;
+        if (m_backend->load(KEY_POINTS, &stored, sizeof(stored))) {
+            bool valid = stored.version == POINTS_VERSION && stored.count <= MAX_POINTS;
+            for (uint8_t i = 0; valid && i < stored.count; i++) {
+                valid = validPoint(stored.points[i]) &&
+                        (i == 0 || stored.points[i].pin_mv > stored.points[i - 1].pin_mv);
+            }
+            if (valid) {
+                memcpy(m_points, stored.points, sizeof(m_points));
+                m_pointCount = stored.count;
+            } else {
+                m_stats.rejected++;
+            }
+        }
+
+#ifdef ARDUINO
+        Serial.printf("[CAL] ADC multiplier %.3f, %u calibration point(s)\n", m_multiplier,
+                      (unsigned)m_pointCount);
+#endif
+    }
+
+    bool PowerCalibration::setAdcMultiplier(float multiplier) {
+        if (!validMultiplier(multiplier)) {
+            m_stats.rejected++;
+            return false;
+        }
+        if (std::fabs(multiplier - m_multiplier) < 0.0005f) {
+            return true;
+        }
+        m_multiplier = multiplier;
+        return storeMultiplier();
+    }
+
+    bool PowerCalibration::addPoint(float pinVolts, float batteryVolts) {
+        AdcCalibrationPoint point;
+        point.pin_mv = static_cast<uint16_t>(std::lround(pinVolts * 1000.0f));
+        point.battery_mv = static_cast<uint16_t>(std::lround(batteryVolts * 1000.0f));
+        if (!(pinVolts > 0.0f && batteryVolts > 0.0f && batteryVolts < 65.0f) || !validPoint(point)) {
+            m_stats.rejected++;
+            return false;
+        }
+
+        // Same spot measured again replaces the earlier reading
+        for (size_t i = 0; i < m_pointCount; i++) {
+            const int delta = static_cast<int>(m_points[i].pin_mv) - static_cast<int>(point.pin_mv);
+            if (delta > -static_cast<int>(POINT_MERGE_MV) && delta < static_cast<int>(POINT_MERGE_MV)) {
+                if (m_points[i].pin_mv == point.pin_mv && m_points[i].battery_mv == point.battery_mv) {
+                    return true;
+                }
+                memmove(&m_points[i], &m_points[i + 1], (m_pointCount - i - 1) * sizeof(m_points[0]));
+                m_pointCount--;
+                break;
+            }
+        }
+        if (m_pointCount >= MAX_POINTS) {
+            m_stats.rejected++;
+            return false;
+        }
+
+        size_t at = m_pointCount;
+        while (at > 0 && m_points[at - 1].pin_mv > point.pin_mv) {
+            m_points[at] = m_points[at - 1];
+            at--;
+        }
+        m_points[at] = point;
+        m_pointCount++;
+        return storePoints();
+    }
+
+    bool PowerCalibration::clearPoints() {
+        if (m_pointCount == 0) {
+            return true;
+        }
+        m_pointCount = 0;
+        return storePoints();
+    }
+
+    float PowerCalibration::batteryVoltage(float pinVolts) const {
+        if (m_pointCount == 0) {
+            return pinVolts * m_multiplier;
+        }
+        const float pinMv = pinVolts * 1000.0f;
+        const AdcCalibrationPoint& first = m_points[0];
+        const AdcCalibrationPoint& last = m_points[m_pointCount - 1];
+
+        // Outside the measured span the nearest point's ratio holds
+        if (pinMv <= first.pin_mv) {
+            return pinVolts * ratioOf(first);
+        }
+        if (pinMv >= last.pin_mv) {
+            return pinVolts * ratioOf(last);
+        }
+
+        size_t lo = 0;
+        size_t hi = m_pointCount - 1;
+        while (hi - lo > 1) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (m_points[mid].pin_mv <= pinMv) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        const float t = (pinMv - m_points[lo].pin_mv) / static_cast<float>(m_points[hi].pin_mv - m_points[lo].pin_mv);
+        const float batteryMv = m_points[lo].battery_mv + t * (m_points[hi].battery_mv - m_points[lo].battery_mv);
+        return batteryMv / 1000.0f;
+    }
+
+    bool PowerCalibration::storeMultiplier() {
+        if (m_backend == nullptr) {
+            return true;
+        }
+        m_stats.stores++;
+        return m_backend->store(KEY_MULTIPLIER, &m_multiplier, sizeof(m_multiplier));
+    }
+
+    bool PowerCalibration::storePoints() {
+        if (m_backend == nullptr) {
+            return true;
+        }
+        StoredPoints stored;
+        memset(&stored, 0, sizeof(stored));
+        stored.version = POINTS_VERSION;
+        stored.count = static_cast<uint8_t>(m_pointCount);
+        memcpy(stored.points, m_points, m_pointCount * sizeof(m_points[0]));
+        m_stats.stores++;
+        return m_backend->store(KEY_POINTS, &stored, sizeof(stored));
+    }
+
+#ifdef ARDUINO
+    namespace {
+        class PreferencesCalibration : public CalibrationBackend {
+        public:
+            explicit PreferencesCalibration(const char* nvsNamespace) : m_namespace(nvsNamespace) {}
+
+            bool load(const char* key, void* data, size_t length) override {
+                Preferences prefs;
+                if (!prefs.begin(m_namespace, true)) {
+                    return false;
+                }
+                const bool ok = prefs.isKey(key) && prefs.getBytesLength(key) == length &&
+                                prefs.getBytes(key, data, length) == length;
+                prefs.end();
+                return ok;
+            }
+
+            bool store(const char* key, const void* data, size_t length) override {
+                Preferences prefs;
+                if (!prefs.begin(m_namespace, false)) {
+                    return false;
+                }
+                const bool ok = prefs.putBytes(key, data, length) == length;
+                prefs.end();
+                return ok;
+            }
+
+        private:
+            const char* m_namespace;
+        };
+    }
+
+    CalibrationBackend* openPreferencesCalibration(const char* nvsNamespace) {
+        static PreferencesCalibration s_backend(nvsNamespace);
+        return &s_backend;
+    }
+#endif
+
+#ifndef ARDUINO
+    namespace Simulation {
+
+        MemoryCalibrationBackend::MemoryCalibrationBackend() : loads(0), stores(0), m_entries(), m_count(0) {}
+
+        MemoryCalibrationBackend::Entry* MemoryCalibrationBackend::find(const char* key) {
+            for (size_t i = 0; i < m_count; i++) {
+                if (strncmp(m_entries[i].key, key, sizeof(m_entries[i].key)) == 0) {
+                    return &m_entries[i];
+                }
+            }
+            return nullptr;
+        }
+
+        bool MemoryCalibrationBackend::load(const char* key, void* data, size_t length) {
+            loads++;
+            Entry* entry = find(key);
+            if (entry == nullptr || entry->length != length) {
+                return false;
+            }
+            memcpy(data, entry->data, length);
+            return true;
+        }
+
+        bool MemoryCalibrationBackend::store(const char* key, const void* data, size_t length) {
+            stores++;
+            return put(key, data, length);
+        }
+
+        bool MemoryCalibrationBackend::put(const char* key, const void* data, size_t length) {
+            if (length > MAX_BLOB || strlen(key) >= sizeof(m_entries[0].key)) {
+                return false;
+            }
+            Entry* entry = find(key);
+            if (entry == nullptr) {
+                if (m_count >= MAX_KEYS) {
+                    return false;
+                }
+                entry = &m_entries[m_count++];
+                strncpy(entry->key, key, sizeof(entry->key) - 1);
+                entry->key[sizeof(entry->key) - 1] = '\0';
+            }
+            memcpy(entry->data, data, length);
+            entry->length = length;
+            return true;
+        }
+    }
+#endif
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace HardwareAbstraction {
+
+    // Persistent blobs for calibration data, keyed by short NVS-style names
+    class CalibrationBackend {
+    public:
+        virtual ~CalibrationBackend() = default;
+
+        // True only if the key exists and holds exactly `length` bytes
+        virtual bool load(const char* key, void* data, size_t length) = 0;
+        virtual bool store(const char* key, const void* data, size_t length) = 0;
+    };
+
+#ifdef ARDUINO
+    // Preferences namespace on the device's NVS; the object lives for the
+    // rest of the program
+    CalibrationBackend* openPreferencesCalibration(const char* nvsNamespace);
+#endif
+
+    // Measured pair from the web UI: what the ADC pin read, and what a
+    // meter showed on the battery at the same time
+    struct AdcCalibrationPoint {
+        uint16_t pin_mv;
+        uint16_t battery_mv;
+    };
+
+    struct PowerCalibrationStats {
+        uint32_t loads;                     // Backend reads, all at begin()
+        uint32_t stores;                    // Backend writes, only on change
+        uint32_t rejected;                  // Out-of-range or corrupt values
+    };
+
+    // Calibration for the power subsystem, loaded once at HAL init and
+    // served from RAM. Battery voltage is interpolated across this board's
+    // measured points; with none, the single divider multiplier applies.
+    class PowerCalibration {
+    public:
+        static constexpr size_t MAX_POINTS = 8;
+        static constexpr float DEFAULT_MULTIPLIER = 4.9f;
+        static constexpr float MIN_MULTIPLIER = 2.0f;
+        static constexpr float MAX_MULTIPLIER = 6.0f;
+
+        PowerCalibration();
+
+        // Loads everything from the backend; nullptr keeps the defaults and
+        // makes later changes RAM-only
+        void begin(CalibrationBackend* backend);
+        bool isLoaded() const { return m_loaded; }
+
+        float getAdcMultiplier() const { return m_multiplier; }
+        bool setAdcMultiplier(float multiplier);
+
+        // Replaces a point within 20 mV of pin voltage; refuses when full
+        bool addPoint(float pinVolts, float batteryVolts);
+        bool clearPoints();
+        size_t pointCount() const { return m_pointCount; }
+        const AdcCalibrationPoint& point(size_t index) const { return m_points[index]; }
+
+        float batteryVoltage(float pinVolts) const;
+
+        const PowerCalibrationStats& getStats() const { return m_stats; }
+
+    private:
+        CalibrationBackend* m_backend;
+        bool m_loaded;
+        float m_multiplier;
+        AdcCalibrationPoint m_points[MAX_POINTS];
+        size_t m_pointCount;
+        PowerCalibrationStats m_stats;
+
+        bool storeMultiplier();
+        bool storePoints();
+    };
+
+    extern PowerCalibration g_powerCalibration;
+
+#ifndef ARDUINO
+    namespace Simulation {
+
+        // In-memory backend that survives a PowerCalibration being rebuilt,
+        // like NVS across a reboot, and counts its traffic
+        class MemoryCalibrationBackend : public CalibrationBackend {
+        public:
+            static constexpr size_t MAX_KEYS = 8;
+            static constexpr size_t MAX_BLOB = 64;
+
+            MemoryCalibrationBackend();
+
+            bool load(const char* key, void* data, size_t length) override;
+            bool store(const char* key, const void* data, size_t length) override;
+
+            // Raw write, for seeding legacy or corrupt values
+            bool put(const char* key, const void* data, size_t length);
+
+            uint32_t loads;
+            uint32_t stores;
+
+        private:
+            struct Entry {
+                char key[16];
+                uint8_t data[MAX_BLOB];
+                size_t length;
+            };
+            Entry m_entries[MAX_KEYS];
+            size_t m_count;
+
+            Entry* find(const char* key);
+        };
+    }
+#endif
+}
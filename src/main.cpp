@@ -6,9 +6,27 @@
 #include <Preferences.h>
 #include <ArduinoJson.h>
 #include <esp_sleep.h>
+#include <esp_system.h>
+#include <time.h>
 #include <driver/rtc_io.h>
 #include "app_logic.h"
 #include "hardware/hardware_abstraction.h"
+#include "hardware/flash_partition.h"
+#include "hardware/power_calibration.h"
+#include "hardware/adc_continuous.h"
+#include "system/event_log.h"
+#include "display/dirty_tile_renderer.h"
+#include "display/display_task.h"
+#include "display/screen_model.h"
+#include "display/screen_renderer.h"
+#include "display/ui_timeline.h"
+#include "display/ui_controller.h"
+#include "system/loop_budget.h"
+#include "communication/control_burst.h"
+#include "sensors/battery_monitor.h"
+#include "sensors/battery_soc.h"
+#include "sensors/button_input.h"
+#include "sensors/storm_tracker.h"
 #include "config/role_config.h"
 
 #ifdef ENABLE_WIFI_OTA
@@ -27,6 +45,48 @@
 // SSD1306 128x64 OLED over HW I2C; pins set via Wire.begin(17,18)
 U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R0, U8X8_PIN_NONE);
 
+// Partial OLED updates: only tiles that changed since the last frame go over I2C.
+// updateDisplayArea() takes native (unrotated) tile coordinates, which is how
+// the frame buffer is laid out regardless of setDisplayRotation().
+class U8g2TileSink : public Display::TileSink {
+public:
+  void sendTiles(uint8_t tx, uint8_t ty, uint8_t tw, const uint8_t*) override {
+    u8g2.updateDisplayArea(tx, ty, tw, 1);
+  }
+};
+static U8g2TileSink oledSink;
+static Display::DirtyTileRenderer oledRenderer;
+
+// Retained display state: loop-side setters bump section revisions, the
+// display task redraws only the regions whose revision moved
+static const uint32_t SCREEN_ROTATE_MS = 5000;
+static const uint8_t RECEIVER_SCREENS = (1 << (uint8_t)Display::Screen::SIGNAL) | (1 << (uint8_t)Display::Screen::NETWORK) |
+                                        (1 << (uint8_t)Display::Screen::NODES) | (1 << (uint8_t)Display::Screen::STORM);
+static const uint8_t SENDER_SCREENS = RECEIVER_SCREENS & ~(1 << (uint8_t)Display::Screen::NODES); // Senders hear no pings
+
+static Display::ScreenConfig makeScreenConfig() {
+  Display::ScreenConfig config = Display::getDefaultScreenConfig();
+  config.rotate_interval_ms = SCREEN_ROTATE_MS;
+  return config;
+}
+static Display::ScreenState screenState(makeScreenConfig());
+static Display::ScreenRenderer screenRenderer(u8g2);
+
+// Drawing and flushing run in a low-priority task; refreshScreen() only posts
+// a ScreenModel snapshot into its mailbox
+static Display::DisplayTask displayTask;
+
+// Deferred UI steps (sleep, reboot) wait here while the loop keeps running;
+// loopBudget reports iterations that block longer than LOOP_BUDGET_MS
+static Display::UiTimeline uiTimeline;
+static Diagnostics::LoopBudget loopBudget;
+
+// Button actions, idle mode and sleep; firmware side effects via hooks
+static Display::UiController uiController(screenState, uiTimeline);
+
+// Receiver preset announcements on the control channel, stepped off the timeline
+static CommunicationSystem::ControlBurst controlBurst(uiTimeline);
+
 #ifndef PIN_LORA_NSS
   #define PIN_LORA_NSS   8
 #endif
@@ -87,16 +147,7 @@ static Preferences prefs;
 
 static bool isSender = true;
 static uint32_t seq = 0;
-static uint32_t lastButtonMs = 0;
-static int lastButtonState = HIGH;
-static uint32_t buttonPressMs = 0;
-static bool buttonPressed = false;
-
-
 
-// Display mode cycling for receiver
-static uint8_t displayMode = 0;
-static const uint8_t MAX_DISPLAY_MODES = 3; // Signal info, network status, settings
 
 // LoRa parameters that can be changed at runtime
 static float currentFreq = LORA_FREQ_MHZ;
@@ -110,6 +161,22 @@ static const int sfValues[] = {7, 8, 9, 10, 11, 12};
 static const float bwValues[] = {62.5f, 125.0f, 250.0f, 500.0f};
 static const int txPowerValues[] = {2, 3, 5, 8, 10, 12, 15, 17, 20, 22};
 
+// Blocking radio calls, timed for the state-of-charge coulomb count
+static int radioTransmit(const char* msg) {
+  const uint32_t start = millis();
+  const int st = radio.transmit(msg);
+  const uint32_t end = millis();
+  Sensors::g_batterySoc.recordTx(end - start, (int8_t)currentTxPower, end);
+  return st;
+}
+
+static int radioReceive(String& rx, size_t len = 0) {
+  const uint32_t start = millis();
+  const int st = radio.receive(rx, len);
+  Sensors::g_batterySoc.recordRx(millis() - start);
+  return st;
+}
+
 // Forward declaration so it can be used by preset helper
 static void computeIndicesFromCurrent();
 static void updateRadioSettings();
@@ -160,10 +227,11 @@ static void applyLoRaPreset(int presetIndex) {
     updateRadioSettings();
     Serial.printf("[PRESET] Preset applied successfully\n");
 
-    // Broadcast the new preset to TX devices
+    // Broadcast the new preset to TX devices; the loop sends it, one
+    // packet per iteration
     if (!isSender) {
         Serial.printf("[PRESET] Broadcasting preset %d to TX devices\n", presetIndex);
-        broadcastConfigOnControlChannel(4, 200); // 4 times, 200ms apart
+        controlBurst.start(millis(), 4, 200); // 4 times, 200ms apart
     }
 }
 
@@ -234,122 +302,14 @@ static void broadcastConfigOnControlChannel(uint8_t times = 8, uint32_t interval
 static void tryReceiveConfigOnControlChannel(uint32_t durationMs = 4000);
 
 // Deep sleep functions
-static void enterDeepSleep();
 static void configureWakeupSources();
 static void restoreStateAfterWakeup();
 
-// Full-screen ping flash function
-static void drawFullScreenPingFlash();
-
-// IP address scrolling state
-static String currentIP = "";
-static int ipScrollOffset = 0;
-static uint32_t lastScrollUpdate = 0;
-static const uint32_t SCROLL_INTERVAL_MS = 300; // Scroll every 300ms
-static const int MAX_DISPLAY_WIDTH = 12; // Maximum characters that fit on screen
-
-// Full-screen ping flash mode state
-static const uint32_t IDLE_TIMEOUT_MS = 10000; // 10 seconds to enter idle mode
-static const uint32_t INTERACTIVE_TIMEOUT_MS = 30000; // 30 seconds to return to idle mode
-static uint32_t lastButtonPressTime = 0;
-static bool isInIdleMode = false;
-static uint32_t idleModeStartTime = 0;
-
 // RTC memory for deep sleep state preservation
 RTC_DATA_ATTR uint32_t sleepCount = 0;
 RTC_DATA_ATTR uint32_t lastSleepTime = 0;
 RTC_DATA_ATTR bool wasInSleepMode = false;
 
-// Draw status bar at the bottom of the screen
-static void drawStatusBar() {
-  u8g2.setFont(u8g2_font_5x7_tr); // Smaller font for status bar
-
-  const int yPos = 120; // Bottom of screen
-  int xPos = 2;
-
-#ifdef ENABLE_WIFI_OTA
-  // WiFi status for both sender and receiver roles
-  if (wifiConnected) {
-    // Get IP address and handle scrolling if needed
-    String ipAddress = WiFi.localIP().toString();
-
-    // Reset scroll if IP changed
-    if (currentIP != ipAddress) {
-      currentIP = ipAddress;
-      ipScrollOffset = 0;
-      lastScrollUpdate = millis();
-    }
-
-    // Display IP address with scrolling if too long
-    const char* ipStr = ipAddress.c_str();
-    int ipLength = strlen(ipStr);
-
-    if (ipLength <= MAX_DISPLAY_WIDTH) {
-      // IP fits, display normally
-      u8g2.drawStr(xPos, yPos - 10, ipStr);
-    } else {
-      // IP is too long, implement scrolling
-      uint32_t now = millis();
-      if (now - lastScrollUpdate >= SCROLL_INTERVAL_MS) {
-        ipScrollOffset++;
-        // Reset scroll when we've shown the entire string
-        if (ipScrollOffset > ipLength - MAX_DISPLAY_WIDTH) {
-          ipScrollOffset = 0;
-        }
-        lastScrollUpdate = now;
-      }
-
-      // Create substring for scrolling display
-      char scrolledIP[MAX_DISPLAY_WIDTH + 1];
-      strncpy(scrolledIP, ipStr + ipScrollOffset, MAX_DISPLAY_WIDTH);
-      scrolledIP[MAX_DISPLAY_WIDTH] = '\0';
-      u8g2.drawStr(xPos, yPos - 10, scrolledIP);
-    }
-
-    // Display network location
-    const char* location = getCurrentNetworkLocation();
-    u8g2.drawStr(xPos, yPos, location);
-    xPos += (strlen(location) * 6); // Approximate character width
-  } else {
-    u8g2.drawStr(xPos, yPos, "NoWiFi");
-    xPos += 20;
-  }
-
-  // OTA status for both roles
-  if (otaActive) {
-    u8g2.drawStr(xPos, yPos, "OTA");
-    xPos += 20;
-  }
-
-  // LoRa OTA status for both roles
-  if (loraOtaActive) {
-    u8g2.drawStr(xPos, yPos, "LoRaOTA");
-  }
-#endif
-
-  // --- Battery Level ---
-  {
-    uint8_t batt = HardwareAbstraction::Power::getBatteryPercent();
-    char battStr[8];
-    snprintf(battStr, sizeof(battStr), "%u%%", batt);
-
-    // Debug output for battery level
-    static uint32_t lastBattDebug = 0;
-    if (millis() - lastBattDebug >= 5000) { // Debug every 5 seconds
-      Serial.printf("[STATUS_BAR] Battery level: %u%%\n", batt);
-      lastBattDebug = millis();
-    }
-
-    // Right-align battery text within 64px width screen
-    int textWidth = strlen(battStr) * 6; // 6px per char (5x7 font +1 spacing)
-    int drawX = 62 - textWidth;          // leave 2px margin
-    if (drawX < xPos) {
-      drawX = xPos; // Avoid overlap with previous status items
-    }
-    u8g2.drawStr(drawX, yPos, battStr);
-  }
-}
-
 // Trigger ping dot flash
 static void triggerPingDotBlink() {
   if (!dotBlinkActive) {
@@ -362,86 +322,66 @@ static void triggerPingDotBlink() {
   }
 }
 
-// Draw ping flash dot if active
-static void drawPingDot() {
-  if (!dotBlinkActive) return;
+// Whether the ping flash is still showing; ends it after its duration
+static bool pingDotVisible() {
+  if (!dotBlinkActive) return false;
 
-  uint32_t now = millis();
-  uint32_t elapsed = now - dotBlinkStartMs;
+  uint32_t elapsed = millis() - dotBlinkStartMs;
 
   // Stop flashing after duration
   if (elapsed >= DOT_FLASH_DURATION_MS) {
     dotBlinkActive = false;
     Serial.println("[DEBUG] Ping dot flash finished");
-    return;
+    return false;
   }
+  return true;
+}
 
-  if (isInIdleMode) {
-    // Full-screen ping flash mode
-    drawFullScreenPingFlash();
-  } else {
-    // Interactive mode - show small dot
-    u8g2.drawDisc(55, 12, 4); // Main ping flash dot
-    Serial.printf("[DEBUG] *** PING DOT VISIBLE *** elapsed=%lu ms\n", elapsed);
-  }
+// Short node id carried in PING frames: last two bytes of the factory MAC
+static unsigned nodeId() {
+  return (unsigned)(ESP.getEfuseMac() >> 32) & 0xFFFF;
 }
 
-static void oledMsg(const char* l1, const char* l2 = nullptr, const char* l3 = nullptr) {
-  // Enhanced rate limiting to prevent I2C bus contention with faster main loop
-  static uint32_t lastOledUpdate = 0;
+// Push live values into the retained screen model; posts a snapshot to the
+// display task only if something visible changed
+static void refreshScreen() {
   uint32_t now = millis();
-  if (now - lastOledUpdate < 200) { // Increased to 200ms to prevent I2C bus contention
-    return;
-  }
-  lastOledUpdate = now;
 
-  // Add I2C mutex protection
-  static bool oledBusy = false;
-  if (oledBusy) {
-    return; // Skip if already in use
+  screenState.setRadio(isSender, currentSF, currentBW, currentFreq);
+  if (lastRSSI > -999.0) {
+    screenState.setSignal(lastRSSI, lastSNR);
   }
-  oledBusy = true;
-
-  u8g2.clearBuffer();
-  u8g2.setFont(u8g2_font_6x10_tr);
-
-  // Portrait layout: 64 pixels wide, 128 pixels tall
-
-  // Top section - main status
-  if (l1) u8g2.drawStr(2, 12, l1);
-
-  // Second line - additional info (if provided) - moved down one line
-  if (l2) u8g2.drawStr(2, 32, l2);
-
-  // Middle section - signal quality for receiver mode
-  if (!isSender && lastRSSI > -999.0) {
-    char rssiStr[12], snrStr[12];
-    snprintf(rssiStr, sizeof(rssiStr), "RSSI: %.0f", lastRSSI);
-    snprintf(snrStr, sizeof(snrStr), "SNR: %.1f", lastSNR);
 
-    u8g2.drawStr(2, 51, rssiStr);
-    u8g2.drawStr(2, 65, snrStr);
+#ifdef ENABLE_WIFI_OTA
+  uint8_t ip[4] = {0, 0, 0, 0};
+  const char* location = nullptr;
+  if (wifiConnected) {
+    IPAddress addr = WiFi.localIP();
+    for (int i = 0; i < 4; i++) ip[i] = addr[i];
+    location = getCurrentNetworkLocation();
   }
+  screenState.setNetwork(wifiConnected, ip, location, otaActive, loraOtaActive);
+#endif
 
-  // Bottom section - settings (moved up to make room for status bar)
-  char settings[32];
-  snprintf(settings, sizeof(settings), "SF%d BW%.0f", currentSF, currentBW);
-  u8g2.drawStr(2, 81, settings);
-
-  char modeStr[16];
-  snprintf(modeStr, sizeof(modeStr), "%s %.1fMHz", isSender ? "TX" : "RX", currentFreq);
-  u8g2.drawStr(2, 95, modeStr);
-
-  // Status bar at the bottom - WiFi and OTA status
-  drawStatusBar();
+  // Cached by the battery monitor and SoC estimator; no ADC or GPIO on the display path
+  if (Sensors::g_batterySoc.hasEstimate()) {
+    screenState.setBattery(Sensors::g_batterySoc.getPercent());
+  }
 
-    // Draw blinking dot if ping activity
-  drawPingDot();
+  screenState.setStorm(Sensors::g_stormTracker.getSummary());
+  screenState.setPing(pingDotVisible(), uiController.isIdle());
 
-  u8g2.sendBuffer();
+  if (screenState.update(now)) {
+    displayTask.post(screenState.getModel());
+  }
+}
 
-  // Release I2C mutex
-  oledBusy = false;
+// Queue a transient message; it stays up for at least its hold time and is
+// never dropped for arriving too soon after another
+static void oledMsg(const char* l1, const char* l2 = nullptr,
+                    Display::MessagePriority priority = Display::MessagePriority::STATUS, uint32_t holdMs = 0) {
+  screenState.showMessage(l1, l2, priority, holdMs);
+  refreshScreen();
 }
 
 // Role display logic moved; device role is now chosen at runtime via RoleConfig
@@ -529,7 +469,7 @@ static void initDisplay() {
   if (!i2cInitialized) {
     Wire.begin(17, 18);
     Wire.setTimeOut(1000);
-    Wire.setClock(100000);
+    Wire.setClock(displayTask.getConfig().i2c_clock_hz);
     i2cInitialized = true;
     delay(100);
   }
@@ -550,6 +490,15 @@ static void initDisplay() {
 
   // Rotate display 90 degrees for portrait orientation
   u8g2.setDisplayRotation(U8G2_R1);
+
+  // Panel RAM holds whatever begin() left: first flush sends the full frame
+  oledRenderer.attach(u8g2.getBufferPtr(), &oledSink);
+  screenRenderer.invalidate();
+  screenState.setEnabledScreens(isSender ? SENDER_SCREENS : RECEIVER_SCREENS);
+  displayTask.begin(Display::ScreenRenderer::drawCallback, &screenRenderer, &oledRenderer);
+  if (!displayTask.start()) {
+    Serial.println("[OLED] Display task start failed");
+  }
 }
 
 static void updateRadioSettings() {
@@ -570,7 +519,7 @@ static void updateRadioSettings() {
   if (st != RADIOLIB_ERR_NONE) {
     Serial.printf("Failed to update radio settings: %d\n", st);
     char errBuf[16]; snprintf(errBuf, sizeof(errBuf), "Settings fail %d", st);
-    oledMsg("Settings fail", errBuf);
+    oledMsg("Settings fail", errBuf, Display::MessagePriority::ERROR);
   } else {
     Serial.printf("Radio updated: SF%d BW%.0f Tx%ddBm\n", currentSF, currentBW, currentTxPower);
     oledSettings();
@@ -582,7 +531,7 @@ static void initRadioOrHalt() {
   int st = radio.begin(currentFreq, currentBW, currentSF, currentCR, 0x34, currentTxPower);
   if (st != RADIOLIB_ERR_NONE) {
     char buf[48]; snprintf(buf, sizeof(buf), "Radio fail %d", st);
-    oledMsg("Radio init", buf);
+    oledMsg("Radio init", buf, Display::MessagePriority::ERROR);
     while (true) { Serial.println(buf); delay(1000); }
   }
   radio.setDio2AsRfSwitch(true);
@@ -590,16 +539,19 @@ static void initRadioOrHalt() {
   oledSettings();
 }
 
-static void broadcastConfigOnControlChannel(uint8_t times, uint32_t intervalMs) {
-  // Switch to control channel
+// Control-channel steps, shared by the blocking broadcast and controlBurst
+static bool enterControlChannel() {
   int st = radio.begin(CTRL_FREQ_MHZ, CTRL_BW_KHZ, CTRL_SF, CTRL_CR, 0x34, currentTxPower);
   if (st != RADIOLIB_ERR_NONE) {
     Serial.printf("[CTRL] begin fail %d\n", st);
-    return;
+    return false;
   }
   radio.setDio2AsRfSwitch(true);
   radio.setCRC(true);
+  return true;
+}
 
+static bool transmitConfigOnControlChannel() {
   char msg[64];
   // Include preset information in broadcast
   if (currentPreset >= 0) {
@@ -609,15 +561,13 @@ static void broadcastConfigOnControlChannel(uint8_t times, uint32_t intervalMs)
     snprintf(msg, sizeof(msg), "CFG F=%.1f BW=%.0f SF=%d CR=%d TX=%d P=-1",
              currentFreq, currentBW, currentSF, currentCR, currentTxPower);
   }
+  int tx = radioTransmit(msg);
+  Serial.printf("[CTRL][TX] %s %s\n", msg, tx == RADIOLIB_ERR_NONE ? "OK" : "FAIL");
+  return tx == RADIOLIB_ERR_NONE;
+}
 
-  for (uint8_t i = 0; i < times; i++) {
-    int tx = radio.transmit(msg);
-    Serial.printf("[CTRL][TX] %s %s\n", msg, tx == RADIOLIB_ERR_NONE ? "OK" : "FAIL");
-    delay(intervalMs);
-  }
-
-  // Restore operational settings
-  st = radio.begin(currentFreq, currentBW, currentSF, currentCR, 0x34, currentTxPower);
+static void restoreOperationalChannel() {
+  int st = radio.begin(currentFreq, currentBW, currentSF, currentCR, 0x34, currentTxPower);
   if (st != RADIOLIB_ERR_NONE) {
     Serial.printf("[CTRL] restore begin fail %d\n", st);
   } else {
@@ -626,6 +576,24 @@ static void broadcastConfigOnControlChannel(uint8_t times, uint32_t intervalMs)
   }
 }
 
+static void broadcastConfigOnControlChannel(uint8_t times, uint32_t intervalMs) {
+  // This one retunes and restores by itself; a queued burst would step on it
+  controlBurst.cancel();
+
+  // Switch to control channel
+  if (!enterControlChannel()) {
+    return;
+  }
+
+  for (uint8_t i = 0; i < times; i++) {
+    transmitConfigOnControlChannel();
+    delay(intervalMs);
+  }
+
+  // Restore operational settings
+  restoreOperationalChannel();
+}
+
 static void tryReceiveConfigOnControlChannel(uint32_t durationMs) {
   // Switch to control channel
   int st = radio.begin(CTRL_FREQ_MHZ, CTRL_BW_KHZ, CTRL_SF, CTRL_CR, 0x34, currentTxPower);
@@ -647,7 +615,7 @@ static void tryReceiveConfigOnControlChannel(uint32_t durationMs) {
     #endif
 
     String rx;
-    int r = radio.receive(rx, 0); // Make non-blocking
+    int r = radioReceive(rx, 0); // Make non-blocking
     if (r == RADIOLIB_ERR_NONE && rx.startsWith("CFG ")) {
       float nf = currentFreq;
       float nb = currentBW;
@@ -698,115 +666,32 @@ static void tryReceiveConfigOnControlChannel(uint32_t durationMs) {
   }
 }
 
-static void handleSenderButtonAction(ButtonAction action) {
-  // Record button press time and exit idle mode
-  lastButtonPressTime = millis();
-  if (isInIdleMode) {
-    isInIdleMode = false;
-    Serial.println("[IDLE] Exiting idle mode due to button press");
-    oledMsg("Interactive", "Mode");
-    delay(1000);
-  }
-
-  switch (action) {
-    case ButtonAction::CyclePreset:
-      // Cycle through LoRa presets
-      {
-        int nextPreset = (currentPreset + 1) % PRESET_COUNT;
-        applyLoRaPreset(nextPreset);
-        savePersistedSettings();
-        startConfigBroadcast(currentFreq, currentBW, currentSF, currentCR, currentTxPower);
-        Serial.printf("Preset change requested -> %s (index %d)\n", loRaPresets[nextPreset].name, nextPreset);
-        oledMsg("Preset", loRaPresets[nextPreset].shortName);
-      }
-      break;
-    case ButtonAction::SleepMode:
-      Serial.println("Sleep mode requested");
-      enterDeepSleep();
-      break;
-    default:
-      break;
-  }
-}
-
-static void handleReceiverButtonAction(ButtonAction action) {
-  // Record button press time and exit idle mode
-  lastButtonPressTime = millis();
-  if (isInIdleMode) {
-    isInIdleMode = false;
-    Serial.println("[IDLE] Exiting idle mode due to button press");
-    oledMsg("Interactive", "Mode");
-    delay(1000);
-  }
-
-  Serial.printf("[RX_BTN] Handling action: %d\n", (int)action);
-  switch (action) {
-    case ButtonAction::CyclePreset:
-      {
-        int nextPreset = (currentPreset + 1) % PRESET_COUNT;
-        applyLoRaPreset(nextPreset);
-        savePersistedSettings();
-        Serial.printf("[RX_BTN] Preset change -> %s (index %d)\n", loRaPresets[nextPreset].name, nextPreset);
-        oledMsg("Preset", loRaPresets[nextPreset].shortName);
-      }
-      break;
-    case ButtonAction::SleepMode:
-      Serial.println("[RX_BTN] Sleep mode triggered");
-      Serial.println("Sleep mode requested");
-      enterDeepSleep();
-      break;
-    default:
-      Serial.printf("[RX_BTN] Unknown action: %d\n", (int)action);
-      break;
+// UiController hook: next preset; senders announce it on the operational
+// channel, receivers queue a control-channel burst in applyLoRaPreset()
+static const char* uiCyclePreset(bool broadcast) {
+  int nextPreset = (currentPreset + 1) % PRESET_COUNT;
+  applyLoRaPreset(nextPreset);
+  savePersistedSettings();
+  if (broadcast) {
+    startConfigBroadcast(currentFreq, currentBW, currentSF, currentCR, currentTxPower);
   }
+  Serial.printf("Preset change requested -> %s (index %d)\n", loRaPresets[nextPreset].name, nextPreset);
+  return loRaPresets[nextPreset].shortName;
 }
 
 static void updateButton() {
-  static uint32_t callCount = 0;
-  callCount++;
-
-  int s = digitalRead(BUTTON_PIN);
-  uint32_t now = millis();
-
-  // Debug button state every 5 seconds
-  static uint32_t lastDebugMs = 0;
-  if (now - lastDebugMs >= 5000) {
-    int altState = digitalRead(ALT_BUTTON_PIN);
-    Serial.printf("[BTN_DEBUG] Main pin: %d, Alt pin: %d, lastButtonState: %d, buttonPressed: %s, role: %s, calls: %lu\n",
-                  s, altState, lastButtonState, buttonPressed ? "true" : "false", isSender ? "Sender" : "Receiver", callCount);
-    lastDebugMs = now;
-  }
-
-  // Button press detection
-  if (lastButtonState == HIGH && s == LOW) {
-    buttonPressed = true;
-    buttonPressMs = now;
-    Serial.printf("[BTN] Press detected (role: %s)\n", isSender ? "Sender" : "Receiver");
-  }
-
-  // Button release detection
-  if (lastButtonState == LOW && s == HIGH && buttonPressed) {
-    buttonPressed = false;
-    uint32_t pressDuration = now - buttonPressMs;
-    Serial.printf("[BTN] Release detected, duration: %lu ms (role: %s)\n", pressDuration, isSender ? "Sender" : "Receiver");
-
-    // Handle single press actions
-    ButtonAction action = classifyPress(pressDuration);
-    Serial.printf("[BTN] Single press action: %d\n", (int)action);
-    if (action != ButtonAction::Ignore) {
-      if (isSender) {
-        Serial.println("[BTN] Handling sender action");
-        handleSenderButtonAction(action);
-      } else {
-        Serial.println("[BTN] Handling receiver action");
-        handleReceiverButtonAction(action);
-      }
+  // Without the interrupt, poll the pin and feed level changes through the
+  // same debounce path, at loop granularity
+  if (!Sensors::g_button.isAttached()) {
+    static int lastLevel = HIGH;
+    const int level = digitalRead(BUTTON_PIN);
+    if (level != lastLevel) {
+      lastLevel = level;
+      Sensors::g_button.pushEdge(micros(), level == HIGH);
     }
-
-    lastButtonMs = now;
   }
 
-  lastButtonState = s;
+  uiController.serviceButton(Sensors::g_button, isSender, millis());
 }
 
 // OTA Function Declarations
@@ -823,9 +708,6 @@ static void checkLoraOtaTimeout();
 static void sendLoraOtaUpdate(const uint8_t* firmware, size_t firmwareSize);
 #endif
 
-// OLED Display Functions
-static void drawStatusBar();
-
 // Simple button test function
 static void testButton() {
   Serial.println("[BTN_TEST] Starting button test...");
@@ -860,7 +742,8 @@ static void testButton() {
 
 // Deep sleep implementation
 static void configureWakeupSources() {
-  // Configure button as wake-up source
+  // Configure button as wake-up source; RTC IO takes the pin over from the GPIO interrupt
+  Sensors::g_button.end();
   esp_sleep_enable_ext0_wakeup((gpio_num_t)BUTTON_PIN, LOW);
 
   // Also enable timer wake-up as backup (30 seconds)
@@ -869,60 +752,8 @@ static void configureWakeupSources() {
   Serial.println("[SLEEP] Wake-up sources configured: button (LOW) + 30s timer");
 }
 
-// Idle mode management
-static void checkIdleMode() {
-  uint32_t currentTime = millis();
-
-  // Check if we should enter idle mode (no button press for IDLE_TIMEOUT_MS)
-  if (!isInIdleMode && (currentTime - lastButtonPressTime) > IDLE_TIMEOUT_MS) {
-    isInIdleMode = true;
-    idleModeStartTime = currentTime;
-    Serial.println("[IDLE] Entering full-screen ping flash mode");
-    oledMsg("Idle Mode", "Full Screen");
-    delay(1000);
-  }
-
-  // Check if we should exit idle mode (been in interactive mode for INTERACTIVE_TIMEOUT_MS)
-  if (isInIdleMode && (currentTime - idleModeStartTime) > INTERACTIVE_TIMEOUT_MS) {
-    isInIdleMode = false;
-    Serial.println("[IDLE] Returning to full-screen ping flash mode");
-    oledMsg("Idle Mode", "Full Screen");
-    delay(1000);
-  }
-}
-
-// Full-screen ping flash function
-static void drawFullScreenPingFlash() {
-  if (!isInIdleMode) return;
-
-  // Clear the entire screen
-  u8g2.clearBuffer();
-
-  // Draw a large, centered ping indicator
-  u8g2.setFont(u8g2_font_ncenB14_tr);
-  u8g2.setDrawColor(1);
-
-  // Calculate center position
-  int textWidth = u8g2.getStrWidth("PING");
-  int x = (u8g2.getDisplayWidth() - textWidth) / 2;
-  int y = (u8g2.getDisplayHeight() + 14) / 2; // +14 for font height
-
-  // Draw "PING" text
-  u8g2.drawStr(x, y, "PING");
-
-  // Draw a large circle around it
-  int centerX = u8g2.getDisplayWidth() / 2;
-  int centerY = u8g2.getDisplayHeight() / 2;
-  int radius = 25;
-  u8g2.drawCircle(centerX, centerY, radius);
-
-  // Send to display
-  u8g2.sendBuffer();
-}
-
-static void enterDeepSleep() {
-  Serial.println("[SLEEP] Entering deep sleep mode...");
-
+// UiController hook: runs while the sleep message shows
+static void uiPrepareSleep() {
   // Save current state to RTC memory
   sleepCount++;
   lastSleepTime = millis();
@@ -930,13 +761,15 @@ static void enterDeepSleep() {
 
   // Save important settings to flash before sleep
   savePersistedSettings();
+}
 
-  // Show sleep message on OLED
-  oledMsg("Sleep Mode", "Entering...");
-  delay(1000);
-
-  // Turn off OLED to save power
-  u8g2.setPowerSave(1);
+// UiController hook: the sleep message has been seen
+static void uiPowerDown() {
+  // Turn off OLED to save power, once the display task is off the bus
+  if (displayTask.acquireBus(500)) {
+    u8g2.setPowerSave(1);
+    displayTask.releaseBus();
+  }
 
   // Configure wake-up sources
   configureWakeupSources();
@@ -958,16 +791,26 @@ static void restoreStateAfterWakeup() {
     wasInSleepMode = false;
 
     // Restore OLED power
-    u8g2.setPowerSave(0);
+    if (displayTask.acquireBus(500)) {
+      u8g2.setPowerSave(0);
+      displayTask.releaseBus();
+    }
 
     // Show wake-up message
     oledMsg("Wake Up", "Resuming...");
-    delay(1000);
 
     Serial.println("[SLEEP] State restored, resuming normal operation");
   }
 }
 
+#ifdef ENABLE_WIFI_OTA
+// Unix seconds once NTP has set the clock, 0 before
+static uint32_t eventLogUnixTime() {
+  const time_t now = time(nullptr);
+  return now > 1600000000 ? static_cast<uint32_t>(now) : 0;
+}
+#endif
+
 void setup() {
   Serial.begin(115200);
   delay(500);
@@ -978,6 +821,25 @@ void setup() {
     Serial.println("[ERROR] HardwareAbstraction init failed");
   }
 
+  // Background battery sampling through this board's calibration. The VBAT
+  // tap is on the DMA sampler, which the monitor runs only for its bursts
+  // while the divider gate is open; one-shot reads if it cannot start.
+  Sensors::BatteryMonitorConfig batteryConfig = Sensors::getDefaultBatteryMonitorConfig();
+  batteryConfig.calibration = &HardwareAbstraction::g_powerCalibration;
+  HardwareAbstraction::g_continuousAdc.addChannel(batteryConfig.adc_pin,
+                                                  Sensors::BatteryMonitor::continuousRateHz(batteryConfig));
+  batteryConfig.continuous = &HardwareAbstraction::g_continuousAdc;
+  Sensors::g_batteryMonitor.begin(batteryConfig, millis());
+  Sensors::g_batterySoc.begin(Sensors::getDefaultBatterySocConfig());
+
+  // Strike/alert history on the "eventlog" partition (partitions_eventlog.csv)
+  if (Logging::g_eventLog.begin(HardwareAbstraction::openFlashPartition("eventlog"))) {
+    const uint8_t resetReason = static_cast<uint8_t>(esp_reset_reason());
+    Logging::g_eventLog.append(Logging::EventType::BOOT, &resetReason, sizeof(resetReason));
+  } else {
+    Serial.println("[SETUP] No event log partition, strike history disabled");
+  }
+
   // Check if we're waking up from deep sleep
   restoreStateAfterWakeup();
 
@@ -992,20 +854,32 @@ void setup() {
   Serial.printf("[SETUP] Main button state: %d, Alt button state: %d (HIGH=%d, LOW=%d)\n",
                 initialButtonState, initialAltButtonState, HIGH, LOW);
 
-  // Explicitly initialize button state variables
-  lastButtonState = HIGH;
-  buttonPressed = false;
-  Serial.println("[SETUP] Button state variables initialized");
 
-  // Initialize idle mode variables
-  lastButtonPressTime = millis();
-  isInIdleMode = false;
-  idleModeStartTime = 0;
+  // Button actions, idle mode and sleep
+  Display::UiControllerHooks uiHooks = {};
+  uiHooks.cyclePreset = uiCyclePreset;
+  uiHooks.prepareSleep = uiPrepareSleep;
+  uiHooks.powerDown = uiPowerDown;
+  uiHooks.messageShown = refreshScreen;
+  uiController.setHooks(uiHooks);
+  CommunicationSystem::ControlBurstHooks burstHooks = {};
+  burstHooks.enterControl = enterControlChannel;
+  burstHooks.transmit = transmitConfigOnControlChannel;
+  burstHooks.restore = restoreOperationalChannel;
+  controlBurst.setHooks(burstHooks);
+  uiController.begin(millis());
   Serial.println("[SETUP] Idle mode variables initialized");
 
   // Test button functionality
   testButton();
 
+  // Button edges from here on come through the interrupt queue
+  Sensors::ButtonInputConfig buttonConfig = Sensors::getDefaultButtonInputConfig();
+  buttonConfig.pin = BUTTON_PIN;
+  if (!Sensors::g_button.begin(buttonConfig)) {
+    Serial.println("[SETUP] Button interrupt unavailable, polling the pin");
+  }
+
   // Initialize current values
   currentFreq = LORA_FREQ_MHZ;
   currentBW = LORA_BW_KHZ;
@@ -1024,7 +898,6 @@ void setup() {
 
   initDisplay();
   oledMsg("Booting...", "Heltec V3");
-  oledMsg("Role", isSender ? "Sender" : "Receiver");
 
   initRadioOrHalt();
 
@@ -1036,6 +909,9 @@ void setup() {
   Serial.printf("[MAIN] wifiConnected variable: %s\n", wifiConnected ? "TRUE" : "FALSE");
   if (wifiConnected) {
     initOTA();
+    // Wall-clock time for event log records (queried by /api/v1/events from/to)
+    configTime(0, 0, "pool.ntp.org");
+    Logging::g_eventLog.setTimeSource(eventLogUnixTime);
     oledMsg("WiFi + OTA", "Ready");
     // Start web interface server for both modes when WiFi is connected
     Serial.println("[MAIN] Starting web server...");
@@ -1063,6 +939,7 @@ void loop() {
   static uint32_t lastTxMs = 0;
   static uint32_t lastRxMs = 0;
   uint32_t now = millis();
+  loopBudget.beginIteration();
 
   // Handle web server requests for both modes when WiFi connected
 #ifdef ENABLE_WIFI_OTA
@@ -1080,8 +957,11 @@ void loop() {
   }
 #endif
 
+  loopBudget.checkpoint("web server");
+
   // Check button more frequently
   updateButton();
+  loopBudget.checkpoint("button");
 
   // Check if web interface has changed preferences
   static uint32_t lastPrefCheck = 0;
@@ -1106,8 +986,11 @@ void loop() {
     }
   }
 
+  loopBudget.checkpoint("preferences");
+
   // Check and manage idle mode transitions
-  checkIdleMode();
+  uiController.checkIdle(millis());
+  loopBudget.checkpoint("idle mode");
 
   if (isSender) {
     // Check for control channel updates from receiver (every 5 seconds)
@@ -1125,7 +1008,7 @@ void loop() {
         char msg[64];
         snprintf(msg, sizeof(msg), "CFG F=%.1f BW=%.0f SF=%d CR=%d TX=%d",
                  pendingFreq, pendingBW, pendingSF, pendingCR, pendingTxPower);
-        int st = radio.transmit(msg);
+        int st = radioTransmit(msg);
         if (st == RADIOLIB_ERR_NONE) {
           Serial.printf("[TX] %s OK\n", msg);
         } else {
@@ -1163,8 +1046,8 @@ void loop() {
       // Non-blocking TX every 2 seconds
       if (now - lastTxMs >= 2000) {
         char msg[48];
-        snprintf(msg, sizeof(msg), "PING seq=%lu", (unsigned long)seq++);
-        int st = radio.transmit(msg);
+        snprintf(msg, sizeof(msg), "PING seq=%lu id=%04X", (unsigned long)seq++, nodeId());
+        int st = radioTransmit(msg);
         if (st == RADIOLIB_ERR_NONE) {
           Serial.printf("[TX] %s OK\n", msg);
           Serial.printf("[DEBUG] TX seq counter at: %lu\n", (unsigned long)(seq-1));
@@ -1173,16 +1056,17 @@ void loop() {
         } else {
           char e[24]; snprintf(e, sizeof(e), "err %d", st);
           Serial.printf("[TX] %s FAIL %s\n", msg, e);
-          oledMsg("TX FAIL", msg, e);
+          oledMsg("TX FAIL", e, Display::MessagePriority::ERROR);
         }
         lastTxMs = now;
       }
     }
   } else {
-    // Non-blocking RX every 50ms
-    if (now - lastRxMs >= 50) {
+    // Non-blocking RX every 50ms; not while a preset burst holds the radio
+    // on the control channel
+    if (!controlBurst.isActive() && now - lastRxMs >= 50) {
       String rx;
-      int st = radio.receive(rx, 0); // 0 = immediate return, non-blocking
+      int st = radioReceive(rx, 0); // 0 = immediate return, non-blocking
       if (st == RADIOLIB_ERR_NONE) {
         float rssi = radio.getRSSI();
         float snr  = radio.getSNR();
@@ -1220,13 +1104,11 @@ void loop() {
 
             updateRadioSettings();
             savePersistedSettings();
-            char l2[20]; snprintf(l2, sizeof(l2), "RSSI %.1f", rssi);
             Serial.printf("[RX] APPLIED %s | SNR %.1f | PKT:%lu\n", rx.c_str(), snr, packetCount);
-            oledMsg("SYNC", rx.c_str(), l2);
+            oledMsg("SYNC", rx.c_str());
           } else {
-            char l2[20]; snprintf(l2, sizeof(l2), "RSSI %.1f", rssi);
             Serial.printf("[RX] CFG PARSE FAIL | %s | SNR %.1f | PKT:%lu\n", rx.c_str(), snr, packetCount);
-            oledMsg("RX", rx.c_str(), l2);
+            oledMsg("RX", rx.c_str(), Display::MessagePriority::INFO);
           }
         } else if (rx.startsWith("OTA_")) {
           // Handle OTA packets (both roles)
@@ -1235,7 +1117,7 @@ void loop() {
           // Sender: request update when notified
           if (isSender) {
             Serial.println("FW update notice received; requesting update...");
-            radio.transmit("REQUEST_UPDATE");
+            radioTransmit("REQUEST_UPDATE");
           }
         } else if (rx.startsWith("REQUEST_UPDATE")) {
           // Receiver only: handle update request from transmitter
@@ -1244,7 +1126,7 @@ void loop() {
             oledMsg("Update Req", "Received");
 
             // Acknowledge the request
-            radio.transmit("UPDATE_ACK");
+            radioTransmit("UPDATE_ACK");
             delay(100);
 
             // Send the actual firmware if we have it stored
@@ -1255,11 +1137,11 @@ void loop() {
               sendLoraOtaUpdate(storedFirmware, storedFirmwareSize);
             } else {
               Serial.println("No firmware stored to send!");
-              oledMsg("No FW", "Stored");
-              radio.transmit("NO_FIRMWARE");
+              oledMsg("No FW", "Stored", Display::MessagePriority::WARNING);
+              radioTransmit("NO_FIRMWARE");
             }
             #else
-            radio.transmit("NO_FIRMWARE");
+            radioTransmit("NO_FIRMWARE");
             #endif
           }
         } else {
@@ -1271,25 +1153,31 @@ void loop() {
               unsigned long rxSeq = strtoul(seqPtr + 4, nullptr, 10);
               Serial.printf("[DEBUG] RX parsed seq: %lu\n", rxSeq);
             }
+            // Node table entry; senders without an id show up as 0000
+            const char* idPtr = strstr(rx.c_str(), "id=");
+            uint16_t nodeIdRx = idPtr ? (uint16_t)strtoul(idPtr + 3, nullptr, 16) : 0;
+            screenState.updateNode(nodeIdRx, rssi, snr, now);
             // Log ping reception to serial console
             Serial.printf("[RX] %s | %s | SNR %.1f | PKT:%lu\n", rx.c_str(), l2, snr, packetCount);
             // Trigger blinking dot instead of showing PING text
             triggerPingDotBlink();
           } else {
             Serial.printf("[RX] %s | %s | SNR %.1f | PKT:%lu\n", rx.c_str(), l2, snr, packetCount);
-            oledMsg("RX", rx.c_str(), l2);
+            oledMsg("RX", rx.c_str(), Display::MessagePriority::INFO);
           }
         }
       } else if (st != RADIOLIB_ERR_RX_TIMEOUT) {
         errorCount++;
         char e[24]; snprintf(e, sizeof(e), "err %d", st);
         Serial.printf("[RX] FAIL %s | ERR:%lu\n", e, errorCount);
-        oledMsg("RX FAIL", e);
+        oledMsg("RX FAIL", e, Display::MessagePriority::ERROR);
       }
       lastRxMs = now;
     }
   }
 
+  loopBudget.checkpoint(isSender ? "sender radio" : "receiver radio");
+
   // Handle OTA updates (WiFi OTA only on receiver)
   #ifdef ENABLE_WIFI_OTA
   if (!isSender && wifiConnected) {
@@ -1300,7 +1188,7 @@ void loop() {
     if (now - lastWiFiCheck >= 30000) { // Check every 30 seconds
       if (!checkWiFiConnection()) {
         wifiConnected = false;
-        oledMsg("WiFi", "Reconnecting...");
+        oledMsg("WiFi", "Reconnecting...", Display::MessagePriority::WARNING);
       } else if (!wifiConnected) {
         wifiConnected = true;
         oledMsg("WiFi", "Reconnected");
@@ -1313,20 +1201,34 @@ void loop() {
   // Check LoRa OTA timeout (both roles)
   checkLoraOtaTimeout();
 
-        // Refresh display when dot state changes
-  static bool lastDotState = false;
-  static uint32_t lastDotRefresh = 0;
-
-        if (dotBlinkActive && (now - lastDotRefresh >= 200)) {
-    // Refresh display periodically while dot is active (keep original display content)
-    // The dot will be added automatically by drawPingDot() in oledMsg()
-    oledMsg("Role", isSender ? "Sender" : "Receiver"); // Show normal "Mode" / "Sender" or "Receiver" display
-    lastDotRefresh = now;
-  } else if (lastDotState && !dotBlinkActive) {
-    // Dot just finished - refresh display to clear it (normal content, no dot)
-    oledMsg("Role", isSender ? "Sender" : "Receiver"); // Show normal "Mode" / "Sender" or "Receiver" display
+  loopBudget.checkpoint("OTA");
+
+  // Opens the divider gate, or reads a burst once it has settled; each new
+  // burst moves the state-of-charge estimate on
+  static uint32_t lastBatteryBurst = 0;
+  Sensors::g_batteryMonitor.update(millis());
+  if (Sensors::g_batteryMonitor.getStats().bursts != lastBatteryBurst) {
+    lastBatteryBurst = Sensors::g_batteryMonitor.getStats().bursts;
+    // The burst as read, not the EMA: compensation needs the load of that moment
+    Sensors::g_batterySoc.update(Sensors::g_batteryMonitor.getLastBurstVoltage(),
+                                 Sensors::g_batteryMonitor.getLastBurstStartMs(),
+                                 Sensors::g_batteryMonitor.getLastBurstEndMs());
   }
-  lastDotState = dotBlinkActive;
+  loopBudget.checkpoint("battery");
+
+  // Deferred UI steps whose message has had its time on screen
+  uiTimeline.poll(millis());
+
+  // Ping dot, message holds, node ages and live values; posts only on change
+  refreshScreen();
+  loopBudget.checkpoint("UI");
+
+  if (!loopBudget.endIteration() && loopBudget.getStats().overruns == 1) {
+    Serial.printf("[LOOP] Iteration took %lu us, budget %lu us; slowest step so far: %s\n",
+                  (unsigned long)loopBudget.getStats().last_iteration_us,
+                  (unsigned long)loopBudget.getConfig().budget_us, loopBudget.getStats().max_span_label);
+  }
+  loopBudget.report(millis());
 
   // Small delay to prevent overwhelming the system, but keep button responsive
   delay(1); // Reduced from 10ms to 1ms for better web server responsiveness
@@ -1353,7 +1255,7 @@ static void initWiFi() {
     oledMsg("WiFi", location);
   } else {
     Serial.println("\nWiFi connection failed!");
-    oledMsg("WiFi", "Failed!");
+    oledMsg("WiFi", "Failed!", Display::MessagePriority::ERROR);
   }
 }
 
@@ -1373,7 +1275,6 @@ static void initOTA() {
     otaActive = false;
     Serial.println("OTA Update complete!");
     oledMsg("OTA", "Complete!");
-    delay(1000);
 
     // NEW: Store the firmware for LoRa OTA cascade updates
     #ifdef ENABLE_WIFI_OTA
@@ -1382,7 +1283,6 @@ static void initOTA() {
       if (storeCurrentFirmware()) {
         Serial.println("Firmware stored for LoRa OTA distribution");
         oledMsg("Firmware", "Stored");
-        delay(1000);
 
         // Now trigger LoRa firmware updates
         Serial.println("Triggering LoRa firmware updates...");
@@ -1390,8 +1290,7 @@ static void initOTA() {
         triggerLoraFirmwareUpdates();
       } else {
         Serial.println("Failed to store firmware for LoRa OTA");
-        oledMsg("Firmware", "Store failed");
-        delay(1000);
+        oledMsg("Firmware", "Store failed", Display::MessagePriority::ERROR);
       }
     }
     #endif
@@ -1401,7 +1300,7 @@ static void initOTA() {
     int percent = (progress * 100) / total;
     char progressStr[20];
     snprintf(progressStr, sizeof(progressStr), "%d%%", percent);
-    oledMsg("OTA Update", progressStr);
+    oledMsg("OTA Update", progressStr, Display::MessagePriority::INFO);
   });
 
   ArduinoOTA.onError([](ota_error_t error) {
@@ -1409,7 +1308,7 @@ static void initOTA() {
     Serial.printf("OTA Error: %u\n", error);
     char errorStr[20];
     snprintf(errorStr, sizeof(errorStr), "Error: %u", error);
-    oledMsg("OTA Error", errorStr);
+    oledMsg("OTA Error", errorStr, Display::MessagePriority::ERROR);
   });
 
   ArduinoOTA.begin();
@@ -1450,7 +1349,7 @@ static void handleLoraOtaPacket(const String& packet) {
         int percent = (loraOtaReceivedSize * 100) / loraOtaExpectedSize;
         char progressStr[20];
         snprintf(progressStr, sizeof(progressStr), "%d%%", percent);
-        oledMsg("LoRa OTA", progressStr);
+        oledMsg("LoRa OTA", progressStr, Display::MessagePriority::INFO);
       }
     }
   } else if (packet.startsWith("OTA_END:")) {
@@ -1466,16 +1365,15 @@ static void handleLoraOtaPacket(const String& packet) {
         (void)Update.write(loraOtaBuffer, loraOtaBufferSize); // Suppress unused variable warning
         if (Update.end()) {
           Serial.println("Firmware flashed successfully!");
-          oledMsg("OTA Complete", "Rebooting...");
-          delay(2000);
-          ESP.restart();
+          oledMsg("OTA Complete", "Rebooting...", Display::MessagePriority::STATUS, 2000);
+          uiTimeline.schedule(millis(), 2000, [](void*) { ESP.restart(); }, nullptr, "reboot");
         } else {
           Serial.println("Firmware flash failed!");
-          oledMsg("OTA Error", "Flash failed!");
+          oledMsg("OTA Error", "Flash failed!", Display::MessagePriority::ERROR);
         }
       } else {
         Serial.println("OTA begin failed!");
-        oledMsg("OTA Error", "Begin failed!");
+        oledMsg("OTA Error", "Begin failed!", Display::MessagePriority::ERROR);
       }
     }
 
@@ -1486,7 +1384,7 @@ static void handleLoraOtaPacket(const String& packet) {
 static void checkLoraOtaTimeout() {
   if (loraOtaActive && (millis() - loraOtaStartTime > loraOtaTimeout)) {
     Serial.println("LoRa OTA timeout!");
-    oledMsg("LoRa OTA", "Timeout!");
+    oledMsg("LoRa OTA", "Timeout!", Display::MessagePriority::ERROR);
     loraOtaActive = false;
   }
 }
@@ -1502,7 +1400,7 @@ static void sendLoraOtaUpdate(const uint8_t* firmware, size_t firmwareSize) {
   // Send OTA start packet
   char startMsg[64];
   snprintf(startMsg, sizeof(startMsg), "OTA_START:%zu:%lu", firmwareSize, loraOtaTimeout);
-  radio.transmit(startMsg);
+  radioTransmit(startMsg);
   delay(100);
 
   // Break firmware into chunks and send
@@ -1522,7 +1420,7 @@ static void sendLoraOtaUpdate(const uint8_t* firmware, size_t firmwareSize) {
     chunkMsg[strlen(chunkMsg) + currentChunkSize] = '\0';
 
     // Send chunk
-    radio.transmit(chunkMsg);
+    radioTransmit(chunkMsg);
     delay(50);
 
     sentBytes += currentChunkSize;
@@ -1532,11 +1430,11 @@ static void sendLoraOtaUpdate(const uint8_t* firmware, size_t firmwareSize) {
     int percent = (sentBytes * 100) / firmwareSize;
     char progressStr[20];
     snprintf(progressStr, sizeof(progressStr), "Sending %d%%", percent);
-    oledMsg("LoRa OTA", progressStr);
+    oledMsg("LoRa OTA", progressStr, Display::MessagePriority::INFO);
   }
 
   // Send OTA end packet
-  radio.transmit("OTA_END:");
+  radioTransmit("OTA_END:");
   delay(100);
 
   Serial.println("LoRa OTA update sent!");
@@ -1557,7 +1455,7 @@ static void triggerLoraFirmwareUpdates() {
   // Send multiple notifications to ensure transmitters receive them
   for (int i = 0; i < 10; i++) {
     // Send firmware update available notification
-    radio.transmit("FW_UPDATE_AVAILABLE");
+    radioTransmit("FW_UPDATE_AVAILABLE");
     delay(200);
 
           // Send version info from stored firmware
@@ -1567,11 +1465,11 @@ static void triggerLoraFirmwareUpdates() {
       } else {
         snprintf(versionMsg, sizeof(versionMsg), "FW_VERSION:0.0.0");
       }
-      radio.transmit(versionMsg);
+      radioTransmit(versionMsg);
       delay(200);
 
     // Send update trigger command
-    radio.transmit("UPDATE_NOW");
+    radioTransmit("UPDATE_NOW");
     delay(200);
   }
 
@@ -1589,7 +1487,7 @@ static void triggerLoraFirmwareUpdates() {
   uint32_t startTime = millis();
   while (millis() - startTime < 15000) { // Listen for 15 seconds
     String rx;
-    int r = radio.receive(rx);
+    int r = radioReceive(rx);
     if (r == RADIOLIB_ERR_NONE) {
       if (rx.startsWith("REQUEST_UPDATE")) {
         Serial.println("Transmitter requested update!");
@@ -1597,7 +1495,7 @@ static void triggerLoraFirmwareUpdates() {
 
         // Here you could implement logic to send the actual firmware
         // For now, we'll just acknowledge the request
-        radio.transmit("UPDATE_ACK");
+        radioTransmit("UPDATE_ACK");
         delay(100);
 
         // You could call sendLoraOtaUpdate() here with the firmware data
@@ -0,0 +1,233 @@
+#include "battery_monitor.h"
+#include "../hardware/hardware_abstraction.h"
+#include "../hardware/power_calibration.h"
+#include "../hardware/adc_continuous.h"
+#include <cmath>
+
+namespace Sensors {
+
+    // Global battery monitor, updated from the main loop
+    BatteryMonitor g_batteryMonitor;
+
+    using HardwareAbstraction::Result;
+    namespace ADC = HardwareAbstraction::ADC;
+    namespace GPIO = HardwareAbstraction::GPIO;
+    namespace Timer = HardwareAbstraction::Timer;
+
+    BatteryMonitorConfig getDefaultBatteryMonitorConfig() {
+        BatteryMonitorConfig config = {};
+        config.adc_pin = 1;
+        config.enable_pin = 37;
+        config.sample_interval_ms = 10000;
+        config.settle_ms = 3;
+        config.oversample = 16;
+        config.ema_alpha = 0.25f;           // ~35 s time constant at 10 s bursts
+        config.reseed_step_v = 0.3f;
+        config.divider_ratio = 4.9f;
+        config.present_min_v = 2.5f;
+        config.calibration = nullptr;
+        config.continuous = nullptr;
+        return config;
+    }
+
+    BatteryMonitor::BatteryMonitor()
+        : m_config(getDefaultBatteryMonitorConfig()), m_stats(), m_phase(Phase::IDLE), m_started(false),
+          m_hasReading(false), m_nextBurstMs(0), m_gateOpenedMs(0), m_gateOpenedUs(0), m_runsContinuous(false),
+          m_lastUpdateMs(0), m_filteredPinV(0.0f), m_lastBurstPinV(0.0f), m_lastBurstStartMs(0),
+          m_lastBurstEndMs(0), m_firstSampleUs(0), m_lastSampleUs(0) {}
+
+    void BatteryMonitor::begin(const BatteryMonitorConfig& config, uint32_t nowMs) {
+        m_config = config;
+        if (m_config.oversample == 0) {
+            m_config.oversample = 1;
+        } else if (m_config.oversample > MAX_OVERSAMPLE) {
+            m_config.oversample = MAX_OVERSAMPLE;
+        }
+        if (!(m_config.ema_alpha > 0.0f && m_config.ema_alpha <= 1.0f)) {
+            m_config.ema_alpha = 1.0f;
+        }
+
+        m_stats = BatteryMonitorStats();
+        m_phase = Phase::IDLE;
+        m_hasReading = false;
+        m_filteredPinV = 0.0f;
+        m_lastBurstPinV = 0.0f;
+        m_lastBurstStartMs = 0;
+        m_lastBurstEndMs = 0;
+        m_nextBurstMs = nowMs;              // First burst right away
+        m_runsContinuous = false;
+        m_started = true;
+
+        if (m_config.enable_pin != 0xFF) {
+            GPIO::pinMode(m_config.enable_pin, GPIO::Mode::MODE_OUTPUT);
+        }
+        setGate(false);
+    }
+
+    void BatteryMonitor::setGate(bool open) {
+        if (m_config.enable_pin != 0xFF) {
+            GPIO::digitalWrite(m_config.enable_pin, open ? GPIO::Level::LEVEL_LOW : GPIO::Level::LEVEL_HIGH);
+        }
+    }
+
+    void BatteryMonitor::update(uint32_t nowMs) {
+        if (!m_started) {
+            return;
+        }
+
+        if (m_phase == Phase::IDLE) {
+            if (static_cast<int32_t>(nowMs - m_nextBurstMs) < 0) {
+                return;
+            }
+            setGate(true);
+            m_gateOpenedMs = nowMs;
+            m_gateOpenedUs = Timer::micros();
+            // The sampler converts only while the gate is open: off-gate
+            // readings are meaningless and the DMA would run for nothing
+            if (m_config.continuous != nullptr && m_config.continuous->hasChannel(m_config.adc_pin) &&
+                !m_config.continuous->isRunning()) {
+                m_runsContinuous = m_config.continuous->start() == Result::SUCCESS;
+            }
+            m_phase = Phase::SETTLING;
+            // A zero settle time samples in the same call
+            if (m_config.settle_ms > 0) {
+                return;
+            }
+        }
+
+        if (nowMs - m_gateOpenedMs < m_config.settle_ms) {
+            return;
+        }
+
+        const uint32_t startUs = Timer::micros();
+        float volts[MAX_OVERSAMPLE];
+        size_t count = 0;
+        bool continuous = false;
+        if (m_config.continuous != nullptr && m_config.continuous->isRunning() &&
+            m_config.continuous->hasChannel(m_config.adc_pin)) {
+            if (!collectContinuous(volts, count, nowMs)) {
+                return;
+            }
+            continuous = true;
+        } else {
+            for (uint8_t i = 0; i < m_config.oversample; i++) {
+                float v = 0.0f;
+                if (ADC::readVoltage(m_config.adc_pin, v) == Result::SUCCESS) {
+                    volts[count++] = v;
+                } else {
+                    m_stats.failed_reads++;
+                }
+            }
+        }
+        closeBurst();
+
+        const uint32_t burstUs = Timer::micros() - startUs;
+        m_stats.last_burst_us = burstUs;
+        if (burstUs > m_stats.max_burst_us) {
+            m_stats.max_burst_us = burstUs;
+        }
+
+        m_phase = Phase::IDLE;
+        m_nextBurstMs = nowMs + m_config.sample_interval_ms;
+        if (count > 0) {
+            addBurst(volts, count, nowMs);
+            if (continuous) {
+                // The loop may have been blocked while the DMA converted
+                const uint32_t nowUs = Timer::micros();
+                m_lastBurstStartMs = nowMs - (nowUs - m_firstSampleUs) / 1000;
+                m_lastBurstEndMs = nowMs - (nowUs - m_lastSampleUs) / 1000;
+            }
+        }
+    }
+
+    void BatteryMonitor::closeBurst() {
+        setGate(false);
+        if (m_runsContinuous) {
+            m_config.continuous->stop();
+            m_runsContinuous = false;
+        }
+    }
+
+    // Burst from the continuous sampler: only outputs converted after the
+    // divider settled count. False while they are still coming in.
+    bool BatteryMonitor::collectContinuous(float* volts, size_t& count, uint32_t nowMs) {
+        HardwareAbstraction::ContinuousSample samples[MAX_OVERSAMPLE];
+        const uint32_t settledUs = m_gateOpenedUs + m_config.settle_ms * 1000UL;
+        const size_t available =
+            m_config.continuous->readSince(m_config.adc_pin, settledUs, samples, m_config.oversample);
+        if (available < m_config.oversample && nowMs - m_gateOpenedMs < m_config.settle_ms + CONTINUOUS_TIMEOUT_MS) {
+            return false;
+        }
+        if (available > 0) {
+            m_firstSampleUs = samples[0].timestamp_us;
+            m_lastSampleUs = samples[available - 1].timestamp_us;
+        }
+        for (size_t i = 0; i < available; i++) {
+            volts[count++] = m_config.continuous->toVolts(samples[i].raw);
+        }
+        m_stats.failed_reads += m_config.oversample - static_cast<uint32_t>(available);
+        return true;
+    }
+
+    void BatteryMonitor::addBurst(const float* pinVolts, size_t count, uint32_t nowMs) {
+        if (count == 0) {
+            return;
+        }
+        const float mean = trimmedMean(pinVolts, count);
+        m_lastBurstPinV = mean;
+        m_lastBurstStartMs = nowMs;
+        m_lastBurstEndMs = nowMs;
+        m_stats.bursts++;
+        m_stats.samples += static_cast<uint32_t>(count);
+
+        if (!m_hasReading) {
+            m_filteredPinV = mean;
+            m_hasReading = true;
+        } else if (std::fabs(toBattery(mean) - toBattery(m_filteredPinV)) >= m_config.reseed_step_v) {
+            // Charger connected or battery swapped: follow at once instead of
+            // creeping there over several time constants
+            m_filteredPinV = mean;
+            m_stats.reseeds++;
+        } else {
+            m_filteredPinV += m_config.ema_alpha * (mean - m_filteredPinV);
+        }
+
+        m_lastUpdateMs = nowMs;
+    }
+
+    void BatteryMonitor::setDividerRatio(float ratio) {
+        if (ratio > 0.0f) {
+            m_config.divider_ratio = ratio;
+        }
+    }
+
+    float BatteryMonitor::toBattery(float pinVolts) const {
+        if (m_config.calibration != nullptr) {
+            return m_config.calibration->batteryVoltage(pinVolts);
+        }
+        return pinVolts * m_config.divider_ratio;
+    }
+
+    float BatteryMonitor::trimmedMean(const float* values, size_t count) {
+        if (count == 0) {
+            return 0.0f;
+        }
+        float sum = 0.0f;
+        float lo = values[0];
+        float hi = values[0];
+        for (size_t i = 0; i < count; i++) {
+            sum += values[i];
+            if (values[i] < lo) lo = values[i];
+            if (values[i] > hi) hi = values[i];
+        }
+        if (count < 4) {
+            return sum / static_cast<float>(count);
+        }
+        return (sum - lo - hi) / static_cast<float>(count - 2);
+    }
+
+    uint32_t BatteryMonitor::continuousRateHz(const BatteryMonitorConfig& config) {
+        const uint32_t outputs = config.oversample > 0 ? config.oversample : 1;
+        return outputs * 1000UL / CONTINUOUS_BURST_MS;
+    }
+}
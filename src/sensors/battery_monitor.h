@@ -0,0 +1,116 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace HardwareAbstraction {
+    class PowerCalibration;
+    class ContinuousAdc;
+}
+
+namespace Sensors {
+
+    struct BatteryMonitorConfig {
+        uint8_t adc_pin;                    // VBAT divider tap (GPIO1 on Heltec V3)
+        uint8_t enable_pin;                 // Divider gate, driven LOW while sampling; 0xFF = none
+        uint32_t sample_interval_ms;        // Time between sample bursts
+        uint32_t settle_ms;                 // Divider settling after the gate opens
+        uint8_t oversample;                 // ADC readings per burst, at most MAX_OVERSAMPLE
+        float ema_alpha;                    // Weight of a new burst in the filtered voltage
+        float reseed_step_v;                // A burst this far off the filter restarts it (charger plugged)
+        float divider_ratio;                // VBAT / pin voltage, when there is no calibration
+        const HardwareAbstraction::PowerCalibration* calibration;  // Board calibration, read live
+        HardwareAbstraction::ContinuousAdc* continuous;  // Runs it for each burst when adc_pin is registered
+        float present_min_v;                // Below this there is no battery on the connector
+    };
+
+    BatteryMonitorConfig getDefaultBatteryMonitorConfig();
+
+    struct BatteryMonitorStats {
+        uint32_t bursts;
+        uint32_t samples;
+        uint32_t failed_reads;
+        uint32_t reseeds;
+        uint32_t last_burst_us;             // ADC readings only; settling is not waited out
+        uint32_t max_burst_us;
+    };
+
+    // Samples the battery off the display path. update() from the loop opens
+    // the divider gate when a burst is due, comes back once it has settled,
+    // reads `oversample` ADC values, closes the gate and folds their trimmed
+    // mean into an EMA. Readers get the cached voltage, which costs nothing:
+    // no GPIO, no ADC, no Preferences, no delay. The charge percentage comes
+    // from SocEstimator (battery_soc.h).
+    class BatteryMonitor {
+    public:
+        static constexpr uint8_t MAX_OVERSAMPLE = 32;
+        static constexpr uint32_t CONTINUOUS_TIMEOUT_MS = 250;  // Settled samples not all in by then: use what came
+        static constexpr uint32_t CONTINUOUS_BURST_MS = 16;     // Span the oversampled readings are spread over
+
+        BatteryMonitor();
+
+        void begin(const BatteryMonitorConfig& config, uint32_t nowMs);
+        void update(uint32_t nowMs);
+
+        // Ratio change without a calibration store; takes effect on the
+        // cached values at once, as calibration changes do
+        void setDividerRatio(float ratio);
+
+        // Feeds one burst of pin voltages, as update() does after reading them
+        void addBurst(const float* pinVolts, size_t count, uint32_t nowMs);
+
+        bool hasReading() const { return m_hasReading; }
+        bool isPresent() const { return m_hasReading && getVoltage() >= m_config.present_min_v; }
+        float getVoltage() const { return toBattery(m_filteredPinV); }
+        float getPinVoltage() const { return m_filteredPinV; }
+
+        // Newest burst's trimmed mean, unfiltered, and the span its readings
+        // were converted over (one instant for one-shot reads): the terminal
+        // voltage under whatever load the cell had then
+        float getLastBurstVoltage() const { return toBattery(m_lastBurstPinV); }
+        uint32_t getLastBurstStartMs() const { return m_lastBurstStartMs; }
+        uint32_t getLastBurstEndMs() const { return m_lastBurstEndMs; }
+        uint32_t getLastUpdateMs() const { return m_lastUpdateMs; }
+
+        const BatteryMonitorConfig& getConfig() const { return m_config; }
+        const BatteryMonitorStats& getStats() const { return m_stats; }
+
+        // Mean of the readings without the lowest and highest, which catches
+        // the odd ADC spike; plain mean below four readings
+        static float trimmedMean(const float* values, size_t count);
+
+        // Rate to register adc_pin at on the continuous sampler: `oversample`
+        // outputs in CONTINUOUS_BURST_MS
+        static uint32_t continuousRateHz(const BatteryMonitorConfig& config);
+
+    private:
+        enum class Phase : uint8_t {
+            IDLE,
+            SETTLING
+        };
+
+        BatteryMonitorConfig m_config;
+        BatteryMonitorStats m_stats;
+        Phase m_phase;
+        bool m_started;
+        bool m_hasReading;
+        uint32_t m_nextBurstMs;
+        uint32_t m_gateOpenedMs;
+        uint32_t m_gateOpenedUs;
+        bool m_runsContinuous;              // Started the sampler for this burst
+        uint32_t m_lastUpdateMs;
+        float m_filteredPinV;
+        float m_lastBurstPinV;
+        uint32_t m_lastBurstStartMs;
+        uint32_t m_lastBurstEndMs;
+        uint32_t m_firstSampleUs;           // Conversion times of the continuous burst
+        uint32_t m_lastSampleUs;
+
+        float toBattery(float pinVolts) const;
+        void setGate(bool open);
+        void closeBurst();
+        bool collectContinuous(float* volts, size_t& count, uint32_t nowMs);
+    };
+
+    extern BatteryMonitor g_batteryMonitor;
+}
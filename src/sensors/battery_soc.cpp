@@ -0,0 +1,191 @@
+#include "battery_soc.h"
+#include <cmath>
+
+#ifndef BATTERY_CAPACITY_MAH
+#define BATTERY_CAPACITY_MAH 1000
+#endif
+
+namespace Sensors {
+
+    // Global state-of-charge estimator, fed by the battery monitor and radio
+    SocEstimator g_batterySoc;
+
+    // Typical LiPo/18650 rested OCV; the 3.75-3.85 V plateau covers 25-55%,
+    // which is why a linear 3.0-4.2 V mapping misreads most of the range
+    static constexpr CurvePoint LIION_OCV_CURVE[] = {
+        {3.27f, 0.0f},   {3.61f, 5.0f},   {3.69f, 10.0f},  {3.71f, 15.0f},  {3.73f, 20.0f},
+        {3.75f, 25.0f},  {3.77f, 30.0f},  {3.79f, 35.0f},  {3.80f, 40.0f},  {3.82f, 45.0f},
+        {3.84f, 50.0f},  {3.85f, 55.0f},  {3.87f, 60.0f},  {3.91f, 65.0f},  {3.95f, 70.0f},
+        {3.98f, 75.0f},  {4.02f, 80.0f},  {4.08f, 85.0f},  {4.11f, 90.0f},  {4.15f, 95.0f},
+        {4.20f, 100.0f}
+    };
+
+    // SX1262 datasheet, DC-DC, high-power PA with the matching network for each level
+    static constexpr CurvePoint SX1262_TX_CURRENT[] = {
+        {-9.0f, 26.0f}, {0.0f, 32.0f}, {10.0f, 45.0f}, {14.0f, 63.0f},
+        {17.0f, 90.0f}, {20.0f, 102.0f}, {22.0f, 118.0f}
+    };
+
+    static constexpr size_t OCV_POINTS = sizeof(LIION_OCV_CURVE) / sizeof(LIION_OCV_CURVE[0]);
+    static constexpr size_t TX_POINTS = sizeof(SX1262_TX_CURRENT) / sizeof(SX1262_TX_CURRENT[0]);
+
+    float interpolateCurve(const CurvePoint* curve, size_t count, float key, bool inverse) {
+        if (count == 0) {
+            return 0.0f;
+        }
+        auto in = [&](size_t i) { return inverse ? curve[i].y : curve[i].x; };
+        auto out = [&](size_t i) { return inverse ? curve[i].x : curve[i].y; };
+
+        if (key <= in(0)) return out(0);
+        if (key >= in(count - 1)) return out(count - 1);
+
+        // First point above the key; the segment is [hi-1, hi]
+        size_t lo = 0;
+        size_t hi = count - 1;
+        while (hi - lo > 1) {
+            const size_t mid = lo + (hi - lo) / 2;
+            if (in(mid) <= key) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        const float span = in(hi) - in(lo);
+        if (span <= 0.0f) {
+            return out(lo);
+        }
+        return out(lo) + (out(hi) - out(lo)) * (key - in(lo)) / span;
+    }
+
+    float socFromOcv(float volts) {
+        return interpolateCurve(LIION_OCV_CURVE, OCV_POINTS, volts);
+    }
+
+    float ocvFromSoc(float soc) {
+        return interpolateCurve(LIION_OCV_CURVE, OCV_POINTS, soc, true);
+    }
+
+    float txCurrentMa(int8_t dbm) {
+        return interpolateCurve(SX1262_TX_CURRENT, TX_POINTS, static_cast<float>(dbm));
+    }
+
+    BatterySocConfig getDefaultBatterySocConfig() {
+        BatterySocConfig config;
+        config.capacity_mah = BATTERY_CAPACITY_MAH;
+        config.internal_resistance_ohm = 0.25f;
+        config.base_current_ma = 60.0f;     // ESP32-S3 at 240 MHz, WiFi off, OLED on
+        config.rx_current_ma = 5.3f;
+        config.ocv_gain = 0.05f;
+        config.current_alpha = 0.2f;
+        config.reseed_percent = 20.0f;
+        config.hysteresis_percent = 2;
+        return config;
+    }
+
+    SocEstimator::SocEstimator()
+        : m_config(getDefaultBatterySocConfig()), m_stats(), m_hasEstimate(false), m_soc(0.0f), m_percent(0),
+          m_ocv(0.0f), m_avgCurrentMa(0.0f), m_lastUpdateMs(0), m_pendingRadioMaMs(0.0f), m_txSeen(false), m_lastTxEndMs(0),
+          m_lastTxDurationMs(0), m_lastTxCurrentMa(0.0f) {}
+
+    void SocEstimator::begin(const BatterySocConfig& config) {
+        *this = SocEstimator();
+        m_config = config;
+        if (!(m_config.capacity_mah > 0.0f)) {
+            m_config.capacity_mah = BATTERY_CAPACITY_MAH;
+        }
+    }
+
+    void SocEstimator::recordTx(uint32_t durationMs, int8_t dbm, uint32_t endMs) {
+        const float current = txCurrentMa(dbm);
+        m_pendingRadioMaMs += current * static_cast<float>(durationMs);
+        m_stats.tx_count++;
+        m_stats.tx_ms += durationMs;
+        m_txSeen = true;
+        m_lastTxEndMs = endMs;
+        m_lastTxDurationMs = durationMs;
+        m_lastTxCurrentMa = current;
+    }
+
+    void SocEstimator::recordRx(uint32_t durationMs) {
+        m_pendingRadioMaMs += m_config.rx_current_ma * static_cast<float>(durationMs);
+        m_stats.rx_ms += durationMs;
+    }
+
+    // Base current, plus the last TX current for the share of the sample
+    // window it overlapped: the cell recovers within milliseconds of the PA
+    // switching off, so a TX that ended before the window does not count
+    float SocEstimator::loadCurrentMa(uint32_t startMs, uint32_t endMs) const {
+        float current = m_config.base_current_ma;
+        if (!m_txSeen) {
+            return current;
+        }
+        // Relative to the window start, so that clock wrap does not matter
+        const int32_t windowMs = static_cast<int32_t>(endMs - startMs);
+        const int32_t txEndMs = static_cast<int32_t>(m_lastTxEndMs - startMs);
+        const int32_t txStartMs = txEndMs - static_cast<int32_t>(m_lastTxDurationMs);
+        const int32_t from = txStartMs > 0 ? txStartMs : 0;
+        const int32_t to = txEndMs < windowMs ? txEndMs : windowMs;
+        if (to < from) {
+            return current;
+        }
+        const float share = windowMs > 0 ? static_cast<float>(to - from) / static_cast<float>(windowMs) : 1.0f;
+        return current + m_lastTxCurrentMa * share;
+    }
+
+    void SocEstimator::update(float batteryVolts, uint32_t startMs, uint32_t endMs) {
+        const uint32_t nowMs = endMs;
+        m_stats.samples++;
+        m_ocv = batteryVolts + loadCurrentMa(startMs, endMs) / 1000.0f * m_config.internal_resistance_ohm;
+        const float voltageSoc = socFromOcv(m_ocv);
+
+        const bool first = !m_hasEstimate;
+        if (first) {
+            m_soc = voltageSoc;
+            m_hasEstimate = true;
+        } else {
+            const uint32_t elapsedMs = nowMs - m_lastUpdateMs;
+            const float chargeMaMs = m_config.base_current_ma * static_cast<float>(elapsedMs) + m_pendingRadioMaMs;
+            const float consumedMah = chargeMaMs / 3600000.0f;
+            m_stats.consumed_mah += consumedMah;
+            m_soc -= consumedMah / m_config.capacity_mah * 100.0f;
+
+            if (elapsedMs > 0) {
+                const float intervalMa = chargeMaMs / static_cast<float>(elapsedMs);
+                m_avgCurrentMa = m_avgCurrentMa > 0.0f
+                                     ? m_avgCurrentMa + m_config.current_alpha * (intervalMa - m_avgCurrentMa)
+                                     : intervalMa;
+            }
+
+            if (std::fabs(voltageSoc - m_soc) >= m_config.reseed_percent) {
+                // Charger connected or pack swapped; counting cannot see either
+                m_soc = voltageSoc;
+                m_stats.reseeds++;
+            } else {
+                m_soc += m_config.ocv_gain * (voltageSoc - m_soc);
+            }
+        }
+
+        if (m_soc < 0.0f) m_soc = 0.0f;
+        if (m_soc > 100.0f) m_soc = 100.0f;
+        publishPercent(first);
+        m_pendingRadioMaMs = 0.0f;
+        m_lastUpdateMs = nowMs;
+    }
+
+    void SocEstimator::publishPercent(bool force) {
+        const uint8_t rounded = static_cast<uint8_t>(m_soc + 0.5f);
+        const int delta = static_cast<int>(rounded) - static_cast<int>(m_percent);
+        // The ends always get through, or a full battery could sit at 99%
+        if (force || std::abs(delta) >= m_config.hysteresis_percent || rounded == 0 || rounded == 100) {
+            m_percent = rounded;
+        }
+    }
+
+    uint32_t SocEstimator::getRemainingMinutes() const {
+        if (!m_hasEstimate || m_avgCurrentMa <= 0.0f) {
+            return UINT32_MAX;
+        }
+        const float remainingMah = m_soc / 100.0f * m_config.capacity_mah;
+        return static_cast<uint32_t>(remainingMah / m_avgCurrentMa * 60.0f);
+    }
+}
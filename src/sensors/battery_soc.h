@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Sensors {
+
+    // One point of a piecewise-linear curve, sorted by ascending x and y
+    struct CurvePoint {
+        float x;
+        float y;
+    };
+
+    // Rested single-cell Li-ion open-circuit voltage to state of charge (%)
+    float socFromOcv(float volts);
+    float ocvFromSoc(float soc);
+
+    // SX1262 supply current while transmitting at the given output power
+    float txCurrentMa(int8_t dbm);
+
+    // Binary search plus linear interpolation; clamps outside the curve.
+    // `inverse` looks up x from y.
+    float interpolateCurve(const CurvePoint* curve, size_t count, float key, bool inverse = false);
+
+    struct BatterySocConfig {
+        float capacity_mah;                 // Rated pack capacity
+        float internal_resistance_ohm;      // Cell, protection FET and connector
+        float base_current_ma;              // MCU, OLED and regulators with the radio idle
+        float rx_current_ma;                // Extra while the radio listens
+        float ocv_gain;                     // Pull of each voltage sample on the counted SoC
+        float current_alpha;                // EMA weight for the average current
+        float reseed_percent;               // Voltage/count disagreement that restarts from voltage
+        uint8_t hysteresis_percent;         // Published percent moves only by at least this much
+    };
+
+    BatterySocConfig getDefaultBatterySocConfig();
+
+    struct BatterySocStats {
+        uint32_t samples;
+        uint32_t reseeds;
+        uint32_t tx_count;
+        uint32_t tx_ms;
+        uint32_t rx_ms;
+        float consumed_mah;
+    };
+
+    // State of charge from two sources. Between voltage samples the charge
+    // drawn is counted from the base current and the measured radio on-times;
+    // each sample is load-compensated (V + I*R, with the TX current weighted
+    // by how much of the sample window a transmission overlapped) and looked
+    // up on the OCV curve, and nudges the counted value by ocv_gain. A TX
+    // burst therefore neither drops the reading nor makes it jump back
+    // afterwards, while counting errors are still corrected.
+    class SocEstimator {
+    public:
+        SocEstimator();
+
+        void begin(const BatterySocConfig& config);
+
+        // Radio activity since the last sample; call when the operation ends
+        void recordTx(uint32_t durationMs, int8_t dbm, uint32_t endMs);
+        void recordRx(uint32_t durationMs);
+
+        // Battery terminal voltage, as sampled at nowMs
+        void update(float batteryVolts, uint32_t nowMs) { update(batteryVolts, nowMs, nowMs); }
+
+        // Mean terminal voltage of readings spread over [startMs, endMs]
+        void update(float batteryVolts, uint32_t startMs, uint32_t endMs);
+
+        bool hasEstimate() const { return m_hasEstimate; }
+        float getSoc() const { return m_soc; }
+        // Rounded SoC with hysteresis, so the display does not flicker
+        // between neighbours; 0 and 100 always get through
+        uint8_t getPercent() const { return m_percent; }
+        float getCompensatedVoltage() const { return m_ocv; }
+        float getAverageCurrentMa() const { return m_avgCurrentMa; }
+
+        // At the average current of recent intervals; UINT32_MAX until known
+        uint32_t getRemainingMinutes() const;
+
+        const BatterySocConfig& getConfig() const { return m_config; }
+        const BatterySocStats& getStats() const { return m_stats; }
+
+    private:
+        BatterySocConfig m_config;
+        BatterySocStats m_stats;
+        bool m_hasEstimate;
+        float m_soc;
+        uint8_t m_percent;
+        float m_ocv;
+        float m_avgCurrentMa;
+        uint32_t m_lastUpdateMs;
+
+        // Radio charge since the last sample, in mA*ms
+        float m_pendingRadioMaMs;
+        bool m_txSeen;
+        uint32_t m_lastTxEndMs;
+        uint32_t m_lastTxDurationMs;
+        float m_lastTxCurrentMa;
+
+        float loadCurrentMa(uint32_t startMs, uint32_t endMs) const;
+        void publishPercent(bool force);
+    };
+
+    extern SocEstimator g_batterySoc;
+}
@@ -0,0 +1,182 @@
+#include "button_input.h"
+#include "../hardware/hardware_abstraction.h"
+
+#ifdef ARDUINO
+#include <driver/gpio.h>
+#include <esp_timer.h>
+#endif
+
+namespace Sensors {
+
+    // BOOT button, updated from the main loop
+    ButtonInput g_button;
+
+    ButtonInput* ButtonInput::instance_ = nullptr;
+
+    using HardwareAbstraction::Result;
+    namespace GPIO = HardwareAbstraction::GPIO;
+    namespace Timer = HardwareAbstraction::Timer;
+
+    ButtonInputConfig getDefaultButtonInputConfig() {
+        ButtonInputConfig config = {};
+        config.pin = 0;
+        config.active_low = true;
+        config.debounce_us = 20000;         // Tactile switches settle within a few ms
+        return config;
+    }
+
+    ButtonInput::ButtonInput()
+        : m_config(getDefaultButtonInputConfig()), m_stats(), m_started(false), m_edgeTimes(), m_edgeLevels(),
+          m_edgeHead(0), m_edgeTail(0), m_droppedEdges(0), m_pressed(false), m_locked(false), m_lockStartUs(0),
+          m_lastRawPressed(false), m_lastRawUs(0), m_pressOpen(false), m_pressStartUs(0), m_events(),
+          m_eventHead(0), m_eventCount(0) {}
+
+    bool ButtonInput::begin(const ButtonInputConfig& config) {
+        end();
+        m_config = config;
+        m_stats = ButtonInputStats();
+        m_edgeHead = 0;
+        m_edgeTail = 0;
+        m_droppedEdges = 0;
+        m_eventHead = 0;
+        m_eventCount = 0;
+
+        GPIO::pinMode(m_config.pin, m_config.active_low ? GPIO::Mode::MODE_INPUT_PULLUP
+                                                        : GPIO::Mode::MODE_INPUT_PULLDOWN);
+
+        // Held at boot: the release that follows is not a press
+        const bool high = GPIO::digitalRead(m_config.pin) == GPIO::Level::LEVEL_HIGH;
+        m_pressed = high != m_config.active_low;
+        m_lastRawPressed = m_pressed;
+        m_lastRawUs = Timer::micros();
+        m_locked = false;
+        m_pressOpen = false;
+
+        instance_ = this;
+        if (GPIO::attachInterrupt(m_config.pin, interruptHandler, CHANGE) != Result::SUCCESS) {
+            instance_ = nullptr;
+            return false;
+        }
+        m_started = true;
+        return true;
+    }
+
+    void ButtonInput::end() {
+        if (!m_started) {
+            return;
+        }
+        GPIO::detachInterrupt(m_config.pin);
+        if (instance_ == this) {
+            instance_ = nullptr;
+        }
+        m_started = false;
+    }
+
+    // Runs while flash may be busy (event log writes), so on the device it
+    // only touches IRAM-resident driver calls, not the HAL
+    void IRAM_ATTR ButtonInput::interruptHandler() {
+        if (instance_) {
+#ifdef ARDUINO
+            const uint32_t now = static_cast<uint32_t>(esp_timer_get_time());
+            const bool high = gpio_get_level(static_cast<gpio_num_t>(instance_->m_config.pin)) != 0;
+#else
+            const uint32_t now = Timer::micros();
+            const bool high = GPIO::digitalRead(instance_->m_config.pin) == GPIO::Level::LEVEL_HIGH;
+#endif
+            instance_->pushEdge(now, high);
+        }
+    }
+
+    void IRAM_ATTR ButtonInput::pushEdge(uint32_t timestampUs, bool high) {
+        const uint8_t head = m_edgeHead;
+        const uint8_t next = (head + 1) & (EDGE_QUEUE_SIZE - 1);
+
+        if (next == m_edgeTail) {
+            m_droppedEdges = m_droppedEdges + 1;
+            return;
+        }
+
+        m_edgeTimes[head] = timestampUs;
+        m_edgeLevels[head] = high;
+        m_edgeHead = next;
+    }
+
+    void ButtonInput::update(uint32_t nowUs) {
+        while (m_edgeTail != m_edgeHead) {
+            const uint8_t tail = m_edgeTail;
+            const uint32_t timestampUs = m_edgeTimes[tail];
+            const bool high = m_edgeLevels[tail];
+            m_edgeTail = (tail + 1) & (EDGE_QUEUE_SIZE - 1);
+
+            m_stats.edges++;
+            processEdge(timestampUs, high != m_config.active_low);
+        }
+        m_stats.dropped_edges = m_droppedEdges;
+        settle(nowUs);
+    }
+
+    void ButtonInput::processEdge(uint32_t timestampUs, bool pressed) {
+        settle(timestampUs);
+        m_lastRawPressed = pressed;
+        m_lastRawUs = timestampUs;
+
+        if (m_locked || pressed == m_pressed) {
+            // Bounce inside the window, or a repeat after a missed edge
+            m_stats.bounces++;
+            return;
+        }
+        commit(pressed, timestampUs);
+    }
+
+    // Closes the debounce window once it has passed; if the pin ended up
+    // elsewhere than the committed level, its last edge is the transition
+    void ButtonInput::settle(uint32_t nowUs) {
+        if (!m_locked || nowUs - m_lockStartUs < m_config.debounce_us) {
+            return;
+        }
+        m_locked = false;
+        if (m_lastRawPressed != m_pressed) {
+            commit(m_lastRawPressed, m_lastRawUs);
+            settle(nowUs);
+        }
+    }
+
+    void ButtonInput::commit(bool pressed, uint32_t timestampUs) {
+        m_pressed = pressed;
+        m_locked = true;
+        m_lockStartUs = timestampUs;
+
+        if (pressed) {
+            m_pressOpen = true;
+            m_pressStartUs = timestampUs;
+            return;
+        }
+        if (!m_pressOpen) {
+            return;
+        }
+        m_pressOpen = false;
+
+        ButtonEvent event;
+        event.duration_ms = (timestampUs - m_pressStartUs) / 1000;
+        event.action = classifyPress(event.duration_ms);
+        event.pressed_us = m_pressStartUs;
+        m_stats.presses++;
+
+        if (m_eventCount >= EVENT_QUEUE_SIZE) {
+            m_stats.dropped_events++;
+            return;
+        }
+        m_events[(m_eventHead + m_eventCount) % EVENT_QUEUE_SIZE] = event;
+        m_eventCount++;
+    }
+
+    bool ButtonInput::poll(ButtonEvent& event) {
+        if (m_eventCount == 0) {
+            return false;
+        }
+        event = m_events[m_eventHead];
+        m_eventHead = (m_eventHead + 1) % EVENT_QUEUE_SIZE;
+        m_eventCount--;
+        return true;
+    }
+}
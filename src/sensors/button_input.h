@@ -0,0 +1,102 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../app_logic.h"
+#include <Arduino.h>
+
+namespace Sensors {
+
+    struct ButtonInputConfig {
+        uint8_t pin;                        // BOOT button on GPIO0 on Heltec V3
+        bool active_low;                    // Pressed reads LOW (pull-up to 3V3)
+        uint32_t debounce_us;               // Edges this soon after a transition are bounce
+    };
+
+    ButtonInputConfig getDefaultButtonInputConfig();
+
+    // A completed press, timed from the edges' interrupt timestamps
+    struct ButtonEvent {
+        ButtonAction action;                // classifyPress() of the duration
+        uint32_t duration_ms;
+        uint32_t pressed_us;                // Timer::micros() at the press edge
+    };
+
+    struct ButtonInputStats {
+        uint32_t edges;                     // Edges taken off the interrupt queue
+        uint32_t bounces;                   // Edges absorbed by debouncing
+        uint32_t dropped_edges;             // Interrupt queue was full
+        uint32_t presses;
+        uint32_t dropped_events;            // Event queue was full
+    };
+
+    // Button on a GPIO interrupt. The ISR only stamps the pin level with
+    // Timer::micros() and pushes it onto a single-producer/single-consumer
+    // ring. update() from the loop drains the ring, debounces and queues a
+    // ButtonEvent per release, so press durations do not depend on how
+    // late the loop gets there.
+    //
+    // Debouncing commits a transition at its first edge and ignores edges
+    // for debounce_us after it; if the level then differs, the last edge
+    // is committed. A glitch therefore shows up as a press shorter than
+    // classifyPress() accepts.
+    class ButtonInput {
+    public:
+        static constexpr uint8_t EDGE_QUEUE_SIZE = 32;      // Power of two
+        static constexpr uint8_t EVENT_QUEUE_SIZE = 4;
+
+        ButtonInput();
+
+        // Configures the pin and attaches the interrupt; one instance
+        // receives interrupts at a time. On false the pin is still set up
+        // and the caller can feed pushEdge() from polling instead.
+        bool begin(const ButtonInputConfig& config);
+        void end();
+        bool isAttached() const { return m_started; }
+
+        // Drains the edge queue; nowUs settles a pending debounce window
+        void update(uint32_t nowUs);
+        bool poll(ButtonEvent& event);
+
+        bool isPressed() const { return m_pressed; }
+        const ButtonInputStats& getStats() const { return m_stats; }
+
+        // Edge as the ISR records it: level read from the pin, true = HIGH
+        void IRAM_ATTR pushEdge(uint32_t timestampUs, bool high);
+
+    private:
+        ButtonInputConfig m_config;
+        ButtonInputStats m_stats;
+        bool m_started;
+
+        // ISR -> update() ring
+        volatile uint32_t m_edgeTimes[EDGE_QUEUE_SIZE];
+        volatile bool m_edgeLevels[EDGE_QUEUE_SIZE];
+        volatile uint8_t m_edgeHead;
+        volatile uint8_t m_edgeTail;
+        volatile uint32_t m_droppedEdges;
+
+        // Debounced state
+        bool m_pressed;
+        bool m_locked;                      // Inside a debounce window
+        uint32_t m_lockStartUs;
+        bool m_lastRawPressed;
+        uint32_t m_lastRawUs;
+        bool m_pressOpen;                   // Press edge seen since begin(), release still to come
+        uint32_t m_pressStartUs;
+
+        ButtonEvent m_events[EVENT_QUEUE_SIZE];
+        uint8_t m_eventHead;
+        uint8_t m_eventCount;
+
+        static ButtonInput* instance_;
+        static void IRAM_ATTR interruptHandler();
+
+        void processEdge(uint32_t timestampUs, bool pressed);
+        void settle(uint32_t nowUs);
+        void commit(bool pressed, uint32_t timestampUs);
+    };
+
+    extern ButtonInput g_button;
+}
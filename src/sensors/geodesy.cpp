@@ -0,0 +1,151 @@
+#include "geodesy.h"
+#include <cmath>
+
+namespace Geodesy {
+
+    static constexpr double DEG_TO_RAD_D = M_PI / 180.0;
+    static constexpr double RAD_TO_DEG_D = 180.0 / M_PI;
+    static constexpr float DEG_TO_RAD_F = static_cast<float>(M_PI / 180.0);
+    static constexpr float RAD_TO_DEG_F = static_cast<float>(180.0 / M_PI);
+    static constexpr float EARTH_RADIUS_KM_F = static_cast<float>(EARTH_RADIUS_KM);
+
+    static inline float wrapLonDeltaDeg(float dlon) {
+        if (dlon > 180.0f) {
+            dlon -= 360.0f;
+        } else if (dlon < -180.0f) {
+            dlon += 360.0f;
+        }
+        return dlon;
+    }
+
+    static inline float normalizeBearingDeg(float bearing) {
+        if (bearing < 0.0f) {
+            bearing += 360.0f;
+        } else if (bearing >= 360.0f) {
+            bearing -= 360.0f;
+        }
+        return bearing;
+    }
+
+    Origin makeOrigin(double lat_deg, double lon_deg) {
+        Origin origin;
+        origin.lat_deg = lat_deg;
+        origin.lon_deg = lon_deg;
+        origin.cos_lat = static_cast<float>(cos(lat_deg * DEG_TO_RAD_D));
+        origin.sin_lat = static_cast<float>(sin(lat_deg * DEG_TO_RAD_D));
+        return origin;
+    }
+
+    void toLocalKm(const Origin& origin, double lat_deg, double lon_deg, float& east_km, float& north_km) {
+        const float dlon = wrapLonDeltaDeg(static_cast<float>(lon_deg - origin.lon_deg));
+        east_km = dlon * DEG_TO_RAD_F * EARTH_RADIUS_KM_F * origin.cos_lat;
+        north_km = static_cast<float>(lat_deg - origin.lat_deg) * DEG_TO_RAD_F * EARTH_RADIUS_KM_F;
+    }
+
+    void fromLocalKm(const Origin& origin, float east_km, float north_km, double& lat_deg, double& lon_deg) {
+        lat_deg = origin.lat_deg + north_km / (DEG_TO_RAD_D * EARTH_RADIUS_KM);
+        lon_deg = origin.lon_deg + east_km / (DEG_TO_RAD_D * EARTH_RADIUS_KM * origin.cos_lat);
+        if (lon_deg > 180.0) {
+            lon_deg -= 360.0;
+        } else if (lon_deg < -180.0) {
+            lon_deg += 360.0;
+        }
+    }
+
+    double haversineKm(double lat1_deg, double lon1_deg, double lat2_deg, double lon2_deg) {
+        const double lat1 = lat1_deg * DEG_TO_RAD_D;
+        const double lat2 = lat2_deg * DEG_TO_RAD_D;
+        const double dlat = (lat2_deg - lat1_deg) * DEG_TO_RAD_D;
+        const double dlon = (lon2_deg - lon1_deg) * DEG_TO_RAD_D;
+
+        const double s_dlat = sin(dlat / 2);
+        const double s_dlon = sin(dlon / 2);
+        const double a = s_dlat * s_dlat + cos(lat1) * cos(lat2) * s_dlon * s_dlon;
+        const double c = 2 * atan2(sqrt(a), sqrt(1 - a));
+
+        return EARTH_RADIUS_KM * c;
+    }
+
+    double initialBearingDeg(double lat1_deg, double lon1_deg, double lat2_deg, double lon2_deg) {
+        const double lat1 = lat1_deg * DEG_TO_RAD_D;
+        const double lat2 = lat2_deg * DEG_TO_RAD_D;
+        const double dlon = (lon2_deg - lon1_deg) * DEG_TO_RAD_D;
+
+        const double y = sin(dlon) * cos(lat2);
+        const double x = cos(lat1) * sin(lat2) - sin(lat1) * cos(lat2) * cos(dlon);
+
+        double bearing = atan2(y, x) * RAD_TO_DEG_D;
+        if (bearing < 0) {
+            bearing += 360.0;
+        }
+        return bearing;
+    }
+
+    // Equirectangular projection about the segment midpoint. cos/sin of the
+    // midpoint latitude come from the cached origin terms via a second-order
+    // expansion, so the loop body has one sqrt and (optionally) one atan2.
+    struct FastTerms {
+        float x;            // East offset (rad of arc)
+        float y;            // North offset (rad of arc)
+        float dlon;         // Longitude difference (rad)
+        float sin_mid;      // sin(midpoint latitude)
+    };
+
+    static inline float fastDistance(const Origin& origin, float lat, float lon, FastTerms& terms) {
+        const float dlat = (lat - static_cast<float>(origin.lat_deg)) * DEG_TO_RAD_F;
+        const float dlon = wrapLonDeltaDeg(lon - static_cast<float>(origin.lon_deg)) * DEG_TO_RAD_F;
+
+        const float h = 0.5f * dlat;
+        const float c2 = 1.0f - 0.5f * h * h;
+        const float cos_mid = origin.cos_lat * c2 - origin.sin_lat * h;
+
+        terms.x = dlon * cos_mid;
+        terms.y = dlat;
+        terms.dlon = dlon;
+        terms.sin_mid = origin.sin_lat * c2 + origin.cos_lat * h;
+
+        return EARTH_RADIUS_KM_F * sqrtf(terms.x * terms.x + terms.y * terms.y);
+    }
+
+    // Midpoint bearing corrected for meridian convergence (dlon * sin(lat_mid) / 2)
+    static inline float fastBearing(const FastTerms& terms) {
+        if (terms.x == 0.0f && terms.y == 0.0f) {
+            return 0.0f;
+        }
+        const float mid_bearing = atan2f(terms.x, terms.y);
+        return normalizeBearingDeg((mid_bearing - 0.5f * terms.dlon * terms.sin_mid) * RAD_TO_DEG_F);
+    }
+
+    size_t distanceBearing(const Origin& origin, const TargetBuffer& targets,
+                           ResultBuffer results, Method method) {
+        size_t fallbacks = 0;
+        const bool polar = fabsf(static_cast<float>(origin.lat_deg)) > FAST_PATH_MAX_LAT_DEG;
+        const bool try_fast = (method == Method::FAST) || (method == Method::AUTO && !polar);
+
+        for (size_t i = 0; i < targets.count; i++) {
+            const float lat = targets.lat_deg[i];
+            const float lon = targets.lon_deg[i];
+
+            if (try_fast) {
+                FastTerms terms;
+                const float distance = fastDistance(origin, lat, lon, terms);
+
+                if (method == Method::FAST || distance <= FAST_PATH_MAX_KM) {
+                    results.distance_km[i] = distance;
+                    if (results.bearing_deg) {
+                        results.bearing_deg[i] = fastBearing(terms);
+                    }
+                    continue;
+                }
+            }
+
+            fallbacks++;
+            results.distance_km[i] = static_cast<float>(haversineKm(origin.lat_deg, origin.lon_deg, lat, lon));
+            if (results.bearing_deg) {
+                results.bearing_deg[i] = static_cast<float>(initialBearingDeg(origin.lat_deg, origin.lon_deg, lat, lon));
+            }
+        }
+
+        return fallbacks;
+    }
+}
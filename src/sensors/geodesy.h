@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Batch distance/bearing kernels over structure-of-arrays coordinate buffers.
+// The ESP32-S3 FPU is single precision, so the batch path works in float and
+// only the haversine fallback uses double.
+namespace Geodesy {
+
+    constexpr double EARTH_RADIUS_KM = 6371.0;
+
+    // Equirectangular fast path is used up to this distance (km)
+    constexpr float FAST_PATH_MAX_KM = 100.0f;
+
+    // Above this latitude meridian convergence is too strong for the fast path
+    constexpr float FAST_PATH_MAX_LAT_DEG = 80.0f;
+
+    enum class Method {
+        AUTO,           // Fast path, haversine fallback beyond FAST_PATH_MAX_KM
+        FAST,           // Equirectangular only (caller guarantees short range)
+        EXACT           // Haversine only
+    };
+
+    // Observer position with trig terms cached once per batch
+    struct Origin {
+        double lat_deg;
+        double lon_deg;
+        float cos_lat;
+        float sin_lat;
+    };
+
+    // Structure-of-arrays target coordinates (degrees)
+    struct TargetBuffer {
+        const float* lat_deg;
+        const float* lon_deg;
+        size_t count;
+    };
+
+    // Per-target results; bearing_deg may be nullptr when only distances are needed
+    struct ResultBuffer {
+        float* distance_km;
+        float* bearing_deg;
+    };
+
+    Origin makeOrigin(double lat_deg, double lon_deg);
+
+    // Distance and initial bearing from origin to every target.
+    // Returns the number of targets that took the haversine path.
+    size_t distanceBearing(const Origin& origin, const TargetBuffer& targets,
+                           ResultBuffer results, Method method = Method::AUTO);
+
+    // Equirectangular projection onto a local east/north plane (km) around origin.
+    // Accurate to well under 0.1% within FAST_PATH_MAX_KM.
+    void toLocalKm(const Origin& origin, double lat_deg, double lon_deg, float& east_km, float& north_km);
+    void fromLocalKm(const Origin& origin, float east_km, float north_km, double& lat_deg, double& lon_deg);
+
+    // Single-point exact formulas (double precision)
+    double haversineKm(double lat1_deg, double lon1_deg, double lat2_deg, double lon2_deg);
+    double initialBearingDeg(double lat1_deg, double lon1_deg, double lat2_deg, double lon2_deg);
+}
@@ -0,0 +1,268 @@
+#include "gps_duty_cycle.h"
+#include <cstring>
+#include <cmath>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+namespace GPS {
+
+    // Below this speed the reported course is noise
+    static constexpr float MIN_COURSE_SPEED_KMH = 1.0f;
+    static constexpr float MS_PER_HOUR = 3600000.0f;
+
+    DutyCycleConfig getDefaultDutyCycleConfig() {
+        DutyCycleConfig config = {};
+        config.mode = DutyCycleMode::PERIODIC_FIX;
+        config.fix_interval_ms = 300000;          // 5 minutes
+        config.hot_start_interval_ms = 60000;     // 1 minute
+        config.wake_lead_ms = 5000;
+        config.acquisition_timeout_ms = 120000;   // 2 minutes (cold start worst case)
+        config.hdop_threshold = 2.0f;
+        config.moving_speed_kmh = 3.0f;
+        config.course_change_deg = 30.0f;
+        config.stationary_radius_m = 25.0f;
+        config.stationary_fix_count = 3;
+        config.stationary_interval_ms = 3600000;  // 1 hour
+        config.active_current_ma = 30.0f;         // UC6580 tracking, multi-GNSS
+        config.off_current_ma = 0.0f;             // Power switched off via enable pin
+        return config;
+    }
+
+    const char* dutyCycleModeToString(DutyCycleMode mode) {
+        switch (mode) {
+            case DutyCycleMode::ALWAYS_ON: return "ALWAYS_ON";
+            case DutyCycleMode::PERIODIC_FIX: return "PERIODIC_FIX";
+            case DutyCycleMode::HOT_START: return "HOT_START";
+            default: return "UNKNOWN";
+        }
+    }
+
+    DutyCycleController::DutyCycleController(UC6580& gps)
+        : m_gps(gps)
+        , m_state(DutyCycleState::IDLE)
+        , m_last_update_ms(0)
+        , m_acquire_start_ms(0)
+        , m_next_fix_ms(NO_FIX_SCHEDULED)
+        , m_have_last_fix(false)
+        , m_last_lat(0.0)
+        , m_last_lon(0.0)
+        , m_last_course(0.0f)
+        , m_still_fixes(0)
+        , m_stationary(false)
+    {
+        m_config = getDefaultDutyCycleConfig();
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    HardwareAbstraction::Result DutyCycleController::begin(const DutyCycleConfig& config, uint32_t now_ms) {
+        if (!m_gps.isInitialized()) {
+            return HardwareAbstraction::Result::ERROR_NOT_INITIALIZED;
+        }
+
+        if (config.hdop_threshold <= 0.0f || config.acquisition_timeout_ms == 0) {
+            return HardwareAbstraction::Result::ERROR_INVALID_PARAMETER;
+        }
+
+        m_config = config;
+        memset(&m_stats, 0, sizeof(m_stats));
+        m_last_update_ms = now_ms;
+        m_have_last_fix = false;
+        m_still_fixes = 0;
+        m_stationary = false;
+        m_state = DutyCycleState::IDLE;
+
+        return setMode(config.mode, now_ms);
+    }
+
+    HardwareAbstraction::Result DutyCycleController::setMode(DutyCycleMode mode, uint32_t now_ms) {
+        accumulate(now_ms);
+        m_config.mode = mode;
+
+        if (mode == DutyCycleMode::ALWAYS_ON) {
+            m_state = DutyCycleState::CONTINUOUS;
+            m_next_fix_ms = NO_FIX_SCHEDULED;
+            return m_gps.isPowered() ? HardwareAbstraction::Result::SUCCESS : m_gps.powerOn(false);
+        }
+
+        // Leaving ALWAYS_ON (or starting): take a fix now, then follow the schedule
+        if (m_state == DutyCycleState::IDLE || m_state == DutyCycleState::CONTINUOUS) {
+            startAcquisition(now_ms);
+        }
+
+        return HardwareAbstraction::Result::SUCCESS;
+    }
+
+    void DutyCycleController::requestFix(uint32_t now_ms) {
+        if (m_state == DutyCycleState::SLEEPING) {
+            accumulate(now_ms);
+            startAcquisition(now_ms);
+        }
+    }
+
+    void DutyCycleController::update(uint32_t now_ms) {
+        accumulate(now_ms);
+
+        switch (m_state) {
+            case DutyCycleState::ACQUIRING: {
+                // powerOff() clears Data::valid, so any valid fix here is from this cycle
+                const Data& data = m_gps.getData();
+                if (m_gps.hasValidFix() && data.hdop > 0.0f && data.hdop <= m_config.hdop_threshold) {
+                    finishAcquisition(now_ms, true);
+                } else if (now_ms - m_acquire_start_ms >= m_config.acquisition_timeout_ms) {
+                    finishAcquisition(now_ms, false);
+                }
+                break;
+            }
+
+            case DutyCycleState::SLEEPING:
+                if (m_next_fix_ms != NO_FIX_SCHEDULED &&
+                    static_cast<int32_t>(now_ms + getCurrentWakeLead() - m_next_fix_ms) >= 0) {
+                    startAcquisition(now_ms);
+                }
+                break;
+
+            case DutyCycleState::CONTINUOUS:
+                if (!m_gps.isPowered()) {
+                    m_gps.powerOn(false);
+                }
+                break;
+
+            case DutyCycleState::IDLE:
+            default:
+                break;
+        }
+    }
+
+    uint32_t DutyCycleController::getCurrentWakeLead() const {
+        uint32_t lead = 0;
+
+        switch (m_config.mode) {
+            case DutyCycleMode::PERIODIC_FIX:
+                lead = m_config.wake_lead_ms;
+                break;
+            case DutyCycleMode::HOT_START:
+                lead = (m_stats.avg_acquisition_ms > 0) ? m_stats.avg_acquisition_ms : m_config.wake_lead_ms;
+                break;
+            default:
+                return 0;
+        }
+
+        // Never spend more than half the interval powered up just waiting
+        const uint32_t interval = currentInterval();
+        if (interval > 0 && lead > interval / 2) {
+            lead = interval / 2;
+        }
+        return lead;
+    }
+
+    void DutyCycleController::startAcquisition(uint32_t now_ms) {
+        if (!m_gps.isPowered()) {
+            m_gps.powerOn(false);
+        }
+        m_acquire_start_ms = now_ms;
+        m_state = DutyCycleState::ACQUIRING;
+    }
+
+    void DutyCycleController::finishAcquisition(uint32_t now_ms, bool success) {
+        if (success) {
+            const uint32_t acquisition_ms = now_ms - m_acquire_start_ms;
+            m_stats.fixes++;
+            m_stats.last_acquisition_ms = acquisition_ms;
+            m_stats.avg_acquisition_ms = (m_stats.avg_acquisition_ms == 0)
+                ? acquisition_ms
+                : (m_stats.avg_acquisition_ms * 3 + acquisition_ms) / 4;
+            updateMotion(m_gps.getData());
+        } else {
+            m_stats.failed_acquisitions++;
+        }
+
+        m_gps.powerOff();
+        m_state = DutyCycleState::SLEEPING;
+
+        const uint32_t interval = currentInterval();
+        m_next_fix_ms = (interval == 0) ? NO_FIX_SCHEDULED : now_ms + interval;
+    }
+
+    void DutyCycleController::updateMotion(const Data& data) {
+        bool moving = data.speed_kmh >= m_config.moving_speed_kmh;
+
+        if (m_have_last_fix && !moving) {
+            if (data.speed_kmh >= MIN_COURSE_SPEED_KMH) {
+                float course_delta = fabsf(data.course_deg - m_last_course);
+                if (course_delta > 180.0f) {
+                    course_delta = 360.0f - course_delta;
+                }
+                moving = course_delta >= m_config.course_change_deg;
+            }
+
+            if (!moving) {
+                const float displacement_m = m_gps.distanceTo(m_last_lat, m_last_lon) * 1000.0f;
+                moving = displacement_m > m_config.stationary_radius_m;
+            }
+        }
+
+        if (moving) {
+            m_still_fixes = 0;
+            m_stationary = false;
+        } else if (m_have_last_fix && m_config.stationary_fix_count > 0) {
+            if (m_still_fixes < 255) {
+                m_still_fixes++;
+            }
+            m_stationary = m_still_fixes >= m_config.stationary_fix_count;
+        }
+
+        m_have_last_fix = true;
+        m_last_lat = data.latitude;
+        m_last_lon = data.longitude;
+        m_last_course = data.course_deg;
+    }
+
+    void DutyCycleController::accumulate(uint32_t now_ms) {
+        const uint32_t delta = now_ms - m_last_update_ms;
+        m_last_update_ms = now_ms;
+
+        if (m_state == DutyCycleState::IDLE) {
+            return;
+        }
+
+        if (m_gps.isPowered()) {
+            m_stats.on_time_ms += delta;
+        } else {
+            m_stats.off_time_ms += delta;
+        }
+
+        const float on_h = m_stats.on_time_ms / MS_PER_HOUR;
+        const float off_h = m_stats.off_time_ms / MS_PER_HOUR;
+        m_stats.consumed_mah = on_h * m_config.active_current_ma + off_h * m_config.off_current_ma;
+        m_stats.saved_mah = off_h * (m_config.active_current_ma - m_config.off_current_ma);
+
+        const uint32_t total_ms = m_stats.on_time_ms + m_stats.off_time_ms;
+        m_stats.duty_cycle = (total_ms > 0) ? static_cast<float>(m_stats.on_time_ms) / total_ms : 0.0f;
+    }
+
+    uint32_t DutyCycleController::currentInterval() const {
+        if (m_stationary) {
+            return m_config.stationary_interval_ms;
+        }
+        return (m_config.mode == DutyCycleMode::HOT_START) ? m_config.hot_start_interval_ms
+                                                           : m_config.fix_interval_ms;
+    }
+
+    void DutyCycleController::printDiagnostics() const {
+        #ifdef ARDUINO
+        Serial.println("=== GPS Duty Cycle ===");
+        Serial.printf("Mode: %s\n", dutyCycleModeToString(m_config.mode));
+        Serial.printf("Stationary: %s\n", m_stationary ? "Yes" : "No");
+        Serial.printf("Fixes: %lu (failed: %lu)\n", m_stats.fixes, m_stats.failed_acquisitions);
+        Serial.printf("Acquisition: last %lu ms, avg %lu ms, wake lead %lu ms\n",
+                     m_stats.last_acquisition_ms, m_stats.avg_acquisition_ms, getCurrentWakeLead());
+        Serial.printf("On/Off: %lu/%lu ms (duty %.1f%%)\n",
+                     m_stats.on_time_ms, m_stats.off_time_ms, m_stats.duty_cycle * 100.0f);
+        Serial.printf("Consumed: %.3f mAh, saved: %.3f mAh\n", m_stats.consumed_mah, m_stats.saved_mah);
+        Serial.println("======================");
+        #endif
+    }
+
+} // namespace GPS
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "gps_sensor.h"
+#include <stdint.h>
+
+namespace GPS {
+
+    // Receiver power strategies
+    enum class DutyCycleMode {
+        ALWAYS_ON,      // Receiver stays powered (legacy behaviour)
+        PERIODIC_FIX,   // Power up every fix_interval_ms, fixed wake lead
+        HOT_START       // Short hot_start_interval_ms, wake lead learned from measured TTFF
+    };
+
+    // Duty-cycle controller states
+    enum class DutyCycleState {
+        IDLE,           // Controller not started
+        ACQUIRING,      // Receiver powered, waiting for a good fix
+        SLEEPING,       // Receiver powered down until the next scheduled fix
+        CONTINUOUS      // ALWAYS_ON mode
+    };
+
+    // Duty-cycle configuration
+    struct DutyCycleConfig {
+        DutyCycleMode mode;
+        uint32_t fix_interval_ms;          // PERIODIC_FIX: time between fixes
+        uint32_t hot_start_interval_ms;    // HOT_START: time between fixes (keep within ephemeris validity)
+        uint32_t wake_lead_ms;             // PERIODIC_FIX: power up this long before a scheduled fix
+        uint32_t acquisition_timeout_ms;   // Give up on a fix after this long
+        float hdop_threshold;              // Accept a fix once HDOP is at or below this
+
+        // Motion gating
+        float moving_speed_kmh;            // Speed at or above this counts as moving
+        float course_change_deg;           // Course change (while not standing) that counts as moving
+        float stationary_radius_m;         // Displacement between fixes that counts as moving
+        uint8_t stationary_fix_count;      // Consecutive still fixes before the node is stationary
+        uint32_t stationary_interval_ms;   // Interval while stationary, 0 = no fixes until requestFix()
+
+        // Energy model
+        float active_current_ma;           // Receiver current while powered
+        float off_current_ma;              // Residual current while powered down
+    };
+
+    // On-time accounting and savings estimate
+    struct DutyCycleStats {
+        uint32_t on_time_ms;               // Total time the receiver was powered
+        uint32_t off_time_ms;              // Total time the receiver was powered down
+        uint32_t fixes;                    // Accepted fixes
+        uint32_t failed_acquisitions;      // Acquisitions that hit the timeout
+        uint32_t last_acquisition_ms;      // Power-up to accepted fix, last cycle
+        uint32_t avg_acquisition_ms;       // Smoothed acquisition time (drives HOT_START wake lead)
+        float consumed_mah;                // Estimated charge used by the receiver
+        float saved_mah;                   // Estimated charge saved versus ALWAYS_ON
+        float duty_cycle;                  // on_time / (on_time + off_time)
+    };
+
+    // Powers the UC6580 down between fixes, driven by fix quality and motion.
+    // Call update() from the main loop after UC6580::update() has parsed new sentences.
+    class DutyCycleController {
+    public:
+        explicit DutyCycleController(UC6580& gps);
+
+        HardwareAbstraction::Result begin(const DutyCycleConfig& config, uint32_t now_ms);
+        void update(uint32_t now_ms);
+
+        HardwareAbstraction::Result setMode(DutyCycleMode mode, uint32_t now_ms);
+        void requestFix(uint32_t now_ms);                  // Acquire as soon as possible
+
+        DutyCycleState getState() const { return m_state; }
+        bool isStationary() const { return m_stationary; }
+        uint32_t getNextFixTime() const { return m_next_fix_ms; }
+        uint32_t getCurrentWakeLead() const;
+        const DutyCycleConfig& getConfig() const { return m_config; }
+        const DutyCycleStats& getStats() const { return m_stats; }
+
+        void printDiagnostics() const;
+
+        static constexpr uint32_t NO_FIX_SCHEDULED = 0xFFFFFFFFu;
+
+    private:
+        UC6580& m_gps;
+        DutyCycleConfig m_config;
+        DutyCycleStats m_stats;
+        DutyCycleState m_state;
+
+        uint32_t m_last_update_ms;
+        uint32_t m_acquire_start_ms;
+        uint32_t m_next_fix_ms;
+
+        // Last accepted fix for motion detection
+        bool m_have_last_fix;
+        double m_last_lat;
+        double m_last_lon;
+        float m_last_course;
+        uint8_t m_still_fixes;
+        bool m_stationary;
+
+        void startAcquisition(uint32_t now_ms);
+        void finishAcquisition(uint32_t now_ms, bool success);
+        void updateMotion(const Data& data);
+        void accumulate(uint32_t now_ms);
+        uint32_t currentInterval() const;
+    };
+
+    // Default duty-cycle configuration for the Wireless Tracker
+    DutyCycleConfig getDefaultDutyCycleConfig();
+    const char* dutyCycleModeToString(DutyCycleMode mode);
+}
@@ -1,4 +1,5 @@
 #include "gps_sensor.h"
+#include "geodesy.h"
 #include <cstring>
 #include <cstdlib>
 #include <cmath>
@@ -24,6 +25,7 @@ namespace GPS {
         config.enable_pin = 3;  // GPIO 3 for V1.1 hardware
         config.auto_power_on = true;
         config.update_rate = 1; // 1 Hz
+        config.position_filter = true;
         return config;
     }
 
@@ -47,6 +49,59 @@ namespace GPS {
         return g_gps.hasValidFix();
     }
 
+    // Constellation helpers
+    Constellation constellationFromTalker(const char* talker) {
+        if (!talker || strlen(talker) < 2) {
+            return Constellation::UNKNOWN;
+        }
+
+        if (strncmp(talker, "GP", 2) == 0) return Constellation::GPS;
+        if (strncmp(talker, "GL", 2) == 0) return Constellation::GLONASS;
+        if (strncmp(talker, "GA", 2) == 0) return Constellation::GALILEO;
+        if (strncmp(talker, "GB", 2) == 0 || strncmp(talker, "BD", 2) == 0) return Constellation::BEIDOU;
+        if (strncmp(talker, "GQ", 2) == 0 || strncmp(talker, "QZ", 2) == 0) return Constellation::QZSS;
+
+        // "GN" (combined solution) and anything else
+        return Constellation::UNKNOWN;
+    }
+
+    Constellation constellationFromPRN(uint8_t prn) {
+        // NMEA 0183 numbering; only the legacy ranges are unambiguous
+        if (prn >= 1 && prn <= 32) return Constellation::GPS;
+        if (prn >= 33 && prn <= 64) return Constellation::SBAS;
+        if (prn >= 65 && prn <= 96) return Constellation::GLONASS;
+        return Constellation::UNKNOWN;
+    }
+
+    const char* constellationToString(Constellation constellation) {
+        switch (constellation) {
+            case Constellation::GPS: return "GPS";
+            case Constellation::GLONASS: return "GLONASS";
+            case Constellation::GALILEO: return "Galileo";
+            case Constellation::BEIDOU: return "BeiDou";
+            case Constellation::QZSS: return "QZSS";
+            case Constellation::SBAS: return "SBAS";
+            default: return "Unknown";
+        }
+    }
+
+    // Resolve the constellation of a PRN reported under a given talker/system
+    static Constellation resolveConstellation(Constellation system, uint8_t prn) {
+        if (system == Constellation::UNKNOWN) {
+            return constellationFromPRN(prn);
+        }
+        if (system == Constellation::GPS && prn >= 33 && prn <= 64) {
+            return Constellation::SBAS; // SBAS is reported under the GP talker
+        }
+        return system;
+    }
+
+    // True if a satellite is reported by the given talker/system
+    static bool belongsTo(const SatelliteInfo& sat, Constellation system) {
+        return sat.constellation == system ||
+               (system == Constellation::GPS && sat.constellation == Constellation::SBAS);
+    }
+
     // UC6580 class implementation
     UC6580::UC6580()
         : m_initialized(false)
@@ -54,10 +109,16 @@ namespace GPS {
         , m_messages_received(0)
         , m_parse_errors(0)
         , m_last_update(0)
+        , m_power_on_time(0)
+        , m_time_to_first_fix(0)
+        , m_fix_clock_ms(0)
+        , m_last_fix_tod_ms(-1)
     {
         // Initialize data structure
         memset(&m_data, 0, sizeof(m_data));
         memset(&m_config, 0, sizeof(m_config));
+        memset(&m_satellites, 0, sizeof(m_satellites));
+        memset(m_gsv_epoch, 0, sizeof(m_gsv_epoch));
     }
 
     UC6580::~UC6580() {
@@ -125,7 +186,7 @@ namespace GPS {
         return m_initialized;
     }
 
-    HardwareAbstraction::Result UC6580::powerOn() {
+    HardwareAbstraction::Result UC6580::powerOn(bool wait_for_startup) {
         if (!m_initialized) {
             return HardwareAbstraction::Result::ERROR_NOT_INITIALIZED;
         }
@@ -141,8 +202,15 @@ namespace GPS {
 
         m_powered = true;
 
-        // Wait for GPS to start up
-        HardwareAbstraction::Timer::delay(1000);
+        // Restart satellite tracking and TTFF measurement
+        memset(&m_satellites, 0, sizeof(m_satellites));
+        m_power_on_time = HardwareAbstraction::Timer::millis();
+        m_time_to_first_fix = 0;
+
+        // Wait for GPS to start up (callers polling isStartingUp() skip the wait)
+        if (wait_for_startup) {
+            HardwareAbstraction::Timer::delay(STARTUP_TIME_MS);
+        }
 
         return HardwareAbstraction::Result::SUCCESS;
     }
@@ -171,6 +239,10 @@ namespace GPS {
         return m_powered;
     }
 
+    bool UC6580::isStartingUp() const {
+        return m_powered && (HardwareAbstraction::Timer::millis() - m_power_on_time) < STARTUP_TIME_MS;
+    }
+
     HardwareAbstraction::Result UC6580::setBaudRate(uint32_t baud_rate) {
         if (!m_initialized) {
             return HardwareAbstraction::Result::ERROR_NOT_INITIALIZED;
@@ -225,7 +297,7 @@ namespace GPS {
         return result;
     }
 
-    HardwareAbstraction::Result UC6580::enableGNSSSystems(bool gps, bool glonass, bool beidou, bool galileo) {
+    HardwareAbstraction::Result UC6580::enableGNSSSystems(bool, bool, bool, bool) {
         if (!m_initialized) {
             return HardwareAbstraction::Result::ERROR_NOT_INITIALIZED;
         }
@@ -252,10 +324,73 @@ namespace GPS {
         return HardwareAbstraction::Result::ERROR_TIMEOUT;
     }
 
+    HardwareAbstraction::Result UC6580::processNMEA(const char* sentence) {
+        return parseNMEA(sentence);
+    }
+
     const Data& UC6580::getData() const {
         return m_data;
     }
 
+    void UC6580::setPositionFilterEnabled(bool enabled) {
+        if (enabled && !m_config.position_filter) {
+            m_position_filter.reset();
+        }
+        m_config.position_filter = enabled;
+    }
+
+    void UC6580::configurePositionFilter(const PositionFilterConfig& config) {
+        m_position_filter.configure(config);
+    }
+
+    const PositionFilter& UC6580::getPositionFilter() const {
+        return m_position_filter;
+    }
+
+    const SatelliteTable& UC6580::getSatelliteTable() const {
+        return m_satellites;
+    }
+
+    FixQuality UC6580::getFixQuality() const {
+        FixQuality quality = {};
+        quality.satellites_in_view = m_satellites.count;
+        quality.time_to_first_fix_ms = m_time_to_first_fix;
+
+        uint32_t cn0_used_sum = 0;
+        uint32_t cn0_tracked_sum = 0;
+
+        for (uint8_t i = 0; i < m_satellites.count; i++) {
+            const SatelliteInfo& sat = m_satellites.satellites[i];
+
+            if (sat.cn0_dbhz > 0) {
+                quality.satellites_tracked++;
+                cn0_tracked_sum += sat.cn0_dbhz;
+                if (sat.cn0_dbhz > quality.max_cn0) {
+                    quality.max_cn0 = sat.cn0_dbhz;
+                }
+            }
+
+            if (sat.used_in_fix) {
+                quality.satellites_used++;
+                quality.used_by_constellation[static_cast<uint8_t>(sat.constellation)]++;
+                cn0_used_sum += sat.cn0_dbhz;
+            }
+        }
+
+        if (quality.satellites_used > 0) {
+            quality.mean_cn0_used = static_cast<float>(cn0_used_sum) / quality.satellites_used;
+        }
+        if (quality.satellites_tracked > 0) {
+            quality.mean_cn0_tracked = static_cast<float>(cn0_tracked_sum) / quality.satellites_tracked;
+        }
+
+        return quality;
+    }
+
+    uint32_t UC6580::getTimeToFirstFix() const {
+        return m_time_to_first_fix;
+    }
+
     bool UC6580::hasValidFix() const {
         return m_data.valid && (m_data.fix_type == FixType::FIX_2D || m_data.fix_type == FixType::FIX_3D);
     }
@@ -274,20 +409,7 @@ namespace GPS {
             return -1.0f;
         }
 
-        // Haversine formula for distance calculation
-        const double R = 6371.0; // Earth's radius in km
-
-        double lat1_rad = m_data.latitude * M_PI / 180.0;
-        double lat2_rad = lat * M_PI / 180.0;
-        double dlat = (lat - m_data.latitude) * M_PI / 180.0;
-        double dlon = (lon - m_data.longitude) * M_PI / 180.0;
-
-        double a = sin(dlat/2) * sin(dlat/2) +
-                   cos(lat1_rad) * cos(lat2_rad) *
-                   sin(dlon/2) * sin(dlon/2);
-        double c = 2 * atan2(sqrt(a), sqrt(1-a));
-
-        return static_cast<float>(R * c);
+        return static_cast<float>(Geodesy::haversineKm(m_data.latitude, m_data.longitude, lat, lon));
     }
 
     float UC6580::bearingTo(double lat, double lon) const {
@@ -295,23 +417,7 @@ namespace GPS {
             return -1.0f;
         }
 
-        double lat1_rad = m_data.latitude * M_PI / 180.0;
-        double lat2_rad = lat * M_PI / 180.0;
-        double dlon = (lon - m_data.longitude) * M_PI / 180.0;
-
-        double y = sin(dlon) * cos(lat2_rad);
-        double x = cos(lat1_rad) * sin(lat2_rad) -
-                   sin(lat1_rad) * cos(lat2_rad) * cos(dlon);
-
-        double bearing_rad = atan2(y, x);
-        double bearing_deg = bearing_rad * 180.0 / M_PI;
-
-        // Normalize to 0-360 degrees
-        if (bearing_deg < 0) {
-            bearing_deg += 360.0;
-        }
-
-        return static_cast<float>(bearing_deg);
+        return static_cast<float>(Geodesy::initialBearingDeg(m_data.latitude, m_data.longitude, lat, lon));
     }
 
     HardwareAbstraction::Result UC6580::factoryReset() {
@@ -340,10 +446,31 @@ namespace GPS {
 
         if (hasValidFix()) {
             Serial.printf("Position: %.6f, %.6f\n", m_data.latitude, m_data.longitude);
+            if (m_data.filtered) {
+                const PositionFilterStats& filter = m_position_filter.getStats();
+                Serial.printf("Raw Position: %.6f, %.6f (sigma %.1f m)\n",
+                             m_data.raw_latitude, m_data.raw_longitude, m_data.position_sigma_m);
+                Serial.printf("Filter: %lu accepted, %lu rejected, %lu resets\n",
+                             filter.accepted, filter.rejected, filter.resets);
+            }
             Serial.printf("Altitude: %.2f m\n", m_data.altitude);
             Serial.printf("Speed: %.2f km/h\n", m_data.speed_kmh);
             Serial.printf("Course: %.2f degrees\n", m_data.course_deg);
         }
+
+        const FixQuality quality = getFixQuality();
+        Serial.printf("TTFF: %lu ms\n", quality.time_to_first_fix_ms);
+        Serial.printf("Satellites in view/tracked/used: %u/%u/%u\n",
+                     quality.satellites_in_view, quality.satellites_tracked, quality.satellites_used);
+        Serial.printf("Mean C/N0 used: %.1f dB-Hz, tracked: %.1f dB-Hz, max: %u dB-Hz\n",
+                     quality.mean_cn0_used, quality.mean_cn0_tracked, quality.max_cn0);
+        for (uint8_t i = 0; i < m_satellites.count; i++) {
+            const SatelliteInfo& sat = m_satellites.satellites[i];
+            Serial.printf("  %-7s PRN %3u  El %3d  Az %3u  C/N0 %2u %s\n",
+                         constellationToString(sat.constellation), sat.prn,
+                         sat.elevation_deg, sat.azimuth_deg, sat.cn0_dbhz,
+                         sat.used_in_fix ? "*" : "");
+        }
         Serial.println("======================");
         #endif
     }
@@ -489,15 +616,22 @@ namespace GPS {
         else if (strncmp(fields[0], "$GPRMC", 6) == 0 || strncmp(fields[0], "$GNRMC", 6) == 0) {
             result = parseRMC(fields, field_count);
         }
-        else if (strncmp(fields[0], "$GPGSA", 6) == 0 || strncmp(fields[0], "$GNGSA", 6) == 0) {
+        // GSA/GSV are emitted once per constellation ($GPGSV, $GLGSV, $GAGSV, ...)
+        else if (strlen(fields[0]) == 6 && strcmp(fields[0] + 3, "GSA") == 0) {
             result = parseGSA(fields, field_count);
         }
-        else if (strncmp(fields[0], "$GPGSV", 6) == 0 || strncmp(fields[0], "$GNGSV", 6) == 0) {
+        else if (strlen(fields[0]) == 6 && strcmp(fields[0] + 3, "GSV") == 0) {
             result = parseGSV(fields, field_count);
         }
 
         if (result == HardwareAbstraction::Result::SUCCESS) {
             m_data.timestamp = HardwareAbstraction::Timer::millis();
+
+            // Record time-to-first-fix once per power cycle
+            if (m_time_to_first_fix == 0 && hasValidFix()) {
+                const uint32_t elapsed = m_data.timestamp - m_power_on_time;
+                m_time_to_first_fix = (elapsed > 0) ? elapsed : 1;
+            }
         }
 
         return result;
@@ -529,21 +663,67 @@ namespace GPS {
 
         // Position
         if (strlen(fields[2]) > 0 && strlen(fields[3]) > 0) {
-            m_data.latitude = nmeaToDecimal(fields[2], fields[3][0]);
+            m_data.raw_latitude = nmeaToDecimal(fields[2], fields[3][0]);
         }
 
         if (strlen(fields[4]) > 0 && strlen(fields[5]) > 0) {
-            m_data.longitude = nmeaToDecimal(fields[4], fields[5][0]);
+            m_data.raw_longitude = nmeaToDecimal(fields[4], fields[5][0]);
         }
 
         // Altitude
         if (strlen(fields[9]) > 0) {
-            m_data.altitude = atof(fields[9]);
+            m_data.raw_altitude = atof(fields[9]);
+        }
+
+        m_data.latitude = m_data.raw_latitude;
+        m_data.longitude = m_data.raw_longitude;
+        m_data.altitude = m_data.raw_altitude;
+        m_data.filtered = false;
+        m_data.position_sigma_m = 0.0f;
+
+        if (m_data.valid) {
+            applyPositionFilter(fields[1]);
         }
 
         return HardwareAbstraction::Result::SUCCESS;
     }
 
+    void UC6580::applyPositionFilter(const char* utc_time) {
+        if (!m_config.position_filter) {
+            return;
+        }
+
+        // Clock the filter from the fix epoch (hhmmss.ss) rather than UART arrival time
+        uint32_t time_ms = HardwareAbstraction::Timer::millis();
+        if (strlen(utc_time) >= 6) {
+            const double hhmmss = atof(utc_time);
+            const int32_t hours = static_cast<int32_t>(hhmmss / 10000);
+            const int32_t minutes = static_cast<int32_t>(hhmmss / 100) % 100;
+            const double seconds = fmod(hhmmss, 100.0);
+            const int32_t tod_ms = (hours * 3600 + minutes * 60) * 1000 + static_cast<int32_t>(seconds * 1000.0 + 0.5);
+
+            if (m_last_fix_tod_ms >= 0) {
+                int32_t delta = tod_ms - m_last_fix_tod_ms;
+                if (delta < 0) {
+                    delta += 86400000;  // Midnight rollover
+                }
+                m_fix_clock_ms += delta;
+            }
+            m_last_fix_tod_ms = tod_ms;
+            time_ms = m_fix_clock_ms;
+        }
+
+        m_position_filter.update(m_data.raw_latitude, m_data.raw_longitude, m_data.raw_altitude, true,
+                                 m_data.hdop, m_data.vdop, time_ms);
+
+        const PositionEstimate estimate = m_position_filter.getEstimate();
+        m_data.latitude = estimate.latitude;
+        m_data.longitude = estimate.longitude;
+        m_data.altitude = estimate.altitude;
+        m_data.filtered = true;
+        m_data.position_sigma_m = estimate.horizontal_sigma_m;
+    }
+
     HardwareAbstraction::Result UC6580::parseRMC(const char* fields[], int field_count) {
         // $GPRMC,hhmmss.ss,A,ddmm.mmmm,a,dddmm.mmmm,a,x.x,x.x,ddmmyy,x.x,a*hh
 
@@ -613,15 +793,166 @@ namespace GPS {
             m_data.vdop = atof(fields[17]);
         }
 
+        // Constellation: from the talker, or the NMEA 4.1 system ID for $GNGSA
+        Constellation system = constellationFromTalker(fields[0] + 1);
+        if (system == Constellation::UNKNOWN && field_count > 18 && strlen(fields[18]) > 0) {
+            switch (atoi(fields[18])) {
+                case 1: system = Constellation::GPS; break;
+                case 2: system = Constellation::GLONASS; break;
+                case 3: system = Constellation::GALILEO; break;
+                case 4: system = Constellation::BEIDOU; break;
+                case 5: system = Constellation::QZSS; break;
+                default: break;
+            }
+        }
+
+        // Satellites used in fix (fields 3-14) replace this constellation's
+        // previous set. Without a system ID only the constellations its PRNs
+        // fall in are replaced, so one $GNGSA does not clear the others.
+        uint8_t listed = 0;
+        if (system == Constellation::UNKNOWN) {
+            for (int i = 3; i <= 14; i++) {
+                if (strlen(fields[i]) > 0) {
+                    listed |= 1u << static_cast<uint8_t>(constellationFromPRN(static_cast<uint8_t>(atoi(fields[i]))));
+                }
+            }
+        }
+        for (uint8_t i = 0; i < m_satellites.count; i++) {
+            SatelliteInfo& sat = m_satellites.satellites[i];
+            const bool replaced = system == Constellation::UNKNOWN
+                                      ? (listed & (1u << static_cast<uint8_t>(sat.constellation))) != 0
+                                      : belongsTo(sat, system);
+            if (replaced) {
+                sat.used_in_fix = false;
+            }
+        }
+
+        for (int i = 3; i <= 14; i++) {
+            if (strlen(fields[i]) == 0) {
+                continue;
+            }
+
+            const uint8_t prn = static_cast<uint8_t>(atoi(fields[i]));
+            SatelliteInfo* sat = findOrAddSatellite(resolveConstellation(system, prn), prn, 0);
+            if (sat) {
+                sat->used_in_fix = true;
+            }
+        }
+
         return HardwareAbstraction::Result::SUCCESS;
     }
 
     HardwareAbstraction::Result UC6580::parseGSV(const char* fields[], int field_count) {
-        // GSV sentences provide satellite information
-        // For now, we'll just acknowledge the sentence
+        // $GPGSV,n,k,ss,prn,elev,azim,cn0,...(up to 4 satellites)[,signal]*hh
+
+        if (field_count < 4) {
+            return HardwareAbstraction::Result::ERROR_COMMUNICATION_FAILED;
+        }
+
+        const int total_messages = atoi(fields[1]);
+        const int message_number = atoi(fields[2]);
+        if (total_messages < 1 || message_number < 1 || message_number > total_messages) {
+            return HardwareAbstraction::Result::ERROR_COMMUNICATION_FAILED;
+        }
+
+        // Each multi-part sequence is one epoch per constellation
+        const Constellation system = constellationFromTalker(fields[0] + 1);
+        uint8_t& epoch = m_gsv_epoch[static_cast<uint8_t>(system)];
+        if (message_number == 1) {
+            epoch++;
+            if (epoch == 0) {
+                epoch = 1; // 0 marks entries never refreshed by GSV
+            }
+        }
+
+        int groups = (field_count - 4) / 4;
+        if (groups > 4) {
+            groups = 4;
+        }
+
+        for (int g = 0; g < groups; g++) {
+            const char** sat_fields = &fields[4 + g * 4];
+            if (strlen(sat_fields[0]) == 0) {
+                continue;
+            }
+
+            const uint8_t prn = static_cast<uint8_t>(atoi(sat_fields[0]));
+            const uint8_t cn0 = (strlen(sat_fields[3]) > 0) ? static_cast<uint8_t>(atoi(sat_fields[3])) : 0;
+            const Constellation constellation = resolveConstellation(system, prn);
+
+            SatelliteInfo* sat = findOrAddSatellite(constellation, prn, cn0);
+            if (!sat) {
+                continue;
+            }
+
+            if (constellation != Constellation::UNKNOWN) {
+                sat->constellation = constellation; // Upgrade entries created from a bare GSA PRN
+            }
+            sat->elevation_deg = static_cast<int8_t>(atoi(sat_fields[1]));
+            sat->azimuth_deg = static_cast<uint16_t>(atoi(sat_fields[2]));
+            sat->cn0_dbhz = cn0;
+            sat->epoch = epoch;
+        }
+
+        // Satellites missing from a complete sequence have left view
+        if (message_number == total_messages) {
+            pruneSatellites(system, epoch);
+        }
+
         return HardwareAbstraction::Result::SUCCESS;
     }
 
+    SatelliteInfo* UC6580::findOrAddSatellite(Constellation constellation, uint8_t prn, uint8_t cn0_dbhz) {
+        for (uint8_t i = 0; i < m_satellites.count; i++) {
+            SatelliteInfo& sat = m_satellites.satellites[i];
+            if (sat.prn == prn &&
+                (sat.constellation == constellation ||
+                 sat.constellation == Constellation::UNKNOWN ||
+                 constellation == Constellation::UNKNOWN)) {
+                return &sat;
+            }
+        }
+
+        SatelliteInfo* slot = nullptr;
+        if (m_satellites.count < SatelliteTable::MAX_SATELLITES) {
+            slot = &m_satellites.satellites[m_satellites.count++];
+        } else {
+            // Table full: replace the weakest unused satellite if this one is stronger
+            for (uint8_t i = 0; i < m_satellites.count; i++) {
+                SatelliteInfo& sat = m_satellites.satellites[i];
+                if (!sat.used_in_fix && sat.cn0_dbhz < cn0_dbhz &&
+                    (slot == nullptr || sat.cn0_dbhz < slot->cn0_dbhz)) {
+                    slot = &sat;
+                }
+            }
+            if (!slot) {
+                m_satellites.dropped++;
+                return nullptr;
+            }
+        }
+
+        memset(slot, 0, sizeof(*slot));
+        slot->prn = prn;
+        slot->constellation = constellation;
+        return slot;
+    }
+
+    void UC6580::pruneSatellites(Constellation constellation, uint8_t epoch) {
+        uint8_t i = 0;
+        while (i < m_satellites.count) {
+            const SatelliteInfo& sat = m_satellites.satellites[i];
+            const bool stale = (belongsTo(sat, constellation) && sat.epoch != epoch) ||
+                               (sat.constellation == Constellation::UNKNOWN && sat.epoch == 0 && !sat.used_in_fix);
+
+            if (stale) {
+                // Swap-remove keeps the table compact
+                m_satellites.satellites[i] = m_satellites.satellites[--m_satellites.count];
+            } else {
+                i++;
+            }
+        }
+    }
+
     bool UC6580::validateChecksum(const char* sentence) const {
         const char* asterisk = strchr(sentence, '*');
         if (!asterisk || asterisk - sentence < 1) {
@@ -652,12 +983,20 @@ namespace GPS {
             *asterisk = '\0';
         }
 
+        // Split on every comma so empty fields keep their position
+        // (strtok would collapse them, e.g. missing C/N0 in GSV or PRN slots in GSA)
         int field_count = 0;
-        char* token = strtok(buffer, ",");
+        char* cursor = buffer;
 
-        while (token && field_count < max_fields) {
-            fields[field_count++] = token;
-            token = strtok(nullptr, ",");
+        while (field_count < max_fields) {
+            fields[field_count++] = cursor;
+
+            char* comma = strchr(cursor, ',');
+            if (!comma) {
+                break;
+            }
+            *comma = '\0';
+            cursor = comma + 1;
         }
 
         return field_count;
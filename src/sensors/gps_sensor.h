@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../hardware/hardware_abstraction.h"
+#include "position_filter.h"
 #include <stdint.h>
 
 namespace GPS {
@@ -12,12 +13,63 @@ namespace GPS {
         FIX_3D = 3
     };
 
+    // GNSS constellations reported by the UC6580
+    enum class Constellation : uint8_t {
+        UNKNOWN = 0,
+        GPS,
+        GLONASS,
+        GALILEO,
+        BEIDOU,
+        QZSS,
+        SBAS,
+        COUNT
+    };
+
+    // Per-satellite state from GSV (position/C/N0) and GSA (used in fix)
+    struct SatelliteInfo {
+        uint8_t prn;                    // Satellite PRN / slot number
+        Constellation constellation;    // Owning constellation
+        int8_t elevation_deg;           // Elevation (-90..90 degrees)
+        uint8_t cn0_dbhz;               // Carrier-to-noise density (dB-Hz), 0 = not tracked
+        uint16_t azimuth_deg;           // Azimuth (0-359 degrees)
+        bool used_in_fix;               // Listed in the latest GSA for its constellation
+        uint8_t epoch;                  // GSV cycle that last refreshed this entry
+    };
+
+    // Fixed-size satellite table, updated incrementally as GSV parts arrive
+    struct SatelliteTable {
+        static constexpr uint8_t MAX_SATELLITES = 32;
+
+        SatelliteInfo satellites[MAX_SATELLITES];
+        uint8_t count;                  // Valid entries in satellites[]
+        uint32_t dropped;               // Satellites not stored because the table was full
+    };
+
+    // Fix quality metrics derived from the satellite table
+    struct FixQuality {
+        uint8_t satellites_in_view;     // Entries in the satellite table
+        uint8_t satellites_tracked;     // Entries with a non-zero C/N0
+        uint8_t satellites_used;        // Entries used in the fix
+        uint8_t used_by_constellation[static_cast<uint8_t>(Constellation::COUNT)];
+        float mean_cn0_used;            // Mean C/N0 of used satellites (dB-Hz)
+        float mean_cn0_tracked;         // Mean C/N0 of all tracked satellites (dB-Hz)
+        uint8_t max_cn0;                // Strongest C/N0 in view (dB-Hz)
+        uint32_t time_to_first_fix_ms;  // Power-on to first valid fix, 0 if no fix yet
+    };
+
     // GPS data structure
     struct Data {
-        // Position
+        // Position (filtered when the position filter is enabled, raw otherwise)
         double latitude;        // Degrees
         double longitude;       // Degrees
         float altitude;         // Meters above sea level
+
+        // Unfiltered position from the last GGA
+        double raw_latitude;    // Degrees
+        double raw_longitude;   // Degrees
+        float raw_altitude;     // Meters above sea level
+        bool filtered;          // True if latitude/longitude/altitude are filter output
+        float position_sigma_m; // Filter 1-sigma horizontal uncertainty (0 when unfiltered)
         
         // Accuracy and quality
         float hdop;            // Horizontal dilution of precision
@@ -52,6 +104,7 @@ namespace GPS {
         uint8_t enable_pin;    // GPS enable/power pin
         bool auto_power_on;    // Automatically power on GPS at init
         uint32_t update_rate;  // Update rate in Hz (1-10)
+        bool position_filter;  // Smooth fixes with the Kalman position filter
     };
 
     // GPS sensor class for UC6580 GNSS chip
@@ -66,9 +119,10 @@ namespace GPS {
         bool isInitialized() const;
 
         // Power management
-        HardwareAbstraction::Result powerOn();
+        HardwareAbstraction::Result powerOn(bool wait_for_startup = true); // false: return immediately
         HardwareAbstraction::Result powerOff();
         bool isPowered() const;
+        bool isStartingUp() const;                               // Powered but still within startup time
 
         // Configuration
         HardwareAbstraction::Result setBaudRate(uint32_t baud_rate);
@@ -77,10 +131,21 @@ namespace GPS {
 
         // Data reading
         HardwareAbstraction::Result update();                    // Update GPS data from UART
+        HardwareAbstraction::Result processNMEA(const char* sentence); // Feed one raw NMEA sentence
         const Data& getData() const;                             // Get latest GPS data
         bool hasValidFix() const;                                // Check if GPS has valid fix
         bool isDataFresh(uint32_t max_age_ms = 5000) const;      // Check if data is fresh
 
+        // Satellite table and fix quality
+        const SatelliteTable& getSatelliteTable() const;         // Per-satellite GSV/GSA state
+        FixQuality getFixQuality() const;                        // Metrics derived from the table
+        uint32_t getTimeToFirstFix() const;                      // TTFF in ms, 0 if no fix yet
+
+        // Position filter
+        void setPositionFilterEnabled(bool enabled);
+        void configurePositionFilter(const PositionFilterConfig& config);
+        const PositionFilter& getPositionFilter() const;
+
         // Utility functions
         float distanceTo(double lat, double lon) const;          // Distance to coordinates (km)
         float bearingTo(double lat, double lon) const;           // Bearing to coordinates (degrees)
@@ -94,6 +159,7 @@ namespace GPS {
     private:
         Config m_config;
         Data m_data;
+        SatelliteTable m_satellites;
         bool m_initialized;
         bool m_powered;
         
@@ -101,6 +167,16 @@ namespace GPS {
         uint32_t m_messages_received;
         uint32_t m_parse_errors;
         uint32_t m_last_update;
+
+        // Satellite tracking
+        uint8_t m_gsv_epoch[static_cast<uint8_t>(Constellation::COUNT)];
+        uint32_t m_power_on_time;
+        uint32_t m_time_to_first_fix;
+
+        // Position filtering, clocked by the GGA UTC time
+        PositionFilter m_position_filter;
+        uint32_t m_fix_clock_ms;
+        int32_t m_last_fix_tod_ms;
         
         // Internal methods
         HardwareAbstraction::Result parseNMEA(const char* sentence);
@@ -108,21 +184,32 @@ namespace GPS {
         HardwareAbstraction::Result parseRMC(const char* fields[], int field_count);
         HardwareAbstraction::Result parseGSA(const char* fields[], int field_count);
         HardwareAbstraction::Result parseGSV(const char* fields[], int field_count);
+
+        SatelliteInfo* findOrAddSatellite(Constellation constellation, uint8_t prn, uint8_t cn0_dbhz);
+        void pruneSatellites(Constellation constellation, uint8_t epoch);
         
         bool validateChecksum(const char* sentence) const;
         int splitNMEA(const char* sentence, const char* fields[], int max_fields) const;
         double nmeaToDecimal(const char* nmea_coord, char direction) const;
         float knots_to_kmh(float knots) const;
+        void applyPositionFilter(const char* utc_time);
         
         // Hardware interface helpers
         HardwareAbstraction::Result configureUART();
         HardwareAbstraction::Result sendCommand(const char* command);
         int readLine(char* buffer, int max_length, uint32_t timeout_ms = 1000);
+
+        static constexpr uint32_t STARTUP_TIME_MS = 1000;
     };
 
     // Global GPS instance (singleton pattern for simplicity)
     extern UC6580 g_gps;
     
+    // Constellation helpers
+    Constellation constellationFromTalker(const char* talker);   // "GP", "GL", ... ("GN" = UNKNOWN)
+    Constellation constellationFromPRN(uint8_t prn);             // NMEA PRN range heuristic
+    const char* constellationToString(Constellation constellation);
+
     // Configuration functions  
     Config getDefaultConfig();                                   // Get default config for Wireless Tracker
     Config getWirelessTrackerV11Config();                        // Specific config for V1.1 hardware
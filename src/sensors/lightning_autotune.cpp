@@ -0,0 +1,217 @@
+#include "lightning_autotune.h"
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+namespace Sensors {
+
+    static constexpr float MS_PER_MIN = 60000.0f;
+
+    NoiseAutoTuneConfig getDefaultNoiseAutoTuneConfig() {
+        NoiseAutoTuneConfig config = {};
+        config.bucket_ms = 20000;
+        config.min_observe_ms = 60000;
+        config.min_raise_events = 6;              // One stray burst is not a trend
+        config.relax_ms = 300000;                 // 5 minutes quiet per step down
+        config.noise_raise_per_min = 4.0f;
+        config.noise_relax_per_min = 0.2f;
+        config.disturber_raise_per_min = 8.0f;
+        config.disturber_relax_per_min = 1.0f;
+        config.min = {0, 1, 1};
+        config.max = {7, 10, 11};                 // WDTH/SREJ beyond these cost too much range
+        return config;
+    }
+
+    const char* noiseParameterToString(NoiseParameter parameter) {
+        switch (parameter) {
+            case NoiseParameter::NOISE_FLOOR: return "noise_floor";
+            case NoiseParameter::WATCHDOG_THRESHOLD: return "watchdog_threshold";
+            case NoiseParameter::SPIKE_REJECTION: return "spike_rejection";
+            default: return "unknown";
+        }
+    }
+
+    void NoiseAutoTuner::Channel::reset(uint32_t total, uint32_t now_ms) {
+        last_total = total;
+        memset(buckets, 0, sizeof(buckets));
+        current = 0;
+        window_start_ms = now_ms;
+        since_step_count = 0;
+        since_step_ms = now_ms;
+    }
+
+    void NoiseAutoTuner::Channel::add(uint32_t total) {
+        const uint32_t delta = total - last_total;
+        last_total = total;
+        since_step_count += delta;
+
+        const uint32_t sum = buckets[current] + delta;
+        buckets[current] = (sum > UINT16_MAX) ? UINT16_MAX : static_cast<uint16_t>(sum);
+    }
+
+    void NoiseAutoTuner::Channel::rotate() {
+        current = (current + 1) % WINDOW_BUCKETS;
+        buckets[current] = 0;
+    }
+
+    uint32_t NoiseAutoTuner::Channel::count() const {
+        uint32_t total = 0;
+        for (uint8_t i = 0; i < WINDOW_BUCKETS; i++) {
+            total += buckets[i];
+        }
+        return total;
+    }
+
+    float NoiseAutoTuner::Channel::rate(uint32_t now_ms, uint32_t window_ms) const {
+        uint32_t observed = now_ms - window_start_ms;
+        if (observed > window_ms) {
+            observed = window_ms;
+        }
+        return observed ? count() * MS_PER_MIN / observed : 0.0f;
+    }
+
+    float NoiseAutoTuner::Channel::rateSinceStep(uint32_t now_ms) const {
+        const uint32_t elapsed = now_ms - since_step_ms;
+        return elapsed ? since_step_count * MS_PER_MIN / elapsed : 0.0f;
+    }
+
+    NoiseAutoTuner::NoiseAutoTuner() {
+        begin(getDefaultNoiseAutoTuneConfig(), 0);
+    }
+
+    void NoiseAutoTuner::begin(const NoiseAutoTuneConfig& config, uint32_t now_ms) {
+        (void)now_ms;
+        m_config = config;
+        m_started = false;
+        m_bucket_start_ms = 0;
+        memset(&m_noise, 0, sizeof(m_noise));
+        memset(&m_disturber, 0, sizeof(m_disturber));
+        memset(m_log, 0, sizeof(m_log));
+        m_log_head = 0;
+        m_log_count = 0;
+        m_total_adjustments = 0;
+    }
+
+    bool NoiseAutoTuner::update(uint32_t noise_total, uint32_t disturber_total, NoiseSettings& settings, uint32_t now_ms) {
+        if (!m_started) {
+            m_noise.reset(noise_total, now_ms);
+            m_disturber.reset(disturber_total, now_ms);
+            m_bucket_start_ms = now_ms;
+            m_started = true;
+            return false;
+        }
+
+        m_noise.add(noise_total);
+        m_disturber.add(disturber_total);
+
+        // Not polled for a whole window: the counts cannot be placed in time
+        if (now_ms - m_bucket_start_ms >= 2 * windowMs()) {
+            m_noise.reset(noise_total, now_ms);
+            m_disturber.reset(disturber_total, now_ms);
+            m_bucket_start_ms = now_ms;
+            return false;
+        }
+
+        bool changed = false;
+        while (now_ms - m_bucket_start_ms >= m_config.bucket_ms) {
+            m_bucket_start_ms += m_config.bucket_ms;
+            changed |= evaluateNoise(settings, m_bucket_start_ms);
+            changed |= evaluateDisturbers(settings, m_bucket_start_ms);
+            m_noise.rotate();
+            m_disturber.rotate();
+        }
+        return changed;
+    }
+
+    bool NoiseAutoTuner::evaluateNoise(NoiseSettings& settings, uint32_t now_ms) {
+        const float rate = m_noise.rate(now_ms, windowMs());
+        if (now_ms - m_noise.window_start_ms >= m_config.min_observe_ms &&
+            m_noise.count() >= m_config.min_raise_events && rate > m_config.noise_raise_per_min && settings.noiseFloor < m_config.max.noiseFloor) {
+            step(NoiseParameter::NOISE_FLOOR, settings.noiseFloor, 1, rate, m_noise, now_ms);
+            return true;
+        }
+
+        const float quiet = m_noise.rateSinceStep(now_ms);
+        if (now_ms - m_noise.since_step_ms >= relaxMs(m_noise) &&
+            quiet < m_config.noise_relax_per_min && settings.noiseFloor > m_config.min.noiseFloor) {
+            step(NoiseParameter::NOISE_FLOOR, settings.noiseFloor, -1, quiet, m_noise, now_ms);
+            return true;
+        }
+        return false;
+    }
+
+    bool NoiseAutoTuner::evaluateDisturbers(NoiseSettings& settings, uint32_t now_ms) {
+        // Watchdog first: it costs less sensitivity than spike rejection
+        const float rate = m_disturber.rate(now_ms, windowMs());
+        if (now_ms - m_disturber.window_start_ms >= m_config.min_observe_ms &&
+            m_disturber.count() >= m_config.min_raise_events && rate > m_config.disturber_raise_per_min) {
+            if (settings.watchdogThreshold < m_config.max.watchdogThreshold) {
+                step(NoiseParameter::WATCHDOG_THRESHOLD, settings.watchdogThreshold, 1, rate, m_disturber, now_ms);
+                return true;
+            }
+            if (settings.spikeRejection < m_config.max.spikeRejection) {
+                step(NoiseParameter::SPIKE_REJECTION, settings.spikeRejection, 1, rate, m_disturber, now_ms);
+                return true;
+            }
+            return false;
+        }
+
+        const float quiet = m_disturber.rateSinceStep(now_ms);
+        if (now_ms - m_disturber.since_step_ms >= relaxMs(m_disturber) &&
+            quiet < m_config.disturber_relax_per_min) {
+            if (settings.spikeRejection > m_config.min.spikeRejection) {
+                step(NoiseParameter::SPIKE_REJECTION, settings.spikeRejection, -1, quiet, m_disturber, now_ms);
+                return true;
+            }
+            if (settings.watchdogThreshold > m_config.min.watchdogThreshold) {
+                step(NoiseParameter::WATCHDOG_THRESHOLD, settings.watchdogThreshold, -1, quiet, m_disturber, now_ms);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void NoiseAutoTuner::step(NoiseParameter parameter, uint8_t& value, int8_t delta, float rate,
+                              Channel& channel, uint32_t now_ms) {
+        NoiseAdjustment& entry = m_log[m_log_head];
+        entry.time_ms = now_ms;
+        entry.parameter = parameter;
+        entry.from = value;
+        entry.to = static_cast<uint8_t>(value + delta);
+        entry.rate_per_min = rate;
+
+        m_log_head = (m_log_head + 1) % LOG_SIZE;
+        if (m_log_count < LOG_SIZE) {
+            m_log_count++;
+        }
+        m_total_adjustments++;
+
+        #ifdef ARDUINO
+        Serial.printf("[AS3935] %s %u -> %u (%.2f/min)\n",
+                      noiseParameterToString(parameter), entry.from, entry.to, rate);
+        #endif
+
+        value = entry.to;
+
+        // Raise soon after a relax: that relax was premature, wait longer next time
+        const bool reversed = channel.last_delta < 0 && (now_ms - channel.since_step_ms) < m_config.relax_ms;
+        if (delta > 0 && reversed) {
+            if (channel.relax_shift < MAX_RELAX_SHIFT) {
+                channel.relax_shift++;
+            }
+        } else if (delta < 0 && channel.last_delta < 0 && channel.relax_shift > 0) {
+            channel.relax_shift--;
+        }
+        channel.last_delta = delta;
+
+        // Judge the new setting on fresh counts only
+        channel.reset(channel.last_total, now_ms);
+    }
+
+    const NoiseAdjustment& NoiseAutoTuner::getAdjustment(size_t index) const {
+        const size_t oldest = (m_log_head + LOG_SIZE - m_log_count) % LOG_SIZE;
+        return m_log[(oldest + index) % LOG_SIZE];
+    }
+}
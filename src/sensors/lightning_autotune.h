@@ -0,0 +1,115 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Sensors {
+
+    // Analog front-end settings the auto-tuner steers
+    struct NoiseSettings {
+        uint8_t noiseFloor;         // NF_LEV 0-7
+        uint8_t watchdogThreshold;  // WDTH 0-15
+        uint8_t spikeRejection;     // SREJ 0-15
+    };
+
+    // Auto-tuner thresholds. Raise and relax rates form the hysteresis band:
+    // rates between them leave the settings alone.
+    struct NoiseAutoTuneConfig {
+        uint32_t bucket_ms;                 // Sliding window granularity; decisions run at bucket edges
+        uint32_t min_observe_ms;            // Evidence needed before stepping up
+        uint16_t min_raise_events;          // ...and at least this many interrupts in the window
+        uint32_t relax_ms;                  // Quiet time needed before stepping down
+        float noise_raise_per_min;          // NOISE interrupts above this raise NF_LEV
+        float noise_relax_per_min;          // ...below this (over relax_ms) lower it
+        float disturber_raise_per_min;      // Disturbers above this raise WDTH, then SREJ
+        float disturber_relax_per_min;      // ...below this lower SREJ, then WDTH
+        NoiseSettings min;
+        NoiseSettings max;
+    };
+
+    enum class NoiseParameter : uint8_t {
+        NOISE_FLOOR,
+        WATCHDOG_THRESHOLD,
+        SPIKE_REJECTION
+    };
+
+    // One logged adjustment
+    struct NoiseAdjustment {
+        uint32_t time_ms;
+        NoiseParameter parameter;
+        uint8_t from;
+        uint8_t to;
+        float rate_per_min;         // Rate that triggered the step
+    };
+
+    // Closed-loop controller for the AS3935 noise floor, watchdog and spike
+    // rejection. Escalates on the short sliding-window rate and relaxes only
+    // after relax_ms of low activity, one step per parameter per bucket.
+    // A relax step that has to be undone doubles the next relax time, so a
+    // site sitting just above a threshold does not oscillate.
+    class NoiseAutoTuner {
+    public:
+        static constexpr uint8_t WINDOW_BUCKETS = 6;
+        static constexpr uint8_t LOG_SIZE = 16;
+        static constexpr uint8_t MAX_RELAX_SHIFT = 3;   // Up to 8x relax_ms after reversed relaxes
+
+        NoiseAutoTuner();
+
+        void begin(const NoiseAutoTuneConfig& config, uint32_t now_ms);
+
+        // Feed the cumulative NOISE/disturber interrupt counters. settings holds the
+        // values currently applied and is stepped in place; returns true if it changed.
+        bool update(uint32_t noise_total, uint32_t disturber_total, NoiseSettings& settings, uint32_t now_ms);
+
+        float getNoiseRatePerMin(uint32_t now_ms) const { return m_noise.rate(now_ms, windowMs()); }
+        float getDisturberRatePerMin(uint32_t now_ms) const { return m_disturber.rate(now_ms, windowMs()); }
+
+        // Adjustment log, oldest first
+        size_t getAdjustmentCount() const { return m_log_count; }
+        const NoiseAdjustment& getAdjustment(size_t index) const;
+        uint32_t getTotalAdjustments() const { return m_total_adjustments; }
+
+        const NoiseAutoTuneConfig& getConfig() const { return m_config; }
+
+    private:
+        // Interrupt counts for one source: sliding window plus a since-last-step accumulator
+        struct Channel {
+            uint32_t last_total;
+            uint16_t buckets[WINDOW_BUCKETS];
+            uint8_t current;
+            uint32_t window_start_ms;       // Window restarts after every step
+            uint32_t since_step_count;
+            uint32_t since_step_ms;
+            int8_t last_delta;              // Direction of the last step on this channel
+            uint8_t relax_shift;            // Relax time backoff (relax_ms << shift)
+
+            void reset(uint32_t total, uint32_t now_ms);
+            void add(uint32_t total);
+            void rotate();
+            uint32_t count() const;
+            float rate(uint32_t now_ms, uint32_t window_ms) const;
+            float rateSinceStep(uint32_t now_ms) const;
+        };
+
+        NoiseAutoTuneConfig m_config;
+        Channel m_noise;
+        Channel m_disturber;
+        bool m_started;
+        uint32_t m_bucket_start_ms;
+
+        NoiseAdjustment m_log[LOG_SIZE];
+        size_t m_log_head;
+        size_t m_log_count;
+        uint32_t m_total_adjustments;
+
+        uint32_t windowMs() const { return m_config.bucket_ms * WINDOW_BUCKETS; }
+        uint32_t relaxMs(const Channel& channel) const { return m_config.relax_ms << channel.relax_shift; }
+        bool evaluateNoise(NoiseSettings& settings, uint32_t now_ms);
+        bool evaluateDisturbers(NoiseSettings& settings, uint32_t now_ms);
+        void step(NoiseParameter parameter, uint8_t& value, int8_t delta, float rate, Channel& channel, uint32_t now_ms);
+    };
+
+    // Defaults: 2 min window in 20 s buckets, 5 min relax time
+    NoiseAutoTuneConfig getDefaultNoiseAutoTuneConfig();
+    const char* noiseParameterToString(NoiseParameter parameter);
+}
@@ -0,0 +1,891 @@
+#include "lightning_sensor.h"
+#include "../system/event_log.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+namespace Sensors {
+
+    using namespace HardwareAbstraction;
+
+    LightningSensor* LightningSensor::instance_ = nullptr;
+
+    AS3935BusConfig getDefaultAS3935BusConfig() {
+        AS3935BusConfig bus = {};
+        bus.interface = AS3935Interface::SPI;
+        bus.csPin = SystemConfig::Pins::LIGHTNING_CS;
+        bus.spiFrequency = 2000000;
+        bus.i2cAddress = 0x03;
+        bus.sdaPin = SystemConfig::Pins::I2C_SDA;
+        bus.sclPin = SystemConfig::Pins::I2C_SCL;
+        bus.i2cFrequency = 400000;
+        bus.irqPin = SystemConfig::Pins::LIGHTNING_IRQ;
+        return bus;
+    }
+
+    void TimingStats::add(uint32_t us) {
+        if (count == 0 || us < minUs) {
+            minUs = us;
+        }
+        if (us > maxUs) {
+            maxUs = us;
+        }
+        lastUs = us;
+        totalUs += us;
+        count++;
+    }
+
+    LightningSensor::LightningSensor()
+        : LightningSensor(getDefaultAS3935BusConfig())
+    {
+    }
+
+    LightningSensor::LightningSensor(const AS3935BusConfig& bus)
+        : state_(State::UNINITIALIZED)
+        , hasNewData_(false)
+        , readingCount_(0)
+        , lastError_(0)
+        , bus_(bus)
+        , autoTuneEnabled_(true)
+        , stormTracker_(nullptr)
+        , eventLog_(nullptr)
+        , eventHead_(0)
+        , eventTail_(0)
+        , droppedEvents_(0)
+        , interruptPending_(false)
+    {
+        config_.noiseFloor = SystemConfig::Lightning::NOISE_FLOOR;
+        config_.watchdogThreshold = SystemConfig::Lightning::WATCHDOG_THRESHOLD;
+        config_.spikeRejection = SystemConfig::Lightning::SPIKE_REJECTION;
+        config_.minimumStrikes = SystemConfig::Lightning::MIN_STRIKES;
+        config_.indoorMode = false;
+        config_.disturbersLightning = false;
+        config_.tuningCapacitor = 0;
+
+        memset(&stats_, 0, sizeof(stats_));
+        memset(&lastLightning_, 0, sizeof(lastLightning_));
+        memset(&tuning_, 0, sizeof(tuning_));
+        memset(&busTime_, 0, sizeof(busTime_));
+        memset(&latency_, 0, sizeof(latency_));
+    }
+
+    LightningSensor::~LightningSensor() {
+        deinitialize();
+    }
+
+    // ---------------------------------------------------------------------
+    // ISensor lifecycle
+    // ---------------------------------------------------------------------
+
+    bool LightningSensor::initialize() {
+        if (state_ == State::READY) {
+            return true;
+        }
+
+        setState(State::INITIALIZING);
+
+        if (!isConfigurationValid(config_)) {
+            reportError(LightningErrorCodes::INVALID_CONFIGURATION);
+            setState(State::ERROR);
+            return false;
+        }
+
+        if (!beginBus()) {
+            reportError(LightningErrorCodes::COMMUNICATION_FAILED, "bus init");
+            setState(State::ERROR);
+            return false;
+        }
+
+        // PRESET_DEFAULT, then check a known reset value: the AS3935 has no ID register
+        uint8_t nfWdth = 0;
+        if (!writeRegister(AS3935Register::PRESET_DEFAULT, AS3935Bits::DIRECT_COMMAND) ||
+            (Timer::delay(RESET_DELAY_MS), !readRegister(AS3935Register::NF_LEV, nfWdth)) ||
+            nfWdth != AS3935Bits::DEFAULT_NF_WDTH) {
+            reportError(LightningErrorCodes::CHIP_NOT_FOUND);
+            setState(State::ERROR);
+            return false;
+        }
+
+        // A stored TUN_CAP skips the ~0.3 s antenna tuning on every boot
+        const bool tuningStored = loadTuning();
+
+        if (!applyConfig()) {
+            setState(State::ERROR);
+            return false;
+        }
+
+        // Untuned antenna still detects, just with reduced range: not fatal
+        if (!tuningStored) {
+            tuneTankCircuit();
+        }
+
+        if (!calibrateRCO()) {
+            setState(State::ERROR);
+            return false;
+        }
+
+        eventHead_ = 0;
+        eventTail_ = 0;
+        instance_ = this;
+
+        if (GPIO::pinMode(bus_.irqPin, GPIO::Mode::MODE_INPUT) != Result::SUCCESS ||
+            GPIO::attachInterrupt(bus_.irqPin, interruptHandler, RISING) != Result::SUCCESS) {
+            instance_ = nullptr;
+            reportError(LightningErrorCodes::INTERRUPT_SETUP_FAILED);
+            setState(State::ERROR);
+            return false;
+        }
+
+        setState(State::READY);
+        return true;
+    }
+
+    bool LightningSensor::deinitialize() {
+        if (state_ == State::UNINITIALIZED) {
+            return true;
+        }
+
+        GPIO::detachInterrupt(bus_.irqPin);
+        if (instance_ == this) {
+            instance_ = nullptr;
+        }
+
+        powerDown();
+        setState(State::UNINITIALIZED);
+        return true;
+    }
+
+    uint16_t LightningSensor::getCapabilities() const {
+        using SensorSystem::Capability;
+        return static_cast<uint16_t>(Capability::INTERRUPT_CAPABLE) |
+               static_cast<uint16_t>(Capability::CONFIGURABLE) |
+               static_cast<uint16_t>(Capability::SELF_TEST) |
+               static_cast<uint16_t>(Capability::CALIBRATION) |
+               static_cast<uint16_t>(Capability::POWER_MANAGEMENT);
+    }
+
+    // ---------------------------------------------------------------------
+    // Event path
+    // ---------------------------------------------------------------------
+
+    void IRAM_ATTR LightningSensor::interruptHandler() {
+        if (instance_) {
+            instance_->handleInterrupt();
+        }
+    }
+
+    void IRAM_ATTR LightningSensor::handleInterrupt() {
+        const uint32_t now = Timer::micros();
+        const uint8_t head = eventHead_;
+        const uint8_t next = (head + 1) & (EVENT_QUEUE_SIZE - 1);
+
+        if (next == eventTail_) {
+            droppedEvents_ = droppedEvents_ + 1;
+            return;
+        }
+
+        eventTimes_[head] = now;
+        eventHead_ = next;
+        interruptPending_ = true;
+    }
+
+    void LightningSensor::update() {
+        if (state_ != State::READY) {
+            return;
+        }
+
+        while (eventTail_ != eventHead_) {
+            const uint8_t tail = eventTail_;
+            const uint32_t irqMicros = eventTimes_[tail];
+
+            // Leave the event queued until the INT register is valid
+            if (Timer::micros() - irqMicros < INT_SETTLE_US) {
+                break;
+            }
+
+            eventTail_ = (tail + 1) & (EVENT_QUEUE_SIZE - 1);
+            processEvent(irqMicros);
+        }
+
+        interruptPending_ = (eventTail_ != eventHead_);
+
+        if (droppedEvents_ > 0 && lastError_ != LightningErrorCodes::EVENT_QUEUE_OVERFLOW) {
+            reportError(LightningErrorCodes::EVENT_QUEUE_OVERFLOW);
+        }
+
+        if (autoTuneEnabled_) {
+            NoiseSettings settings = {config_.noiseFloor, config_.watchdogThreshold, config_.spikeRejection};
+            if (autoTune_.update(stats_.totalNoise, stats_.totalDisturbers, settings, Timer::millis())) {
+                applyNoiseSettings(settings);
+            }
+        }
+
+        if (stormTracker_) {
+            logStormEvent(stormTracker_->update(Timer::millis()));
+        }
+    }
+
+    void LightningSensor::processEvent(uint32_t irqMicros) {
+        AS3935EventRegisters regs;
+
+        const uint32_t start = Timer::micros();
+        const bool ok = readEventRegisters(regs);
+        const uint32_t end = Timer::micros();
+
+        busTime_.add(end - start);
+
+        if (!ok) {
+            stats_.communicationErrors++;
+            reportError(LightningErrorCodes::COMMUNICATION_FAILED, "event read");
+            return;
+        }
+
+        const uint32_t now = Timer::millis();
+        stats_.lastActivity = now;
+
+        switch (regs.interrupt) {
+            case static_cast<uint8_t>(InterruptReason::NOISE):
+                stats_.totalNoise++;
+                return;
+
+            case static_cast<uint8_t>(InterruptReason::DISTURBER):
+                stats_.totalDisturbers++;
+                if (!config_.disturbersLightning) {
+                    return;
+                }
+                break;
+
+            case static_cast<uint8_t>(InterruptReason::LIGHTNING):
+                stats_.totalLightning++;
+                break;
+
+            default:
+                // INT = 0: distance estimate changed by the statistics purge
+                return;
+        }
+
+        const bool disturber = (regs.interrupt == static_cast<uint8_t>(InterruptReason::DISTURBER));
+        const bool series = lastLightning_.lightningDetected &&
+                            (now - lastLightning_.lastStrikeTime) < STRIKE_SERIES_WINDOW_MS;
+
+        lastLightning_.lightningDetected = true;
+        lastLightning_.distance = disturber ? 63 : regs.distance;
+        lastLightning_.energy = disturber ? 0 : regs.energy;
+        lastLightning_.strikeCount = series && lastLightning_.strikeCount < 255 ? lastLightning_.strikeCount + 1 : 1;
+        lastLightning_.lastStrikeTime = now;
+        lastLightning_.isDisturber = disturber;
+        lastLightning_.noiseLevel = config_.noiseFloor;
+
+        hasNewData_ = true;
+        readingCount_++;
+
+        latency_.add(Timer::micros() - irqMicros);
+
+        if (eventLog_) {
+            Logging::StrikeEventData strike = {};
+            strike.energy = lastLightning_.energy;
+            strike.distance_km = lastLightning_.distance;
+            strike.strike_count = lastLightning_.strikeCount;
+            eventLog_->append(disturber ? Logging::EventType::DISTURBER : Logging::EventType::STRIKE,
+                              &strike, sizeof(strike));
+        }
+
+        if (stormTracker_ && !disturber) {
+            logStormEvent(stormTracker_->addStrike(regs.distance, regs.energy, now));
+        }
+
+        if (readingCallback_) {
+            Reading reading = {};
+            reading.timestamp = now;
+            reading.type = SensorSystem::DataType::INTEGER;
+            reading.name = "lightning_distance";
+            reading.unit = "km";
+            reading.value.intValue = lastLightning_.distance;
+            reading.isValid = true;
+            readingCallback_(reading);
+        }
+    }
+
+    bool LightningSensor::readEventRegisters(AS3935EventRegisters& regs) {
+        // INT, S_LIG_L, S_LIG_M, S_LIG_MM, DISTANCE in one transaction
+        uint8_t raw[5];
+        if (!readRegisters(static_cast<uint8_t>(AS3935Register::INT), raw, sizeof(raw))) {
+            return false;
+        }
+
+        regs.interrupt = raw[0] & AS3935Bits::INT_MASK;
+        regs.energy = static_cast<uint32_t>(raw[1]) |
+                      (static_cast<uint32_t>(raw[2]) << 8) |
+                      (static_cast<uint32_t>(raw[3] & AS3935Bits::ENERGY_MMSB_MASK) << 16);
+        regs.distance = raw[4] & AS3935Bits::DISTANCE_MASK;
+        return true;
+    }
+
+    bool LightningSensor::readSensor(Reading& reading) {
+        if (state_ != State::READY || !hasNewData_) {
+            return false;
+        }
+
+        reading = {};
+        reading.timestamp = lastLightning_.lastStrikeTime;
+        reading.type = SensorSystem::DataType::INTEGER;
+        reading.name = "lightning_distance";
+        reading.unit = "km";
+        reading.value.intValue = lastLightning_.distance;
+        reading.isValid = true;
+
+        hasNewData_ = false;
+        return true;
+    }
+
+    bool LightningSensor::getLastLightningData(LightningData& data) const {
+        if (!lastLightning_.lightningDetected) {
+            return false;
+        }
+        data = lastLightning_;
+        return true;
+    }
+
+    // ---------------------------------------------------------------------
+    // Configuration
+    // ---------------------------------------------------------------------
+
+    bool LightningSensor::setNoiseFloor(uint8_t level) {
+        if (level > 7) {
+            return false;
+        }
+        if (state_ == State::READY && !modifyRegister(AS3935Register::NF_LEV, AS3935Bits::NF_LEV_MASK, level << 4)) {
+            return false;
+        }
+        config_.noiseFloor = level;
+        return true;
+    }
+
+    bool LightningSensor::setWatchdogThreshold(uint8_t threshold) {
+        if (threshold > 15) {
+            return false;
+        }
+        if (state_ == State::READY && !modifyRegister(AS3935Register::WDTH, AS3935Bits::WDTH_MASK, threshold)) {
+            return false;
+        }
+        config_.watchdogThreshold = threshold;
+        return true;
+    }
+
+    bool LightningSensor::setSpikeRejection(uint8_t rejection) {
+        if (rejection > 15) {
+            return false;
+        }
+        if (state_ == State::READY && !modifyRegister(AS3935Register::SREJ, AS3935Bits::SREJ_MASK, rejection)) {
+            return false;
+        }
+        config_.spikeRejection = rejection;
+        return true;
+    }
+
+    bool LightningSensor::setMinimumStrikes(uint8_t strikes) {
+        uint8_t code;
+        switch (strikes) {
+            case 1: code = 0; break;
+            case 5: code = 1; break;
+            case 9: code = 2; break;
+            case 16: code = 3; break;
+            default: return false;
+        }
+        if (state_ == State::READY &&
+            !modifyRegister(AS3935Register::MIN_NUM_LIGH, AS3935Bits::MIN_NUM_LIGH_MASK, code << 4)) {
+            return false;
+        }
+        config_.minimumStrikes = strikes;
+        return true;
+    }
+
+    bool LightningSensor::setIndoorMode(bool indoor) {
+        const uint8_t gain = indoor ? AS3935Bits::AFE_GB_INDOOR : AS3935Bits::AFE_GB_OUTDOOR;
+        if (state_ == State::READY && !modifyRegister(AS3935Register::AFE_GAIN, AS3935Bits::AFE_GB_MASK, gain)) {
+            return false;
+        }
+        config_.indoorMode = indoor;
+        return true;
+    }
+
+    bool LightningSensor::maskDisturbers(bool mask) {
+        if (state_ == State::READY &&
+            !modifyRegister(AS3935Register::MASK_DIST, AS3935Bits::MASK_DIST, mask ? AS3935Bits::MASK_DIST : 0)) {
+            return false;
+        }
+        // Masked disturbers never interrupt, so they cannot be reported as lightning either
+        config_.disturbersLightning = config_.disturbersLightning && !mask;
+        return true;
+    }
+
+    void LightningSensor::setAutoTuneEnabled(bool enabled) {
+        if (enabled && !autoTuneEnabled_) {
+            autoTune_.begin(autoTune_.getConfig(), Timer::millis());
+        }
+        autoTuneEnabled_ = enabled;
+    }
+
+    void LightningSensor::configureAutoTune(const NoiseAutoTuneConfig& config) {
+        autoTune_.begin(config, Timer::millis());
+    }
+
+    void LightningSensor::applyNoiseSettings(const NoiseSettings& settings) {
+        if (settings.noiseFloor != config_.noiseFloor) {
+            setNoiseFloor(settings.noiseFloor);
+        }
+        if (settings.watchdogThreshold != config_.watchdogThreshold) {
+            setWatchdogThreshold(settings.watchdogThreshold);
+        }
+        if (settings.spikeRejection != config_.spikeRejection) {
+            setSpikeRejection(settings.spikeRejection);
+        }
+    }
+
+    bool LightningSensor::applyConfig() {
+        const uint8_t minStrikes = config_.minimumStrikes;
+        config_.minimumStrikes = 0;     // Force the write in setMinimumStrikes
+
+        const bool ok =
+            modifyRegister(AS3935Register::AFE_GAIN, AS3935Bits::AFE_GB_MASK,
+                           config_.indoorMode ? AS3935Bits::AFE_GB_INDOOR : AS3935Bits::AFE_GB_OUTDOOR) &&
+            modifyRegister(AS3935Register::NF_LEV, AS3935Bits::NF_LEV_MASK | AS3935Bits::WDTH_MASK,
+                           (config_.noiseFloor << 4) | config_.watchdogThreshold) &&
+            modifyRegister(AS3935Register::SREJ, AS3935Bits::SREJ_MASK, config_.spikeRejection) &&
+            modifyRegister(AS3935Register::TUN_CAP, AS3935Bits::TUN_CAP_MASK, config_.tuningCapacitor);
+
+        config_.minimumStrikes = minStrikes;
+        if (!ok) {
+            return false;
+        }
+
+        uint8_t code = 0;
+        switch (minStrikes) {
+            case 5: code = 1; break;
+            case 9: code = 2; break;
+            case 16: code = 3; break;
+            default: code = 0; break;
+        }
+        return modifyRegister(AS3935Register::MIN_NUM_LIGH, AS3935Bits::MIN_NUM_LIGH_MASK, code << 4);
+    }
+
+    bool LightningSensor::setParameter(const char* name, const void* value, size_t size) {
+        if (!name || !value || size != sizeof(uint8_t)) {
+            return false;
+        }
+
+        const uint8_t v = *static_cast<const uint8_t*>(value);
+
+        if (strcmp(name, "noise_floor") == 0) return setNoiseFloor(v);
+        if (strcmp(name, "watchdog_threshold") == 0) return setWatchdogThreshold(v);
+        if (strcmp(name, "spike_rejection") == 0) return setSpikeRejection(v);
+        if (strcmp(name, "minimum_strikes") == 0) return setMinimumStrikes(v);
+        if (strcmp(name, "indoor_mode") == 0) return setIndoorMode(v != 0);
+        if (strcmp(name, "mask_disturbers") == 0) return maskDisturbers(v != 0);
+        if (strcmp(name, "tuning_capacitor") == 0) {
+            if (v > 15) {
+                return false;
+            }
+            if (state_ == State::READY && !modifyRegister(AS3935Register::TUN_CAP, AS3935Bits::TUN_CAP_MASK, v)) {
+                return false;
+            }
+            config_.tuningCapacitor = v;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool LightningSensor::getParameter(const char* name, void* value, size_t& size) const {
+        if (!name || !value || size < sizeof(uint8_t)) {
+            return false;
+        }
+
+        uint8_t v;
+        if (strcmp(name, "noise_floor") == 0) v = config_.noiseFloor;
+        else if (strcmp(name, "watchdog_threshold") == 0) v = config_.watchdogThreshold;
+        else if (strcmp(name, "spike_rejection") == 0) v = config_.spikeRejection;
+        else if (strcmp(name, "minimum_strikes") == 0) v = config_.minimumStrikes;
+        else if (strcmp(name, "indoor_mode") == 0) v = config_.indoorMode ? 1 : 0;
+        else if (strcmp(name, "tuning_capacitor") == 0) v = config_.tuningCapacitor;
+        else return false;
+
+        *static_cast<uint8_t*>(value) = v;
+        size = sizeof(uint8_t);
+        return true;
+    }
+
+    // ---------------------------------------------------------------------
+    // Calibration, self-test and power
+    // ---------------------------------------------------------------------
+
+    bool LightningSensor::calibrate() {
+        return tuneTankCircuit() && calibrateRCO();
+    }
+
+    bool LightningSensor::tuneTankCircuit() {
+        const uint32_t start = Timer::millis();
+
+        // LCO shares the IRQ pin; strike interrupts are off while it is displayed
+        const bool irqAttached = (instance_ == this);
+        if (irqAttached) {
+            GPIO::detachInterrupt(bus_.irqPin);
+        }
+
+        memset(&tuning_, 0, sizeof(tuning_));
+
+        uint32_t frequencies[16] = {};
+        bool ok = modifyRegister(AS3935Register::LCO_FDIV, AS3935Bits::LCO_FDIV_MASK, 0) &&
+                  modifyRegister(AS3935Register::DISP_LCO, AS3935Bits::DISP_LCO, AS3935Bits::DISP_LCO);
+
+        // Frequency falls as TUN_CAP rises: find the first value at or below target
+        uint8_t lo = 0;
+        uint8_t hi = 15;
+        while (ok && lo < hi) {
+            const uint8_t mid = (lo + hi) / 2;
+            ok = measureLcoFrequency(mid, frequencies[mid]);
+            if (frequencies[mid] > LCO_TARGET_HZ) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        // Best is either that value or its neighbour just above target
+        uint8_t best = lo;
+        if (ok && frequencies[lo] == 0) {
+            ok = measureLcoFrequency(lo, frequencies[lo]);
+        }
+        if (ok && lo > 0) {
+            if (frequencies[lo - 1] == 0) {
+                ok = measureLcoFrequency(lo - 1, frequencies[lo - 1]);
+            }
+            const int32_t errorLo = static_cast<int32_t>(frequencies[lo]) - static_cast<int32_t>(LCO_TARGET_HZ);
+            const int32_t errorPrev = static_cast<int32_t>(frequencies[lo - 1]) - static_cast<int32_t>(LCO_TARGET_HZ);
+            if (abs(errorPrev) < abs(errorLo)) {
+                best = lo - 1;
+            }
+        }
+
+        modifyRegister(AS3935Register::DISP_LCO, AS3935Bits::DISP_LCO, 0);
+
+        if (irqAttached) {
+            GPIO::attachInterrupt(bus_.irqPin, interruptHandler, RISING);
+        }
+
+        tuning_.tuningCapacitor = best;
+        tuning_.frequencyHz = frequencies[best];
+        tuning_.errorPercent = (static_cast<float>(frequencies[best]) - LCO_TARGET_HZ) * 100.0f / LCO_TARGET_HZ;
+        tuning_.withinTolerance = ok && fabsf(tuning_.errorPercent) <= LCO_TOLERANCE_PERCENT;
+        tuning_.durationMs = Timer::millis() - start;
+
+        // Out of range usually means a wrong antenna or no LCO on IRQ: keep the old value
+        if (!tuning_.withinTolerance ||
+            !modifyRegister(AS3935Register::TUN_CAP, AS3935Bits::TUN_CAP_MASK, best)) {
+            modifyRegister(AS3935Register::TUN_CAP, AS3935Bits::TUN_CAP_MASK, config_.tuningCapacitor);
+            reportError(LightningErrorCodes::TANK_TUNING_FAILED);
+            return false;
+        }
+
+        config_.tuningCapacitor = best;
+        stats_.calibrationCount++;
+        saveTuning();
+        return true;
+    }
+
+    bool LightningSensor::measureLcoFrequency(uint8_t tuningCap, uint32_t& frequencyHz) {
+        if (!modifyRegister(AS3935Register::TUN_CAP, AS3935Bits::TUN_CAP_MASK, tuningCap)) {
+            return false;
+        }
+        Timer::delay(TUNING_SETTLE_MS);
+
+        uint32_t edges = 0;
+        uint32_t gateUs = 0;
+        if (PulseCounter::countEdges(bus_.irqPin, TUNING_GATE_MS, edges, gateUs) != Result::SUCCESS || gateUs == 0) {
+            return false;
+        }
+
+        tuning_.measurements++;
+        frequencyHz = static_cast<uint32_t>(static_cast<uint64_t>(edges) * LCO_DIVIDER * 1000000ULL / gateUs);
+        return true;
+    }
+
+    bool LightningSensor::loadTuning() {
+        uint8_t value = 0;
+        size_t length = sizeof(value);
+        const bool found = Memory::nvs_open("as3935") == Result::SUCCESS &&
+                           Memory::nvs_get("tun_cap", &value, length) == Result::SUCCESS &&
+                           length == sizeof(value) && value <= 15;
+        Memory::nvs_close();
+
+        if (found) {
+            config_.tuningCapacitor = value;
+        }
+        return found;
+    }
+
+    bool LightningSensor::saveTuning() {
+        const uint8_t value = config_.tuningCapacitor;
+        const bool ok = Memory::nvs_open("as3935") == Result::SUCCESS &&
+                        Memory::nvs_set("tun_cap", &value, sizeof(value)) == Result::SUCCESS &&
+                        Memory::nvs_commit() == Result::SUCCESS;
+        Memory::nvs_close();
+        return ok;
+    }
+
+    bool LightningSensor::calibrateRCO() {
+        // CALIB_RCO, then expose SRCO on IRQ for 2 ms as the datasheet requires
+        if (!writeRegister(AS3935Register::CALIB_RCO, AS3935Bits::DIRECT_COMMAND) ||
+            !modifyRegister(AS3935Register::DISP_SRCO, AS3935Bits::DISP_SRCO, AS3935Bits::DISP_SRCO)) {
+            reportError(LightningErrorCodes::RCO_CALIBRATION_FAILED);
+            return false;
+        }
+
+        Timer::delay(2);
+
+        uint8_t trco = 0;
+        uint8_t srco = 0;
+        if (!modifyRegister(AS3935Register::DISP_SRCO, AS3935Bits::DISP_SRCO, 0) ||
+            !readRegister(AS3935Register::TRCO_CALIB, trco) ||
+            !readRegister(AS3935Register::SRCO_CALIB, srco) ||
+            !(trco & AS3935Bits::CALIB_DONE) || (trco & AS3935Bits::CALIB_NOK) ||
+            !(srco & AS3935Bits::CALIB_DONE) || (srco & AS3935Bits::CALIB_NOK)) {
+            reportError(LightningErrorCodes::RCO_CALIBRATION_FAILED);
+            return false;
+        }
+
+        stats_.calibrationCount++;
+        return true;
+    }
+
+    bool LightningSensor::selfTest() {
+        // Write/read-back of the watchdog field, then restore it
+        uint8_t original = 0;
+        if (!readRegister(AS3935Register::WDTH, original)) {
+            return false;
+        }
+
+        const uint8_t pattern = (~original) & AS3935Bits::WDTH_MASK;
+        uint8_t readBack = 0;
+        const bool ok = modifyRegister(AS3935Register::WDTH, AS3935Bits::WDTH_MASK, pattern) &&
+                        readRegister(AS3935Register::WDTH, readBack) &&
+                        (readBack & AS3935Bits::WDTH_MASK) == pattern;
+
+        writeRegister(AS3935Register::WDTH, original);
+        if (!ok) {
+            reportError(LightningErrorCodes::COMMUNICATION_FAILED, "self test");
+        }
+        return ok;
+    }
+
+    bool LightningSensor::sleep() {
+        if (state_ != State::READY) {
+            return false;
+        }
+        if (!powerDown()) {
+            return false;
+        }
+        setState(State::DISABLED);
+        return true;
+    }
+
+    bool LightningSensor::wakeup() {
+        if (state_ != State::DISABLED) {
+            return state_ == State::READY;
+        }
+        // RCO must be recalibrated after leaving power-down
+        if (!powerUp() || !calibrateRCO()) {
+            return false;
+        }
+        setState(State::READY);
+        return true;
+    }
+
+    bool LightningSensor::reset() {
+        if (!writeRegister(AS3935Register::PRESET_DEFAULT, AS3935Bits::DIRECT_COMMAND)) {
+            return false;
+        }
+        Timer::delay(RESET_DELAY_MS);
+        return applyConfig() && calibrateRCO() && clearStatistics();
+    }
+
+    bool LightningSensor::powerUp() {
+        return modifyRegister(AS3935Register::PWD, AS3935Bits::PWD, 0);
+    }
+
+    bool LightningSensor::powerDown() {
+        return modifyRegister(AS3935Register::PWD, AS3935Bits::PWD, AS3935Bits::PWD);
+    }
+
+    bool LightningSensor::clearStatistics() {
+        // CL_STAT high-low-high clears the on-chip lightning statistics
+        return modifyRegister(AS3935Register::CL_STAT, AS3935Bits::CL_STAT, AS3935Bits::CL_STAT) &&
+               modifyRegister(AS3935Register::CL_STAT, AS3935Bits::CL_STAT, 0) &&
+               modifyRegister(AS3935Register::CL_STAT, AS3935Bits::CL_STAT, AS3935Bits::CL_STAT);
+    }
+
+    InterruptReason LightningSensor::getInterruptReason() {
+        uint8_t value = 0;
+        readRegister(AS3935Register::INT, value);
+        return static_cast<InterruptReason>(value & AS3935Bits::INT_MASK);
+    }
+
+    uint8_t LightningSensor::getLightningDistance() {
+        uint8_t value = 0;
+        readRegister(AS3935Register::DISTANCE, value);
+        return value & AS3935Bits::DISTANCE_MASK;
+    }
+
+    uint32_t LightningSensor::getLightningEnergy() {
+        uint8_t raw[3] = {};
+        readRegisters(static_cast<uint8_t>(AS3935Register::S_LIG_L), raw, sizeof(raw));
+        return static_cast<uint32_t>(raw[0]) |
+               (static_cast<uint32_t>(raw[1]) << 8) |
+               (static_cast<uint32_t>(raw[2] & AS3935Bits::ENERGY_MMSB_MASK) << 16);
+    }
+
+    // ---------------------------------------------------------------------
+    // Bus access
+    // ---------------------------------------------------------------------
+
+    bool LightningSensor::beginBus() {
+        if (bus_.interface == AS3935Interface::SPI) {
+            return GPIO::pinMode(bus_.csPin, GPIO::Mode::MODE_OUTPUT) == Result::SUCCESS &&
+                   GPIO::digitalWrite(bus_.csPin, GPIO::Level::LEVEL_HIGH) == Result::SUCCESS &&
+                   SPI::initialize() == Result::SUCCESS;
+        }
+        return I2C::initialize(bus_.sdaPin, bus_.sclPin, bus_.i2cFrequency) == Result::SUCCESS;
+    }
+
+    bool LightningSensor::writeRegister(AS3935Register reg, uint8_t value) {
+        const uint8_t address = static_cast<uint8_t>(reg);
+
+        if (bus_.interface == AS3935Interface::SPI) {
+            const SPI::Settings settings = {bus_.spiFrequency, MSBFIRST, SPI_MODE1};
+            if (SPI::beginTransaction(settings) != Result::SUCCESS) {
+                return false;
+            }
+            GPIO::digitalWrite(bus_.csPin, GPIO::Level::LEVEL_LOW);
+            SPI::transfer(static_cast<uint8_t>(address & 0x3F));   // Mode bits 00 = write
+            SPI::transfer(value);
+            GPIO::digitalWrite(bus_.csPin, GPIO::Level::LEVEL_HIGH);
+            return SPI::endTransaction() == Result::SUCCESS;
+        }
+
+        const uint8_t data[2] = {address, value};
+        return I2C::beginTransmission(bus_.i2cAddress) == Result::SUCCESS &&
+               I2C::write(data, sizeof(data)) == Result::SUCCESS &&
+               I2C::endTransmission() == Result::SUCCESS;
+    }
+
+    bool LightningSensor::readRegister(AS3935Register reg, uint8_t& value) {
+        return readRegisters(static_cast<uint8_t>(reg), &value, 1);
+    }
+
+    bool LightningSensor::readRegisters(uint8_t startReg, uint8_t* data, size_t length) {
+        if (bus_.interface == AS3935Interface::SPI) {
+            const SPI::Settings settings = {bus_.spiFrequency, MSBFIRST, SPI_MODE1};
+            if (SPI::beginTransaction(settings) != Result::SUCCESS) {
+                return false;
+            }
+            GPIO::digitalWrite(bus_.csPin, GPIO::Level::LEVEL_LOW);
+            SPI::transfer(static_cast<uint8_t>(0x40 | (startReg & 0x3F)));   // Mode bits 01 = read
+            memset(data, 0, length);
+            SPI::transfer(data, length);
+            GPIO::digitalWrite(bus_.csPin, GPIO::Level::LEVEL_HIGH);
+            return SPI::endTransaction() == Result::SUCCESS;
+        }
+
+        // Register pointer with repeated start, then auto-incrementing burst
+        if (I2C::beginTransmission(bus_.i2cAddress) != Result::SUCCESS ||
+            I2C::write(startReg) != Result::SUCCESS ||
+            I2C::endTransmission(false) != Result::SUCCESS ||
+            I2C::requestFrom(bus_.i2cAddress, length) != Result::SUCCESS) {
+            return false;
+        }
+
+        for (size_t i = 0; i < length; i++) {
+            const int b = I2C::read();
+            if (b < 0) {
+                return false;
+            }
+            data[i] = static_cast<uint8_t>(b);
+        }
+        return true;
+    }
+
+    bool LightningSensor::modifyRegister(AS3935Register reg, uint8_t mask, uint8_t value) {
+        uint8_t current = 0;
+        if (!readRegister(reg, current)) {
+            stats_.communicationErrors++;
+            return false;
+        }
+
+        const uint8_t updated = (current & ~mask) | (value & mask);
+        if (updated == current) {
+            return true;
+        }
+
+        if (!writeRegister(reg, updated)) {
+            stats_.communicationErrors++;
+            return false;
+        }
+        return true;
+    }
+
+    // ---------------------------------------------------------------------
+    // Validation, state and errors
+    // ---------------------------------------------------------------------
+
+    bool LightningSensor::validateConfig() const {
+        return isConfigurationValid(config_);
+    }
+
+    bool LightningSensor::isConfigurationValid(const Config& config) const {
+        const bool strikesValid = config.minimumStrikes == 1 || config.minimumStrikes == 5 ||
+                                  config.minimumStrikes == 9 || config.minimumStrikes == 16;
+        return config.noiseFloor <= 7 && config.watchdogThreshold <= 15 &&
+               config.spikeRejection <= 15 && config.tuningCapacitor <= 15 && strikesValid;
+    }
+
+    void LightningSensor::setState(State newState) {
+        if (state_ == newState) {
+            return;
+        }
+        state_ = newState;
+        if (stateChangeCallback_) {
+            stateChangeCallback_(getId(), newState);
+        }
+    }
+
+    void LightningSensor::reportError(uint32_t errorCode, const char* message) {
+        (void)message;
+        lastError_ = errorCode;
+        if (errorCallback_) {
+            errorCallback_(getId(), errorCode);
+        }
+    }
+
+    void LightningSensor::logStormEvent(StormEvent event) {
+        if (!eventLog_ || event == StormEvent::NONE) {
+            return;
+        }
+        eventLog_->append(event == StormEvent::STARTED ? Logging::EventType::STORM_STARTED
+                                                       : Logging::EventType::STORM_ENDED);
+    }
+
+    const char* LightningSensor::getErrorString(uint32_t errorCode) const {
+        switch (errorCode) {
+            case 0: return "No error";
+            case LightningErrorCodes::CHIP_NOT_FOUND: return "AS3935 not found";
+            case LightningErrorCodes::COMMUNICATION_FAILED: return "Communication failed";
+            case LightningErrorCodes::CALIBRATION_FAILED: return "Calibration failed";
+            case LightningErrorCodes::INVALID_CONFIGURATION: return "Invalid configuration";
+            case LightningErrorCodes::INTERRUPT_SETUP_FAILED: return "Interrupt setup failed";
+            case LightningErrorCodes::TANK_TUNING_FAILED: return "Tank circuit tuning failed";
+            case LightningErrorCodes::RCO_CALIBRATION_FAILED: return "RCO calibration failed";
+            case LightningErrorCodes::EVENT_QUEUE_OVERFLOW: return "Event queue overflow";
+            default: return "Unknown error";
+        }
+    }
+}
@@ -2,10 +2,25 @@
 
 #include "sensor_interface.h"
 #include "../config/system_config.h"
+#include "../hardware/hardware_abstraction.h"
+#include "lightning_autotune.h"
+#include "storm_tracker.h"
+#include <Arduino.h>
+
+namespace Logging {
+    class EventLog;
+}
 
 // AS3935 Lightning Sensor Implementation
 namespace Sensors {
 
+    using SensorSystem::ISensor;
+    using SensorSystem::State;
+    using SensorSystem::Reading;
+    using SensorSystem::ReadingCallback;
+    using SensorSystem::ErrorCallback;
+    using SensorSystem::StateChangeCallback;
+
     // Lightning sensor specific data
     struct LightningData {
         bool lightningDetected;
@@ -28,10 +43,91 @@ namespace Sensors {
         SREJ = 0x02,
         LCO_FDIV = 0x03,
         MASK_DIST = 0x03,
+        INT = 0x03,
+        S_LIG_L = 0x04,             // Energy LSB
+        S_LIG_M = 0x05,             // Energy MSB
+        S_LIG_MM = 0x06,            // Energy MMSB [4:0]
+        DISTANCE = 0x07,            // Distance estimate [5:0]
         DISP_LCO = 0x08,
         DISP_SRCO = 0x08,
         DISP_TRCO = 0x08,
-        TUN_CAP = 0x08
+        TUN_CAP = 0x08,
+        TRCO_CALIB = 0x3A,          // [7] done, [6] failed
+        SRCO_CALIB = 0x3B,          // [7] done, [6] failed
+        PRESET_DEFAULT = 0x3C,      // Direct command: write DIRECT_COMMAND
+        CALIB_RCO = 0x3D            // Direct command: write DIRECT_COMMAND
+    };
+
+    // Register bit fields
+    namespace AS3935Bits {
+        constexpr uint8_t PWD = 0x01;
+        constexpr uint8_t AFE_GB_MASK = 0x3E;
+        constexpr uint8_t AFE_GB_INDOOR = 0x12 << 1;
+        constexpr uint8_t AFE_GB_OUTDOOR = 0x0E << 1;
+        constexpr uint8_t NF_LEV_MASK = 0x70;
+        constexpr uint8_t WDTH_MASK = 0x0F;
+        constexpr uint8_t CL_STAT = 0x40;
+        constexpr uint8_t MIN_NUM_LIGH_MASK = 0x30;
+        constexpr uint8_t SREJ_MASK = 0x0F;
+        constexpr uint8_t LCO_FDIV_MASK = 0xC0;
+        constexpr uint8_t MASK_DIST = 0x20;
+        constexpr uint8_t INT_MASK = 0x0F;
+        constexpr uint8_t ENERGY_MMSB_MASK = 0x1F;
+        constexpr uint8_t DISTANCE_MASK = 0x3F;
+        constexpr uint8_t DISP_LCO = 0x80;
+        constexpr uint8_t DISP_SRCO = 0x40;
+        constexpr uint8_t DISP_TRCO = 0x20;
+        constexpr uint8_t TUN_CAP_MASK = 0x0F;
+        constexpr uint8_t CALIB_DONE = 0x80;
+        constexpr uint8_t CALIB_NOK = 0x40;
+        constexpr uint8_t DIRECT_COMMAND = 0x96;
+        constexpr uint8_t DEFAULT_NF_WDTH = 0x22;   // Register 0x01 after PRESET_DEFAULT
+    }
+
+    // Bus the AS3935 is wired to
+    enum class AS3935Interface : uint8_t {
+        SPI,
+        I2C
+    };
+
+    struct AS3935BusConfig {
+        AS3935Interface interface;
+        uint8_t csPin;              // SPI chip select
+        uint32_t spiFrequency;      // Max 2 MHz, avoid 500 kHz (antenna band)
+        uint8_t i2cAddress;         // 0x01-0x03 via ADD0/ADD1
+        uint8_t sdaPin;
+        uint8_t sclPin;
+        uint32_t i2cFrequency;
+        uint8_t irqPin;
+    };
+
+    // Per-event timing (microseconds)
+    struct TimingStats {
+        uint32_t count;
+        uint32_t lastUs;
+        uint32_t minUs;
+        uint32_t maxUs;
+        uint64_t totalUs;
+
+        void add(uint32_t us);
+        uint32_t meanUs() const { return count ? static_cast<uint32_t>(totalUs / count) : 0; }
+    };
+
+    // Event registers fetched in one burst (0x03..0x07)
+    struct AS3935EventRegisters {
+        uint8_t interrupt;          // INT [3:0]
+        uint32_t energy;            // 21-bit S_LIG
+        uint8_t distance;           // km, 63 = out of range
+    };
+
+    // Outcome of the last antenna tuning run
+    struct TankTuningResult {
+        uint8_t tuningCapacitor;    // Selected TUN_CAP (0-15, 8 pF steps)
+        uint32_t frequencyHz;       // Measured LCO at the selected TUN_CAP
+        float errorPercent;         // Deviation from 500 kHz
+        uint8_t measurements;       // Gate measurements taken
+        uint32_t durationMs;
+        bool withinTolerance;       // |error| <= 3.5%
     };
 
     // Interrupt reasons
@@ -44,7 +140,8 @@ namespace Sensors {
     class LightningSensor : public ISensor {
     public:
         LightningSensor();
-        virtual ~LightningSensor() = default;
+        explicit LightningSensor(const AS3935BusConfig& bus);
+        virtual ~LightningSensor();
 
         // ISensor interface implementation
         bool initialize() override;
@@ -83,9 +180,22 @@ namespace Sensors {
         bool setIndoorMode(bool indoor);
         bool maskDisturbers(bool mask);
 
+        // Closed-loop NF_LEV/WDTH/SREJ adjustment from live NOISE and disturber rates
+        void setAutoTuneEnabled(bool enabled);
+        bool isAutoTuneEnabled() const { return autoTuneEnabled_; }
+        void configureAutoTune(const NoiseAutoTuneConfig& config);
+        const NoiseAutoTuner& getAutoTuner() const { return autoTune_; }
+
+        // Feed lightning (not disturber) events into a storm tracker; nullptr detaches
+        void setStormTracker(StormTracker* tracker) { stormTracker_ = tracker; }
+
+        // Record strikes, reported disturbers and storm start/end in a flash event log; nullptr detaches
+        void setEventLog(Logging::EventLog* log) { eventLog_ = log; }
+
         // Calibration
-        bool tuneTankCircuit();
+        bool tuneTankCircuit();     // Measure LCO on IRQ via the pulse counter, persist TUN_CAP
         bool calibrateRCO();
+        const TankTuningResult& getTankTuning() const { return tuning_; }
 
         // Status queries
         uint8_t getNoiseFloor() const { return config_.noiseFloor; }
@@ -104,9 +214,15 @@ namespace Sensors {
         // Lightning data access
         bool getLastLightningData(LightningData& data) const;
 
-        // Interrupt handling (called from ISR)
+        // Event timing: bus time of the burst read, and IRQ edge to decoded reading
+        const TimingStats& getBusTimeStats() const { return busTime_; }
+        const TimingStats& getLatencyStats() const { return latency_; }
+        uint32_t getDroppedEvents() const { return droppedEvents_; }
+        uint32_t getCommunicationErrors() const { return stats_.communicationErrors; }
+
+        // Interrupt handling (called from ISR): timestamp and enqueue only
         static void IRAM_ATTR interruptHandler();
-        void handleInterrupt();
+        void IRAM_ATTR handleInterrupt();
 
     private:
         // Configuration structure
@@ -144,14 +260,30 @@ namespace Sensors {
         ErrorCallback errorCallback_;
         StateChangeCallback stateChangeCallback_;
 
-        // Interrupt handling
+        AS3935BusConfig bus_;
+        TankTuningResult tuning_;
+        NoiseAutoTuner autoTune_;
+        bool autoTuneEnabled_;
+        StormTracker* stormTracker_;
+        Logging::EventLog* eventLog_;
+        TimingStats busTime_;
+        TimingStats latency_;
+
+        // Interrupt handling: single-producer (ISR) / single-consumer (update) ring of IRQ timestamps
+        static constexpr uint8_t EVENT_QUEUE_SIZE = 16;     // Power of two
+        volatile uint32_t eventTimes_[EVENT_QUEUE_SIZE];
+        volatile uint8_t eventHead_;
+        volatile uint8_t eventTail_;
+        volatile uint32_t droppedEvents_;
         volatile bool interruptPending_;
         static LightningSensor* instance_;
 
         // Hardware interface
         bool writeRegister(AS3935Register reg, uint8_t value);
         bool readRegister(AS3935Register reg, uint8_t& value);
+        bool readRegisters(uint8_t startReg, uint8_t* data, size_t length);
         bool modifyRegister(AS3935Register reg, uint8_t mask, uint8_t value);
+        bool beginBus();
 
         // Internal operations
         bool powerUp();
@@ -160,6 +292,13 @@ namespace Sensors {
         InterruptReason getInterruptReason();
         uint8_t getLightningDistance();
         uint32_t getLightningEnergy();
+        bool readEventRegisters(AS3935EventRegisters& regs);
+        void processEvent(uint32_t irqMicros);
+        bool applyConfig();
+        void applyNoiseSettings(const NoiseSettings& settings);
+        bool measureLcoFrequency(uint8_t tuningCap, uint32_t& frequencyHz);
+        bool loadTuning();
+        bool saveTuning();
 
         // Validation
         bool validateConfig() const;
@@ -168,14 +307,27 @@ namespace Sensors {
         // State management
         void setState(State newState);
         void reportError(uint32_t errorCode, const char* message = nullptr);
+        void logStormEvent(StormEvent event);
 
         // Constants
         static constexpr uint8_t CHIP_ID = 0x3C;
         static constexpr uint32_t RESET_DELAY_MS = 2;
         static constexpr uint32_t CALIBRATION_TIMEOUT_MS = 2000;
         static constexpr uint32_t INTERRUPT_TIMEOUT_MS = 100;
+        static constexpr uint32_t INT_SETTLE_US = 2000;          // INT register valid 2 ms after IRQ
+        static constexpr uint32_t STRIKE_SERIES_WINDOW_MS = 900000;
+
+        // Antenna tuning: LCO/16 on IRQ counted over a fixed gate
+        static constexpr uint32_t LCO_TARGET_HZ = 500000;
+        static constexpr float LCO_TOLERANCE_PERCENT = 3.5f;
+        static constexpr uint32_t LCO_DIVIDER = 16;
+        static constexpr uint32_t TUNING_GATE_MS = 50;          // ~1560 edges at 500 kHz / 16
+        static constexpr uint32_t TUNING_SETTLE_MS = 2;
     };
 
+    // Default wiring from SystemConfig (SPI, CS and IRQ pins)
+    AS3935BusConfig getDefaultAS3935BusConfig();
+
     // Error codes specific to lightning sensor
     namespace LightningErrorCodes {
         constexpr uint32_t CHIP_NOT_FOUND = 1001;
@@ -185,5 +337,6 @@ namespace Sensors {
         constexpr uint32_t INTERRUPT_SETUP_FAILED = 1005;
         constexpr uint32_t TANK_TUNING_FAILED = 1006;
         constexpr uint32_t RCO_CALIBRATION_FAILED = 1007;
+        constexpr uint32_t EVENT_QUEUE_OVERFLOW = 1008;
     }
 }
@@ -0,0 +1,193 @@
+#include "position_filter.h"
+#include <cmath>
+#include <cstring>
+
+namespace GPS {
+
+    // Meters per degree of latitude on the mean-radius sphere
+    static constexpr double METERS_PER_DEG = 6371000.0 * M_PI / 180.0;
+
+    // Recenter the local frame once the state drifts this far from the origin
+    static constexpr float RECENTER_DISTANCE_M = 5000.0f;
+
+    // Used when the receiver reports no DOP
+    static constexpr float DEFAULT_DOP = 2.0f;
+
+    // Initial velocity uncertainty (m/s)^2 when seeding
+    static constexpr float SEED_VELOCITY_VAR = 100.0f;
+
+    PositionFilterConfig getDefaultPositionFilterConfig() {
+        PositionFilterConfig config = {};
+        config.uere_m = 5.0f;
+        config.accel_noise_mps2 = 0.5f;
+        config.gate_nis = 13.8f;              // chi-square, 2 dof, 99.9%
+        config.max_consecutive_rejects = 5;
+        config.max_gap_ms = 60000;
+        return config;
+    }
+
+    void PositionFilter::Axis::seed(float z, float r, float vel_var) {
+        pos = z;
+        vel = 0.0f;
+        p00 = r;
+        p01 = 0.0f;
+        p11 = vel_var;
+    }
+
+    void PositionFilter::Axis::predict(float dt, float accel_var) {
+        // x = F x, P = F P F' + Q with F = [1 dt; 0 1], Q = white acceleration
+        pos += vel * dt;
+
+        const float dt2 = dt * dt;
+        p00 += dt * (2.0f * p01 + dt * p11) + accel_var * dt2 * dt2 * 0.25f;
+        p01 += dt * p11 + accel_var * dt2 * dt * 0.5f;
+        p11 += accel_var * dt2;
+    }
+
+    void PositionFilter::Axis::correct(float z, float r) {
+        const float s = p00 + r;
+        const float k0 = p00 / s;
+        const float k1 = p01 / s;
+        const float y = z - pos;
+
+        pos += k0 * y;
+        vel += k1 * y;
+
+        // P = (I - K H) P
+        p11 -= k1 * p01;
+        p01 -= k1 * p00;
+        p00 -= k0 * p00;
+    }
+
+    PositionFilter::PositionFilter() {
+        configure(getDefaultPositionFilterConfig());
+    }
+
+    PositionFilter::PositionFilter(const PositionFilterConfig& config) {
+        configure(config);
+    }
+
+    void PositionFilter::configure(const PositionFilterConfig& config) {
+        m_config = config;
+        reset();
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    void PositionFilter::reset() {
+        m_initialized = false;
+        m_consecutive_rejects = 0;
+        m_last_time_ms = 0;
+        m_ref_lat = 0.0;
+        m_ref_lon = 0.0;
+        m_ref_cos_lat = 1.0;
+        memset(&m_north, 0, sizeof(m_north));
+        memset(&m_east, 0, sizeof(m_east));
+        memset(&m_up, 0, sizeof(m_up));
+    }
+
+    void PositionFilter::seed(double lat, double lon, float alt, float r_h, float r_v, uint32_t time_ms) {
+        m_ref_lat = lat;
+        m_ref_lon = lon;
+        m_ref_cos_lat = cos(lat * M_PI / 180.0);
+
+        m_north.seed(0.0f, r_h, SEED_VELOCITY_VAR);
+        m_east.seed(0.0f, r_h, SEED_VELOCITY_VAR);
+        m_up.seed(alt, r_v, SEED_VELOCITY_VAR);
+
+        m_initialized = true;
+        m_consecutive_rejects = 0;
+        m_last_time_ms = time_ms;
+        m_stats.resets++;
+    }
+
+    void PositionFilter::recenter() {
+        const PositionEstimate estimate = getEstimate();
+        m_ref_lat = estimate.latitude;
+        m_ref_lon = estimate.longitude;
+        m_ref_cos_lat = cos(m_ref_lat * M_PI / 180.0);
+        m_north.pos = 0.0f;
+        m_east.pos = 0.0f;
+    }
+
+    PositionFilter::UpdateResult PositionFilter::update(double lat, double lon, float alt, bool alt_valid,
+                                                        float hdop, float vdop, uint32_t time_ms) {
+        // HDOP * UERE is the horizontal RMS error; split evenly over north and east
+        const float sigma_h = ((hdop > 0.0f) ? hdop : DEFAULT_DOP) * m_config.uere_m;
+        const float r_h = 0.5f * sigma_h * sigma_h;
+        const float sigma_v = ((vdop > 0.0f) ? vdop : 1.5f * ((hdop > 0.0f) ? hdop : DEFAULT_DOP)) * m_config.uere_m;
+        const float r_v = sigma_v * sigma_v;
+
+        if (!m_initialized || (time_ms - m_last_time_ms) > m_config.max_gap_ms) {
+            seed(lat, lon, alt_valid ? alt : m_up.pos, r_h, r_v, time_ms);
+            return UpdateResult::INITIALIZED;
+        }
+
+        const float dt = (time_ms - m_last_time_ms) * 0.001f;
+        m_last_time_ms = time_ms;
+
+        const float accel_var = m_config.accel_noise_mps2 * m_config.accel_noise_mps2;
+        m_north.predict(dt, accel_var);
+        m_east.predict(dt, accel_var);
+        m_up.predict(dt, accel_var);
+
+        double dlon = lon - m_ref_lon;
+        if (dlon > 180.0) {
+            dlon -= 360.0;
+        } else if (dlon < -180.0) {
+            dlon += 360.0;
+        }
+        const float z_north = static_cast<float>((lat - m_ref_lat) * METERS_PER_DEG);
+        const float z_east = static_cast<float>(dlon * METERS_PER_DEG * m_ref_cos_lat);
+
+        // Horizontal innovation gate (normalized innovation squared)
+        const float y_north = z_north - m_north.pos;
+        const float y_east = z_east - m_east.pos;
+        const float nis = y_north * y_north / m_north.innovationVariance(r_h) +
+                          y_east * y_east / m_east.innovationVariance(r_h);
+
+        if (nis > m_config.gate_nis) {
+            m_stats.rejected++;
+            if (++m_consecutive_rejects >= m_config.max_consecutive_rejects) {
+                // Persistent disagreement: the receiver is right and we are lost
+                seed(lat, lon, alt_valid ? alt : m_up.pos, r_h, r_v, time_ms);
+                return UpdateResult::INITIALIZED;
+            }
+            return UpdateResult::REJECTED;
+        }
+
+        m_consecutive_rejects = 0;
+        m_north.correct(z_north, r_h);
+        m_east.correct(z_east, r_h);
+        if (alt_valid) {
+            m_up.correct(alt, r_v);
+        }
+        m_stats.accepted++;
+
+        if (fabsf(m_north.pos) > RECENTER_DISTANCE_M || fabsf(m_east.pos) > RECENTER_DISTANCE_M) {
+            recenter();
+        }
+
+        return UpdateResult::ACCEPTED;
+    }
+
+    PositionEstimate PositionFilter::getEstimate() const {
+        PositionEstimate estimate = {};
+        if (!m_initialized) {
+            return estimate;
+        }
+
+        estimate.latitude = m_ref_lat + m_north.pos / METERS_PER_DEG;
+        estimate.longitude = m_ref_lon + m_east.pos / (METERS_PER_DEG * m_ref_cos_lat);
+        if (estimate.longitude > 180.0) {
+            estimate.longitude -= 360.0;
+        } else if (estimate.longitude < -180.0) {
+            estimate.longitude += 360.0;
+        }
+        estimate.altitude = m_up.pos;
+        estimate.velocity_north_mps = m_north.vel;
+        estimate.velocity_east_mps = m_east.vel;
+        estimate.velocity_up_mps = m_up.vel;
+        estimate.horizontal_sigma_m = sqrtf(m_north.p00 + m_east.p00);
+        return estimate;
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace GPS {
+
+    // Position filter tuning
+    struct PositionFilterConfig {
+        float uere_m;                      // User equivalent range error; sigma = HDOP * UERE
+        float accel_noise_mps2;            // Process noise: white acceleration (1-sigma)
+        float gate_nis;                    // Reject fixes whose normalized innovation exceeds this
+        uint8_t max_consecutive_rejects;   // Re-seed from the measurement after this many rejects
+        uint32_t max_gap_ms;               // Re-seed when fixes are further apart than this
+    };
+
+    // Filtered state in geodetic coordinates
+    struct PositionEstimate {
+        double latitude;                   // Degrees
+        double longitude;                  // Degrees
+        float altitude;                    // Meters above sea level
+        float velocity_north_mps;
+        float velocity_east_mps;
+        float velocity_up_mps;
+        float horizontal_sigma_m;          // 1-sigma horizontal position uncertainty
+    };
+
+    // Filter counters
+    struct PositionFilterStats {
+        uint32_t accepted;                 // Fixes fused into the state
+        uint32_t rejected;                 // Fixes dropped by the innovation gate
+        uint32_t resets;                   // Re-seeds (first fix, gaps, persistent rejects)
+    };
+
+    // Constant-velocity Kalman filter over lat/lon/alt.
+    // Each axis is an independent [position, velocity] state in a local
+    // north/east/up frame (meters), so an update is O(1) with 2x2 covariances.
+    class PositionFilter {
+    public:
+        enum class UpdateResult {
+            INITIALIZED,    // State seeded from this fix
+            ACCEPTED,       // Fix fused
+            REJECTED        // Fix failed the innovation gate, state is the prediction
+        };
+
+        PositionFilter();
+        explicit PositionFilter(const PositionFilterConfig& config);
+
+        void configure(const PositionFilterConfig& config);
+        void reset();
+
+        // alt_valid = false skips the vertical update (vertical state is only predicted)
+        UpdateResult update(double lat, double lon, float alt, bool alt_valid,
+                            float hdop, float vdop, uint32_t time_ms);
+
+        bool isInitialized() const { return m_initialized; }
+        PositionEstimate getEstimate() const;
+        const PositionFilterStats& getStats() const { return m_stats; }
+        const PositionFilterConfig& getConfig() const { return m_config; }
+
+    private:
+        // One [position, velocity] axis with symmetric 2x2 covariance
+        struct Axis {
+            float pos;
+            float vel;
+            float p00;
+            float p01;
+            float p11;
+
+            void seed(float z, float r, float vel_var);
+            void predict(float dt, float accel_var);
+            float innovationVariance(float r) const { return p00 + r; }
+            void correct(float z, float r);
+        };
+
+        PositionFilterConfig m_config;
+        PositionFilterStats m_stats;
+        bool m_initialized;
+        uint8_t m_consecutive_rejects;
+        uint32_t m_last_time_ms;
+
+        // Local frame origin
+        double m_ref_lat;
+        double m_ref_lon;
+        double m_ref_cos_lat;
+
+        Axis m_north;
+        Axis m_east;
+        Axis m_up;
+
+        void seed(double lat, double lon, float alt, float r_h, float r_v, uint32_t time_ms);
+        void recenter();
+    };
+
+    PositionFilterConfig getDefaultPositionFilterConfig();
+}
@@ -0,0 +1,458 @@
+#include "sensor_interface.h"
+#include "../hardware/hardware_abstraction.h"
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+namespace SensorSystem {
+
+    using HardwareAbstraction::Timer::micros;
+    using HardwareAbstraction::Timer::millis;
+
+    // Wrap-safe "a is earlier than b" on the 32-bit millisecond clock
+    static inline bool timeBefore(uint32_t a, uint32_t b) {
+        return static_cast<int32_t>(a - b) < 0;
+    }
+
+    SensorManager& SensorManager::getInstance() {
+        static SensorManager instance;
+        return instance;
+    }
+
+    // --- Registration ---
+
+    bool SensorManager::registerSensor(ISensor* sensor, uint32_t pollPeriodMs) {
+        if (!sensor || sensorCount_ >= MAX_SENSORS || findSensorIndex(sensor->getId()) >= 0) {
+            return false;
+        }
+
+        size_t slot = 0;
+        while (sensors_[slot].sensor) {
+            slot++;
+        }
+
+        SensorEntry& entry = sensors_[slot];
+        entry = SensorEntry();
+        entry.sensor = sensor;
+        entry.isActive = true;
+        entry.interruptDriven = hasCapability(sensor->getCapabilities(), Capability::INTERRUPT_CAPABLE);
+        entry.heapIndex = NOT_IN_HEAP;
+        entry.lastReading = createErrorReading(sensor->getId(), 0);
+        entry.stats.pollPeriodMs = entry.interruptDriven ? 0 : (pollPeriodMs > 0 ? pollPeriodMs : 1);
+        sensorCount_++;
+
+        if (!entry.interruptDriven) {
+            entry.nextDue = millis();
+            heapPush(static_cast<uint8_t>(slot));
+        }
+        return true;
+    }
+
+    bool SensorManager::unregisterSensor(const char* sensorId) {
+        const int slot = findSensorIndex(sensorId);
+        if (slot < 0) {
+            return false;
+        }
+        heapRemove(static_cast<uint8_t>(slot));
+        sensors_[slot] = SensorEntry();
+        sensorCount_--;
+        return true;
+    }
+
+    ISensor* SensorManager::getSensor(const char* sensorId) {
+        const int slot = findSensorIndex(sensorId);
+        return slot < 0 ? nullptr : sensors_[slot].sensor;
+    }
+
+    bool SensorManager::setPollPeriod(const char* sensorId, uint32_t pollPeriodMs) {
+        const int slot = findSensorIndex(sensorId);
+        if (slot < 0 || sensors_[slot].interruptDriven || pollPeriodMs == 0) {
+            return false;
+        }
+        // Re-anchor on the last run so a shorter period takes effect now
+        SensorEntry& entry = sensors_[slot];
+        entry.stats.pollPeriodMs = pollPeriodMs;
+        heapRemove(static_cast<uint8_t>(slot));
+        entry.nextDue = entry.stats.polls > 0 ? entry.lastUpdate + pollPeriodMs : millis();
+        heapPush(static_cast<uint8_t>(slot));
+        return true;
+    }
+
+    bool SensorManager::notifyInterrupt(const ISensor* sensor) {
+        for (size_t slot = 0; slot < MAX_SENSORS; slot++) {
+            if (sensors_[slot].sensor == sensor && sensors_[slot].interruptDriven) {
+                sensors_[slot].irqPending = true;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // --- Global operations ---
+
+    bool SensorManager::initializeAll() {
+        bool ok = true;
+        for (size_t slot = 0; slot < MAX_SENSORS; slot++) {
+            SensorEntry& entry = sensors_[slot];
+            if (!entry.sensor || entry.sensor->getState() == State::READY) {
+                continue;
+            }
+            if (!entry.sensor->initialize()) {
+                ok = false;
+                entry.isActive = false;
+                if (globalErrorCallback_) {
+                    globalErrorCallback_(entry.sensor->getId(), entry.sensor->getLastError());
+                }
+            } else {
+                entry.isActive = true;
+            }
+        }
+        return ok;
+    }
+
+    void SensorManager::updateAll() {
+        const uint32_t now = millis();
+
+        // Interrupt-driven sensors cost one flag test until their IRQ fires
+        for (size_t slot = 0; slot < MAX_SENSORS; slot++) {
+            SensorEntry& entry = sensors_[slot];
+            if (entry.interruptDriven && entry.irqPending) {
+                entry.irqPending = false;
+                entry.stats.interrupts++;
+                service(slot, now);
+            }
+        }
+
+        // Pop every polled sensor whose deadline has passed
+        while (heapSize_ > 0 && !timeBefore(now, sensors_[heap_[0]].nextDue)) {
+            const uint8_t slot = heap_[0];
+            SensorEntry& entry = sensors_[slot];
+            const uint32_t period = entry.stats.pollPeriodMs;
+            const uint32_t lateness = now - entry.nextDue;
+            if (lateness > entry.stats.maxLatenessMs) {
+                entry.stats.maxLatenessMs = lateness;
+            }
+            if (lateness >= period) {
+                entry.stats.overruns++;
+            }
+
+            service(slot, now);
+
+            // Next deadline stays on the period grid unless a slot was missed
+            entry.nextDue = lateness < period ? entry.nextDue + period : now + period;
+            siftDown(0);
+        }
+    }
+
+    void SensorManager::service(size_t slot, uint32_t now) {
+        SensorEntry& entry = sensors_[slot];
+        const State state = entry.sensor->getState();
+        if (!entry.isActive || (state != State::READY && state != State::READING)) {
+            return;
+        }
+
+        const uint32_t start = micros();
+        entry.sensor->update();
+        bool gotReading = false;
+        bool readFailed = false;
+        Reading reading = {};
+        if (entry.sensor->hasNewData()) {
+            if (entry.sensor->readSensor(reading)) {
+                gotReading = true;
+                entry.lastReading = reading;
+                entry.errorCount = 0;
+                entry.stats.readings++;
+            } else {
+                readFailed = true;
+                entry.errorCount++;
+                entry.stats.errors++;
+            }
+        }
+        const uint32_t latency = micros() - start;
+
+        entry.lastUpdate = now;
+        entry.stats.polls++;
+        entry.stats.lastLatencyUs = latency;
+        if (latency > entry.stats.maxLatencyUs) {
+            entry.stats.maxLatencyUs = latency;
+        }
+        entry.totalLatencyUs += latency;
+        entry.stats.avgLatencyUs = static_cast<uint32_t>(entry.totalLatencyUs / entry.stats.polls);
+
+        // Callbacks run after timing so their cost is not charged to the sensor
+        if (gotReading && globalReadingCallback_) {
+            globalReadingCallback_(reading);
+        } else if (readFailed && globalErrorCallback_) {
+            globalErrorCallback_(entry.sensor->getId(), entry.sensor->getLastError());
+        }
+    }
+
+    void SensorManager::deinitializeAll() {
+        for (size_t slot = 0; slot < MAX_SENSORS; slot++) {
+            if (sensors_[slot].sensor) {
+                sensors_[slot].sensor->deinitialize();
+                sensors_[slot].isActive = false;
+            }
+        }
+    }
+
+    // --- Data access ---
+
+    bool SensorManager::getReading(const char* sensorId, Reading& reading) {
+        const int slot = findSensorIndex(sensorId);
+        if (slot < 0 || sensors_[slot].stats.readings == 0) {
+            return false;
+        }
+        reading = sensors_[slot].lastReading;
+        return true;
+    }
+
+    bool SensorManager::getReadings(Reading* readings, size_t maxReadings, size_t& count) {
+        count = 0;
+        for (size_t slot = 0; slot < MAX_SENSORS && count < maxReadings; slot++) {
+            if (sensors_[slot].sensor && sensors_[slot].stats.readings > 0) {
+                readings[count++] = sensors_[slot].lastReading;
+            }
+        }
+        return count > 0;
+    }
+
+    void SensorManager::setGlobalReadingCallback(ReadingCallback callback) {
+        globalReadingCallback_ = callback;
+    }
+
+    void SensorManager::setGlobalErrorCallback(ErrorCallback callback) {
+        globalErrorCallback_ = callback;
+    }
+
+    // --- Status ---
+
+    size_t SensorManager::getSensorCount() const {
+        return sensorCount_;
+    }
+
+    void SensorManager::getSensorList(const char** sensorIds, size_t maxSensors, size_t& count) const {
+        count = 0;
+        for (size_t slot = 0; slot < MAX_SENSORS && count < maxSensors; slot++) {
+            if (sensors_[slot].sensor) {
+                sensorIds[count++] = sensors_[slot].sensor->getId();
+            }
+        }
+    }
+
+    bool SensorManager::getStats(const char* sensorId, SensorStats& stats) const {
+        const int slot = findSensorIndex(sensorId);
+        if (slot < 0) {
+            return false;
+        }
+        stats = sensors_[slot].stats;
+        return true;
+    }
+
+    uint32_t SensorManager::getTimeUntilNextPoll() const {
+        if (heapSize_ == 0) {
+            return UINT32_MAX;
+        }
+        const uint32_t now = millis();
+        const uint32_t due = sensors_[heap_[0]].nextDue;
+        return timeBefore(now, due) ? due - now : 0;
+    }
+
+    void SensorManager::printStatus() const {
+        #ifdef ARDUINO
+        Serial.println("=== Sensor Manager ===");
+        for (size_t slot = 0; slot < MAX_SENSORS; slot++) {
+            const SensorEntry& entry = sensors_[slot];
+            if (!entry.sensor) {
+                continue;
+            }
+            const SensorStats& s = entry.stats;
+            Serial.printf("%s [%s] %s: polls %lu, errors %lu, overruns %lu, latency avg/max %lu/%lu us\n",
+                         entry.sensor->getId(), stateToString(entry.sensor->getState()),
+                         entry.interruptDriven ? "irq" : "polled", s.polls, s.errors, s.overruns,
+                         s.avgLatencyUs, s.maxLatencyUs);
+        }
+        Serial.println("======================");
+        #endif
+    }
+
+    bool SensorManager::performHealthCheck() {
+        bool healthy = true;
+        const uint32_t now = millis();
+        for (size_t slot = 0; slot < MAX_SENSORS; slot++) {
+            SensorEntry& entry = sensors_[slot];
+            if (!entry.sensor) {
+                continue;
+            }
+
+            // Repeated read failures or an ERROR state: one reset + re-init attempt
+            if (entry.sensor->getState() == State::ERROR || entry.errorCount >= MAX_CONSECUTIVE_ERRORS) {
+                healthy = false;
+                entry.sensor->reset();
+                entry.isActive = entry.sensor->initialize();
+                entry.errorCount = 0;
+                continue;
+            }
+
+            // A polled sensor that has not run for three periods is starved
+            const uint32_t period = entry.stats.pollPeriodMs;
+            if (!entry.interruptDriven && entry.stats.polls > 0 && period > 0 &&
+                now - entry.lastUpdate > 3 * period) {
+                healthy = false;
+            }
+            if (!entry.isActive) {
+                healthy = false;
+            }
+        }
+        return healthy;
+    }
+
+    int SensorManager::findSensorIndex(const char* sensorId) const {
+        if (!sensorId) {
+            return -1;
+        }
+        for (size_t slot = 0; slot < MAX_SENSORS; slot++) {
+            if (sensors_[slot].sensor && strcmp(sensors_[slot].sensor->getId(), sensorId) == 0) {
+                return static_cast<int>(slot);
+            }
+        }
+        return -1;
+    }
+
+    // --- Deadline heap ---
+
+    bool SensorManager::dueBefore(uint8_t a, uint8_t b) const {
+        return timeBefore(sensors_[a].nextDue, sensors_[b].nextDue);
+    }
+
+    void SensorManager::heapSwap(size_t a, size_t b) {
+        const uint8_t slot = heap_[a];
+        heap_[a] = heap_[b];
+        heap_[b] = slot;
+        sensors_[heap_[a]].heapIndex = static_cast<uint8_t>(a);
+        sensors_[heap_[b]].heapIndex = static_cast<uint8_t>(b);
+    }
+
+    void SensorManager::siftUp(size_t index) {
+        while (index > 0) {
+            const size_t parent = (index - 1) / 2;
+            if (!dueBefore(heap_[index], heap_[parent])) {
+                break;
+            }
+            heapSwap(index, parent);
+            index = parent;
+        }
+    }
+
+    void SensorManager::siftDown(size_t index) {
+        for (;;) {
+            const size_t left = 2 * index + 1;
+            const size_t right = left + 1;
+            size_t first = index;
+            if (left < heapSize_ && dueBefore(heap_[left], heap_[first])) {
+                first = left;
+            }
+            if (right < heapSize_ && dueBefore(heap_[right], heap_[first])) {
+                first = right;
+            }
+            if (first == index) {
+                return;
+            }
+            heapSwap(index, first);
+            index = first;
+        }
+    }
+
+    void SensorManager::heapPush(uint8_t slot) {
+        heap_[heapSize_] = slot;
+        sensors_[slot].heapIndex = static_cast<uint8_t>(heapSize_);
+        heapSize_++;
+        siftUp(heapSize_ - 1);
+    }
+
+    void SensorManager::heapRemove(uint8_t slot) {
+        const uint8_t index = sensors_[slot].heapIndex;
+        if (index == NOT_IN_HEAP) {
+            return;
+        }
+        heapSize_--;
+        if (index != heapSize_) {
+            heapSwap(index, heapSize_);
+            siftDown(index);
+            siftUp(index);
+        }
+        sensors_[slot].heapIndex = NOT_IN_HEAP;
+    }
+
+    // --- Utility functions ---
+
+    static Reading makeReading(const char* name, DataType type, const char* unit) {
+        Reading reading = {};
+        reading.timestamp = millis();
+        reading.type = type;
+        reading.name = name;
+        reading.unit = unit;
+        reading.isValid = true;
+        return reading;
+    }
+
+    Reading createBoolReading(const char* name, bool value, const char* unit) {
+        Reading reading = makeReading(name, DataType::BOOLEAN, unit);
+        reading.value.boolValue = value;
+        return reading;
+    }
+
+    Reading createIntReading(const char* name, int32_t value, const char* unit) {
+        Reading reading = makeReading(name, DataType::INTEGER, unit);
+        reading.value.intValue = value;
+        return reading;
+    }
+
+    Reading createFloatReading(const char* name, float value, const char* unit) {
+        Reading reading = makeReading(name, DataType::FLOAT, unit);
+        reading.value.floatValue = value;
+        return reading;
+    }
+
+    Reading createStringReading(const char* name, const char* value) {
+        Reading reading = makeReading(name, DataType::STRING, nullptr);
+        reading.value.stringValue = value;
+        return reading;
+    }
+
+    Reading createErrorReading(const char* name, uint32_t errorCode) {
+        Reading reading = makeReading(name, DataType::INTEGER, nullptr);
+        reading.isValid = false;
+        reading.errorCode = errorCode;
+        return reading;
+    }
+
+    const char* stateToString(State state) {
+        switch (state) {
+            case State::UNINITIALIZED: return "UNINITIALIZED";
+            case State::INITIALIZING: return "INITIALIZING";
+            case State::READY: return "READY";
+            case State::READING: return "READING";
+            case State::ERROR: return "ERROR";
+            case State::DISABLED: return "DISABLED";
+            default: return "UNKNOWN";
+        }
+    }
+
+    const char* dataTypeToString(DataType type) {
+        switch (type) {
+            case DataType::BOOLEAN: return "BOOLEAN";
+            case DataType::INTEGER: return "INTEGER";
+            case DataType::FLOAT: return "FLOAT";
+            case DataType::STRING: return "STRING";
+            case DataType::BINARY: return "BINARY";
+            default: return "UNKNOWN";
+        }
+    }
+
+    bool hasCapability(uint16_t capabilities, Capability cap) {
+        return (capabilities & static_cast<uint16_t>(cap)) != 0;
+    }
+}
@@ -103,15 +103,43 @@ namespace SensorSystem {
         virtual const char* getErrorString(uint32_t errorCode) const = 0;
     };
 
-    // Sensor manager for handling multiple sensors
+    // Per-sensor scheduling and timing statistics
+    struct SensorStats {
+        uint32_t pollPeriodMs;      // 0 = interrupt-driven
+        uint32_t polls;             // update() calls made by the manager
+        uint32_t readings;          // Successful readSensor() calls
+        uint32_t errors;            // Failed readSensor() calls
+        uint32_t overruns;          // Polls started a full period or more after their deadline
+        uint32_t interrupts;        // notifyInterrupt() calls serviced
+        uint32_t lastLatencyUs;     // Duration of the last update() + read
+        uint32_t maxLatencyUs;
+        uint32_t avgLatencyUs;
+        uint32_t maxLatenessMs;     // Worst start delay past the deadline
+    };
+
+    // Sensor manager for handling multiple sensors.
+    // Polled sensors sit in a min-heap keyed by their next deadline, so
+    // updateAll() costs O(1) when nothing is due and O(log n) per sensor
+    // serviced. INTERRUPT_CAPABLE sensors are kept out of the heap and only
+    // serviced after notifyInterrupt(). A late sensor is rescheduled one
+    // period after the time it actually ran, not back-to-back to catch up.
     class SensorManager {
     public:
+        static constexpr uint32_t DEFAULT_POLL_PERIOD_MS = 1000;
+
         static SensorManager& getInstance();
 
-        // Sensor management
-        bool registerSensor(ISensor* sensor);
+        // Sensor management. Polled sensors become due immediately. Periods
+        // have a 1 ms floor: registerSensor() raises 0 to 1 ms, and
+        // setPollPeriod() rejects 0.
+        bool registerSensor(ISensor* sensor, uint32_t pollPeriodMs = DEFAULT_POLL_PERIOD_MS);
         bool unregisterSensor(const char* sensorId);
         ISensor* getSensor(const char* sensorId);
+        bool setPollPeriod(const char* sensorId, uint32_t pollPeriodMs);
+
+        // IRQ from an interrupt-capable sensor. ISR-safe: a pointer scan and
+        // one flag write. The sensor is serviced on the next updateAll().
+        bool notifyInterrupt(const ISensor* sensor);
 
         // Global operations
         bool initializeAll();
@@ -129,6 +157,11 @@ namespace SensorSystem {
         // Status
         size_t getSensorCount() const;
         void getSensorList(const char** sensorIds, size_t maxSensors, size_t& count) const;
+        bool getStats(const char* sensorId, SensorStats& stats) const;
+
+        // Milliseconds until the next polled sensor is due (UINT32_MAX if none);
+        // lets the main loop sleep instead of spinning
+        uint32_t getTimeUntilNextPoll() const;
 
         // Diagnostics
         void printStatus() const;
@@ -137,20 +170,39 @@ namespace SensorSystem {
     private:
         SensorManager() = default;
         static constexpr size_t MAX_SENSORS = 8;
+        static constexpr uint32_t MAX_CONSECUTIVE_ERRORS = 5;
 
         struct SensorEntry {
             ISensor* sensor;
             bool isActive;
+            bool interruptDriven;
+            volatile bool irqPending;
             uint32_t lastUpdate;
-            uint32_t errorCount;
+            uint32_t errorCount;    // Consecutive read failures
+            uint32_t nextDue;
+            uint8_t heapIndex;      // Position in heap_, NOT_IN_HEAP if interrupt-driven
+            uint64_t totalLatencyUs;
+            Reading lastReading;
+            SensorStats stats;
         };
 
-        SensorEntry sensors_[MAX_SENSORS];
-        size_t sensorCount_;
+        static constexpr uint8_t NOT_IN_HEAP = 0xFF;
+
+        SensorEntry sensors_[MAX_SENSORS] = {};
+        size_t sensorCount_ = 0;
+        uint8_t heap_[MAX_SENSORS] = {};    // Slot indices, earliest nextDue first
+        size_t heapSize_ = 0;
         ReadingCallback globalReadingCallback_;
         ErrorCallback globalErrorCallback_;
 
         int findSensorIndex(const char* sensorId) const;
+        void service(size_t slot, uint32_t now);
+        bool dueBefore(uint8_t a, uint8_t b) const;
+        void heapPush(uint8_t slot);
+        void heapRemove(uint8_t slot);
+        void siftUp(size_t index);
+        void siftDown(size_t index);
+        void heapSwap(size_t a, size_t b);
     };
 
     // Utility functions
@@ -0,0 +1,424 @@
+#include "storm_tracker.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace Sensors {
+
+    // Global storm tracker fed from the lightning sensor
+    StormTracker g_stormTracker;
+
+    static constexpr float MS_PER_MIN = 60000.0f;
+
+    // Farthest in-range AS3935 distance bin
+    static constexpr uint8_t MAX_RANGE_KM = 40;
+
+    // Trend compares the last 5 min against the 10 min before; needs this many strikes
+    static constexpr uint32_t MIN_TREND_STRIKES = 6;
+    static constexpr float TREND_RATIO = 1.5f;
+
+    StormTrackerConfig getDefaultStormTrackerConfig() {
+        StormTrackerConfig config = {};
+        config.fit_window_ms = 30 * 60000;
+        config.start_strikes = 3;
+        config.start_window_ms = 5 * 60000;
+        config.end_quiet_ms = 30 * 60000;     // 30-minute all-clear rule
+        config.min_fit_strikes = 5;
+        config.min_fit_span_ms = 3 * 60000;
+        config.outlier_k = 1.5f;
+        config.min_sigma_km = 2.0f;
+        config.stationary_kmh = 3.0f;
+        return config;
+    }
+
+    const char* stormTrendToString(StormTrend trend) {
+        switch (trend) {
+            case StormTrend::INTENSIFYING: return "intensifying";
+            case StormTrend::STEADY: return "steady";
+            case StormTrend::WEAKENING: return "weakening";
+            default: return "unknown";
+        }
+    }
+
+    const char* stormMotionToString(StormMotion motion) {
+        switch (motion) {
+            case StormMotion::APPROACHING: return "approaching";
+            case StormMotion::STATIONARY: return "stationary";
+            case StormMotion::RECEDING: return "receding";
+            default: return "unknown";
+        }
+    }
+
+    StormTracker::StormTracker() {
+        configure(getDefaultStormTrackerConfig());
+    }
+
+    StormTracker::StormTracker(const StormTrackerConfig& config) {
+        configure(config);
+    }
+
+    void StormTracker::configure(const StormTrackerConfig& config) {
+        m_config = config;
+        m_window_ms[WINDOW_1MIN] = 60000;
+        m_window_ms[WINDOW_5MIN] = 5 * 60000;
+        m_window_ms[WINDOW_15MIN] = 15 * 60000;
+        m_window_ms[WINDOW_START] = config.start_window_ms;
+        m_window_ms[WINDOW_FIT] = config.fit_window_ms;
+        reset();
+    }
+
+    void StormTracker::reset() {
+        memset(m_ring, 0, sizeof(m_ring));
+        memset(m_tail, 0, sizeof(m_tail));
+        memset(&m_fit, 0, sizeof(m_fit));
+        memset(&m_summary, 0, sizeof(m_summary));
+        m_total = 0;
+        m_overflowed = false;
+        m_overflow_ms = 0;
+        m_fit_ref_ms = 0;
+        m_since_rebuild = 0;
+        m_last_distance_km = 0.0f;
+        m_summary.eta_min = -1.0f;
+    }
+
+    void StormTracker::removeFromFit(const Strike& strike) {
+        if (strike.weight <= 0.0f) {
+            return;
+        }
+        if (--m_fit.count == 0) {
+            // Window emptied: drop accumulated rounding error
+            memset(&m_fit, 0, sizeof(m_fit));
+            return;
+        }
+
+        const float t = -static_cast<float>(m_fit_ref_ms - strike.time_ms) / MS_PER_MIN;
+        const float w = strike.weight;
+        const float d = strike.distance_km;
+        m_fit.w -= w;
+        m_fit.wt -= w * t;
+        m_fit.wd -= w * d;
+        m_fit.wtt -= w * t * t;
+        m_fit.wtd -= w * t * d;
+        m_fit.wrr -= strike.residual_sq;
+        if (m_fit.wrr < 0.0f) {
+            m_fit.wrr = 0.0f;
+        }
+    }
+
+    void StormTracker::rebaseFit(uint32_t ref_ms) {
+        // Shift t so the newest strike sits at 0 and old t values stay small
+        const float shift = static_cast<float>(ref_ms - m_fit_ref_ms) / MS_PER_MIN;
+        m_fit.wtt += shift * (shift * m_fit.w - 2.0f * m_fit.wt);
+        m_fit.wtd -= shift * m_fit.wd;
+        m_fit.wt -= shift * m_fit.w;
+        m_fit_ref_ms = ref_ms;
+    }
+
+    void StormTracker::rebuildFit() {
+        memset(&m_fit, 0, sizeof(m_fit));
+        for (uint32_t i = m_tail[WINDOW_FIT]; i != m_total; i++) {
+            const Strike& strike = m_ring[i % CAPACITY];
+            if (strike.weight <= 0.0f) {
+                continue;
+            }
+            const float t = -static_cast<float>(m_fit_ref_ms - strike.time_ms) / MS_PER_MIN;
+            const float w = strike.weight;
+            const float d = strike.distance_km;
+            m_fit.w += w;
+            m_fit.wt += w * t;
+            m_fit.wd += w * d;
+            m_fit.wtt += w * t * t;
+            m_fit.wtd += w * t * d;
+            m_fit.wrr += strike.residual_sq;
+            m_fit.count++;
+        }
+        m_since_rebuild = 0;
+    }
+
+    bool StormTracker::fitLine(float& intercept, float& slope) const {
+        if (m_fit.count < m_config.min_fit_strikes || m_tail[WINDOW_FIT] == m_total) {
+            return false;
+        }
+        const uint32_t oldest_ms = m_ring[m_tail[WINDOW_FIT] % CAPACITY].time_ms;
+        if (m_fit_ref_ms - oldest_ms < m_config.min_fit_span_ms) {
+            return false;
+        }
+
+        const float det = m_fit.w * m_fit.wtt - m_fit.wt * m_fit.wt;
+        if (det <= 1e-6f * m_fit.w * m_fit.w) {
+            return false;
+        }
+        slope = (m_fit.w * m_fit.wtd - m_fit.wt * m_fit.wd) / det;
+        intercept = (m_fit.wd - slope * m_fit.wt) / m_fit.w;
+        return true;
+    }
+
+    void StormTracker::expire(uint32_t now_ms) {
+        for (uint8_t window = 0; window < WINDOW_COUNT; window++) {
+            uint32_t& tail = m_tail[window];
+            while (tail != m_total && now_ms - m_ring[tail % CAPACITY].time_ms >= m_window_ms[window]) {
+                if (window == WINDOW_FIT) {
+                    removeFromFit(m_ring[tail % CAPACITY]);
+                }
+                tail++;
+            }
+        }
+    }
+
+    StormEvent StormTracker::addStrike(uint8_t distance_km, uint32_t energy, uint32_t time_ms) {
+        // Strikes arrive in order; clamp a late timestamp so the windows stay sorted
+        if (m_total > 0) {
+            const uint32_t newest_ms = m_ring[(m_total - 1) % CAPACITY].time_ms;
+            if (static_cast<int32_t>(time_ms - newest_ms) < 0) {
+                time_ms = newest_ms;
+            }
+        }
+        expire(time_ms);
+
+        // Full ring: the oldest slot is overwritten, drag any window still pointing at it
+        if (m_total >= CAPACITY) {
+            const uint32_t evicted = m_total - CAPACITY;
+            for (uint8_t window = 0; window < WINDOW_COUNT; window++) {
+                if (m_tail[window] == evicted) {
+                    if (window == WINDOW_FIT) {
+                        removeFromFit(m_ring[evicted % CAPACITY]);
+                    }
+                    m_tail[window]++;
+                    if (window != WINDOW_FIT) {
+                        m_overflowed = true;
+                        m_overflow_ms = m_ring[evicted % CAPACITY].time_ms;
+                    }
+                }
+            }
+        }
+
+        Strike& strike = m_ring[m_total % CAPACITY];
+        strike.time_ms = time_ms;
+        strike.energy = energy;
+        strike.distance_km = distance_km;
+        strike.weight = 0.0f;
+        strike.residual_sq = 0.0f;
+
+        const bool in_range = distance_km <= MAX_RANGE_KM;
+        if (in_range) {
+            // Huber weight against the fit before this strike
+            float intercept, slope;
+            if (fitLine(intercept, slope)) {
+                const float t = static_cast<float>(time_ms - m_fit_ref_ms) / MS_PER_MIN;
+                const float residual = distance_km - (intercept + slope * t);
+                const float sigma = fmaxf(m_config.min_sigma_km, sqrtf(m_fit.wrr / m_fit.w));
+                const float limit = m_config.outlier_k * sigma;
+                strike.weight = (fabsf(residual) <= limit) ? 1.0f : limit / fabsf(residual);
+                strike.residual_sq = strike.weight * residual * residual;
+            } else {
+                strike.weight = 1.0f;
+            }
+
+            // New strike at t = 0 only contributes to the zeroth-order sums
+            rebaseFit(time_ms);
+            m_fit.w += strike.weight;
+            m_fit.wd += strike.weight * distance_km;
+            m_fit.wrr += strike.residual_sq;
+            m_fit.count++;
+            m_last_distance_km = distance_km;
+        }
+        m_total++;
+
+        // Periodic exact recompute bounds float drift of the running sums
+        if (++m_since_rebuild >= CAPACITY) {
+            rebaseFit(time_ms);
+            rebuildFit();
+        }
+
+        StormEvent event = StormEvent::NONE;
+        if (m_summary.active) {
+            m_summary.strikes++;
+            if (in_range && distance_km < m_summary.closest_km) {
+                m_summary.closest_km = distance_km;
+            }
+            if (energy > m_summary.peak_energy) {
+                m_summary.peak_energy = energy;
+            }
+        } else if (windowCount(WINDOW_START) >= m_config.start_strikes) {
+            // Runs once per storm: seed the storm stats from the start window
+            m_summary.active = true;
+            m_summary.started_ms = m_ring[m_tail[WINDOW_START] % CAPACITY].time_ms;
+            m_summary.strikes = windowCount(WINDOW_START);
+            m_summary.closest_km = STORM_OUT_OF_RANGE_KM;
+            m_summary.peak_energy = 0;
+            for (uint32_t i = m_tail[WINDOW_START]; i != m_total; i++) {
+                const Strike& seed = m_ring[i % CAPACITY];
+                if (seed.distance_km <= MAX_RANGE_KM && seed.distance_km < m_summary.closest_km) {
+                    m_summary.closest_km = seed.distance_km;
+                }
+                if (seed.energy > m_summary.peak_energy) {
+                    m_summary.peak_energy = seed.energy;
+                }
+            }
+            event = StormEvent::STARTED;
+        }
+        m_summary.last_strike_ms = time_ms;
+
+        refreshSummary(time_ms);
+        return event;
+    }
+
+    StormEvent StormTracker::update(uint32_t now_ms) {
+        expire(now_ms);
+
+        StormEvent event = StormEvent::NONE;
+        if (m_summary.active && now_ms - m_summary.last_strike_ms >= m_config.end_quiet_ms) {
+            m_summary.active = false;
+            event = StormEvent::ENDED;
+        }
+
+        refreshSummary(now_ms);
+        return event;
+    }
+
+    void StormTracker::refreshSummary(uint32_t now_ms) {
+        const uint32_t count_1 = windowCount(WINDOW_1MIN);
+        const uint32_t count_5 = windowCount(WINDOW_5MIN);
+        const uint32_t count_15 = windowCount(WINDOW_15MIN);
+        m_summary.rate_1min = static_cast<float>(count_1);
+        m_summary.rate_5min = count_5 / 5.0f;
+        m_summary.rate_15min = count_15 / 15.0f;
+        m_summary.saturated = m_overflowed && (now_ms - m_overflow_ms < m_window_ms[WINDOW_15MIN]);
+
+        // Trend: last 5 min against the (up to) 10 min before, as rates
+        m_summary.trend = StormTrend::UNKNOWN;
+        const uint32_t age_ms = now_ms - m_summary.started_ms;
+        if (m_summary.active && count_15 >= MIN_TREND_STRIKES && age_ms > m_window_ms[WINDOW_5MIN]) {
+            const uint32_t earlier_ms = age_ms - m_window_ms[WINDOW_5MIN];
+            const float earlier_min = fminf(earlier_ms, m_window_ms[WINDOW_15MIN] - m_window_ms[WINDOW_5MIN]) / MS_PER_MIN;
+            const float earlier_rate = (count_15 - count_5) / fmaxf(earlier_min, 1.0f);
+            if (m_summary.rate_5min > TREND_RATIO * earlier_rate) {
+                m_summary.trend = StormTrend::INTENSIFYING;
+            } else if (m_summary.rate_5min * TREND_RATIO < earlier_rate) {
+                m_summary.trend = StormTrend::WEAKENING;
+            } else {
+                m_summary.trend = StormTrend::STEADY;
+            }
+        }
+
+        float intercept, slope;
+        m_summary.fit_valid = fitLine(intercept, slope);
+        if (m_summary.fit_valid) {
+            const float t = static_cast<float>(now_ms - m_fit_ref_ms) / MS_PER_MIN;
+            m_summary.distance_km = fmaxf(0.0f, intercept + slope * t);
+            m_summary.approach_kmh = -slope * 60.0f;
+            m_summary.residual_km = sqrtf(m_fit.wrr / m_fit.w);
+
+            if (m_summary.approach_kmh >= m_config.stationary_kmh) {
+                m_summary.motion = StormMotion::APPROACHING;
+                m_summary.eta_min = m_summary.distance_km / m_summary.approach_kmh * 60.0f;
+            } else {
+                m_summary.motion = (m_summary.approach_kmh <= -m_config.stationary_kmh) ?
+                    StormMotion::RECEDING : StormMotion::STATIONARY;
+                m_summary.eta_min = -1.0f;
+            }
+        } else {
+            m_summary.distance_km = m_last_distance_km;
+            m_summary.approach_kmh = 0.0f;
+            m_summary.residual_km = 0.0f;
+            m_summary.motion = StormMotion::UNKNOWN;
+            m_summary.eta_min = -1.0f;
+        }
+    }
+
+    size_t StormTracker::formatDisplay(char lines[][DISPLAY_LINE_LEN], size_t max_lines) const {
+        const StormSummary& s = m_summary;
+        size_t n = 0;
+
+        if (!s.active) {
+            if (n < max_lines) {
+                snprintf(lines[n++], DISPLAY_LINE_LEN, "No storm");
+            }
+            if (n < max_lines && m_total > 0) {
+                snprintf(lines[n++], DISPLAY_LINE_LEN, "Strikes 15m: %u", static_cast<unsigned>(s.rate_15min * 15.0f + 0.5f));
+            }
+            return n;
+        }
+
+        if (n < max_lines) {
+            static const char* const trend_labels[] = {"", "rising", "steady", "easing"};
+            snprintf(lines[n++], DISPLAY_LINE_LEN, "STORM %.0fkm %s", s.distance_km,
+                     trend_labels[static_cast<uint8_t>(s.trend) & 3]);
+        }
+        if (n < max_lines) {
+            snprintf(lines[n++], DISPLAY_LINE_LEN, "%.0f/min 5m %.1f%s", s.rate_1min, s.rate_5min, s.saturated ? "+" : "");
+        }
+        if (n < max_lines) {
+            switch (s.motion) {
+                case StormMotion::APPROACHING:
+                    if (s.eta_min < 100.0f) {
+                        snprintf(lines[n++], DISPLAY_LINE_LEN, "Closing %.0fkm/h ETA%.0fm", s.approach_kmh, s.eta_min);
+                    } else {
+                        snprintf(lines[n++], DISPLAY_LINE_LEN, "Closing %.0fkm/h", s.approach_kmh);
+                    }
+                    break;
+                case StormMotion::RECEDING:
+                    snprintf(lines[n++], DISPLAY_LINE_LEN, "Leaving %.0fkm/h", -s.approach_kmh);
+                    break;
+                case StormMotion::STATIONARY:
+                    snprintf(lines[n++], DISPLAY_LINE_LEN, "Stationary");
+                    break;
+                default:
+                    snprintf(lines[n++], DISPLAY_LINE_LEN, "Tracking...");
+                    break;
+            }
+        }
+        return n;
+    }
+
+    static char trendCode(StormTrend trend) {
+        static const char codes[] = {'U', 'I', 'S', 'W'};
+        return codes[static_cast<uint8_t>(trend) & 3];
+    }
+
+    static char motionCode(StormMotion motion) {
+        static const char codes[] = {'U', 'A', 'S', 'R'};
+        return codes[static_cast<uint8_t>(motion) & 3];
+    }
+
+    size_t StormTracker::formatUplink(char* buffer, size_t length) const {
+        const StormSummary& s = m_summary;
+        const int written = snprintf(buffer, length,
+            "STORM A=%d N=%lu R1=%.0f R5=%.1f R15=%.1f D=%.1f V=%.1f E=%.0f T=%c M=%c",
+            s.active ? 1 : 0, static_cast<unsigned long>(s.strikes), s.rate_1min, s.rate_5min, s.rate_15min,
+            s.distance_km, s.approach_kmh, s.eta_min, trendCode(s.trend), motionCode(s.motion));
+        if (written < 0 || static_cast<size_t>(written) >= length) {
+            return 0;
+        }
+        return static_cast<size_t>(written);
+    }
+
+    bool StormTracker::parseUplink(const char* frame, StormSummary& summary) {
+        int active = 0;
+        unsigned long strikes = 0;
+        char trend = 0, motion = 0;
+        StormSummary parsed = {};
+        const int fields = sscanf(frame, "STORM A=%d N=%lu R1=%f R5=%f R15=%f D=%f V=%f E=%f T=%c M=%c",
+                                  &active, &strikes, &parsed.rate_1min, &parsed.rate_5min, &parsed.rate_15min,
+                                  &parsed.distance_km, &parsed.approach_kmh, &parsed.eta_min, &trend, &motion);
+        if (fields != 10) {
+            return false;
+        }
+
+        parsed.active = active != 0;
+        parsed.strikes = static_cast<uint32_t>(strikes);
+        parsed.trend = StormTrend::UNKNOWN;
+        parsed.motion = StormMotion::UNKNOWN;
+        for (uint8_t i = 0; i < 4; i++) {
+            if (trendCode(static_cast<StormTrend>(i)) == trend) {
+                parsed.trend = static_cast<StormTrend>(i);
+            }
+            if (motionCode(static_cast<StormMotion>(i)) == motion) {
+                parsed.motion = static_cast<StormMotion>(i);
+            }
+        }
+        parsed.fit_valid = parsed.motion != StormMotion::UNKNOWN;
+        summary = parsed;
+        return true;
+    }
+}
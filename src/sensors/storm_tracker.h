@@ -0,0 +1,159 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Sensors {
+
+    // AS3935 distance estimate for strikes beyond its 40 km range
+    static constexpr uint8_t STORM_OUT_OF_RANGE_KM = 63;
+
+    struct StormTrackerConfig {
+        uint32_t fit_window_ms;             // Strikes used for the distance-vs-time fit
+        uint16_t start_strikes;             // A storm starts with this many strikes...
+        uint32_t start_window_ms;           // ...inside this window
+        uint32_t end_quiet_ms;              // A storm ends after this long without strikes
+        uint16_t min_fit_strikes;           // Fit needs this many in-range strikes...
+        uint32_t min_fit_span_ms;           // ...spread over at least this long
+        float outlier_k;                    // Huber threshold in residual sigmas
+        float min_sigma_km;                 // Residual scale floor (AS3935 distance bins are coarse)
+        float stationary_kmh;               // |approach speed| below this is STATIONARY
+    };
+
+    enum class StormEvent : uint8_t {
+        NONE,
+        STARTED,
+        ENDED
+    };
+
+    enum class StormTrend : uint8_t {
+        UNKNOWN,
+        INTENSIFYING,
+        STEADY,
+        WEAKENING
+    };
+
+    enum class StormMotion : uint8_t {
+        UNKNOWN,
+        APPROACHING,
+        STATIONARY,
+        RECEDING
+    };
+
+    // Snapshot refreshed by addStrike() and update()
+    struct StormSummary {
+        bool active;
+        uint32_t started_ms;
+        uint32_t last_strike_ms;
+        uint32_t strikes;                   // Strikes since the storm started
+        float rate_1min;                    // Strikes per minute over each window
+        float rate_5min;
+        float rate_15min;
+        bool saturated;                     // Ring overflowed: rates are lower bounds
+        bool fit_valid;
+        float distance_km;                  // Fitted distance now (last reported if no fit)
+        float closest_km;                   // Closest strike since the storm started
+        uint32_t peak_energy;               // Strongest strike since the storm started
+        float approach_kmh;                 // Positive = closing
+        float eta_min;                      // Minutes to overhead, < 0 if not approaching
+        float residual_km;                  // Fit residual RMS
+        StormTrend trend;
+        StormMotion motion;
+    };
+
+    // Aggregates AS3935 strikes into a storm picture.
+    // Strikes live in a fixed ring; each sliding window (1/5/15 min and the fit
+    // window) is a tail index into it that only moves forward, so rates cost
+    // O(1) amortized per strike. Approach speed is a weighted least-squares
+    // line through distance vs time kept as running sums: strikes are added on
+    // arrival with a Huber weight against the current fit and subtracted when
+    // they leave the fit window.
+    class StormTracker {
+    public:
+        static constexpr size_t CAPACITY = 256;
+        static constexpr size_t DISPLAY_LINE_LEN = 22;      // 21 columns at 6 px on the 128 px OLED
+
+        StormTracker();
+        explicit StormTracker(const StormTrackerConfig& config);
+
+        void configure(const StormTrackerConfig& config);
+        void reset();
+
+        // distance_km as reported by the sensor (0 = overhead, 63 = out of range)
+        StormEvent addStrike(uint8_t distance_km, uint32_t energy, uint32_t time_ms);
+
+        // Expire windows and detect the end of a storm; call periodically
+        StormEvent update(uint32_t now_ms);
+
+        const StormSummary& getSummary() const { return m_summary; }
+        const StormTrackerConfig& getConfig() const { return m_config; }
+        uint32_t getTotalStrikes() const { return m_total; }
+
+        // OLED: up to max_lines text lines; returns the number written
+        size_t formatDisplay(char lines[][DISPLAY_LINE_LEN], size_t max_lines) const;
+
+        // LoRa uplink: "STORM A=1 N=.. R1=.. R5=.. R15=.. D=.. V=.. E=.. T=. M=."
+        // Returns the frame length, 0 if it does not fit
+        size_t formatUplink(char* buffer, size_t length) const;
+        static bool parseUplink(const char* frame, StormSummary& summary);
+
+    private:
+        struct Strike {
+            uint32_t time_ms;
+            uint32_t energy;
+            uint8_t distance_km;
+            float weight;                   // Fit weight, 0 = not in the fit
+            float residual_sq;              // Weighted squared residual at insertion
+        };
+
+        enum Window : uint8_t {
+            WINDOW_1MIN,
+            WINDOW_5MIN,
+            WINDOW_15MIN,
+            WINDOW_START,
+            WINDOW_FIT,
+            WINDOW_COUNT
+        };
+
+        // Running weighted sums; t is minutes relative to m_fit_ref_ms
+        struct FitSums {
+            float w;
+            float wt;
+            float wd;
+            float wtt;
+            float wtd;
+            float wrr;
+            uint16_t count;
+        };
+
+        StormTrackerConfig m_config;
+        Strike m_ring[CAPACITY];
+        uint32_t m_total;                   // Strikes ever added; ring slot = index % CAPACITY
+        uint32_t m_tail[WINDOW_COUNT];      // Oldest strike index inside each window
+        uint32_t m_window_ms[WINDOW_COUNT];
+        bool m_overflowed;
+        uint32_t m_overflow_ms;             // Time of the newest strike pushed out of the ring
+
+        FitSums m_fit;
+        uint32_t m_fit_ref_ms;              // Newest strike time; fit t = 0
+        uint32_t m_since_rebuild;
+        float m_last_distance_km;           // Last in-range strike
+
+        StormSummary m_summary;
+
+        void expire(uint32_t now_ms);
+        void removeFromFit(const Strike& strike);
+        void rebaseFit(uint32_t ref_ms);
+        void rebuildFit();
+        bool fitLine(float& intercept, float& slope) const;
+        void refreshSummary(uint32_t now_ms);
+        uint32_t windowCount(Window window) const { return m_total - m_tail[window]; }
+    };
+
+    extern StormTracker g_stormTracker;
+
+    // Defaults: 30 min fit, 3 strikes in 5 min to start, 30 min all-clear
+    StormTrackerConfig getDefaultStormTrackerConfig();
+    const char* stormTrendToString(StormTrend trend);
+    const char* stormMotionToString(StormMotion motion);
+}
@@ -0,0 +1,244 @@
+#include "strike_density.h"
+#include <cmath>
+#include <cstring>
+
+namespace Sensors {
+
+    // Global density map fed from located strikes
+    StrikeDensityGrid g_strikeDensity;
+
+    namespace {
+        void put16(uint8_t* p, uint16_t v) {
+            p[0] = static_cast<uint8_t>(v);
+            p[1] = static_cast<uint8_t>(v >> 8);
+        }
+
+        void put32(uint8_t* p, uint32_t v) {
+            for (int i = 0; i < 4; i++) {
+                p[i] = static_cast<uint8_t>(v >> (8 * i));
+            }
+        }
+
+        uint16_t get16(const uint8_t* p) {
+            return static_cast<uint16_t>(p[0] | (p[1] << 8));
+        }
+
+        uint32_t get32(const uint8_t* p) {
+            uint32_t v = 0;
+            for (int i = 0; i < 4; i++) {
+                v |= static_cast<uint32_t>(p[i]) << (8 * i);
+            }
+            return v;
+        }
+    }
+
+    StrikeDensityConfig getDefaultStrikeDensityConfig() {
+        StrikeDensityConfig config = {};
+        config.half_width_km = 100.0f;
+        config.half_life_ms = 60 * 60000;
+        return config;
+    }
+
+    StrikeDensityGrid::StrikeDensityGrid() {
+        configure(getDefaultStrikeDensityConfig());
+    }
+
+    StrikeDensityGrid::StrikeDensityGrid(const StrikeDensityConfig& config) {
+        configure(config);
+    }
+
+    void StrikeDensityGrid::configure(const StrikeDensityConfig& config) {
+        m_config = config;
+        m_cell_km = 2.0f * config.half_width_km / GRID_SIZE;
+        m_inv_half_life = config.half_life_ms > 0 ? 1.0f / config.half_life_ms : 0.0f;
+        m_has_site = false;
+        memset(&m_site, 0, sizeof(m_site));
+        reset();
+    }
+
+    void StrikeDensityGrid::reset() {
+        memset(m_cells, 0, sizeof(m_cells));
+        m_total = 0.0f;
+        m_ref_ms = 0;
+        m_strikes = 0;
+        m_outside = 0;
+        m_rebases = 0;
+    }
+
+    void StrikeDensityGrid::setSite(double latitude, double longitude) {
+        if (m_has_site) {
+            float east_km, north_km;
+            Geodesy::toLocalKm(m_site, latitude, longitude, east_km, north_km);
+            if (hypotf(east_km, north_km) < 0.5f * m_cell_km) {
+                return;
+            }
+        }
+        m_site = Geodesy::makeOrigin(latitude, longitude);
+        m_has_site = true;
+        reset();
+    }
+
+    bool StrikeDensityGrid::addStrike(double latitude, double longitude, uint32_t time_ms) {
+        if (!m_has_site) {
+            return false;
+        }
+        float east_km, north_km;
+        Geodesy::toLocalKm(m_site, latitude, longitude, east_km, north_km);
+        return addStrikeLocal(east_km, north_km, time_ms);
+    }
+
+    bool StrikeDensityGrid::addStrikeLocal(float east_km, float north_km, uint32_t time_ms) {
+        const float col = floorf((east_km + m_config.half_width_km) / m_cell_km);
+        const float row = floorf((m_config.half_width_km - north_km) / m_cell_km);
+        if (!(col >= 0.0f && col < GRID_SIZE && row >= 0.0f && row < GRID_SIZE)) {
+            m_outside++;
+            return false;
+        }
+
+        float exponent = halfLivesSince(time_ms);
+        if (m_total <= 0.0f || exponent >= STALE_HALF_LIVES) {
+            // Empty, or everything has decayed away: start over at this strike
+            if (m_total > 0.0f) {
+                memset(m_cells, 0, sizeof(m_cells));
+                m_total = 0.0f;
+            }
+            m_ref_ms = time_ms;
+            exponent = 0.0f;
+        }
+        if (exponent > REBASE_EXPONENT) {
+            rebase(time_ms);
+            exponent = 0.0f;
+        }
+        const float weight = exp2f(exponent);
+        m_cells[static_cast<size_t>(row) * GRID_SIZE + static_cast<size_t>(col)] += weight;
+        m_total += weight;
+        m_strikes++;
+        return true;
+    }
+
+    // Half-lives from m_ref_ms to t. Slightly earlier times (strikes reported
+    // out of order) come out negative; anything else counts forward, so a
+    // quiet spell longer than 2^31 ms does not turn into a negative age.
+    float StrikeDensityGrid::halfLivesSince(uint32_t time_ms) const {
+        const uint32_t elapsed = time_ms - m_ref_ms;
+        const int32_t signedElapsed = static_cast<int32_t>(elapsed);
+        if (signedElapsed < 0 && -static_cast<float>(signedElapsed) * m_inv_half_life < STALE_HALF_LIVES) {
+            return static_cast<float>(signedElapsed) * m_inv_half_life;
+        }
+        return static_cast<float>(elapsed) * m_inv_half_life;
+    }
+
+    float StrikeDensityGrid::decayTo(uint32_t now_ms) const {
+        const float halfLives = halfLivesSince(now_ms);
+        if (halfLives >= STALE_HALF_LIVES) {
+            return 0.0f;
+        }
+        return exp2f(-halfLives);
+    }
+
+    void StrikeDensityGrid::rebase(uint32_t time_ms) {
+        const float scale = decayTo(time_ms);
+        float total = 0.0f;
+        for (size_t i = 0; i < CELLS; i++) {
+            m_cells[i] *= scale;
+            total += m_cells[i];
+        }
+        m_total = total;                    // Resumming also drops accumulated rounding
+        m_ref_ms = time_ms;
+        m_rebases++;
+    }
+
+    float StrikeDensityGrid::cellDensity(size_t row, size_t col, uint32_t now_ms) const {
+        if (row >= GRID_SIZE || col >= GRID_SIZE) {
+            return 0.0f;
+        }
+        return m_cells[row * GRID_SIZE + col] * decayTo(now_ms);
+    }
+
+    float StrikeDensityGrid::totalDensity(uint32_t now_ms) const {
+        return m_total * decayTo(now_ms);
+    }
+
+    size_t StrikeDensityGrid::encode(uint8_t* buffer, size_t length, uint32_t now_ms) const {
+        if (length < STRIKE_DENSITY_HEADER_BYTES) {
+            return 0;
+        }
+
+        float max_weight = 0.0f;
+        for (size_t i = 0; i < CELLS; i++) {
+            max_weight = fmaxf(max_weight, m_cells[i]);
+        }
+        const float to_level = max_weight > 0.0f ? 1.0f / max_weight : 0.0f;
+
+        size_t pos = STRIKE_DENSITY_HEADER_BYTES;
+        uint16_t pairs = 0;
+        uint8_t run_level = 0;
+        size_t run = 0;
+        for (size_t i = 0; i <= CELLS; i++) {
+            uint8_t level = 0;
+            if (i < CELLS) {
+                level = static_cast<uint8_t>(lroundf(255.0f * sqrtf(m_cells[i] * to_level)));
+            }
+            if (run > 0 && (i == CELLS || level != run_level || run == 255)) {
+                if (pos + 2 > length) {
+                    return 0;
+                }
+                buffer[pos++] = static_cast<uint8_t>(run);
+                buffer[pos++] = run_level;
+                pairs++;
+                run = 0;
+            }
+            run_level = level;
+            run++;
+        }
+
+        const float max_density = max_weight * decayTo(now_ms);
+        uint32_t max_bits;
+        memcpy(&max_bits, &max_density, sizeof(max_bits));
+        const uint32_t half_life_min = m_config.half_life_ms / 60000;
+
+        buffer[0] = 'S';
+        buffer[1] = 'D';
+        buffer[2] = STRIKE_DENSITY_FORMAT_VERSION;
+        buffer[3] = GRID_SIZE;
+        put16(buffer + 4, static_cast<uint16_t>(lroundf(m_cell_km * 1000.0f)));
+        put32(buffer + 6, max_bits);
+        put32(buffer + 10, static_cast<uint32_t>(static_cast<int32_t>(lround(m_site.lat_deg * 1e7))));
+        put32(buffer + 14, static_cast<uint32_t>(static_cast<int32_t>(lround(m_site.lon_deg * 1e7))));
+        put32(buffer + 18, m_strikes);
+        put16(buffer + 22, static_cast<uint16_t>(half_life_min > 0xFFFF ? 0xFFFF : half_life_min));
+        put16(buffer + 24, pairs);
+        return pos;
+    }
+
+    bool StrikeDensityGrid::decode(const uint8_t* buffer, size_t length, StrikeDensityHeader& header, uint8_t* levels) {
+        if (length < STRIKE_DENSITY_HEADER_BYTES || buffer[0] != 'S' || buffer[1] != 'D' ||
+            buffer[2] != STRIKE_DENSITY_FORMAT_VERSION || buffer[3] != GRID_SIZE) {
+            return false;
+        }
+
+        const uint32_t max_bits = get32(buffer + 6);
+        header.grid = buffer[3];
+        header.cell_m = get16(buffer + 4);
+        memcpy(&header.max_density, &max_bits, sizeof(header.max_density));
+        header.site_latitude = static_cast<int32_t>(get32(buffer + 10)) * 1e-7;
+        header.site_longitude = static_cast<int32_t>(get32(buffer + 14)) * 1e-7;
+        header.strikes = get32(buffer + 18);
+        header.half_life_min = get16(buffer + 22);
+        header.pairs = get16(buffer + 24);
+        if (STRIKE_DENSITY_HEADER_BYTES + 2 * static_cast<size_t>(header.pairs) > length) {
+            return false;
+        }
+
+        size_t cell = 0;
+        const uint8_t* p = buffer + STRIKE_DENSITY_HEADER_BYTES;
+        for (uint16_t i = 0; i < header.pairs; i++, p += 2) {
+            if (p[0] == 0 || cell + p[0] > CELLS) {
+                return false;
+            }
+            memset(levels + cell, p[1], p[0]);
+            cell += p[0];
+        }
+        return cell == CELLS;
+    }
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "geodesy.h"
+
+namespace Sensors {
+
+    struct StrikeDensityConfig {
+        float half_width_km;                // Grid covers +/- this around the site (100 km -> 3.1 km cells)
+        uint32_t half_life_ms;              // A strike's weight halves every half-life
+    };
+
+    // Header of an encoded density map. All fields little-endian.
+    //   0  'S' 'D'         magic
+    //   2  u8  version     STRIKE_DENSITY_FORMAT_VERSION
+    //   3  u8  grid        cells per side
+    //   4  u16 cell_m      cell size, metres
+    //   6  f32 max         decayed strike count of the densest cell
+    //  10  i32 lat, i32 lon  site, 1e-7 degrees
+    //  18  u32 strikes     strikes ever binned
+    //  22  u16 half_life   minutes
+    //  24  u16 pairs       RLE (run, level) pairs that follow
+    // Cells run row-major from the north-west corner. Level L of 0-255
+    // decodes to max * (L / 255)^2; the square root spreads the levels
+    // over the sparse tail of a storm instead of its single busiest cell.
+    static constexpr uint8_t STRIKE_DENSITY_FORMAT_VERSION = 1;
+    static constexpr size_t STRIKE_DENSITY_HEADER_BYTES = 26;
+
+    struct StrikeDensityHeader {
+        uint8_t grid;
+        uint16_t cell_m;
+        float max_density;
+        double site_latitude;
+        double site_longitude;
+        uint32_t strikes;
+        uint16_t half_life_min;
+        uint16_t pairs;
+    };
+
+    // Time-decayed strike counts on a fixed grid around the receiver.
+    // Decay is applied lazily: cells hold weights relative to m_ref_ms, and a
+    // strike at t adds 2^((t - ref) / half_life) to its cell. A read scales by
+    // 2^(-(now - ref) / half_life). When the insertion weight would exceed
+    // 2^REBASE_EXPONENT every cell is rescaled once and ref moves to t, so
+    // floats never overflow.
+    //
+    // Cost: addStrike() is one projection, one exp2f and one add, O(1).
+    // The O(CELLS) rebase runs at most once per REBASE_EXPONENT half-lives
+    // (16 h at the 1 h default). encode() is one pass over the cells.
+    // Memory: CELLS floats = 16 KiB, plus MAX_ENCODED_BYTES of caller buffer
+    // for a worst-case (noise-like) map. A single storm encodes to a few
+    // hundred bytes.
+    class StrikeDensityGrid {
+    public:
+        static constexpr size_t GRID_SIZE = 64;
+        static constexpr size_t CELLS = GRID_SIZE * GRID_SIZE;
+        static constexpr size_t MAX_ENCODED_BYTES = STRIKE_DENSITY_HEADER_BYTES + 2 * CELLS;
+        static constexpr float REBASE_EXPONENT = 16.0f;
+        static constexpr float STALE_HALF_LIVES = 32.0f;    // Older weights read as zero; the next strike clears the grid
+
+        StrikeDensityGrid();
+        explicit StrikeDensityGrid(const StrikeDensityConfig& config);
+
+        void configure(const StrikeDensityConfig& config);
+        void reset();
+
+        // Centre the grid on the receiver. Moving it by more than half a cell
+        // clears the counts; GPS jitter below that is ignored.
+        void setSite(double latitude, double longitude);
+        bool hasSite() const { return m_has_site; }
+
+        // Bin one located strike. Returns false without a site or outside the grid.
+        bool addStrike(double latitude, double longitude, uint32_t time_ms);
+        bool addStrikeLocal(float east_km, float north_km, uint32_t time_ms);
+
+        // Decayed strike count of one cell (row 0 = north edge) and of the whole grid
+        float cellDensity(size_t row, size_t col, uint32_t now_ms) const;
+        float totalDensity(uint32_t now_ms) const;
+
+        float getCellKm() const { return m_cell_km; }
+        uint32_t getTotalStrikes() const { return m_strikes; }
+        uint32_t getOutsideStrikes() const { return m_outside; }
+        uint32_t getRebaseCount() const { return m_rebases; }
+        const StrikeDensityConfig& getConfig() const { return m_config; }
+
+        // Run-length-encoded snapshot at now_ms. Returns the length, 0 if it does not fit.
+        size_t encode(uint8_t* buffer, size_t length, uint32_t now_ms) const;
+
+        // Inverse of encode(); levels receives GRID_SIZE * GRID_SIZE bytes
+        static bool decode(const uint8_t* buffer, size_t length, StrikeDensityHeader& header, uint8_t* levels);
+
+    private:
+        StrikeDensityConfig m_config;
+        float m_cells[CELLS];
+        float m_total;                      // Sum of m_cells
+        uint32_t m_ref_ms;                  // Time at which stored weights are true counts
+        float m_cell_km;
+        float m_inv_half_life;              // 1 / half_life, per ms
+
+        bool m_has_site;
+        Geodesy::Origin m_site;
+
+        uint32_t m_strikes;
+        uint32_t m_outside;
+        uint32_t m_rebases;
+
+        float halfLivesSince(uint32_t time_ms) const;
+        float decayTo(uint32_t now_ms) const;
+        void rebase(uint32_t time_ms);
+    };
+
+    extern StrikeDensityGrid g_strikeDensity;
+
+    // Defaults: 64 x 64 cells over +/- 100 km, 1 h half-life
+    StrikeDensityConfig getDefaultStrikeDensityConfig();
+}
@@ -0,0 +1,360 @@
+#include "strike_locator.h"
+#include "geodesy.h"
+#include "strike_density.h"
+#include <cmath>
+#include <cstring>
+
+namespace Sensors {
+
+    // AS3935 distance estimates; 63 means out of range
+    static const uint8_t DISTANCE_BINS[] = {1, 5, 6, 8, 10, 12, 14, 17, 20, 24, 27, 31, 34, 37, 40};
+    static constexpr size_t BIN_COUNT = sizeof(DISTANCE_BINS) / sizeof(DISTANCE_BINS[0]);
+    static constexpr uint8_t MAX_RANGE_KM = 40;
+
+    // Weak prior (1/km^2) that keeps the covariance finite when the circles only touch
+    static constexpr float COVARIANCE_PRIOR = 1.0f / (MAX_RANGE_KM * MAX_RANGE_KM);
+
+    static constexpr uint8_t MAX_STEP_HALVINGS = 5;
+
+    StrikeLocatorConfig getDefaultStrikeLocatorConfig() {
+        StrikeLocatorConfig config = {};
+        config.group_window_ms = 1500;
+        config.max_iterations = 10;
+        config.convergence_km = 0.01f;
+        config.range_error_fraction = 0.1f;
+        config.confidence_scale = 2.4477f;
+        return config;
+    }
+
+    float strikeRangeSigmaKm(uint8_t distance_km, float error_fraction) {
+        const float relative = error_fraction * distance_km;
+        for (size_t i = 0; i < BIN_COUNT; i++) {
+            if (DISTANCE_BINS[i] != distance_km) {
+                continue;
+            }
+            // Bin covers half-way to each neighbour
+            const float lower = (i == 0) ? 0.0f : 0.5f * (DISTANCE_BINS[i - 1] + DISTANCE_BINS[i]);
+            const float upper = (i + 1 == BIN_COUNT) ?
+                DISTANCE_BINS[i] + 0.5f * (DISTANCE_BINS[i] - DISTANCE_BINS[i - 1]) :
+                0.5f * (DISTANCE_BINS[i] + DISTANCE_BINS[i + 1]);
+            const float binning = fmaxf(0.5f, (upper - lower) / sqrtf(12.0f));
+            return sqrtf(binning * binning + relative * relative);
+        }
+        return fmaxf(1.0f, hypotf(0.1f * distance_km, relative));
+    }
+
+    namespace {
+        // Range circle in the local east/north frame (km)
+        struct Circle {
+            float x;
+            float y;
+            float r;
+            float w;        // 1 / sigma^2
+        };
+
+        float cost(const Circle* circles, size_t n, float x, float y) {
+            float sum = 0.0f;
+            for (size_t i = 0; i < n; i++) {
+                const float r = hypotf(x - circles[i].x, y - circles[i].y) - circles[i].r;
+                sum += circles[i].w * r * r;
+            }
+            return sum;
+        }
+
+        // Gauss-Newton normal matrix H = J'WJ and gradient g = J'Wr at (x, y)
+        void normalEquations(const Circle* circles, size_t n, float x, float y,
+                             float& h00, float& h01, float& h11, float& g0, float& g1) {
+            h00 = h01 = h11 = g0 = g1 = 0.0f;
+            for (size_t i = 0; i < n; i++) {
+                const float dx = x - circles[i].x;
+                const float dy = y - circles[i].y;
+                const float rho = fmaxf(hypotf(dx, dy), 1e-3f);
+                const float jx = dx / rho;
+                const float jy = dy / rho;
+                const float r = rho - circles[i].r;
+                const float w = circles[i].w;
+                h00 += w * jx * jx;
+                h01 += w * jx * jy;
+                h11 += w * jy * jy;
+                g0 += w * jx * r;
+                g1 += w * jy * r;
+            }
+        }
+
+        // Linearized closed form: subtracting circle k from the others leaves
+        // linear equations 2 (s_i - s_k) . p = |s_i|^2 - |s_k|^2 - r_i^2 + r_k^2
+        bool linearGuess(const Circle* circles, size_t n, size_t k, float& x, float& y) {
+            float a00 = 0.0f, a01 = 0.0f, a11 = 0.0f, b0 = 0.0f, b1 = 0.0f;
+            const Circle& ref = circles[k];
+            for (size_t i = 0; i < n; i++) {
+                if (i == k) {
+                    continue;
+                }
+                const float ax = 2.0f * (circles[i].x - ref.x);
+                const float ay = 2.0f * (circles[i].y - ref.y);
+                const float b = (circles[i].x * circles[i].x + circles[i].y * circles[i].y) -
+                                (ref.x * ref.x + ref.y * ref.y) -
+                                circles[i].r * circles[i].r + ref.r * ref.r;
+                const float w = circles[i].w;
+                a00 += w * ax * ax;
+                a01 += w * ax * ay;
+                a11 += w * ay * ay;
+                b0 += w * ax * b;
+                b1 += w * ay * b;
+            }
+            const float det = a00 * a11 - a01 * a01;
+            if (det <= 1e-4f * (a00 + a11) * (a00 + a11)) {
+                return false;   // Stations (nearly) collinear
+            }
+            x = (a11 * b0 - a01 * b1) / det;
+            y = (a00 * b1 - a01 * b0) / det;
+            return true;
+        }
+
+        // Both intersections of circles a and b (tangent point twice if they miss)
+        bool intersect(const Circle& a, const Circle& b, float p[2][2]) {
+            const float ux = b.x - a.x;
+            const float uy = b.y - a.y;
+            const float baseline = hypotf(ux, uy);
+            if (baseline < 1e-3f) {
+                return false;
+            }
+            const float along = (a.r * a.r - b.r * b.r + baseline * baseline) / (2.0f * baseline);
+            const float across = sqrtf(fmaxf(0.0f, a.r * a.r - along * along));
+            const float ex = ux / baseline;
+            const float ey = uy / baseline;
+            for (int s = 0; s < 2; s++) {
+                const float sign = s ? -1.0f : 1.0f;
+                p[s][0] = a.x + along * ex - sign * across * ey;
+                p[s][1] = a.y + along * ey + sign * across * ex;
+            }
+            return true;
+        }
+    }
+
+    StrikeLocation StrikeLocator::solve(const StationReport* reports, size_t count,
+                                        const StrikeLocatorConfig& config, const StrikeLocation* prior) {
+        StrikeLocation location = {};
+        if (count == 0) {
+            return location;
+        }
+        if (count > MAX_STATIONS) {
+            count = MAX_STATIONS;
+        }
+        location.time_ms = reports[0].time_ms;
+
+        // Frame origin: mean station position
+        double lat0 = 0.0, lon0 = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            lat0 += reports[i].latitude / count;
+            lon0 += reports[i].longitude / count;
+        }
+        const Geodesy::Origin frame = Geodesy::makeOrigin(lat0, lon0);
+
+        Circle circles[MAX_STATIONS];
+        Circle beyond[MAX_STATIONS];        // Stations that saw it beyond range
+        size_t n = 0, n_beyond = 0;
+        size_t best = 0;
+        for (size_t i = 0; i < count; i++) {
+            Circle circle = {};
+            Geodesy::toLocalKm(frame, reports[i].latitude, reports[i].longitude, circle.x, circle.y);
+            if (reports[i].distance_km > MAX_RANGE_KM) {
+                circle.r = MAX_RANGE_KM;
+                beyond[n_beyond++] = circle;
+                continue;
+            }
+            const float sigma = strikeRangeSigmaKm(reports[i].distance_km, config.range_error_fraction);
+            circle.r = reports[i].distance_km;
+            circle.w = 1.0f / (sigma * sigma);
+            if (n == 0 || circle.w > circles[best].w) {
+                best = n;
+            }
+            circles[n++] = circle;
+        }
+        location.stations = static_cast<uint8_t>(n);
+        location.out_of_range = static_cast<uint8_t>(n_beyond);
+        if (n < 2) {
+            return location;
+        }
+
+        // Initial guess: linearized closed form, or the better of the two
+        // intersections of the most precise pair when the stations are collinear
+        float x = 0.0f, y = 0.0f;
+        if (n < 3 || !linearGuess(circles, n, best, x, y)) {
+            const size_t other = (best == 0) ? 1 : 0;
+            size_t partner = other;
+            for (size_t i = 0; i < n; i++) {
+                if (i != best && circles[i].w > circles[partner].w) {
+                    partner = i;
+                }
+            }
+            float candidates[2][2];
+            if (!intersect(circles[best], circles[partner], candidates)) {
+                return location;
+            }
+
+            // Rank: violated "beyond range" reports, then full cost, then distance to the prior
+            float score[2];
+            for (int s = 0; s < 2; s++) {
+                uint8_t violations = 0;
+                for (size_t i = 0; i < n_beyond; i++) {
+                    if (hypotf(candidates[s][0] - beyond[i].x, candidates[s][1] - beyond[i].y) < beyond[i].r) {
+                        violations++;
+                    }
+                }
+                score[s] = violations * 1e6f + cost(circles, n, candidates[s][0], candidates[s][1]);
+            }
+
+            const float separation = hypotf(candidates[0][0] - candidates[1][0], candidates[0][1] - candidates[1][1]);
+            const bool tie = fabsf(score[0] - score[1]) < 1.0f && separation > 1.0f;
+            int pick = (score[1] < score[0]) ? 1 : 0;
+            if (tie) {
+                location.ambiguous = true;
+                if (prior && prior->valid) {
+                    float px, py;
+                    Geodesy::toLocalKm(frame, prior->latitude, prior->longitude, px, py);
+                    pick = (hypotf(candidates[1][0] - px, candidates[1][1] - py) <
+                            hypotf(candidates[0][0] - px, candidates[0][1] - py)) ? 1 : 0;
+                }
+            }
+            x = candidates[pick][0];
+            y = candidates[pick][1];
+        }
+
+        // Gauss-Newton with step halving
+        float h00, h01, h11, g0, g1;
+        float current = cost(circles, n, x, y);
+        for (uint8_t iteration = 0; iteration < config.max_iterations; iteration++) {
+            location.iterations = iteration + 1;
+            normalEquations(circles, n, x, y, h00, h01, h11, g0, g1);
+            const float det = h00 * h11 - h01 * h01;
+            if (det <= 1e-9f * (h00 + h11) * (h00 + h11)) {
+                break;      // Circles tangent: no information across the baseline
+            }
+            float dx = -(h11 * g0 - h01 * g1) / det;
+            float dy = -(h00 * g1 - h01 * g0) / det;
+
+            float next = cost(circles, n, x + dx, y + dy);
+            for (uint8_t halving = 0; next > current && halving < MAX_STEP_HALVINGS; halving++) {
+                dx *= 0.5f;
+                dy *= 0.5f;
+                next = cost(circles, n, x + dx, y + dy);
+            }
+            if (next > current) {
+                location.converged = true;      // No descent left: at the minimum
+                break;
+            }
+            x += dx;
+            y += dy;
+            current = next;
+            if (hypotf(dx, dy) < config.convergence_km) {
+                location.converged = true;
+                break;
+            }
+        }
+
+        // Covariance s^2 (H + prior)^-1, scaled up (never down) by the reduced chi-square
+        normalEquations(circles, n, x, y, h00, h01, h11, g0, g1);
+        h00 += COVARIANCE_PRIOR;
+        h11 += COVARIANCE_PRIOR;
+        const float det = h00 * h11 - h01 * h01;
+        const float scale = (n > 2) ? fmaxf(1.0f, current / (n - 2)) : 1.0f;
+        const float c00 = scale * h11 / det;
+        const float c11 = scale * h00 / det;
+        const float c01 = -scale * h01 / det;
+
+        const float mean = 0.5f * (c00 + c11);
+        const float spread = sqrtf(0.25f * (c00 - c11) * (c00 - c11) + c01 * c01);
+        location.semi_major_km = config.confidence_scale * sqrtf(mean + spread);
+        location.semi_minor_km = config.confidence_scale * sqrtf(fmaxf(0.0f, mean - spread));
+
+        // Major axis angle from east (counter-clockwise) to bearing from north (clockwise)
+        const float theta_deg = 0.5f * atan2f(2.0f * c01, c00 - c11) * 180.0f / static_cast<float>(M_PI);
+        float bearing = 90.0f - theta_deg;
+        while (bearing >= 180.0f) {
+            bearing -= 180.0f;
+        }
+        while (bearing < 0.0f) {
+            bearing += 180.0f;
+        }
+        location.orientation_deg = bearing;
+
+        float weight_sum = 0.0f;
+        for (size_t i = 0; i < n; i++) {
+            weight_sum += circles[i].w;
+        }
+        location.residual_km = sqrtf(current / weight_sum);
+
+        Geodesy::fromLocalKm(frame, x, y, location.latitude, location.longitude);
+        location.valid = true;
+        return location;
+    }
+
+    StrikeLocator::StrikeLocator() : m_density(nullptr) {
+        configure(getDefaultStrikeLocatorConfig());
+    }
+
+    StrikeLocator::StrikeLocator(const StrikeLocatorConfig& config) : m_density(nullptr) {
+        configure(config);
+    }
+
+    void StrikeLocator::configure(const StrikeLocatorConfig& config) {
+        m_config = config;
+        reset();
+    }
+
+    void StrikeLocator::reset() {
+        memset(&m_stats, 0, sizeof(m_stats));
+        memset(&m_last, 0, sizeof(m_last));
+        memset(&m_prior, 0, sizeof(m_prior));
+        m_pending_count = 0;
+    }
+
+    bool StrikeLocator::addReport(const StationReport& report) {
+        bool closed = false;
+        if (m_pending_count > 0 && report.time_ms - m_pending[0].time_ms > m_config.group_window_ms) {
+            closeEvent();
+            closed = true;
+        }
+
+        for (size_t i = 0; i < m_pending_count; i++) {
+            if (m_pending[i].station_id == report.station_id) {
+                m_stats.duplicates++;
+                return closed;
+            }
+        }
+        if (m_pending_count < MAX_STATIONS) {
+            m_pending[m_pending_count++] = report;
+        }
+        return closed;
+    }
+
+    bool StrikeLocator::update(uint32_t now_ms) {
+        if (m_pending_count == 0 || now_ms - m_pending[0].time_ms < m_config.group_window_ms) {
+            return false;
+        }
+        closeEvent();
+        return true;
+    }
+
+    void StrikeLocator::closeEvent() {
+        m_stats.events++;
+        m_last = solve(m_pending, m_pending_count, m_config, &m_prior);
+        m_pending_count = 0;
+
+        if (m_last.valid) {
+            m_stats.located++;
+            if (m_last.ambiguous) {
+                m_stats.ambiguous++;
+            }
+            m_prior = m_last;
+            if (m_density) {
+                m_density->addStrike(m_last.latitude, m_last.longitude, m_last.time_ms);
+            }
+        } else if (m_last.stations < 2) {
+            m_stats.too_few_stations++;
+        } else {
+            m_stats.failed++;
+        }
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Sensors {
+
+    class StrikeDensityGrid;
+
+    // One station's AS3935 report as received over LoRa
+    struct StationReport {
+        uint16_t station_id;
+        double latitude;                    // Station GPS position (GPS::Data), degrees
+        double longitude;
+        uint8_t distance_km;                // AS3935 distance bin, 63 = out of range
+        uint32_t time_ms;                   // Detection time on the receiver clock
+    };
+
+    struct StrikeLocatorConfig {
+        uint32_t group_window_ms;           // Reports within this of the first one form one event
+        uint8_t max_iterations;             // Gauss-Newton iteration cap
+        float convergence_km;               // Stop when the step is shorter than this
+        float range_error_fraction;         // AS3935 estimate error beyond binning, fraction of range
+        float confidence_scale;             // Ellipse radius in sigmas (2.4477 = 95% for 2 dof)
+    };
+
+    // Estimated strike position
+    struct StrikeLocation {
+        bool valid;
+        bool converged;
+        bool ambiguous;                     // Two-station fix: mirror solution was also possible
+        double latitude;
+        double longitude;
+        float semi_major_km;                // Confidence ellipse
+        float semi_minor_km;
+        float orientation_deg;              // Major axis bearing, 0-180 clockwise from north
+        float residual_km;                  // Weighted RMS range residual
+        uint8_t stations;                   // In-range reports used in the fit
+        uint8_t out_of_range;               // Reports of "beyond 40 km"
+        uint8_t iterations;
+        uint32_t time_ms;                   // First report of the event
+    };
+
+    struct StrikeLocatorStats {
+        uint32_t events;                    // Report groups closed
+        uint32_t located;
+        uint32_t ambiguous;
+        uint32_t too_few_stations;          // Fewer than two in-range reports
+        uint32_t failed;                    // Degenerate geometry
+        uint32_t duplicates;                // Second report from a station within one event
+    };
+
+    // Groups near-simultaneous reports from different stations into one event
+    // and locates it by weighted least-squares trilateration of the AS3935
+    // range circles. Ranges are weighted by the width of their distance bin.
+    // Geometry is solved in a local east/north plane (km) around the stations;
+    // at AS3935 ranges the flat-earth error is well below the bin width.
+    class StrikeLocator {
+    public:
+        static constexpr size_t MAX_STATIONS = 16;
+
+        StrikeLocator();
+        explicit StrikeLocator(const StrikeLocatorConfig& config);
+
+        void configure(const StrikeLocatorConfig& config);
+        void reset();
+
+        // Located strikes are also binned into this density map (optional)
+        void setDensityGrid(StrikeDensityGrid* grid) { m_density = grid; }
+
+        // Buffer a report. Returns true when it closed the previous event
+        // (its result is in getLastLocation()).
+        bool addReport(const StationReport& report);
+
+        // Close the pending event once its window has passed; returns true if it did
+        bool update(uint32_t now_ms);
+
+        const StrikeLocation& getLastLocation() const { return m_last; }
+        const StrikeLocatorStats& getStats() const { return m_stats; }
+        const StrikeLocatorConfig& getConfig() const { return m_config; }
+
+        // Locate one event. prior (optional) breaks the two-station mirror ambiguity.
+        static StrikeLocation solve(const StationReport* reports, size_t count,
+                                    const StrikeLocatorConfig& config, const StrikeLocation* prior = nullptr);
+
+    private:
+        StrikeLocatorConfig m_config;
+        StrikeLocatorStats m_stats;
+        StrikeLocation m_last;
+        StrikeLocation m_prior;             // Last valid fix
+
+        StationReport m_pending[MAX_STATIONS];
+        size_t m_pending_count;
+
+        StrikeDensityGrid* m_density;
+
+        void closeEvent();
+    };
+
+    // 1-sigma range error of an AS3935 report: bin width (uniform over the bin)
+    // combined with a relative estimate error
+    float strikeRangeSigmaKm(uint8_t distance_km, float error_fraction = 0.0f);
+
+    // Defaults: 1.5 s grouping window, 10 iterations, 10 m convergence, 10% range error, 95% ellipse
+    StrikeLocatorConfig getDefaultStrikeLocatorConfig();
+}
@@ -0,0 +1,389 @@
+#include "tdoa_locator.h"
+#include "geodesy.h"
+#include <cmath>
+#include <cstring>
+
+namespace Sensors {
+
+    static constexpr uint8_t MAX_STEP_HALVINGS = 5;
+    static constexpr size_t SAMPLE_SIZE = 4;            // Minimal overdetermined-free TDOA sample in 2D
+    static constexpr uint8_t MULTI_START_POINTS = 8;    // Ring of starts for three-station solves
+    static constexpr uint8_t MAX_RESELECT_PASSES = 3;
+
+    TdoaConfig getDefaultTdoaConfig() {
+        TdoaConfig config = {};
+        config.timing_sigma_us = 1.0f;
+        config.inlier_sigmas = 4.0f;
+        config.ransac_iterations = 32;
+        config.max_iterations = 10;
+        config.convergence_km = 0.001f;
+        return config;
+    }
+
+    namespace {
+        // Stations in the local plane with pseudoranges c * (t_i - t_min), all km
+        struct Problem {
+            float x[TdoaLocator::MAX_STATIONS];
+            float y[TdoaLocator::MAX_STATIONS];
+            float rho[TdoaLocator::MAX_STATIONS];
+            size_t count;
+        };
+
+        // Position and range bias b = c * (t_emit - t_min)
+        struct State {
+            float x;
+            float y;
+            float b;
+        };
+
+        float residual(const Problem& p, size_t i, const State& s) {
+            return hypotf(s.x - p.x[i], s.y - p.y[i]) + s.b - p.rho[i];
+        }
+
+        float cost(const Problem& p, uint16_t mask, const State& s) {
+            float sum = 0.0f;
+            for (size_t i = 0; i < p.count; i++) {
+                if (mask & (1u << i)) {
+                    const float e = residual(p, i, s);
+                    sum += e * e;
+                }
+            }
+            return sum;
+        }
+
+        // Symmetric 3x3 solve (Cramer); a is row-major
+        bool solve3(const float a[9], const float rhs[3], float out[3], float inverse[9] = nullptr) {
+            const float c00 = a[4] * a[8] - a[5] * a[7];
+            const float c01 = a[5] * a[6] - a[3] * a[8];
+            const float c02 = a[3] * a[7] - a[4] * a[6];
+            const float det = a[0] * c00 + a[1] * c01 + a[2] * c02;
+            const float scale = a[0] + a[4] + a[8];
+            if (!(fabsf(det) > 1e-9f * scale * scale * scale)) {
+                return false;
+            }
+            const float inv[9] = {
+                c00 / det, (a[2] * a[7] - a[1] * a[8]) / det, (a[1] * a[5] - a[2] * a[4]) / det,
+                c01 / det, (a[0] * a[8] - a[2] * a[6]) / det, (a[2] * a[3] - a[0] * a[5]) / det,
+                c02 / det, (a[1] * a[6] - a[0] * a[7]) / det, (a[0] * a[4] - a[1] * a[3]) / det,
+            };
+            for (int r = 0; r < 3; r++) {
+                out[r] = inv[3 * r] * rhs[0] + inv[3 * r + 1] * rhs[1] + inv[3 * r + 2] * rhs[2];
+            }
+            if (inverse) {
+                memcpy(inverse, inv, sizeof(inv));
+            }
+            return true;
+        }
+
+        // Subtracting the squared range equation of station k removes |p|^2 and b^2:
+        // 2 (s_i - s_k) . p - 2 (rho_i - rho_k) b = |s_i|^2 - |s_k|^2 - rho_i^2 + rho_k^2
+        bool linearGuess(const Problem& p, uint16_t mask, State& s) {
+            size_t k = p.count;
+            for (size_t i = 0; i < p.count; i++) {
+                if (mask & (1u << i)) {
+                    k = i;
+                    break;
+                }
+            }
+            if (k == p.count) {
+                return false;
+            }
+
+            float ata[9] = {};
+            float atb[3] = {};
+            const float sk = p.x[k] * p.x[k] + p.y[k] * p.y[k];
+            for (size_t i = 0; i < p.count; i++) {
+                if (i == k || !(mask & (1u << i))) {
+                    continue;
+                }
+                const float row[3] = {2.0f * (p.x[i] - p.x[k]), 2.0f * (p.y[i] - p.y[k]), -2.0f * (p.rho[i] - p.rho[k])};
+                const float rhs = p.x[i] * p.x[i] + p.y[i] * p.y[i] - sk - p.rho[i] * p.rho[i] + p.rho[k] * p.rho[k];
+                for (int r = 0; r < 3; r++) {
+                    for (int c = 0; c < 3; c++) {
+                        ata[3 * r + c] += row[r] * row[c];
+                    }
+                    atb[r] += row[r] * rhs;
+                }
+            }
+            float out[3];
+            if (!solve3(ata, atb, out)) {
+                return false;
+            }
+            s.x = out[0];
+            s.y = out[1];
+            s.b = out[2];
+            return true;
+        }
+
+        // Normal matrix J'J and gradient J'e over the masked stations
+        void normalEquations(const Problem& p, uint16_t mask, const State& s, float h[9], float g[3]) {
+            memset(h, 0, 9 * sizeof(float));
+            memset(g, 0, 3 * sizeof(float));
+            for (size_t i = 0; i < p.count; i++) {
+                if (!(mask & (1u << i))) {
+                    continue;
+                }
+                const float dx = s.x - p.x[i];
+                const float dy = s.y - p.y[i];
+                const float d = fmaxf(hypotf(dx, dy), 1e-3f);
+                const float j[3] = {dx / d, dy / d, 1.0f};
+                const float e = d + s.b - p.rho[i];
+                for (int r = 0; r < 3; r++) {
+                    for (int c = 0; c < 3; c++) {
+                        h[3 * r + c] += j[r] * j[c];
+                    }
+                    g[r] += j[r] * e;
+                }
+            }
+        }
+
+        // Gauss-Newton with step halving; returns the final cost
+        float refine(const Problem& p, uint16_t mask, State& s, uint8_t max_iterations, float convergence_km,
+                     uint8_t& iterations, bool& converged) {
+            float current = cost(p, mask, s);
+            iterations = 0;
+            converged = false;
+            float h[9], g[3], step[3];
+            for (uint8_t it = 0; it < max_iterations; it++) {
+                iterations = it + 1;
+                normalEquations(p, mask, s, h, g);
+                if (!solve3(h, g, step)) {
+                    break;
+                }
+                State next = {s.x - step[0], s.y - step[1], s.b - step[2]};
+                float next_cost = cost(p, mask, next);
+                for (uint8_t halving = 0; next_cost > current && halving < MAX_STEP_HALVINGS; halving++) {
+                    step[0] *= 0.5f;
+                    step[1] *= 0.5f;
+                    step[2] *= 0.5f;
+                    next = {s.x - step[0], s.y - step[1], s.b - step[2]};
+                    next_cost = cost(p, mask, next);
+                }
+                if (next_cost > current) {
+                    converged = true;       // No descent left
+                    break;
+                }
+                s = next;
+                current = next_cost;
+                if (hypotf(step[0], step[1]) < convergence_km) {
+                    converged = true;
+                    break;
+                }
+            }
+            return current;
+        }
+
+        // Bias that best fits a position: mean of rho_i - |p - s_i|
+        float fitBias(const Problem& p, uint16_t mask, float x, float y) {
+            float sum = 0.0f;
+            uint8_t n = 0;
+            for (size_t i = 0; i < p.count; i++) {
+                if (mask & (1u << i)) {
+                    sum += p.rho[i] - hypotf(x - p.x[i], y - p.y[i]);
+                    n++;
+                }
+            }
+            return n ? sum / n : 0.0f;
+        }
+
+        uint8_t popcount(uint16_t mask) {
+            uint8_t n = 0;
+            for (; mask; mask &= mask - 1) {
+                n++;
+            }
+            return n;
+        }
+
+        // Stations consistent with a fit over fit_mask. A station's residual is
+        // compared with its predicted spread sigma * sqrt(1 + j' (J'J)^-1 j): a
+        // station outside the fit that the geometry leans on gets a wider gate.
+        uint16_t inliers(const Problem& p, uint16_t fit_mask, const State& s, float sigma_km, float k) {
+            float h[9], g[3], unused[3], covariance[9];
+            normalEquations(p, fit_mask, s, h, g);
+            const bool have_covariance = solve3(h, g, unused, covariance);
+
+            uint16_t mask = 0;
+            for (size_t i = 0; i < p.count; i++) {
+                float spread = 1.0f;
+                if (have_covariance && !(fit_mask & (1u << i))) {
+                    const float dx = s.x - p.x[i];
+                    const float dy = s.y - p.y[i];
+                    const float d = fmaxf(hypotf(dx, dy), 1e-3f);
+                    const float j[3] = {dx / d, dy / d, 1.0f};
+                    float leverage = 0.0f;
+                    for (int r = 0; r < 3; r++) {
+                        for (int c = 0; c < 3; c++) {
+                            leverage += j[r] * covariance[3 * r + c] * j[c];
+                        }
+                    }
+                    spread = sqrtf(1.0f + fmaxf(0.0f, leverage));
+                }
+                if (fabsf(residual(p, i, s)) <= k * sigma_km * spread) {
+                    mask |= 1u << i;
+                }
+            }
+            return mask;
+        }
+    }
+
+    TdoaLocator::TdoaLocator() {
+        configure(getDefaultTdoaConfig());
+    }
+
+    TdoaLocator::TdoaLocator(const TdoaConfig& config) {
+        configure(config);
+    }
+
+    void TdoaLocator::configure(const TdoaConfig& config) {
+        m_config = config;
+    }
+
+    TdoaSolution TdoaLocator::solve(const TdoaDetection* detections, size_t count) const {
+        TdoaSolution solution = {};
+        if (count > MAX_STATIONS) {
+            count = MAX_STATIONS;
+        }
+        if (count < MIN_STATIONS) {
+            return solution;
+        }
+
+        // Local frame around the stations, times relative to the first arrival
+        double lat0 = 0.0, lon0 = 0.0;
+        int64_t t_ref = detections[0].arrival_ns;
+        for (size_t i = 0; i < count; i++) {
+            lat0 += detections[i].latitude / count;
+            lon0 += detections[i].longitude / count;
+            if (detections[i].arrival_ns < t_ref) {
+                t_ref = detections[i].arrival_ns;
+            }
+        }
+        const Geodesy::Origin frame = Geodesy::makeOrigin(lat0, lon0);
+
+        Problem problem = {};
+        problem.count = count;
+        float spread_km = 0.0f;
+        for (size_t i = 0; i < count; i++) {
+            Geodesy::toLocalKm(frame, detections[i].latitude, detections[i].longitude, problem.x[i], problem.y[i]);
+            problem.rho[i] = static_cast<float>(detections[i].arrival_ns - t_ref) * 1e-3f * TDOA_PROPAGATION_KM_PER_US;
+            spread_km = fmaxf(spread_km, hypotf(problem.x[i], problem.y[i]));
+        }
+
+        const uint16_t all = static_cast<uint16_t>((1u << count) - 1);
+        const float sigma_km = m_config.timing_sigma_us * TDOA_PROPAGATION_KM_PER_US;
+        uint16_t mask = all;
+        State state = {};
+        bool seeded = false;
+
+        if (count > SAMPLE_SIZE) {
+            // RANSAC: four-station hypotheses scored by consensus, then by fit cost.
+            // The sampler is seeded from the arrival times so a solve is reproducible.
+            uint32_t rng = static_cast<uint32_t>(t_ref) ^ static_cast<uint32_t>(count * 0x9E3779B9u);
+            if (rng == 0) {
+                rng = 1;
+            }
+            uint8_t best_count = 0;
+            float best_cost = INFINITY;
+            for (uint8_t it = 0; it < m_config.ransac_iterations; it++) {
+                uint16_t sample = 0;
+                while (popcount(sample) < SAMPLE_SIZE) {
+                    rng ^= rng << 13;
+                    rng ^= rng >> 17;
+                    rng ^= rng << 5;
+                    sample |= 1u << (rng % count);
+                }
+                State hypothesis;
+                if (!linearGuess(problem, sample, hypothesis)) {
+                    continue;
+                }
+                const uint16_t support = inliers(problem, sample, hypothesis, sigma_km, m_config.inlier_sigmas);
+                const uint8_t support_count = popcount(support);
+                const float support_cost = cost(problem, support, hypothesis);
+                if (support_count > best_count || (support_count == best_count && support_cost < best_cost)) {
+                    best_count = support_count;
+                    best_cost = support_cost;
+                    mask = support;
+                    state = hypothesis;
+                    seeded = true;
+                }
+                if (best_count == count) {
+                    break;
+                }
+            }
+            if (best_count < SAMPLE_SIZE) {
+                mask = all;         // No consensus: fit everything and let the quality metric show it
+                seeded = false;
+            }
+        }
+
+        if (!seeded && popcount(mask) >= SAMPLE_SIZE) {
+            seeded = linearGuess(problem, mask, state);
+        }
+
+        uint8_t iterations = 0;
+        bool converged = false;
+        float final_cost;
+        if (seeded) {
+            final_cost = refine(problem, mask, state, m_config.max_iterations, m_config.convergence_km, iterations, converged);
+
+            // Re-select against the refined fit, which may admit or drop stations
+            for (uint8_t pass = 0; count > SAMPLE_SIZE && pass < MAX_RESELECT_PASSES; pass++) {
+                const uint16_t reselected = inliers(problem, mask, state, sigma_km, m_config.inlier_sigmas);
+                if (reselected == mask || popcount(reselected) < SAMPLE_SIZE) {
+                    break;
+                }
+                mask = reselected;
+                uint8_t more = 0;
+                final_cost = refine(problem, mask, state, m_config.max_iterations, m_config.convergence_km, more, converged);
+                iterations += more;
+            }
+        } else {
+            // Three stations (or collinear): multi-start from the centroid and a ring around it
+            final_cost = INFINITY;
+            const float radius = fmaxf(2.0f * spread_km, 10.0f);
+            for (uint8_t k = 0; k <= MULTI_START_POINTS; k++) {
+                State start = {};
+                if (k > 0) {
+                    const float angle = 2.0f * static_cast<float>(M_PI) * k / MULTI_START_POINTS;
+                    start.x = radius * cosf(angle);
+                    start.y = radius * sinf(angle);
+                }
+                start.b = fitBias(problem, mask, start.x, start.y);
+                uint8_t used = 0;
+                bool done = false;
+                const float start_cost = refine(problem, mask, start, m_config.max_iterations,
+                                                m_config.convergence_km, used, done);
+                iterations += used;
+                // Prefer the lower cost; on a tie (exactly determined) the solution nearer the network
+                const bool tie = fabsf(start_cost - final_cost) < 1e-4f;
+                if (start_cost < final_cost - 1e-4f ||
+                    (tie && hypotf(start.x, start.y) < hypotf(state.x, state.y))) {
+                    final_cost = start_cost;
+                    state = start;
+                    converged = done;
+                }
+            }
+        }
+
+        // Quality: residual RMS and chi-square per degree of freedom; covariance from (J'J)^-1
+        const uint8_t used = popcount(mask);
+        float h[9], g[3], unused[3], covariance[9];
+        normalEquations(problem, mask, state, h, g);
+        if (!solve3(h, g, unused, covariance)) {
+            return solution;
+        }
+
+        solution.valid = true;
+        solution.converged = converged;
+        solution.iterations = iterations;
+        solution.stations = used;
+        solution.rejected = static_cast<uint8_t>(count - used);
+        solution.inlier_mask = mask;
+        solution.residual_us = sqrtf(final_cost / used) / TDOA_PROPAGATION_KM_PER_US;
+        solution.chi2_dof = (used > 3) ? final_cost / ((used - 3) * sigma_km * sigma_km) : 0.0f;
+        solution.hdop = sqrtf(fmaxf(0.0f, covariance[0] + covariance[4]));
+        solution.horizontal_sigma_km = solution.hdop * sigma_km * sqrtf(fmaxf(1.0f, solution.chi2_dof));
+        solution.strike_ns = t_ref + static_cast<int64_t>(state.b / TDOA_PROPAGATION_KM_PER_US * 1000.0f);
+        Geodesy::fromLocalKm(frame, state.x, state.y, solution.latitude, solution.longitude);
+        return solution;
+    }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Sensors {
+
+    // Sferic propagation speed (km/us); ground-wave VLF travels at ~c
+    static constexpr float TDOA_PROPAGATION_KM_PER_US = 0.299792f;
+
+    // GPS-timestamped IRQ edge from one station
+    struct TdoaDetection {
+        uint16_t station_id;
+        double latitude;                    // Station GPS position, degrees
+        double longitude;
+        int64_t arrival_ns;                 // GPS time of the interrupt edge
+    };
+
+    struct TdoaConfig {
+        float timing_sigma_us;              // 1-sigma timestamp jitter per station
+        float inlier_sigmas;                // RANSAC inlier gate, in timing sigmas
+        uint8_t ransac_iterations;          // Minimal-sample hypotheses per solve
+        uint8_t max_iterations;             // Gauss-Newton iteration cap
+        float convergence_km;
+    };
+
+    struct TdoaSolution {
+        bool valid;
+        bool converged;
+        double latitude;
+        double longitude;
+        int64_t strike_ns;                  // Estimated emission time
+        float residual_us;                  // RMS arrival-time residual over the inliers
+        float chi2_dof;                     // Residual variance / timing_sigma^2 (~1 when consistent)
+        float hdop;                         // Geometry factor: sigma_h = hdop * c * timing_sigma
+        float horizontal_sigma_km;          // 1-sigma horizontal uncertainty
+        uint8_t stations;                   // Inliers used in the final fit
+        uint8_t rejected;                   // Stations RANSAC found inconsistent
+        uint16_t inlier_mask;               // Bit i = detection i used
+        uint8_t iterations;
+    };
+
+    // Hyperbolic (time-difference-of-arrival) strike localization.
+    // Unknowns are east/north position and emission time; pseudoranges
+    // c * (t_i - t_min) are solved in a local plane around the stations.
+    // With four or more stations a closed-form linearization seeds the
+    // iterative least squares; three stations use a small multi-start.
+    // From five stations up, RANSAC over four-station subsets rejects
+    // detections that disagree with the consensus (wrong edge, bad PPS).
+    class TdoaLocator {
+    public:
+        static constexpr size_t MAX_STATIONS = 16;
+        static constexpr size_t MIN_STATIONS = 3;
+
+        TdoaLocator();
+        explicit TdoaLocator(const TdoaConfig& config);
+
+        void configure(const TdoaConfig& config);
+        const TdoaConfig& getConfig() const { return m_config; }
+
+        TdoaSolution solve(const TdoaDetection* detections, size_t count) const;
+
+    private:
+        TdoaConfig m_config;
+    };
+
+    // Defaults: 1 us timing, 4-sigma inlier gate, 32 RANSAC hypotheses, 10 iterations
+    TdoaConfig getDefaultTdoaConfig();
+}
@@ -0,0 +1,378 @@
+#include "time_series_store.h"
+#include <cmath>
+#include <cstring>
+
+namespace SensorSystem {
+
+    namespace {
+        // MSB-first bit packing into a block payload
+        void writeBits(uint8_t* data, uint32_t& bit, uint32_t value, uint8_t count) {
+            while (count > 0) {
+                const uint8_t room = 8 - (bit & 7);
+                const uint8_t take = count < room ? count : room;
+                const uint8_t chunk = static_cast<uint8_t>((value >> (count - take)) & ((1u << take) - 1));
+                data[bit >> 3] |= static_cast<uint8_t>(chunk << (room - take));
+                bit += take;
+                count -= take;
+            }
+        }
+
+        uint32_t readBits(const uint8_t* data, uint32_t& bit, uint8_t count) {
+            uint32_t value = 0;
+            while (count > 0) {
+                const uint8_t room = 8 - (bit & 7);
+                const uint8_t take = count < room ? count : room;
+                const uint8_t chunk = static_cast<uint8_t>((data[bit >> 3] >> (room - take)) & ((1u << take) - 1));
+                value = (value << take) | chunk;
+                bit += take;
+                count -= take;
+            }
+            return value;
+        }
+
+        uint8_t leadingZeros(uint32_t x) {
+            uint8_t n = 0;
+            for (uint32_t mask = 0x80000000u; mask && !(x & mask); mask >>= 1) {
+                n++;
+            }
+            return n;
+        }
+
+        uint8_t trailingZeros(uint32_t x) {
+            uint8_t n = 0;
+            for (uint32_t mask = 1; mask && !(x & mask); mask <<= 1) {
+                n++;
+            }
+            return n;
+        }
+
+        // Delta-of-delta buckets: '0', '10'+7, '110'+9, '1110'+12, '1111'+32
+        void writeDod(uint8_t* data, uint32_t& bit, int32_t dod) {
+            if (dod == 0) {
+                writeBits(data, bit, 0, 1);
+            } else if (dod >= -64 && dod <= 63) {
+                writeBits(data, bit, 0x2, 2);
+                writeBits(data, bit, static_cast<uint32_t>(dod) & 0x7F, 7);
+            } else if (dod >= -256 && dod <= 255) {
+                writeBits(data, bit, 0x6, 3);
+                writeBits(data, bit, static_cast<uint32_t>(dod) & 0x1FF, 9);
+            } else if (dod >= -2048 && dod <= 2047) {
+                writeBits(data, bit, 0xE, 4);
+                writeBits(data, bit, static_cast<uint32_t>(dod) & 0xFFF, 12);
+            } else {
+                writeBits(data, bit, 0xF, 4);
+                writeBits(data, bit, static_cast<uint32_t>(dod), 32);
+            }
+        }
+
+        int32_t signExtend(uint32_t value, uint8_t bits) {
+            const uint32_t sign = 1u << (bits - 1);
+            return static_cast<int32_t>((value ^ sign) - sign);
+        }
+
+        int32_t readDod(const uint8_t* data, uint32_t& bit) {
+            if (readBits(data, bit, 1) == 0) {
+                return 0;
+            }
+            if (readBits(data, bit, 1) == 0) {
+                return signExtend(readBits(data, bit, 7), 7);
+            }
+            if (readBits(data, bit, 1) == 0) {
+                return signExtend(readBits(data, bit, 9), 9);
+            }
+            if (readBits(data, bit, 1) == 0) {
+                return signExtend(readBits(data, bit, 12), 12);
+            }
+            return static_cast<int32_t>(readBits(data, bit, 32));
+        }
+    }
+
+    TimeSeriesChannelConfig makeTimeSeriesChannel(const char* name, const char* unit, size_t budget_bytes,
+                                                  uint32_t resolution_ms, float quantum) {
+        TimeSeriesChannelConfig config = {};
+        config.name = name;
+        config.unit = unit;
+        config.budget_bytes = budget_bytes;
+        config.resolution_ms = resolution_ms;
+        config.quantum = quantum;
+        return config;
+    }
+
+    TimeSeriesStore::TimeSeriesStore() {
+        reset();
+    }
+
+    void TimeSeriesStore::reset() {
+        memset(m_blocks, 0, sizeof(m_blocks));
+        memset(m_channels, 0, sizeof(m_channels));
+        m_blocks_used = 0;
+        m_channel_count = 0;
+    }
+
+    int TimeSeriesStore::addChannel(const TimeSeriesChannelConfig& config) {
+        const size_t blocks = config.budget_bytes / BLOCK_BYTES;
+        if (m_channel_count >= MAX_CHANNELS || blocks < 2 || m_blocks_used + blocks > ARENA_BLOCKS ||
+            config.resolution_ms == 0 || config.quantum < 0.0f) {
+            return -1;
+        }
+        Channel& channel = m_channels[m_channel_count];
+        memset(&channel, 0, sizeof(channel));
+        channel.config = config;
+        channel.first_block = m_blocks_used;
+        channel.block_count = blocks;
+        m_blocks_used += blocks;
+        return static_cast<int>(m_channel_count++);
+    }
+
+    int TimeSeriesStore::findChannel(const char* name) const {
+        if (!name) {
+            return -1;
+        }
+        for (size_t i = 0; i < m_channel_count; i++) {
+            if (m_channels[i].config.name && strcmp(m_channels[i].config.name, name) == 0) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    const TimeSeriesChannelConfig* TimeSeriesStore::getChannelConfig(int channel) const {
+        if (channel < 0 || static_cast<size_t>(channel) >= m_channel_count) {
+            return nullptr;
+        }
+        return &m_channels[channel].config;
+    }
+
+    TimeSeriesStore::Block& TimeSeriesStore::blockAt(const Channel& channel, size_t ordinal) const {
+        const size_t index = channel.first_block + (channel.head + ordinal) % channel.block_count;
+        return const_cast<Block&>(m_blocks[index]);
+    }
+
+    uint32_t TimeSeriesStore::encodeValue(const Channel& channel, float value) const {
+        if (channel.config.quantum > 0.0f) {
+            value = roundf(value / channel.config.quantum);
+        }
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    float TimeSeriesStore::decodeValue(const Channel& channel, uint32_t value_bits) const {
+        float value;
+        memcpy(&value, &value_bits, sizeof(value));
+        return channel.config.quantum > 0.0f ? value * channel.config.quantum : value;
+    }
+
+    void TimeSeriesStore::startBlock(Channel& channel, uint32_t tick, uint32_t value_bits) {
+        if (channel.used == channel.block_count) {
+            Block& oldest = blockAt(channel, 0);
+            channel.dropped += oldest.count;
+            channel.samples -= oldest.count;
+            channel.payload_bits -= oldest.bit_length;
+            channel.head = (channel.head + 1) % channel.block_count;
+            channel.used--;
+        }
+        Block& block = blockAt(channel, channel.used++);
+        memset(&block, 0, sizeof(block));
+        block.first_tick = tick;
+        block.last_tick = tick;
+        block.first_value = value_bits;
+        block.count = 1;
+
+        channel.prev_tick = tick;
+        channel.prev_delta = 0;
+        channel.prev_value_bits = value_bits;
+        channel.prev_leading = 0xFF;        // No XOR window yet
+        channel.prev_trailing = 0;
+    }
+
+    bool TimeSeriesStore::append(int channel_id, uint32_t timestamp_ms, float value) {
+        if (channel_id < 0 || static_cast<size_t>(channel_id) >= m_channel_count) {
+            return false;
+        }
+        Channel& channel = m_channels[channel_id];
+        if (!channel.has_epoch) {
+            channel.has_epoch = true;
+            channel.epoch_ms = timestamp_ms - timestamp_ms % channel.config.resolution_ms;
+        } else if (static_cast<int32_t>(timestamp_ms - channel.last_ms) < 0) {
+            channel.rejected++;
+            return false;
+        }
+        channel.last_ms = timestamp_ms;
+
+        const uint32_t tick = (timestamp_ms - channel.epoch_ms) / channel.config.resolution_ms;
+        const uint32_t value_bits = encodeValue(channel, value);
+        channel.samples++;
+
+        Block* block = channel.used > 0 ? &blockAt(channel, channel.used - 1) : nullptr;
+        if (!block || block->bit_length + MAX_SAMPLE_BITS > PAYLOAD_BYTES * 8 || block->count == UINT16_MAX) {
+            startBlock(channel, tick, value_bits);
+            return true;
+        }
+
+        uint32_t bit = block->bit_length;
+        const uint32_t start_bit = bit;
+
+        const int32_t delta = static_cast<int32_t>(tick - channel.prev_tick);
+        writeDod(block->data, bit, delta - channel.prev_delta);
+        channel.prev_delta = delta;
+        channel.prev_tick = tick;
+
+        const uint32_t x = value_bits ^ channel.prev_value_bits;
+        if (x == 0) {
+            writeBits(block->data, bit, 0, 1);
+        } else {
+            const uint8_t leading = leadingZeros(x);
+            const uint8_t trailing = trailingZeros(x);
+            if (channel.prev_leading != 0xFF && leading >= channel.prev_leading && trailing >= channel.prev_trailing) {
+                // Fits the previous window: '10' + window bits
+                const uint8_t length = 32 - channel.prev_leading - channel.prev_trailing;
+                writeBits(block->data, bit, 0x2, 2);
+                writeBits(block->data, bit, x >> channel.prev_trailing, length);
+            } else {
+                // New window: '11' + 5-bit leading + 5-bit (length - 1) + bits
+                const uint8_t length = 32 - leading - trailing;
+                writeBits(block->data, bit, 0x3, 2);
+                writeBits(block->data, bit, leading, 5);
+                writeBits(block->data, bit, length - 1, 5);
+                writeBits(block->data, bit, x >> trailing, length);
+                channel.prev_leading = leading;
+                channel.prev_trailing = trailing;
+            }
+        }
+        channel.prev_value_bits = value_bits;
+
+        block->bit_length = static_cast<uint16_t>(bit);
+        block->last_tick = tick;
+        block->count++;
+        channel.payload_bits += bit - start_bit;
+        return true;
+    }
+
+    bool TimeSeriesStore::append(const Reading& reading) {
+        if (!reading.isValid) {
+            return false;
+        }
+        float value;
+        switch (reading.type) {
+            case DataType::BOOLEAN: value = reading.value.boolValue ? 1.0f : 0.0f; break;
+            case DataType::INTEGER: value = static_cast<float>(reading.value.intValue); break;
+            case DataType::FLOAT:   value = reading.value.floatValue; break;
+            default: return false;
+        }
+        return append(findChannel(reading.name), reading.timestamp, value);
+    }
+
+    TimeSeriesStore::Iterator TimeSeriesStore::query(int channel_id, uint32_t from_ms, uint32_t to_ms) const {
+        Iterator it = {};
+        it.m_store = this;
+        it.m_channel = channel_id;
+        it.m_done = true;
+        if (channel_id < 0 || static_cast<size_t>(channel_id) >= m_channel_count) {
+            return it;
+        }
+        const Channel& channel = m_channels[channel_id];
+        if (channel.used == 0 || static_cast<int32_t>(to_ms - from_ms) < 0) {
+            return it;
+        }
+        // Clamp the range onto the channel's epoch-relative time line
+        const int32_t from = static_cast<int32_t>(from_ms - channel.epoch_ms);
+        const int32_t to = static_cast<int32_t>(to_ms - channel.epoch_ms);
+        if (to < 0) {
+            return it;
+        }
+        it.m_from = from < 0 ? 0 : static_cast<uint32_t>(from);
+        it.m_to = static_cast<uint32_t>(to);
+
+        // Skip blocks that end before the range
+        const uint32_t resolution = channel.config.resolution_ms;
+        while (it.m_block < channel.used && blockAt(channel, it.m_block).last_tick * resolution < it.m_from) {
+            it.m_block++;
+        }
+        it.m_done = it.m_block >= channel.used;
+        return it;
+    }
+
+    bool TimeSeriesStore::Iterator::next(TimeSeriesSample& sample) {
+        while (!m_done) {
+            const Channel& channel = m_store->m_channels[m_channel];
+            if (m_block >= channel.used) {
+                m_done = true;
+                break;
+            }
+            const Block& block = m_store->blockAt(channel, m_block);
+            if (m_index >= block.count) {
+                m_block++;
+                m_index = 0;
+                continue;
+            }
+
+            if (m_index == 0) {
+                m_tick = block.first_tick;
+                m_delta = 0;
+                m_value_bits = block.first_value;
+                m_leading = 0;
+                m_trailing = 0;
+                m_bit = 0;
+            } else {
+                m_delta += readDod(block.data, m_bit);
+                m_tick += static_cast<uint32_t>(m_delta);
+                if (readBits(block.data, m_bit, 1) == 1) {
+                    if (readBits(block.data, m_bit, 1) == 1) {
+                        m_leading = static_cast<uint8_t>(readBits(block.data, m_bit, 5));
+                        const uint8_t length = static_cast<uint8_t>(readBits(block.data, m_bit, 5) + 1);
+                        m_trailing = 32 - m_leading - length;
+                    }
+                    const uint8_t length = 32 - m_leading - m_trailing;
+                    m_value_bits ^= readBits(block.data, m_bit, length) << m_trailing;
+                }
+            }
+            m_index++;
+
+            const uint32_t offset = m_tick * channel.config.resolution_ms;
+            if (offset > m_to) {
+                m_done = true;
+                break;
+            }
+            if (offset < m_from) {
+                continue;
+            }
+            sample.timestamp = channel.epoch_ms + offset;
+            sample.value = m_store->decodeValue(channel, m_value_bits);
+            return true;
+        }
+        return false;
+    }
+
+    bool TimeSeriesStore::getLatest(int channel_id, TimeSeriesSample& sample) const {
+        if (channel_id < 0 || static_cast<size_t>(channel_id) >= m_channel_count) {
+            return false;
+        }
+        const Channel& channel = m_channels[channel_id];
+        if (channel.used == 0) {
+            return false;
+        }
+        sample.timestamp = channel.epoch_ms + channel.prev_tick * channel.config.resolution_ms;
+        sample.value = decodeValue(channel, channel.prev_value_bits);
+        return true;
+    }
+
+    bool TimeSeriesStore::getStats(int channel_id, TimeSeriesStats& stats) const {
+        if (channel_id < 0 || static_cast<size_t>(channel_id) >= m_channel_count) {
+            return false;
+        }
+        const Channel& channel = m_channels[channel_id];
+        memset(&stats, 0, sizeof(stats));
+        stats.samples = channel.samples;
+        stats.dropped = channel.dropped;
+        stats.rejected = channel.rejected;
+        stats.bytes_used = static_cast<uint32_t>(channel.used * BLOCK_BYTES);
+        stats.budget_bytes = static_cast<uint32_t>(channel.block_count * BLOCK_BYTES);
+        stats.bits_per_sample = channel.samples > 0 ? static_cast<float>(channel.payload_bits) / channel.samples : 0.0f;
+        if (channel.used > 0) {
+            stats.oldest_ms = channel.epoch_ms + blockAt(channel, 0).first_tick * channel.config.resolution_ms;
+            stats.newest_ms = channel.epoch_ms + channel.prev_tick * channel.config.resolution_ms;
+        }
+        return true;
+    }
+}
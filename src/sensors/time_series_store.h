@@ -0,0 +1,147 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "sensor_interface.h"
+
+namespace SensorSystem {
+
+    struct TimeSeriesSample {
+        uint32_t timestamp;                 // ms, rounded down to the channel resolution
+        float value;
+    };
+
+    struct TimeSeriesChannelConfig {
+        const char* name;                   // Matched against Reading::name by append(Reading)
+        const char* unit;
+        size_t budget_bytes;                // Rounded down to whole blocks, at least two
+        uint32_t resolution_ms;             // Timestamp quantum; 1 Hz data with jitter compresses best at 100+
+        float quantum;                      // Value step; 0 = lossless float
+    };
+
+    struct TimeSeriesStats {
+        uint32_t samples;                   // Currently retained
+        uint32_t dropped;                   // Evicted with their oldest block
+        uint32_t rejected;                  // Out-of-order timestamps
+        uint32_t bytes_used;                // Blocks in use, headers included
+        uint32_t budget_bytes;
+        float bits_per_sample;              // Compressed payload only
+        uint32_t oldest_ms;
+        uint32_t newest_ms;
+    };
+
+    // Compressed history of scalar sensor channels.
+    // Each channel owns a ring of fixed-size blocks carved from one static
+    // arena, so memory is fixed at compile time and a full channel evicts
+    // its oldest block. Inside a block samples are bit-packed Gorilla style:
+    // timestamps as delta-of-delta (1 bit when the period is steady) and
+    // values as the XOR with the previous value (1 bit when unchanged, the
+    // meaningful bits otherwise). A block stores its first sample and time
+    // span uncompressed so range queries can skip whole blocks.
+    //
+    // Integer-like data (noise floor levels, RSSI, strike energy) compresses
+    // to a few bits per sample. Noisy floats only compress if a quantum is
+    // set: values are then stored as integer multiples of it.
+    // The arena makes an instance 16 KiB: give it static storage.
+    class TimeSeriesStore {
+    public:
+        static constexpr size_t MAX_CHANNELS = 8;
+        static constexpr size_t BLOCK_BYTES = 256;
+        static constexpr size_t ARENA_BLOCKS = 64;                      // 16 KiB
+        static constexpr size_t ARENA_BYTES = ARENA_BLOCKS * BLOCK_BYTES;
+
+        // Forward range scan over one channel, oldest first. Invalidated by
+        // an append that evicts the block it is reading.
+        class Iterator {
+        public:
+            bool next(TimeSeriesSample& sample);
+
+        private:
+            friend class TimeSeriesStore;
+            const TimeSeriesStore* m_store;
+            int m_channel;
+            uint32_t m_from;                // Offsets from the channel epoch, ms
+            uint32_t m_to;
+            size_t m_block;                 // Ordinal from the oldest block
+            uint16_t m_index;               // Next sample within the block
+            uint32_t m_bit;
+            uint32_t m_tick;
+            int32_t m_delta;
+            uint32_t m_value_bits;
+            uint8_t m_leading;
+            uint8_t m_trailing;
+            bool m_done;
+        };
+
+        TimeSeriesStore();
+        void reset();
+
+        // Returns the channel id, or -1 if the table or arena is full
+        int addChannel(const TimeSeriesChannelConfig& config);
+        int findChannel(const char* name) const;
+
+        // Timestamps must not go backwards within a channel and are kept as
+        // offsets from its first sample, so history spans under 49 days
+        bool append(int channel, uint32_t timestamp_ms, float value);
+        bool append(const Reading& reading);
+
+        // Samples with from_ms <= timestamp <= to_ms
+        Iterator query(int channel, uint32_t from_ms, uint32_t to_ms) const;
+        bool getLatest(int channel, TimeSeriesSample& sample) const;
+
+        bool getStats(int channel, TimeSeriesStats& stats) const;
+        size_t getChannelCount() const { return m_channel_count; }
+        const TimeSeriesChannelConfig* getChannelConfig(int channel) const;
+
+    private:
+        static constexpr size_t HEADER_BYTES = 16;
+        static constexpr size_t PAYLOAD_BYTES = BLOCK_BYTES - HEADER_BYTES;
+        static constexpr uint32_t MAX_SAMPLE_BITS = 80;                 // 36 timestamp + 44 value
+
+        struct Block {
+            uint32_t first_tick;
+            uint32_t last_tick;
+            uint32_t first_value;           // Raw bits of the first sample
+            uint16_t count;
+            uint16_t bit_length;
+            uint8_t data[PAYLOAD_BYTES];
+        };
+
+        struct Channel {
+            TimeSeriesChannelConfig config;
+            size_t first_block;             // Range in m_blocks
+            size_t block_count;
+            size_t head;                    // Oldest block, relative to first_block
+            size_t used;                    // Blocks holding samples
+            bool has_epoch;
+            uint32_t epoch_ms;              // First timestamp rounded down; ticks count from here
+            uint32_t last_ms;
+
+            // Encoder state for the newest block
+            uint32_t prev_tick;
+            int32_t prev_delta;
+            uint32_t prev_value_bits;
+            uint8_t prev_leading;
+            uint8_t prev_trailing;
+
+            uint32_t samples;
+            uint32_t dropped;
+            uint32_t rejected;
+            uint32_t payload_bits;
+        };
+
+        Block m_blocks[ARENA_BLOCKS];
+        size_t m_blocks_used;
+        Channel m_channels[MAX_CHANNELS];
+        size_t m_channel_count;
+
+        Block& blockAt(const Channel& channel, size_t ordinal) const;
+        void startBlock(Channel& channel, uint32_t tick, uint32_t value_bits);
+        uint32_t encodeValue(const Channel& channel, float value) const;
+        float decodeValue(const Channel& channel, uint32_t value_bits) const;
+    };
+
+    TimeSeriesChannelConfig makeTimeSeriesChannel(const char* name, const char* unit, size_t budget_bytes,
+                                                  uint32_t resolution_ms = 1, float quantum = 0.0f);
+}
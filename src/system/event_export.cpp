@@ -0,0 +1,200 @@
+#include "event_export.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace Logging {
+
+    EventQuery getDefaultEventQuery() {
+        EventQuery query;
+        query.from_time = 0;
+        query.to_time = 0;
+        query.cursor = 0;
+        query.limit = 0;
+        query.format = ExportFormat::NDJSON;
+        return query;
+    }
+
+    const char* eventTypeToString(EventType type) {
+        switch (type) {
+            case EventType::BOOT: return "boot";
+            case EventType::STRIKE: return "strike";
+            case EventType::DISTURBER: return "disturber";
+            case EventType::STORM_STARTED: return "storm_started";
+            case EventType::STORM_ENDED: return "storm_ended";
+            case EventType::ALERT: return "alert";
+            case EventType::SENSOR_ERROR: return "sensor_error";
+            default: return "unknown";
+        }
+    }
+
+    const char* exportFormatToString(ExportFormat format) {
+        switch (format) {
+            case ExportFormat::NDJSON: return "ndjson";
+            case ExportFormat::BINARY: return "binary";
+            default: return "unknown";
+        }
+    }
+
+    size_t formatEventJson(const EventRecord& record, char* out, size_t capacity) {
+        const EventType type = static_cast<EventType>(record.type);
+
+        int n = snprintf(out, capacity, "{\"seq\":%lu,\"uptime_ms\":%lu,\"type\":\"%s\",\"flags\":%u",
+                         (unsigned long)record.sequence, (unsigned long)record.uptime_ms, eventTypeToString(type),
+                         (unsigned)record.flags);
+        size_t length = n > 0 ? static_cast<size_t>(n) : capacity;
+
+        if (record.unix_time != 0 && length < capacity) {
+            n = snprintf(out + length, capacity - length, ",\"time\":%lu", (unsigned long)record.unix_time);
+            length += n > 0 ? static_cast<size_t>(n) : capacity;
+        }
+
+        if (length < capacity) {
+            switch (type) {
+                case EventType::STRIKE:
+                case EventType::DISTURBER: {
+                    StrikeEventData strike;
+                    memcpy(&strike, record.data, sizeof(strike));
+                    n = snprintf(out + length, capacity - length, ",\"km\":%u,\"energy\":%lu,\"count\":%u",
+                                 (unsigned)strike.distance_km, (unsigned long)strike.energy,
+                                 (unsigned)strike.strike_count);
+                    break;
+                }
+                case EventType::BOOT:
+                    n = snprintf(out + length, capacity - length, ",\"reset_reason\":%u", (unsigned)record.data[0]);
+                    break;
+                case EventType::SENSOR_ERROR: {
+                    uint16_t code;
+                    memcpy(&code, record.data, sizeof(code));
+                    n = snprintf(out + length, capacity - length, ",\"code\":%u", (unsigned)code);
+                    break;
+                }
+                case EventType::ALERT: {
+                    // Escape quotes, backslashes and control bytes; stop at NUL
+                    char text[sizeof(record.data) * 6 + 1];
+                    size_t t = 0;
+                    for (size_t i = 0; i < sizeof(record.data) && record.data[i] != 0; i++) {
+                        const uint8_t c = record.data[i];
+                        if (c == '"' || c == '\\') {
+                            text[t++] = '\\';
+                            text[t++] = static_cast<char>(c);
+                        } else if (c < 0x20 || c >= 0x7F) {
+                            t += snprintf(text + t, sizeof(text) - t, "\\u%04x", (unsigned)c);
+                        } else {
+                            text[t++] = static_cast<char>(c);
+                        }
+                    }
+                    text[t] = '\0';
+                    n = snprintf(out + length, capacity - length, ",\"text\":\"%s\"", text);
+                    break;
+                }
+                default:
+                    n = 0;
+                    break;
+            }
+            length += n >= 0 ? static_cast<size_t>(n) : capacity;
+        }
+
+        if (length + 2 >= capacity) {
+            return 0;
+        }
+        out[length++] = '}';
+        out[length++] = '\n';
+        out[length] = '\0';
+        return length;
+    }
+
+    EventExporter::EventExporter(const EventLog& log, ExportSink sink, void* context)
+        : m_log(log), m_sink(sink), m_context(context), m_used(0), m_stats() {}
+
+    bool EventExporter::flush() {
+        if (m_used == 0) {
+            return true;
+        }
+        if (!m_sink(m_context, m_buffer, m_used)) {
+            m_stats.aborted = true;
+            return false;
+        }
+        m_stats.bytes += m_used;
+        m_stats.chunks++;
+        m_used = 0;
+        return true;
+    }
+
+    bool EventExporter::put(const void* data, size_t length) {
+        if (m_used + length > BUFFER_SIZE && !flush()) {
+            return false;
+        }
+        memcpy(m_buffer + m_used, data, length);
+        m_used += length;
+        return true;
+    }
+
+    bool EventExporter::run(const EventQuery& query) {
+        m_stats = EventExportStats();
+        m_used = 0;
+
+        uint32_t start = query.cursor;
+        if (query.from_time != 0) {
+            const uint32_t seek = m_log.seekTime(query.from_time);
+            if (start == 0 || static_cast<int32_t>(seek - start) > 0) {
+                start = seek;
+            }
+        }
+
+        const bool timed = query.from_time != 0 || query.to_time != 0;
+        EventLog::Reader reader = m_log.read(start);
+        bool stopped = false;
+
+        while (const EventRecord* record = reader.next()) {
+            m_stats.scanned++;
+
+            if (timed && (record->unix_time == 0 || record->unix_time < query.from_time)) {
+                continue;
+            }
+            if (query.to_time != 0 && record->unix_time > query.to_time) {
+                m_stats.next_cursor = record->sequence;
+                stopped = true;
+                break;
+            }
+            if (query.limit != 0 && m_stats.records >= query.limit) {
+                m_stats.next_cursor = record->sequence;
+                m_stats.more = true;
+                stopped = true;
+                break;
+            }
+
+            bool ok;
+            if (query.format == ExportFormat::BINARY) {
+                ok = put(record, sizeof(EventRecord));
+            } else {
+                char line[MAX_LINE];
+                const size_t length = formatEventJson(*record, line, sizeof(line));
+                ok = length == 0 || put(line, length);
+            }
+            if (!ok) {
+                m_stats.skipped = reader.getSkipped();
+                return false;
+            }
+            m_stats.records++;
+        }
+
+        if (!stopped) {
+            m_stats.next_cursor = reader.getNextSequence();
+        }
+        m_stats.skipped = reader.getSkipped();
+
+        if (query.format == ExportFormat::NDJSON) {
+            char line[MAX_LINE];
+            const int n = snprintf(line, sizeof(line),
+                                   "{\"next_cursor\":%lu,\"records\":%lu,\"skipped\":%lu,\"more\":%s}\n",
+                                   (unsigned long)m_stats.next_cursor, (unsigned long)m_stats.records,
+                                   (unsigned long)m_stats.skipped, m_stats.more ? "true" : "false");
+            if (n > 0 && !put(line, static_cast<size_t>(n))) {
+                return false;
+            }
+        }
+
+        return flush();
+    }
+}
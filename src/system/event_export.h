@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "event_log.h"
+
+namespace Logging {
+
+    enum class ExportFormat : uint8_t {
+        NDJSON,             // One JSON object per line, then a summary line
+        BINARY              // Raw 32-byte EventRecords as stored on flash
+    };
+
+    struct EventQuery {
+        uint32_t from_time;                 // Unix seconds, 0 = no lower bound
+        uint32_t to_time;                   // Unix seconds inclusive, 0 = no upper bound
+        uint32_t cursor;                    // Resume at this sequence (next_cursor of a previous page), 0 = start
+        uint32_t limit;                     // Records per response, 0 = all
+        ExportFormat format;
+    };
+
+    struct EventExportStats {
+        uint32_t records;                   // Written to the sink
+        uint32_t scanned;                   // Read from flash, including filtered ones
+        uint32_t skipped;                   // Torn, or evicted while streaming
+        uint32_t bytes;
+        uint32_t chunks;
+        uint32_t next_cursor;               // Pass as cursor to continue
+        bool more;                          // Stopped at the limit with records left
+        bool aborted;                       // Sink refused a chunk (client went away)
+    };
+
+    // Receives each full buffer; false aborts the export
+    typedef bool (*ExportSink)(void* context, const uint8_t* data, size_t length);
+
+    // Streams a range of the event log through one fixed buffer, so memory
+    // use does not depend on how much history is exported. Records with no
+    // wall-clock time are left out of time-bounded queries.
+    class EventExporter {
+    public:
+        static constexpr size_t BUFFER_SIZE = 1024;
+        static constexpr size_t MAX_LINE = 192;
+
+        EventExporter(const EventLog& log, ExportSink sink, void* context);
+
+        bool run(const EventQuery& query);
+        const EventExportStats& getStats() const { return m_stats; }
+
+    private:
+        const EventLog& m_log;
+        ExportSink m_sink;
+        void* m_context;
+        uint8_t m_buffer[BUFFER_SIZE];
+        size_t m_used;
+        EventExportStats m_stats;
+
+        bool put(const void* data, size_t length);
+        bool flush();
+    };
+
+    EventQuery getDefaultEventQuery();
+
+    // One NDJSON line, newline included; returns its length (0 if it does not fit)
+    size_t formatEventJson(const EventRecord& record, char* out, size_t capacity);
+
+    const char* eventTypeToString(EventType type);
+    const char* exportFormatToString(ExportFormat format);
+}
@@ -0,0 +1,455 @@
+#include "event_log.h"
+
+#include <cstddef>
+#include <cstring>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+using HardwareAbstraction::FlashPartition;
+using HardwareAbstraction::Result;
+namespace Timer = HardwareAbstraction::Timer;
+
+namespace Logging {
+
+    EventLog g_eventLog;
+
+    namespace {
+        constexpr uint32_t CRC_TABLE[16] = {
+            0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+            0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+        };
+
+        // Wrap-safe ordering for sequences
+        inline bool sequenceAfter(uint32_t a, uint32_t b) {
+            return static_cast<int32_t>(a - b) > 0;
+        }
+    }
+
+    uint32_t crc32(const void* data, size_t length, uint32_t crc) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        crc = ~crc;
+        while (length--) {
+            crc ^= *p++;
+            crc = (crc >> 4) ^ CRC_TABLE[crc & 0x0F];
+            crc = (crc >> 4) ^ CRC_TABLE[crc & 0x0F];
+        }
+        return ~crc;
+    }
+
+    EventLog::EventLog()
+        : m_partition(nullptr), m_map(nullptr), m_segments(), m_segment_count(0), m_head(0), m_slot(0),
+          m_next_sequence(1), m_unix_time(nullptr), m_last_time(0), m_stats() {}
+
+    bool EventLog::begin(FlashPartition* partition) {
+        end();
+
+        if (!partition || !partition->data()) {
+            return false;
+        }
+
+        size_t count = partition->sectorCount();
+        if (count > MAX_SEGMENTS) {
+            count = MAX_SEGMENTS;
+        }
+        if (count < MIN_SEGMENTS) {
+            return false;
+        }
+
+        const uint32_t start = Timer::micros();
+
+        m_partition = partition;
+        m_map = partition->data();
+        m_segment_count = count;
+        m_stats = EventLogStats();
+        m_stats.segments = count;
+        m_stats.records_per_segment = RECORDS_PER_SEGMENT;
+
+        // Headers only: the newest valid segment is the head
+        bool found = false;
+        uint32_t maxErase = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!readHeader(i, m_segments[i])) {
+                if (!headerErased(i)) {
+                    m_stats.invalid_segments++;
+                }
+                continue;
+            }
+            if (!found || sequenceAfter(m_segments[i].sequence, m_segments[m_head].sequence)) {
+                m_head = i;
+                found = true;
+            }
+            if (m_segments[i].erase_count > maxErase) {
+                maxErase = m_segments[i].erase_count;
+            }
+        }
+
+        // Unreadable headers lost their count: assume the worst seen
+        for (size_t i = 0; i < count; i++) {
+            if (!m_segments[i].valid) {
+                m_segments[i].erase_count = maxErase;
+            }
+        }
+
+        if (!found) {
+            m_next_sequence = 1;
+            if (!format()) {
+                end();
+                return false;
+            }
+        } else {
+            m_slot = findFreeSlot(m_head);
+            m_next_sequence = m_segments[m_head].first_record + m_slot;
+
+            // Newest wall-clock time so far, for the next segment's base time
+            m_last_time = m_segments[m_head].base_time;
+            for (size_t slot = m_slot; slot-- > 0; ) {
+                const EventRecord* record = slotAt(m_head, slot);
+                if (record->unix_time != 0 && record->crc == crc32(record, offsetof(EventRecord, crc))) {
+                    if (record->unix_time > m_last_time) {
+                        m_last_time = record->unix_time;
+                    }
+                    break;
+                }
+            }
+        }
+
+        updateRetention();
+        m_stats.recovery_us = Timer::micros() - start;
+
+        #ifdef ARDUINO
+        Serial.printf("[EVENTLOG] %u segments, head %u slot %u, next #%lu, %u invalid, recovered in %lu us\n",
+                      (unsigned)count, (unsigned)m_head, (unsigned)m_slot, (unsigned long)m_next_sequence,
+                      (unsigned)m_stats.invalid_segments, (unsigned long)m_stats.recovery_us);
+        #endif
+
+        return true;
+    }
+
+    void EventLog::end() {
+        m_partition = nullptr;
+        m_map = nullptr;
+        m_segment_count = 0;
+        m_head = 0;
+        m_slot = 0;
+        m_last_time = 0;
+        for (size_t i = 0; i < MAX_SEGMENTS; i++) {
+            m_segments[i] = Segment();
+        }
+    }
+
+    bool EventLog::format() {
+        if (!m_partition) {
+            return false;
+        }
+
+        for (size_t i = 0; i < m_segment_count; i++) {
+            const uint32_t eraseCount = m_segments[i].erase_count;
+            m_segments[i] = Segment();
+            m_segments[i].erase_count = eraseCount;
+            if (!eraseSegment(i)) {
+                return false;
+            }
+        }
+
+        // Segment 0 was just erased: write its header without another erase
+        SegmentHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.record_size = RECORD_SIZE;
+        header.sequence = 1;
+        header.first_record = m_next_sequence;
+        header.erase_count = m_segments[0].erase_count;
+        header.base_time = m_last_time;
+        header.crc = crc32(&header, offsetof(SegmentHeader, crc));
+        if (m_partition->write(0, &header, sizeof(header)) != Result::SUCCESS) {
+            return false;
+        }
+
+        m_segments[0].valid = true;
+        m_segments[0].sequence = header.sequence;
+        m_segments[0].first_record = header.first_record;
+        m_segments[0].base_time = header.base_time;
+        m_head = 0;
+        m_slot = 0;
+        updateRetention();
+        return true;
+    }
+
+    bool EventLog::append(EventType type, const void* data, size_t length, uint16_t flags) {
+        if (!isReady()) {
+            return false;
+        }
+
+        if (m_slot >= RECORDS_PER_SEGMENT && !rotate()) {
+            m_stats.failed_appends++;
+            return false;
+        }
+
+        EventRecord record;
+        memset(&record, 0, sizeof(record));
+        record.sequence = m_next_sequence;
+        record.uptime_ms = Timer::millis();
+        record.unix_time = m_unix_time ? m_unix_time() : 0;
+        record.type = static_cast<uint16_t>(type);
+        record.flags = flags;
+        if (data && length) {
+            memcpy(record.data, data, length < sizeof(record.data) ? length : sizeof(record.data));
+        }
+        record.crc = crc32(&record, offsetof(EventRecord, crc));
+
+        if (record.unix_time > m_last_time) {
+            m_last_time = record.unix_time;
+        }
+
+        const size_t offset = m_head * SEGMENT_SIZE + HEADER_SIZE + m_slot * RECORD_SIZE;
+        if (m_partition->write(offset, &record, sizeof(record)) != Result::SUCCESS) {
+            m_stats.failed_appends++;
+            // A slot with any bits programmed is spent; keeping used slots a
+            // prefix of the segment is what lets recovery binary-search it
+            if (!slotErased(m_head, m_slot)) {
+                m_slot++;
+                m_next_sequence++;
+                m_stats.next_sequence = m_next_sequence;
+            }
+            return false;
+        }
+
+        m_slot++;
+        m_next_sequence++;
+        m_stats.appends++;
+        m_stats.next_sequence = m_next_sequence;
+        return true;
+    }
+
+    bool EventLog::rotate() {
+        const size_t next = (m_head + 1) % m_segment_count;
+        if (!startSegment(next, m_segments[m_head].sequence + 1)) {
+            return false;
+        }
+
+        m_head = next;
+        m_slot = 0;
+        m_stats.rotations++;
+        updateRetention();
+        return true;
+    }
+
+    bool EventLog::eraseSegment(size_t segment) {
+        // Skipping sectors that are already blank saves wear and ~45 ms each
+        const uint32_t* words = reinterpret_cast<const uint32_t*>(m_map + segment * SEGMENT_SIZE);
+        bool blank = true;
+        for (size_t i = 0; blank && i < SEGMENT_SIZE / sizeof(uint32_t); i++) {
+            blank = words[i] == 0xFFFFFFFF;
+        }
+        if (blank) {
+            return true;
+        }
+
+        m_segments[segment].erase_count++;
+        return m_partition->eraseSector(segment) == Result::SUCCESS;
+    }
+
+    bool EventLog::startSegment(size_t segment, uint32_t sequence) {
+        Segment& seg = m_segments[segment];
+
+        // Its records are gone from the moment the erase starts
+        seg.valid = false;
+        if (!eraseSegment(segment)) {
+            return false;
+        }
+
+        SegmentHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.record_size = RECORD_SIZE;
+        header.sequence = sequence;
+        header.first_record = m_next_sequence;
+        header.erase_count = seg.erase_count;
+        header.base_time = m_last_time;
+        header.crc = crc32(&header, offsetof(SegmentHeader, crc));
+
+        if (m_partition->write(segment * SEGMENT_SIZE, &header, sizeof(header)) != Result::SUCCESS) {
+            return false;
+        }
+
+        seg.valid = true;
+        seg.sequence = sequence;
+        seg.first_record = header.first_record;
+        seg.base_time = header.base_time;
+        return true;
+    }
+
+    bool EventLog::readHeader(size_t segment, Segment& out) const {
+        SegmentHeader header;
+        memcpy(&header, m_map + segment * SEGMENT_SIZE, sizeof(header));
+
+        out = Segment();
+        if (header.magic != MAGIC || header.version != VERSION || header.record_size != RECORD_SIZE ||
+            header.crc != crc32(&header, offsetof(SegmentHeader, crc))) {
+            return false;
+        }
+
+        out.valid = true;
+        out.sequence = header.sequence;
+        out.first_record = header.first_record;
+        out.erase_count = header.erase_count;
+        out.base_time = header.base_time;
+        return true;
+    }
+
+    bool EventLog::headerErased(size_t segment) const {
+        const uint32_t* words = reinterpret_cast<const uint32_t*>(m_map + segment * SEGMENT_SIZE);
+        for (size_t i = 0; i < HEADER_SIZE / sizeof(uint32_t); i++) {
+            if (words[i] != 0xFFFFFFFF) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const EventRecord* EventLog::slotAt(size_t segment, size_t slot) const {
+        return reinterpret_cast<const EventRecord*>(m_map + segment * SEGMENT_SIZE + HEADER_SIZE + slot * RECORD_SIZE);
+    }
+
+    bool EventLog::slotErased(size_t segment, size_t slot) const {
+        const uint32_t* words = reinterpret_cast<const uint32_t*>(slotAt(segment, slot));
+        for (size_t i = 0; i < RECORD_SIZE / sizeof(uint32_t); i++) {
+            if (words[i] != 0xFFFFFFFF) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t EventLog::findFreeSlot(size_t segment) const {
+        size_t lo = 0;
+        size_t hi = RECORDS_PER_SEGMENT;
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (slotErased(segment, mid)) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        return lo;
+    }
+
+    int EventLog::locate(uint32_t sequence) const {
+        for (size_t i = 0; i < m_segment_count; i++) {
+            const Segment& seg = m_segments[i];
+            if (seg.valid && !sequenceAfter(seg.first_record, sequence) &&
+                sequenceAfter(seg.first_record + RECORDS_PER_SEGMENT, sequence)) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    void EventLog::updateRetention() {
+        bool any = false;
+        for (size_t i = 0; i < m_segment_count; i++) {
+            const Segment& seg = m_segments[i];
+            if (!seg.valid) {
+                continue;
+            }
+            if (!any || sequenceAfter(m_stats.oldest_sequence, seg.first_record)) {
+                m_stats.oldest_sequence = seg.first_record;
+            }
+            if (!any || seg.erase_count < m_stats.min_erase_count) {
+                m_stats.min_erase_count = seg.erase_count;
+            }
+            if (!any || seg.erase_count > m_stats.max_erase_count) {
+                m_stats.max_erase_count = seg.erase_count;
+            }
+            any = true;
+        }
+        if (!any) {
+            m_stats.oldest_sequence = m_next_sequence;
+        }
+        m_stats.next_sequence = m_next_sequence;
+    }
+
+    uint32_t EventLog::getSegmentEraseCount(size_t segment) const {
+        return segment < m_segment_count ? m_segments[segment].erase_count : 0;
+    }
+
+    EventLog::Reader EventLog::read(uint32_t fromSequence) const {
+        Reader reader;
+        reader.m_log = this;
+        reader.m_next = (fromSequence == 0 || sequenceAfter(m_stats.oldest_sequence, fromSequence))
+            ? m_stats.oldest_sequence : fromSequence;
+        reader.m_segment = -1;
+        reader.m_skipped = 0;
+        return reader;
+    }
+
+    uint32_t EventLog::seekTime(uint32_t unixTime) const {
+        if (!isReady() || unixTime == 0) {
+            return m_stats.oldest_sequence;
+        }
+
+        // Valid segments oldest first; base times never decrease along it
+        uint8_t order[MAX_SEGMENTS];
+        size_t count = 0;
+        for (size_t i = 1; i <= m_segment_count; i++) {
+            const size_t segment = (m_head + i) % m_segment_count;
+            if (m_segments[segment].valid) {
+                order[count++] = static_cast<uint8_t>(segment);
+            }
+        }
+
+        // First segment that began at or after unixTime: the records that
+        // reach it can only start in the segment before
+        size_t lo = 0;
+        size_t hi = count;
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (m_segments[order[mid]].base_time < unixTime) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+
+        if (count == 0) {
+            return m_next_sequence;
+        }
+        return m_segments[order[lo > 0 ? lo - 1 : 0]].first_record;
+    }
+
+    const EventRecord* EventLog::Reader::next() {
+        const EventLog& log = *m_log;
+
+        while (log.isReady() && sequenceAfter(log.m_next_sequence, m_next)) {
+            if (m_segment < 0 || !log.m_segments[m_segment].valid ||
+                sequenceAfter(log.m_segments[m_segment].first_record, m_next) ||
+                !sequenceAfter(log.m_segments[m_segment].first_record + RECORDS_PER_SEGMENT, m_next)) {
+                m_segment = log.locate(m_next);
+            }
+
+            if (m_segment < 0) {
+                // Evicted, or lost with an invalid segment: resume at the oldest
+                // record still held
+                const uint32_t resume = sequenceAfter(log.m_stats.oldest_sequence, m_next)
+                    ? log.m_stats.oldest_sequence : m_next + 1;
+                m_skipped += resume - m_next;
+                m_next = resume;
+                continue;
+            }
+
+            const EventRecord* record = log.slotAt(m_segment, m_next - log.m_segments[m_segment].first_record);
+            const uint32_t expected = m_next++;
+            if (record->sequence == expected && record->crc == crc32(record, offsetof(EventRecord, crc))) {
+                return record;
+            }
+            m_skipped++;
+        }
+
+        return nullptr;
+    }
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "../hardware/flash_partition.h"
+
+namespace Logging {
+
+    enum class EventType : uint16_t {
+        BOOT = 1,           // data: reset reason (u8)
+        STRIKE = 2,         // data: StrikeEventData
+        DISTURBER = 3,      // data: StrikeEventData
+        STORM_STARTED = 4,
+        STORM_ENDED = 5,
+        ALERT = 6,          // data: up to 12 bytes of text, not terminated when full
+        SENSOR_ERROR = 7    // data: error code (u16)
+    };
+
+    // One 32-byte slot on flash, little-endian as laid out here
+    struct EventRecord {
+        uint32_t sequence;                  // Global, gap-free unless an append failed
+        uint32_t uptime_ms;
+        uint32_t unix_time;                 // 0 until a time source is available
+        uint16_t type;                      // EventType
+        uint16_t flags;
+        uint8_t data[12];
+        uint32_t crc;                       // CRC-32 of the preceding 28 bytes
+    };
+    static_assert(sizeof(EventRecord) == 32, "EventRecord must fill one slot");
+
+    struct StrikeEventData {
+        uint32_t energy;
+        uint8_t distance_km;
+        uint8_t strike_count;
+    };
+
+    struct EventLogStats {
+        uint32_t segments;
+        uint32_t records_per_segment;
+        uint32_t appends;
+        uint32_t failed_appends;
+        uint32_t rotations;
+        uint32_t oldest_sequence;
+        uint32_t next_sequence;
+        uint32_t min_erase_count;           // Erases actually performed, over segments with a valid header
+        uint32_t max_erase_count;
+        uint32_t invalid_segments;          // Found at recovery: torn header or interrupted erase
+        uint32_t recovery_us;
+    };
+
+    // Append-only event history on a dedicated flash partition.
+    // Every sector is a segment: a 32-byte header (magic, segment sequence,
+    // erase count, CRC) followed by 127 fixed-size record slots that are
+    // programmed once, in order. When the newest segment fills, the next
+    // one round-robin is erased and takes over, so wear is spread evenly
+    // and the oldest records are dropped one segment at a time.
+    //
+    // Recovery after power loss reads only the segment headers to find the
+    // newest segment, then binary-searches its slots for the first erased
+    // one. A torn record fails its CRC and is skipped by readers; a torn
+    // header or interrupted erase invalidates just that segment.
+    //
+    // Readers return pointers into the memory-mapped partition: nothing is
+    // copied and records must not be held across appends.
+    class EventLog {
+    public:
+        static constexpr uint32_t MAGIC = 0x474F4C45;                   // "ELOG"
+        static constexpr uint16_t VERSION = 1;
+        static constexpr size_t HEADER_SIZE = 32;
+        static constexpr size_t RECORD_SIZE = sizeof(EventRecord);
+        static constexpr size_t SEGMENT_SIZE = HardwareAbstraction::FlashPartition::SECTOR_SIZE;
+        static constexpr size_t RECORDS_PER_SEGMENT = (SEGMENT_SIZE - HEADER_SIZE) / RECORD_SIZE;
+        static constexpr size_t MAX_SEGMENTS = 64;                      // 256 KiB partition
+        static constexpr size_t MIN_SEGMENTS = 2;
+
+        // Forward scan in sequence order. Survives appends: records evicted
+        // under it are skipped and counted.
+        class Reader {
+        public:
+            const EventRecord* next();
+            uint32_t getNextSequence() const { return m_next; }
+            uint32_t getSkipped() const { return m_skipped; }
+
+        private:
+            friend class EventLog;
+            const EventLog* m_log;
+            uint32_t m_next;
+            int m_segment;                  // Cached segment holding m_next, -1 = locate
+            uint32_t m_skipped;
+        };
+
+        EventLog();
+
+        // Recovers the log from the partition, formatting it if no segment
+        // is valid. Uses at most MAX_SEGMENTS sectors. False if the partition
+        // is missing, too small or cannot be mapped.
+        bool begin(HardwareAbstraction::FlashPartition* partition);
+        void end();
+        bool isReady() const { return m_partition != nullptr; }
+
+        // Erases every segment that is not already blank; erase counts carry over
+        bool format();
+
+        bool append(EventType type, const void* data = nullptr, size_t length = 0, uint16_t flags = 0);
+
+        // Wall-clock seconds for new records, e.g. from GPS or NTP; nullptr = none
+        void setTimeSource(uint32_t (*unixTime)()) { m_unix_time = unixTime; }
+
+        // From the oldest retained record at or after fromSequence
+        Reader read(uint32_t fromSequence = 0) const;
+
+        // Sequence to start reading from so that no record logged at or
+        // after unixTime is missed. Binary-searches the segment base times,
+        // so it can land up to one segment early: filter on unix_time too.
+        uint32_t seekTime(uint32_t unixTime) const;
+
+        const EventLogStats& getStats() const { return m_stats; }
+        uint32_t getSegmentEraseCount(size_t segment) const;
+
+    private:
+        struct SegmentHeader {
+            uint32_t magic;
+            uint16_t version;
+            uint16_t record_size;
+            uint32_t sequence;              // Segment sequence, newest is largest
+            uint32_t first_record;          // Record sequence of slot 0
+            uint32_t erase_count;
+            uint32_t base_time;             // Newest unix_time logged before this segment, 0 = none yet
+            uint8_t reserved[4];
+            uint32_t crc;
+        };
+        static_assert(sizeof(SegmentHeader) == HEADER_SIZE, "SegmentHeader must fill the header");
+
+        struct Segment {
+            bool valid;
+            uint32_t sequence;
+            uint32_t first_record;
+            uint32_t erase_count;
+            uint32_t base_time;
+        };
+
+        HardwareAbstraction::FlashPartition* m_partition;
+        const uint8_t* m_map;
+        Segment m_segments[MAX_SEGMENTS];
+        size_t m_segment_count;
+        size_t m_head;                      // Segment receiving appends
+        size_t m_slot;                      // Next free slot in the head
+        uint32_t m_next_sequence;
+        uint32_t (*m_unix_time)();
+        uint32_t m_last_time;               // Newest unix_time logged
+        EventLogStats m_stats;
+
+        bool readHeader(size_t segment, Segment& out) const;
+        bool headerErased(size_t segment) const;
+        bool eraseSegment(size_t segment);
+        bool startSegment(size_t segment, uint32_t sequence);
+        bool rotate();
+        size_t findFreeSlot(size_t segment) const;
+        bool slotErased(size_t segment, size_t slot) const;
+        const EventRecord* slotAt(size_t segment, size_t slot) const;
+        int locate(uint32_t sequence) const;
+        void updateRetention();
+    };
+
+    uint32_t crc32(const void* data, size_t length, uint32_t crc = 0);
+
+    extern EventLog g_eventLog;
+}
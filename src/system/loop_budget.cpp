@@ -0,0 +1,90 @@
+#include "loop_budget.h"
+
+#include "../hardware/hardware_abstraction.h"
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+#ifndef LOOP_BUDGET_MS
+#define LOOP_BUDGET_MS 50
+#endif
+
+namespace Diagnostics {
+
+    LoopBudgetConfig getDefaultLoopBudgetConfig() {
+        LoopBudgetConfig config;
+        config.budget_us = LOOP_BUDGET_MS * 1000UL;
+        config.report_interval_ms = 60000;
+        return config;
+    }
+
+    LoopBudget::LoopBudget(const LoopBudgetConfig& config)
+        : m_config(config), m_stats(), m_iterationStartUs(0), m_spanStartUs(0), m_lastReportMs(0),
+          m_inIteration(false) {
+        m_stats.max_span_label = "";
+    }
+
+    void LoopBudget::beginIteration() {
+        m_iterationStartUs = HardwareAbstraction::Timer::micros();
+        m_spanStartUs = m_iterationStartUs;
+        m_inIteration = true;
+    }
+
+    void LoopBudget::checkpoint(const char* label) {
+        if (!m_inIteration) {
+            return;
+        }
+        const uint32_t now = HardwareAbstraction::Timer::micros();
+        const uint32_t span = now - m_spanStartUs;
+        if (span > m_stats.max_span_us) {
+            m_stats.max_span_us = span;
+            m_stats.max_span_label = label;
+        }
+        m_spanStartUs = now;
+    }
+
+    bool LoopBudget::endIteration() {
+        if (!m_inIteration) {
+            return true;
+        }
+        checkpoint("end");
+        m_inIteration = false;
+
+        const uint32_t elapsed = m_spanStartUs - m_iterationStartUs;
+        m_stats.iterations++;
+        m_stats.last_iteration_us = elapsed;
+        m_stats.total_us += elapsed;
+        if (elapsed > m_stats.max_iteration_us) {
+            m_stats.max_iteration_us = elapsed;
+        }
+        if (elapsed > m_config.budget_us) {
+            m_stats.overruns++;
+            return false;
+        }
+        return true;
+    }
+
+    void LoopBudget::report(uint32_t nowMs) {
+        if (m_config.report_interval_ms == 0 || nowMs - m_lastReportMs < m_config.report_interval_ms) {
+            return;
+        }
+        m_lastReportMs = nowMs;
+#ifdef ARDUINO
+        if (m_stats.iterations > 0) {
+            Serial.printf("[LOOP] %lu iterations, avg %lu us, max %lu us, %lu over %lu ms; slowest step %s %lu us\n",
+                          (unsigned long)m_stats.iterations,
+                          (unsigned long)(m_stats.total_us / m_stats.iterations),
+                          (unsigned long)m_stats.max_iteration_us, (unsigned long)m_stats.overruns,
+                          (unsigned long)(m_config.budget_us / 1000), m_stats.max_span_label,
+                          (unsigned long)m_stats.max_span_us);
+        }
+#endif
+        resetStats();
+    }
+
+    void LoopBudget::resetStats() {
+        m_stats = LoopBudgetStats();
+        m_stats.max_span_label = "";
+    }
+}
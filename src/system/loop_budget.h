@@ -0,0 +1,58 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Diagnostics {
+
+    struct LoopBudgetConfig {
+        uint32_t budget_us;                 // Longest acceptable loop() iteration
+        uint32_t report_interval_ms;        // Serial summary period, 0 = off
+    };
+
+    LoopBudgetConfig getDefaultLoopBudgetConfig();
+
+    struct LoopBudgetStats {
+        uint32_t iterations;
+        uint32_t overruns;                  // Iterations longer than budget_us
+        uint32_t last_iteration_us;
+        uint32_t max_iteration_us;
+        uint64_t total_us;
+        uint32_t max_span_us;               // Longest stretch between two checkpoints
+        const char* max_span_label;         // Checkpoint that closed it
+    };
+
+    // Measures loop() against a time budget. checkpoint() calls split the
+    // iteration into labelled spans, so an overrun names the step that
+    // blocked ("control channel", "web server") rather than just the loop.
+    // Uses HardwareAbstraction::Timer::micros(), so the native tests can
+    // drive it from the simulated clock.
+    class LoopBudget {
+    public:
+        explicit LoopBudget(const LoopBudgetConfig& config = getDefaultLoopBudgetConfig());
+
+        void beginIteration();
+
+        // Closes the span since the previous checkpoint (or the start of the
+        // iteration) under label; label must outlive the LoopBudget
+        void checkpoint(const char* label);
+
+        // False if the iteration overran the budget
+        bool endIteration();
+
+        // Prints and clears the summary once report_interval_ms has passed
+        void report(uint32_t nowMs);
+
+        const LoopBudgetStats& getStats() const { return m_stats; }
+        void resetStats();
+        const LoopBudgetConfig& getConfig() const { return m_config; }
+
+    private:
+        LoopBudgetConfig m_config;
+        LoopBudgetStats m_stats;
+        uint32_t m_iterationStartUs;
+        uint32_t m_spanStartUs;
+        uint32_t m_lastReportMs;
+        bool m_inIteration;
+    };
+}
@@ -1,12 +1,21 @@
 #include "web_server.h"
 #include "config/role_config.h"
 #include "hardware/hardware_abstraction.h"
+#include "hardware/power_calibration.h"
+#include "sensors/battery_monitor.h"
+#include "sensors/battery_soc.h"
+#include "sensors/gps_sensor.h"
+#include "sensors/storm_tracker.h"
+#include "sensors/strike_density.h"
+#include "system/event_export.h"
 
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <Preferences.h>
 #include <WiFi.h>
 #include <WebServer.h>
+#include <memory>
+#include <new>
 
 static String getContentType(const String &path) {
     if (path.endsWith(".html")) return "text/html";
@@ -114,6 +123,12 @@ void WebServerManager::registerRoutes() {
     // ADC multiplier calibration endpoints
     server_.on("/api/adc_multiplier", HTTP_GET, [this]() { handleGetAdcMultiplier(); });
     server_.on("/api/adc_multiplier", HTTP_POST, [this]() { handleSetAdcMultiplier(); });
+
+    // GPS diagnostics
+    server_.on("/api/v1/gps/satellites", HTTP_GET, [this]() { handleGpsSatellites(); });
+    server_.on("/api/v1/lightning/storm", HTTP_GET, [this]() { handleLightningStorm(); });
+    server_.on("/api/v1/lightning/density", HTTP_GET, [this]() { handleLightningDensity(); });
+    server_.on("/api/v1/events", HTTP_GET, [this]() { handleEvents(); });
 }
 
 void WebServerManager::handleStaticFile(const String& path) {
@@ -139,6 +154,18 @@ void WebServerManager::handleStatus() {
     // Add role information
     doc["role"] = RoleConfig::isSender() ? "sender" : "receiver";
 
+    // Cached battery state; reading it does not touch the ADC
+    if (Sensors::g_batterySoc.hasEstimate()) {
+        JsonObject battery = doc.createNestedObject("battery");
+        battery["voltage"] = Sensors::g_batteryMonitor.getVoltage();
+        battery["percent"] = Sensors::g_batterySoc.getPercent();
+        battery["avg_current_ma"] = Sensors::g_batterySoc.getAverageCurrentMa();
+        const uint32_t remaining = Sensors::g_batterySoc.getRemainingMinutes();
+        if (remaining != UINT32_MAX) {
+            battery["remaining_min"] = remaining;
+        }
+    }
+
 #if defined(ENABLE_WIFI_OTA)
     doc["wifi_connected"] = (WiFi.status() == WL_CONNECTED);
     if (WiFi.status() == WL_CONNECTED) {
@@ -301,12 +328,21 @@ void WebServerManager::handleNotFound() {
     server_.send(404, "text/plain", "Not Found");
 }
 
-// ADC multiplier calibration handlers
+// ADC calibration handlers; values live in the HAL calibration store
+static void addAdcCalibration(JsonDocument& doc) {
+    const HardwareAbstraction::PowerCalibration& cal = HardwareAbstraction::g_powerCalibration;
+    doc["adc_multiplier"] = cal.getAdcMultiplier();
+    JsonArray points = doc.createNestedArray("points");
+    for (size_t i = 0; i < cal.pointCount(); i++) {
+        JsonObject point = points.createNestedObject();
+        point["pin_v"] = cal.point(i).pin_mv / 1000.0f;
+        point["battery_v"] = cal.point(i).battery_mv / 1000.0f;
+    }
+}
+
 void WebServerManager::handleGetAdcMultiplier() {
-    float multiplier = HardwareAbstraction::Power::getAdcMultiplier();
-    
-    DynamicJsonDocument doc(256);
-    doc["adc_multiplier"] = multiplier;
+    DynamicJsonDocument doc(768);
+    addAdcCalibration(doc);
     doc["status"] = "success";
     
     String response;
@@ -314,6 +350,10 @@ void WebServerManager::handleGetAdcMultiplier() {
     server_.send(200, "application/json", response);
 }
 
+// Accepts any of:
+//   {"adc_multiplier": 4.9}      single divider multiplier
+//   {"measured_voltage": 3.97}   meter reading now; paired with the current pin voltage
+//   {"clear_points": true}       back to the multiplier alone
 void WebServerManager::handleSetAdcMultiplier() {
     DynamicJsonDocument doc(256);
     if (!readJsonBody(server_, doc)) {
@@ -321,33 +361,229 @@ void WebServerManager::handleSetAdcMultiplier() {
         return;
     }
     
-    if (!doc.containsKey("adc_multiplier")) {
+    if (!doc.containsKey("adc_multiplier") && !doc.containsKey("measured_voltage") && !doc.containsKey("clear_points")) {
         server_.send(400, "application/json", "{\"status\":\"error\",\"message\":\"Missing adc_multiplier\"}");
         return;
     }
     
-    float multiplier = doc["adc_multiplier"];
+    HardwareAbstraction::PowerCalibration& cal = HardwareAbstraction::g_powerCalibration;
     
-    // Validate range (2.0 to 6.0 as per Meshtastic documentation)
-    if (multiplier < 2.0f || multiplier > 6.0f) {
-        server_.send(400, "application/json", "{\"status\":\"error\",\"message\":\"ADC multiplier must be between 2.0 and 6.0\"}");
-        return;
+    if (doc.containsKey("adc_multiplier")) {
+        float multiplier = doc["adc_multiplier"];
+    
+        // Validate range (2.0 to 6.0 as per Meshtastic documentation)
+        if (multiplier < HardwareAbstraction::PowerCalibration::MIN_MULTIPLIER ||
+            multiplier > HardwareAbstraction::PowerCalibration::MAX_MULTIPLIER) {
+            server_.send(400, "application/json", "{\"status\":\"error\",\"message\":\"ADC multiplier must be between 2.0 and 6.0\"}");
+            return;
+        }
+        HardwareAbstraction::Power::setAdcMultiplier(multiplier);
     }
     
-    // Set the new multiplier
-    HardwareAbstraction::Power::setAdcMultiplier(multiplier);
+    if (doc["clear_points"] | false) {
+        cal.clearPoints();
+    }
+    
+    if (doc.containsKey("measured_voltage")) {
+        if (!Sensors::g_batteryMonitor.hasReading()) {
+            server_.send(409, "application/json", "{\"status\":\"error\",\"message\":\"No battery reading yet\"}");
+            return;
+        }
+        const float measured = doc["measured_voltage"];
+        if (!cal.addPoint(Sensors::g_batteryMonitor.getPinVoltage(), measured)) {
+            server_.send(400, "application/json", "{\"status\":\"error\",\"message\":\"Calibration point rejected\"}");
+            return;
+        }
+    }
     
     // Return success response
-    DynamicJsonDocument responseDoc(256);
+    DynamicJsonDocument responseDoc(768);
     responseDoc["status"] = "success";
-    responseDoc["message"] = "ADC multiplier updated";
-    responseDoc["adc_multiplier"] = multiplier;
+    responseDoc["message"] = "ADC calibration updated";
+    addAdcCalibration(responseDoc);
     
     String response;
     serializeJson(responseDoc, response);
     server_.send(200, "application/json", response);
 }
 
+void WebServerManager::handleGpsSatellites() {
+    const GPS::SatelliteTable& table = GPS::g_gps.getSatelliteTable();
+    const GPS::FixQuality quality = GPS::g_gps.getFixQuality();
+
+    DynamicJsonDocument doc(4096);
+    doc["powered"] = GPS::g_gps.isPowered();
+    doc["has_fix"] = GPS::g_gps.hasValidFix();
+    doc["hdop"] = GPS::g_gps.getData().hdop;
+    doc["ttff_ms"] = quality.time_to_first_fix_ms;
+    doc["in_view"] = quality.satellites_in_view;
+    doc["tracked"] = quality.satellites_tracked;
+    doc["used"] = quality.satellites_used;
+    doc["mean_cn0_used"] = quality.mean_cn0_used;
+    doc["mean_cn0_tracked"] = quality.mean_cn0_tracked;
+    doc["max_cn0"] = quality.max_cn0;
+    doc["dropped"] = table.dropped;
+
+    JsonObject usedBy = doc.createNestedObject("used_by_constellation");
+    for (uint8_t c = 1; c < static_cast<uint8_t>(GPS::Constellation::COUNT); c++) {
+        if (quality.used_by_constellation[c] > 0) {
+            usedBy[GPS::constellationToString(static_cast<GPS::Constellation>(c))] = quality.used_by_constellation[c];
+        }
+    }
+
+    JsonArray sats = doc.createNestedArray("satellites");
+    for (uint8_t i = 0; i < table.count; i++) {
+        const GPS::SatelliteInfo& sat = table.satellites[i];
+        JsonObject entry = sats.createNestedObject();
+        entry["prn"] = sat.prn;
+        entry["sys"] = GPS::constellationToString(sat.constellation);
+        entry["el"] = sat.elevation_deg;
+        entry["az"] = sat.azimuth_deg;
+        entry["cn0"] = sat.cn0_dbhz;
+        entry["used"] = sat.used_in_fix;
+    }
+
+    String json;
+    serializeJson(doc, json);
+    server_.send(200, "application/json", json);
+}
+
+void WebServerManager::handleLightningStorm() {
+    Sensors::g_stormTracker.update(millis());
+    const Sensors::StormSummary& storm = Sensors::g_stormTracker.getSummary();
+
+    DynamicJsonDocument doc(1024);
+    doc["active"] = storm.active;
+    doc["started_ms"] = storm.started_ms;
+    doc["last_strike_ms"] = storm.last_strike_ms;
+    doc["strikes"] = storm.strikes;
+    doc["total_strikes"] = Sensors::g_stormTracker.getTotalStrikes();
+
+    JsonObject rates = doc.createNestedObject("rate_per_min");
+    rates["1min"] = storm.rate_1min;
+    rates["5min"] = storm.rate_5min;
+    rates["15min"] = storm.rate_15min;
+    doc["saturated"] = storm.saturated;
+    doc["trend"] = Sensors::stormTrendToString(storm.trend);
+
+    doc["distance_km"] = storm.distance_km;
+    doc["closest_km"] = storm.closest_km;
+    doc["peak_energy"] = storm.peak_energy;
+    doc["motion"] = Sensors::stormMotionToString(storm.motion);
+    if (storm.fit_valid) {
+        doc["approach_kmh"] = storm.approach_kmh;
+        doc["residual_km"] = storm.residual_km;
+    }
+    if (storm.eta_min >= 0.0f) {
+        doc["eta_min"] = storm.eta_min;
+    }
+
+    String json;
+    serializeJson(doc, json);
+    server_.send(200, "application/json", json);
+}
+
+void WebServerManager::handleLightningDensity() {
+    // Keep the grid centred on the receiver; setSite() ignores GPS jitter
+    if (GPS::g_gps.hasValidFix()) {
+        const GPS::Data& gps = GPS::g_gps.getData();
+        Sensors::g_strikeDensity.setSite(gps.latitude, gps.longitude);
+    }
+
+    // Worst case is ~8 KB: borrow it from the heap for the request only
+    std::unique_ptr<uint8_t[]> buffer(new (std::nothrow) uint8_t[Sensors::StrikeDensityGrid::MAX_ENCODED_BYTES]);
+    if (!buffer) {
+        server_.send(503, "text/plain", "Out of memory");
+        return;
+    }
+    const size_t length = Sensors::g_strikeDensity.encode(buffer.get(), Sensors::StrikeDensityGrid::MAX_ENCODED_BYTES,
+                                                          millis());
+    server_.sendHeader("Cache-Control", "no-store");
+    server_.send_P(200, "application/octet-stream", reinterpret_cast<const char*>(buffer.get()), length);
+}
+
+namespace {
+    struct EventStreamContext {
+        WebServer* server;
+        size_t minFreeHeap;
+    };
+
+    bool sendEventChunk(void* context, const uint8_t* data, size_t length) {
+        EventStreamContext* stream = static_cast<EventStreamContext*>(context);
+        stream->server->sendContent(reinterpret_cast<const char*>(data), length);
+
+        const size_t freeHeap = ESP.getFreeHeap();
+        if (freeHeap < stream->minFreeHeap) {
+            stream->minFreeHeap = freeHeap;
+        }
+        return stream->server->client().connected();
+    }
+
+    bool parseUint32Arg(WebServer& server, const char* name, uint32_t& value) {
+        if (!server.hasArg(name)) {
+            return true;
+        }
+        const String arg = server.arg(name);
+        char* end = nullptr;
+        const unsigned long parsed = strtoul(arg.c_str(), &end, 10);
+        if (arg.length() == 0 || *end != '\0') {
+            return false;
+        }
+        value = static_cast<uint32_t>(parsed);
+        return true;
+    }
+}
+
+void WebServerManager::handleEvents() {
+    if (!Logging::g_eventLog.isReady()) {
+        server_.send(503, "text/plain", "Event log unavailable");
+        return;
+    }
+
+    // from/to: unix seconds, limit: records per page, cursor: next_cursor of the previous page
+    Logging::EventQuery query = Logging::getDefaultEventQuery();
+    if (!parseUint32Arg(server_, "from", query.from_time) || !parseUint32Arg(server_, "to", query.to_time) ||
+        !parseUint32Arg(server_, "limit", query.limit) || !parseUint32Arg(server_, "cursor", query.cursor)) {
+        server_.send(400, "text/plain", "from, to, limit and cursor must be unsigned integers");
+        return;
+    }
+    if (query.to_time != 0 && query.from_time > query.to_time) {
+        server_.send(400, "text/plain", "from is after to");
+        return;
+    }
+    if (server_.hasArg("format")) {
+        const String format = server_.arg("format");
+        if (format == "binary") {
+            query.format = Logging::ExportFormat::BINARY;
+        } else if (format != "ndjson") {
+            server_.send(400, "text/plain", "format must be ndjson or binary");
+            return;
+        }
+    }
+
+    // Chunked transfer: nothing is buffered beyond the exporter's 1 KiB
+    const bool binary = query.format == Logging::ExportFormat::BINARY;
+    server_.sendHeader("Cache-Control", "no-store");
+    server_.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server_.send(200, binary ? "application/octet-stream" : "application/x-ndjson", "");
+
+    EventStreamContext stream = {&server_, ESP.getFreeHeap()};
+    const size_t heapBefore = stream.minFreeHeap;
+    const uint32_t start = millis();
+
+    Logging::EventExporter exporter(Logging::g_eventLog, sendEventChunk, &stream);
+    exporter.run(query);
+    server_.sendContent("");
+
+    const uint32_t elapsed = millis() - start;
+    const Logging::EventExportStats& stats = exporter.getStats();
+    Serial.printf("[WEB] events %s: %lu records, %lu B in %lu ms (%lu records/s), peak heap +%u B%s\n",
+                  Logging::exportFormatToString(query.format), (unsigned long)stats.records,
+                  (unsigned long)stats.bytes, (unsigned long)elapsed,
+                  (unsigned long)(elapsed ? stats.records * 1000ULL / elapsed : stats.records),
+                  (unsigned)(heapBefore - stream.minFreeHeap), stats.aborted ? " (client left)" : "");
+}
+
 bool WebServerManager::readJsonBody(WebServer &server, DynamicJsonDocument &doc) {
     if (server.hasArg("plain")) {
         DeserializationError err = deserializeJson(doc, server.arg("plain"));
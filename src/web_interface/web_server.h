@@ -43,6 +43,18 @@ private:
     void handleSetAdcMultiplier();
     void handleGetAdcMultiplier();
 
+    // GPS satellite table and fix quality (antenna placement tuning)
+    void handleGpsSatellites();
+
+    // Storm tracker summary (strike rates, approach speed, ETA)
+    void handleLightningStorm();
+
+    // Strike density heatmap (run-length-encoded binary, see strike_density.h)
+    void handleLightningDensity();
+
+    // Event log export: NDJSON or raw records, streamed with chunked encoding
+    void handleEvents();
+
     static bool readJsonBody(WebServer &server, DynamicJsonDocument &doc);
 };
 
@@ -20,9 +20,13 @@ unsigned long micros() {
     return static_cast<unsigned long>(duration.count());
 }
 
+void (*mockDelayHook)(unsigned long ms) = nullptr;
+
 void delay(unsigned long ms) {
-    // Mock delay - do nothing in test environment
-    (void)ms;
+    // Mock delay - do nothing in test environment unless a test hooks it
+    if (mockDelayHook) {
+        mockDelayHook(ms);
+    }
 }
 
 void delayMicroseconds(unsigned int us) {
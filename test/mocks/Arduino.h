@@ -24,12 +24,24 @@ typedef uint16_t word;
 #define LOW 0
 #define HIGH 1
 
+// Mock interrupt modes
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+// ISRs are placed in IRAM on the ESP32; no-op on the host
+#define IRAM_ATTR
+
 // Mock time functions
 unsigned long millis();
 unsigned long micros();
 void delay(unsigned long ms);
 void delayMicroseconds(unsigned int us);
 
+// delay() does not wait; a test on a simulated clock can set this so that
+// delay() advances it and a blocking wait shows up in measured time
+extern void (*mockDelayHook)(unsigned long ms);
+
 // Mock digital I/O
 void pinMode(uint8_t pin, uint8_t mode);
 void digitalWrite(uint8_t pin, uint8_t val);
@@ -75,6 +87,9 @@ public:
 extern TwoWire Wire;
 
 // Mock SPI
+#define MSBFIRST 1
+#define SPI_MODE1 1
+
 class SPIClass {
 public:
     void begin();
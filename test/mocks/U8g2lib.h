@@ -0,0 +1,122 @@
+#ifndef U8G2LIB_MOCK_H
+#define U8G2LIB_MOCK_H
+
+#ifdef ARDUINO_MOCK
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Headless U8g2 for the native tests. Draws into an in-memory 128x64 frame
+// buffer with the real full-buffer layout (8 pages of 128 column bytes) and
+// honours the display rotation, so getBufferPtr() can feed the dirty-tile
+// renderer exactly as on the board.
+//
+// Fonts keep the real glyph advances of the U8g2 fonts the firmware uses,
+// so text positions and string widths match the panel; the glyph shapes
+// come from one built-in 5x7 face. Snapshots are for catching layout
+// changes, not for judging typography.
+
+struct u8g2_cb_t {
+    uint8_t quarter_turns;              // Clockwise
+};
+
+extern const u8g2_cb_t u8g2_cb_r0;
+extern const u8g2_cb_t u8g2_cb_r1;
+extern const u8g2_cb_t u8g2_cb_r2;
+extern const u8g2_cb_t u8g2_cb_r3;
+
+#define U8G2_R0 (&u8g2_cb_r0)
+#define U8G2_R1 (&u8g2_cb_r1)
+#define U8G2_R2 (&u8g2_cb_r2)
+#define U8G2_R3 (&u8g2_cb_r3)
+
+#define U8X8_PIN_NONE 255
+
+// Mock font descriptors: { advance, scale }
+extern const uint8_t u8g2_font_4x6_tr[];
+extern const uint8_t u8g2_font_5x7_tr[];
+extern const uint8_t u8g2_font_6x10_tr[];
+extern const uint8_t u8g2_font_ncenB14_tr[];
+
+class U8G2 {
+public:
+    static constexpr int PANEL_WIDTH = 128;
+    static constexpr int PANEL_HEIGHT = 64;
+    static constexpr size_t BUFFER_BYTES = PANEL_WIDTH * PANEL_HEIGHT / 8;
+
+    explicit U8G2(const u8g2_cb_t* rotation = U8G2_R0);
+
+    bool begin() { return present_; }
+    void setI2CAddress(uint8_t address) { i2cAddress_ = address; }
+    void setPowerSave(uint8_t on) { powerSave_ = on != 0; }
+    void setContrast(uint8_t value) { contrast_ = value; }
+    void setDisplayRotation(const u8g2_cb_t* rotation) { rotation_ = rotation; }
+
+    uint8_t* getBufferPtr() { return buffer_; }
+    int getDisplayWidth() const;
+    int getDisplayHeight() const;
+
+    void clearBuffer();
+    void sendBuffer() { fullTransfers_++; }
+    void updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th);
+
+    void setDrawColor(uint8_t color) { drawColor_ = color; }
+    void setFont(const uint8_t* font) { font_ = font; }
+
+    void drawPixel(int x, int y);
+    void drawHLine(int x, int y, int w);
+    void drawVLine(int x, int y, int h);
+    void drawBox(int x, int y, int w, int h);
+    void drawFrame(int x, int y, int w, int h);
+    void drawCircle(int x0, int y0, int r);
+    void drawDisc(int x0, int y0, int r);
+
+    // y is the baseline; returns the advance like U8g2
+    int drawStr(int x, int y, const char* s);
+    int getStrWidth(const char* s) const;
+    int getAscent() const;
+
+    // Mock-only inspection
+    bool getPixel(int x, int y) const;                  // Rotated coordinates
+    std::string toPBM() const;                          // Plain PBM (P1), rotated as displayed
+    bool writePBM(const char* path) const;
+    void setPresent(bool present) { present_ = present; }
+    uint32_t pixelWrites() const { return pixelWrites_; }
+    uint32_t tilesUpdated() const { return tilesUpdated_; }
+    uint32_t fullTransfers() const { return fullTransfers_; }
+    bool powerSave() const { return powerSave_; }
+    uint8_t i2cAddress() const { return i2cAddress_; }
+    void clearCounters();
+
+private:
+    uint8_t buffer_[BUFFER_BYTES];
+    const u8g2_cb_t* rotation_;
+    const uint8_t* font_;
+    uint8_t drawColor_;
+    uint8_t i2cAddress_;
+    uint8_t contrast_;
+    bool powerSave_;
+    bool present_;
+    uint32_t pixelWrites_;
+    uint32_t tilesUpdated_;
+    uint32_t fullTransfers_;
+
+    bool toPanel(int x, int y, int& px, int& py) const;
+    void drawGlyph(int x, int y, char c);
+};
+
+class U8G2_SSD1306_128X64_NONAME_F_HW_I2C : public U8G2 {
+public:
+    explicit U8G2_SSD1306_128X64_NONAME_F_HW_I2C(const u8g2_cb_t* rotation, uint8_t reset = U8X8_PIN_NONE,
+                                                 uint8_t clock = U8X8_PIN_NONE, uint8_t data = U8X8_PIN_NONE)
+        : U8G2(rotation) {
+        (void)reset;
+        (void)clock;
+        (void)data;
+    }
+};
+
+#endif // ARDUINO_MOCK
+
+#endif // U8G2LIB_MOCK_H
@@ -0,0 +1,201 @@
+#include "as3935_mock.h"
+#include <cmath>
+#include <cstring>
+
+#ifdef ARDUINO_MOCK
+
+using namespace HardwareAbstraction;
+
+AS3935Mock::AS3935Mock()
+    : pointer_(0)
+    , irqPin_(0)
+    , present_(true)
+    , busMicrosPerByte_(0)
+    , inductanceUh_(100.0f)
+    , capacitancePf_(957.0f)        // 500 kHz near TUN_CAP 7
+    , spiCommandPending_(false)
+    , spiReading_(false)
+    , spiCounted_(false)
+{
+    loadDefaults();
+    clearCounters();
+}
+
+void AS3935Mock::loadDefaults() {
+    memset(regs_, 0, sizeof(regs_));
+    regs_[0x00] = 0x24;     // AFE_GB outdoor-ish default, powered up
+    regs_[0x01] = 0x22;     // NF_LEV = 2, WDTH = 2
+    regs_[0x02] = 0xC2;     // CL_STAT = 1, MIN_NUM_LIGH = 0, SREJ = 2
+    regs_[0x07] = 0x3F;     // Distance out of range
+}
+
+void AS3935Mock::clearCounters() {
+    readTransactions_ = 0;
+    writeTransactions_ = 0;
+    presetCount_ = 0;
+    rcoCalibrationCount_ = 0;
+    lcoGates_ = 0;
+}
+
+void AS3935Mock::attachI2C(uint8_t address, uint8_t irqPin) {
+    irqPin_ = irqPin;
+    Simulation::attachI2CDevice(address, this);
+    Simulation::attachPulseSource(irqPin, this);
+}
+
+void AS3935Mock::attachSPI(uint8_t irqPin) {
+    irqPin_ = irqPin;
+    Simulation::attachSPIDevice(this);
+    Simulation::attachPulseSource(irqPin, this);
+}
+
+void AS3935Mock::detach() {
+    Simulation::reset();
+}
+
+void AS3935Mock::writeRegister(uint8_t address, uint8_t value) {
+    address &= 0x3F;
+
+    if (address == 0x3C && value == 0x96) {
+        loadDefaults();
+        presetCount_++;
+        return;
+    }
+    if (address == 0x3D && value == 0x96) {
+        regs_[0x3A] = 0x80;
+        regs_[0x3B] = 0x80;
+        rcoCalibrationCount_++;
+        return;
+    }
+    regs_[address] = value;
+}
+
+uint8_t AS3935Mock::readRegister(uint8_t address) {
+    address &= 0x3F;
+    const uint8_t value = regs_[address];
+    if (address == 0x03) {
+        regs_[0x03] &= 0xF0;    // Reading INT clears the interrupt source
+    }
+    return value;
+}
+
+void AS3935Mock::busDelay(size_t bytes) {
+    if (busMicrosPerByte_) {
+        Simulation::advanceMicros(busMicrosPerByte_ * bytes);
+    }
+}
+
+bool AS3935Mock::i2cWrite(const uint8_t* data, size_t length) {
+    if (!present_ || length == 0) {
+        return false;
+    }
+    busDelay(length + 1);
+
+    pointer_ = data[0] & 0x3F;
+    if (length == 1) {
+        return true;    // Pointer set for a following read
+    }
+
+    writeTransactions_++;
+    for (size_t i = 1; i < length; i++) {
+        writeRegister(pointer_++, data[i]);
+    }
+    return true;
+}
+
+size_t AS3935Mock::i2cRead(uint8_t* data, size_t length) {
+    if (!present_) {
+        return 0;
+    }
+    busDelay(length + 1);
+
+    readTransactions_++;
+    for (size_t i = 0; i < length; i++) {
+        data[i] = readRegister(pointer_++);
+    }
+    return length;
+}
+
+void AS3935Mock::spiSelect() {
+    spiCommandPending_ = true;
+    spiCounted_ = false;
+}
+
+uint8_t AS3935Mock::spiTransfer(uint8_t data) {
+    busDelay(1);
+
+    if (spiCommandPending_) {
+        spiCommandPending_ = false;
+        spiReading_ = (data & 0xC0) == 0x40;
+        pointer_ = data & 0x3F;
+        return 0x00;
+    }
+
+    if (!spiCounted_) {
+        spiCounted_ = true;
+        if (spiReading_) {
+            readTransactions_++;
+        } else {
+            writeTransactions_++;
+        }
+    }
+
+    if (!present_) {
+        return 0x00;
+    }
+    if (spiReading_) {
+        return readRegister(pointer_++);
+    }
+    writeRegister(pointer_++, data);
+    return 0x00;
+}
+
+void AS3935Mock::spiDeselect() {
+    spiCommandPending_ = false;
+}
+
+void AS3935Mock::setTank(float inductanceUh, float capacitancePf) {
+    inductanceUh_ = inductanceUh;
+    capacitancePf_ = capacitancePf;
+}
+
+float AS3935Mock::lcoFrequencyHz(uint8_t tuningCap) const {
+    const double l = inductanceUh_ * 1e-6;
+    const double c = (capacitancePf_ + 8.0 * (tuningCap & 0x0F)) * 1e-12;
+    return static_cast<float>(1.0 / (2.0 * M_PI * sqrt(l * c)));
+}
+
+uint32_t AS3935Mock::countEdges(uint8_t pin, uint32_t gateUs) {
+    (void)pin;
+    lcoGates_++;
+    if (!present_ || !(regs_[0x08] & 0x80)) {
+        return 0;
+    }
+
+    static const uint32_t dividers[4] = {16, 32, 64, 128};
+    const uint32_t divider = dividers[(regs_[0x03] >> 6) & 0x03];
+    return static_cast<uint32_t>(lcoFrequencyHz(regs_[0x08]) / divider * gateUs / 1e6);
+}
+
+void AS3935Mock::raise(uint8_t interrupt) {
+    regs_[0x03] = (regs_[0x03] & 0xF0) | (interrupt & 0x0F);
+    Simulation::triggerInterrupt(irqPin_);
+}
+
+void AS3935Mock::scriptLightning(uint8_t distanceKm, uint32_t energy) {
+    regs_[0x04] = energy & 0xFF;
+    regs_[0x05] = (energy >> 8) & 0xFF;
+    regs_[0x06] = (energy >> 16) & 0x1F;
+    regs_[0x07] = distanceKm & 0x3F;
+    raise(0x08);
+}
+
+void AS3935Mock::scriptDisturber() {
+    raise(0x04);
+}
+
+void AS3935Mock::scriptNoise() {
+    raise(0x01);
+}
+
+#endif // ARDUINO_MOCK
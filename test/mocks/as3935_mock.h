@@ -0,0 +1,92 @@
+#ifndef AS3935_MOCK_H
+#define AS3935_MOCK_H
+
+#ifdef ARDUINO_MOCK
+
+#include <cstdint>
+#include <cstddef>
+#include "../../src/hardware/hardware_abstraction.h"
+
+// Register-level AS3935 model for the native bus simulation.
+// Serves both the I2C (register pointer + auto-increment) and SPI
+// (mode bits in the address byte) protocols, and drives LCO/FDIV onto
+// the IRQ pin from a parallel LC tank model when DISP_LCO is set.
+class AS3935Mock : public HardwareAbstraction::Simulation::BusDevice,
+                   public HardwareAbstraction::Simulation::PulseSource {
+public:
+    static constexpr size_t REGISTER_COUNT = 0x40;
+
+    AS3935Mock();
+
+    // Bus attachment; irqPin is the pin whose ISR the scripting helpers fire
+    void attachI2C(uint8_t address, uint8_t irqPin);
+    void attachSPI(uint8_t irqPin);
+    void detach();
+
+    // BusDevice
+    bool i2cWrite(const uint8_t* data, size_t length) override;
+    size_t i2cRead(uint8_t* data, size_t length) override;
+    void spiSelect() override;
+    uint8_t spiTransfer(uint8_t data) override;
+    void spiDeselect() override;
+
+    // PulseSource
+    uint32_t countEdges(uint8_t pin, uint32_t gateUs) override;
+
+    // Antenna model: f = 1 / (2*pi*sqrt(L * (C + 8 pF * TUN_CAP)))
+    void setTank(float inductanceUh, float capacitancePf);
+    float lcoFrequencyHz(uint8_t tuningCap) const;
+    uint32_t lcoGates() const { return lcoGates_; }
+
+    // Event scripting: load INT/energy/distance and raise IRQ
+    void scriptLightning(uint8_t distanceKm, uint32_t energy);
+    void scriptDisturber();
+    void scriptNoise();
+
+    // Direct register access for assertions
+    uint8_t reg(uint8_t address) const { return regs_[address & 0x3F]; }
+    void setReg(uint8_t address, uint8_t value) { regs_[address & 0x3F] = value; }
+
+    // Simulated chip absent: I2C NACKs, SPI reads 0x00
+    void setPresent(bool present) { present_ = present; }
+
+    // Advance the simulated clock by this much per byte moved on the bus
+    void setBusMicrosPerByte(uint32_t us) { busMicrosPerByte_ = us; }
+
+    // Transaction counters
+    uint32_t readTransactions() const { return readTransactions_; }
+    uint32_t writeTransactions() const { return writeTransactions_; }
+    uint32_t presetCount() const { return presetCount_; }
+    uint32_t rcoCalibrationCount() const { return rcoCalibrationCount_; }
+    void clearCounters();
+
+private:
+    uint8_t regs_[REGISTER_COUNT];
+    uint8_t pointer_;
+    uint8_t irqPin_;
+    bool present_;
+    uint32_t busMicrosPerByte_;
+    float inductanceUh_;
+    float capacitancePf_;
+
+    // SPI transaction state
+    bool spiCommandPending_;
+    bool spiReading_;
+    bool spiCounted_;
+
+    uint32_t readTransactions_;
+    uint32_t writeTransactions_;
+    uint32_t presetCount_;
+    uint32_t rcoCalibrationCount_;
+    uint32_t lcoGates_;
+
+    void loadDefaults();
+    void writeRegister(uint8_t address, uint8_t value);
+    uint8_t readRegister(uint8_t address);
+    void busDelay(size_t bytes);
+    void raise(uint8_t interrupt);
+};
+
+#endif // ARDUINO_MOCK
+
+#endif // AS3935_MOCK_H
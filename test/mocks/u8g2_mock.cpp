@@ -0,0 +1,285 @@
+#include "U8g2lib.h"
+#include <cstdio>
+#include <cstring>
+
+#ifdef ARDUINO_MOCK
+
+const u8g2_cb_t u8g2_cb_r0 = {0};
+const u8g2_cb_t u8g2_cb_r1 = {1};
+const u8g2_cb_t u8g2_cb_r2 = {2};
+const u8g2_cb_t u8g2_cb_r3 = {3};
+
+// Advances of the real fonts; ncenB14 is proportional, 11 px is its
+// typical capital width
+const uint8_t u8g2_font_4x6_tr[] = {4, 1};
+const uint8_t u8g2_font_5x7_tr[] = {5, 1};
+const uint8_t u8g2_font_6x10_tr[] = {6, 1};
+const uint8_t u8g2_font_ncenB14_tr[] = {11, 2};
+
+namespace {
+    constexpr int GLYPH_WIDTH = 5;
+    constexpr int GLYPH_HEIGHT = 7;
+
+    // Classic 5x7 ASCII face, ' ' to '~': one byte per column, bit 0 on top
+    const uint8_t GLYPHS[][GLYPH_WIDTH] = {
+        {0x00, 0x00, 0x00, 0x00, 0x00}, {0x00, 0x00, 0x5F, 0x00, 0x00}, {0x00, 0x07, 0x00, 0x07, 0x00},
+        {0x14, 0x7F, 0x14, 0x7F, 0x14}, {0x24, 0x2A, 0x7F, 0x2A, 0x12}, {0x23, 0x13, 0x08, 0x64, 0x62},
+        {0x36, 0x49, 0x55, 0x22, 0x50}, {0x00, 0x05, 0x03, 0x00, 0x00}, {0x00, 0x1C, 0x22, 0x41, 0x00},
+        {0x00, 0x41, 0x22, 0x1C, 0x00}, {0x08, 0x2A, 0x1C, 0x2A, 0x08}, {0x08, 0x08, 0x3E, 0x08, 0x08},
+        {0x00, 0x50, 0x30, 0x00, 0x00}, {0x08, 0x08, 0x08, 0x08, 0x08}, {0x00, 0x60, 0x60, 0x00, 0x00},
+        {0x20, 0x10, 0x08, 0x04, 0x02}, {0x3E, 0x51, 0x49, 0x45, 0x3E}, {0x00, 0x42, 0x7F, 0x40, 0x00},
+        {0x42, 0x61, 0x51, 0x49, 0x46}, {0x21, 0x41, 0x45, 0x4B, 0x31}, {0x18, 0x14, 0x12, 0x7F, 0x10},
+        {0x27, 0x45, 0x45, 0x45, 0x39}, {0x3C, 0x4A, 0x49, 0x49, 0x30}, {0x01, 0x71, 0x09, 0x05, 0x03},
+        {0x36, 0x49, 0x49, 0x49, 0x36}, {0x06, 0x49, 0x49, 0x29, 0x1E}, {0x00, 0x36, 0x36, 0x00, 0x00},
+        {0x00, 0x56, 0x36, 0x00, 0x00}, {0x08, 0x14, 0x22, 0x41, 0x00}, {0x14, 0x14, 0x14, 0x14, 0x14},
+        {0x00, 0x41, 0x22, 0x14, 0x08}, {0x02, 0x01, 0x51, 0x09, 0x06}, {0x32, 0x49, 0x79, 0x41, 0x3E},
+        {0x7E, 0x11, 0x11, 0x11, 0x7E}, {0x7F, 0x49, 0x49, 0x49, 0x36}, {0x3E, 0x41, 0x41, 0x41, 0x22},
+        {0x7F, 0x41, 0x41, 0x22, 0x1C}, {0x7F, 0x49, 0x49, 0x49, 0x41}, {0x7F, 0x09, 0x09, 0x09, 0x01},
+        {0x3E, 0x41, 0x49, 0x49, 0x7A}, {0x7F, 0x08, 0x08, 0x08, 0x7F}, {0x00, 0x41, 0x7F, 0x41, 0x00},
+        {0x20, 0x40, 0x41, 0x3F, 0x01}, {0x7F, 0x08, 0x14, 0x22, 0x41}, {0x7F, 0x40, 0x40, 0x40, 0x40},
+        {0x7F, 0x02, 0x0C, 0x02, 0x7F}, {0x7F, 0x04, 0x08, 0x10, 0x7F}, {0x3E, 0x41, 0x41, 0x41, 0x3E},
+        {0x7F, 0x09, 0x09, 0x09, 0x06}, {0x3E, 0x41, 0x51, 0x21, 0x5E}, {0x7F, 0x09, 0x19, 0x29, 0x46},
+        {0x46, 0x49, 0x49, 0x49, 0x31}, {0x01, 0x01, 0x7F, 0x01, 0x01}, {0x3F, 0x40, 0x40, 0x40, 0x3F},
+        {0x1F, 0x20, 0x40, 0x20, 0x1F}, {0x3F, 0x40, 0x38, 0x40, 0x3F}, {0x63, 0x14, 0x08, 0x14, 0x63},
+        {0x07, 0x08, 0x70, 0x08, 0x07}, {0x61, 0x51, 0x49, 0x45, 0x43}, {0x00, 0x7F, 0x41, 0x41, 0x00},
+        {0x02, 0x04, 0x08, 0x10, 0x20}, {0x00, 0x41, 0x41, 0x7F, 0x00}, {0x04, 0x02, 0x01, 0x02, 0x04},
+        {0x40, 0x40, 0x40, 0x40, 0x40}, {0x00, 0x01, 0x02, 0x04, 0x00}, {0x20, 0x54, 0x54, 0x54, 0x78},
+        {0x7F, 0x48, 0x44, 0x44, 0x38}, {0x38, 0x44, 0x44, 0x44, 0x20}, {0x38, 0x44, 0x44, 0x48, 0x7F},
+        {0x38, 0x54, 0x54, 0x54, 0x18}, {0x08, 0x7E, 0x09, 0x01, 0x02}, {0x0C, 0x52, 0x52, 0x52, 0x3E},
+        {0x7F, 0x08, 0x04, 0x04, 0x78}, {0x00, 0x44, 0x7D, 0x40, 0x00}, {0x20, 0x40, 0x44, 0x3D, 0x00},
+        {0x7F, 0x10, 0x28, 0x44, 0x00}, {0x00, 0x41, 0x7F, 0x40, 0x00}, {0x7C, 0x04, 0x18, 0x04, 0x78},
+        {0x7C, 0x08, 0x04, 0x04, 0x78}, {0x38, 0x44, 0x44, 0x44, 0x38}, {0x7C, 0x14, 0x14, 0x14, 0x08},
+        {0x08, 0x14, 0x14, 0x18, 0x7C}, {0x7C, 0x08, 0x04, 0x04, 0x08}, {0x48, 0x54, 0x54, 0x54, 0x20},
+        {0x04, 0x3F, 0x44, 0x40, 0x20}, {0x3C, 0x40, 0x40, 0x20, 0x7C}, {0x1C, 0x20, 0x40, 0x20, 0x1C},
+        {0x3C, 0x40, 0x30, 0x40, 0x3C}, {0x44, 0x28, 0x10, 0x28, 0x44}, {0x0C, 0x50, 0x50, 0x50, 0x3C},
+        {0x44, 0x64, 0x54, 0x4C, 0x44}, {0x00, 0x08, 0x36, 0x41, 0x00}, {0x00, 0x00, 0x7F, 0x00, 0x00},
+        {0x00, 0x41, 0x36, 0x08, 0x00}, {0x08, 0x04, 0x08, 0x10, 0x08},
+    };
+}
+
+U8G2::U8G2(const u8g2_cb_t* rotation)
+    : rotation_(rotation)
+    , font_(u8g2_font_6x10_tr)
+    , drawColor_(1)
+    , i2cAddress_(0x78)
+    , contrast_(255)
+    , powerSave_(false)
+    , present_(true)
+{
+    memset(buffer_, 0, sizeof(buffer_));
+    clearCounters();
+}
+
+void U8G2::clearCounters() {
+    pixelWrites_ = 0;
+    tilesUpdated_ = 0;
+    fullTransfers_ = 0;
+}
+
+int U8G2::getDisplayWidth() const {
+    return (rotation_->quarter_turns & 1) ? PANEL_HEIGHT : PANEL_WIDTH;
+}
+
+int U8G2::getDisplayHeight() const {
+    return (rotation_->quarter_turns & 1) ? PANEL_WIDTH : PANEL_HEIGHT;
+}
+
+// Same mapping as U8g2's u8g2_cb_r0..r3 callbacks
+bool U8G2::toPanel(int x, int y, int& px, int& py) const {
+    if (x < 0 || y < 0 || x >= getDisplayWidth() || y >= getDisplayHeight()) {
+        return false;
+    }
+    switch (rotation_->quarter_turns & 3) {
+        case 0: px = x; py = y; break;
+        case 1: px = PANEL_WIDTH - 1 - y; py = x; break;
+        case 2: px = PANEL_WIDTH - 1 - x; py = PANEL_HEIGHT - 1 - y; break;
+        default: px = y; py = PANEL_HEIGHT - 1 - x; break;
+    }
+    return true;
+}
+
+void U8G2::clearBuffer() {
+    memset(buffer_, 0, sizeof(buffer_));
+}
+
+void U8G2::updateDisplayArea(uint8_t tx, uint8_t ty, uint8_t tw, uint8_t th) {
+    (void)tx;
+    (void)ty;
+    tilesUpdated_ += static_cast<uint32_t>(tw) * th;
+}
+
+void U8G2::drawPixel(int x, int y) {
+    int px, py;
+    if (!toPanel(x, y, px, py)) {
+        return;
+    }
+    uint8_t& byte = buffer_[(py / 8) * PANEL_WIDTH + px];
+    const uint8_t bit = static_cast<uint8_t>(1u << (py % 8));
+    switch (drawColor_) {
+        case 0: byte &= static_cast<uint8_t>(~bit); break;
+        case 1: byte |= bit; break;
+        default: byte ^= bit; break;
+    }
+    pixelWrites_++;
+}
+
+bool U8G2::getPixel(int x, int y) const {
+    int px, py;
+    if (!toPanel(x, y, px, py)) {
+        return false;
+    }
+    return (buffer_[(py / 8) * PANEL_WIDTH + px] >> (py % 8)) & 1;
+}
+
+void U8G2::drawHLine(int x, int y, int w) {
+    for (int i = 0; i < w; i++) {
+        drawPixel(x + i, y);
+    }
+}
+
+void U8G2::drawVLine(int x, int y, int h) {
+    for (int i = 0; i < h; i++) {
+        drawPixel(x, y + i);
+    }
+}
+
+void U8G2::drawBox(int x, int y, int w, int h) {
+    for (int i = 0; i < h; i++) {
+        drawHLine(x, y + i, w);
+    }
+}
+
+void U8G2::drawFrame(int x, int y, int w, int h) {
+    if (w <= 0 || h <= 0) {
+        return;
+    }
+    drawHLine(x, y, w);
+    drawHLine(x, y + h - 1, w);
+    drawVLine(x, y + 1, h - 2);
+    drawVLine(x + w - 1, y + 1, h - 2);
+}
+
+// Midpoint circle as in u8g2_draw_circle(); each octant pixel drawn once
+void U8G2::drawCircle(int x0, int y0, int r) {
+    int f = 1 - r;
+    int ddF_x = 1;
+    int ddF_y = -2 * r;
+    int x = 0;
+    int y = r;
+
+    drawPixel(x0, y0 + r);
+    drawPixel(x0, y0 - r);
+    drawPixel(x0 + r, y0);
+    drawPixel(x0 - r, y0);
+    while (x < y) {
+        if (f >= 0) {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+        drawPixel(x0 + x, y0 + y);
+        drawPixel(x0 - x, y0 + y);
+        drawPixel(x0 + x, y0 - y);
+        drawPixel(x0 - x, y0 - y);
+        if (x != y) {
+            drawPixel(x0 + y, y0 + x);
+            drawPixel(x0 - y, y0 + x);
+            drawPixel(x0 + y, y0 - x);
+            drawPixel(x0 - y, y0 - x);
+        }
+    }
+}
+
+// Filled with the same outline, one horizontal span per row
+void U8G2::drawDisc(int x0, int y0, int r) {
+    int f = 1 - r;
+    int ddF_x = 1;
+    int ddF_y = -2 * r;
+    int x = 0;
+    int y = r;
+
+    drawHLine(x0 - r, y0, 2 * r + 1);
+    while (x < y) {
+        if (f >= 0) {
+            drawHLine(x0 - x, y0 + y, 2 * x + 1);
+            drawHLine(x0 - x, y0 - y, 2 * x + 1);
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+        if (x <= y) {
+            drawHLine(x0 - y, y0 + x, 2 * y + 1);
+            drawHLine(x0 - y, y0 - x, 2 * y + 1);
+        }
+    }
+}
+
+void U8G2::drawGlyph(int x, int y, char c) {
+    if (c < ' ' || c > '~') {
+        c = '?';
+    }
+    const uint8_t* columns = GLYPHS[c - ' '];
+    const int scale = font_[1];
+    const int top = y - GLYPH_HEIGHT * scale;
+    for (int col = 0; col < GLYPH_WIDTH; col++) {
+        for (int row = 0; row < GLYPH_HEIGHT; row++) {
+            if (!((columns[col] >> row) & 1)) {
+                continue;
+            }
+            for (int sy = 0; sy < scale; sy++) {
+                for (int sx = 0; sx < scale; sx++) {
+                    drawPixel(x + col * scale + sx, top + row * scale + sy);
+                }
+            }
+        }
+    }
+}
+
+int U8G2::drawStr(int x, int y, const char* s) {
+    int width = 0;
+    for (; *s; s++) {
+        drawGlyph(x + width, y, *s);
+        width += font_[0];
+    }
+    return width;
+}
+
+int U8G2::getStrWidth(const char* s) const {
+    return static_cast<int>(strlen(s)) * font_[0];
+}
+
+int U8G2::getAscent() const {
+    return GLYPH_HEIGHT * font_[1];
+}
+
+std::string U8G2::toPBM() const {
+    const int width = getDisplayWidth();
+    const int height = getDisplayHeight();
+    std::string out = "P1\n" + std::to_string(width) + " " + std::to_string(height) + "\n";
+    out.reserve(out.size() + static_cast<size_t>((width + 1) * height));
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            out += getPixel(x, y) ? '1' : '0';
+        }
+        out += '\n';
+    }
+    return out;
+}
+
+bool U8G2::writePBM(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        return false;
+    }
+    const std::string pbm = toPBM();
+    const bool ok = fwrite(pbm.data(), 1, pbm.size(), file) == pbm.size();
+    return fclose(file) == 0 && ok;
+}
+
+#endif // ARDUINO_MOCK
@@ -0,0 +1,265 @@
+// Unit tests for the continuous ADC sampler: rate planning, decimation,
+// timestamps and the HAL/battery consumers, driven by simulated signals
+#include <unity.h>
+#include "../src/hardware/adc_continuous.h"
+#include "../src/hardware/hardware_abstraction.h"
+#include "../src/sensors/battery_monitor.h"
+#include <cmath>
+
+using namespace HardwareAbstraction;
+using Simulation::SignalGenerator;
+
+static const uint32_t T0 = 1000000;
+
+static uint16_t codeFor(float volts) {
+    return static_cast<uint16_t>(lroundf(volts / 3.3f * 4095.0f));
+}
+
+void setUp(void) {
+    Simulation::reset();
+    Simulation::setMicros(T0);
+}
+
+void tearDown(void) {
+    g_continuousAdc.stop();
+    g_continuousAdc.clearChannels();
+    Simulation::attachAnalogSource(1, nullptr);
+    Simulation::attachAnalogSource(2, nullptr);
+}
+
+void test_signal_generator_shapes() {
+    SignalGenerator gen;
+    gen.dc(1.65f);
+    TEST_ASSERT_EQUAL_UINT16(codeFor(1.65f), gen.sample(1, 0));
+
+    gen.wave(SignalGenerator::Wave::SINE, 1.0f, 50.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.65f, gen.voltsAt(5000));     // Quarter period
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.65f, gen.voltsAt(15000));
+
+    gen.wave(SignalGenerator::Wave::SQUARE, 2.0f, 100.0f);
+    TEST_ASSERT_EQUAL_UINT16(4095, gen.sample(1, 1000));              // Clipped high
+    TEST_ASSERT_EQUAL_UINT16(0, gen.sample(1, 6000));                 // Clipped low
+    TEST_ASSERT_EQUAL_UINT32(3, gen.samples);
+
+    // Noise stays within its peak and repeats for the same seed
+    SignalGenerator a;
+    SignalGenerator b;
+    a.dc(1.0f).noise(0.1f, 7);
+    b.dc(1.0f).noise(0.1f, 7);
+    for (int i = 0; i < 200; i++) {
+        const uint16_t code = a.sample(1, 0);
+        TEST_ASSERT_EQUAL_UINT16(code, b.sample(1, 0));
+        TEST_ASSERT_INT_WITHIN(125, codeFor(1.0f), code);
+    }
+}
+
+void test_rate_planning_and_decimation() {
+    ContinuousAdc adc;
+    TEST_ASSERT_EQUAL(Result::ERROR_INVALID_PARAMETER, adc.start());    // Nothing registered
+    TEST_ASSERT_EQUAL(Result::ERROR_INVALID_PARAMETER, adc.addChannel(11, 100));   // ADC2
+    TEST_ASSERT_EQUAL(Result::ERROR_INVALID_PARAMETER, adc.addChannel(0, 100));
+    TEST_ASSERT_EQUAL(Result::ERROR_INVALID_PARAMETER, adc.addChannel(1, 0));
+
+    TEST_ASSERT_EQUAL(Result::SUCCESS, adc.addChannel(1, 1000));
+    TEST_ASSERT_EQUAL(Result::SUCCESS, adc.addChannel(2, 100));
+    TEST_ASSERT_EQUAL(Result::SUCCESS, adc.start());
+    TEST_ASSERT_EQUAL_UINT32(2000, adc.getControllerHz());
+    TEST_ASSERT_EQUAL_FLOAT(1000.0f, adc.getEffectiveRate(1));
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, adc.getEffectiveRate(2));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, adc.getEffectiveRate(3));
+    TEST_ASSERT_EQUAL(Result::ERROR_INVALID_PARAMETER, adc.addChannel(3, 10));  // Fixed while running
+
+    // One second serviced every 10 ms: every conversion lands, each channel
+    // at its own rate
+    for (int i = 0; i < 100; i++) {
+        Simulation::advanceMicros(i == 99 ? 9999 : 10000);
+        adc.service();
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, adc.getStats().skipped);
+    TEST_ASSERT_EQUAL_UINT32(2000, adc.getStats().conversions);
+    TEST_ASSERT_EQUAL_UINT32(1000 + 100, adc.getStats().outputs);
+
+    // A slow channel alone runs the controller at its floor and decimates
+    adc.stop();
+    adc.clearChannels();
+    adc.addChannel(1, 10);
+    adc.start();
+    TEST_ASSERT_EQUAL_UINT32(ContinuousAdc::MIN_CONTROLLER_HZ, adc.getControllerHz());
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 10.0f, adc.getEffectiveRate(1));
+}
+
+void test_read_since_is_oldest_first_with_timestamps() {
+    SignalGenerator gen;
+    gen.dc(1.2f);
+    Simulation::attachAnalogSource(1, &gen);
+
+    ContinuousAdc adc;
+    adc.addChannel(1, 1000);
+    adc.start();
+    Simulation::advanceMicros(10000);
+
+    ContinuousSample out[ContinuousAdc::RING_SIZE];
+    const size_t count = adc.readSince(1, T0 + 4500, out, ContinuousAdc::RING_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(6, count);
+    for (size_t i = 0; i < count; i++) {
+        TEST_ASSERT_EQUAL_UINT32(T0 + 5000 + i * 1000, out[i].timestamp_us);
+        TEST_ASSERT_EQUAL_UINT16(codeFor(1.2f), out[i].raw);
+    }
+
+    // Capped to the newest when asked for fewer
+    TEST_ASSERT_EQUAL_UINT32(2, adc.readSince(1, T0 + 4500, out, 2));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 9000, out[0].timestamp_us);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 10000, out[1].timestamp_us);
+    TEST_ASSERT_EQUAL_UINT32(0, adc.readSince(1, T0 + 10000, out, 4));
+    TEST_ASSERT_EQUAL_UINT32(0, adc.readSince(3, T0, out, 4));
+}
+
+// Decimation averages: a 50 Hz hum sampled at 50 Hz outputs comes out as
+// its DC level, and noise shrinks in the ring average
+void test_decimated_values_filter_signal() {
+    SignalGenerator hum;
+    hum.dc(1.65f).wave(SignalGenerator::Wave::SINE, 0.5f, 50.0f);
+    SignalGenerator noisy;
+    noisy.dc(1.0f).noise(0.2f, 3);
+    Simulation::attachAnalogSource(1, &noisy);
+    Simulation::attachAnalogSource(2, &hum);
+
+    ContinuousAdc adc;
+    adc.addChannel(1, 1000);
+    adc.addChannel(2, 50);
+    adc.start();
+    Simulation::advanceMicros(500000);
+
+    float volts = 0.0f;
+    TEST_ASSERT_TRUE(adc.latestVoltage(2, volts));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.65f, volts);
+
+    float raw = 0.0f;
+    TEST_ASSERT_EQUAL_UINT32(ContinuousAdc::RING_SIZE, adc.average(1, 100, raw));
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 1.0f, adc.toVolts(static_cast<uint16_t>(lroundf(raw))));
+    TEST_ASSERT_EQUAL_UINT32(4, adc.average(2, 4, raw));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.65f, adc.toVolts(static_cast<uint16_t>(lroundf(raw))));
+}
+
+// After a long gap only what can still reach the rings is generated
+void test_long_gap_is_capped() {
+    SignalGenerator gen;
+    gen.dc(0.5f);
+    Simulation::attachAnalogSource(1, &gen);
+
+    ContinuousAdc adc;
+    adc.addChannel(1, 1000);
+    adc.addChannel(2, 100);
+    adc.start();
+    Simulation::advanceMicros(60000000);
+    adc.service();
+
+    const ContinuousAdcStats& stats = adc.getStats();
+    TEST_ASSERT_TRUE(stats.skipped > 0);
+    TEST_ASSERT_TRUE(stats.conversions <= (ContinuousAdc::RING_SIZE + 1) * 10 * 2 + 2);
+    TEST_ASSERT_EQUAL_UINT32(120000 + 1, stats.conversions + stats.skipped);
+
+    ContinuousSample out[ContinuousAdc::RING_SIZE];
+    const size_t count = adc.readSince(1, T0, out, ContinuousAdc::RING_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(ContinuousAdc::RING_SIZE, count);
+    TEST_ASSERT_UINT32_WITHIN(1000, T0 + 60000000, out[count - 1].timestamp_us);
+    TEST_ASSERT_EQUAL_UINT32(1000, out[1].timestamp_us - out[0].timestamp_us);
+    TEST_ASSERT_EQUAL_UINT32(ContinuousAdc::RING_SIZE, adc.readSince(2, T0, out, ContinuousAdc::RING_SIZE));
+}
+
+// One-shot HAL reads of a sampled pin come from the ring
+void test_hal_read_served_from_ring() {
+    initialize();
+    ADC::initialize();
+    SignalGenerator gen;
+    gen.dc(2.0f);
+    Simulation::attachAnalogSource(1, &gen);
+
+    g_continuousAdc.addChannel(1, 1000);
+    const uint32_t generation = g_continuousAdc.getGeneration();
+    TEST_ASSERT_EQUAL(Result::SUCCESS, g_continuousAdc.start());
+    TEST_ASSERT_NOT_EQUAL(generation, g_continuousAdc.getGeneration());
+    Simulation::advanceMicros(5000);
+
+    uint16_t value = 0;
+    TEST_ASSERT_EQUAL(Result::SUCCESS, ADC::read(1, value));
+    TEST_ASSERT_EQUAL_UINT16(codeFor(2.0f), value);
+    const uint32_t sampled = gen.samples;
+    TEST_ASSERT_EQUAL(Result::SUCCESS, ADC::read(1, value));
+    TEST_ASSERT_EQUAL_UINT32(sampled, gen.samples);                  // Nothing converted for it
+
+    g_continuousAdc.stop();
+    TEST_ASSERT_EQUAL(Result::SUCCESS, ADC::read(1, value));
+    TEST_ASSERT_EQUAL_UINT32(sampled + 1, gen.samples);              // Back to one-shot
+}
+
+// Battery bursts from the ring use only conversions after the divider settled
+class GatedDivider : public Simulation::AnalogSource {
+public:
+    float vbat = 3.9f;
+    uint16_t sample(uint8_t pin, uint32_t nowUs) override {
+        if (GPIO::digitalRead(37) == GPIO::Level::LEVEL_HIGH) {
+            return 0;
+        }
+        return static_cast<uint16_t>(lroundf(vbat / 4.9f / 3.3f * 4095.0f));
+    }
+};
+
+void test_battery_monitor_uses_ring() {
+    initialize();
+    ADC::initialize();
+    GatedDivider divider;
+    Simulation::attachAnalogSource(1, &divider);
+    Sensors::BatteryMonitorConfig config = Sensors::getDefaultBatteryMonitorConfig();
+    TEST_ASSERT_EQUAL_UINT32(1000, Sensors::BatteryMonitor::continuousRateHz(config));
+    g_continuousAdc.addChannel(1, Sensors::BatteryMonitor::continuousRateHz(config));
+
+    Sensors::BatteryMonitor monitor;
+    config.continuous = &g_continuousAdc;
+    monitor.begin(config, Timer::millis());
+
+    // Gate opens, then 3 ms settling plus 16 outputs at 1 kHz
+    uint32_t elapsedMs = 0;
+    while (!monitor.hasReading() && elapsedMs < 100) {
+        monitor.update(Timer::millis());
+        Simulation::advanceMicros(1000);
+        elapsedMs++;
+    }
+    TEST_ASSERT_TRUE(monitor.hasReading());
+    TEST_ASSERT_UINT32_WITHIN(2, 3 + 16, elapsedMs);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.9f, monitor.getVoltage());
+    TEST_ASSERT_EQUAL_UINT32(16, monitor.getStats().samples);
+    TEST_ASSERT_EQUAL_UINT32(0, monitor.getStats().failed_reads);
+    TEST_ASSERT_EQUAL(GPIO::Level::LEVEL_HIGH, GPIO::digitalRead(37));  // Gate closed again
+
+    // The sampler ran for the burst only
+    TEST_ASSERT_FALSE(g_continuousAdc.isRunning());
+    const uint32_t conversions = g_continuousAdc.getStats().conversions;
+    TEST_ASSERT_UINT32_WITHIN(3, 3 + 16, conversions);
+    Simulation::advanceMicros(5000000);
+    monitor.update(Timer::millis());
+    TEST_ASSERT_EQUAL_UINT32(conversions, g_continuousAdc.getStats().conversions);
+
+    // Next burst starts it again
+    while (monitor.getStats().bursts < 2) {
+        Simulation::advanceMicros(1000);
+        monitor.update(Timer::millis());
+    }
+    TEST_ASSERT_FALSE(g_continuousAdc.isRunning());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.9f, monitor.getVoltage());
+    TEST_ASSERT_EQUAL_UINT32(0, monitor.getStats().failed_reads);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_signal_generator_shapes);
+    RUN_TEST(test_rate_planning_and_decimation);
+    RUN_TEST(test_read_since_is_oldest_first_with_timestamps);
+    RUN_TEST(test_decimated_values_filter_signal);
+    RUN_TEST(test_long_gap_is_capped);
+    RUN_TEST(test_hal_read_served_from_ring);
+    RUN_TEST(test_battery_monitor_uses_ring);
+
+    return UNITY_END();
+}
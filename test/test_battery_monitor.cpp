@@ -0,0 +1,284 @@
+// Unit tests for the background battery monitor, sampling a simulated
+// divider through the HAL ADC, and the state of charge fed from it
+#include <unity.h>
+#include "../src/sensors/battery_monitor.h"
+#include "../src/sensors/battery_soc.h"
+#include "../src/hardware/adc_continuous.h"
+#include "../src/hardware/hardware_abstraction.h"
+#include "../src/hardware/power_calibration.h"
+#include <cmath>
+
+using namespace Sensors;
+namespace HAL = HardwareAbstraction;
+namespace Simulation = HardwareAbstraction::Simulation;
+namespace Timer = HardwareAbstraction::Timer;
+
+static const uint8_t ADC_PIN = 1;
+static const uint8_t GATE_PIN = 37;
+static const float RATIO = 4.9f;
+
+// Battery behind the gated divider: the tap reads ground while the gate
+// pin is HIGH, and every `spike_every`-th reading jumps to full scale.
+// Between load_from_us and load_to_us the cell sags by load_sag_v.
+class DividerSource : public Simulation::AnalogSource {
+public:
+    float vbat = 3.9f;
+    uint32_t spike_every = 0;
+    uint32_t reads = 0;
+    uint32_t gated_reads = 0;
+    float load_sag_v = 0.0f;
+    uint32_t load_from_us = 0;
+    uint32_t load_to_us = 0;
+
+    uint16_t sample(uint8_t, uint32_t nowUs) override {
+        reads++;
+        if (HAL::GPIO::digitalRead(GATE_PIN) == HAL::GPIO::Level::LEVEL_HIGH) {
+            gated_reads++;
+            return 0;
+        }
+        if (spike_every && reads % spike_every == 0) {
+            return 4095;
+        }
+        const bool loaded = nowUs - load_from_us < load_to_us - load_from_us;
+        const float volts = vbat - (loaded ? load_sag_v : 0.0f);
+        return static_cast<uint16_t>(lroundf(volts / RATIO / 3.3f * 4095.0f));
+    }
+};
+
+static DividerSource s_source;
+
+static BatteryMonitorConfig makeConfig() {
+    BatteryMonitorConfig config = getDefaultBatteryMonitorConfig();
+    config.divider_ratio = RATIO;
+    return config;
+}
+
+// Loop calls at 1 ms steps, as loop()'s trailing delay(1) gives them
+static void runFor(BatteryMonitor& monitor, uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i++) {
+        monitor.update(Timer::millis());
+        Simulation::advanceMicros(1000);
+    }
+}
+
+void setUp(void) {
+    Simulation::reset();
+    Simulation::setMicros(1000000);
+    HAL::initialize();
+    HAL::ADC::initialize();
+    s_source = DividerSource();
+    Simulation::attachAnalogSource(ADC_PIN, &s_source);
+}
+
+void tearDown(void) {
+    HAL::g_continuousAdc.stop();
+    HAL::g_continuousAdc.clearChannels();
+    Simulation::attachAnalogSource(ADC_PIN, nullptr);
+}
+
+void test_first_burst_after_settling_without_delay() {
+    BatteryMonitor monitor;
+    monitor.begin(makeConfig(), Timer::millis());
+    TEST_ASSERT_FALSE(monitor.hasReading());
+
+    // Gate opens on the first call, which returns at once
+    const uint32_t before = Timer::micros();
+    monitor.update(Timer::millis());
+    TEST_ASSERT_EQUAL_UINT32(before, Timer::micros());
+    TEST_ASSERT_EQUAL(HAL::GPIO::Level::LEVEL_LOW, HAL::GPIO::digitalRead(GATE_PIN));
+    TEST_ASSERT_EQUAL_UINT32(0, s_source.reads);
+
+    runFor(monitor, 5);
+    TEST_ASSERT_TRUE(monitor.hasReading());
+    TEST_ASSERT_TRUE(monitor.isPresent());
+    TEST_ASSERT_EQUAL(HAL::GPIO::Level::LEVEL_HIGH, HAL::GPIO::digitalRead(GATE_PIN));
+    TEST_ASSERT_EQUAL_UINT32(16, s_source.reads);
+    TEST_ASSERT_EQUAL_UINT32(0, s_source.gated_reads);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.9f, monitor.getVoltage());
+
+    // Getters touch neither the ADC nor the gate
+    for (int i = 0; i < 100; i++) {
+        monitor.getVoltage();
+        monitor.isPresent();
+    }
+    TEST_ASSERT_EQUAL_UINT32(16, s_source.reads);
+}
+
+void test_bursts_follow_configured_interval() {
+    BatteryMonitorConfig config = makeConfig();
+    config.sample_interval_ms = 2000;
+    config.oversample = 8;
+    BatteryMonitor monitor;
+    monitor.begin(config, Timer::millis());
+
+    runFor(monitor, 10000);
+    TEST_ASSERT_EQUAL_UINT32(5, monitor.getStats().bursts);
+    TEST_ASSERT_EQUAL_UINT32(40, monitor.getStats().samples);
+    TEST_ASSERT_EQUAL_UINT32(0, s_source.gated_reads);
+}
+
+void test_ema_smooths_slow_discharge() {
+    BatteryMonitor monitor;
+    monitor.begin(makeConfig(), Timer::millis());
+    runFor(monitor, 10);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.9f, monitor.getVoltage());
+
+    // A 0.1 V sag under radio load is followed, but only part of the way
+    s_source.vbat = 3.8f;
+    runFor(monitor, 10000);
+    TEST_ASSERT_TRUE(monitor.getVoltage() < 3.89f);
+    TEST_ASSERT_TRUE(monitor.getVoltage() > 3.81f);
+
+    runFor(monitor, 200000);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.8f, monitor.getVoltage());
+    TEST_ASSERT_EQUAL_UINT32(0, monitor.getStats().reseeds);
+}
+
+void test_trimmed_mean_drops_spikes() {
+    const float values[6] = {1.0f, 1.0f, 3.3f, 1.0f, 0.0f, 1.0f};
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 1.0f, BatteryMonitor::trimmedMean(values, 6));
+    const float few[3] = {1.0f, 2.0f, 3.0f};
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 2.0f, BatteryMonitor::trimmedMean(few, 3));
+
+    // One full-scale reading per burst leaves the filtered voltage alone
+    s_source.spike_every = 16;
+    BatteryMonitor monitor;
+    monitor.begin(makeConfig(), Timer::millis());
+    runFor(monitor, 10);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.9f, monitor.getVoltage());
+}
+
+void test_charger_step_reseeds_filter() {
+    BatteryMonitor monitor;
+    monitor.begin(makeConfig(), Timer::millis());
+    runFor(monitor, 10);
+
+    s_source.vbat = 4.2f;                   // USB plugged in
+    runFor(monitor, 10000);
+    TEST_ASSERT_EQUAL_UINT32(1, monitor.getStats().reseeds);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 4.2f, monitor.getVoltage());
+}
+
+void test_divider_ratio_change_applies_at_once() {
+    BatteryMonitor monitor;
+    monitor.begin(makeConfig(), Timer::millis());
+    runFor(monitor, 10);
+    const uint32_t reads = s_source.reads;
+
+    monitor.setDividerRatio(RATIO * 4.0f / 3.9f);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 4.0f, monitor.getVoltage());
+    TEST_ASSERT_EQUAL_UINT32(reads, s_source.reads);
+
+    monitor.setDividerRatio(0.0f);          // Ignored
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 4.0f, monitor.getVoltage());
+}
+
+// With a calibration store attached, a new meter point re-reads the cached
+// voltage without another burst
+void test_calibration_store_applies_live() {
+    HAL::PowerCalibration calibration;
+    calibration.begin(nullptr);
+    BatteryMonitorConfig config = makeConfig();
+    config.calibration = &calibration;
+    BatteryMonitor monitor;
+    monitor.begin(config, Timer::millis());
+    runFor(monitor, 10);
+    const uint32_t reads = s_source.reads;
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.9f, monitor.getVoltage());
+
+    TEST_ASSERT_TRUE(calibration.addPoint(monitor.getPinVoltage(), 3.95f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.95f, monitor.getVoltage());
+    TEST_ASSERT_EQUAL_UINT32(reads, s_source.reads);
+}
+
+void test_no_battery_reads_absent() {
+    s_source.vbat = 0.0f;
+    BatteryMonitor monitor;
+    monitor.begin(makeConfig(), Timer::millis());
+    runFor(monitor, 10);
+    TEST_ASSERT_TRUE(monitor.hasReading());
+    TEST_ASSERT_FALSE(monitor.isPresent());
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, monitor.getVoltage());
+}
+
+// loop()'s battery step: each new burst, as read, goes to the estimator
+static void runLoop(BatteryMonitor& monitor, SocEstimator& soc, uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i++) {
+        const uint32_t bursts = monitor.getStats().bursts;
+        monitor.update(Timer::millis());
+        if (monitor.getStats().bursts != bursts) {
+            soc.update(monitor.getLastBurstVoltage(), monitor.getLastBurstStartMs(), monitor.getLastBurstEndMs());
+        }
+        Simulation::advanceMicros(1000);
+    }
+}
+
+// Blocking 22 dBm transmit: the loop stalls while the cell sags under the
+// PA current, then the airtime is reported as radioTransmit() does
+static void transmit(DividerSource& source, SocEstimator& soc, uint32_t airtimeMs) {
+    const float sag = txCurrentMa(22) / 1000.0f * soc.getConfig().internal_resistance_ohm;
+    source.load_sag_v = sag;
+    source.load_from_us = Timer::micros();
+    source.load_to_us = source.load_from_us + airtimeMs * 1000;
+    Simulation::advanceMicros(airtimeMs * 1000);
+    soc.recordTx(airtimeMs, 22, Timer::millis());
+}
+
+// Monitor and estimator together on the DMA sampler: the estimator gets the
+// burst as read rather than the EMA, and adds the TX current only when a
+// transmission overlapped the burst
+void test_soc_compensates_only_overlapping_tx() {
+    BatteryMonitorConfig config = makeConfig();
+    HAL::g_continuousAdc.addChannel(ADC_PIN, BatteryMonitor::continuousRateHz(config));
+    config.continuous = &HAL::g_continuousAdc;
+    BatteryMonitor monitor;
+    SocEstimator soc;
+    soc.begin(getDefaultBatterySocConfig());
+    const float restOcv = 3.9f;
+    const float baseDrop = soc.getConfig().base_current_ma / 1000.0f * soc.getConfig().internal_resistance_ohm;
+    s_source.vbat = restOcv - baseDrop;
+    monitor.begin(config, Timer::millis());
+
+    runLoop(monitor, soc, 100);
+    TEST_ASSERT_EQUAL_UINT32(1, soc.getStats().samples);
+    TEST_ASSERT_FLOAT_WITHIN(0.006f, restOcv, soc.getCompensatedVoltage());
+
+    // A sender PING that ends before the next burst: nothing to add back
+    uint32_t nextBurstMs = monitor.getLastUpdateMs() + config.sample_interval_ms;
+    runLoop(monitor, soc, nextBurstMs - Timer::millis() - 800);
+    transmit(s_source, soc, 290);
+    runLoop(monitor, soc, 600);
+    TEST_ASSERT_EQUAL_UINT32(2, soc.getStats().samples);
+    TEST_ASSERT_FLOAT_WITHIN(0.006f, restOcv, soc.getCompensatedVoltage());
+
+    // The loop blocks in a TX right after opening the gate; the DMA keeps
+    // converting, so the whole burst is under load
+    nextBurstMs = monitor.getLastUpdateMs() + config.sample_interval_ms;
+    runLoop(monitor, soc, nextBurstMs - Timer::millis() + 1);
+    TEST_ASSERT_EQUAL(HAL::GPIO::Level::LEVEL_LOW, HAL::GPIO::digitalRead(GATE_PIN));
+    transmit(s_source, soc, 290);
+    runLoop(monitor, soc, 50);
+    TEST_ASSERT_EQUAL_UINT32(3, soc.getStats().samples);
+    TEST_ASSERT_FLOAT_WITHIN(0.006f, restOcv - txCurrentMa(22) / 1000.0f * 0.25f,
+                             monitor.getLastBurstVoltage() + baseDrop);
+    TEST_ASSERT_FLOAT_WITHIN(0.006f, restOcv, soc.getCompensatedVoltage());
+
+    // The filtered voltage lags the sag; the estimator is not fed from it
+    TEST_ASSERT_TRUE(monitor.getVoltage() - monitor.getLastBurstVoltage() > 0.015f);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_first_burst_after_settling_without_delay);
+    RUN_TEST(test_bursts_follow_configured_interval);
+    RUN_TEST(test_ema_smooths_slow_discharge);
+    RUN_TEST(test_trimmed_mean_drops_spikes);
+    RUN_TEST(test_charger_step_reseeds_filter);
+    RUN_TEST(test_divider_ratio_change_applies_at_once);
+    RUN_TEST(test_calibration_store_applies_live);
+    RUN_TEST(test_no_battery_reads_absent);
+    RUN_TEST(test_soc_compensates_only_overlapping_tx);
+
+    return UNITY_END();
+}
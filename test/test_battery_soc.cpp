@@ -0,0 +1,257 @@
+// Unit tests for the Li-ion state-of-charge estimator, including a replay
+// of a full discharge log
+#include <unity.h>
+#include "../src/sensors/battery_soc.h"
+#include <cmath>
+
+using namespace Sensors;
+
+struct LogRow {
+    uint16_t minute;
+    uint16_t millivolts;                    // Terminal voltage as the node sampled it
+    uint8_t after_tx;                       // Sample taken right after a 22 dBm PING
+    uint16_t truth_permille;                // SoC from the charge actually drawn, 0.1%
+};
+
+// Sender node, PING every 2 s at 22 dBm with ~290 ms airtime, one sample
+// every 10 min. Generated from a reference cell that deliberately differs
+// from the firmware defaults: its own rested curve, 1050 mAh, 0.28 ohm path
+// resistance and +-6 mV ADC noise.
+static const LogRow DISCHARGE_LOG[] = {
+    {   0, 4171, 0, 1000}, {  10, 4124, 1,  987}, {  20, 4152, 0,  975},
+    {  30, 4134, 0,  962}, {  40, 4095, 1,  950}, {  50, 4115, 0,  937},
+    {  60, 4100, 0,  925}, {  70, 4061, 1,  912}, {  80, 4077, 0,  900},
+    {  90, 4073, 0,  887}, { 100, 4027, 1,  874}, { 110, 4051, 0,  862},
+    { 120, 4046, 0,  849}, { 130, 4007, 1,  837}, { 140, 4020, 0,  824},
+    { 150, 4010, 0,  812}, { 160, 3970, 1,  799}, { 170, 3997, 0,  787},
+    { 180, 3983, 0,  774}, { 190, 3937, 1,  761}, { 200, 3968, 0,  749},
+    { 210, 3948, 0,  736}, { 220, 3916, 1,  724}, { 230, 3933, 0,  711},
+    { 240, 3922, 0,  699}, { 250, 3879, 1,  686}, { 260, 3904, 0,  674},
+    { 270, 3900, 0,  661}, { 280, 3850, 1,  648}, { 290, 3880, 0,  636},
+    { 300, 3873, 0,  623}, { 310, 3830, 1,  611}, { 320, 3857, 0,  598},
+    { 330, 3845, 0,  586}, { 340, 3806, 1,  573}, { 350, 3834, 0,  560},
+    { 360, 3834, 0,  548}, { 370, 3793, 1,  535}, { 380, 3820, 0,  523},
+    { 390, 3818, 0,  510}, { 400, 3778, 1,  498}, { 410, 3804, 0,  485},
+    { 420, 3805, 0,  473}, { 430, 3766, 1,  460}, { 440, 3789, 0,  447},
+    { 450, 3789, 0,  435}, { 460, 3752, 1,  422}, { 470, 3785, 0,  410},
+    { 480, 3780, 0,  397}, { 490, 3737, 1,  385}, { 500, 3775, 0,  372},
+    { 510, 3761, 0,  360}, { 520, 3728, 1,  347}, { 530, 3761, 0,  334},
+    { 540, 3750, 0,  322}, { 550, 3717, 1,  309}, { 560, 3741, 0,  297},
+    { 570, 3743, 0,  284}, { 580, 3706, 1,  272}, { 590, 3732, 0,  259},
+    { 600, 3731, 0,  247}, { 610, 3686, 1,  234}, { 620, 3719, 0,  221},
+    { 630, 3712, 0,  209}, { 640, 3674, 1,  196}, { 650, 3699, 0,  184},
+    { 660, 3697, 0,  171}, { 670, 3659, 1,  159}, { 680, 3681, 0,  146},
+    { 690, 3678, 0,  134}, { 700, 3633, 1,  121}, { 710, 3668, 0,  108},
+    { 720, 3659, 0,   96}, { 730, 3616, 1,   83}, { 740, 3631, 0,   71},
+    { 750, 3610, 0,   58}, { 760, 3547, 1,   46}, { 770, 3520, 0,   33},
+    { 780, 3421, 0,   21},
+};
+static const size_t LOG_ROWS = sizeof(DISCHARGE_LOG) / sizeof(DISCHARGE_LOG[0]);
+
+static const uint32_t PINGS_PER_ROW = 300;
+static const uint32_t PING_AIRTIME_MS = 290;
+
+// What the sender's loop reports between two samples
+static void replayRadio(SocEstimator& soc, const LogRow& row, uint32_t nowMs) {
+    for (uint32_t i = 0; i + 1 < PINGS_PER_ROW; i++) {
+        soc.recordTx(PING_AIRTIME_MS, 22, nowMs - 600000 + i * 2000);
+    }
+    soc.recordTx(PING_AIRTIME_MS, 22, row.after_tx ? nowMs : nowMs - 2000);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_ocv_lookup_interpolates_and_clamps() {
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 50.0f, socFromOcv(3.84f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 52.5f, socFromOcv(3.845f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, socFromOcv(2.9f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 100.0f, socFromOcv(4.35f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.845f, ocvFromSoc(52.5f));
+
+    // Every point of the curve survives the round trip
+    for (float v = 3.30f; v < 4.20f; v += 0.01f) {
+        TEST_ASSERT_FLOAT_WITHIN(0.0005f, v, ocvFromSoc(socFromOcv(v)));
+    }
+
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 118.0f, txCurrentMa(22));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 90.0f, txCurrentMa(17));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 110.0f, txCurrentMa(21));
+
+    const CurvePoint single[] = {{1.0f, 2.0f}};
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.0f, interpolateCurve(single, 1, 5.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, interpolateCurve(single, 0, 5.0f));
+}
+
+// Replays the log: the estimate stays near the coulomb-counted truth and
+// does not follow the TX sag, which the plain lookups both do
+void test_discharge_log_tracks_truth() {
+    SocEstimator soc;
+    soc.begin(getDefaultBatterySocConfig());
+
+    float maxError = 0.0f;
+    float maxStep = 0.0f;
+    float maxLinearError = 0.0f;
+    float maxLookupStep = 0.0f;
+    float previous = 0.0f;
+    float previousLookup = 0.0f;
+
+    for (size_t i = 0; i < LOG_ROWS; i++) {
+        const LogRow& row = DISCHARGE_LOG[i];
+        const uint32_t nowMs = row.minute * 60000UL;
+        const float volts = row.millivolts / 1000.0f;
+        const float truth = row.truth_permille / 10.0f;
+        if (i > 0) {
+            replayRadio(soc, row, nowMs);
+        }
+        soc.update(volts, nowMs);
+
+        const float lookup = socFromOcv(volts);
+        const float linear = fminf(fmaxf((volts - 3.0f) / 1.2f * 100.0f, 0.0f), 100.0f);
+        maxError = fmaxf(maxError, fabsf(soc.getSoc() - truth));
+        maxLinearError = fmaxf(maxLinearError, fabsf(linear - truth));
+        if (i > 0) {
+            maxStep = fmaxf(maxStep, fabsf(soc.getSoc() - previous));
+            maxLookupStep = fmaxf(maxLookupStep, fabsf(lookup - previousLookup));
+        }
+        previous = soc.getSoc();
+        previousLookup = lookup;
+    }
+
+    TEST_ASSERT_TRUE_MESSAGE(maxError < 5.0f, "estimate strays from the bench truth");
+    TEST_ASSERT_TRUE(maxLinearError > 15.0f);
+    TEST_ASSERT_TRUE_MESSAGE(maxStep < 2.0f, "estimate jumps between samples");
+    TEST_ASSERT_TRUE(maxLookupStep > 10.0f);
+    TEST_ASSERT_EQUAL_UINT32(0, soc.getStats().reseeds);
+    TEST_ASSERT_EQUAL_UINT32(LOG_ROWS, soc.getStats().samples);
+    TEST_ASSERT_EQUAL_UINT32((LOG_ROWS - 1) * PINGS_PER_ROW, soc.getStats().tx_count);
+}
+
+// Halfway down the log, the runtime left at this duty cycle is close to
+// what the cell actually had left
+void test_remaining_runtime_at_duty_cycle() {
+    SocEstimator soc;
+    soc.begin(getDefaultBatterySocConfig());
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, soc.getRemainingMinutes());
+
+    size_t i = 0;
+    for (; i < LOG_ROWS && DISCHARGE_LOG[i].truth_permille > 500; i++) {
+        const uint32_t nowMs = DISCHARGE_LOG[i].minute * 60000UL;
+        if (i > 0) {
+            replayRadio(soc, DISCHARGE_LOG[i], nowMs);
+        }
+        soc.update(DISCHARGE_LOG[i].millivolts / 1000.0f, nowMs);
+    }
+
+    // 60 mA base plus 118 mA for 14.5% of the time
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 77.1f, soc.getAverageCurrentMa());
+
+    // The log runs on to ~1% left
+    const float actual = static_cast<float>(DISCHARGE_LOG[LOG_ROWS - 1].minute - DISCHARGE_LOG[i - 1].minute);
+    const float estimate = static_cast<float>(soc.getRemainingMinutes());
+    TEST_ASSERT_TRUE_MESSAGE(fabsf(estimate - actual) / actual < 0.15f, "runtime estimate off by over 15%");
+}
+
+// A compensated sample reads the same under TX as at rest
+void test_load_compensation_follows_tx_state() {
+    BatterySocConfig config = getDefaultBatterySocConfig();
+    config.internal_resistance_ohm = 0.3f;
+    SocEstimator soc;
+    soc.begin(config);
+
+    const float rest = 3.84f - 0.060f * 0.3f;
+    soc.update(rest, 1000);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.84f, soc.getCompensatedVoltage());
+
+    soc.recordTx(300, 22, 5000);
+    soc.update(rest - 0.118f * 0.3f, 5000);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.84f, soc.getCompensatedVoltage());
+
+    // Once the TX has ended the TX current no longer applies
+    soc.update(rest, 5001);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.84f, soc.getCompensatedVoltage());
+
+    // Readings over 20 ms, the first 15 of them under TX: 3/4 of the sag
+    soc.recordTx(300, 22, 6005);
+    soc.update(rest - 0.118f * 0.3f * 0.75f, 5990, 6010);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.84f, soc.getCompensatedVoltage());
+
+    // A TX just before the window is not compensated
+    soc.recordTx(300, 22, 6999);
+    soc.update(rest, 7000, 7020);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.84f, soc.getCompensatedVoltage());
+    TEST_ASSERT_FLOAT_WITHIN(0.2f, 50.0f, soc.getSoc());
+}
+
+void test_radio_time_is_counted() {
+    BatterySocConfig config = getDefaultBatterySocConfig();
+    config.base_current_ma = 0.0f;
+    config.ocv_gain = 0.0f;
+    config.capacity_mah = 100.0f;
+    SocEstimator soc;
+    soc.begin(config);
+    soc.update(3.95f, 0);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 70.0f, soc.getSoc());
+
+    // One hour of listening and 3 minutes of 22 dBm TX
+    soc.recordRx(3600000);
+    soc.recordTx(180000, 22, 1000);
+    soc.update(3.95f, 3600000);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 5.3f + 5.9f, soc.getStats().consumed_mah);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 70.0f - 11.2f, soc.getSoc());
+    TEST_ASSERT_EQUAL_UINT32(3600000, soc.getStats().rx_ms);
+    TEST_ASSERT_EQUAL_UINT32(180000, soc.getStats().tx_ms);
+    TEST_ASSERT_EQUAL_UINT8(59, soc.getPercent());
+}
+
+void test_charger_reseeds_from_voltage() {
+    SocEstimator soc;
+    soc.begin(getDefaultBatterySocConfig());
+    soc.update(3.70f, 0);
+    soc.update(3.70f, 600000);
+    const float before = soc.getSoc();
+    TEST_ASSERT_TRUE(before < 20.0f);
+
+    soc.update(4.20f, 1200000);             // USB plugged in
+    TEST_ASSERT_EQUAL_UINT32(1, soc.getStats().reseeds);
+    TEST_ASSERT_EQUAL_UINT8(100, soc.getPercent());
+}
+
+// The published percent holds within the hysteresis band; the ends and
+// the first estimate always get through
+void test_percent_hysteresis_but_ends_always_published() {
+    BatterySocConfig config = getDefaultBatterySocConfig();
+    config.hysteresis_percent = 3;
+    config.ocv_gain = 1.0f;                 // Follow the voltage outright
+    config.base_current_ma = 0.0f;
+    SocEstimator soc;
+    soc.begin(config);
+
+    soc.update(ocvFromSoc(50.0f), 0);
+    TEST_ASSERT_EQUAL_UINT8(50, soc.getPercent());
+    soc.update(ocvFromSoc(52.0f), 1000);    // Within the band, held
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 52.0f, soc.getSoc());
+    TEST_ASSERT_EQUAL_UINT8(50, soc.getPercent());
+    soc.update(ocvFromSoc(53.0f), 2000);
+    TEST_ASSERT_EQUAL_UINT8(53, soc.getPercent());
+    soc.update(ocvFromSoc(65.0f), 3000);
+    soc.update(ocvFromSoc(99.0f), 4000);    // Reseed
+    TEST_ASSERT_EQUAL_UINT8(99, soc.getPercent());
+    soc.update(4.25f, 5000);                // 100% is never held back
+    TEST_ASSERT_EQUAL_UINT8(100, soc.getPercent());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ocv_lookup_interpolates_and_clamps);
+    RUN_TEST(test_discharge_log_tracks_truth);
+    RUN_TEST(test_remaining_runtime_at_duty_cycle);
+    RUN_TEST(test_load_compensation_follows_tx_state);
+    RUN_TEST(test_radio_time_is_counted);
+    RUN_TEST(test_charger_reseeds_from_voltage);
+    RUN_TEST(test_percent_hysteresis_but_ends_always_published);
+
+    return UNITY_END();
+}
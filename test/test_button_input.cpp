@@ -0,0 +1,196 @@
+// Unit tests for the interrupt-driven button: ISR edge queue, debouncing
+// and press timing, driven by synthetic edge sequences
+#include <unity.h>
+#include "../src/sensors/button_input.h"
+#include "../src/hardware/hardware_abstraction.h"
+
+using namespace Sensors;
+namespace HAL = HardwareAbstraction;
+namespace Simulation = HardwareAbstraction::Simulation;
+
+static const uint8_t PIN = 0;
+static const uint32_t T0 = 1000000;
+
+static ButtonInput* s_button;
+
+// Active-low edges as (offset ms from T0, pressed)
+struct Edge {
+    uint32_t ms;
+    bool pressed;
+};
+
+static void pushEdges(ButtonInput& button, const Edge* edges, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        button.pushEdge(T0 + edges[i].ms * 1000, !edges[i].pressed);
+    }
+}
+
+void setUp(void) {
+    Simulation::reset();
+    Simulation::setMicros(T0);
+    HAL::initialize();
+    s_button = new ButtonInput();
+    TEST_ASSERT_TRUE(s_button->begin(getDefaultButtonInputConfig()));
+}
+
+void tearDown(void) {
+    s_button->end();
+    delete s_button;
+}
+
+void test_clean_press_is_timed_from_edges() {
+    const Edge edges[] = {{10, true}, {350, false}};
+    pushEdges(*s_button, edges, 2);
+
+    // The loop gets here two seconds late; the duration is still exact
+    s_button->update(T0 + 2000000);
+    ButtonEvent event;
+    TEST_ASSERT_TRUE(s_button->poll(event));
+    TEST_ASSERT_EQUAL_UINT32(340, event.duration_ms);
+    TEST_ASSERT_EQUAL_UINT32(T0 + 10000, event.pressed_us);
+    TEST_ASSERT_EQUAL(ButtonAction::CyclePreset, event.action);
+    TEST_ASSERT_FALSE(s_button->poll(event));
+    TEST_ASSERT_FALSE(s_button->isPressed());
+}
+
+void test_bounce_is_absorbed() {
+    // Contact chatter on both press and release
+    const Edge edges[] = {
+        {100, true}, {101, false}, {102, true}, {104, false}, {105, true},
+        {800, false}, {801, true}, {803, false},
+    };
+    pushEdges(*s_button, edges, 8);
+    s_button->update(T0 + 1000000);
+
+    ButtonEvent event;
+    TEST_ASSERT_TRUE(s_button->poll(event));
+    TEST_ASSERT_EQUAL_UINT32(700, event.duration_ms);
+    TEST_ASSERT_EQUAL_UINT32(1, s_button->getStats().presses);
+    TEST_ASSERT_EQUAL_UINT32(6, s_button->getStats().bounces);
+    TEST_ASSERT_FALSE(s_button->poll(event));
+}
+
+void test_glitch_is_ignored() {
+    // A spike shorter than the debounce window reads as a too-short press
+    const Edge edges[] = {{100, true}, {100, false}};
+    pushEdges(*s_button, edges, 2);
+    s_button->update(T0 + 200000);
+
+    ButtonEvent event;
+    TEST_ASSERT_TRUE(s_button->poll(event));
+    TEST_ASSERT_EQUAL(ButtonAction::Ignore, event.action);
+    TEST_ASSERT_FALSE(s_button->isPressed());
+}
+
+void test_long_press_and_held_state() {
+    const Edge press[] = {{0, true}};
+    pushEdges(*s_button, press, 1);
+    s_button->update(T0 + 5000);
+    TEST_ASSERT_TRUE(s_button->isPressed());
+
+    ButtonEvent event;
+    TEST_ASSERT_FALSE(s_button->poll(event));          // Nothing until release
+
+    const Edge release[] = {{6500, false}};
+    pushEdges(*s_button, release, 1);
+    s_button->update(T0 + 6600000);
+    TEST_ASSERT_TRUE(s_button->poll(event));
+    TEST_ASSERT_EQUAL_UINT32(6500, event.duration_ms);
+    TEST_ASSERT_EQUAL(ButtonAction::SleepMode, event.action);
+}
+
+void test_level_settles_after_window() {
+    // A release that reverses inside the window and stays: pressed again
+    // from the reversing edge once the window closes
+    const Edge edges[] = {{0, true}, {500, false}, {505, true}};
+    pushEdges(*s_button, edges, 3);
+    s_button->update(T0 + 510000);
+    TEST_ASSERT_FALSE(s_button->isPressed());           // Window still open
+    s_button->update(T0 + 530000);
+    TEST_ASSERT_TRUE(s_button->isPressed());
+
+    // The first press ended at the release edge
+    ButtonEvent event;
+    TEST_ASSERT_TRUE(s_button->poll(event));
+    TEST_ASSERT_EQUAL_UINT32(500, event.duration_ms);
+    const Edge release[] = {{900, false}};
+    pushEdges(*s_button, release, 1);
+    s_button->update(T0 + 1000000);
+    TEST_ASSERT_TRUE(s_button->poll(event));
+    TEST_ASSERT_EQUAL_UINT32(T0 + 505000, event.pressed_us);
+    TEST_ASSERT_EQUAL_UINT32(395, event.duration_ms);
+}
+
+void test_queues_overflow_counted() {
+    for (uint32_t i = 0; i < 40; i++) {
+        s_button->pushEdge(T0 + i * 100000, (i & 1) != 0);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, s_button->getStats().edges);
+    s_button->update(T0 + 5000000);
+    const ButtonInputStats& stats = s_button->getStats();
+    TEST_ASSERT_EQUAL_UINT32(ButtonInput::EDGE_QUEUE_SIZE - 1, stats.edges);
+    TEST_ASSERT_EQUAL_UINT32(40 - (ButtonInput::EDGE_QUEUE_SIZE - 1), stats.dropped_edges);
+    TEST_ASSERT_EQUAL_UINT32(15, stats.presses);
+    TEST_ASSERT_EQUAL_UINT32(15 - ButtonInput::EVENT_QUEUE_SIZE, stats.dropped_events);
+
+    ButtonEvent event;
+    size_t polled = 0;
+    while (s_button->poll(event)) {
+        TEST_ASSERT_EQUAL_UINT32(100, event.duration_ms);
+        polled++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(ButtonInput::EVENT_QUEUE_SIZE, polled);
+}
+
+// Through the HAL interrupt: the ISR reads the pin and stamps the clock
+void test_interrupt_path() {
+    Simulation::setMicros(T0 + 50000);
+    HAL::GPIO::digitalWrite(PIN, HAL::GPIO::Level::LEVEL_LOW);
+    TEST_ASSERT_TRUE(Simulation::triggerInterrupt(PIN));
+    Simulation::setMicros(T0 + 1250000);
+    HAL::GPIO::digitalWrite(PIN, HAL::GPIO::Level::LEVEL_HIGH);
+    TEST_ASSERT_TRUE(Simulation::triggerInterrupt(PIN));
+
+    Simulation::setMicros(T0 + 3000000);
+    s_button->update(HAL::Timer::micros());
+    ButtonEvent event;
+    TEST_ASSERT_TRUE(s_button->poll(event));
+    TEST_ASSERT_EQUAL_UINT32(1200, event.duration_ms);
+
+    // Detached on end()
+    s_button->end();
+    TEST_ASSERT_FALSE(Simulation::triggerInterrupt(PIN));
+}
+
+// No interrupt: polled level changes go through the same debouncing
+void test_polled_fallback() {
+    s_button->end();
+    HAL::deinitialize();
+    ButtonInput polled;
+    TEST_ASSERT_FALSE(polled.begin(getDefaultButtonInputConfig()));
+    TEST_ASSERT_FALSE(polled.isAttached());
+
+    // The uninitialized pin reads LOW, so the first poll sees a release
+    const Edge edges[] = {{0, false}, {100, true}, {102, false}, {103, true}, {500, false}};
+    pushEdges(polled, edges, 5);
+    polled.update(T0 + 600000);
+    ButtonEvent event;
+    TEST_ASSERT_TRUE(polled.poll(event));
+    TEST_ASSERT_EQUAL_UINT32(400, event.duration_ms);
+    TEST_ASSERT_EQUAL(ButtonAction::CyclePreset, event.action);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_clean_press_is_timed_from_edges);
+    RUN_TEST(test_bounce_is_absorbed);
+    RUN_TEST(test_glitch_is_ignored);
+    RUN_TEST(test_long_press_and_held_state);
+    RUN_TEST(test_level_settles_after_window);
+    RUN_TEST(test_queues_overflow_counted);
+    RUN_TEST(test_interrupt_path);
+    RUN_TEST(test_polled_fallback);
+
+    return UNITY_END();
+}
@@ -0,0 +1,240 @@
+// Unit tests for dirty-tile OLED flushing against a software SSD1306 framebuffer
+#include <unity.h>
+#include "../src/display/dirty_tile_renderer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace Display;
+
+// Panel model: GDDRAM written one tile run at a time
+class SoftwarePanel : public TileSink {
+public:
+    uint8_t ram[FRAME_BYTES];
+    uint32_t calls = 0;
+    uint32_t bytes = 0;                                 // Including per-transfer overhead
+    uint8_t last_tx = 0, last_ty = 0, last_tw = 0;
+
+    SoftwarePanel() { memset(ram, 0xA5, sizeof(ram)); } // Power-on garbage
+
+    void sendTiles(uint8_t tx, uint8_t ty, uint8_t tw, const uint8_t* data) override {
+        TEST_ASSERT_TRUE(tx + tw <= TILE_COLUMNS);
+        TEST_ASSERT_TRUE(ty < TILE_ROWS);
+        memcpy(ram + (ty * TILE_COLUMNS + tx) * TILE_BYTES, data, tw * TILE_BYTES);
+        calls++;
+        bytes += tw * TILE_BYTES + RUN_OVERHEAD_BYTES;
+        last_tx = tx;
+        last_ty = ty;
+        last_tw = tw;
+    }
+
+    void resetCounters() {
+        calls = 0;
+        bytes = 0;
+    }
+};
+
+static uint8_t s_frame[FRAME_BYTES];
+
+// U8g2 full-buffer layout, unrotated 128x64
+static void setPixel(int x, int y, bool on = true) {
+    uint8_t& b = s_frame[(y / 8) * 128 + x];
+    const uint8_t mask = static_cast<uint8_t>(1u << (y % 8));
+    b = on ? (b | mask) : (b & ~mask);
+}
+
+static void fillRect(int x, int y, int w, int h, bool on = true) {
+    for (int j = y; j < y + h; j++) {
+        for (int i = x; i < x + w; i++) {
+            setPixel(i, j, on);
+        }
+    }
+}
+
+static void drawDisc(int cx, int cy, int r, bool on = true) {
+    for (int y = cy - r; y <= cy + r; y++) {
+        for (int x = cx - r; x <= cx + r; x++) {
+            if ((x - cx) * (x - cx) + (y - cy) * (y - cy) <= r * r) {
+                setPixel(x, y, on);
+            }
+        }
+    }
+}
+
+// A plausible status screen: text-like noise in a few bands
+static void drawStatusScreen(uint32_t seed) {
+    memset(s_frame, 0, sizeof(s_frame));
+    for (int band = 0; band < 5; band++) {
+        for (int x = 2; x < 100; x++) {
+            seed = seed * 1103515245u + 12345u;
+            s_frame[band * 128 + 128 + x] = static_cast<uint8_t>(seed >> 24) & 0x7E;
+        }
+    }
+}
+
+void setUp(void) {
+    memset(s_frame, 0, sizeof(s_frame));
+}
+
+void tearDown(void) {}
+
+void test_first_flush_sends_whole_frame() {
+    SoftwarePanel panel;
+    DirtyTileRenderer renderer;
+    renderer.attach(s_frame, &panel);
+
+    drawStatusScreen(1);
+    TEST_ASSERT_EQUAL_UINT32(TILE_COLUMNS * TILE_ROWS, renderer.flush());
+    TEST_ASSERT_EQUAL_MEMORY(s_frame, panel.ram, FRAME_BYTES);
+    TEST_ASSERT_EQUAL_UINT32(TILE_ROWS, panel.calls);    // One run per tile row
+    TEST_ASSERT_EQUAL_UINT32(FRAME_BYTES + TILE_ROWS * RUN_OVERHEAD_BYTES, renderer.getStats().last_bytes);
+
+    // Same frame again: nothing goes over the bus
+    panel.resetCounters();
+    TEST_ASSERT_EQUAL_UINT32(0, renderer.flush());
+    TEST_ASSERT_EQUAL_UINT32(0, panel.calls);
+    TEST_ASSERT_EQUAL_UINT32(1, renderer.getStats().unchanged_frames);
+    TEST_ASSERT_EQUAL_UINT32(0, renderer.getStats().last_bytes);
+}
+
+void test_single_pixel_sends_one_tile() {
+    SoftwarePanel panel;
+    DirtyTileRenderer renderer;
+    renderer.attach(s_frame, &panel);
+    renderer.flush();
+    panel.resetCounters();
+
+    setPixel(77, 42);
+    TEST_ASSERT_EQUAL_UINT32(1, renderer.flush());
+    TEST_ASSERT_EQUAL_UINT32(1, panel.calls);
+    TEST_ASSERT_EQUAL_UINT8(77 / 8, panel.last_tx);
+    TEST_ASSERT_EQUAL_UINT8(42 / 8, panel.last_ty);
+    TEST_ASSERT_EQUAL_UINT8(1, panel.last_tw);
+    TEST_ASSERT_EQUAL_UINT32(TILE_BYTES + RUN_OVERHEAD_BYTES, renderer.getStats().last_bytes);
+    TEST_ASSERT_EQUAL_MEMORY(s_frame, panel.ram, FRAME_BYTES);
+}
+
+void test_nearby_dirty_tiles_merge_into_one_run() {
+    SoftwarePanel panel;
+    DirtyTileRenderer renderer;
+    renderer.attach(s_frame, &panel);
+    renderer.flush();
+    panel.resetCounters();
+
+    // Tiles 2 and 4 of row 3: the one-tile gap is cheaper to resend
+    setPixel(2 * 8, 3 * 8);
+    setPixel(4 * 8, 3 * 8);
+    TEST_ASSERT_EQUAL_UINT32(3, renderer.flush());
+    TEST_ASSERT_EQUAL_UINT32(1, panel.calls);
+    TEST_ASSERT_EQUAL_UINT8(2, panel.last_tx);
+    TEST_ASSERT_EQUAL_UINT8(3, panel.last_tw);
+
+    // Tiles 2 and 6: two transfers
+    panel.resetCounters();
+    setPixel(2 * 8 + 1, 3 * 8);
+    setPixel(6 * 8 + 1, 3 * 8);
+    TEST_ASSERT_EQUAL_UINT32(2, renderer.flush());
+    TEST_ASSERT_EQUAL_UINT32(2, panel.calls);
+    TEST_ASSERT_EQUAL_UINT32(2 * (TILE_BYTES + RUN_OVERHEAD_BYTES), panel.bytes);
+    TEST_ASSERT_EQUAL_MEMORY(s_frame, panel.ram, FRAME_BYTES);
+}
+
+void test_invalidate_resends_everything() {
+    SoftwarePanel panel;
+    DirtyTileRenderer renderer;
+    renderer.attach(s_frame, &panel);
+    drawStatusScreen(7);
+    renderer.flush();
+
+    memset(panel.ram, 0, sizeof(panel.ram));            // Panel reset behind our back
+    renderer.invalidate();
+    TEST_ASSERT_EQUAL_UINT32(TILE_COLUMNS * TILE_ROWS, renderer.flush());
+    TEST_ASSERT_EQUAL_MEMORY(s_frame, panel.ram, FRAME_BYTES);
+}
+
+void test_random_edits_keep_panel_in_sync() {
+    SoftwarePanel panel;
+    DirtyTileRenderer renderer;
+    renderer.attach(s_frame, &panel);
+
+    uint32_t seed = 12345;
+    for (int frame = 0; frame < 500; frame++) {
+        const int edits = frame % 7;
+        for (int e = 0; e < edits; e++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            const int x = seed % 128;
+            const int y = (seed >> 8) % 64;
+            const int w = 1 + (seed >> 16) % 20;
+            const int h = 1 + (seed >> 24) % 12;
+            fillRect(x, y, (x + w > 128 ? 128 - x : w), (y + h > 64 ? 64 - y : h), (seed >> 31) != 0);
+        }
+        renderer.flush();
+        TEST_ASSERT_EQUAL_MEMORY(s_frame, panel.ram, FRAME_BYTES);
+    }
+}
+
+void test_ping_dot_blink_cost() {
+    SoftwarePanel panel;
+    DirtyTileRenderer renderer;
+    renderer.attach(s_frame, &panel);
+    drawStatusScreen(3);
+    renderer.flush();
+    renderer.resetStats();
+
+    // The receiver's ping dot blinking on a static screen, 200 ms redraws
+    const int frames = 50;
+    for (int i = 0; i < frames; i++) {
+        drawDisc(115, 55, 4, (i % 5) < 2);             // drawDisc(55, 12, 4) under U8G2_R1
+        renderer.flush();
+    }
+    TEST_ASSERT_EQUAL_MEMORY(s_frame, panel.ram, FRAME_BYTES);
+
+    const FlushStats& stats = renderer.getStats();
+    const double per_frame = static_cast<double>(stats.bytes_sent) / frames;
+    const uint32_t full = FRAME_BYTES + TILE_ROWS * RUN_OVERHEAD_BYTES;
+    TEST_ASSERT_TRUE(per_frame < full / 20.0);
+
+    printf("oled ping blink: %.1f B/frame vs %u B full (%.0fx less), %u/%d frames unchanged\n",
+           per_frame, (unsigned)full, full / per_frame, (unsigned)stats.unchanged_frames, frames);
+    printf("oled bus time @100 kHz: full %lu us, blink avg %lu us; @400 kHz: full %lu us, blink avg %lu us\n",
+           (unsigned long)estimateI2CMicros(full, 100000),
+           (unsigned long)estimateI2CMicros(static_cast<uint32_t>(per_frame), 100000),
+           (unsigned long)estimateI2CMicros(full, 400000),
+           (unsigned long)estimateI2CMicros(static_cast<uint32_t>(per_frame), 400000));
+}
+
+void test_benchmark_diff() {
+    SoftwarePanel panel;
+    DirtyTileRenderer renderer;
+    renderer.attach(s_frame, &panel);
+    drawStatusScreen(9);
+    renderer.flush();
+
+    const int rounds = 100000;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        s_frame[(i * 37) % FRAME_BYTES] ^= 0x10;        // One tile changes per frame
+        renderer.flush();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    TEST_ASSERT_EQUAL_MEMORY(s_frame, panel.ram, FRAME_BYTES);
+
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / rounds;
+    printf("oled diff+flush %.1f ns/frame (host)\n", ns);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_first_flush_sends_whole_frame);
+    RUN_TEST(test_single_pixel_sends_one_tile);
+    RUN_TEST(test_nearby_dirty_tiles_merge_into_one_run);
+    RUN_TEST(test_invalidate_resends_everything);
+    RUN_TEST(test_random_edits_keep_panel_in_sync);
+    RUN_TEST(test_ping_dot_blink_cost);
+    RUN_TEST(test_benchmark_diff);
+
+    return UNITY_END();
+}
@@ -0,0 +1,262 @@
+// Unit tests for the display mailbox and frame-paced render step
+#include <unity.h>
+#include "../src/display/display_task.h"
+#include "../src/hardware/hardware_abstraction.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+using namespace Display;
+namespace Simulation = HardwareAbstraction::Simulation;
+
+class CountingSink : public TileSink {
+public:
+    uint32_t calls = 0;
+    void sendTiles(uint8_t, uint8_t, uint8_t, const uint8_t*) override { calls++; }
+};
+
+struct DrawLog {
+    uint8_t* frame;
+    uint32_t draws = 0;
+    uint32_t last_sequence = 0;
+    char last_line1[MESSAGE_LINE_LEN] = {};
+};
+
+// Stand-in for the U8g2 drawing code: one byte per character of line1
+static void drawModel(const ScreenModel& model, void* context) {
+    DrawLog* log = static_cast<DrawLog*>(context);
+    memset(log->frame, 0, FRAME_BYTES);
+    memcpy(log->frame, model.header.line1, sizeof(model.header.line1));
+    log->frame[512] = model.ping.dot ? 0xFF : 0x00;
+    log->draws++;
+    log->last_sequence = model.sequence;
+    memcpy(log->last_line1, model.header.line1, sizeof(model.header.line1));
+}
+
+static ScreenModel makeModel(const char* line1) {
+    ScreenModel model;
+    memset(&model, 0, sizeof(model));
+    strncpy(model.header.line1, line1, sizeof(model.header.line1) - 1);
+    return model;
+}
+
+static uint8_t s_frame[FRAME_BYTES];
+
+void setUp(void) {
+    memset(s_frame, 0, sizeof(s_frame));
+    Simulation::reset();
+}
+
+void tearDown(void) {}
+
+void test_mailbox_latest_wins() {
+    DisplayMailbox mailbox;
+    TEST_ASSERT_TRUE(mailbox.take() == nullptr);
+
+    TEST_ASSERT_TRUE(mailbox.post(makeModel("one")));
+    TEST_ASSERT_FALSE(mailbox.post(makeModel("two")));          // "one" never rendered
+    TEST_ASSERT_FALSE(mailbox.post(makeModel("three")));
+    TEST_ASSERT_EQUAL_UINT32(3, mailbox.getPosted());
+    TEST_ASSERT_EQUAL_UINT32(2, mailbox.getDropped());
+
+    const ScreenModel* model = mailbox.take();
+    TEST_ASSERT_NOT_NULL(model);
+    TEST_ASSERT_EQUAL_STRING("three", model->header.line1);
+    TEST_ASSERT_EQUAL_UINT32(3, model->sequence);
+    TEST_ASSERT_TRUE(mailbox.take() == nullptr);                // Nothing new
+
+    TEST_ASSERT_TRUE(mailbox.post(makeModel("four")));
+    model = mailbox.take();
+    TEST_ASSERT_EQUAL_STRING("four", model->header.line1);
+}
+
+void test_taken_frame_survives_later_posts() {
+    DisplayMailbox mailbox;
+    mailbox.post(makeModel("shown"));
+    const ScreenModel* shown = mailbox.take();
+
+    // The producer cycles through the other two slots while the consumer renders
+    for (int i = 0; i < 10; i++) {
+        char text[8];
+        snprintf(text, sizeof(text), "n%d", i);
+        mailbox.post(makeModel(text));
+    }
+    TEST_ASSERT_EQUAL_STRING("shown", shown->header.line1);
+    TEST_ASSERT_EQUAL_STRING("n9", mailbox.take()->header.line1);
+}
+
+void test_poll_renders_and_flushes_newest() {
+    CountingSink sink;
+    DirtyTileRenderer renderer;
+    renderer.attach(s_frame, &sink);
+    DrawLog log;
+    log.frame = s_frame;
+
+    DisplayTask task;
+    task.begin(drawModel, &log, &renderer);
+    TEST_ASSERT_FALSE(task.poll(0));                            // Nothing posted
+
+    task.post(makeModel("RX"));
+    task.post(makeModel("TX FAIL"));
+    TEST_ASSERT_TRUE(task.poll(0));
+    TEST_ASSERT_EQUAL_UINT32(1, log.draws);
+    TEST_ASSERT_EQUAL_STRING("TX FAIL", log.last_line1);
+    TEST_ASSERT_EQUAL_UINT32(TILE_ROWS, sink.calls);            // First flush: full frame
+
+    DisplayTaskStats stats = task.getStats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.posted);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.rendered);
+
+    task.resetStats();
+    stats = task.getStats();
+    TEST_ASSERT_EQUAL_UINT32(0, stats.posted);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+}
+
+void test_max_fps_paces_renders() {
+    CountingSink sink;
+    DirtyTileRenderer renderer;
+    renderer.attach(s_frame, &sink);
+    DrawLog log;
+    log.frame = s_frame;
+
+    DisplayTaskConfig config = getDefaultDisplayTaskConfig();
+    config.max_fps = 10;
+    DisplayTask task(config);
+    task.begin(drawModel, &log, &renderer);
+
+    task.post(makeModel("a"));
+    TEST_ASSERT_TRUE(task.poll(1000));
+
+    task.post(makeModel("b"));
+    TEST_ASSERT_EQUAL_UINT32(60, task.msUntilNextFrame(1040));
+    TEST_ASSERT_FALSE(task.poll(1040));                         // Too soon; stays pending
+    TEST_ASSERT_TRUE(task.poll(1100));
+    TEST_ASSERT_EQUAL_STRING("b", log.last_line1);
+    TEST_ASSERT_EQUAL_UINT32(0, task.msUntilNextFrame(1300));
+
+    // A burst of posts inside one interval collapses into a single render
+    uint32_t now = 1100;
+    for (int i = 0; i < 30; i++) {
+        char text[8];
+        snprintf(text, sizeof(text), "p%d", i);
+        task.post(makeModel(text));
+        now += 5;
+        task.poll(now);
+    }
+    TEST_ASSERT_EQUAL_UINT32(3, log.draws);                     // Only at 1200, with p19
+    TEST_ASSERT_EQUAL_STRING("p19", log.last_line1);
+    TEST_ASSERT_TRUE(task.poll(1300));                          // Newest of the rest
+    TEST_ASSERT_EQUAL_STRING("p29", log.last_line1);
+}
+
+void test_unchanged_model_sends_nothing() {
+    CountingSink sink;
+    DirtyTileRenderer renderer;
+    renderer.attach(s_frame, &sink);
+    DrawLog log;
+    log.frame = s_frame;
+
+    DisplayTask task;
+    task.begin(drawModel, &log, &renderer);
+    task.post(makeModel("Idle"));
+    task.poll(0);
+    sink.calls = 0;
+
+    task.post(makeModel("Idle"));
+    TEST_ASSERT_TRUE(task.poll(1000));
+    TEST_ASSERT_EQUAL_UINT32(0, sink.calls);
+
+    ScreenModel dot = makeModel("Idle");
+    dot.ping.dot = true;
+    task.post(dot);
+    TEST_ASSERT_TRUE(task.poll(2000));
+    TEST_ASSERT_EQUAL_UINT32(1, sink.calls);
+}
+
+void test_concurrent_producer_never_tears() {
+    DisplayMailbox mailbox;
+    const uint32_t total = 200000;
+    bool torn = false;
+    bool reordered = false;
+    uint32_t taken = 0;
+
+    std::thread producer([&mailbox, total]() {
+        ScreenModel model;
+        memset(&model, 0, sizeof(model));
+        for (uint32_t i = 1; i <= total; i++) {
+            // Every byte of the payload carries the same value
+            const char fill = static_cast<char>('a' + i % 26);
+            memset(model.header.line1, fill, sizeof(model.header.line1));
+            memset(model.header.line2, fill, sizeof(model.header.line2));
+            model.battery_percent = static_cast<uint8_t>(fill);
+            mailbox.post(model);
+            if (i % 64 == 0) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    uint32_t last = 0;
+    while (last < total) {
+        const ScreenModel* model = mailbox.take();
+        if (!model) {
+            std::this_thread::yield();
+            continue;
+        }
+        taken++;
+        if (model->sequence <= last) {
+            reordered = true;
+        }
+        last = model->sequence;
+        const char fill = model->header.line1[0];
+        for (size_t i = 0; i < sizeof(model->header.line1); i++) {
+            torn |= model->header.line1[i] != fill || model->header.line2[i] != fill;
+        }
+        torn |= model->battery_percent != static_cast<uint8_t>(fill);
+        torn |= fill != static_cast<char>('a' + model->sequence % 26);
+    }
+    producer.join();
+
+    TEST_ASSERT_FALSE(torn);
+    TEST_ASSERT_FALSE(reordered);
+    TEST_ASSERT_EQUAL_UINT32(total, mailbox.getPosted());
+    TEST_ASSERT_EQUAL_UINT32(total, taken + mailbox.getDropped());
+    printf("mailbox stress: %lu posted, %lu taken, %lu dropped\n", (unsigned long)total, (unsigned long)taken,
+           (unsigned long)mailbox.getDropped());
+}
+
+void test_benchmark_post_cost() {
+    DisplayTask task;
+    ScreenModel model = makeModel("RX");
+    const int rounds = 1000000;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        model.signal.rssi_dbm = static_cast<int16_t>(-i % 120);
+        task.post(model);
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / rounds;
+    printf("display post: %.1f ns/call (host), model %u bytes; synchronous full flush @100 kHz was %lu us\n", ns,
+           (unsigned)sizeof(ScreenModel),
+           (unsigned long)estimateI2CMicros(FRAME_BYTES + TILE_ROWS * RUN_OVERHEAD_BYTES, 100000));
+    TEST_ASSERT_EQUAL_UINT32(rounds, task.getStats().posted);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_mailbox_latest_wins);
+    RUN_TEST(test_taken_frame_survives_later_posts);
+    RUN_TEST(test_poll_renders_and_flushes_newest);
+    RUN_TEST(test_max_fps_paces_renders);
+    RUN_TEST(test_unchanged_model_sends_nothing);
+    RUN_TEST(test_concurrent_producer_never_tears);
+    RUN_TEST(test_benchmark_post_cost);
+
+    return UNITY_END();
+}
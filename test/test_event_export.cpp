@@ -0,0 +1,299 @@
+// Unit tests and native benchmark for the streaming event log export
+#include <unity.h>
+#include "../src/system/event_export.h"
+#include "../src/hardware/flash_partition.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <unistd.h>
+
+using namespace Logging;
+using HardwareAbstraction::FlashPartition;
+using HardwareAbstraction::Simulation::FileFlashPartition;
+
+// Heap accounting: every allocation made while an export runs is counted
+static size_t s_heap_allocations = 0;
+static size_t s_heap_bytes = 0;
+
+void* operator new(size_t size) {
+    s_heap_allocations++;
+    s_heap_bytes += size;
+    void* p = malloc(size ? size : 1);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+static constexpr size_t PER_SEGMENT = EventLog::RECORDS_PER_SEGMENT;
+static constexpr uint32_t EPOCH = 1760000000;
+
+static char s_path[64];
+static FileFlashPartition s_flash;
+static EventLog s_log;
+static uint32_t s_clock = 0;                        // Unix seconds handed to the log, 0 = unknown
+
+// Capture sink
+static uint8_t s_out[EventLog::MAX_SEGMENTS * EventLog::SEGMENT_SIZE * 4];
+static size_t s_out_len = 0;
+static size_t s_chunks = 0;
+static size_t s_max_chunk = 0;
+static int s_fail_after_chunks = -1;
+
+static uint32_t clockSource() {
+    return s_clock;
+}
+
+static bool captureSink(void* context, const uint8_t* data, size_t length) {
+    if (s_fail_after_chunks >= 0 && static_cast<int>(s_chunks) >= s_fail_after_chunks) {
+        return false;
+    }
+    if (s_out_len + length > sizeof(s_out)) {
+        return false;
+    }
+    memcpy(s_out + s_out_len, data, length);
+    s_out_len += length;
+    s_chunks++;
+    s_max_chunk = length > s_max_chunk ? length : s_max_chunk;
+    return true;
+}
+
+static void resetCapture() {
+    s_out_len = 0;
+    s_chunks = 0;
+    s_max_chunk = 0;
+    s_fail_after_chunks = -1;
+}
+
+static void openLog(size_t sectors) {
+    s_flash.close();
+    unlink(s_path);
+    TEST_ASSERT_TRUE(s_flash.open(s_path, sectors * FlashPartition::SECTOR_SIZE));
+    s_log = EventLog();
+    TEST_ASSERT_TRUE(s_log.begin(&s_flash));
+    s_log.setTimeSource(clockSource);
+}
+
+// One strike per second of wall-clock time
+static void appendStrikes(uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        StrikeEventData strike = {};
+        strike.energy = 1000 + i;
+        strike.distance_km = static_cast<uint8_t>(5 + i % 30);
+        strike.strike_count = 1;
+        TEST_ASSERT_TRUE(s_log.append(EventType::STRIKE, &strike, sizeof(strike)));
+        if (s_clock != 0) {
+            s_clock++;
+        }
+    }
+}
+
+static size_t countLines(const uint8_t* data, size_t length) {
+    size_t lines = 0;
+    for (size_t i = 0; i < length; i++) {
+        lines += data[i] == '\n';
+    }
+    return lines;
+}
+
+// Last line of the NDJSON output, without its newline
+static const char* summaryLine() {
+    static char line[256];
+    size_t end = s_out_len - 1;
+    size_t begin = end;
+    while (begin > 0 && s_out[begin - 1] != '\n') {
+        begin--;
+    }
+    memcpy(line, s_out + begin, end - begin);
+    line[end - begin] = '\0';
+    return line;
+}
+
+void setUp(void) {
+    snprintf(s_path, sizeof(s_path), "/tmp/test_event_export_%d.bin", static_cast<int>(getpid()));
+    s_clock = EPOCH;
+    resetCapture();
+}
+
+void tearDown(void) {
+    s_log.end();
+    s_flash.close();
+    unlink(s_path);
+}
+
+void test_ndjson_lines_per_event_type() {
+    openLog(4);
+    appendStrikes(2);
+    const uint8_t reason = 3;
+    s_log.append(EventType::BOOT, &reason, sizeof(reason));
+    const char alert[] = "say \"hi\"\n";
+    s_log.append(EventType::ALERT, alert, sizeof(alert), 7);
+    s_log.append(EventType::STORM_STARTED);
+
+    EventExporter exporter(s_log, captureSink, nullptr);
+    TEST_ASSERT_TRUE(exporter.run(getDefaultEventQuery()));
+    s_out[s_out_len] = '\0';
+
+    const char* text = reinterpret_cast<const char*>(s_out);
+    TEST_ASSERT_EQUAL(6, countLines(s_out, s_out_len));
+    TEST_ASSERT_NOT_NULL(strstr(text, "{\"seq\":1,\"uptime_ms\":"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"type\":\"strike\",\"flags\":0,\"time\":1760000000,\"km\":5,\"energy\":1000,\"count\":1}\n"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"type\":\"boot\",\"flags\":0,\"time\":1760000002,\"reset_reason\":3}\n"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"type\":\"alert\",\"flags\":7,\"time\":1760000002,\"text\":\"say \\\"hi\\\"\\u000a\"}\n"));
+    TEST_ASSERT_NOT_NULL(strstr(text, "\"type\":\"storm_started\",\"flags\":0,\"time\":1760000002}\n"));
+    TEST_ASSERT_EQUAL_STRING("{\"next_cursor\":6,\"records\":5,\"skipped\":0,\"more\":false}", summaryLine());
+
+    const EventExportStats& stats = exporter.getStats();
+    TEST_ASSERT_EQUAL_UINT32(5, stats.records);
+    TEST_ASSERT_EQUAL_UINT32(s_out_len, stats.bytes);
+    TEST_ASSERT_FALSE(stats.more);
+}
+
+void test_time_range_seeks_by_segment() {
+    openLog(16);
+    s_clock = 0;
+    appendStrikes(50);                              // Before GPS time: excluded from timed queries
+    s_clock = EPOCH;
+    appendStrikes(15 * PER_SEGMENT);
+
+    EventQuery query = getDefaultEventQuery();
+    query.from_time = EPOCH + 1000;
+    query.to_time = EPOCH + 1099;
+    query.format = ExportFormat::BINARY;
+
+    EventExporter exporter(s_log, captureSink, nullptr);
+    TEST_ASSERT_TRUE(exporter.run(query));
+    const EventExportStats& stats = exporter.getStats();
+    TEST_ASSERT_EQUAL_UINT32(100, stats.records);
+    TEST_ASSERT_EQUAL_UINT32(100 * sizeof(EventRecord), s_out_len);
+
+    const EventRecord* records = reinterpret_cast<const EventRecord*>(s_out);
+    TEST_ASSERT_EQUAL_UINT32(EPOCH + 1000, records[0].unix_time);
+    TEST_ASSERT_EQUAL_UINT32(51 + 1000, records[0].sequence);
+    TEST_ASSERT_EQUAL_UINT32(EPOCH + 1099, records[99].unix_time);
+
+    // Started at most one segment early instead of scanning from the oldest record
+    TEST_ASSERT_TRUE(stats.scanned <= 100 + 2 * PER_SEGMENT);
+    TEST_ASSERT_EQUAL_UINT32(51 + 1100, stats.next_cursor);
+
+    // Untimed queries include the records logged before the clock was set
+    resetCapture();
+    TEST_ASSERT_TRUE(exporter.run(getDefaultEventQuery()));
+    TEST_ASSERT_EQUAL_UINT32(50 + 15 * PER_SEGMENT, exporter.getStats().records);
+
+    // A range before the first timed record starts at the oldest
+    resetCapture();
+    query.from_time = EPOCH - 100;
+    query.to_time = EPOCH + 4;
+    TEST_ASSERT_TRUE(exporter.run(query));
+    TEST_ASSERT_EQUAL_UINT32(5, exporter.getStats().records);
+}
+
+void test_cursor_paging_covers_everything_once() {
+    openLog(8);
+    appendStrikes(5 * PER_SEGMENT + 3);
+
+    EventQuery query = getDefaultEventQuery();
+    query.format = ExportFormat::BINARY;
+    query.limit = 100;
+
+    EventExporter exporter(s_log, captureSink, nullptr);
+    uint32_t pages = 0;
+    do {
+        TEST_ASSERT_TRUE(exporter.run(query));
+        query.cursor = exporter.getStats().next_cursor;
+        pages++;
+    } while (exporter.getStats().more);
+
+    const uint32_t total = 5 * PER_SEGMENT + 3;
+    TEST_ASSERT_EQUAL_UINT32((total + 99) / 100, pages);
+    TEST_ASSERT_EQUAL_UINT32(total * sizeof(EventRecord), s_out_len);
+    const EventRecord* records = reinterpret_cast<const EventRecord*>(s_out);
+    for (uint32_t i = 0; i < total; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i + 1, records[i].sequence);
+    }
+    TEST_ASSERT_EQUAL_UINT32(total + 1, query.cursor);
+
+    // Nothing new: an empty page, and new appends show up on the next one
+    resetCapture();
+    TEST_ASSERT_TRUE(exporter.run(query));
+    TEST_ASSERT_EQUAL_UINT32(0, exporter.getStats().records);
+    appendStrikes(2);
+    TEST_ASSERT_TRUE(exporter.run(query));
+    TEST_ASSERT_EQUAL_UINT32(2, exporter.getStats().records);
+    TEST_ASSERT_EQUAL_UINT32(total + 1, reinterpret_cast<const EventRecord*>(s_out)[0].sequence);
+}
+
+void test_sink_failure_aborts() {
+    openLog(8);
+    appendStrikes(500);
+
+    s_fail_after_chunks = 2;
+    EventExporter exporter(s_log, captureSink, nullptr);
+    TEST_ASSERT_FALSE(exporter.run(getDefaultEventQuery()));
+    TEST_ASSERT_TRUE(exporter.getStats().aborted);
+    TEST_ASSERT_EQUAL(2, s_chunks);
+    TEST_ASSERT_TRUE(exporter.getStats().records < 500);
+}
+
+void test_benchmark_full_export() {
+    openLog(EventLog::MAX_SEGMENTS);
+    appendStrikes(EventLog::MAX_SEGMENTS * PER_SEGMENT);
+    const uint32_t retained = s_log.getStats().next_sequence - s_log.getStats().oldest_sequence;
+
+    const ExportFormat formats[] = {ExportFormat::NDJSON, ExportFormat::BINARY};
+    for (ExportFormat format : formats) {
+        EventQuery query = getDefaultEventQuery();
+        query.format = format;
+
+        const int rounds = 10;
+        double ns = 0;
+        size_t allocations = 0;
+        size_t allocated = 0;
+        EventExportStats stats = {};
+        for (int r = 0; r < rounds; r++) {
+            resetCapture();
+            EventExporter exporter(s_log, captureSink, nullptr);
+            const size_t allocations_before = s_heap_allocations;
+            const size_t bytes_before = s_heap_bytes;
+            auto t0 = std::chrono::steady_clock::now();
+            TEST_ASSERT_TRUE(exporter.run(query));
+            auto t1 = std::chrono::steady_clock::now();
+            allocations += s_heap_allocations - allocations_before;
+            allocated += s_heap_bytes - bytes_before;
+            ns += std::chrono::duration<double, std::nano>(t1 - t0).count();
+            stats = exporter.getStats();
+        }
+
+        TEST_ASSERT_EQUAL_UINT32(retained, stats.records);
+        TEST_ASSERT_EQUAL(0, allocations);
+        TEST_ASSERT_TRUE(s_max_chunk <= EventExporter::BUFFER_SIZE);
+
+        const double per_record = ns / rounds / stats.records;
+        printf("export %-6s %5lu records %7lu B in %4lu chunks  %6.1f ns/record (%.2f M records/s)  heap %lu B\n",
+               exportFormatToString(format), (unsigned long)stats.records, (unsigned long)stats.bytes,
+               (unsigned long)stats.chunks, per_record, 1000.0 / per_record, (unsigned long)(allocated / rounds));
+    }
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ndjson_lines_per_event_type);
+    RUN_TEST(test_time_range_seeks_by_segment);
+    RUN_TEST(test_cursor_paging_covers_everything_once);
+    RUN_TEST(test_sink_failure_aborts);
+    RUN_TEST(test_benchmark_full_export);
+
+    return UNITY_END();
+}
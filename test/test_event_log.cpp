@@ -0,0 +1,348 @@
+// Unit tests and native benchmark for the flash event log on the file-backed partition emulator
+#include <unity.h>
+#include "../src/system/event_log.h"
+#include "../src/hardware/flash_partition.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+using namespace Logging;
+using HardwareAbstraction::FlashPartition;
+using HardwareAbstraction::Simulation::FileFlashPartition;
+
+static constexpr size_t PER_SEGMENT = EventLog::RECORDS_PER_SEGMENT;
+
+static char s_path[64];
+static FileFlashPartition s_flash;
+static EventLog s_log;
+
+static void openFresh(size_t sectors) {
+    s_flash.close();
+    unlink(s_path);
+    TEST_ASSERT_TRUE(s_flash.open(s_path, sectors * FlashPartition::SECTOR_SIZE));
+}
+
+// Power cycle: new file mapping, new log object recovering from flash alone
+static void reboot() {
+    const size_t size = s_flash.size();
+    s_flash.close();
+    TEST_ASSERT_TRUE(s_flash.open(s_path, size));
+    s_log = EventLog();
+    TEST_ASSERT_TRUE(s_log.begin(&s_flash));
+}
+
+static void appendStrike(uint32_t i) {
+    StrikeEventData strike = {};
+    strike.energy = i * 1000;
+    strike.distance_km = static_cast<uint8_t>(i % 40);
+    strike.strike_count = 1;
+    TEST_ASSERT_TRUE(s_log.append(EventType::STRIKE, &strike, sizeof(strike), static_cast<uint16_t>(i)));
+}
+
+// Reads everything from fromSequence and checks it is the contiguous run first..last
+static void expectRun(uint32_t fromSequence, uint32_t first, uint32_t last) {
+    EventLog::Reader reader = s_log.read(fromSequence);
+    uint32_t expected = first;
+    while (const EventRecord* record = reader.next()) {
+        TEST_ASSERT_EQUAL_UINT32(expected, record->sequence);
+        expected++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(last + 1, expected);
+}
+
+void setUp(void) {
+    snprintf(s_path, sizeof(s_path), "/tmp/test_event_log_%d.bin", static_cast<int>(getpid()));
+    s_log = EventLog();
+}
+
+void tearDown(void) {
+    s_log.end();
+    s_flash.close();
+    unlink(s_path);
+}
+
+void test_append_and_zero_copy_read() {
+    openFresh(8);
+    TEST_ASSERT_TRUE(s_log.begin(&s_flash));
+    TEST_ASSERT_EQUAL_UINT32(8, s_log.getStats().segments);
+    TEST_ASSERT_EQUAL_UINT32(1, s_log.getStats().next_sequence);
+
+    uint32_t epoch = 1760000000;
+    s_log.setTimeSource([]() -> uint32_t { return 1760000000; });
+
+    const uint32_t count = 300;                     // Spans three segments
+    for (uint32_t i = 1; i <= count; i++) {
+        appendStrike(i);
+    }
+    const char alert[] = "STORM 5km";
+    TEST_ASSERT_TRUE(s_log.append(EventType::ALERT, alert, sizeof(alert)));
+
+    EventLog::Reader reader = s_log.read();
+    const uint8_t* begin = s_flash.data();
+    const uint8_t* end = begin + s_flash.size();
+    for (uint32_t i = 1; i <= count; i++) {
+        const EventRecord* record = reader.next();
+        TEST_ASSERT_NOT_NULL(record);
+
+        // Pointers straight into the mapped partition
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(record);
+        TEST_ASSERT_TRUE(p >= begin && p + sizeof(EventRecord) <= end);
+
+        TEST_ASSERT_EQUAL_UINT32(i, record->sequence);
+        TEST_ASSERT_EQUAL_UINT16(static_cast<uint16_t>(EventType::STRIKE), record->type);
+        TEST_ASSERT_EQUAL_UINT16(i, record->flags);
+        TEST_ASSERT_EQUAL_UINT32(epoch, record->unix_time);
+        StrikeEventData strike;
+        memcpy(&strike, record->data, sizeof(strike));
+        TEST_ASSERT_EQUAL_UINT32(i * 1000, strike.energy);
+        TEST_ASSERT_EQUAL_UINT8(i % 40, strike.distance_km);
+    }
+    const EventRecord* last = reader.next();
+    TEST_ASSERT_NOT_NULL(last);
+    TEST_ASSERT_EQUAL_UINT16(static_cast<uint16_t>(EventType::ALERT), last->type);
+    TEST_ASSERT_EQUAL_STRING(alert, reinterpret_cast<const char*>(last->data));
+    TEST_ASSERT_NULL(reader.next());
+    TEST_ASSERT_EQUAL_UINT32(0, reader.getSkipped());
+
+    // Starting mid-log, and the reader picks up later appends
+    expectRun(250, 250, count + 1);
+    EventLog::Reader tail = s_log.read(count + 2);
+    TEST_ASSERT_NULL(tail.next());
+    appendStrike(999);
+    const EventRecord* late = tail.next();
+    TEST_ASSERT_NOT_NULL(late);
+    TEST_ASSERT_EQUAL_UINT32(count + 2, late->sequence);
+
+    TEST_ASSERT_EQUAL_UINT32(count + 2, s_log.getStats().appends);
+    TEST_ASSERT_EQUAL_UINT32(2, s_log.getStats().rotations);
+}
+
+void test_rotation_drops_oldest_segment() {
+    openFresh(4);
+    TEST_ASSERT_TRUE(s_log.begin(&s_flash));
+
+    const uint32_t count = 4 * PER_SEGMENT + 50;    // Wraps once, overwriting segment 0
+    for (uint32_t i = 1; i <= count; i++) {
+        appendStrike(i);
+    }
+
+    const EventLogStats& stats = s_log.getStats();
+    TEST_ASSERT_EQUAL_UINT32(4, stats.rotations);
+    TEST_ASSERT_EQUAL_UINT32(PER_SEGMENT + 1, stats.oldest_sequence);
+    TEST_ASSERT_EQUAL_UINT32(count + 1, stats.next_sequence);
+
+    // Asking for evicted history starts at the oldest retained record
+    expectRun(1, PER_SEGMENT + 1, count);
+    expectRun(0, PER_SEGMENT + 1, count);
+
+    // A reader overtaken by rotation skips what it lost and carries on
+    EventLog::Reader reader = s_log.read();
+    TEST_ASSERT_EQUAL_UINT32(PER_SEGMENT + 1, reader.next()->sequence);
+    for (uint32_t i = 0; i < PER_SEGMENT; i++) {
+        appendStrike(count + 1 + i);
+    }
+    const EventRecord* record = reader.next();
+    TEST_ASSERT_NOT_NULL(record);
+    TEST_ASSERT_EQUAL_UINT32(2 * PER_SEGMENT + 1, record->sequence);
+    TEST_ASSERT_EQUAL_UINT32(PER_SEGMENT - 1, reader.getSkipped());
+}
+
+void test_recovery_after_reboot() {
+    openFresh(8);
+    TEST_ASSERT_TRUE(s_log.begin(&s_flash));
+    for (uint32_t i = 1; i <= 3 * PER_SEGMENT + 17; i++) {
+        appendStrike(i);
+    }
+
+    reboot();
+    const EventLogStats& stats = s_log.getStats();
+    TEST_ASSERT_EQUAL_UINT32(3 * PER_SEGMENT + 18, stats.next_sequence);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.oldest_sequence);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.invalid_segments);
+    expectRun(0, 1, 3 * PER_SEGMENT + 17);
+
+    // Appends continue where the previous boot stopped, including on a full head
+    for (uint32_t i = 0; i < PER_SEGMENT - 17; i++) {
+        appendStrike(i);
+    }
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(4 * PER_SEGMENT + 1, s_log.getStats().next_sequence);
+    appendStrike(0);
+    TEST_ASSERT_EQUAL_UINT32(1, s_log.getStats().rotations);
+    expectRun(0, 1, 4 * PER_SEGMENT + 1);
+}
+
+void test_torn_record_is_skipped() {
+    openFresh(4);
+    TEST_ASSERT_TRUE(s_log.begin(&s_flash));
+    for (uint32_t i = 1; i <= 10; i++) {
+        appendStrike(i);
+    }
+
+    // Power dies 10 bytes into record 11
+    s_flash.failAfterBytes(10);
+    StrikeEventData strike = {};
+    TEST_ASSERT_FALSE(s_log.append(EventType::STRIKE, &strike, sizeof(strike)));
+    s_flash.clearPowerFail();
+
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(12, s_log.getStats().next_sequence);
+    appendStrike(12);
+
+    EventLog::Reader reader = s_log.read();
+    uint32_t seen = 0;
+    while (const EventRecord* record = reader.next()) {
+        TEST_ASSERT_TRUE(record->sequence != 11);
+        seen++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(11, seen);
+    TEST_ASSERT_EQUAL_UINT32(1, reader.getSkipped());
+
+    // Power dies before a single byte lands: the slot is reused
+    s_flash.failAfterBytes(0);
+    TEST_ASSERT_FALSE(s_log.append(EventType::STRIKE, &strike, sizeof(strike)));
+    s_flash.clearPowerFail();
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(13, s_log.getStats().next_sequence);
+    expectRun(13, 13, 12);
+}
+
+void test_power_loss_during_rotation() {
+    const uint32_t full = 4 * PER_SEGMENT;
+    openFresh(4);
+    TEST_ASSERT_TRUE(s_log.begin(&s_flash));
+    for (uint32_t i = 1; i <= full; i++) {
+        appendStrike(i);
+    }
+
+    // The next append recycles segment 0; power dies during its erase
+    s_flash.failAfterBytes(0);
+    TEST_ASSERT_FALSE(s_log.append(EventType::BOOT));
+    s_flash.clearPowerFail();
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(1, s_log.getStats().invalid_segments);
+    TEST_ASSERT_EQUAL_UINT32(full + 1, s_log.getStats().next_sequence);
+    expectRun(0, PER_SEGMENT + 1, full);
+
+    // Torn header on the retry
+    s_flash.failAfterBytes(12);
+    TEST_ASSERT_FALSE(s_log.append(EventType::BOOT));
+    s_flash.clearPowerFail();
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(1, s_log.getStats().invalid_segments);
+    TEST_ASSERT_EQUAL_UINT32(full + 1, s_log.getStats().next_sequence);
+    expectRun(0, PER_SEGMENT + 1, full);
+
+    // Third time lucky; the lost erase count is assumed to be the highest seen.
+    // Rotating into blank sectors did not erase them.
+    appendStrike(0);
+    TEST_ASSERT_EQUAL_UINT32(full + 2, s_log.getStats().next_sequence);
+    TEST_ASSERT_EQUAL_UINT32(0, s_log.getSegmentEraseCount(1));
+    TEST_ASSERT_EQUAL_UINT32(1, s_log.getSegmentEraseCount(0));
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(0, s_log.getStats().invalid_segments);
+    expectRun(0, PER_SEGMENT + 1, full + 1);
+}
+
+void test_erase_counts_level_across_segments() {
+    const size_t sectors = 8;
+    openFresh(sectors);
+    TEST_ASSERT_TRUE(s_log.begin(&s_flash));
+
+    const uint32_t laps = 20;
+    for (uint32_t i = 0; i < laps * sectors * PER_SEGMENT; i++) {
+        appendStrike(i);
+    }
+
+    // The first lap found every sector blank; each later lap erased each once
+    uint32_t minCount = UINT32_MAX;
+    uint32_t maxCount = 0;
+    for (size_t s = 0; s < sectors; s++) {
+        const uint32_t count = s_flash.getEraseCount(s);
+        TEST_ASSERT_EQUAL_UINT32(count, s_log.getSegmentEraseCount(s));
+        minCount = count < minCount ? count : minCount;
+        maxCount = count > maxCount ? count : maxCount;
+    }
+    TEST_ASSERT_TRUE(maxCount - minCount <= 1);
+    TEST_ASSERT_EQUAL_UINT32(laps - 1, maxCount);
+
+    // Counts live in the segment headers and survive a reboot
+    reboot();
+    TEST_ASSERT_EQUAL_UINT32(minCount, s_log.getStats().min_erase_count);
+    TEST_ASSERT_EQUAL_UINT32(maxCount, s_log.getStats().max_erase_count);
+    for (size_t s = 0; s < sectors; s++) {
+        TEST_ASSERT_EQUAL_UINT32(0, s_flash.getEraseCount(s));
+        TEST_ASSERT_TRUE(s_log.getSegmentEraseCount(s) >= minCount);
+    }
+}
+
+void test_benchmark_append_and_recovery() {
+    const size_t sectors = EventLog::MAX_SEGMENTS;  // 256 KiB partition
+    openFresh(sectors);
+    TEST_ASSERT_TRUE(s_log.begin(&s_flash));
+
+    const uint32_t count = 100000;                  // ~12 laps of the partition
+    StrikeEventData strike = {};
+    strike.distance_km = 12;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        strike.energy = i;
+        s_log.append(EventType::STRIKE, &strike, sizeof(strike));
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    TEST_ASSERT_EQUAL_UINT32(count, s_log.getStats().appends);
+
+    uint32_t read = 0;
+    EventLog::Reader reader = s_log.read();
+    while (reader.next()) {
+        read++;
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(read > (sectors - 1) * PER_SEGMENT);
+
+    const uint32_t rotations = s_log.getStats().rotations;
+    const unsigned long long programmed = s_flash.getBytesWritten();
+
+    // Recovery time with the head segment half full
+    for (uint32_t i = 0; i < PER_SEGMENT / 2; i++) {
+        s_log.append(EventType::STRIKE, &strike, sizeof(strike));
+    }
+    const size_t size = s_flash.size();
+    s_flash.close();
+    TEST_ASSERT_TRUE(s_flash.open(s_path, size));
+    const int rounds = 1000;
+    auto t3 = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        s_log = EventLog();
+        s_log.begin(&s_flash);
+    }
+    auto t4 = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(s_log.isReady());
+
+    const double append_ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / count;
+    const double read_ns = std::chrono::duration<double, std::nano>(t2 - t1).count() / read;
+    const double recover_us = std::chrono::duration<double, std::micro>(t4 - t3).count() / rounds;
+    const EventLogStats& stats = s_log.getStats();
+
+    printf("eventlog append %6.1f ns/record (%.2f M/s)   read %5.1f ns/record   recovery %5.2f us\n",
+           append_ns, 1000.0 / append_ns, read_ns, recover_us);
+    printf("eventlog %u segments x %u records, %lu rotations, erase counts %lu..%lu, %llu bytes programmed\n",
+           (unsigned)stats.segments, (unsigned)stats.records_per_segment, (unsigned long)rotations,
+           (unsigned long)stats.min_erase_count, (unsigned long)stats.max_erase_count, programmed);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_append_and_zero_copy_read);
+    RUN_TEST(test_rotation_drops_oldest_segment);
+    RUN_TEST(test_recovery_after_reboot);
+    RUN_TEST(test_torn_record_is_skipped);
+    RUN_TEST(test_power_loss_during_rotation);
+    RUN_TEST(test_erase_counts_level_across_segments);
+    RUN_TEST(test_benchmark_append_and_recovery);
+
+    return UNITY_END();
+}
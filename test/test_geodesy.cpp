@@ -0,0 +1,177 @@
+// Unit tests and native benchmark for the batch geodesy kernels
+#include <unity.h>
+#include "../src/sensors/geodesy.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+using namespace Geodesy;
+
+static constexpr size_t MAX_TARGETS = 1024;
+static float s_lat[MAX_TARGETS];
+static float s_lon[MAX_TARGETS];
+static float s_distance[MAX_TARGETS];
+static float s_bearing[MAX_TARGETS];
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Deterministic pseudo-random targets within max_km of the origin
+static uint32_t s_seed = 12345;
+static float nextUnit() {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return (s_seed >> 8) / 16777216.0f;
+}
+
+static void fillTargets(double lat0, double lon0, float max_km, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        const float r = max_km * sqrtf(nextUnit());
+        const float theta = 2.0f * static_cast<float>(M_PI) * nextUnit();
+        const double dlat = (r * cosf(theta)) / EARTH_RADIUS_KM * 180.0 / M_PI;
+        const double dlon = (r * sinf(theta)) / (EARTH_RADIUS_KM * cos(lat0 * M_PI / 180.0)) * 180.0 / M_PI;
+        double lon = lon0 + dlon;
+        if (lon > 180.0) lon -= 360.0;
+        if (lon < -180.0) lon += 360.0;
+        s_lat[i] = static_cast<float>(lat0 + dlat);
+        s_lon[i] = static_cast<float>(lon);
+    }
+}
+
+static float bearingError(float a, float b) {
+    float d = fabsf(a - b);
+    return (d > 180.0f) ? 360.0f - d : d;
+}
+
+// Max distance (km) and bearing (deg) error against the double-precision formulas
+static void measureError(double lat0, double lon0, Method method, float* max_dist_err, float* max_bearing_err) {
+    const Origin origin = makeOrigin(lat0, lon0);
+    const TargetBuffer targets = {s_lat, s_lon, MAX_TARGETS};
+    distanceBearing(origin, targets, {s_distance, s_bearing}, method);
+
+    *max_dist_err = 0.0f;
+    *max_bearing_err = 0.0f;
+    for (size_t i = 0; i < MAX_TARGETS; i++) {
+        const double exact_d = haversineKm(lat0, lon0, s_lat[i], s_lon[i]);
+        *max_dist_err = fmaxf(*max_dist_err, fabsf(s_distance[i] - static_cast<float>(exact_d)));
+
+        // Bearing is ill-conditioned for near-coincident points
+        if (exact_d > 1.0) {
+            const double exact_b = initialBearingDeg(lat0, lon0, s_lat[i], s_lon[i]);
+            *max_bearing_err = fmaxf(*max_bearing_err, bearingError(s_bearing[i], static_cast<float>(exact_b)));
+        }
+    }
+}
+
+void test_haversine_reference_values() {
+    // Paris to London
+    TEST_ASSERT_FLOAT_WITHIN(1.0, 343.5, haversineKm(48.8566, 2.3522, 51.5074, -0.1278));
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 330.0, initialBearingDeg(48.8566, 2.3522, 51.5074, -0.1278));
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, 0.0, haversineKm(10.0, 20.0, 10.0, 20.0));
+}
+
+void test_fast_path_error_bounds_within_100km() {
+    const double origins[][2] = {
+        {0.0, 0.0}, {39.7, -105.0}, {-33.9, 151.2}, {60.2, 24.9}, {75.0, -40.0}, {52.0, 179.9}
+    };
+
+    for (const auto& o : origins) {
+        fillTargets(o[0], o[1], FAST_PATH_MAX_KM, MAX_TARGETS);
+        float dist_err, bearing_err;
+        measureError(o[0], o[1], Method::FAST, &dist_err, &bearing_err);
+
+        char msg[64];
+        snprintf(msg, sizeof(msg), "origin %.1f,%.1f", o[0], o[1]);
+        TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.02f, 0.0f, dist_err, msg);      // 20 m at 100 km
+        TEST_ASSERT_FLOAT_WITHIN_MESSAGE(0.01f, 0.0f, bearing_err, msg);
+    }
+}
+
+void test_auto_falls_back_beyond_fast_range() {
+    fillTargets(45.0, 10.0, 1000.0f, MAX_TARGETS);
+    const Origin origin = makeOrigin(45.0, 10.0);
+    const TargetBuffer targets = {s_lat, s_lon, MAX_TARGETS};
+    const size_t fallbacks = distanceBearing(origin, targets, {s_distance, s_bearing}, Method::AUTO);
+
+    // ~99% of a uniform disc of radius 1000 km lies beyond 100 km
+    TEST_ASSERT_GREATER_THAN(900, fallbacks);
+    TEST_ASSERT_LESS_THAN(MAX_TARGETS, fallbacks);
+
+    float dist_err, bearing_err;
+    measureError(45.0, 10.0, Method::AUTO, &dist_err, &bearing_err);
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 0.0f, dist_err);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, bearing_err);
+}
+
+void test_polar_origin_uses_exact_path() {
+    fillTargets(85.0, 0.0, 50.0f, MAX_TARGETS);
+    const Origin origin = makeOrigin(85.0, 0.0);
+    const TargetBuffer targets = {s_lat, s_lon, MAX_TARGETS};
+    TEST_ASSERT_EQUAL(MAX_TARGETS, distanceBearing(origin, targets, {s_distance, s_bearing}));
+}
+
+void test_antimeridian_and_null_bearing() {
+    const float lat[] = {0.0f, 0.0f, 0.0f};
+    const float lon[] = {-179.9f, 179.9f, 180.0f};
+    float distance[3];
+
+    const Origin origin = makeOrigin(0.0, 180.0);
+    const TargetBuffer targets = {lat, lon, 3};
+    TEST_ASSERT_EQUAL(0, distanceBearing(origin, targets, {distance, nullptr}));
+
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 11.12f, distance[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, 11.12f, distance[1]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, distance[2]);
+}
+
+void test_coincident_target_bearing_is_zero() {
+    const float lat[] = {45.0f};
+    const float lon[] = {7.0f};
+    float distance[1], bearing[1];
+
+    distanceBearing(makeOrigin(45.0, 7.0), {lat, lon, 1}, {distance, bearing});
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, distance[0]);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, bearing[0]);
+}
+
+// Timing only; prints ns/target for the fast and exact paths
+void test_benchmark_batch_sizes() {
+    fillTargets(39.7, -105.0, FAST_PATH_MAX_KM, MAX_TARGETS);
+    const Origin origin = makeOrigin(39.7, -105.0);
+    volatile float sink = 0.0f;
+
+    for (size_t n = 1; n <= MAX_TARGETS; n *= 2) {
+        const TargetBuffer targets = {s_lat, s_lon, n};
+        const int iterations = static_cast<int>(65536 / n);
+        double ns_per_target[2];
+        const Method methods[2] = {Method::AUTO, Method::EXACT};
+
+        for (int m = 0; m < 2; m++) {
+            const auto start = std::chrono::steady_clock::now();
+            for (int it = 0; it < iterations; it++) {
+                distanceBearing(origin, targets, {s_distance, s_bearing}, methods[m]);
+                sink = sink + s_distance[n - 1];
+            }
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            ns_per_target[m] = std::chrono::duration<double, std::nano>(elapsed).count() / (iterations * n);
+        }
+
+        printf("geodesy N=%4zu  fast %6.1f ns/target  exact %6.1f ns/target\n",
+               n, ns_per_target[0], ns_per_target[1]);
+    }
+
+    TEST_ASSERT_TRUE(sink > 0.0f);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_haversine_reference_values);
+    RUN_TEST(test_fast_path_error_bounds_within_100km);
+    RUN_TEST(test_auto_falls_back_beyond_fast_range);
+    RUN_TEST(test_polar_origin_uses_exact_path);
+    RUN_TEST(test_antimeridian_and_null_bearing);
+    RUN_TEST(test_coincident_target_bearing_is_zero);
+    RUN_TEST(test_benchmark_batch_sizes);
+
+    return UNITY_END();
+}
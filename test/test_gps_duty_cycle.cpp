@@ -0,0 +1,269 @@
+// Unit tests for the GPS duty-cycle controller
+#include <unity.h>
+#include "../src/sensors/gps_duty_cycle.h"
+#include <cstdio>
+
+using namespace GPS;
+
+static UC6580* gps = nullptr;
+static DutyCycleController* controller = nullptr;
+
+void setUp(void) {
+    HardwareAbstraction::initialize();
+    gps = new UC6580();
+
+    Config config = getDefaultConfig();
+    config.auto_power_on = false;
+    config.pps_pin = 255;
+    gps->initialize(config);
+
+    controller = new DutyCycleController(*gps);
+}
+
+void tearDown(void) {
+    delete controller;
+    controller = nullptr;
+    delete gps;
+    gps = nullptr;
+    HardwareAbstraction::deinitialize();
+}
+
+// Wrap an NMEA body with '$' and a valid checksum, then feed it
+static void feed(const char* body) {
+    uint8_t checksum = 0;
+    for (const char* p = body; *p; p++) {
+        checksum ^= static_cast<uint8_t>(*p);
+    }
+
+    char sentence[128];
+    snprintf(sentence, sizeof(sentence), "$%s*%02X", body, checksum);
+    gps->processNMEA(sentence);
+}
+
+// Feed a fix at the given position (NMEA ddmm.mmmm), speed in knots and course
+static void feedFix(const char* lat, const char* lon, float hdop, float knots, float course) {
+    char body[128];
+    snprintf(body, sizeof(body), "GPGGA,120000,%s,N,%s,E,1,08,%.1f,100.0,M,0.0,M,,", lat, lon, hdop);
+    feed(body);
+    snprintf(body, sizeof(body), "GPRMC,120000,A,%s,N,%s,E,%.1f,%.1f,010125,,", lat, lon, knots, course);
+    feed(body);
+}
+
+static DutyCycleConfig testConfig(DutyCycleMode mode) {
+    DutyCycleConfig config = getDefaultDutyCycleConfig();
+    config.mode = mode;
+    config.fix_interval_ms = 60000;
+    config.hot_start_interval_ms = 20000;
+    config.wake_lead_ms = 5000;
+    config.acquisition_timeout_ms = 30000;
+    config.stationary_fix_count = 2;
+    config.stationary_interval_ms = 600000;
+    return config;
+}
+
+void test_begin_requires_initialized_gps() {
+    UC6580 uninitialized;
+    DutyCycleController c(uninitialized);
+    TEST_ASSERT_EQUAL(HardwareAbstraction::Result::ERROR_NOT_INITIALIZED,
+                      c.begin(getDefaultDutyCycleConfig(), 0));
+}
+
+void test_always_on_keeps_receiver_powered() {
+    TEST_ASSERT_EQUAL(HardwareAbstraction::Result::SUCCESS,
+                      controller->begin(testConfig(DutyCycleMode::ALWAYS_ON), 0));
+    TEST_ASSERT_EQUAL(DutyCycleState::CONTINUOUS, controller->getState());
+    TEST_ASSERT_TRUE(gps->isPowered());
+
+    feedFix("4807.038", "01131.000", 0.9f, 0.0f, 0.0f);
+    controller->update(10000);
+    TEST_ASSERT_TRUE(gps->isPowered());
+    TEST_ASSERT_EQUAL_UINT32(10000, controller->getStats().on_time_ms);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.0f, controller->getStats().duty_cycle);
+}
+
+void test_periodic_fix_powers_down_after_good_fix() {
+    controller->begin(testConfig(DutyCycleMode::PERIODIC_FIX), 0);
+    TEST_ASSERT_EQUAL(DutyCycleState::ACQUIRING, controller->getState());
+    TEST_ASSERT_TRUE(gps->isPowered());
+
+    // Poor HDOP is not accepted
+    feedFix("4807.038", "01131.000", 4.5f, 10.0f, 90.0f);
+    controller->update(3000);
+    TEST_ASSERT_EQUAL(DutyCycleState::ACQUIRING, controller->getState());
+
+    feedFix("4807.038", "01131.000", 1.2f, 10.0f, 90.0f);
+    controller->update(4000);
+    TEST_ASSERT_EQUAL(DutyCycleState::SLEEPING, controller->getState());
+    TEST_ASSERT_FALSE(gps->isPowered());
+    TEST_ASSERT_EQUAL_UINT32(1, controller->getStats().fixes);
+    TEST_ASSERT_EQUAL_UINT32(4000, controller->getStats().last_acquisition_ms);
+    TEST_ASSERT_EQUAL_UINT32(64000, controller->getNextFixTime());
+
+    // Wakes wake_lead_ms ahead of the scheduled fix
+    controller->update(58000);
+    TEST_ASSERT_FALSE(gps->isPowered());
+    controller->update(59000);
+    TEST_ASSERT_TRUE(gps->isPowered());
+    TEST_ASSERT_EQUAL(DutyCycleState::ACQUIRING, controller->getState());
+}
+
+void test_acquisition_timeout_powers_down() {
+    controller->begin(testConfig(DutyCycleMode::PERIODIC_FIX), 0);
+
+    controller->update(29999);
+    TEST_ASSERT_EQUAL(DutyCycleState::ACQUIRING, controller->getState());
+    controller->update(30000);
+    TEST_ASSERT_EQUAL(DutyCycleState::SLEEPING, controller->getState());
+    TEST_ASSERT_FALSE(gps->isPowered());
+    TEST_ASSERT_EQUAL_UINT32(1, controller->getStats().failed_acquisitions);
+    TEST_ASSERT_EQUAL_UINT32(0, controller->getStats().fixes);
+}
+
+void test_stale_fix_not_accepted_after_wake() {
+    controller->begin(testConfig(DutyCycleMode::PERIODIC_FIX), 0);
+    feedFix("4807.038", "01131.000", 1.0f, 10.0f, 90.0f);
+    controller->update(2000);
+    TEST_ASSERT_EQUAL(DutyCycleState::SLEEPING, controller->getState());
+
+    // Previous fix must not complete the next acquisition
+    controller->update(57000);
+    TEST_ASSERT_EQUAL(DutyCycleState::ACQUIRING, controller->getState());
+    controller->update(58000);
+    TEST_ASSERT_EQUAL(DutyCycleState::ACQUIRING, controller->getState());
+}
+
+void test_hot_start_learns_wake_lead() {
+    controller->begin(testConfig(DutyCycleMode::HOT_START), 0);
+    TEST_ASSERT_EQUAL_UINT32(5000, controller->getCurrentWakeLead());
+
+    feedFix("4807.038", "01131.000", 1.0f, 10.0f, 90.0f);
+    controller->update(2000);
+    TEST_ASSERT_EQUAL_UINT32(2000, controller->getCurrentWakeLead());
+    TEST_ASSERT_EQUAL_UINT32(22000, controller->getNextFixTime());
+
+    controller->update(19999);
+    TEST_ASSERT_FALSE(gps->isPowered());
+    controller->update(20000);
+    TEST_ASSERT_TRUE(gps->isPowered());
+
+    // Slow fix raises the learned lead (EMA: (2000*3 + 6000) / 4)
+    feedFix("4807.538", "01131.000", 1.0f, 10.0f, 90.0f);
+    controller->update(26000);
+    TEST_ASSERT_EQUAL_UINT32(3000, controller->getCurrentWakeLead());
+}
+
+void test_stationary_node_backs_off() {
+    controller->begin(testConfig(DutyCycleMode::PERIODIC_FIX), 0);
+    uint32_t now = 0;
+
+    // Three fixes at the same spot, not moving
+    for (int i = 0; i < 3; i++) {
+        if (i > 0) {
+            now = controller->getNextFixTime() - 5000;
+            controller->update(now);
+        }
+        TEST_ASSERT_EQUAL(DutyCycleState::ACQUIRING, controller->getState());
+        feedFix("4807.038", "01131.000", 1.0f, 0.2f, 0.0f);
+        now += 1000;
+        controller->update(now);
+    }
+
+    TEST_ASSERT_TRUE(controller->isStationary());
+    TEST_ASSERT_EQUAL_UINT32(now + 600000, controller->getNextFixTime());
+
+    // Moving again returns to the normal interval
+    controller->requestFix(now + 1000);
+    TEST_ASSERT_EQUAL(DutyCycleState::ACQUIRING, controller->getState());
+    feedFix("4807.538", "01131.000", 1.0f, 15.0f, 45.0f);
+    controller->update(now + 2000);
+    TEST_ASSERT_FALSE(controller->isStationary());
+    TEST_ASSERT_EQUAL_UINT32(now + 2000 + 60000, controller->getNextFixTime());
+}
+
+void test_course_change_counts_as_motion() {
+    DutyCycleConfig config = testConfig(DutyCycleMode::PERIODIC_FIX);
+    config.stationary_fix_count = 1;
+    controller->begin(config, 0);
+
+    // Walking pace below moving_speed_kmh, same spot
+    feedFix("4807.038", "01131.000", 1.0f, 1.0f, 10.0f);
+    controller->update(1000);
+    controller->requestFix(2000);
+    feedFix("4807.038", "01131.000", 1.0f, 1.0f, 350.0f);
+    controller->update(3000);
+    TEST_ASSERT_TRUE(controller->isStationary());   // 20 deg wraps, below threshold
+
+    controller->requestFix(4000);
+    feedFix("4807.038", "01131.000", 1.0f, 1.0f, 80.0f);
+    controller->update(5000);
+    TEST_ASSERT_FALSE(controller->isStationary());
+}
+
+void test_zero_stationary_interval_waits_for_request() {
+    DutyCycleConfig config = testConfig(DutyCycleMode::PERIODIC_FIX);
+    config.stationary_fix_count = 1;
+    config.stationary_interval_ms = 0;
+    controller->begin(config, 0);
+
+    feedFix("4807.038", "01131.000", 1.0f, 0.0f, 0.0f);
+    controller->update(1000);
+    controller->requestFix(2000);
+    feedFix("4807.038", "01131.000", 1.0f, 0.0f, 0.0f);
+    controller->update(3000);
+
+    TEST_ASSERT_EQUAL_UINT32(DutyCycleController::NO_FIX_SCHEDULED, controller->getNextFixTime());
+    controller->update(10000000);
+    TEST_ASSERT_EQUAL(DutyCycleState::SLEEPING, controller->getState());
+    TEST_ASSERT_FALSE(gps->isPowered());
+}
+
+void test_energy_accounting() {
+    DutyCycleConfig config = testConfig(DutyCycleMode::PERIODIC_FIX);
+    config.active_current_ma = 36.0f;
+    config.off_current_ma = 0.0f;
+    controller->begin(config, 0);
+
+    feedFix("4807.038", "01131.000", 1.0f, 10.0f, 90.0f);
+    controller->update(100000);      // 100 s on
+    controller->update(400000);      // 300 s off (wakes at the end of this step)
+
+    const DutyCycleStats& stats = controller->getStats();
+    TEST_ASSERT_EQUAL_UINT32(100000, stats.on_time_ms);
+    TEST_ASSERT_EQUAL_UINT32(300000, stats.off_time_ms);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.25f, stats.duty_cycle);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 1.0f, stats.consumed_mah);   // 36 mA * 100 s
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.0f, stats.saved_mah);      // 36 mA * 300 s
+}
+
+void test_mode_switch_to_always_on() {
+    controller->begin(testConfig(DutyCycleMode::PERIODIC_FIX), 0);
+    feedFix("4807.038", "01131.000", 1.0f, 10.0f, 90.0f);
+    controller->update(1000);
+    TEST_ASSERT_FALSE(gps->isPowered());
+
+    controller->setMode(DutyCycleMode::ALWAYS_ON, 2000);
+    TEST_ASSERT_EQUAL(DutyCycleState::CONTINUOUS, controller->getState());
+    TEST_ASSERT_TRUE(gps->isPowered());
+    TEST_ASSERT_EQUAL_UINT32(0, controller->getCurrentWakeLead());
+
+    controller->setMode(DutyCycleMode::PERIODIC_FIX, 3000);
+    TEST_ASSERT_EQUAL(DutyCycleState::ACQUIRING, controller->getState());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_begin_requires_initialized_gps);
+    RUN_TEST(test_always_on_keeps_receiver_powered);
+    RUN_TEST(test_periodic_fix_powers_down_after_good_fix);
+    RUN_TEST(test_acquisition_timeout_powers_down);
+    RUN_TEST(test_stale_fix_not_accepted_after_wake);
+    RUN_TEST(test_hot_start_learns_wake_lead);
+    RUN_TEST(test_stationary_node_backs_off);
+    RUN_TEST(test_course_change_counts_as_motion);
+    RUN_TEST(test_zero_stationary_interval_waits_for_request);
+    RUN_TEST(test_energy_accounting);
+    RUN_TEST(test_mode_switch_to_always_on);
+
+    return UNITY_END();
+}
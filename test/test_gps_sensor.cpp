@@ -0,0 +1,212 @@
+// Unit tests for the UC6580 NMEA parser and satellite table
+#include <unity.h>
+#include "../src/sensors/gps_sensor.h"
+#include <cstdio>
+#include <cstring>
+
+using namespace GPS;
+
+static UC6580* gps = nullptr;
+
+void setUp(void) {
+    HardwareAbstraction::initialize();
+    gps = new UC6580();
+}
+
+void tearDown(void) {
+    delete gps;
+    gps = nullptr;
+    HardwareAbstraction::deinitialize();
+}
+
+// Wrap an NMEA body ("GPGSV,...") with '$' and a valid checksum, then feed it
+static HardwareAbstraction::Result feed(const char* body) {
+    uint8_t checksum = 0;
+    for (const char* p = body; *p; p++) {
+        checksum ^= static_cast<uint8_t>(*p);
+    }
+
+    char sentence[128];
+    snprintf(sentence, sizeof(sentence), "$%s*%02X", body, checksum);
+    return gps->processNMEA(sentence);
+}
+
+static const SatelliteInfo* findSat(Constellation constellation, uint8_t prn) {
+    const SatelliteTable& table = gps->getSatelliteTable();
+    for (uint8_t i = 0; i < table.count; i++) {
+        if (table.satellites[i].constellation == constellation && table.satellites[i].prn == prn) {
+            return &table.satellites[i];
+        }
+    }
+    return nullptr;
+}
+
+void test_rejects_bad_checksum() {
+    TEST_ASSERT_EQUAL(HardwareAbstraction::Result::ERROR_COMMUNICATION_FAILED,
+                      gps->processNMEA("$GPGSV,1,1,01,05,40,083,46*00"));
+    TEST_ASSERT_EQUAL_UINT32(1, gps->getParseErrors());
+}
+
+void test_gga_with_empty_fields() {
+    // Empty fields must keep their positions (no fix, no position)
+    TEST_ASSERT_EQUAL(HardwareAbstraction::Result::SUCCESS,
+                      feed("GPGGA,123519,,,,,0,00,,,M,,M,,"));
+    TEST_ASSERT_FALSE(gps->hasValidFix());
+
+    TEST_ASSERT_EQUAL(HardwareAbstraction::Result::SUCCESS,
+                      feed("GPGGA,123520,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,"));
+    TEST_ASSERT_TRUE(gps->hasValidFix());
+    TEST_ASSERT_EQUAL_UINT8(8, gps->getData().satellites);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 48.1173, gps->getData().latitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 11.5167, gps->getData().longitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 545.4f, gps->getData().altitude);
+}
+
+void test_gsv_multipart_builds_table() {
+    TEST_ASSERT_EQUAL(HardwareAbstraction::Result::SUCCESS,
+                      feed("GPGSV,2,1,06,02,45,120,38,05,60,200,44,12,15,310,,13,05,045,22"));
+    // Table is updated incrementally, before the sequence completes
+    TEST_ASSERT_EQUAL_UINT8(4, gps->getSatelliteTable().count);
+
+    TEST_ASSERT_EQUAL(HardwareAbstraction::Result::SUCCESS,
+                      feed("GPGSV,2,2,06,25,30,090,35,46,40,180,30"));
+    TEST_ASSERT_EQUAL_UINT8(6, gps->getSatelliteTable().count);
+
+    const SatelliteInfo* sat = findSat(Constellation::GPS, 5);
+    TEST_ASSERT_NOT_NULL(sat);
+    TEST_ASSERT_EQUAL_INT8(60, sat->elevation_deg);
+    TEST_ASSERT_EQUAL_UINT16(200, sat->azimuth_deg);
+    TEST_ASSERT_EQUAL_UINT8(44, sat->cn0_dbhz);
+
+    // Satellite 12 is in view but not tracked
+    sat = findSat(Constellation::GPS, 12);
+    TEST_ASSERT_NOT_NULL(sat);
+    TEST_ASSERT_EQUAL_UINT8(0, sat->cn0_dbhz);
+
+    // PRN 46 under the GP talker is an SBAS satellite
+    TEST_ASSERT_NOT_NULL(findSat(Constellation::SBAS, 46));
+}
+
+void test_gsv_prunes_satellites_that_left_view() {
+    feed("GPGSV,1,1,03,02,45,120,38,05,60,200,44,13,05,045,22");
+    feed("GLGSV,1,1,02,65,50,100,40,66,20,250,31");
+    TEST_ASSERT_EQUAL_UINT8(5, gps->getSatelliteTable().count);
+
+    // Next GPS cycle no longer contains PRN 13; GLONASS must be untouched
+    feed("GPGSV,1,1,02,02,46,121,39,05,61,201,43");
+    TEST_ASSERT_EQUAL_UINT8(4, gps->getSatelliteTable().count);
+    TEST_ASSERT_NULL(findSat(Constellation::GPS, 13));
+    TEST_ASSERT_NOT_NULL(findSat(Constellation::GLONASS, 66));
+    TEST_ASSERT_EQUAL_UINT8(39, findSat(Constellation::GPS, 2)->cn0_dbhz);
+}
+
+void test_gsa_marks_used_satellites_per_constellation() {
+    feed("GPGSV,1,1,03,02,45,120,38,05,60,200,44,13,05,045,22");
+    feed("GLGSV,1,1,02,65,50,100,40,66,20,250,31");
+
+    // NMEA 4.1 combined GSA with system IDs
+    TEST_ASSERT_EQUAL(HardwareAbstraction::Result::SUCCESS,
+                      feed("GNGSA,A,3,02,05,,,,,,,,,,,1.8,1.0,1.5,1"));
+    TEST_ASSERT_EQUAL(HardwareAbstraction::Result::SUCCESS,
+                      feed("GNGSA,A,3,65,,,,,,,,,,,,1.8,1.0,1.5,2"));
+
+    TEST_ASSERT_TRUE(findSat(Constellation::GPS, 2)->used_in_fix);
+    TEST_ASSERT_TRUE(findSat(Constellation::GPS, 5)->used_in_fix);
+    TEST_ASSERT_FALSE(findSat(Constellation::GPS, 13)->used_in_fix);
+    TEST_ASSERT_TRUE(findSat(Constellation::GLONASS, 65)->used_in_fix);
+    TEST_ASSERT_FALSE(findSat(Constellation::GLONASS, 66)->used_in_fix);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, gps->getData().hdop);
+
+    // A new GPS GSA replaces the GPS set only
+    feed("GNGSA,A,3,13,,,,,,,,,,,,2.0,1.2,1.6,1");
+    TEST_ASSERT_FALSE(findSat(Constellation::GPS, 2)->used_in_fix);
+    TEST_ASSERT_TRUE(findSat(Constellation::GPS, 13)->used_in_fix);
+    TEST_ASSERT_TRUE(findSat(Constellation::GLONASS, 65)->used_in_fix);
+
+    // Pre-4.1 $GNGSA without a system ID replaces only the constellations
+    // its PRNs fall in
+    TEST_ASSERT_EQUAL(HardwareAbstraction::Result::SUCCESS,
+                      feed("GNGSA,A,3,66,,,,,,,,,,,,2.0,1.2,1.6"));
+    TEST_ASSERT_FALSE(findSat(Constellation::GLONASS, 65)->used_in_fix);
+    TEST_ASSERT_TRUE(findSat(Constellation::GLONASS, 66)->used_in_fix);
+    TEST_ASSERT_TRUE(findSat(Constellation::GPS, 13)->used_in_fix);
+}
+
+void test_fix_quality_metrics() {
+    feed("GPGSV,1,1,03,02,45,120,38,05,60,200,44,13,05,045,");
+    feed("GAGSV,1,1,01,11,30,300,41");
+    feed("GNGSA,A,3,02,05,,,,,,,,,,,1.8,1.0,1.5,1");
+    feed("GNGSA,A,3,11,,,,,,,,,,,,1.8,1.0,1.5,3");
+
+    const FixQuality quality = gps->getFixQuality();
+    TEST_ASSERT_EQUAL_UINT8(4, quality.satellites_in_view);
+    TEST_ASSERT_EQUAL_UINT8(3, quality.satellites_tracked);
+    TEST_ASSERT_EQUAL_UINT8(3, quality.satellites_used);
+    TEST_ASSERT_EQUAL_UINT8(2, quality.used_by_constellation[static_cast<uint8_t>(Constellation::GPS)]);
+    TEST_ASSERT_EQUAL_UINT8(1, quality.used_by_constellation[static_cast<uint8_t>(Constellation::GALILEO)]);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, (38.0f + 44.0f + 41.0f) / 3.0f, quality.mean_cn0_used);
+    TEST_ASSERT_EQUAL_UINT8(44, quality.max_cn0);
+}
+
+void test_time_to_first_fix() {
+    TEST_ASSERT_EQUAL_UINT32(0, gps->getTimeToFirstFix());
+
+    feed("GPGGA,123519,,,,,0,00,,,M,,M,,");
+    TEST_ASSERT_EQUAL_UINT32(0, gps->getTimeToFirstFix());
+
+    feed("GPGGA,123520,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
+    const uint32_t ttff = gps->getTimeToFirstFix();
+    TEST_ASSERT_GREATER_THAN(0, ttff);
+
+    // Later fixes do not move the first-fix time
+    feed("GPGGA,123521,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,");
+    TEST_ASSERT_EQUAL_UINT32(ttff, gps->getTimeToFirstFix());
+}
+
+void test_satellite_table_capacity() {
+    // 40 GLONASS-range satellites overflow the 32-entry table
+    char body[96];
+    for (int msg = 0; msg < 10; msg++) {
+        const int base = 65 + msg * 4;
+        snprintf(body, sizeof(body), "GLGSV,10,%d,40,%d,10,010,20,%d,10,020,20,%d,10,030,20,%d,10,040,20",
+                 msg + 1, base, base + 1, base + 2, base + 3);
+        TEST_ASSERT_EQUAL(HardwareAbstraction::Result::SUCCESS, feed(body));
+    }
+
+    TEST_ASSERT_EQUAL_UINT8(SatelliteTable::MAX_SATELLITES, gps->getSatelliteTable().count);
+    TEST_ASSERT_EQUAL_UINT32(40 - SatelliteTable::MAX_SATELLITES, gps->getSatelliteTable().dropped);
+
+    // A stronger satellite replaces a weak unused one: stored, not dropped
+    TEST_ASSERT_EQUAL(HardwareAbstraction::Result::SUCCESS, feed("GLGSV,1,1,01,105,10,050,40"));
+    TEST_ASSERT_EQUAL_UINT32(40 - SatelliteTable::MAX_SATELLITES, gps->getSatelliteTable().dropped);
+    bool stored = false;
+    for (uint8_t i = 0; i < gps->getSatelliteTable().count; i++) {
+        stored = stored || gps->getSatelliteTable().satellites[i].prn == 105;
+    }
+    TEST_ASSERT_TRUE(stored);
+}
+
+void test_constellation_helpers() {
+    TEST_ASSERT_EQUAL(Constellation::GPS, constellationFromTalker("GP"));
+    TEST_ASSERT_EQUAL(Constellation::BEIDOU, constellationFromTalker("BD"));
+    TEST_ASSERT_EQUAL(Constellation::UNKNOWN, constellationFromTalker("GN"));
+    TEST_ASSERT_EQUAL(Constellation::SBAS, constellationFromPRN(40));
+    TEST_ASSERT_EQUAL(Constellation::GLONASS, constellationFromPRN(70));
+    TEST_ASSERT_EQUAL_STRING("Galileo", constellationToString(Constellation::GALILEO));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_rejects_bad_checksum);
+    RUN_TEST(test_gga_with_empty_fields);
+    RUN_TEST(test_gsv_multipart_builds_table);
+    RUN_TEST(test_gsv_prunes_satellites_that_left_view);
+    RUN_TEST(test_gsa_marks_used_satellites_per_constellation);
+    RUN_TEST(test_fix_quality_metrics);
+    RUN_TEST(test_time_to_first_fix);
+    RUN_TEST(test_satellite_table_capacity);
+    RUN_TEST(test_constellation_helpers);
+
+    return UNITY_END();
+}
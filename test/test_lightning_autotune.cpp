@@ -0,0 +1,290 @@
+// Closed-loop tests for the AS3935 noise/disturber auto-tuner against site traces
+#include <unity.h>
+#include "../src/sensors/lightning_sensor.h"
+#include "../src/sensors/lightning_autotune.h"
+#include "as3935_mock.h"
+#include <cmath>
+
+using namespace Sensors;
+using namespace HardwareAbstraction;
+
+static constexpr uint32_t STEP_MS = 250;
+static constexpr uint32_t MINUTE_MS = 60000;
+
+void setUp(void) {
+    HardwareAbstraction::initialize();
+    Simulation::reset();
+}
+
+void tearDown(void) {
+    Simulation::reset();
+    HardwareAbstraction::deinitialize();
+}
+
+// Deterministic Bernoulli draws (xorshift32)
+static uint32_t s_seed = 1;
+static void seed(uint32_t n) {
+    s_seed = (n + 1) * 0x9E3779B9u;     // Spread small seeds over all bits
+}
+static bool draw(float p) {
+    s_seed ^= s_seed << 13;
+    s_seed ^= s_seed >> 17;
+    s_seed ^= s_seed << 5;
+    return ((s_seed >> 8) / 16777216.0f) < p;
+}
+
+// Site model: NOISE interrupts grow 20/min per NF_LEV step the ambient level sits above the floor;
+// disturbers halve with every WDTH or SREJ step above 2.
+struct Site {
+    const float* ambient;           // Ambient noise level (NF_LEV units), one entry per 5 minutes
+    size_t segments;
+    float disturbers_per_min;       // At WDTH = SREJ = 2
+
+    float ambientAt(uint32_t t) const {
+        const size_t i = t / (5 * MINUTE_MS);
+        return ambient[i < segments ? i : segments - 1];
+    }
+    float noiseRate(uint32_t t, const NoiseSettings& s) const {
+        const float excess = ambientAt(t) - s.noiseFloor;
+        return excess > 0.0f ? 20.0f * excess : 0.0f;
+    }
+    float disturberRate(const NoiseSettings& s) const {
+        return disturbers_per_min * powf(0.5f, (s.watchdogThreshold - 2.0f) + (s.spikeRejection - 2.0f));
+    }
+};
+
+struct RunResult {
+    uint32_t noise_events;
+    uint32_t disturber_events;
+    uint32_t ms_noisy;              // Time spent with the noise floor below ambient
+};
+
+static RunResult run(NoiseAutoTuner& tuner, const Site& site, NoiseSettings& settings,
+                     uint32_t from_ms, uint32_t to_ms, uint32_t& noise_total, uint32_t& disturber_total) {
+    RunResult result = {};
+    for (uint32_t t = from_ms; t < to_ms; t += STEP_MS) {
+        if (draw(site.noiseRate(t, settings) * STEP_MS / MINUTE_MS)) {
+            noise_total++;
+            result.noise_events++;
+        }
+        if (draw(site.disturberRate(settings) * STEP_MS / MINUTE_MS)) {
+            disturber_total++;
+            result.disturber_events++;
+        }
+        if (site.ambientAt(t) > settings.noiseFloor) {
+            result.ms_noisy += STEP_MS;
+        }
+        tuner.update(noise_total, disturber_total, settings, t);
+    }
+    return result;
+}
+
+void test_noisy_site_converges_within_minutes() {
+    const float ambient[] = {4.5f};
+    const Site site = {ambient, 1, 0.0f};
+    NoiseSettings settings = {2, 2, 2};
+    uint32_t noise = 0, disturbers = 0;
+    seed(1);
+
+    NoiseAutoTuner tuner;
+    tuner.begin(getDefaultNoiseAutoTuneConfig(), 0);
+    run(tuner, site, settings, 0, 4 * MINUTE_MS, noise, disturbers);
+
+    TEST_ASSERT_EQUAL_UINT8(5, settings.noiseFloor);
+    TEST_ASSERT_EQUAL_UINT32(3, tuner.getTotalAdjustments());
+    for (size_t i = 0; i < tuner.getAdjustmentCount(); i++) {
+        const NoiseAdjustment& a = tuner.getAdjustment(i);
+        TEST_ASSERT_EQUAL(NoiseParameter::NOISE_FLOOR, a.parameter);
+        TEST_ASSERT_EQUAL_UINT8(2 + i, a.from);
+        TEST_ASSERT_EQUAL_UINT8(3 + i, a.to);
+        TEST_ASSERT_GREATER_THAN(4.0f, a.rate_per_min);
+    }
+}
+
+void test_marginal_site_does_not_oscillate() {
+    // Ambient just below NF 5: every relax to 4 is undone, relax time backs off
+    const float ambient[] = {4.5f};
+    const Site site = {ambient, 1, 0.0f};
+    NoiseSettings settings = {5, 2, 2};
+    uint32_t noise = 0, disturbers = 0;
+    seed(2);
+
+    NoiseAutoTuneConfig config = getDefaultNoiseAutoTuneConfig();
+    config.min.watchdogThreshold = 2;
+    config.min.spikeRejection = 2;
+
+    NoiseAutoTuner tuner;
+    tuner.begin(config, 0);
+    const RunResult result = run(tuner, site, settings, 0, 100 * MINUTE_MS, noise, disturbers);
+
+    // Relax attempts after 5, 10, 20 and 40 minutes, each undone
+    TEST_ASSERT_LESS_OR_EQUAL(8, tuner.getTotalAdjustments());
+    uint32_t previous_gap = 0;
+    for (size_t i = 2; i + 1 < tuner.getAdjustmentCount(); i += 2) {
+        const uint32_t gap = tuner.getAdjustment(i).time_ms - tuner.getAdjustment(i - 1).time_ms;
+        TEST_ASSERT_TRUE(gap >= previous_gap);
+        previous_gap = gap;
+    }
+    TEST_ASSERT_GREATER_OR_EQUAL(40 * MINUTE_MS, previous_gap);
+    TEST_ASSERT_LESS_OR_EQUAL(4 * 90000, result.ms_noisy);              // Each undone within 90 s
+    TEST_ASSERT_EQUAL_UINT8(5, settings.noiseFloor);
+}
+
+void test_quiet_site_regains_sensitivity() {
+    const float ambient[] = {0.5f};
+    const Site site = {ambient, 1, 0.0f};
+    NoiseSettings settings = {4, 2, 2};
+    uint32_t noise = 0, disturbers = 0;
+    seed(3);
+
+    NoiseAutoTuner tuner;
+    tuner.begin(getDefaultNoiseAutoTuneConfig(), 0);
+    run(tuner, site, settings, 0, 16 * MINUTE_MS, noise, disturbers);
+    TEST_ASSERT_EQUAL_UINT8(1, settings.noiseFloor);
+}
+
+void test_hysteresis_band_holds_settings() {
+    // 1 NOISE/min and 3 disturbers/min: inside both raise/relax bands
+    const float ambient[] = {2.05f};
+    const Site site = {ambient, 1, 3.0f};
+    NoiseSettings settings = {2, 2, 2};
+    uint32_t noise = 0, disturbers = 0;
+    seed(4);
+
+    NoiseAutoTuner tuner;
+    tuner.begin(getDefaultNoiseAutoTuneConfig(), 0);
+    run(tuner, site, settings, 0, 60 * MINUTE_MS, noise, disturbers);
+
+    TEST_ASSERT_EQUAL_UINT32(0, tuner.getTotalAdjustments());
+    TEST_ASSERT_EQUAL_UINT8(2, settings.noiseFloor);
+    TEST_ASSERT_EQUAL_UINT8(2, settings.watchdogThreshold);
+}
+
+void test_disturbers_raise_watchdog_before_spike_rejection() {
+    const float ambient[] = {0.0f};
+    const Site site = {ambient, 1, 40.0f};
+    NoiseSettings settings = {2, 2, 2};
+    uint32_t noise = 0, disturbers = 0;
+    seed(5);
+
+    NoiseAutoTuneConfig config = getDefaultNoiseAutoTuneConfig();
+    config.min.noiseFloor = 2;
+    config.max.watchdogThreshold = 3;
+
+    NoiseAutoTuner tuner;
+    tuner.begin(config, 0);
+    run(tuner, site, settings, 0, 8 * MINUTE_MS, noise, disturbers);
+
+    // 40 -> 20 (WDTH 3) -> 10 (SREJ 3) -> 5/min (SREJ 4), below the 8/min raise rate
+    TEST_ASSERT_EQUAL_UINT8(3, settings.watchdogThreshold);
+    TEST_ASSERT_GREATER_OR_EQUAL(4, settings.spikeRejection);
+    TEST_ASSERT_LESS_THAN(8.0f, site.disturberRate(settings));
+    TEST_ASSERT_EQUAL(NoiseParameter::WATCHDOG_THRESHOLD, tuner.getAdjustment(0).parameter);
+    TEST_ASSERT_EQUAL(NoiseParameter::SPIKE_REJECTION, tuner.getAdjustment(1).parameter);
+}
+
+void test_evening_trace_tracks_noise_source() {
+    // 5-minute ambient levels: quiet, an inverter switching on for 30 minutes, quiet again
+    const float ambient[] = {1.0f, 1.0f, 1.2f, 3.8f, 4.2f, 4.1f, 3.9f, 4.3f, 4.0f,
+                             1.5f, 1.0f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f,
+                             0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f};
+    const Site site = {ambient, sizeof(ambient) / sizeof(ambient[0]), 0.0f};
+    NoiseSettings settings = {2, 2, 2};
+    uint32_t noise = 0, disturbers = 0;
+    seed(6);
+
+    NoiseAutoTuner tuner;
+    tuner.begin(getDefaultNoiseAutoTuneConfig(), 0);
+
+    run(tuner, site, settings, 0, 15 * MINUTE_MS, noise, disturbers);
+    TEST_ASSERT_LESS_OR_EQUAL(2, settings.noiseFloor);
+
+    const RunResult burst = run(tuner, site, settings, 15 * MINUTE_MS, 45 * MINUTE_MS, noise, disturbers);
+    TEST_ASSERT_GREATER_OR_EQUAL(4, settings.noiseFloor);
+    TEST_ASSERT_LESS_THAN(120, burst.noise_events);       // ~1200 with the floor left at 2
+
+    run(tuner, site, settings, 45 * MINUTE_MS, 135 * MINUTE_MS, noise, disturbers);
+    TEST_ASSERT_LESS_OR_EQUAL(1, settings.noiseFloor);
+}
+
+void test_adjustment_log_wraps() {
+    NoiseAutoTuneConfig config = getDefaultNoiseAutoTuneConfig();
+    config.relax_ms = config.bucket_ms;
+    config.max.noiseFloor = 7;
+    NoiseAutoTuner tuner;
+    tuner.begin(config, 0);
+
+    // Alternate floods and silence to force many steps
+    NoiseSettings settings = {0, 2, 2};
+    uint32_t noise = 0;
+    uint32_t t = 0;
+    tuner.update(noise, 0, settings, t);
+    for (int i = 0; i < 40; i++) {
+        t += config.bucket_ms;
+        noise += (i % 6 < 3) ? 10 : 0;
+        tuner.update(noise, 0, settings, t);
+    }
+
+    TEST_ASSERT_GREATER_THAN(NoiseAutoTuner::LOG_SIZE, tuner.getTotalAdjustments());
+    TEST_ASSERT_EQUAL(NoiseAutoTuner::LOG_SIZE, tuner.getAdjustmentCount());
+    for (size_t i = 1; i < tuner.getAdjustmentCount(); i++) {
+        TEST_ASSERT_TRUE(tuner.getAdjustment(i).time_ms >= tuner.getAdjustment(i - 1).time_ms);
+    }
+    const NoiseAdjustment& last = tuner.getAdjustment(tuner.getAdjustmentCount() - 1);
+    TEST_ASSERT_EQUAL_UINT8(settings.noiseFloor, last.to);
+}
+
+// Driver integration: NOISE interrupts from the AS3935 model raise NF_LEV on the chip
+void test_sensor_applies_adjustments_to_chip() {
+    Simulation::setMicros(1000000);
+    AS3935Mock chip;
+    AS3935BusConfig bus = getDefaultAS3935BusConfig();
+    bus.interface = AS3935Interface::I2C;
+    bus.irqPin = 4;
+    chip.attachI2C(bus.i2cAddress, bus.irqPin);
+
+    LightningSensor sensor(bus);
+    TEST_ASSERT_TRUE(sensor.initialize());
+    TEST_ASSERT_TRUE(sensor.isAutoTuneEnabled());
+    TEST_ASSERT_EQUAL_HEX8(0x20, chip.reg(0x01) & AS3935Bits::NF_LEV_MASK);
+
+    // 6 NOISE interrupts per minute for two minutes
+    for (int s = 0; s < 120; s++) {
+        if (s % 10 == 0) {
+            chip.scriptNoise();
+        }
+        Simulation::advanceMicros(1000000);
+        sensor.update();
+    }
+
+    TEST_ASSERT_GREATER_THAN(2, sensor.getNoiseFloor());
+    TEST_ASSERT_EQUAL_HEX8(sensor.getNoiseFloor() << 4, chip.reg(0x01) & AS3935Bits::NF_LEV_MASK);
+    TEST_ASSERT_GREATER_THAN(0, sensor.getAutoTuner().getTotalAdjustments());
+
+    // Disabled: settings stay put
+    const uint8_t floor = sensor.getNoiseFloor();
+    sensor.setAutoTuneEnabled(false);
+    for (int s = 0; s < 120; s++) {
+        if (s % 5 == 0) {
+            chip.scriptNoise();
+        }
+        Simulation::advanceMicros(1000000);
+        sensor.update();
+    }
+    TEST_ASSERT_EQUAL_UINT8(floor, sensor.getNoiseFloor());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_noisy_site_converges_within_minutes);
+    RUN_TEST(test_marginal_site_does_not_oscillate);
+    RUN_TEST(test_quiet_site_regains_sensitivity);
+    RUN_TEST(test_hysteresis_band_holds_settings);
+    RUN_TEST(test_disturbers_raise_watchdog_before_spike_rejection);
+    RUN_TEST(test_evening_trace_tracks_noise_source);
+    RUN_TEST(test_adjustment_log_wraps);
+    RUN_TEST(test_sensor_applies_adjustments_to_chip);
+
+    return UNITY_END();
+}
@@ -0,0 +1,463 @@
+// Unit tests for the AS3935 driver against a register-level bus model
+#include <unity.h>
+#include "../src/sensors/lightning_sensor.h"
+#include "../src/system/event_log.h"
+#include "as3935_mock.h"
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
+
+using namespace Sensors;
+using namespace HardwareAbstraction;
+
+static constexpr uint8_t IRQ_PIN = 4;
+static constexpr uint8_t I2C_ADDRESS = 0x03;
+
+static AS3935Mock* s_chip = nullptr;
+static uint32_t s_callbacks = 0;
+static int32_t s_last_distance = -1;
+
+void setUp(void) {
+    HardwareAbstraction::initialize();
+    Simulation::reset();
+    Simulation::setMicros(1000000);
+    s_chip = new AS3935Mock();
+    s_callbacks = 0;
+    s_last_distance = -1;
+}
+
+void tearDown(void) {
+    delete s_chip;
+    s_chip = nullptr;
+    Simulation::reset();
+    HardwareAbstraction::deinitialize();
+}
+
+static AS3935BusConfig i2cBus() {
+    AS3935BusConfig bus = getDefaultAS3935BusConfig();
+    bus.interface = AS3935Interface::I2C;
+    bus.i2cAddress = I2C_ADDRESS;
+    bus.irqPin = IRQ_PIN;
+    return bus;
+}
+
+static AS3935BusConfig spiBus() {
+    AS3935BusConfig bus = getDefaultAS3935BusConfig();
+    bus.interface = AS3935Interface::SPI;
+    bus.irqPin = IRQ_PIN;
+    return bus;
+}
+
+static void onReading(const Reading& reading) {
+    s_callbacks++;
+    s_last_distance = reading.value.intValue;
+}
+
+void test_initialize_over_i2c() {
+    s_chip->attachI2C(I2C_ADDRESS, IRQ_PIN);
+    LightningSensor sensor(i2cBus());
+
+    TEST_ASSERT_TRUE(sensor.initialize());
+    TEST_ASSERT_EQUAL(State::READY, sensor.getState());
+    TEST_ASSERT_EQUAL_UINT32(1, s_chip->presetCount());
+    TEST_ASSERT_EQUAL_UINT32(1, s_chip->rcoCalibrationCount());
+
+    // Outdoor gain, NF_LEV/WDTH and MIN_NUM_LIGH = 5 applied
+    TEST_ASSERT_EQUAL_HEX8(AS3935Bits::AFE_GB_OUTDOOR, s_chip->reg(0x00) & AS3935Bits::AFE_GB_MASK);
+    TEST_ASSERT_EQUAL_HEX8(0x22, s_chip->reg(0x01));
+    TEST_ASSERT_EQUAL_HEX8(0x10, s_chip->reg(0x02) & AS3935Bits::MIN_NUM_LIGH_MASK);
+    TEST_ASSERT_EQUAL_HEX8(0x00, s_chip->reg(0x08) & AS3935Bits::DISP_SRCO);
+}
+
+void test_initialize_over_spi() {
+    s_chip->attachSPI(IRQ_PIN);
+    LightningSensor sensor(spiBus());
+
+    TEST_ASSERT_TRUE(sensor.initialize());
+    TEST_ASSERT_EQUAL_UINT32(1, s_chip->presetCount());
+    TEST_ASSERT_EQUAL_HEX8(0x10, s_chip->reg(0x02) & AS3935Bits::MIN_NUM_LIGH_MASK);
+}
+
+void test_missing_chip_reports_not_found() {
+    s_chip->setPresent(false);
+    s_chip->attachSPI(IRQ_PIN);
+    LightningSensor sensor(spiBus());
+
+    TEST_ASSERT_FALSE(sensor.initialize());
+    TEST_ASSERT_EQUAL(State::ERROR, sensor.getState());
+    TEST_ASSERT_EQUAL_UINT32(LightningErrorCodes::CHIP_NOT_FOUND, sensor.getLastError());
+}
+
+void test_lightning_event_read_in_one_burst() {
+    s_chip->attachI2C(I2C_ADDRESS, IRQ_PIN);
+    LightningSensor sensor(i2cBus());
+    sensor.setReadingCallback(onReading);
+    TEST_ASSERT_TRUE(sensor.initialize());
+    s_chip->clearCounters();
+
+    s_chip->scriptLightning(14, 0x12ABCD);
+
+    // INT is not valid until 2 ms after the IRQ edge
+    Simulation::advanceMicros(1500);
+    sensor.update();
+    TEST_ASSERT_EQUAL_UINT32(0, s_chip->readTransactions());
+    TEST_ASSERT_FALSE(sensor.hasNewData());
+
+    Simulation::advanceMicros(600);
+    sensor.update();
+    TEST_ASSERT_EQUAL_UINT32(1, s_chip->readTransactions());
+    TEST_ASSERT_EQUAL_UINT32(0, s_chip->writeTransactions());
+
+    LightningData data;
+    TEST_ASSERT_TRUE(sensor.getLastLightningData(data));
+    TEST_ASSERT_EQUAL_UINT8(14, data.distance);
+    TEST_ASSERT_EQUAL_UINT32(0x12ABCD, data.energy);
+    TEST_ASSERT_FALSE(data.isDisturber);
+    TEST_ASSERT_EQUAL_UINT8(1, data.strikeCount);
+    TEST_ASSERT_EQUAL_UINT32(1, sensor.getTotalLightningCount());
+    TEST_ASSERT_EQUAL_UINT32(1, s_callbacks);
+    TEST_ASSERT_EQUAL_INT32(14, s_last_distance);
+
+    // INT cleared by the read
+    TEST_ASSERT_EQUAL_HEX8(0x00, s_chip->reg(0x03) & AS3935Bits::INT_MASK);
+
+    Reading reading;
+    TEST_ASSERT_TRUE(sensor.readSensor(reading));
+    TEST_ASSERT_EQUAL_INT32(14, reading.value.intValue);
+    TEST_ASSERT_FALSE(sensor.readSensor(reading));
+}
+
+void test_spi_burst_and_timing_stats() {
+    s_chip->attachSPI(IRQ_PIN);
+    LightningSensor sensor(spiBus());
+    TEST_ASSERT_TRUE(sensor.initialize());
+    s_chip->clearCounters();
+    s_chip->setBusMicrosPerByte(4);    // 2 MHz SPI plus overhead
+
+    s_chip->scriptLightning(6, 1000);
+    Simulation::advanceMicros(2500);
+    sensor.update();
+
+    TEST_ASSERT_EQUAL_UINT32(1, s_chip->readTransactions());
+
+    // Command byte + 5 data bytes
+    const TimingStats& bus = sensor.getBusTimeStats();
+    TEST_ASSERT_EQUAL_UINT32(1, bus.count);
+    TEST_ASSERT_EQUAL_UINT32(24, bus.lastUs);
+
+    const TimingStats& latency = sensor.getLatencyStats();
+    TEST_ASSERT_EQUAL_UINT32(1, latency.count);
+    TEST_ASSERT_EQUAL_UINT32(2500 + 24, latency.lastUs);
+}
+
+void test_disturber_and_noise_counted() {
+    s_chip->attachI2C(I2C_ADDRESS, IRQ_PIN);
+    LightningSensor sensor(i2cBus());
+    sensor.setReadingCallback(onReading);
+    TEST_ASSERT_TRUE(sensor.initialize());
+
+    s_chip->scriptDisturber();
+    Simulation::advanceMicros(3000);
+    sensor.update();
+    s_chip->scriptNoise();
+    Simulation::advanceMicros(3000);
+    sensor.update();
+
+    TEST_ASSERT_EQUAL_UINT32(1, sensor.getTotalDisturberCount());
+    TEST_ASSERT_EQUAL_UINT32(1, sensor.getTotalNoiseEvents());
+    TEST_ASSERT_EQUAL_UINT32(0, sensor.getTotalLightningCount());
+    TEST_ASSERT_EQUAL_UINT32(0, s_callbacks);
+    TEST_ASSERT_FALSE(sensor.hasNewData());
+}
+
+void test_strike_series_counts() {
+    s_chip->attachI2C(I2C_ADDRESS, IRQ_PIN);
+    LightningSensor sensor(i2cBus());
+    TEST_ASSERT_TRUE(sensor.initialize());
+
+    for (int i = 0; i < 3; i++) {
+        s_chip->scriptLightning(20 - i, 500);
+        Simulation::advanceMicros(60000000);    // One minute apart
+        sensor.update();
+    }
+
+    LightningData data;
+    TEST_ASSERT_TRUE(sensor.getLastLightningData(data));
+    TEST_ASSERT_EQUAL_UINT8(3, data.strikeCount);
+    TEST_ASSERT_EQUAL_UINT8(18, data.distance);
+}
+
+void test_strikes_feed_storm_tracker() {
+    s_chip->attachI2C(I2C_ADDRESS, IRQ_PIN);
+    LightningSensor sensor(i2cBus());
+    StormTracker tracker;
+    sensor.setStormTracker(&tracker);
+    TEST_ASSERT_TRUE(sensor.initialize());
+
+    for (int i = 0; i < 3; i++) {
+        s_chip->scriptLightning(24 - 4 * i, 500);
+        Simulation::advanceMicros(30000000);
+        sensor.update();
+    }
+    s_chip->scriptDisturber();
+    Simulation::advanceMicros(3000);
+    sensor.update();
+
+    TEST_ASSERT_EQUAL_UINT32(3, tracker.getTotalStrikes());
+    TEST_ASSERT_TRUE(tracker.getSummary().active);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 16.0f, tracker.getSummary().closest_km);
+}
+
+void test_strikes_and_storm_logged_to_flash() {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_lightning_log_%d.bin", static_cast<int>(getpid()));
+    unlink(path);
+    Simulation::FileFlashPartition flash;
+    TEST_ASSERT_TRUE(flash.open(path, 4 * FlashPartition::SECTOR_SIZE));
+    Logging::EventLog log;
+    TEST_ASSERT_TRUE(log.begin(&flash));
+
+    s_chip->attachI2C(I2C_ADDRESS, IRQ_PIN);
+    LightningSensor sensor(i2cBus());
+    StormTracker tracker;
+    sensor.setStormTracker(&tracker);
+    sensor.setEventLog(&log);
+    TEST_ASSERT_TRUE(sensor.initialize());
+
+    for (int i = 0; i < 3; i++) {
+        s_chip->scriptLightning(24 - 4 * i, 500);
+        Simulation::advanceMicros(30000000);
+        sensor.update();
+    }
+    s_chip->scriptDisturber();
+    Simulation::advanceMicros(3000);
+    sensor.update();
+
+    uint16_t types[8] = {};
+    size_t count = 0;
+    Logging::EventLog::Reader reader = log.read();
+    while (const Logging::EventRecord* record = reader.next()) {
+        if (count < 8) {
+            types[count] = record->type;
+        }
+        if (count == 2) {
+            Logging::StrikeEventData strike;
+            memcpy(&strike, record->data, sizeof(strike));
+            TEST_ASSERT_EQUAL_UINT8(16, strike.distance_km);
+            TEST_ASSERT_EQUAL_UINT8(3, strike.strike_count);
+        }
+        count++;
+    }
+
+    // Disturbers are dropped before logging unless reported as lightning
+    TEST_ASSERT_EQUAL(4, count);
+    TEST_ASSERT_EQUAL_UINT16(static_cast<uint16_t>(Logging::EventType::STRIKE), types[0]);
+    TEST_ASSERT_EQUAL_UINT16(static_cast<uint16_t>(Logging::EventType::STRIKE), types[1]);
+    TEST_ASSERT_EQUAL_UINT16(static_cast<uint16_t>(Logging::EventType::STRIKE), types[2]);
+    TEST_ASSERT_EQUAL_UINT16(static_cast<uint16_t>(Logging::EventType::STORM_STARTED), types[3]);
+
+    sensor.setEventLog(nullptr);
+    log.end();
+    flash.close();
+    unlink(path);
+}
+
+void test_queue_overflow_counts_dropped_events() {
+    s_chip->attachI2C(I2C_ADDRESS, IRQ_PIN);
+    LightningSensor sensor(i2cBus());
+    TEST_ASSERT_TRUE(sensor.initialize());
+
+    // Ring holds 15 pending timestamps
+    for (int i = 0; i < 20; i++) {
+        s_chip->scriptLightning(10, 100);
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, sensor.getDroppedEvents());
+
+    Simulation::advanceMicros(3000);
+    sensor.update();
+    TEST_ASSERT_EQUAL_UINT32(15, sensor.getBusTimeStats().count);
+    TEST_ASSERT_EQUAL_UINT32(LightningErrorCodes::EVENT_QUEUE_OVERFLOW, sensor.getLastError());
+}
+
+void test_parameters_round_trip() {
+    s_chip->attachI2C(I2C_ADDRESS, IRQ_PIN);
+    LightningSensor sensor(i2cBus());
+    TEST_ASSERT_TRUE(sensor.initialize());
+
+    uint8_t value = 5;
+    TEST_ASSERT_TRUE(sensor.setParameter("noise_floor", &value, sizeof(value)));
+    TEST_ASSERT_EQUAL_HEX8(0x50, s_chip->reg(0x01) & AS3935Bits::NF_LEV_MASK);
+
+    value = 9;
+    TEST_ASSERT_TRUE(sensor.setParameter("minimum_strikes", &value, sizeof(value)));
+    TEST_ASSERT_EQUAL_HEX8(0x20, s_chip->reg(0x02) & AS3935Bits::MIN_NUM_LIGH_MASK);
+
+    value = 7;
+    TEST_ASSERT_FALSE(sensor.setParameter("minimum_strikes", &value, sizeof(value)));
+
+    value = 1;
+    TEST_ASSERT_TRUE(sensor.setParameter("indoor_mode", &value, sizeof(value)));
+    TEST_ASSERT_EQUAL_HEX8(AS3935Bits::AFE_GB_INDOOR, s_chip->reg(0x00) & AS3935Bits::AFE_GB_MASK);
+
+    uint8_t out = 0;
+    size_t size = sizeof(out);
+    TEST_ASSERT_TRUE(sensor.getParameter("noise_floor", &out, size));
+    TEST_ASSERT_EQUAL_UINT8(5, out);
+    TEST_ASSERT_TRUE(sensor.getParameter("minimum_strikes", &out, size));
+    TEST_ASSERT_EQUAL_UINT8(9, out);
+    TEST_ASSERT_FALSE(sensor.getParameter("unknown", &out, size));
+
+    TEST_ASSERT_TRUE(sensor.selfTest());
+    TEST_ASSERT_EQUAL_HEX8(0x52, s_chip->reg(0x01));
+}
+
+void test_sleep_and_wakeup_recalibrate() {
+    s_chip->attachSPI(IRQ_PIN);
+    LightningSensor sensor(spiBus());
+    TEST_ASSERT_TRUE(sensor.initialize());
+
+    TEST_ASSERT_TRUE(sensor.sleep());
+    TEST_ASSERT_EQUAL_HEX8(AS3935Bits::PWD, s_chip->reg(0x00) & AS3935Bits::PWD);
+    TEST_ASSERT_EQUAL(State::DISABLED, sensor.getState());
+
+    TEST_ASSERT_TRUE(sensor.wakeup());
+    TEST_ASSERT_EQUAL_HEX8(0x00, s_chip->reg(0x00) & AS3935Bits::PWD);
+    TEST_ASSERT_EQUAL_UINT32(2, s_chip->rcoCalibrationCount());
+}
+
+void test_deinitialize_detaches_interrupt() {
+    s_chip->attachI2C(I2C_ADDRESS, IRQ_PIN);
+    LightningSensor sensor(i2cBus());
+    TEST_ASSERT_TRUE(sensor.initialize());
+    TEST_ASSERT_TRUE(sensor.deinitialize());
+    TEST_ASSERT_FALSE(Simulation::triggerInterrupt(IRQ_PIN));
+}
+
+// Closest TUN_CAP to 500 kHz by exhaustive search over the tank model
+static uint8_t bestTuningCap(const AS3935Mock& chip) {
+    uint8_t best = 0;
+    for (uint8_t cap = 1; cap < 16; cap++) {
+        if (fabsf(chip.lcoFrequencyHz(cap) - 500000.0f) < fabsf(chip.lcoFrequencyHz(best) - 500000.0f)) {
+            best = cap;
+        }
+    }
+    return best;
+}
+
+void test_tuning_finds_closest_capacitor() {
+    const float tanks[] = {905.0f, 930.0f, 957.0f, 990.0f, 1020.0f};
+
+    for (float capacitance : tanks) {
+        Simulation::reset();
+        Simulation::setMicros(1000000);
+        AS3935Mock chip;
+        chip.setTank(100.0f, capacitance);
+        chip.attachI2C(I2C_ADDRESS, IRQ_PIN);
+
+        LightningSensor sensor(i2cBus());
+        TEST_ASSERT_TRUE(sensor.initialize());
+
+        const TankTuningResult& tuning = sensor.getTankTuning();
+        char msg[48];
+        snprintf(msg, sizeof(msg), "tank %.0f pF", capacitance);
+        TEST_ASSERT_TRUE_MESSAGE(tuning.withinTolerance, msg);
+        // Ties are only resolved to the counter resolution (16 / 50 ms gate = 320 Hz)
+        const float chosenError = fabsf(chip.lcoFrequencyHz(tuning.tuningCapacitor) - 500000.0f);
+        const float bestError = fabsf(chip.lcoFrequencyHz(bestTuningCap(chip)) - 500000.0f);
+        TEST_ASSERT_FLOAT_WITHIN_MESSAGE(320.0f, bestError, chosenError, msg);
+        TEST_ASSERT_EQUAL_HEX8_MESSAGE(tuning.tuningCapacitor, chip.reg(0x08) & AS3935Bits::TUN_CAP_MASK, msg);
+        TEST_ASSERT_FLOAT_WITHIN_MESSAGE(320.0f, chip.lcoFrequencyHz(tuning.tuningCapacitor),
+                                         static_cast<float>(tuning.frequencyHz), msg);
+
+        // Binary search: at most 4 probes plus the neighbour check
+        TEST_ASSERT_LESS_OR_EQUAL_MESSAGE(6, tuning.measurements, msg);
+        TEST_ASSERT_LESS_THAN_MESSAGE(1000, tuning.durationMs, msg);
+
+        // LCO no longer routed to IRQ
+        TEST_ASSERT_EQUAL_HEX8_MESSAGE(0x00, chip.reg(0x08) & AS3935Bits::DISP_LCO, msg);
+        sensor.deinitialize();
+    }
+}
+
+void test_tuning_out_of_range_fails() {
+    s_chip->setTank(100.0f, 1300.0f);     // ~440 kHz even at TUN_CAP 0
+    s_chip->attachI2C(I2C_ADDRESS, IRQ_PIN);
+    LightningSensor sensor(i2cBus());
+
+    // Initialization survives an untunable antenna
+    TEST_ASSERT_TRUE(sensor.initialize());
+    TEST_ASSERT_FALSE(sensor.getTankTuning().withinTolerance);
+    TEST_ASSERT_EQUAL_UINT32(LightningErrorCodes::TANK_TUNING_FAILED, sensor.getLastError());
+    TEST_ASSERT_EQUAL_HEX8(0x00, s_chip->reg(0x08) & AS3935Bits::TUN_CAP_MASK);
+
+    // Nothing persisted: the next boot tunes again
+    sensor.deinitialize();
+    s_chip->clearCounters();
+    LightningSensor again(i2cBus());
+    TEST_ASSERT_TRUE(again.initialize());
+    TEST_ASSERT_GREATER_THAN(0, s_chip->lcoGates());
+}
+
+void test_tuning_persisted_across_boots() {
+    s_chip->setTank(100.0f, 930.0f);
+    s_chip->attachSPI(IRQ_PIN);
+    {
+        LightningSensor sensor(spiBus());
+        TEST_ASSERT_TRUE(sensor.initialize());
+        TEST_ASSERT_TRUE(sensor.getTankTuning().withinTolerance);
+    }
+
+    // Power cycle: chip registers reset, NVS kept
+    const uint8_t tuned = bestTuningCap(*s_chip);
+    s_chip->setReg(0x3C, 0x00);
+    s_chip->clearCounters();
+
+    LightningSensor sensor(spiBus());
+    TEST_ASSERT_TRUE(sensor.initialize());
+    TEST_ASSERT_EQUAL_UINT32(0, s_chip->lcoGates());
+    TEST_ASSERT_EQUAL_HEX8(tuned, s_chip->reg(0x08) & AS3935Bits::TUN_CAP_MASK);
+
+    uint8_t value = 0;
+    size_t size = sizeof(value);
+    TEST_ASSERT_TRUE(sensor.getParameter("tuning_capacitor", &value, size));
+    TEST_ASSERT_EQUAL_UINT8(tuned, value);
+}
+
+void test_retune_while_running_restores_irq() {
+    s_chip->attachI2C(I2C_ADDRESS, IRQ_PIN);
+    LightningSensor sensor(i2cBus());
+    TEST_ASSERT_TRUE(sensor.initialize());
+
+    s_chip->setTank(100.0f, 990.0f);
+    TEST_ASSERT_TRUE(sensor.calibrate());
+    TEST_ASSERT_EQUAL_UINT8(bestTuningCap(*s_chip), sensor.getTankTuning().tuningCapacitor);
+
+    s_chip->scriptLightning(8, 100);
+    Simulation::advanceMicros(3000);
+    sensor.update();
+    TEST_ASSERT_EQUAL_UINT32(1, sensor.getTotalLightningCount());
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_initialize_over_i2c);
+    RUN_TEST(test_initialize_over_spi);
+    RUN_TEST(test_missing_chip_reports_not_found);
+    RUN_TEST(test_lightning_event_read_in_one_burst);
+    RUN_TEST(test_spi_burst_and_timing_stats);
+    RUN_TEST(test_disturber_and_noise_counted);
+    RUN_TEST(test_strike_series_counts);
+    RUN_TEST(test_strikes_feed_storm_tracker);
+    RUN_TEST(test_strikes_and_storm_logged_to_flash);
+    RUN_TEST(test_queue_overflow_counts_dropped_events);
+    RUN_TEST(test_parameters_round_trip);
+    RUN_TEST(test_sleep_and_wakeup_recalibrate);
+    RUN_TEST(test_deinitialize_detaches_interrupt);
+    RUN_TEST(test_tuning_finds_closest_capacitor);
+    RUN_TEST(test_tuning_out_of_range_fails);
+    RUN_TEST(test_tuning_persisted_across_boots);
+    RUN_TEST(test_retune_while_running_restores_irq);
+
+    return UNITY_END();
+}
@@ -0,0 +1,363 @@
+// Unit tests for the loop time budget, and a simulated loop() running the
+// UI controller, button and control-channel burst (preset change, idle
+// mode, sleep) against it
+#include <unity.h>
+#include "../src/system/loop_budget.h"
+#include "../src/display/screen_model.h"
+#include "../src/display/ui_timeline.h"
+#include "../src/display/ui_controller.h"
+#include "../src/sensors/button_input.h"
+#include "../src/communication/control_burst.h"
+#include "../src/hardware/hardware_abstraction.h"
+#include <cstring>
+
+using namespace Diagnostics;
+using namespace Display;
+namespace Simulation = HardwareAbstraction::Simulation;
+namespace Timer = HardwareAbstraction::Timer;
+
+// Tight enough that any leftover delay(1000)-style wait fails the test
+static const uint32_t TEST_BUDGET_US = 20000;
+
+static LoopBudgetConfig makeConfig() {
+    LoopBudgetConfig config = getDefaultLoopBudgetConfig();
+    config.budget_us = TEST_BUDGET_US;
+    return config;
+}
+
+// Stands in for main.cpp's UiController and ControlBurst hooks
+struct Firmware {
+    uint32_t presets = 0;
+    bool broadcast = false;
+    uint32_t sleep_prepared = 0;
+    bool asleep = false;
+    uint32_t asleep_ms = 0;
+    CommunicationSystem::ControlBurst* burst = nullptr;
+    bool on_control = false;
+    uint32_t ctrl_enters = 0;
+    uint32_t ctrl_tx = 0;
+    uint32_t ctrl_tx_ms[8] = {};
+    uint32_t restored_ms = 0;
+};
+
+static Firmware s_firmware;
+
+static const char* cyclePreset(bool broadcast) {
+    s_firmware.presets++;
+    s_firmware.broadcast = broadcast;
+    // applyLoRaPreset() on a receiver: announce on the control channel
+    if (!broadcast && s_firmware.burst) {
+        s_firmware.burst->start(Timer::millis(), 4, 200);
+    }
+    return "LR-F";
+}
+
+// Radio stand-ins; their cost goes through the mocked delay() like the
+// rest, so waiting between packets here would show up as an overrun
+static bool enterControl() {
+    delay(2);                               // radio.begin on the control channel
+    s_firmware.on_control = true;
+    s_firmware.ctrl_enters++;
+    return true;
+}
+
+static bool transmitConfig() {
+    delay(5);
+    if (s_firmware.ctrl_tx < 8) {
+        s_firmware.ctrl_tx_ms[s_firmware.ctrl_tx] = Timer::millis();
+    }
+    s_firmware.ctrl_tx++;
+    return true;
+}
+
+static void restoreChannel() {
+    delay(2);
+    s_firmware.on_control = false;
+    s_firmware.restored_ms = Timer::millis();
+}
+
+static void prepareSleep() {
+    s_firmware.sleep_prepared++;
+}
+
+static void powerDown() {
+    s_firmware.asleep = true;
+    s_firmware.asleep_ms = Timer::millis();
+}
+
+// The mocked delay() advances the simulated clock, so a blocking wait in
+// the UI code shows up as an overrun
+static void simulatedDelay(unsigned long ms) {
+    Timer::delay(ms);
+}
+
+// loop()'s UI steps on the real button and controller, with the radio and
+// web server reduced to a fixed cost per iteration
+struct UiLoop {
+    ScreenState screen;
+    UiTimeline timeline;
+    UiController ui;
+    CommunicationSystem::ControlBurst burst;
+    Sensors::ButtonInput button;
+    LoopBudget budget;
+    bool sender = true;
+    uint32_t radio_polls = 0;
+    uint32_t control_polls = 0;             // RX attempted while on the control channel
+
+    UiLoop() : screen(makeScreenConfig()), ui(screen, timeline), burst(timeline), budget(makeConfig()) {
+        UiControllerHooks hooks = {};
+        hooks.cyclePreset = cyclePreset;
+        hooks.prepareSleep = prepareSleep;
+        hooks.powerDown = powerDown;
+        ui.setHooks(hooks);
+        ui.begin(Timer::millis());
+        CommunicationSystem::ControlBurstHooks burstHooks = {};
+        burstHooks.enterControl = enterControl;
+        burstHooks.transmit = transmitConfig;
+        burstHooks.restore = restoreChannel;
+        burst.setHooks(burstHooks);
+        s_firmware.burst = &burst;
+        TEST_ASSERT_TRUE(button.begin(Sensors::getDefaultButtonInputConfig()));
+    }
+
+    ~UiLoop() {
+        button.end();
+        s_firmware.burst = nullptr;
+    }
+
+    static ScreenConfig makeScreenConfig() {
+        ScreenConfig config = getDefaultScreenConfig();
+        config.rotate_interval_ms = 0;
+        return config;
+    }
+};
+
+static void iterate(UiLoop& loop) {
+    loop.budget.beginIteration();
+    Timer::delay(1);                        // Web server
+    loop.budget.checkpoint("web server");
+    loop.ui.serviceButton(loop.button, loop.sender, Timer::millis());
+    loop.budget.checkpoint("button");
+    loop.ui.checkIdle(Timer::millis());
+    loop.budget.checkpoint("idle mode");
+    if (!loop.burst.isActive()) {
+        Timer::delay(1);                    // radio.receive(rx, 0)
+        loop.radio_polls++;
+        if (s_firmware.on_control) {
+            loop.control_polls++;
+        }
+    }
+    loop.budget.checkpoint("radio");
+    loop.timeline.poll(Timer::millis());
+    loop.screen.update(Timer::millis());
+    loop.budget.checkpoint("UI");
+    TEST_ASSERT_TRUE_MESSAGE(loop.budget.endIteration(), loop.budget.getStats().max_span_label);
+    Timer::delay(1);                        // loop()'s trailing delay(1)
+}
+
+static void runFor(UiLoop& loop, uint32_t ms) {
+    const uint32_t end = Timer::millis() + ms;
+    while (static_cast<int32_t>(Timer::millis() - end) < 0 && !s_firmware.asleep) {
+        iterate(loop);
+    }
+}
+
+// BOOT button through its interrupt, held for holdMs with the loop running
+static void press(UiLoop& loop, uint32_t holdMs) {
+    const uint8_t pin = Sensors::getDefaultButtonInputConfig().pin;
+    HardwareAbstraction::GPIO::digitalWrite(pin, HardwareAbstraction::GPIO::Level::LEVEL_LOW);
+    TEST_ASSERT_TRUE(Simulation::triggerInterrupt(pin));
+    runFor(loop, holdMs);
+    HardwareAbstraction::GPIO::digitalWrite(pin, HardwareAbstraction::GPIO::Level::LEVEL_HIGH);
+    TEST_ASSERT_TRUE(Simulation::triggerInterrupt(pin));
+}
+
+static bool headerShows(const UiLoop& loop, const char* line1) {
+    return loop.screen.getModel().header.message && strcmp(loop.screen.getModel().header.line1, line1) == 0;
+}
+
+void setUp(void) {
+    Simulation::reset();
+    Simulation::setMicros(1000000);
+    HardwareAbstraction::initialize();
+    s_firmware = Firmware();
+    mockDelayHook = simulatedDelay;
+}
+
+void tearDown(void) {
+    mockDelayHook = nullptr;
+}
+
+void test_iteration_within_budget() {
+    LoopBudget budget(makeConfig());
+    budget.beginIteration();
+    Simulation::advanceMicros(5000);
+    budget.checkpoint("radio");
+    Simulation::advanceMicros(3000);
+    TEST_ASSERT_TRUE(budget.endIteration());
+
+    const LoopBudgetStats& stats = budget.getStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.iterations);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.overruns);
+    TEST_ASSERT_EQUAL_UINT32(8000, stats.last_iteration_us);
+    TEST_ASSERT_EQUAL_UINT32(5000, stats.max_span_us);
+    TEST_ASSERT_EQUAL_STRING("radio", stats.max_span_label);
+}
+
+void test_overrun_names_the_blocking_step() {
+    LoopBudget budget(makeConfig());
+    budget.beginIteration();
+    Simulation::advanceMicros(1000);
+    budget.checkpoint("web server");
+    Timer::delay(1000);                     // The old "keep the message up" wait
+    budget.checkpoint("button");
+    Simulation::advanceMicros(1000);
+    TEST_ASSERT_FALSE(budget.endIteration());
+
+    TEST_ASSERT_EQUAL_UINT32(1, budget.getStats().overruns);
+    TEST_ASSERT_EQUAL_UINT32(1002000, budget.getStats().max_iteration_us);
+    TEST_ASSERT_EQUAL_STRING("button", budget.getStats().max_span_label);
+
+    budget.resetStats();
+    TEST_ASSERT_EQUAL_UINT32(0, budget.getStats().overruns);
+    TEST_ASSERT_EQUAL_STRING("", budget.getStats().max_span_label);
+}
+
+void test_default_budget_from_build_flag() {
+    TEST_ASSERT_EQUAL_UINT32(50000, getDefaultLoopBudgetConfig().budget_us);
+    LoopBudget budget;
+    budget.checkpoint("outside");           // Ignored between iterations
+    TEST_ASSERT_TRUE(budget.endIteration());
+    TEST_ASSERT_EQUAL_UINT32(0, budget.getStats().iterations);
+}
+
+// A preset change used to be followed by delay(1000): now the message holds
+// on its own while the loop keeps polling the radio
+void test_preset_message_holds_without_blocking() {
+    UiLoop loop;
+    runFor(loop, 12500);
+    TEST_ASSERT_TRUE(loop.ui.isIdle());
+    TEST_ASSERT_FALSE(loop.screen.getModel().header.message);
+
+    press(loop, 300);
+    const uint32_t start = Timer::millis();
+    const uint32_t pollsBefore = loop.radio_polls;
+    runFor(loop, 10);
+    TEST_ASSERT_FALSE(loop.ui.isIdle());
+    TEST_ASSERT_EQUAL_UINT32(1, s_firmware.presets);
+    TEST_ASSERT_TRUE(s_firmware.broadcast);
+
+    runFor(loop, 1900);
+    TEST_ASSERT_TRUE(headerShows(loop, "Interactive"));
+    runFor(loop, 200);
+    TEST_ASSERT_TRUE(headerShows(loop, "Preset"));
+    TEST_ASSERT_EQUAL_STRING("LR-F", loop.screen.getModel().header.line2);
+    runFor(loop, 2100);
+    TEST_ASSERT_FALSE(loop.screen.getModel().header.message);
+
+    // Some 1400 radio polls in the 4.2 s the two messages were up
+    TEST_ASSERT_TRUE(loop.radio_polls - pollsBefore > (Timer::millis() - start) / 4);
+    TEST_ASSERT_EQUAL_UINT32(0, loop.budget.getStats().overruns);
+}
+
+// The sleep message queues behind the preset message; the panel must not
+// go dark before it has had its full hold time
+void test_sleep_waits_for_its_message() {
+    UiLoop loop;
+    loop.sender = false;
+    runFor(loop, 100);
+
+    press(loop, 300);
+    runFor(loop, 500);
+    TEST_ASSERT_TRUE(headerShows(loop, "Preset"));
+    TEST_ASSERT_FALSE(s_firmware.broadcast);                // Receivers do not announce
+
+    loop.ui.handleAction(ButtonAction::SleepMode, loop.sender, Timer::millis());
+    loop.ui.handleAction(ButtonAction::SleepMode, loop.sender, Timer::millis());   // While going down
+    TEST_ASSERT_TRUE(loop.ui.isSleepRequested());
+    TEST_ASSERT_EQUAL_UINT32(1, s_firmware.sleep_prepared);
+
+    uint32_t shownAt = 0;
+    while (!s_firmware.asleep) {
+        iterate(loop);
+        if (!shownAt && headerShows(loop, "Sleep Mode")) {
+            shownAt = Timer::millis();
+        }
+    }
+
+    TEST_ASSERT_TRUE(shownAt != 0);
+    TEST_ASSERT_TRUE(s_firmware.asleep_ms - shownAt >= 1000);
+    TEST_ASSERT_TRUE(s_firmware.asleep_ms - loop.ui.getSleepRequestedMs() < 5000);
+    TEST_ASSERT_EQUAL_UINT32(loop.timeline.getStats().scheduled, loop.timeline.getStats().fired);
+    TEST_ASSERT_EQUAL_UINT32(0, loop.budget.getStats().overruns);
+}
+
+// Long press on the button all the way to power-down
+void test_long_press_sleeps_without_blocking() {
+    UiLoop loop;
+    runFor(loop, 100);
+
+    press(loop, 6500);
+    TEST_ASSERT_FALSE(loop.ui.isSleepRequested());          // Acts on release
+    runFor(loop, 10);
+    TEST_ASSERT_TRUE(loop.ui.isSleepRequested());
+    TEST_ASSERT_EQUAL_UINT32(0, s_firmware.presets);
+
+    runFor(loop, 6000);
+    TEST_ASSERT_TRUE(s_firmware.asleep);
+    TEST_ASSERT_TRUE(s_firmware.asleep_ms - loop.ui.getSleepRequestedMs() >= 1000);
+    TEST_ASSERT_EQUAL_UINT32(0, loop.budget.getStats().overruns);
+}
+
+// A receiver's preset change used to broadcast on the control channel
+// inline: two retunes, four packets and four delay(200) in one iteration
+void test_receiver_preset_broadcast_without_blocking() {
+    UiLoop loop;
+    loop.sender = false;
+    runFor(loop, 100);
+
+    press(loop, 300);
+    runFor(loop, 10);
+    TEST_ASSERT_EQUAL_UINT32(1, s_firmware.presets);
+    TEST_ASSERT_TRUE(loop.burst.isActive());
+
+    runFor(loop, 1500);
+    TEST_ASSERT_FALSE(loop.burst.isActive());
+    TEST_ASSERT_FALSE(s_firmware.on_control);
+    TEST_ASSERT_EQUAL_UINT32(4, s_firmware.ctrl_tx);
+    TEST_ASSERT_EQUAL_UINT32(4, loop.burst.getSent());
+    for (uint32_t i = 1; i < 4; i++) {
+        TEST_ASSERT_TRUE(s_firmware.ctrl_tx_ms[i] - s_firmware.ctrl_tx_ms[i - 1] >= 200);
+    }
+    TEST_ASSERT_TRUE(s_firmware.restored_ms - s_firmware.ctrl_tx_ms[3] >= 200);
+    TEST_ASSERT_TRUE(headerShows(loop, "Preset"));
+
+    // A second press mid-burst retunes the radio; the burst starts over
+    press(loop, 300);
+    runFor(loop, 450);
+    TEST_ASSERT_TRUE(loop.burst.isActive());
+    press(loop, 300);
+    runFor(loop, 1500);
+    TEST_ASSERT_EQUAL_UINT32(3, s_firmware.presets);
+    TEST_ASSERT_FALSE(loop.burst.isActive());
+    TEST_ASSERT_FALSE(s_firmware.on_control);
+    TEST_ASSERT_TRUE(loop.burst.getSent() >= 8 + 2);
+    TEST_ASSERT_EQUAL_UINT32(3, s_firmware.ctrl_enters);
+
+    TEST_ASSERT_EQUAL_UINT32(0, loop.control_polls);
+    TEST_ASSERT_EQUAL_UINT32(0, loop.budget.getStats().overruns);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_iteration_within_budget);
+    RUN_TEST(test_overrun_names_the_blocking_step);
+    RUN_TEST(test_default_budget_from_build_flag);
+    RUN_TEST(test_preset_message_holds_without_blocking);
+    RUN_TEST(test_sleep_waits_for_its_message);
+    RUN_TEST(test_long_press_sleeps_without_blocking);
+    RUN_TEST(test_receiver_preset_broadcast_without_blocking);
+
+    return UNITY_END();
+}
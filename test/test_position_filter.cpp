@@ -0,0 +1,241 @@
+// Unit tests for the GPS position filter against synthetic trajectories
+#include <unity.h>
+#include "../src/sensors/gps_sensor.h"
+#include <cmath>
+#include <cstdio>
+
+using namespace GPS;
+
+static constexpr double METERS_PER_DEG = 6371000.0 * M_PI / 180.0;
+static constexpr double LAT0 = 39.7392;
+static constexpr double LON0 = -104.9903;
+
+void setUp(void) {
+    HardwareAbstraction::initialize();
+}
+
+void tearDown(void) {
+    HardwareAbstraction::deinitialize();
+}
+
+// Deterministic Gaussian noise (LCG + Box-Muller)
+static uint32_t s_seed = 1;
+static double uniform() {
+    s_seed = s_seed * 1664525u + 1013904223u;
+    return ((s_seed >> 8) + 0.5) / 16777216.0;
+}
+static double gaussian() {
+    return sqrt(-2.0 * log(uniform())) * cos(2.0 * M_PI * uniform());
+}
+
+static void offsetToLatLon(double north_m, double east_m, double* lat, double* lon) {
+    *lat = LAT0 + north_m / METERS_PER_DEG;
+    *lon = LON0 + east_m / (METERS_PER_DEG * cos(LAT0 * M_PI / 180.0));
+}
+
+static double horizontalError(double lat, double lon, double true_north, double true_east) {
+    const double north = (lat - LAT0) * METERS_PER_DEG;
+    const double east = (lon - LON0) * METERS_PER_DEG * cos(LAT0 * M_PI / 180.0);
+    return hypot(north - true_north, east - true_east);
+}
+
+struct TrajectoryResult {
+    double raw_rms_m;
+    double filtered_rms_m;
+    PositionEstimate last;
+};
+
+// 1 Hz fixes along north/east velocity (m/s); RMS taken after a 30 s settling time
+static TrajectoryResult runTrajectory(PositionFilter& filter, double vn, double ve, float hdop, int samples) {
+    const PositionFilterConfig& config = filter.getConfig();
+    const double sigma_axis = hdop * config.uere_m / sqrt(2.0);
+    double raw_sq = 0.0, filtered_sq = 0.0;
+    int counted = 0;
+    TrajectoryResult result = {};
+
+    for (int i = 0; i < samples; i++) {
+        const double true_north = vn * i;
+        const double true_east = ve * i;
+        double lat, lon;
+        offsetToLatLon(true_north + sigma_axis * gaussian(), true_east + sigma_axis * gaussian(), &lat, &lon);
+
+        filter.update(lat, lon, 1600.0f, true, hdop, 0.0f, i * 1000u);
+        result.last = filter.getEstimate();
+
+        if (i >= 30) {
+            const double raw = horizontalError(lat, lon, true_north, true_east);
+            const double filtered = horizontalError(result.last.latitude, result.last.longitude, true_north, true_east);
+            raw_sq += raw * raw;
+            filtered_sq += filtered * filtered;
+            counted++;
+        }
+    }
+
+    result.raw_rms_m = sqrt(raw_sq / counted);
+    result.filtered_rms_m = sqrt(filtered_sq / counted);
+    return result;
+}
+
+void test_first_fix_seeds_state() {
+    PositionFilter filter;
+    TEST_ASSERT_FALSE(filter.isInitialized());
+    TEST_ASSERT_EQUAL(PositionFilter::UpdateResult::INITIALIZED,
+                      filter.update(LAT0, LON0, 1600.0f, true, 1.0f, 0.0f, 0));
+    TEST_ASSERT_TRUE(filter.isInitialized());
+
+    const PositionEstimate estimate = filter.getEstimate();
+    TEST_ASSERT_FLOAT_WITHIN(1e-7, LAT0, estimate.latitude);
+    TEST_ASSERT_FLOAT_WITHIN(1e-7, LON0, estimate.longitude);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1600.0f, estimate.altitude);
+}
+
+void test_stationary_steady_state_error() {
+    PositionFilter filter;
+    s_seed = 1;
+    const TrajectoryResult result = runTrajectory(filter, 0.0, 0.0, 1.5f, 300);
+
+    // 7.5 m raw RMS; the filter should roughly halve it
+    TEST_ASSERT_FLOAT_WITHIN(1.5, 7.5, result.raw_rms_m);
+    TEST_ASSERT_LESS_THAN(result.raw_rms_m * 0.6, result.filtered_rms_m);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, hypotf(result.last.velocity_north_mps, result.last.velocity_east_mps));
+    TEST_ASSERT_EQUAL_UINT32(0, filter.getStats().rejected);
+}
+
+void test_constant_velocity_steady_state_error() {
+    PositionFilter filter;
+    s_seed = 2;
+    const TrajectoryResult result = runTrajectory(filter, 6.0, 8.0, 1.0f, 300);
+
+    // Constant-velocity model tracks without lag
+    TEST_ASSERT_LESS_THAN(result.raw_rms_m * 0.6, result.filtered_rms_m);
+    TEST_ASSERT_FLOAT_WITHIN(1.5f, 6.0f, result.last.velocity_north_mps);
+    TEST_ASSERT_FLOAT_WITHIN(1.5f, 8.0f, result.last.velocity_east_mps);
+}
+
+void test_recenter_keeps_long_tracks_accurate() {
+    // 30 m/s for 10 minutes crosses the 5 km recenter distance several times
+    PositionFilter filter;
+    s_seed = 3;
+    const TrajectoryResult result = runTrajectory(filter, 0.0, 30.0, 1.0f, 600);
+    TEST_ASSERT_LESS_THAN(result.raw_rms_m, result.filtered_rms_m);
+}
+
+void test_multipath_outlier_rejected() {
+    PositionFilter filter;
+    s_seed = 4;
+    runTrajectory(filter, 0.0, 0.0, 1.0f, 60);
+
+    // Single 300 m jump
+    double lat, lon;
+    offsetToLatLon(300.0, 0.0, &lat, &lon);
+    TEST_ASSERT_EQUAL(PositionFilter::UpdateResult::REJECTED,
+                      filter.update(lat, lon, 1600.0f, true, 1.0f, 0.0f, 60000));
+
+    const PositionEstimate estimate = filter.getEstimate();
+    TEST_ASSERT_LESS_THAN(5.0, horizontalError(estimate.latitude, estimate.longitude, 0.0, 0.0));
+    TEST_ASSERT_EQUAL_UINT32(1, filter.getStats().rejected);
+
+    // Next good fix is accepted again
+    TEST_ASSERT_EQUAL(PositionFilter::UpdateResult::ACCEPTED,
+                      filter.update(LAT0, LON0, 1600.0f, true, 1.0f, 0.0f, 61000));
+}
+
+void test_persistent_jump_reseeds() {
+    PositionFilter filter;
+    s_seed = 5;
+    runTrajectory(filter, 0.0, 0.0, 1.0f, 60);
+
+    double lat, lon;
+    offsetToLatLon(0.0, 500.0, &lat, &lon);
+    PositionFilter::UpdateResult result = PositionFilter::UpdateResult::ACCEPTED;
+    for (uint32_t i = 0; i < filter.getConfig().max_consecutive_rejects; i++) {
+        result = filter.update(lat, lon, 1600.0f, true, 1.0f, 0.0f, 60000 + i * 1000);
+    }
+
+    TEST_ASSERT_EQUAL(PositionFilter::UpdateResult::INITIALIZED, result);
+    const PositionEstimate estimate = filter.getEstimate();
+    TEST_ASSERT_LESS_THAN(1.0, horizontalError(estimate.latitude, estimate.longitude, 0.0, 500.0));
+}
+
+void test_hdop_weighting() {
+    // Identical 10 m offsets: a poor-HDOP fix must pull the estimate less
+    double lat, lon;
+    offsetToLatLon(10.0, 0.0, &lat, &lon);
+    double pulled[2];
+    const float hdops[2] = {1.0f, 4.0f};
+
+    for (int k = 0; k < 2; k++) {
+        PositionFilter filter;
+        for (uint32_t i = 0; i < 20; i++) {
+            filter.update(LAT0, LON0, 1600.0f, true, 1.0f, 0.0f, i * 1000);
+        }
+        filter.update(lat, lon, 1600.0f, true, hdops[k], 0.0f, 20000);
+        const PositionEstimate estimate = filter.getEstimate();
+        pulled[k] = (estimate.latitude - LAT0) * METERS_PER_DEG;
+    }
+
+    TEST_ASSERT_GREATER_THAN(0.0, pulled[1]);
+    TEST_ASSERT_LESS_THAN(pulled[0] * 0.25, pulled[1]);
+}
+
+void test_gap_reseeds() {
+    PositionFilter filter;
+    filter.update(LAT0, LON0, 1600.0f, true, 1.0f, 0.0f, 0);
+    filter.update(LAT0, LON0, 1600.0f, true, 1.0f, 0.0f, 1000);
+    TEST_ASSERT_EQUAL(PositionFilter::UpdateResult::INITIALIZED,
+                      filter.update(LAT0 + 0.01, LON0, 1600.0f, true, 1.0f, 0.0f, 1000 + 120000));
+    TEST_ASSERT_EQUAL_UINT32(2, filter.getStats().resets);
+}
+
+// UC6580 integration: raw and filtered positions are both exposed
+static void feed(UC6580& gps, const char* body) {
+    uint8_t checksum = 0;
+    for (const char* p = body; *p; p++) {
+        checksum ^= static_cast<uint8_t>(*p);
+    }
+    char sentence[128];
+    snprintf(sentence, sizeof(sentence), "$%s*%02X", body, checksum);
+    gps.processNMEA(sentence);
+}
+
+void test_uc6580_exposes_raw_and_filtered() {
+    UC6580 gps;
+    Config config = getDefaultConfig();
+    config.auto_power_on = false;
+    gps.initialize(config);
+
+    feed(gps, "GPGGA,120000.00,4807.0380,N,01131.0000,E,1,08,1.0,545.4,M,46.9,M,,");
+    feed(gps, "GPGGA,120001.00,4807.0380,N,01131.0000,E,1,08,1.0,545.4,M,46.9,M,,");
+    // 0.01' north (~18.5 m) jitter
+    feed(gps, "GPGGA,120002.00,4807.0480,N,01131.0000,E,1,08,1.0,545.4,M,46.9,M,,");
+
+    const Data& data = gps.getData();
+    TEST_ASSERT_TRUE(data.filtered);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 48.0 + 7.048 / 60.0, data.raw_latitude);
+    TEST_ASSERT_TRUE(data.latitude > 48.0 + 7.038 / 60.0);
+    TEST_ASSERT_TRUE(data.latitude < data.raw_latitude);
+    TEST_ASSERT_GREATER_THAN(0.0f, data.position_sigma_m);
+    TEST_ASSERT_EQUAL_UINT32(2, gps.getPositionFilter().getStats().accepted);
+
+    // Disabled: latitude follows the raw fix
+    gps.setPositionFilterEnabled(false);
+    feed(gps, "GPGGA,120003.00,4807.0580,N,01131.0000,E,1,08,1.0,545.4,M,46.9,M,,");
+    TEST_ASSERT_FALSE(gps.getData().filtered);
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, gps.getData().raw_latitude, gps.getData().latitude);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_first_fix_seeds_state);
+    RUN_TEST(test_stationary_steady_state_error);
+    RUN_TEST(test_constant_velocity_steady_state_error);
+    RUN_TEST(test_recenter_keeps_long_tracks_accurate);
+    RUN_TEST(test_multipath_outlier_rejected);
+    RUN_TEST(test_persistent_jump_reseeds);
+    RUN_TEST(test_hdop_weighting);
+    RUN_TEST(test_gap_reseeds);
+    RUN_TEST(test_uc6580_exposes_raw_and_filtered);
+
+    return UNITY_END();
+}
@@ -0,0 +1,166 @@
+// Unit tests for the power calibration store: load once, serve from RAM,
+// write through only on change, multi-point ADC calibration
+#include <unity.h>
+#include "../src/hardware/power_calibration.h"
+#include "../src/hardware/hardware_abstraction.h"
+#include <cstring>
+
+using namespace HardwareAbstraction;
+using Simulation::MemoryCalibrationBackend;
+
+static MemoryCalibrationBackend* s_nvs;
+
+void setUp(void) {
+    s_nvs = new MemoryCalibrationBackend();
+}
+
+void tearDown(void) {
+    g_powerCalibration.begin(nullptr);
+    delete s_nvs;
+}
+
+void test_defaults_without_stored_values() {
+    PowerCalibration cal;
+    cal.begin(s_nvs);
+    TEST_ASSERT_TRUE(cal.isLoaded());
+    TEST_ASSERT_EQUAL_FLOAT(PowerCalibration::DEFAULT_MULTIPLIER, cal.getAdcMultiplier());
+    TEST_ASSERT_EQUAL_UINT32(0, cal.pointCount());
+    TEST_ASSERT_FLOAT_WITHIN(0.0001f, 0.8f * 4.9f, cal.batteryVoltage(0.8f));
+    TEST_ASSERT_EQUAL_UINT32(0, s_nvs->stores);
+}
+
+// All keys are read at begin(); after that reads never reach NVS
+void test_reads_served_from_ram() {
+    const float stored = 4.62f;
+    s_nvs->put("adc_multiplier", &stored, sizeof(stored));
+
+    PowerCalibration cal;
+    cal.begin(s_nvs);
+    const uint32_t loads = s_nvs->loads;
+    TEST_ASSERT_EQUAL_UINT32(2, loads);
+
+    for (int i = 0; i < 1000; i++) {
+        TEST_ASSERT_EQUAL_FLOAT(4.62f, cal.getAdcMultiplier());
+        cal.batteryVoltage(0.8f);
+    }
+    TEST_ASSERT_EQUAL_UINT32(loads, s_nvs->loads);
+    TEST_ASSERT_EQUAL_UINT32(0, s_nvs->stores);
+}
+
+void test_write_through_only_on_change() {
+    PowerCalibration cal;
+    cal.begin(s_nvs);
+
+    TEST_ASSERT_TRUE(cal.setAdcMultiplier(4.9f));
+    TEST_ASSERT_EQUAL_UINT32(0, s_nvs->stores);
+
+    TEST_ASSERT_TRUE(cal.setAdcMultiplier(5.1f));
+    TEST_ASSERT_TRUE(cal.setAdcMultiplier(5.1f));
+    TEST_ASSERT_EQUAL_UINT32(1, s_nvs->stores);
+
+    TEST_ASSERT_FALSE(cal.setAdcMultiplier(7.0f));
+    TEST_ASSERT_FALSE(cal.setAdcMultiplier(1.0f));
+    TEST_ASSERT_EQUAL_FLOAT(5.1f, cal.getAdcMultiplier());
+    TEST_ASSERT_EQUAL_UINT32(2, cal.getStats().rejected);
+    TEST_ASSERT_EQUAL_UINT32(1, s_nvs->stores);
+
+    // Survives a reboot
+    PowerCalibration rebooted;
+    rebooted.begin(s_nvs);
+    TEST_ASSERT_EQUAL_FLOAT(5.1f, rebooted.getAdcMultiplier());
+}
+
+void test_multi_point_interpolation() {
+    PowerCalibration cal;
+    cal.begin(s_nvs);
+
+    // Meter readings at three charge levels; the ADC reads low at the bottom
+    TEST_ASSERT_TRUE(cal.addPoint(0.850f, 4.180f));
+    TEST_ASSERT_TRUE(cal.addPoint(0.700f, 3.500f));
+    TEST_ASSERT_TRUE(cal.addPoint(0.780f, 3.850f));
+    TEST_ASSERT_EQUAL_UINT32(3, cal.pointCount());
+    TEST_ASSERT_EQUAL_UINT16(700, cal.point(0).pin_mv);
+    TEST_ASSERT_EQUAL_UINT16(850, cal.point(2).pin_mv);
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.850f, cal.batteryVoltage(0.780f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.675f, cal.batteryVoltage(0.740f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 4.015f, cal.batteryVoltage(0.815f));
+
+    // Outside the span the nearest point's ratio holds
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.6f * 3.5f / 0.7f, cal.batteryVoltage(0.6f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.9f * 4.18f / 0.85f, cal.batteryVoltage(0.9f));
+
+    // Points win over the multiplier while there are any
+    cal.setAdcMultiplier(3.0f);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 3.850f, cal.batteryVoltage(0.780f));
+    TEST_ASSERT_TRUE(cal.clearPoints());
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 2.34f, cal.batteryVoltage(0.780f));
+}
+
+void test_points_persist_and_merge() {
+    PowerCalibration cal;
+    cal.begin(s_nvs);
+    cal.addPoint(0.700f, 3.500f);
+    cal.addPoint(0.850f, 4.180f);
+    TEST_ASSERT_EQUAL_UINT32(2, s_nvs->stores);
+
+    // Same spot again replaces it; identical repeats are not written
+    TEST_ASSERT_TRUE(cal.addPoint(0.705f, 3.520f));
+    TEST_ASSERT_TRUE(cal.addPoint(0.705f, 3.520f));
+    TEST_ASSERT_EQUAL_UINT32(2, cal.pointCount());
+    TEST_ASSERT_EQUAL_UINT32(3, s_nvs->stores);
+
+    PowerCalibration rebooted;
+    rebooted.begin(s_nvs);
+    TEST_ASSERT_EQUAL_UINT32(2, rebooted.pointCount());
+    TEST_ASSERT_EQUAL_UINT16(705, rebooted.point(0).pin_mv);
+    TEST_ASSERT_EQUAL_UINT16(3520, rebooted.point(0).battery_mv);
+
+    // Implausible ratio and a full table are refused
+    TEST_ASSERT_FALSE(rebooted.addPoint(0.800f, 0.9f));
+    for (int i = 0; i < 10; i++) {
+        rebooted.addPoint(0.300f + i * 0.05f, (0.300f + i * 0.05f) * 4.9f);
+    }
+    TEST_ASSERT_EQUAL_UINT32(PowerCalibration::MAX_POINTS, rebooted.pointCount());
+}
+
+void test_corrupt_values_are_ignored() {
+    const float badMultiplier = 40.0f;
+    s_nvs->put("adc_multiplier", &badMultiplier, sizeof(badMultiplier));
+    uint8_t badPoints[36];
+    memset(badPoints, 0xFF, sizeof(badPoints));
+    s_nvs->put("adc_cal_pts", badPoints, sizeof(badPoints));
+
+    PowerCalibration cal;
+    cal.begin(s_nvs);
+    TEST_ASSERT_EQUAL_FLOAT(PowerCalibration::DEFAULT_MULTIPLIER, cal.getAdcMultiplier());
+    TEST_ASSERT_EQUAL_UINT32(0, cal.pointCount());
+    TEST_ASSERT_EQUAL_UINT32(2, cal.getStats().rejected);
+}
+
+// The HAL power API is a view of the same store
+void test_power_api_uses_store() {
+    g_powerCalibration.begin(s_nvs);
+    Power::setAdcMultiplier(4.4f);
+    TEST_ASSERT_EQUAL_FLOAT(4.4f, Power::getAdcMultiplier());
+    TEST_ASSERT_EQUAL_FLOAT(4.4f, g_powerCalibration.getAdcMultiplier());
+    TEST_ASSERT_EQUAL_UINT32(1, s_nvs->stores);
+
+    Power::setAdcMultiplier(9.0f);
+    TEST_ASSERT_EQUAL_FLOAT(4.4f, Power::getAdcMultiplier());
+    TEST_ASSERT_EQUAL_UINT32(1, s_nvs->stores);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_defaults_without_stored_values);
+    RUN_TEST(test_reads_served_from_ram);
+    RUN_TEST(test_write_through_only_on_change);
+    RUN_TEST(test_multi_point_interpolation);
+    RUN_TEST(test_points_persist_and_merge);
+    RUN_TEST(test_corrupt_values_are_ignored);
+    RUN_TEST(test_power_api_uses_store);
+
+    return UNITY_END();
+}
@@ -0,0 +1,303 @@
+// Unit tests for the retained screen model and the transient message queue
+#include <unity.h>
+#include "../src/display/screen_model.h"
+#include "../src/sensors/storm_tracker.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using namespace Display;
+
+static uint16_t rev(const ScreenState& state, Section section) {
+    return state.getModel().getRevision(section);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_queue_orders_by_priority_then_arrival() {
+    MessageQueue queue;
+    queue.push("info", nullptr, MessagePriority::INFO, 100);
+    queue.push("status1", nullptr, MessagePriority::STATUS, 100);
+    queue.push("error", nullptr, MessagePriority::ERROR, 100);
+    queue.push("status2", nullptr, MessagePriority::STATUS, 100);
+    queue.push("warning", nullptr, MessagePriority::WARNING, 100);
+
+    const char* expected[] = {"error", "warning", "status1", "status2", "info"};
+    TransientMessage message;
+    for (const char* text : expected) {
+        TEST_ASSERT_TRUE(queue.pop(message));
+        TEST_ASSERT_EQUAL_STRING(text, message.line1);
+    }
+    TEST_ASSERT_FALSE(queue.pop(message));
+    TEST_ASSERT_EQUAL_UINT32(5, queue.getStats().shown);
+}
+
+void test_full_queue_evicts_least_important() {
+    MessageQueue queue;
+    for (size_t i = 0; i < MessageQueue::CAPACITY; i++) {
+        char text[8];
+        snprintf(text, sizeof(text), "s%u", (unsigned)i);
+        TEST_ASSERT_TRUE(queue.push(text, nullptr, i == 3 ? MessagePriority::INFO : MessagePriority::STATUS, 100));
+    }
+
+    // Another STATUS does not outrank queued STATUS messages, but the INFO goes
+    TEST_ASSERT_TRUE(queue.push("fail", nullptr, MessagePriority::ERROR, 100));
+    TEST_ASSERT_FALSE(queue.push("late", nullptr, MessagePriority::STATUS, 100));
+    TEST_ASSERT_FALSE(queue.push("info", nullptr, MessagePriority::INFO, 100));
+    TEST_ASSERT_EQUAL_UINT32(3, queue.getStats().dropped);
+    TEST_ASSERT_EQUAL_UINT32(MessageQueue::CAPACITY, queue.size());
+
+    TransientMessage message;
+    queue.pop(message);
+    TEST_ASSERT_EQUAL_STRING("fail", message.line1);
+    while (queue.pop(message)) {
+        TEST_ASSERT_TRUE(strcmp(message.line1, "s3") != 0);
+        TEST_ASSERT_TRUE(message.priority == MessagePriority::STATUS);
+    }
+}
+
+void test_messages_respect_hold_time_and_are_not_dropped() {
+    ScreenState state;
+    state.setRadio(true, 7, 125.0f, 915.0f);
+    state.update(0);
+    TEST_ASSERT_FALSE(state.getModel().header.message);
+    TEST_ASSERT_EQUAL_STRING("Sender", state.getModel().header.line1);
+
+    // Three messages inside 200 ms: the old oledMsg() kept only the first
+    state.showMessage("Preset", "LongFast", MessagePriority::STATUS, 1000);
+    state.update(10);
+    state.showMessage("Syncing...", "Sending config", MessagePriority::STATUS, 1000);
+    state.update(50);
+    state.showMessage("TX FAIL", "err -2", MessagePriority::ERROR, 3000);
+    state.update(120);
+
+    TEST_ASSERT_EQUAL_STRING("Preset", state.getModel().header.line1);  // Held for 1000 ms
+    state.update(1009);
+    TEST_ASSERT_EQUAL_STRING("Preset", state.getModel().header.line1);
+    state.update(1010);
+    TEST_ASSERT_EQUAL_STRING("TX FAIL", state.getModel().header.line1); // Error jumps the queue
+    TEST_ASSERT_TRUE(state.getModel().header.priority == MessagePriority::ERROR);
+    state.update(4009);
+    TEST_ASSERT_EQUAL_STRING("TX FAIL", state.getModel().header.line1);
+    state.update(4010);
+    TEST_ASSERT_EQUAL_STRING("Syncing...", state.getModel().header.line1);
+    state.update(5010);
+    TEST_ASSERT_FALSE(state.getModel().header.message);                 // Back to the resting header
+    TEST_ASSERT_EQUAL_STRING("Sender", state.getModel().header.line1);
+    TEST_ASSERT_EQUAL_STRING("Signal", state.getModel().header.line2);
+    TEST_ASSERT_EQUAL_UINT32(0, state.getMessages().getStats().dropped);
+}
+
+void test_progress_messages_update_in_place() {
+    ScreenState state;
+    state.update(0);
+    state.showMessage("OTA Update", "10%", MessagePriority::INFO);
+    state.update(1);
+    const uint16_t header = rev(state, Section::HEADER);
+
+    // Progress while showing: line2 changes, no new queue entries
+    state.showMessage("OTA Update", "20%", MessagePriority::INFO);
+    state.showMessage("OTA Update", "20%", MessagePriority::INFO);
+    TEST_ASSERT_EQUAL_STRING("20%", state.getModel().header.line2);
+    TEST_ASSERT_EQUAL_UINT16(header + 1, rev(state, Section::HEADER));
+    TEST_ASSERT_EQUAL_UINT32(0, state.getMessages().size());
+
+    // Progress behind another message: the queued entry is updated
+    state.showMessage("OTA Error", "Flash failed!", MessagePriority::ERROR);
+    state.update(5000);
+    TEST_ASSERT_EQUAL_STRING("OTA Error", state.getModel().header.line1);
+    state.showMessage("LoRa OTA", "40%", MessagePriority::INFO);
+    state.showMessage("LoRa OTA", "50%", MessagePriority::INFO);
+    TEST_ASSERT_EQUAL_UINT32(1, state.getMessages().size());
+    TEST_ASSERT_EQUAL_STRING("50%", state.getMessages().peek()->line2);
+}
+
+void test_default_hold_comes_from_priority() {
+    ScreenState state;
+    state.showMessage("WiFi", "Failed!", MessagePriority::ERROR);
+    state.update(0);
+    state.update(getDefaultScreenConfig().hold_ms[static_cast<size_t>(MessagePriority::ERROR)] - 1);
+    TEST_ASSERT_TRUE(state.getModel().header.message);
+    state.update(getDefaultScreenConfig().hold_ms[static_cast<size_t>(MessagePriority::ERROR)]);
+    TEST_ASSERT_FALSE(state.getModel().header.message);
+}
+
+void test_setters_bump_revision_only_on_visible_change() {
+    ScreenState state;
+    state.update(0);
+    TEST_ASSERT_FALSE(state.update(1));                                 // Nothing new
+
+    state.setSignal(-87.2f, 6.04f);
+    const uint16_t signal = rev(state, Section::SIGNAL);
+    TEST_ASSERT_TRUE(state.update(2));
+    state.setSignal(-86.8f, 5.96f);                                     // Still "-87" and "6.0"
+    TEST_ASSERT_EQUAL_UINT16(signal, rev(state, Section::SIGNAL));
+    TEST_ASSERT_FALSE(state.update(3));
+    state.setSignal(-80.0f, 6.0f);
+    TEST_ASSERT_EQUAL_UINT16(signal + 1, rev(state, Section::SIGNAL));
+
+    const uint16_t battery = rev(state, Section::BATTERY);
+    state.setBattery(80);
+    state.setBattery(80);
+    TEST_ASSERT_EQUAL_UINT16(battery + 1, rev(state, Section::BATTERY));
+
+    const uint16_t radio = rev(state, Section::RADIO);
+    const uint16_t header = rev(state, Section::HEADER);
+    state.setRadio(false, 9, 125.0f, 915.04f);
+    state.setRadio(false, 9, 125.0f, 914.96f);                          // Both "915.0"
+    TEST_ASSERT_EQUAL_UINT16(radio + 1, rev(state, Section::RADIO));
+    TEST_ASSERT_EQUAL_UINT16(header, rev(state, Section::HEADER));      // Role unchanged
+
+    const uint16_t ping = rev(state, Section::PING);
+    state.setPing(true, false);
+    state.setPing(true, false);
+    state.setPing(false, true);                                         // Full screen needs the dot
+    TEST_ASSERT_EQUAL_UINT16(ping + 2, rev(state, Section::PING));
+    TEST_ASSERT_FALSE(state.getModel().ping.full_screen);
+}
+
+void test_node_table_orders_ages_and_expires() {
+    ScreenConfig config = getDefaultScreenConfig();
+    config.node_timeout_ms = 60000;
+    ScreenState state(config);
+
+    for (uint16_t id = 1; id <= MAX_NODES + 2; id++) {
+        state.updateNode(id, -60.0f - id, 5.0f, id * 1000);
+    }
+    const ScreenModel& model = state.getModel();
+    TEST_ASSERT_EQUAL_UINT8(MAX_NODES, model.nodes.count);
+    TEST_ASSERT_EQUAL_UINT16(MAX_NODES + 2, model.nodes.entries[0].id);   // Most recent first
+    TEST_ASSERT_EQUAL_UINT16(3, model.nodes.entries[MAX_NODES - 1].id);   // 1 and 2 evicted
+
+    state.updateNode(5, -50.0f, 7.5f, 9000);
+    TEST_ASSERT_EQUAL_UINT16(5, model.nodes.entries[0].id);
+    TEST_ASSERT_EQUAL_INT16(-50, model.nodes.entries[0].rssi_dbm);
+    TEST_ASSERT_EQUAL_INT16(75, model.nodes.entries[0].snr_x10);
+    TEST_ASSERT_EQUAL_UINT16(2, model.nodes.entries[0].packets);
+
+    // Ages tick in whole seconds; the revision moves once per second, not per update
+    state.update(9000);
+    const uint16_t nodes = rev(state, Section::NODES);
+    state.update(9500);
+    TEST_ASSERT_EQUAL_UINT16(nodes, rev(state, Section::NODES));
+    state.update(10000);
+    TEST_ASSERT_EQUAL_UINT16(nodes + 1, rev(state, Section::NODES));
+    TEST_ASSERT_EQUAL_UINT16(1, model.nodes.entries[0].age_s);
+
+    // Everything but node 5 was last heard at <= 8 s
+    state.update(68500);
+    TEST_ASSERT_EQUAL_UINT8(1, model.nodes.count);
+    TEST_ASSERT_EQUAL_UINT16(5, model.nodes.entries[0].id);
+}
+
+void test_screens_rotate_over_enabled_set() {
+    ScreenConfig config = getDefaultScreenConfig();
+    config.rotate_interval_ms = 5000;
+    ScreenState state(config);
+    state.setEnabledScreens((1u << static_cast<uint8_t>(Screen::SIGNAL)) |
+                            (1u << static_cast<uint8_t>(Screen::STORM)));
+    state.update(0);
+    TEST_ASSERT_TRUE(state.getModel().screen == Screen::SIGNAL);
+
+    state.update(5000);
+    TEST_ASSERT_TRUE(state.getModel().screen == Screen::STORM);
+    TEST_ASSERT_EQUAL_STRING("Storm", state.getModel().header.line2);
+    state.update(10000);
+    TEST_ASSERT_TRUE(state.getModel().screen == Screen::SIGNAL);
+
+    // A message is not interrupted by a screen switch
+    state.showMessage("OTA", "Starting...", MessagePriority::STATUS, 8000);
+    state.update(10001);
+    state.update(15001);
+    TEST_ASSERT_TRUE(state.getModel().screen == Screen::STORM);
+    TEST_ASSERT_EQUAL_STRING("OTA", state.getModel().header.line1);
+}
+
+void test_storm_and_network_quantization() {
+    ScreenState state;
+    Sensors::StormSummary summary;
+    memset(&summary, 0, sizeof(summary));
+    summary.active = true;
+    summary.strikes = 12;
+    summary.distance_km = 14.4f;
+    summary.rate_1min = 3.04f;
+    summary.eta_min = 22.6f;
+    summary.motion = Sensors::StormMotion::APPROACHING;
+    state.setStorm(summary);
+
+    const ScreenModel& model = state.getModel();
+    TEST_ASSERT_EQUAL_UINT8(14, model.storm.distance_km);
+    TEST_ASSERT_EQUAL_UINT16(30, model.storm.rate_x10);
+    TEST_ASSERT_EQUAL_INT16(23, model.storm.eta_min);
+
+    const uint16_t storm = rev(state, Section::STORM);
+    summary.distance_km = 14.1f;
+    summary.rate_1min = 2.99f;
+    state.setStorm(summary);
+    TEST_ASSERT_EQUAL_UINT16(storm, rev(state, Section::STORM));
+    summary.distance_km = 80.0f;
+    summary.eta_min = -1.0f;
+    state.setStorm(summary);
+    TEST_ASSERT_EQUAL_UINT8(Sensors::STORM_OUT_OF_RANGE_KM, model.storm.distance_km);
+    TEST_ASSERT_EQUAL_INT16(-1, model.storm.eta_min);
+
+    // 15-character address scrolls through the 12 visible characters and wraps
+    const uint8_t ip[4] = {192, 168, 100, 200};
+    state.setNetwork(true, ip, "Home", false, false);
+    state.update(0);
+    const uint16_t network = rev(state, Section::NETWORK);
+    state.update(299);
+    TEST_ASSERT_EQUAL_UINT16(network, rev(state, Section::NETWORK));
+    uint8_t offsets[5];
+    for (int i = 0; i < 5; i++) {
+        state.update(300 * (i + 1));
+        offsets[i] = model.network.scroll;
+    }
+    TEST_ASSERT_EQUAL_UINT8(1, offsets[0]);
+    TEST_ASSERT_EQUAL_UINT8(3, offsets[2]);
+    TEST_ASSERT_EQUAL_UINT8(0, offsets[3]);
+    state.setNetwork(true, ip, "Home", false, false);
+    TEST_ASSERT_EQUAL_UINT8(1, model.network.scroll);                   // Same address keeps scrolling
+}
+
+void test_benchmark_steady_state_update() {
+    ScreenState state;
+    state.setRadio(false, 9, 125.0f, 915.0f);
+    state.update(0);
+
+    // A receiver loop: signal jitter below display resolution, periodic updates
+    const int rounds = 1000000;
+    uint32_t posts = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        state.setSignal(-87.0f + (i % 3) * 0.1f, 6.0f);
+        state.setRadio(false, 9, 125.0f, 915.0f);
+        state.setBattery(80);
+        posts += state.update(static_cast<uint32_t>(i / 10)) ? 1 : 0;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / rounds;
+    printf("screen state: %.1f ns per set+update (host), %lu of %d updates needed a post\n", ns,
+           (unsigned long)posts, rounds);
+    TEST_ASSERT_TRUE(posts <= 2);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_queue_orders_by_priority_then_arrival);
+    RUN_TEST(test_full_queue_evicts_least_important);
+    RUN_TEST(test_messages_respect_hold_time_and_are_not_dropped);
+    RUN_TEST(test_progress_messages_update_in_place);
+    RUN_TEST(test_default_hold_comes_from_priority);
+    RUN_TEST(test_setters_bump_revision_only_on_visible_change);
+    RUN_TEST(test_node_table_orders_ages_and_expires);
+    RUN_TEST(test_screens_rotate_over_enabled_set);
+    RUN_TEST(test_storm_and_network_quantization);
+    RUN_TEST(test_benchmark_steady_state_update);
+
+    return UNITY_END();
+}
@@ -0,0 +1,324 @@
+// Golden-image and render-cost tests for the screen renderer on the headless U8g2
+#include <unity.h>
+#include <U8g2lib.h>
+#include "../src/display/screen_renderer.h"
+#include "../src/display/dirty_tile_renderer.h"
+#include "../src/sensors/storm_tracker.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace Display;
+
+// Snapshots live next to the tests; run with UPDATE_GOLDEN=1 to rewrite them
+// after an intended layout change and review the diff like any other
+#ifndef GOLDEN_DIR
+#define GOLDEN_DIR "test/golden"
+#endif
+
+static const uint8_t TEST_IP[4] = {192, 168, 1, 42};
+
+class PanelSink : public TileSink {
+public:
+    explicit PanelSink(U8G2& u8g2) : m_u8g2(u8g2) {}
+    void sendTiles(uint8_t tx, uint8_t ty, uint8_t tw, const uint8_t*) override {
+        m_u8g2.updateDisplayArea(tx, ty, tw, 1);
+    }
+
+private:
+    U8G2& m_u8g2;
+};
+
+static ScreenConfig makeConfig() {
+    ScreenConfig config = getDefaultScreenConfig();
+    config.rotate_interval_ms = 0;
+    return config;
+}
+
+// Receiver on the signal screen with WiFi up and a packet heard
+static void populate(ScreenState& state, bool sender = false) {
+    state.setRadio(sender, 9, 125.0f, 915.0f);
+    if (!sender) {
+        state.setSignal(-87.4f, 7.25f);
+    }
+    state.setNetwork(true, TEST_IP, "Home", false, false);
+    state.setBattery(78);
+    state.update(1000);
+}
+
+static Sensors::StormSummary makeStorm() {
+    Sensors::StormSummary storm;
+    memset(&storm, 0, sizeof(storm));
+    storm.active = true;
+    storm.strikes = 42;
+    storm.rate_1min = 3.4f;
+    storm.distance_km = 17.0f;
+    storm.motion = Sensors::StormMotion::APPROACHING;
+    storm.eta_min = 25.0f;
+    return storm;
+}
+
+static std::string readFile(const std::string& path) {
+    std::string data;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (!file) {
+        return data;
+    }
+    char chunk[512];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        data.append(chunk, n);
+    }
+    fclose(file);
+    return data;
+}
+
+static void assertGolden(const U8G2& u8g2, const char* name) {
+    const std::string path = std::string(GOLDEN_DIR) + "/" + name + ".pbm";
+    const std::string actual = u8g2.toPBM();
+
+    if (getenv("UPDATE_GOLDEN")) {
+        TEST_ASSERT_TRUE_MESSAGE(u8g2.writePBM(path.c_str()), path.c_str());
+        return;
+    }
+
+    const std::string golden = readFile(path);
+    if (golden == actual) {
+        return;
+    }
+
+    // Leave the rendering next to the golden for a side-by-side look
+    const std::string actualPath = std::string(GOLDEN_DIR) + "/" + name + ".actual.pbm";
+    u8g2.writePBM(actualPath.c_str());
+
+    char message[160];
+    if (golden.empty()) {
+        snprintf(message, sizeof(message), "%s missing; UPDATE_GOLDEN=1 creates it", path.c_str());
+    } else {
+        size_t differing = golden.size() == actual.size() ? 0 : actual.size();
+        for (size_t i = 0; i < golden.size() && i < actual.size(); i++) {
+            if (golden[i] != actual[i]) {
+                differing++;
+            }
+        }
+        snprintf(message, sizeof(message), "%s: %u pixels differ, see %s", path.c_str(), (unsigned)differing,
+                 actualPath.c_str());
+    }
+    TEST_FAIL_MESSAGE(message);
+}
+
+static void renderGolden(const ScreenState& state, const char* name) {
+    U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R1);
+    ScreenRenderer renderer(u8g2);
+    renderer.draw(state.getModel());
+    TEST_ASSERT_EQUAL_INT(64, u8g2.getDisplayWidth());
+    assertGolden(u8g2, name);
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_receiver_signal_screen_matches_golden() {
+    ScreenState state(makeConfig());
+    populate(state);
+    renderGolden(state, "screen_signal_receiver");
+}
+
+void test_sender_signal_screen_matches_golden() {
+    ScreenState state(makeConfig());
+    populate(state, true);
+    state.setPing(true, false);
+    state.update(1100);
+    renderGolden(state, "screen_signal_sender");
+}
+
+void test_network_screen_matches_golden() {
+    ScreenState state(makeConfig());
+    populate(state);
+    state.setScreen(Screen::NETWORK);
+    state.setNetwork(true, TEST_IP, "Home", true, false);
+    state.update(1100);
+    renderGolden(state, "screen_network");
+}
+
+void test_nodes_screen_matches_golden() {
+    ScreenState state(makeConfig());
+    populate(state);
+    state.setScreen(Screen::NODES);
+    state.updateNode(0x1A2B, -71.0f, 9.5f, 1000);
+    state.updateNode(0x00C4, -104.0f, -6.0f, 40000);
+    state.updateNode(0xBEEF, -92.0f, 1.0f, 200000);
+    state.update(260000);
+    renderGolden(state, "screen_nodes");
+}
+
+void test_storm_screen_matches_golden() {
+    ScreenState state(makeConfig());
+    populate(state);
+    state.setScreen(Screen::STORM);
+    state.setStorm(makeStorm());
+    state.update(1100);
+    renderGolden(state, "screen_storm");
+}
+
+void test_warning_header_matches_golden() {
+    ScreenState state(makeConfig());
+    populate(state);
+    state.setPing(true, false);
+    state.showMessage("Low battery", "3.41V", MessagePriority::WARNING);
+    state.update(1100);
+    renderGolden(state, "screen_warning");
+}
+
+void test_full_screen_ping_matches_golden() {
+    ScreenState state(makeConfig());
+    populate(state);
+    state.setPing(true, true);
+    state.update(1100);
+    renderGolden(state, "screen_ping_full");
+}
+
+// Region repaints must leave exactly the frame a full redraw would produce
+void test_incremental_frames_match_full_redraw() {
+    U8G2_SSD1306_128X64_NONAME_F_HW_I2C incremental(U8G2_R1);
+    U8G2_SSD1306_128X64_NONAME_F_HW_I2C reference(U8G2_R1);
+    ScreenRenderer incrementalRenderer(incremental);
+    ScreenRenderer referenceRenderer(reference);
+
+    ScreenState state(makeConfig());
+    populate(state);
+    uint32_t now = 1000;
+
+    auto check = [&](const char* step) {
+        state.update(now);
+        incrementalRenderer.draw(state.getModel());
+        referenceRenderer.invalidate();
+        referenceRenderer.draw(state.getModel());
+        TEST_ASSERT_TRUE_MESSAGE(
+            memcmp(reference.getBufferPtr(), incremental.getBufferPtr(), U8G2::BUFFER_BYTES) == 0, step);
+        now += 100;
+    };
+
+    check("initial");
+    state.setSignal(-101.0f, -3.5f);
+    check("rssi");
+    state.setPing(true, false);
+    check("ping dot on");
+    state.setPing(false, false);
+    check("ping dot off");
+    state.showMessage("RX FAIL", "-7", MessagePriority::ERROR);
+    check("error message");
+    now += 10000;
+    check("message expired");
+    state.setBattery(9);
+    check("battery");
+    state.setNetwork(false, TEST_IP, "", false, true);
+    check("wifi down");
+    state.setPing(true, true);
+    check("full-screen ping");
+    state.setPing(false, false);
+    check("back from ping");
+    state.setScreen(Screen::NODES);
+    check("nodes screen");
+    state.updateNode(0x0042, -80.0f, 4.0f, now);
+    check("node heard");
+    state.setScreen(Screen::STORM);
+    check("storm screen");
+    state.setStorm(makeStorm());
+    check("storm update");
+    state.setScreen(Screen::SIGNAL);
+    state.setRadio(false, 12, 62.5f, 868.1f);
+    check("radio change");
+
+    TEST_ASSERT_TRUE(incrementalRenderer.getStats().regions_skipped > 0);
+}
+
+// Deterministic cost check: an RSSI update repaints one region and sends a
+// handful of tiles, not the frame
+void test_rssi_update_touches_few_tiles() {
+    U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R1);
+    ScreenRenderer renderer(u8g2);
+    PanelSink sink(u8g2);
+    DirtyTileRenderer tiles;
+    tiles.attach(u8g2.getBufferPtr(), &sink);
+
+    ScreenState state(makeConfig());
+    populate(state);
+    renderer.draw(state.getModel());
+    tiles.flush();
+    const uint32_t fullPixels = u8g2.pixelWrites();
+    TEST_ASSERT_EQUAL_UINT32(TILE_COLUMNS * TILE_ROWS, u8g2.tilesUpdated());
+
+    u8g2.clearCounters();
+    renderer.resetStats();
+    state.setSignal(-90.0f, 7.25f);
+    state.update(1100);
+    renderer.draw(state.getModel());
+    tiles.flush();
+
+    TEST_ASSERT_EQUAL_UINT32(1, renderer.getStats().regions_drawn);
+    TEST_ASSERT_TRUE(u8g2.pixelWrites() < fullPixels / 2);
+    TEST_ASSERT_TRUE(u8g2.tilesUpdated() <= 8);
+}
+
+void test_benchmark_render_per_screen() {
+    const Screen screens[] = {Screen::SIGNAL, Screen::NETWORK, Screen::NODES, Screen::STORM};
+    const int rounds = 2000;
+
+    for (Screen screen : screens) {
+        U8G2_SSD1306_128X64_NONAME_F_HW_I2C u8g2(U8G2_R1);
+        ScreenRenderer renderer(u8g2);
+        ScreenState state(makeConfig());
+        populate(state);
+        state.setScreen(screen);
+        state.updateNode(0x1A2B, -71.0f, 9.5f, 1000);
+        state.setStorm(makeStorm());
+        state.update(1100);
+
+        u8g2.clearCounters();
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            renderer.invalidate();
+            renderer.draw(state.getModel());
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        const uint32_t fullPixels = u8g2.pixelWrites() / rounds;
+
+        // Steady state: the battery figure is the one value every screen shows
+        u8g2.clearCounters();
+        auto t2 = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            state.setBattery(static_cast<uint8_t>(50 + (i & 1)));
+            state.update(1200);
+            renderer.draw(state.getModel());
+        }
+        auto t3 = std::chrono::steady_clock::now();
+        const uint32_t updatePixels = u8g2.pixelWrites() / rounds;
+
+        const double fullUs = std::chrono::duration<double, std::micro>(t1 - t0).count() / rounds;
+        const double updateUs = std::chrono::duration<double, std::micro>(t3 - t2).count() / rounds;
+        printf("render %-8s full %6.2f us / %5lu px, battery update %6.2f us / %5lu px (host)\n",
+               screenToString(screen), fullUs, (unsigned long)fullPixels, updateUs, (unsigned long)updatePixels);
+        TEST_ASSERT_TRUE(updatePixels < fullPixels);
+    }
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_receiver_signal_screen_matches_golden);
+    RUN_TEST(test_sender_signal_screen_matches_golden);
+    RUN_TEST(test_network_screen_matches_golden);
+    RUN_TEST(test_nodes_screen_matches_golden);
+    RUN_TEST(test_storm_screen_matches_golden);
+    RUN_TEST(test_warning_header_matches_golden);
+    RUN_TEST(test_full_screen_ping_matches_golden);
+    RUN_TEST(test_incremental_frames_match_full_redraw);
+    RUN_TEST(test_rssi_update_touches_few_tiles);
+    RUN_TEST(test_benchmark_render_per_screen);
+
+    return UNITY_END();
+}
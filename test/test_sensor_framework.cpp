@@ -1,15 +1,30 @@
-// Simplified tests for the sensor framework (header-only testing)
+// Tests for the sensor framework and the deadline-scheduled sensor manager
 #include <unity.h>
 #include "../src/sensors/sensor_interface.h"
+#include "../src/hardware/hardware_abstraction.h"
 #include <cstring>
 
+using namespace HardwareAbstraction;
+using SensorSystem::SensorManager;
+
 // Unity test setup and teardown functions
 void setUp(void) {
-    // Initialize before each test
+    Simulation::reset();
+    Simulation::setMicros(0);
 }
 
 void tearDown(void) {
-    // Clean up after each test
+    // The manager is a singleton: leave it empty for the next test
+    // (test sensors are static so they outlive their test function)
+    SensorManager& manager = SensorManager::getInstance();
+    const char* ids[8];
+    size_t count = 0;
+    manager.getSensorList(ids, 8, count);
+    for (size_t i = 0; i < count; i++) {
+        manager.unregisterSensor(ids[i]);
+    }
+    manager.setGlobalReadingCallback(nullptr);
+    manager.setGlobalErrorCallback(nullptr);
 }
 
 // Mock delay function
@@ -70,29 +85,29 @@ void test_reading_structure() {
 }
 
 void test_reading_utility_functions() {
-    // Test reading utility function declarations (these will be implemented later)
-    // For now, we just verify the functions exist in the header
-
-    // These functions are declared but not implemented yet:
-    // - createBoolReading()
-    // - createIntReading()
-    // - createFloatReading()
-    // - createStringReading()
-    // - createErrorReading()
-
-    // This test will pass as long as the header compiles
-    TEST_ASSERT_TRUE(true);
+    Simulation::setMicros(42000);
+    const SensorSystem::Reading f = SensorSystem::createFloatReading("battery", 3.7f, "V");
+    TEST_ASSERT_EQUAL_INT((int)SensorSystem::DataType::FLOAT, (int)f.type);
+    TEST_ASSERT_EQUAL_FLOAT(3.7f, f.value.floatValue);
+    TEST_ASSERT_EQUAL_STRING("V", f.unit);
+    TEST_ASSERT_EQUAL_UINT32(42, f.timestamp);
+    TEST_ASSERT_TRUE(f.isValid);
+
+    TEST_ASSERT_EQUAL_INT32(-5, SensorSystem::createIntReading("rssi", -5).value.intValue);
+    TEST_ASSERT_TRUE(SensorSystem::createBoolReading("irq", true).value.boolValue);
+    TEST_ASSERT_EQUAL_STRING("ok", SensorSystem::createStringReading("status", "ok").value.stringValue);
+
+    const SensorSystem::Reading e = SensorSystem::createErrorReading("lightning", 7);
+    TEST_ASSERT_FALSE(e.isValid);
+    TEST_ASSERT_EQUAL_UINT32(7, e.errorCode);
 }
 
 void test_capability_management() {
-    // Test capability checking function declaration (this will be implemented later)
-    // For now, we just verify the function exists in the header
-
-    // This function is declared but not implemented yet:
-    // - hasCapability()
-
-    // This test will pass as long as the header compiles
-    TEST_ASSERT_TRUE(true);
+    const uint16_t caps = (uint16_t)SensorSystem::Capability::INTERRUPT_CAPABLE |
+                          (uint16_t)SensorSystem::Capability::CALIBRATION;
+    TEST_ASSERT_TRUE(SensorSystem::hasCapability(caps, SensorSystem::Capability::INTERRUPT_CAPABLE));
+    TEST_ASSERT_TRUE(SensorSystem::hasCapability(caps, SensorSystem::Capability::CALIBRATION));
+    TEST_ASSERT_FALSE(SensorSystem::hasCapability(caps, SensorSystem::Capability::SELF_TEST));
 }
 
 void test_sensor_interface_declaration() {
@@ -107,15 +122,225 @@ void test_sensor_interface_declaration() {
     TEST_ASSERT_TRUE(true);
 }
 
-void test_sensor_manager_declaration() {
-    // Test that SensorManager class is properly declared
-    // This class is declared but not implemented yet
+// Scriptable sensor: counts calls, burns simulated time in update()
+class FakeSensor : public SensorSystem::ISensor {
+public:
+    FakeSensor(const char* id, uint16_t caps = 0) : id_(id), caps_(caps) {}
+
+    uint32_t updates = 0;
+    uint32_t updateCostUs = 0;
+    bool produceData = true;
+    bool failRead = false;
+    uint32_t resets = 0;
+    SensorSystem::State state = SensorSystem::State::READY;
+
+    bool initialize() override { state = SensorSystem::State::READY; return true; }
+    bool deinitialize() override { state = SensorSystem::State::DISABLED; return true; }
+    SensorSystem::State getState() const override { return state; }
+    const char* getId() const override { return id_; }
+    const char* getName() const override { return id_; }
+    uint16_t getCapabilities() const override { return caps_; }
+
+    bool readSensor(SensorSystem::Reading& reading) override {
+        if (failRead) {
+            return false;
+        }
+        reading = SensorSystem::createIntReading(id_, (int32_t)updates);
+        return true;
+    }
+    bool hasNewData() const override { return produceData; }
+    uint32_t getReadingCount() const override { return updates; }
+
+    bool setParameter(const char*, const void*, size_t) override { return false; }
+    bool getParameter(const char*, void*, size_t&) const override { return false; }
+    bool calibrate() override { return false; }
+    bool selfTest() override { return true; }
+    bool sleep() override { return true; }
+    bool wakeup() override { return true; }
+    bool reset() override { resets++; return true; }
+
+    void setReadingCallback(SensorSystem::ReadingCallback) override {}
+    void setErrorCallback(SensorSystem::ErrorCallback) override {}
+    void setStateChangeCallback(SensorSystem::StateChangeCallback) override {}
+
+    void update() override {
+        updates++;
+        Simulation::advanceMicros(updateCostUs);
+    }
+    uint32_t getLastError() const override { return failRead ? 99 : 0; }
+    const char* getErrorString(uint32_t) const override { return ""; }
+
+private:
+    const char* id_;
+    uint16_t caps_;
+};
+
+static const uint16_t IRQ_CAP = (uint16_t)SensorSystem::Capability::INTERRUPT_CAPABLE;
+
+void test_sensor_manager_registration() {
+    SensorManager& manager = SensorManager::getInstance();
+    static FakeSensor a("a"), dup("a");
+    TEST_ASSERT_TRUE(manager.registerSensor(&a));
+    TEST_ASSERT_FALSE(manager.registerSensor(&dup));
+    TEST_ASSERT_FALSE(manager.registerSensor(nullptr));
+    TEST_ASSERT_TRUE(manager.getSensor("a") == &a);
+
+    static FakeSensor extra[8] = {FakeSensor("b"), FakeSensor("c"), FakeSensor("d"), FakeSensor("e"),
+                                  FakeSensor("f"), FakeSensor("g"), FakeSensor("h"), FakeSensor("i")};
+    for (int i = 0; i < 7; i++) {
+        TEST_ASSERT_TRUE(manager.registerSensor(&extra[i]));
+    }
+    TEST_ASSERT_FALSE(manager.registerSensor(&extra[7]));        // Full at 8
+    TEST_ASSERT_EQUAL_UINT(8, manager.getSensorCount());
+
+    // A freed slot is reused and the heap stays consistent
+    TEST_ASSERT_TRUE(manager.unregisterSensor("d"));
+    TEST_ASSERT_FALSE(manager.unregisterSensor("d"));
+    TEST_ASSERT_TRUE(manager.registerSensor(&extra[7]));
+    manager.updateAll();
+    for (int i = 0; i < 8; i++) {
+        TEST_ASSERT_EQUAL_UINT32(i == 2 ? 0 : 1, extra[i].updates);
+    }
+}
+
+void test_sensor_manager_polls_only_due_sensors() {
+    SensorManager& manager = SensorManager::getInstance();
+    static FakeSensor fast("fast"), medium("medium"), slow("slow");
+    manager.registerSensor(&fast, 10);
+    manager.registerSensor(&medium, 25);
+    manager.registerSensor(&slow, 100);
+
+    // One updateAll() per millisecond for one second
+    for (uint32_t ms = 0; ms < 1000; ms++) {
+        Simulation::setMicros(ms * 1000);
+        manager.updateAll();
+    }
+    TEST_ASSERT_EQUAL_UINT32(100, fast.updates);
+    TEST_ASSERT_EQUAL_UINT32(40, medium.updates);
+    TEST_ASSERT_EQUAL_UINT32(10, slow.updates);
+    // A poll-everything loop would have made 3000 update() calls
+
+    SensorSystem::SensorStats stats;
+    TEST_ASSERT_TRUE(manager.getStats("medium", stats));
+    TEST_ASSERT_EQUAL_UINT32(25, stats.pollPeriodMs);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.overruns);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.maxLatenessMs);
+
+    Simulation::setMicros(997000);
+    TEST_ASSERT_EQUAL_UINT32(3, manager.getTimeUntilNextPoll());   // fast is next at 1000
+
+    // Changing the period re-anchors on the last run
+    TEST_ASSERT_TRUE(manager.setPollPeriod("slow", 5));
+    TEST_ASSERT_EQUAL_UINT32(0, manager.getTimeUntilNextPoll());   // 900 + 5 is overdue
+    TEST_ASSERT_FALSE(manager.setPollPeriod("slow", 0));
+}
 
-    // Test that the class exists and has the right methods declared
-    // The actual implementation will be provided later
+void test_sensor_manager_interrupt_sensor_waits_for_irq() {
+    SensorManager& manager = SensorManager::getInstance();
+    static FakeSensor lightning("lightning", IRQ_CAP);
+    manager.registerSensor(&lightning, 10);
+
+    for (uint32_t ms = 0; ms < 200; ms++) {
+        Simulation::setMicros(ms * 1000);
+        manager.updateAll();
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, lightning.updates);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, manager.getTimeUntilNextPoll());
+    TEST_ASSERT_FALSE(manager.setPollPeriod("lightning", 10));
+
+    TEST_ASSERT_TRUE(manager.notifyInterrupt(&lightning));
+    manager.updateAll();
+    manager.updateAll();
+    TEST_ASSERT_EQUAL_UINT32(1, lightning.updates);
+
+    SensorSystem::SensorStats stats;
+    manager.getStats("lightning", stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.pollPeriodMs);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.interrupts);
+
+    static FakeSensor stranger("stranger");
+    TEST_ASSERT_FALSE(manager.notifyInterrupt(&stranger));
+}
 
-    // This test will pass as long as the header compiles
-    TEST_ASSERT_TRUE(true);
+void test_sensor_manager_latency_and_overruns() {
+    SensorManager& manager = SensorManager::getInstance();
+    static FakeSensor adc("adc");
+    adc.updateCostUs = 1500;
+    manager.registerSensor(&adc, 10);
+
+    manager.updateAll();                                // t = 0
+    SensorSystem::SensorStats stats;
+    manager.getStats("adc", stats);
+    TEST_ASSERT_EQUAL_UINT32(1500, stats.lastLatencyUs);
+    TEST_ASSERT_EQUAL_UINT32(1500, stats.maxLatencyUs);
+
+    // The loop stalls for 35 ms: one overrun, and no burst of catch-up polls
+    Simulation::setMicros(35000);
+    manager.updateAll();
+    manager.updateAll();
+    TEST_ASSERT_EQUAL_UINT32(2, adc.updates);
+    manager.getStats("adc", stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.overruns);
+    TEST_ASSERT_EQUAL_UINT32(25, stats.maxLatenessMs);
+    TEST_ASSERT_EQUAL_UINT32(9, manager.getTimeUntilNextPoll());    // Due at 45; update() ran the clock to 36.5
+
+    // Slightly late polls keep the period grid and are not overruns
+    adc.updateCostUs = 500;
+    Simulation::setMicros(48000);
+    manager.updateAll();
+    manager.getStats("adc", stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.overruns);
+    TEST_ASSERT_EQUAL_UINT32(1500, stats.maxLatencyUs);
+    TEST_ASSERT_EQUAL_UINT32(1166, stats.avgLatencyUs);
+    TEST_ASSERT_EQUAL_UINT32(7, manager.getTimeUntilNextPoll());        // 55, not 58
+}
+
+static uint32_t s_callbackReadings = 0;
+static uint32_t s_callbackErrors = 0;
+
+void test_sensor_manager_readings_errors_and_health() {
+    SensorManager& manager = SensorManager::getInstance();
+    static FakeSensor good("good"), flaky("flaky");
+    flaky.failRead = true;
+    manager.registerSensor(&good, 10);
+    manager.registerSensor(&flaky, 10);
+    s_callbackReadings = 0;
+    s_callbackErrors = 0;
+    manager.setGlobalReadingCallback([](const SensorSystem::Reading&) { s_callbackReadings++; });
+    manager.setGlobalErrorCallback([](const char*, uint32_t code) {
+        TEST_ASSERT_EQUAL_UINT32(99, code);
+        s_callbackErrors++;
+    });
+
+    for (uint32_t ms = 0; ms < 50; ms++) {
+        Simulation::setMicros(ms * 1000);
+        manager.updateAll();
+    }
+    TEST_ASSERT_EQUAL_UINT32(5, s_callbackReadings);
+    TEST_ASSERT_EQUAL_UINT32(5, s_callbackErrors);
+
+    SensorSystem::Reading reading;
+    TEST_ASSERT_TRUE(manager.getReading("good", reading));
+    TEST_ASSERT_EQUAL_INT32(5, reading.value.intValue);
+    TEST_ASSERT_FALSE(manager.getReading("flaky", reading));
+
+    SensorSystem::Reading all[4];
+    size_t count = 0;
+    TEST_ASSERT_TRUE(manager.getReadings(all, 4, count));
+    TEST_ASSERT_EQUAL_UINT(1, count);
+
+    // Five consecutive failures: the health check resets the sensor
+    TEST_ASSERT_FALSE(manager.performHealthCheck());
+    TEST_ASSERT_EQUAL_UINT32(1, flaky.resets);
+    flaky.failRead = false;
+    TEST_ASSERT_TRUE(manager.performHealthCheck());
+
+    // A sensor in ERROR is skipped by the scheduler
+    good.state = SensorSystem::State::ERROR;
+    const uint32_t before = good.updates;
+    Simulation::setMicros(60000);
+    manager.updateAll();
+    TEST_ASSERT_EQUAL_UINT32(before, good.updates);
 }
 
 void test_callback_types() {
@@ -130,15 +355,10 @@ void test_callback_types() {
 }
 
 void test_utility_functions() {
-    // Test utility function declarations (these will be implemented later)
-    // For now, we just verify the functions exist in the header
-
-    // These functions are declared but not implemented yet:
-    // - stateToString()
-    // - dataTypeToString()
-
-    // This test will pass as long as the header compiles
-    TEST_ASSERT_TRUE(true);
+    TEST_ASSERT_EQUAL_STRING("READY", SensorSystem::stateToString(SensorSystem::State::READY));
+    TEST_ASSERT_EQUAL_STRING("ERROR", SensorSystem::stateToString(SensorSystem::State::ERROR));
+    TEST_ASSERT_EQUAL_STRING("FLOAT", SensorSystem::dataTypeToString(SensorSystem::DataType::FLOAT));
+    TEST_ASSERT_EQUAL_STRING("BINARY", SensorSystem::dataTypeToString(SensorSystem::DataType::BINARY));
 }
 
 int main(int argc, char **argv) {
@@ -152,9 +372,15 @@ int main(int argc, char **argv) {
 
     // Interface and class declaration tests
     RUN_TEST(test_sensor_interface_declaration);
-    RUN_TEST(test_sensor_manager_declaration);
     RUN_TEST(test_callback_types);
 
+    // Sensor manager scheduling
+    RUN_TEST(test_sensor_manager_registration);
+    RUN_TEST(test_sensor_manager_polls_only_due_sensors);
+    RUN_TEST(test_sensor_manager_interrupt_sensor_waits_for_irq);
+    RUN_TEST(test_sensor_manager_latency_and_overruns);
+    RUN_TEST(test_sensor_manager_readings_errors_and_health);
+
     // Utility tests
     RUN_TEST(test_utility_functions);
 
@@ -0,0 +1,293 @@
+// Unit tests for the storm tracker against synthetic AS3935 strike sequences
+#include <unity.h>
+#include "../src/sensors/storm_tracker.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace Sensors;
+
+static constexpr uint32_t MINUTE_MS = 60000;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Deterministic draws (xorshift32)
+static uint32_t s_seed = 1;
+static void seed(uint32_t n) {
+    s_seed = (n + 1) * 0x9E3779B9u;
+}
+static float uniform() {
+    s_seed ^= s_seed << 13;
+    s_seed ^= s_seed >> 17;
+    s_seed ^= s_seed << 5;
+    return (s_seed >> 8) / 16777216.0f;
+}
+
+// AS3935 reports distance in these bins only
+static const uint8_t DISTANCE_BINS[] = {1, 5, 6, 8, 10, 12, 14, 17, 20, 24, 27, 31, 34, 37, 40};
+static constexpr size_t BIN_COUNT = sizeof(DISTANCE_BINS) / sizeof(DISTANCE_BINS[0]);
+
+static uint8_t quantize(float km) {
+    if (km > 40.0f) {
+        return STORM_OUT_OF_RANGE_KM;
+    }
+    uint8_t best = DISTANCE_BINS[0];
+    for (size_t i = 1; i < BIN_COUNT; i++) {
+        if (fabsf(DISTANCE_BINS[i] - km) < fabsf(best - km)) {
+            best = DISTANCE_BINS[i];
+        }
+    }
+    return best;
+}
+
+// Storm cell moving at speed_kmh (positive = closing); strikes scatter +-3 km
+// around the cell, outlier_p of them land in a random bin. Returns the last strike time.
+static uint32_t runStorm(StormTracker& tracker, uint32_t start_ms, uint32_t duration_ms, float start_km,
+                         float speed_kmh, float strikes_per_min, float outlier_p) {
+    uint32_t t = start_ms;
+    const uint32_t mean_gap_ms = static_cast<uint32_t>(MINUTE_MS / strikes_per_min);
+    while (t - start_ms < duration_ms) {
+        t += static_cast<uint32_t>(mean_gap_ms * (0.5f + uniform()));
+        const float hours = (t - start_ms) / 3600000.0f;
+        const float cell_km = start_km - speed_kmh * hours;
+        uint8_t reported = quantize(fmaxf(0.0f, cell_km + 6.0f * (uniform() - 0.5f)));
+        if (uniform() < outlier_p) {
+            reported = DISTANCE_BINS[static_cast<size_t>(uniform() * BIN_COUNT) % BIN_COUNT];
+        }
+        tracker.addStrike(reported, 100000 + static_cast<uint32_t>(uniform() * 50000), t);
+    }
+    return t;
+}
+
+void test_sliding_window_rates() {
+    StormTracker tracker;
+    // One strike every 20 s for 10 minutes
+    for (uint32_t i = 1; i <= 30; i++) {
+        tracker.addStrike(20, 1000, i * 20000);
+    }
+    const StormSummary& s = tracker.getSummary();
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.0f, s.rate_1min);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.0f, s.rate_5min);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.0f, s.rate_15min);
+
+    // 30 s later the 1 min window lost one strike; one exactly 60 s old is out
+    tracker.update(600000 + 30000);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.0f, tracker.getSummary().rate_1min);
+    tracker.update(600000 + 40000);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, tracker.getSummary().rate_1min);
+
+    tracker.update(600000 + 16 * MINUTE_MS);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, tracker.getSummary().rate_1min);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, tracker.getSummary().rate_5min);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, tracker.getSummary().rate_15min);
+    TEST_ASSERT_FALSE(tracker.getSummary().saturated);
+}
+
+void test_storm_start_and_end() {
+    StormTracker tracker;
+
+    // Isolated strikes 10 minutes apart never start a storm
+    for (uint32_t i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL(StormEvent::NONE, tracker.addStrike(30, 1000, i * 10 * MINUTE_MS));
+    }
+    TEST_ASSERT_FALSE(tracker.getSummary().active);
+
+    // Three within 5 minutes do
+    const uint32_t t0 = 60 * MINUTE_MS;
+    TEST_ASSERT_EQUAL(StormEvent::NONE, tracker.addStrike(27, 5000, t0));
+    TEST_ASSERT_EQUAL(StormEvent::NONE, tracker.addStrike(24, 9000, t0 + MINUTE_MS));
+    TEST_ASSERT_EQUAL(StormEvent::STARTED, tracker.addStrike(63, 2000, t0 + 2 * MINUTE_MS));
+    const StormSummary& s = tracker.getSummary();
+    TEST_ASSERT_TRUE(s.active);
+    TEST_ASSERT_EQUAL_UINT32(t0, s.started_ms);
+    TEST_ASSERT_EQUAL_UINT32(3, s.strikes);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 24.0f, s.closest_km);
+    TEST_ASSERT_EQUAL_UINT32(9000, s.peak_energy);
+
+    TEST_ASSERT_EQUAL(StormEvent::NONE, tracker.addStrike(17, 1000, t0 + 3 * MINUTE_MS));
+    TEST_ASSERT_EQUAL_UINT32(4, s.strikes);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 17.0f, s.closest_km);
+
+    // All-clear 30 minutes after the last strike, reported once
+    TEST_ASSERT_EQUAL(StormEvent::NONE, tracker.update(t0 + 32 * MINUTE_MS));
+    TEST_ASSERT_TRUE(s.active);
+    TEST_ASSERT_EQUAL(StormEvent::ENDED, tracker.update(t0 + 33 * MINUTE_MS));
+    TEST_ASSERT_FALSE(s.active);
+    TEST_ASSERT_EQUAL(StormEvent::NONE, tracker.update(t0 + 34 * MINUTE_MS));
+}
+
+void test_approaching_storm_speed_and_eta() {
+    StormTracker tracker;
+    seed(1);
+    // 38 km out closing at 12 km/h, 6 strikes/min
+    const uint32_t last = runStorm(tracker, 0, 40 * MINUTE_MS, 38.0f, 12.0f, 6.0f, 0.0f);
+    tracker.update(last);
+
+    const StormSummary& s = tracker.getSummary();
+    const float true_km = 38.0f - 12.0f * last / 3600000.0f;
+    TEST_ASSERT_TRUE(s.active);
+    TEST_ASSERT_TRUE(s.fit_valid);
+    TEST_ASSERT_EQUAL(StormMotion::APPROACHING, s.motion);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, 12.0f, s.approach_kmh);
+    TEST_ASSERT_FLOAT_WITHIN(2.5f, true_km, s.distance_km);
+    TEST_ASSERT_FLOAT_WITHIN(40.0f, true_km / 12.0f * 60.0f, s.eta_min);
+    TEST_ASSERT_LESS_THAN(4.0f, s.residual_km);
+}
+
+void test_receding_and_stationary() {
+    StormTracker receding;
+    seed(2);
+    uint32_t last = runStorm(receding, 0, 40 * MINUTE_MS, 8.0f, 15.0f * -1.0f, 4.0f, 0.0f);
+    receding.update(last);
+    TEST_ASSERT_EQUAL(StormMotion::RECEDING, receding.getSummary().motion);
+    TEST_ASSERT_FLOAT_WITHIN(4.0f, -15.0f, receding.getSummary().approach_kmh);
+    TEST_ASSERT_TRUE(receding.getSummary().eta_min < 0.0f);
+
+    StormTracker stationary;
+    seed(3);
+    last = runStorm(stationary, 0, 40 * MINUTE_MS, 20.0f, 0.0f, 4.0f, 0.0f);
+    stationary.update(last);
+    TEST_ASSERT_EQUAL(StormMotion::STATIONARY, stationary.getSummary().motion);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, 0.0f, stationary.getSummary().approach_kmh);
+}
+
+void test_outliers_are_downweighted() {
+    // 20% of strikes land in a random bin; the Huber weights keep the speed close
+    for (uint32_t n = 0; n < 5; n++) {
+        StormTracker tracker;
+        seed(10 + n);
+        const uint32_t last = runStorm(tracker, 0, 40 * MINUTE_MS, 36.0f, 10.0f, 6.0f, 0.2f);
+        tracker.update(last);
+        char message[48];
+        snprintf(message, sizeof(message), "seed %u speed %.1f", static_cast<unsigned>(n),
+                 tracker.getSummary().approach_kmh);
+        TEST_ASSERT_FLOAT_WITHIN_MESSAGE(4.0f, 10.0f, tracker.getSummary().approach_kmh, message);
+        TEST_ASSERT_EQUAL_MESSAGE(StormMotion::APPROACHING, tracker.getSummary().motion, message);
+    }
+}
+
+void test_out_of_range_strikes_counted_not_fitted() {
+    StormTracker tracker;
+    for (uint32_t i = 0; i < 20; i++) {
+        tracker.addStrike(STORM_OUT_OF_RANGE_KM, 1000, i * 15000);
+    }
+    const StormSummary& s = tracker.getSummary();
+    TEST_ASSERT_TRUE(s.active);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 4.0f, s.rate_1min);
+    TEST_ASSERT_FALSE(s.fit_valid);
+    TEST_ASSERT_EQUAL(StormMotion::UNKNOWN, s.motion);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, STORM_OUT_OF_RANGE_KM, s.closest_km);
+}
+
+void test_trend_detection() {
+    StormTracker tracker;
+    uint32_t t = 0;
+    // 1/min for 10 minutes, then 6/min for 5 minutes
+    for (uint32_t i = 0; i < 10; i++) {
+        t += MINUTE_MS;
+        tracker.addStrike(20, 1000, t);
+    }
+    TEST_ASSERT_EQUAL(StormTrend::STEADY, tracker.getSummary().trend);
+    for (uint32_t i = 0; i < 30; i++) {
+        t += 10000;
+        tracker.addStrike(20, 1000, t);
+    }
+    TEST_ASSERT_EQUAL(StormTrend::INTENSIFYING, tracker.getSummary().trend);
+
+    // Back to one strike every 3 minutes
+    for (uint32_t i = 0; i < 3; i++) {
+        t += 3 * MINUTE_MS;
+        tracker.addStrike(20, 1000, t);
+    }
+    TEST_ASSERT_EQUAL(StormTrend::WEAKENING, tracker.getSummary().trend);
+}
+
+void test_ring_overflow_saturates() {
+    StormTracker tracker;
+    // 300 strikes in one minute overflow the 256-slot ring
+    for (uint32_t i = 0; i < 300; i++) {
+        tracker.addStrike(12, 1000, i * 200);
+    }
+    const StormSummary& s = tracker.getSummary();
+    TEST_ASSERT_TRUE(s.saturated);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, static_cast<float>(StormTracker::CAPACITY), s.rate_1min);
+    TEST_ASSERT_EQUAL_UINT32(300, s.strikes);
+    TEST_ASSERT_EQUAL_UINT32(300, tracker.getTotalStrikes());
+
+    tracker.update(16 * MINUTE_MS);
+    TEST_ASSERT_FALSE(tracker.getSummary().saturated);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.0f, tracker.getSummary().rate_15min);
+}
+
+void test_uplink_round_trip_and_display() {
+    StormTracker tracker;
+    seed(4);
+    const uint32_t last = runStorm(tracker, 0, 40 * MINUTE_MS, 38.0f, 12.0f, 6.0f, 0.0f);
+    tracker.update(last);
+    const StormSummary& s = tracker.getSummary();
+
+    char frame[128];
+    const size_t length = tracker.formatUplink(frame, sizeof(frame));
+    TEST_ASSERT_GREATER_THAN(0, length);
+    TEST_ASSERT_EQUAL(strlen(frame), length);
+    TEST_ASSERT_EQUAL(0, tracker.formatUplink(frame, 16));
+
+    tracker.formatUplink(frame, sizeof(frame));
+    StormSummary parsed;
+    TEST_ASSERT_TRUE(StormTracker::parseUplink(frame, parsed));
+    TEST_ASSERT_TRUE(parsed.active);
+    TEST_ASSERT_EQUAL_UINT32(s.strikes, parsed.strikes);
+    TEST_ASSERT_FLOAT_WITHIN(0.06f, s.rate_5min, parsed.rate_5min);
+    TEST_ASSERT_FLOAT_WITHIN(0.06f, s.distance_km, parsed.distance_km);
+    TEST_ASSERT_FLOAT_WITHIN(0.06f, s.approach_kmh, parsed.approach_kmh);
+    TEST_ASSERT_EQUAL(s.motion, parsed.motion);
+    TEST_ASSERT_EQUAL(s.trend, parsed.trend);
+    TEST_ASSERT_FALSE(StormTracker::parseUplink("PING seq=1", parsed));
+
+    char lines[4][StormTracker::DISPLAY_LINE_LEN];
+    TEST_ASSERT_EQUAL(3, tracker.formatDisplay(lines, 4));
+    TEST_ASSERT_EQUAL(0, strncmp(lines[0], "STORM ", 6));
+    TEST_ASSERT_EQUAL(0, strncmp(lines[2], "Closing ", 8));
+    TEST_ASSERT_EQUAL(1, tracker.formatDisplay(lines, 1));
+
+    tracker.update(last + 31 * MINUTE_MS);
+    TEST_ASSERT_EQUAL(2, tracker.formatDisplay(lines, 4));
+    TEST_ASSERT_EQUAL_STRING("No storm", lines[0]);
+}
+
+void test_long_run_cost_and_drift() {
+    // Six hours at 10 strikes/min: running sums must match a fresh fit of the last window
+    StormTracker tracker;
+    seed(5);
+    const auto start = std::chrono::steady_clock::now();
+    const uint32_t last = runStorm(tracker, 0, 360 * MINUTE_MS, 20.0f, 0.0f, 10.0f, 0.05f);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    const double ns_per_strike = std::chrono::duration<double, std::nano>(elapsed).count() / tracker.getTotalStrikes();
+    printf("storm tracker: %lu strikes, %.0f ns/strike\n",
+           static_cast<unsigned long>(tracker.getTotalStrikes()), ns_per_strike);
+
+    tracker.update(last);
+    TEST_ASSERT_TRUE(tracker.getSummary().fit_valid);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, 0.0f, tracker.getSummary().approach_kmh);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, 20.0f, tracker.getSummary().distance_km);
+    TEST_ASSERT_LESS_THAN(5.0f, tracker.getSummary().residual_km);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sliding_window_rates);
+    RUN_TEST(test_storm_start_and_end);
+    RUN_TEST(test_approaching_storm_speed_and_eta);
+    RUN_TEST(test_receding_and_stationary);
+    RUN_TEST(test_outliers_are_downweighted);
+    RUN_TEST(test_out_of_range_strikes_counted_not_fitted);
+    RUN_TEST(test_trend_detection);
+    RUN_TEST(test_ring_overflow_saturates);
+    RUN_TEST(test_uplink_round_trip_and_display);
+    RUN_TEST(test_long_run_cost_and_drift);
+
+    return UNITY_END();
+}
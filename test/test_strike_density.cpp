@@ -0,0 +1,270 @@
+// Unit tests and native benchmark for the strike density grid
+#include <unity.h>
+#include "../src/sensors/strike_density.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace Sensors;
+
+static constexpr uint32_t HOUR_MS = 60 * 60000;
+static constexpr double LAT0 = 39.7392;
+static constexpr double LON0 = -104.9903;
+static constexpr double KM_PER_DEG = 6371.0 * M_PI / 180.0;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Deterministic draws (xorshift32)
+static uint32_t s_seed = 1;
+static void seed(uint32_t n) {
+    s_seed = (n + 1) * 0x9E3779B9u;
+}
+static float uniform() {
+    s_seed ^= s_seed << 13;
+    s_seed ^= s_seed >> 17;
+    s_seed ^= s_seed << 5;
+    return ((s_seed >> 8) + 0.5f) / 16777216.0f;
+}
+static float gaussian() {
+    return sqrtf(-2.0f * logf(uniform())) * cosf(2.0f * static_cast<float>(M_PI) * uniform());
+}
+
+static uint8_t s_buffer[StrikeDensityGrid::MAX_ENCODED_BYTES];
+static uint8_t s_levels[StrikeDensityGrid::CELLS];
+
+void test_strikes_land_in_expected_cells() {
+    StrikeDensityGrid grid;                         // +/- 100 km, 3.125 km cells
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 3.125f, grid.getCellKm());
+
+    TEST_ASSERT_TRUE(grid.addStrikeLocal(0.1f, 0.1f, 1000));        // Just NE of the site
+    TEST_ASSERT_TRUE(grid.addStrikeLocal(-99.9f, 99.9f, 1000));     // North-west corner
+    TEST_ASSERT_TRUE(grid.addStrikeLocal(10.0f, -20.0f, 1000));
+    TEST_ASSERT_FALSE(grid.addStrikeLocal(100.5f, 0.0f, 1000));
+    TEST_ASSERT_FALSE(grid.addStrikeLocal(0.0f, -150.0f, 1000));
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, grid.cellDensity(31, 32, 1000));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, grid.cellDensity(0, 0, 1000));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, grid.cellDensity(38, 35, 1000));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 3.0f, grid.totalDensity(1000));
+    TEST_ASSERT_EQUAL_UINT32(3, grid.getTotalStrikes());
+    TEST_ASSERT_EQUAL_UINT32(2, grid.getOutsideStrikes());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, grid.cellDensity(64, 0, 1000));
+}
+
+void test_counts_decay_with_half_life() {
+    StrikeDensityGrid grid;
+    const uint32_t t0 = 5000;
+    for (int i = 0; i < 8; i++) {
+        grid.addStrikeLocal(5.0f, 5.0f, t0);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 8.0f, grid.cellDensity(30, 33, t0));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 4.0f, grid.cellDensity(30, 33, t0 + HOUR_MS));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, grid.cellDensity(30, 33, t0 + 3 * HOUR_MS));
+
+    // A newer strike weighs in at full count next to the decayed ones
+    grid.addStrikeLocal(5.0f, 5.0f, t0 + HOUR_MS);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 5.0f, grid.cellDensity(30, 33, t0 + HOUR_MS));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 5.0f, grid.totalDensity(t0 + HOUR_MS));
+}
+
+void test_rebase_is_invisible_and_rare() {
+    // Brute-force decayed sums against the lazy grid over 48 half-lives
+    StrikeDensityConfig config = getDefaultStrikeDensityConfig();
+    config.half_life_ms = 10 * 60000;
+    StrikeDensityGrid grid(config);
+
+    static float expected[StrikeDensityGrid::CELLS];
+    static uint32_t times[4000];
+    static uint16_t cells[4000];
+    seed(1);
+    const uint32_t start = 0xFFFFFFFFu - 30 * 60000;      // Cross the millis() wrap too
+    const int strikes = 4000;
+    for (int i = 0; i < strikes; i++) {
+        times[i] = start + static_cast<uint32_t>(i) * (8 * 60 * 60000 / strikes);
+        const float east = 15.0f * gaussian();
+        const float north = 15.0f * gaussian();
+        TEST_ASSERT_TRUE(grid.addStrikeLocal(east, north, times[i]));
+        const int col = static_cast<int>(floorf((east + 100.0f) / 3.125f));
+        const int row = static_cast<int>(floorf((100.0f - north) / 3.125f));
+        cells[i] = static_cast<uint16_t>(row * 64 + col);
+    }
+
+    const uint32_t now = times[strikes - 1] + 5 * 60000;
+    memset(expected, 0, sizeof(expected));
+    for (int i = 0; i < strikes; i++) {
+        expected[cells[i]] += exp2f(-static_cast<float>(now - times[i]) / config.half_life_ms);
+    }
+    float worst = 0.0f;
+    float total = 0.0f;
+    for (size_t c = 0; c < StrikeDensityGrid::CELLS; c++) {
+        const float got = grid.cellDensity(c / 64, c % 64, now);
+        worst = fmaxf(worst, fabsf(got - expected[c]) / fmaxf(expected[c], 1e-3f));
+        total += expected[c];
+    }
+    TEST_ASSERT_LESS_THAN(1e-3f, worst);
+    TEST_ASSERT_FLOAT_WITHIN(total * 1e-3f, total, grid.totalDensity(now));
+
+    // 48 half-lives of strikes need only a few full-grid rescales
+    TEST_ASSERT_GREATER_OR_EQUAL(2, grid.getRebaseCount());
+    TEST_ASSERT_LESS_OR_EQUAL(4, grid.getRebaseCount());
+}
+
+// Weeks without strikes: past 2^31 ms the age must not wrap negative
+void test_long_quiet_spell() {
+    StrikeDensityGrid grid;
+    const uint32_t t0 = 1000;
+    grid.addStrikeLocal(5.0f, 5.0f, t0);
+    grid.addStrikeLocal(5.0f, 5.0f, t0);
+
+    const uint32_t day = 24 * HOUR_MS;
+    for (uint32_t days = 2; days <= 45; days += 1) {
+        const float total = grid.totalDensity(t0 + days * day);
+        TEST_ASSERT_TRUE(std::isfinite(total));
+        TEST_ASSERT_EQUAL_FLOAT(0.0f, total);
+    }
+
+    // The next strike starts over instead of scaling stale weights
+    const uint32_t later = t0 + 30 * day;
+    TEST_ASSERT_TRUE(grid.addStrikeLocal(-5.0f, -5.0f, later));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, grid.totalDensity(later));
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 0.5f, grid.totalDensity(later + HOUR_MS));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, grid.cellDensity(30, 33, later));
+
+    // Slightly out-of-order strikes still weigh in correctly
+    grid.addStrikeLocal(-5.0f, -5.0f, later - HOUR_MS);
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.5f, grid.totalDensity(later));
+}
+
+void test_site_projection_and_recentre() {
+    StrikeDensityGrid grid;
+    TEST_ASSERT_FALSE(grid.addStrike(LAT0, LON0, 0));                // No site yet
+
+    grid.setSite(LAT0, LON0);
+    const double north_20km = LAT0 + 20.0 / KM_PER_DEG;
+    const double east_20km = LON0 + 20.0 / (KM_PER_DEG * cos(LAT0 * M_PI / 180.0));
+    TEST_ASSERT_TRUE(grid.addStrike(north_20km, LON0 + 1e-6, 0));
+    TEST_ASSERT_TRUE(grid.addStrike(LAT0 + 1e-6, east_20km, 0));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, grid.cellDensity(25, 32, 0));   // 20 km / 3.125 = 6.4 rows up
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, grid.cellDensity(31, 38, 0));
+
+    // GPS jitter keeps the map; moving the receiver clears it
+    grid.setSite(LAT0 + 0.00005, LON0 - 0.00005);
+    TEST_ASSERT_EQUAL_UINT32(2, grid.getTotalStrikes());
+    grid.setSite(LAT0 + 0.1, LON0);
+    TEST_ASSERT_EQUAL_UINT32(0, grid.getTotalStrikes());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, grid.totalDensity(0));
+}
+
+void test_encode_round_trip() {
+    StrikeDensityGrid grid;
+    grid.setSite(LAT0, LON0);
+    seed(2);
+    for (int i = 0; i < 300; i++) {
+        grid.addStrikeLocal(-20.0f + 6.0f * gaussian(), 30.0f + 4.0f * gaussian(), i * 1000);
+    }
+    const uint32_t now = 300 * 1000 + HOUR_MS;
+
+    const size_t length = grid.encode(s_buffer, sizeof(s_buffer), now);
+    printf("density storm map: %zu bytes (raw levels %zu)\n", length, StrikeDensityGrid::CELLS);
+    TEST_ASSERT_GREATER_THAN(STRIKE_DENSITY_HEADER_BYTES, length);
+    TEST_ASSERT_LESS_THAN(600, length);
+
+    StrikeDensityHeader header;
+    TEST_ASSERT_TRUE(StrikeDensityGrid::decode(s_buffer, length, header, s_levels));
+    TEST_ASSERT_EQUAL_UINT8(64, header.grid);
+    TEST_ASSERT_EQUAL_UINT16(3125, header.cell_m);
+    TEST_ASSERT_EQUAL_UINT16(60, header.half_life_min);
+    TEST_ASSERT_EQUAL_UINT32(300, header.strikes);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, LAT0, header.site_latitude);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, LON0, header.site_longitude);
+    TEST_ASSERT_EQUAL_UINT16((length - STRIKE_DENSITY_HEADER_BYTES) / 2, header.pairs);
+
+    // Each level decodes to within half a quantization step of the true density
+    float max_density = 0.0f;
+    for (size_t c = 0; c < StrikeDensityGrid::CELLS; c++) {
+        max_density = fmaxf(max_density, grid.cellDensity(c / 64, c % 64, now));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(max_density * 1e-5f, max_density, header.max_density);
+    for (size_t c = 0; c < StrikeDensityGrid::CELLS; c++) {
+        const float root = sqrtf(grid.cellDensity(c / 64, c % 64, now) / max_density);
+        TEST_ASSERT_FLOAT_WITHIN(0.5f / 255.0f + 1e-6f, root, s_levels[c] / 255.0f);
+    }
+
+    // Corrupt or truncated payloads are rejected
+    TEST_ASSERT_FALSE(StrikeDensityGrid::decode(s_buffer, length - 1, header, s_levels));
+    s_buffer[0] = 'X';
+    TEST_ASSERT_FALSE(StrikeDensityGrid::decode(s_buffer, length, header, s_levels));
+
+    // Buffer too small reports 0 rather than a partial map
+    TEST_ASSERT_EQUAL_UINT(0, grid.encode(s_buffer, 64, now));
+}
+
+void test_worst_case_fits_max_encoded_bytes() {
+    // Alternating levels defeat RLE: every cell becomes its own pair
+    StrikeDensityGrid grid;
+    for (size_t c = 0; c < StrikeDensityGrid::CELLS; c++) {
+        const float east = -100.0f + 3.125f * (c % 64) + 1.0f;
+        const float north = 100.0f - 3.125f * (c / 64) - 1.0f;
+        for (size_t k = 0; k < 1 + (c & 1); k++) {
+            grid.addStrikeLocal(east, north, 0);
+        }
+    }
+    const size_t length = grid.encode(s_buffer, sizeof(s_buffer), 0);
+    TEST_ASSERT_EQUAL_UINT(StrikeDensityGrid::MAX_ENCODED_BYTES, length);
+
+    // An empty map is 16 full runs of zeros
+    StrikeDensityGrid empty;
+    TEST_ASSERT_EQUAL_UINT(STRIKE_DENSITY_HEADER_BYTES + 2 * 17, empty.encode(s_buffer, sizeof(s_buffer), 0));
+}
+
+void test_memory_and_update_cost() {
+    // Fixed footprint: the cell array dominates
+    printf("density grid: %zu bytes, encode buffer %zu bytes\n", sizeof(StrikeDensityGrid),
+           StrikeDensityGrid::MAX_ENCODED_BYTES);
+    TEST_ASSERT_LESS_OR_EQUAL(StrikeDensityGrid::CELLS * sizeof(float) + 128, sizeof(StrikeDensityGrid));
+
+    static StrikeDensityGrid grid;
+    grid.setSite(LAT0, LON0);
+    static double lat[1024], lon[1024];
+    seed(3);
+    for (int i = 0; i < 1024; i++) {
+        lat[i] = LAT0 + 40.0 * gaussian() / KM_PER_DEG;
+        lon[i] = LON0 + 40.0 * gaussian() / KM_PER_DEG;
+    }
+    const int iterations = 200000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        grid.addStrike(lat[i & 1023], lon[i & 1023], static_cast<uint32_t>(i) * 100);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    printf("density addStrike  %6.1f ns/strike  (%u rebases)\n",
+           std::chrono::duration<double, std::nano>(elapsed).count() / iterations, grid.getRebaseCount());
+
+    size_t length = 0;
+    const int encodes = 2000;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < encodes; i++) {
+        length += grid.encode(s_buffer, sizeof(s_buffer), static_cast<uint32_t>(iterations) * 100);
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    printf("density encode     %6.1f us/map  (%zu bytes)\n",
+           std::chrono::duration<double, std::micro>(elapsed).count() / encodes, length / encodes);
+    TEST_ASSERT_GREATER_THAN(0, length);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_strikes_land_in_expected_cells);
+    RUN_TEST(test_counts_decay_with_half_life);
+    RUN_TEST(test_rebase_is_invisible_and_rare);
+    RUN_TEST(test_long_quiet_spell);
+    RUN_TEST(test_site_projection_and_recentre);
+    RUN_TEST(test_encode_round_trip);
+    RUN_TEST(test_worst_case_fits_max_encoded_bytes);
+    RUN_TEST(test_memory_and_update_cost);
+
+    return UNITY_END();
+}
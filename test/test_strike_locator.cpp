@@ -0,0 +1,292 @@
+// Accuracy tests and native benchmark for multi-station strike trilateration
+#include <unity.h>
+#include "../src/sensors/strike_locator.h"
+#include "../src/sensors/strike_density.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+using namespace Sensors;
+
+static constexpr double LAT0 = 39.7392;
+static constexpr double LON0 = -104.9903;
+static constexpr double KM_PER_DEG = 6371.0 * M_PI / 180.0;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Deterministic draws (xorshift32)
+static uint32_t s_seed = 1;
+static void seed(uint32_t n) {
+    s_seed = (n + 1) * 0x9E3779B9u;
+}
+static float uniform() {
+    s_seed ^= s_seed << 13;
+    s_seed ^= s_seed >> 17;
+    s_seed ^= s_seed << 5;
+    return ((s_seed >> 8) + 0.5f) / 16777216.0f;
+}
+static float gaussian() {
+    return sqrtf(-2.0f * logf(uniform())) * cosf(2.0f * static_cast<float>(M_PI) * uniform());
+}
+
+static const uint8_t DISTANCE_BINS[] = {1, 5, 6, 8, 10, 12, 14, 17, 20, 24, 27, 31, 34, 37, 40};
+
+static uint8_t quantize(float km) {
+    if (km > 40.0f) {
+        return 63;
+    }
+    uint8_t best = DISTANCE_BINS[0];
+    for (uint8_t bin : DISTANCE_BINS) {
+        if (fabsf(bin - km) < fabsf(best - km)) {
+            best = bin;
+        }
+    }
+    return best;
+}
+
+// Local east/north km around (LAT0, LON0)
+static StationReport station(uint16_t id, float east_km, float north_km, uint8_t distance_km, uint32_t time_ms = 0) {
+    StationReport report = {};
+    report.station_id = id;
+    report.latitude = LAT0 + north_km / KM_PER_DEG;
+    report.longitude = LON0 + east_km / (KM_PER_DEG * cos(LAT0 * M_PI / 180.0));
+    report.distance_km = distance_km;
+    report.time_ms = time_ms;
+    return report;
+}
+
+static void toLocal(const StrikeLocation& location, float& east_km, float& north_km) {
+    north_km = static_cast<float>((location.latitude - LAT0) * KM_PER_DEG);
+    east_km = static_cast<float>((location.longitude - LON0) * KM_PER_DEG * cos(LAT0 * M_PI / 180.0));
+}
+
+void test_range_sigma_follows_bin_width() {
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 2.0f / sqrtf(12.0f), strikeRangeSigmaKm(10));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.0f / sqrtf(12.0f), strikeRangeSigmaKm(1));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 3.0f / sqrtf(12.0f), strikeRangeSigmaKm(40));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.5f, strikeRangeSigmaKm(6));
+    TEST_ASSERT_TRUE(strikeRangeSigmaKm(24) > strikeRangeSigmaKm(10));
+}
+
+void test_exact_ranges_recover_position() {
+    // Strike at the origin; every range is an exact AS3935 bin
+    const StationReport reports[] = {
+        station(1, 10.0f, 0.0f, 10), station(2, 0.0f, 20.0f, 20),
+        station(3, -12.0f, 0.0f, 12), station(4, 0.0f, -24.0f, 24),
+    };
+    const StrikeLocation location = StrikeLocator::solve(reports, 4, getDefaultStrikeLocatorConfig());
+
+    TEST_ASSERT_TRUE(location.valid);
+    TEST_ASSERT_TRUE(location.converged);
+    TEST_ASSERT_FALSE(location.ambiguous);
+    TEST_ASSERT_EQUAL_UINT8(4, location.stations);
+    float east, north;
+    toLocal(location, east, north);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 0.0f, east);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 0.0f, north);
+    TEST_ASSERT_LESS_THAN(0.05f, location.residual_km);
+    TEST_ASSERT_LESS_THAN(6.0f, location.semi_major_km);
+    TEST_ASSERT_TRUE(location.semi_minor_km <= location.semi_major_km);
+}
+
+void test_ellipse_elongates_along_weak_axis() {
+    // All stations south of the strike: the ranges pin north, east is weak
+    const StationReport reports[] = {
+        station(1, -6.0f, 0.0f, 10), station(2, 6.0f, 0.0f, 10), station(3, 0.0f, 0.5f, 8),
+    };
+    const StrikeLocation location = StrikeLocator::solve(reports, 3, getDefaultStrikeLocatorConfig());
+    TEST_ASSERT_TRUE(location.valid);
+    TEST_ASSERT_TRUE(location.semi_major_km > 1.5f * location.semi_minor_km);
+    TEST_ASSERT_FLOAT_WITHIN(30.0f, 90.0f, location.orientation_deg);
+}
+
+void test_two_stations_mirror_ambiguity() {
+    // A at (0,0), B at (16,0): strikes at (8, +-6) are both 10 km from each
+    const StationReport reports[] = {station(1, 0.0f, 0.0f, 10), station(2, 16.0f, 0.0f, 10)};
+    StrikeLocation location = StrikeLocator::solve(reports, 2, getDefaultStrikeLocatorConfig());
+    TEST_ASSERT_TRUE(location.valid);
+    TEST_ASSERT_TRUE(location.ambiguous);
+    float east, north;
+    toLocal(location, east, north);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 8.0f, east);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 6.0f, fabsf(north));
+
+    // A prior near the southern solution picks it
+    StrikeLocation prior = {};
+    prior.valid = true;
+    prior.latitude = LAT0 - 5.0 / KM_PER_DEG;
+    prior.longitude = LON0 + 8.0 / (KM_PER_DEG * cos(LAT0 * M_PI / 180.0));
+    location = StrikeLocator::solve(reports, 2, getDefaultStrikeLocatorConfig(), &prior);
+    toLocal(location, east, north);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, -6.0f, north);
+}
+
+void test_out_of_range_station_breaks_ambiguity() {
+    // A station 40 km south saw it beyond range, ruling out the southern mirror (34 km from it)
+    const StationReport reports[] = {
+        station(1, 0.0f, 0.0f, 10), station(2, 16.0f, 0.0f, 10), station(3, 8.0f, -40.0f, 63),
+    };
+    const StrikeLocation location = StrikeLocator::solve(reports, 3, getDefaultStrikeLocatorConfig());
+    TEST_ASSERT_TRUE(location.valid);
+    TEST_ASSERT_FALSE(location.ambiguous);
+    TEST_ASSERT_EQUAL_UINT8(2, location.stations);
+    TEST_ASSERT_EQUAL_UINT8(1, location.out_of_range);
+    float east, north;
+    toLocal(location, east, north);
+    TEST_ASSERT_FLOAT_WITHIN(0.1f, 6.0f, north);
+}
+
+void test_grouping_by_time_window() {
+    StrikeLocator locator;
+    StrikeDensityGrid density;
+    density.setSite(LAT0, LON0);
+    locator.setDensityGrid(&density);
+
+    // Three stations within the window form one event
+    TEST_ASSERT_FALSE(locator.addReport(station(1, 10.0f, 0.0f, 10, 1000)));
+    TEST_ASSERT_FALSE(locator.addReport(station(2, 0.0f, 20.0f, 20, 1200)));
+    TEST_ASSERT_FALSE(locator.addReport(station(2, 0.0f, 20.0f, 20, 1300)));    // Duplicate
+    TEST_ASSERT_FALSE(locator.addReport(station(3, -12.0f, 0.0f, 12, 1400)));
+    TEST_ASSERT_FALSE(locator.update(2000));
+
+    // Next report after the window closes the event
+    TEST_ASSERT_TRUE(locator.addReport(station(1, 10.0f, 0.0f, 10, 5000)));
+    const StrikeLocation& location = locator.getLastLocation();
+    TEST_ASSERT_TRUE(location.valid);
+    TEST_ASSERT_EQUAL_UINT8(3, location.stations);
+    TEST_ASSERT_EQUAL_UINT32(1000, location.time_ms);
+    TEST_ASSERT_EQUAL_UINT32(1, locator.getStats().duplicates);
+
+    // A lone station cannot be located
+    TEST_ASSERT_TRUE(locator.update(6500));
+    TEST_ASSERT_FALSE(locator.getLastLocation().valid);
+
+    const StrikeLocatorStats& stats = locator.getStats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.events);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.located);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.too_few_stations);
+
+    // Only the located event reached the density map
+    TEST_ASSERT_EQUAL_UINT32(1, density.getTotalStrikes());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f, density.totalDensity(1000));
+}
+
+struct FieldResult {
+    float median_error_km;
+    float p90_error_km;
+    float coverage;             // Fraction of true positions inside the 95% ellipse
+    uint32_t located;
+};
+
+// Random station network in a 60x60 km square, strikes across the same area.
+// AS3935 ranges: 10% multiplicative error, then binned.
+static FieldResult runStrikeField(size_t stations, uint32_t strikes) {
+    static float errors[4096];
+    StationReport reports[StrikeLocator::MAX_STATIONS];
+    float sx[StrikeLocator::MAX_STATIONS], sy[StrikeLocator::MAX_STATIONS];
+    for (size_t i = 0; i < stations; i++) {
+        sx[i] = 60.0f * uniform() - 30.0f;
+        sy[i] = 60.0f * uniform() - 30.0f;
+    }
+
+    FieldResult result = {};
+    uint32_t inside = 0;
+    for (uint32_t k = 0; k < strikes; k++) {
+        const float ex = 60.0f * uniform() - 30.0f;
+        const float ny = 60.0f * uniform() - 30.0f;
+        for (size_t i = 0; i < stations; i++) {
+            const float range = hypotf(ex - sx[i], ny - sy[i]) * (1.0f + 0.1f * gaussian());
+            reports[i] = station(static_cast<uint16_t>(i), sx[i], sy[i], quantize(range));
+        }
+        const StrikeLocation location = StrikeLocator::solve(reports, stations, getDefaultStrikeLocatorConfig());
+        if (!location.valid || location.ambiguous) {
+            continue;
+        }
+
+        float east, north;
+        toLocal(location, east, north);
+        const float dx = ex - east;
+        const float dy = ny - north;
+        errors[result.located++] = hypotf(dx, dy);
+
+        // Inside the ellipse: rotate the miss into the major/minor frame
+        const float bearing = location.orientation_deg * static_cast<float>(M_PI) / 180.0f;
+        const float along = dx * sinf(bearing) + dy * cosf(bearing);
+        const float across = dx * cosf(bearing) - dy * sinf(bearing);
+        const float a = location.semi_major_km;
+        const float b = fmaxf(location.semi_minor_km, 1e-3f);
+        if ((along * along) / (a * a) + (across * across) / (b * b) <= 1.0f) {
+            inside++;
+        }
+    }
+
+    std::sort(errors, errors + result.located);
+    result.median_error_km = errors[result.located / 2];
+    result.p90_error_km = errors[result.located * 9 / 10];
+    result.coverage = static_cast<float>(inside) / result.located;
+    return result;
+}
+
+void test_accuracy_on_synthetic_strike_fields() {
+    const size_t counts[] = {3, 4, 8, 16};
+    float median[4];
+    for (size_t c = 0; c < 4; c++) {
+        seed(static_cast<uint32_t>(counts[c]));
+        const FieldResult result = runStrikeField(counts[c], 2000);
+        median[c] = result.median_error_km;
+        printf("locator N=%2zu  located %4lu  median %5.2f km  p90 %5.2f km  95%% ellipse coverage %.2f\n",
+               counts[c], static_cast<unsigned long>(result.located), result.median_error_km,
+               result.p90_error_km, result.coverage);
+        TEST_ASSERT_GREATER_THAN(1000, result.located);
+        TEST_ASSERT_GREATER_THAN(0.75f, result.coverage);
+    }
+
+    // More stations, smaller errors
+    TEST_ASSERT_LESS_THAN(4.0f, median[1]);
+    TEST_ASSERT_LESS_THAN(median[1], median[3]);
+    TEST_ASSERT_LESS_THAN(1.5f, median[3]);
+}
+
+void test_benchmark_solve_vs_station_count() {
+    StationReport reports[StrikeLocator::MAX_STATIONS];
+    volatile float sink = 0.0f;
+    seed(99);
+    for (size_t n = 2; n <= StrikeLocator::MAX_STATIONS; n *= 2) {
+        for (size_t i = 0; i < n; i++) {
+            const float sx = 40.0f * uniform() - 20.0f;
+            const float sy = 40.0f * uniform() - 20.0f;
+            reports[i] = station(static_cast<uint16_t>(i), sx, sy, quantize(hypotf(sx - 3.0f, sy + 4.0f)));
+        }
+
+        const int iterations = 20000;
+        uint32_t total_iterations = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; it++) {
+            const StrikeLocation location = StrikeLocator::solve(reports, n, getDefaultStrikeLocatorConfig());
+            sink = sink + location.semi_major_km;
+            total_iterations += location.iterations;
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        printf("locator N=%2zu  %6.2f us/solve  %.1f GN iterations\n", n,
+               std::chrono::duration<double, std::micro>(elapsed).count() / iterations,
+               static_cast<double>(total_iterations) / iterations);
+    }
+    TEST_ASSERT_TRUE(sink > 0.0f);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_range_sigma_follows_bin_width);
+    RUN_TEST(test_exact_ranges_recover_position);
+    RUN_TEST(test_ellipse_elongates_along_weak_axis);
+    RUN_TEST(test_two_stations_mirror_ambiguity);
+    RUN_TEST(test_out_of_range_station_breaks_ambiguity);
+    RUN_TEST(test_grouping_by_time_window);
+    RUN_TEST(test_accuracy_on_synthetic_strike_fields);
+    RUN_TEST(test_benchmark_solve_vs_station_count);
+
+    return UNITY_END();
+}
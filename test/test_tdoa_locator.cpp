@@ -0,0 +1,212 @@
+// Accuracy tests and native benchmark for the TDOA strike solver
+#include <unity.h>
+#include "../src/sensors/tdoa_locator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+using namespace Sensors;
+
+static constexpr double LAT0 = 39.7392;
+static constexpr double LON0 = -104.9903;
+static constexpr double KM_PER_DEG = 6371.0 * M_PI / 180.0;
+static constexpr int64_t EPOCH_NS = 1400000000LL * 1000000000LL;     // Arbitrary GPS time
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Deterministic draws (xorshift32)
+static uint32_t s_seed = 1;
+static void seed(uint32_t n) {
+    s_seed = (n + 1) * 0x9E3779B9u;
+}
+static float uniform() {
+    s_seed ^= s_seed << 13;
+    s_seed ^= s_seed >> 17;
+    s_seed ^= s_seed << 5;
+    return ((s_seed >> 8) + 0.5f) / 16777216.0f;
+}
+static float gaussian() {
+    return sqrtf(-2.0f * logf(uniform())) * cosf(2.0f * static_cast<float>(M_PI) * uniform());
+}
+
+// Station at local east/north km; arrival from a strike at (ex, ny) emitted at EPOCH_NS + offset
+static TdoaDetection detection(uint16_t id, float east_km, float north_km, float strike_east, float strike_north,
+                               float jitter_us = 0.0f) {
+    TdoaDetection d = {};
+    d.station_id = id;
+    d.latitude = LAT0 + north_km / KM_PER_DEG;
+    d.longitude = LON0 + east_km / (KM_PER_DEG * cos(LAT0 * M_PI / 180.0));
+    const double travel_us = hypot(east_km - strike_east, north_km - strike_north) / TDOA_PROPAGATION_KM_PER_US;
+    d.arrival_ns = EPOCH_NS + 5000 + static_cast<int64_t>(llround((travel_us + jitter_us) * 1000.0));
+    return d;
+}
+
+static float positionError(const TdoaSolution& s, float east_km, float north_km) {
+    const float north = static_cast<float>((s.latitude - LAT0) * KM_PER_DEG);
+    const float east = static_cast<float>((s.longitude - LON0) * KM_PER_DEG * cos(LAT0 * M_PI / 180.0));
+    return hypotf(east - east_km, north - north_km);
+}
+
+void test_exact_arrivals_recover_position_and_time() {
+    const float sx[] = {-20.0f, 25.0f, 5.0f, -10.0f, 18.0f};
+    const float sy[] = {-15.0f, -10.0f, 30.0f, 20.0f, 12.0f};
+    TdoaDetection detections[5];
+    for (int i = 0; i < 5; i++) {
+        detections[i] = detection(i, sx[i], sy[i], 3.0f, -4.0f);
+    }
+
+    TdoaLocator locator;
+    const TdoaSolution s = locator.solve(detections, 5);
+    TEST_ASSERT_TRUE(s.valid);
+    TEST_ASSERT_TRUE(s.converged);
+    TEST_ASSERT_EQUAL_UINT8(5, s.stations);
+    TEST_ASSERT_EQUAL_UINT8(0, s.rejected);
+    TEST_ASSERT_LESS_THAN(0.02f, positionError(s, 3.0f, -4.0f));
+    TEST_ASSERT_TRUE(llabs(s.strike_ns - (EPOCH_NS + 5000)) < 100);
+    TEST_ASSERT_LESS_THAN(0.05f, s.residual_us);
+    TEST_ASSERT_GREATER_THAN(0.0f, s.hdop);
+}
+
+void test_three_stations_exactly_determined() {
+    TdoaDetection detections[3] = {
+        detection(1, -15.0f, -10.0f, 2.0f, 3.0f),
+        detection(2, 15.0f, -10.0f, 2.0f, 3.0f),
+        detection(3, 0.0f, 18.0f, 2.0f, 3.0f),
+    };
+    TdoaLocator locator;
+    const TdoaSolution s = locator.solve(detections, 3);
+    TEST_ASSERT_TRUE(s.valid);
+    TEST_ASSERT_LESS_THAN(0.05f, positionError(s, 2.0f, 3.0f));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, s.chi2_dof);
+
+    // Two stations cannot fix a TDOA position
+    TEST_ASSERT_FALSE(locator.solve(detections, 2).valid);
+}
+
+void test_ransac_rejects_bad_timestamps() {
+    seed(7);
+    TdoaDetection detections[10];
+    for (int i = 0; i < 10; i++) {
+        const float x = 60.0f * uniform() - 30.0f;
+        const float y = 60.0f * uniform() - 30.0f;
+        detections[i] = detection(i, x, y, -6.0f, 9.0f, 0.5f * gaussian());
+    }
+    // Stations 2 and 7 triggered on a later half-cycle
+    detections[2].arrival_ns += 40000;
+    detections[7].arrival_ns += 25000;
+
+    TdoaConfig config = getDefaultTdoaConfig();
+    config.timing_sigma_us = 0.5f;
+    const TdoaSolution robust = TdoaLocator(config).solve(detections, 10);
+    TEST_ASSERT_TRUE(robust.valid);
+    TEST_ASSERT_EQUAL_UINT8(2, robust.rejected);
+    TEST_ASSERT_EQUAL_HEX16(0x3FF & ~((1u << 2) | (1u << 7)), robust.inlier_mask);
+    TEST_ASSERT_LESS_THAN(0.5f, positionError(robust, -6.0f, 9.0f));
+    TEST_ASSERT_LESS_THAN(3.0f, robust.chi2_dof);
+
+    // Without RANSAC the outliers drag the fix and blow up the quality metric
+    config.ransac_iterations = 0;
+    const TdoaSolution naive = TdoaLocator(config).solve(detections, 10);
+    TEST_ASSERT_EQUAL_UINT8(0, naive.rejected);
+    TEST_ASSERT_GREATER_THAN(2.0f, positionError(naive, -6.0f, 9.0f));
+    TEST_ASSERT_GREATER_THAN(100.0f, naive.chi2_dof);
+}
+
+void test_chi2_matches_timing_noise() {
+    // Residual variance over the assumed jitter should average ~1
+    TdoaConfig config = getDefaultTdoaConfig();
+    config.timing_sigma_us = 0.8f;
+    TdoaLocator locator(config);
+    seed(8);
+    TdoaDetection detections[8];
+    float chi2_sum = 0.0f;
+    const int trials = 200;
+    for (int t = 0; t < trials; t++) {
+        const float ex = 30.0f * uniform() - 15.0f;
+        const float ny = 30.0f * uniform() - 15.0f;
+        for (int i = 0; i < 8; i++) {
+            const float angle = 2.0f * static_cast<float>(M_PI) * i / 8;
+            detections[i] = detection(i, 25.0f * cosf(angle), 25.0f * sinf(angle), ex, ny, 0.8f * gaussian());
+        }
+        chi2_sum += locator.solve(detections, 8).chi2_dof;
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.35f, 1.0f, chi2_sum / trials);
+}
+
+// Median position error over random strikes inside a ring of stations
+static float medianError(size_t stations, float jitter_us, uint32_t strikes) {
+    static float errors[1024];
+    TdoaConfig config = getDefaultTdoaConfig();
+    config.timing_sigma_us = fmaxf(jitter_us, 0.05f);
+    TdoaLocator locator(config);
+    TdoaDetection detections[TdoaLocator::MAX_STATIONS];
+    uint32_t n = 0;
+    for (uint32_t k = 0; k < strikes; k++) {
+        const float ex = 30.0f * uniform() - 15.0f;
+        const float ny = 30.0f * uniform() - 15.0f;
+        for (size_t i = 0; i < stations; i++) {
+            const float angle = 2.0f * static_cast<float>(M_PI) * (i + 0.3f * uniform()) / stations;
+            const float radius = 20.0f + 10.0f * uniform();
+            detections[i] = detection(i, radius * cosf(angle), radius * sinf(angle), ex, ny, jitter_us * gaussian());
+        }
+        const TdoaSolution s = locator.solve(detections, stations);
+        if (s.valid) {
+            errors[n++] = positionError(s, ex, ny);
+        }
+    }
+    std::sort(errors, errors + n);
+    return errors[n / 2];
+}
+
+void test_accuracy_vs_timing_jitter() {
+    const float jitters[] = {0.1f, 0.3f, 1.0f, 3.0f};
+    float median[4];
+    for (int j = 0; j < 4; j++) {
+        seed(20 + j);
+        median[j] = medianError(6, jitters[j], 500);
+        printf("tdoa N=6  jitter %.1f us  median error %.3f km\n", jitters[j], median[j]);
+    }
+    for (int j = 1; j < 4; j++) {
+        TEST_ASSERT_LESS_THAN(median[j], median[j - 1]);
+    }
+    // Sub-kilometre at 1 us, far tighter than the 1-3 km AS3935 range bins
+    TEST_ASSERT_LESS_THAN(0.6f, median[2]);
+    TEST_ASSERT_LESS_THAN(0.06f, median[0]);
+}
+
+void test_benchmark_solve_vs_station_count() {
+    TdoaLocator locator;
+    TdoaDetection detections[TdoaLocator::MAX_STATIONS];
+    volatile float sink = 0.0f;
+    seed(30);
+    const size_t counts[] = {3, 4, 6, 8, 12, 16};
+    for (size_t n : counts) {
+        for (size_t i = 0; i < n; i++) {
+            const float angle = 2.0f * static_cast<float>(M_PI) * i / n;
+            detections[i] = detection(i, 25.0f * cosf(angle), 25.0f * sinf(angle), 4.0f, -2.0f, gaussian());
+        }
+        const int iterations = 5000;
+        const auto start = std::chrono::steady_clock::now();
+        for (int it = 0; it < iterations; it++) {
+            sink = sink + locator.solve(detections, n).residual_us;
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        printf("tdoa N=%2zu  %7.2f us/solve\n", n, std::chrono::duration<double, std::micro>(elapsed).count() / iterations);
+    }
+    TEST_ASSERT_TRUE(sink > 0.0f);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_exact_arrivals_recover_position_and_time);
+    RUN_TEST(test_three_stations_exactly_determined);
+    RUN_TEST(test_ransac_rejects_bad_timestamps);
+    RUN_TEST(test_chi2_matches_timing_noise);
+    RUN_TEST(test_accuracy_vs_timing_jitter);
+    RUN_TEST(test_benchmark_solve_vs_station_count);
+
+    return UNITY_END();
+}
@@ -0,0 +1,294 @@
+// Unit tests and native benchmark for the compressed time-series store
+#include <unity.h>
+#include "../src/sensors/time_series_store.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace SensorSystem;
+
+static constexpr uint32_t HOUR_S = 3600;
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Deterministic draws (xorshift32)
+static uint32_t s_seed = 1;
+static void seed(uint32_t n) {
+    s_seed = (n + 1) * 0x9E3779B9u;
+}
+static uint32_t next32() {
+    s_seed ^= s_seed << 13;
+    s_seed ^= s_seed >> 17;
+    s_seed ^= s_seed << 5;
+    return s_seed;
+}
+static float uniform() {
+    return ((next32() >> 8) + 0.5f) / 16777216.0f;
+}
+static float gaussian() {
+    return sqrtf(-2.0f * logf(uniform())) * cosf(2.0f * static_cast<float>(M_PI) * uniform());
+}
+
+static TimeSeriesStore s_store;                     // 16 KiB: keep it off the stack
+static TimeSeriesSample s_expected[8192];
+
+void test_lossless_round_trip() {
+    s_store.reset();
+    const int channel = s_store.addChannel(makeTimeSeriesChannel("raw", "", 16 * TimeSeriesStore::BLOCK_BYTES));
+    TEST_ASSERT_EQUAL_INT(0, channel);
+
+    // Irregular timestamps (including gaps that need the 32-bit escape) and arbitrary floats
+    seed(1);
+    uint32_t t = 0xFFFFF000u;                       // Crosses the millis() wrap
+    const int count = 600;
+    for (int i = 0; i < count; i++) {
+        const uint32_t r = next32();
+        t += (r & 7) == 0 ? 100000 + (r >> 12) : 1000 + (r & 0xF);
+        float value = gaussian() * 1000.0f;
+        if ((r & 0x30) == 0) {
+            value = s_expected[i > 0 ? i - 1 : 0].value;        // Repeats
+        }
+        s_expected[i].timestamp = t;
+        s_expected[i].value = value;
+        TEST_ASSERT_TRUE(s_store.append(channel, t, value));
+    }
+
+    TimeSeriesStore::Iterator it = s_store.query(channel, s_expected[0].timestamp, t);
+    TimeSeriesSample sample;
+    int n = 0;
+    while (it.next(sample)) {
+        TEST_ASSERT_EQUAL_UINT32(s_expected[n].timestamp, sample.timestamp);
+        TEST_ASSERT_EQUAL_UINT32(*reinterpret_cast<const uint32_t*>(&s_expected[n].value),
+                                 *reinterpret_cast<const uint32_t*>(&sample.value));
+        n++;
+    }
+    TEST_ASSERT_EQUAL_INT(count, n);
+
+    TimeSeriesStats stats;
+    TEST_ASSERT_TRUE(s_store.getStats(channel, stats));
+    TEST_ASSERT_EQUAL_UINT32(count, stats.samples);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(s_expected[0].timestamp, stats.oldest_ms);
+    TEST_ASSERT_EQUAL_UINT32(t, stats.newest_ms);
+}
+
+void test_quantized_channel_and_resolution() {
+    s_store.reset();
+    const int battery = s_store.addChannel(makeTimeSeriesChannel("battery", "V", 1024, 100, 0.001f));
+    seed(2);
+    for (int i = 0; i < 300; i++) {
+        const float v = 4.1f - i * 0.0002f + 0.002f * gaussian();
+        s_expected[i].timestamp = 5000 + i * 1000 + (next32() & 3);      // Loop jitter
+        s_expected[i].value = v;
+        s_store.append(battery, s_expected[i].timestamp, v);
+    }
+
+    TimeSeriesStore::Iterator it = s_store.query(battery, 0, UINT32_MAX / 2);
+    TimeSeriesSample sample;
+    int n = 0;
+    while (it.next(sample)) {
+        TEST_ASSERT_EQUAL_UINT32(s_expected[n].timestamp / 100 * 100, sample.timestamp);
+        TEST_ASSERT_FLOAT_WITHIN(0.0005f + 1e-6f, s_expected[n].value, sample.value);
+        n++;
+    }
+    TEST_ASSERT_EQUAL_INT(300, n);
+
+    TimeSeriesSample latest;
+    TEST_ASSERT_TRUE(s_store.getLatest(battery, latest));
+    TEST_ASSERT_EQUAL_UINT32(s_expected[299].timestamp / 100 * 100, latest.timestamp);
+}
+
+void test_ring_evicts_oldest_block() {
+    s_store.reset();
+    const int rssi = s_store.addChannel(makeTimeSeriesChannel("rssi", "dBm", 2 * TimeSeriesStore::BLOCK_BYTES, 1000));
+    seed(3);
+    const uint32_t count = 5000;
+    for (uint32_t i = 0; i < count; i++) {
+        TEST_ASSERT_TRUE(s_store.append(rssi, i * 1000, roundf(-95.0f + 3.0f * gaussian())));
+    }
+
+    TimeSeriesStats stats;
+    s_store.getStats(rssi, stats);
+    TEST_ASSERT_EQUAL_UINT32(count, stats.samples + stats.dropped);
+    TEST_ASSERT_GREATER_THAN(0, stats.dropped);
+    TEST_ASSERT_EQUAL_UINT32(2 * TimeSeriesStore::BLOCK_BYTES, stats.bytes_used);
+    TEST_ASSERT_EQUAL_UINT32((count - 1) * 1000, stats.newest_ms);
+    TEST_ASSERT_EQUAL_UINT32(stats.dropped * 1000, stats.oldest_ms);
+
+    // What is left is the newest contiguous stretch
+    TimeSeriesStore::Iterator it = s_store.query(rssi, 0, UINT32_MAX / 2);
+    TimeSeriesSample sample;
+    uint32_t expected_t = stats.oldest_ms;
+    uint32_t n = 0;
+    while (it.next(sample)) {
+        TEST_ASSERT_EQUAL_UINT32(expected_t, sample.timestamp);
+        expected_t += 1000;
+        n++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(stats.samples, n);
+}
+
+void test_range_queries() {
+    s_store.reset();
+    const int level = s_store.addChannel(makeTimeSeriesChannel("noise_floor", "", 8 * TimeSeriesStore::BLOCK_BYTES, 1000));
+    for (uint32_t i = 0; i < 4000; i++) {
+        s_store.append(level, 10000 + i * 1000, static_cast<float>((i / 200) % 8));
+    }
+
+    // Inclusive bounds, starting mid-stream in a later block
+    TimeSeriesStore::Iterator it = s_store.query(level, 3010000, 3015000);
+    TimeSeriesSample sample;
+    uint32_t n = 0;
+    while (it.next(sample)) {
+        TEST_ASSERT_EQUAL_UINT32(3010000 + n * 1000, sample.timestamp);
+        TEST_ASSERT_EQUAL_FLOAT(static_cast<float>((3000 / 200) % 8), sample.value);
+        n++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(6, n);
+
+    // Between samples, before the first, after the last, inverted, bad channel
+    it = s_store.query(level, 3010500, 3010900);
+    TEST_ASSERT_FALSE(it.next(sample));
+    it = s_store.query(level, 0, 10000);
+    TEST_ASSERT_TRUE(it.next(sample));
+    TEST_ASSERT_EQUAL_UINT32(10000, sample.timestamp);
+    TEST_ASSERT_FALSE(it.next(sample));
+    it = s_store.query(level, 5000000, 6000000);
+    TEST_ASSERT_FALSE(it.next(sample));
+    it = s_store.query(level, 3015000, 3010000);
+    TEST_ASSERT_FALSE(it.next(sample));
+    it = s_store.query(7, 0, 1000);
+    TEST_ASSERT_FALSE(it.next(sample));
+}
+
+void test_readings_and_rejections() {
+    s_store.reset();
+    const int energy = s_store.addChannel(makeTimeSeriesChannel("strike_energy", "", 512));
+    const int irq = s_store.addChannel(makeTimeSeriesChannel("irq", "", 512));
+    TEST_ASSERT_EQUAL_INT(energy, s_store.findChannel("strike_energy"));
+    TEST_ASSERT_EQUAL_INT(-1, s_store.findChannel("missing"));
+
+    Reading reading = createIntReading("strike_energy", 123456);
+    reading.timestamp = 2000;
+    TEST_ASSERT_TRUE(s_store.append(reading));
+    reading.timestamp = 1000;
+    TEST_ASSERT_FALSE(s_store.append(reading));                 // Backwards in time
+    reading = createBoolReading("irq", true);
+    reading.timestamp = 2000;
+    TEST_ASSERT_TRUE(s_store.append(reading));
+    TEST_ASSERT_FALSE(s_store.append(createStringReading("irq", "x")));
+    TEST_ASSERT_FALSE(s_store.append(createErrorReading("irq", 3)));
+    TEST_ASSERT_FALSE(s_store.append(createIntReading("unknown", 1)));
+
+    TimeSeriesSample sample;
+    TEST_ASSERT_TRUE(s_store.getLatest(energy, sample));
+    TEST_ASSERT_EQUAL_FLOAT(123456.0f, sample.value);
+    TEST_ASSERT_TRUE(s_store.getLatest(irq, sample));
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, sample.value);
+
+    TimeSeriesStats stats;
+    s_store.getStats(energy, stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.rejected);
+
+    // Budgets are whole blocks, at least two, from a fixed arena
+    TEST_ASSERT_EQUAL_INT(-1, s_store.addChannel(makeTimeSeriesChannel("tiny", "", 300)));
+    TEST_ASSERT_EQUAL_INT(-1, s_store.addChannel(makeTimeSeriesChannel("huge", "", TimeSeriesStore::ARENA_BYTES)));
+    TEST_ASSERT_EQUAL_INT(2, s_store.addChannel(makeTimeSeriesChannel("rest", "", TimeSeriesStore::ARENA_BYTES - 1024)));
+}
+
+// One hour at 1 Hz with loop jitter; returns bytes of payload per hour
+static float hourOfSignal(int channel, float (*signal)(uint32_t)) {
+    for (uint32_t i = 0; i < HOUR_S; i++) {
+        s_store.append(channel, 1000 + i * 1000 + (next32() % 5), signal(i));
+    }
+    TimeSeriesStats stats;
+    s_store.getStats(channel, stats);
+    return stats.bits_per_sample * HOUR_S / 8.0f;
+}
+
+static float batterySignal(uint32_t i) { return 4.15f - 0.00005f * i + 0.002f * gaussian(); }
+static float noiseFloorSignal(uint32_t i) { return static_cast<float>(2 + (i / 600) % 3); }
+static float rssiSignal(uint32_t i) { return roundf(-97.0f + 2.0f * gaussian()); }
+static float rawFloatSignal(uint32_t i) { return 3.3f + 0.01f * gaussian(); }
+
+void test_compression_per_hour_at_1hz() {
+    struct Case {
+        const char* name;
+        float (*signal)(uint32_t);
+        float quantum;
+        float max_bytes;
+    };
+    const Case cases[] = {
+        {"noise floor (level 0-7)", noiseFloorSignal, 0.0f, 1000.0f},
+        {"RSSI (1 dBm steps)", rssiSignal, 0.0f, 4000.0f},
+        {"battery (1 mV quantum)", batterySignal, 0.001f, 4000.0f},
+        {"battery (5 mV quantum)", batterySignal, 0.005f, 2000.0f},
+        {"raw noisy float", rawFloatSignal, 0.0f, 11000.0f},
+    };
+
+    seed(4);
+    for (const Case& c : cases) {
+        s_store.reset();
+        const int channel = s_store.addChannel(makeTimeSeriesChannel(c.name, "", TimeSeriesStore::ARENA_BYTES, 100, c.quantum));
+        const float bytes = hourOfSignal(channel, c.signal);
+        // Reading is what a naive history would keep; 8 bytes is a packed (u32, f32) pair
+        printf("tsdb %-24s %6.0f B/h  %5.2f bits/sample  %5.1fx vs Reading  %5.1fx vs 8 B\n", c.name, bytes,
+               bytes * 8.0f / HOUR_S, HOUR_S * sizeof(Reading) / bytes, HOUR_S * 8.0f / bytes);
+        TEST_ASSERT_LESS_THAN(c.max_bytes, bytes);
+    }
+}
+
+void test_benchmark_append_and_query() {
+    s_store.reset();
+    const int channel = s_store.addChannel(makeTimeSeriesChannel("rssi", "dBm", 32 * TimeSeriesStore::BLOCK_BYTES, 100));
+    seed(5);
+    static float values[4096];
+    for (int i = 0; i < 4096; i++) {
+        values[i] = roundf(-97.0f + 2.0f * gaussian());
+    }
+
+    const uint32_t appends = 500000;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < appends; i++) {
+        s_store.append(channel, i * 1000, values[i & 4095]);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    const double append_ns = std::chrono::duration<double, std::nano>(elapsed).count() / appends;
+
+    TimeSeriesStats stats;
+    s_store.getStats(channel, stats);
+    volatile float sink = 0.0f;
+    uint32_t decoded = 0;
+    const int queries = 200;
+    start = std::chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) {
+        TimeSeriesStore::Iterator it = s_store.query(channel, stats.oldest_ms, stats.newest_ms);
+        TimeSeriesSample sample;
+        while (it.next(sample)) {
+            sink = sink + sample.value;
+            decoded++;
+        }
+    }
+    elapsed = std::chrono::steady_clock::now() - start;
+    const double query_ns = std::chrono::duration<double, std::nano>(elapsed).count() / decoded;
+
+    printf("tsdb append %6.1f ns/sample   query %6.1f ns/sample   (%u samples retained in %u B)\n", append_ns,
+           query_ns, stats.samples, stats.bytes_used);
+    TEST_ASSERT_EQUAL_UINT32(queries * stats.samples, decoded);
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_lossless_round_trip);
+    RUN_TEST(test_quantized_channel_and_resolution);
+    RUN_TEST(test_ring_evicts_oldest_block);
+    RUN_TEST(test_range_queries);
+    RUN_TEST(test_readings_and_rejections);
+    RUN_TEST(test_compression_per_hour_at_1hz);
+    RUN_TEST(test_benchmark_append_and_query);
+
+    return UNITY_END();
+}
@@ -0,0 +1,131 @@
+// Unit tests for the deferred UI action timeline
+#include <unity.h>
+#include "../src/display/ui_timeline.h"
+#include <cstring>
+
+using namespace Display;
+
+struct FireLog {
+    char order[16];
+    size_t count;
+};
+
+static FireLog s_log;
+
+static void record(void* context) {
+    if (s_log.count < sizeof(s_log.order) - 1) {
+        s_log.order[s_log.count++] = *static_cast<const char*>(context);
+    }
+}
+
+static UiTimeline* s_timeline;
+static uint32_t s_now;
+
+static void reschedule(void* context) {
+    record(context);
+    s_timeline->schedule(s_now, 0, record, context, "again");
+}
+
+void setUp(void) {
+    memset(&s_log, 0, sizeof(s_log));
+}
+
+void tearDown(void) {}
+
+void test_actions_fire_when_due_in_due_order() {
+    UiTimeline timeline;
+    static const char a = 'a', b = 'b', c = 'c';
+    timeline.schedule(1000, 300, record, (void*)&c, "c");
+    timeline.schedule(1000, 100, record, (void*)&a, "a");
+    timeline.schedule(1000, 200, record, (void*)&b, "b");
+
+    TEST_ASSERT_EQUAL_UINT32(0, timeline.poll(1099));
+    TEST_ASSERT_EQUAL_UINT32(100, timeline.msUntilNext(1000));
+    TEST_ASSERT_EQUAL_UINT32(1, timeline.poll(1100));
+    TEST_ASSERT_EQUAL_UINT32(2, timeline.poll(1500));
+    TEST_ASSERT_EQUAL_STRING("abc", s_log.order);
+    TEST_ASSERT_EQUAL_UINT32(0, timeline.size());
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, timeline.msUntilNext(1500));
+    TEST_ASSERT_EQUAL_UINT32(300, timeline.getStats().max_late_ms);
+}
+
+void test_equal_due_times_fire_in_scheduling_order() {
+    UiTimeline timeline;
+    static const char text[] = "fedcba";
+    for (int i = 0; i < 6; i++) {
+        timeline.schedule(0, 50, record, (void*)&text[i], "tie");
+    }
+    // Removal swaps entries around; scheduling order must still hold
+    timeline.poll(50);
+    TEST_ASSERT_EQUAL_STRING("fedcba", s_log.order);
+}
+
+void test_cancel_and_pending() {
+    UiTimeline timeline;
+    static const char a = 'a', b = 'b';
+    const uint16_t first = timeline.schedule(0, 10, record, (void*)&a, "a");
+    const uint16_t second = timeline.schedule(0, 10, record, (void*)&b, "b");
+    TEST_ASSERT_TRUE(first != 0 && second != 0 && first != second);
+
+    TEST_ASSERT_TRUE(timeline.isPending(first));
+    TEST_ASSERT_TRUE(timeline.cancel(first));
+    TEST_ASSERT_FALSE(timeline.isPending(first));
+    TEST_ASSERT_FALSE(timeline.cancel(first));
+    TEST_ASSERT_FALSE(timeline.isPending(0));
+
+    timeline.poll(10);
+    TEST_ASSERT_EQUAL_STRING("b", s_log.order);
+    TEST_ASSERT_FALSE(timeline.isPending(second));
+    TEST_ASSERT_EQUAL_UINT32(1, timeline.getStats().cancelled);
+}
+
+void test_full_timeline_rejects() {
+    UiTimeline timeline;
+    static const char a = 'a';
+    for (size_t i = 0; i < UiTimeline::CAPACITY; i++) {
+        TEST_ASSERT_TRUE(timeline.schedule(0, 10, record, (void*)&a, "fill") != 0);
+    }
+    TEST_ASSERT_EQUAL_UINT16(0, timeline.schedule(0, 10, record, (void*)&a, "over"));
+    TEST_ASSERT_EQUAL_UINT16(0, timeline.schedule(0, 10, nullptr, nullptr, "null"));
+    TEST_ASSERT_EQUAL_UINT32(2, timeline.getStats().rejected);
+}
+
+// A retry scheduled from inside an action waits for the next poll, so an
+// action that keeps rescheduling itself cannot spin the loop
+void test_action_scheduled_during_poll_waits() {
+    UiTimeline timeline;
+    s_timeline = &timeline;
+    s_now = 100;
+    static const char r = 'r';
+    timeline.schedule(0, 100, reschedule, (void*)&r, "retry");
+
+    TEST_ASSERT_EQUAL_UINT32(1, timeline.poll(100));
+    TEST_ASSERT_EQUAL_UINT32(1, timeline.size());
+    TEST_ASSERT_EQUAL_UINT32(1, timeline.poll(100));
+    TEST_ASSERT_EQUAL_STRING("rr", s_log.order);
+}
+
+void test_due_time_survives_millis_wrap() {
+    UiTimeline timeline;
+    static const char a = 'a';
+    const uint32_t start = 0xFFFFFF00u;
+    timeline.schedule(start, 0x200, record, (void*)&a, "wrap");
+
+    TEST_ASSERT_EQUAL_UINT32(0, timeline.poll(0xFFFFFFF0u));
+    TEST_ASSERT_EQUAL_UINT32(0, timeline.poll(0x000000F0u));
+    TEST_ASSERT_EQUAL_UINT32(0x10, timeline.msUntilNext(0x000000F0u));
+    TEST_ASSERT_EQUAL_UINT32(1, timeline.poll(0x00000100u));
+}
+
+int main(int argc, char **argv) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_actions_fire_when_due_in_due_order);
+    RUN_TEST(test_equal_due_times_fire_in_scheduling_order);
+    RUN_TEST(test_cancel_and_pending);
+    RUN_TEST(test_full_timeline_rejects);
+    RUN_TEST(test_action_scheduled_during_poll_waits);
+    RUN_TEST(test_due_time_survives_millis_wrap);
+
+    return UNITY_END();
+}